@@ -258,6 +258,57 @@
 
 #define ACPI_MAX_LOOP_TIMEOUT           30
 
+/*
+ * Scopes with at least this many children get a hashed child index so that
+ * AcpiNsSearchOneScope does not have to walk the whole peer list. Wide
+ * scopes such as \_SB and \_PR on server firmware are the main users.
+ */
+#define ACPI_NS_INDEX_THRESHOLD         32
+
+/* Minimum number of slots in a scope's child index (must be power of 2) */
+
+#define ACPI_NS_INDEX_MIN_SIZE          64
+
+/*
+ * Absolute pathname lookup cache used by AcpiNsGetNode. Entries (power of
+ * 2) and the longest external pathname that is cached, including the null.
+ */
+#define ACPI_NS_PATH_CACHE_SIZE         512
+#define ACPI_NS_PATH_CACHE_NAME_LENGTH  48
+
+/*
+ * Namespace nodes created by a table load are carved from per-owner slabs
+ * of this many nodes, so that unloading the table frees them in bulk.
+ */
+#define ACPI_NS_NODE_SLAB_SIZE          64
+
+/*
+ * Name references resolved while running control methods are cached per
+ * method. Default memory budget in bytes for all such caches, and the
+ * bounds for the number of slots in one method's cache (powers of 2).
+ */
+#define ACPI_METHOD_CACHE_BUDGET        (128 * 1024)
+#define ACPI_METHOD_CACHE_MIN_SLOTS     8
+#define ACPI_METHOD_CACHE_MAX_SLOTS     256
+
+/*
+ * Simple methods are executed from a pre-decoded form. Longest method AML
+ * that is decoded, the operand stack depth available, and how many buffer
+ * constants and distinct name references a decoded method may have.
+ */
+#define ACPI_DECODE_MAX_AML_LENGTH      4096
+#define ACPI_DECODE_STACK_DEPTH         16
+#define ACPI_DECODE_MAX_BUFFERS         16
+#define ACPI_DECODE_MAX_NAMES           16
+
+/*
+ * Parallel methods run under the shared interpreter. Most threads that can
+ * hold it shared at once (more fall back to exclusive), and the number of
+ * locks operation regions are hashed onto while they hold it.
+ */
+#define ACPI_INTERPRETER_MAX_SHARED     16
+#define ACPI_REGION_LOCK_COUNT          32
+
 
 /******************************************************************************
  *
@@ -284,7 +284,8 @@ AcpiDbGenerateSci (
 
 void
 AcpiDbExecuteTest (
-    char                    *TypeArg);
+    char                    *TypeArg,
+    char                    *CountArg);
 
 
 /*
@@ -369,6 +369,16 @@ AcpiDsAutoSerializeMethod (
     ACPI_NAMESPACE_NODE     *Node,
     ACPI_OPERAND_OBJECT     *ObjDesc);
 
+ACPI_STATUS
+AcpiDsDetectPureMethod (
+    ACPI_NAMESPACE_NODE     *Node,
+    ACPI_OPERAND_OBJECT     *ObjDesc);
+
+ACPI_STATUS
+AcpiDsDetectParallelMethod (
+    ACPI_NAMESPACE_NODE     *Node,
+    ACPI_OPERAND_OBJECT     *ObjDesc);
+
 ACPI_STATUS
 AcpiDsCallControlMethod (
     ACPI_THREAD_STATE       *Thread,
@@ -234,6 +234,23 @@ ACPI_GLOBAL (ACPI_MUTEX,                AcpiGbl_OsiMutex);
 
 ACPI_GLOBAL (ACPI_RW_LOCK,              AcpiGbl_NamespaceRwLock);
 
+/*
+ * Shared interpreter for parallel methods (exutils.c). Holders, the count
+ * of those not suspended, and the semaphore the last one signals when a
+ * thread taking the interpreter exclusive is waiting for them to leave.
+ */
+ACPI_GLOBAL (ACPI_SPINLOCK,             AcpiGbl_InterpreterLock);
+ACPI_GLOBAL (ACPI_SEMAPHORE,            AcpiGbl_InterpreterDrained);
+ACPI_GLOBAL (ACPI_INTERPRETER_HOLDER,   AcpiGbl_InterpreterHolders[ACPI_INTERPRETER_MAX_SHARED]);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_InterpreterHolderCount);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_InterpreterReaders);
+ACPI_GLOBAL (BOOLEAN,                   AcpiGbl_InterpreterDrainWaiting);
+ACPI_GLOBAL (ACPI_REGION_LOCK,          AcpiGbl_RegionLocks[ACPI_REGION_LOCK_COUNT]);
+
+/* Method thread counts and owner IDs, which parallel methods update concurrently */
+
+ACPI_GLOBAL (ACPI_MUTEX,                AcpiGbl_MethodThreadMutex);
+
 
 /*****************************************************************************
  *
@@ -280,6 +297,19 @@ ACPI_INIT_GLOBAL (BOOLEAN,              AcpiGbl_NamespaceInitialized, FALSE);
 
 ACPI_GLOBAL (UINT32,                    AcpiGbl_OriginalMode);
 ACPI_GLOBAL (UINT32,                    AcpiGbl_NsLookupCount);
+ACPI_GLOBAL (ACPI_NS_PATH_CACHE_ENTRY *, AcpiGbl_NsPathCache);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_NsPathCacheGeneration);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_NsPathCacheHits);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_NsPathCacheMisses);
+ACPI_GLOBAL (ACPI_NS_NODE_ARENA *,      AcpiGbl_NsNodeArenas);
+ACPI_GLOBAL (ACPI_NS_ID_MAP *,          AcpiGbl_NsIdMap);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_NsIdMapGeneration);
+ACPI_GLOBAL (ACPI_METHOD_NAME_CACHE *,  AcpiGbl_MethodCacheList);
+ACPI_GLOBAL (ACPI_METHOD_NAME_CACHE *,  AcpiGbl_MethodCacheClock);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_MethodCacheBytes);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_MethodCacheHits);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_MethodCacheMisses);
+ACPI_GLOBAL (UINT32,                    AcpiGbl_MethodCacheEvictions);
 ACPI_GLOBAL (UINT32,                    AcpiGbl_PsFindCount);
 ACPI_GLOBAL (UINT16,                    AcpiGbl_Pm1EnableRegisterSave);
 ACPI_GLOBAL (UINT8,                     AcpiGbl_DebuggerConfiguration);
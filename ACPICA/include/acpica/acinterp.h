@@ -785,6 +785,34 @@ void
 AcpiExExitInterpreter (
     void);
 
+void
+AcpiExEnterInterpreterShared (
+    void);
+
+void
+AcpiExExitInterpreterShared (
+    void);
+
+void
+AcpiExUpgradeInterpreter (
+    void);
+
+BOOLEAN
+AcpiExInterpreterIsShared (
+    void);
+
+void
+AcpiExWaitForSharedHolders (
+    void);
+
+ACPI_REGION_LOCK *
+AcpiExAcquireRegionLock (
+    ACPI_OPERAND_OBJECT     *ObjDesc);
+
+void
+AcpiExReleaseRegionLock (
+    ACPI_REGION_LOCK        *Lock);
+
 BOOLEAN
 AcpiExTruncateFor32bitTable (
     ACPI_OPERAND_OBJECT     *ObjDesc);
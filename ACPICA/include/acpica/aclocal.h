@@ -211,6 +211,35 @@ typedef struct acpi_rw_lock
 } ACPI_RW_LOCK;
 
 
+/*
+ * A thread running a parallel method under the shared interpreter
+ * (exutils.c). Suspended while it has let go of the interpreter to block;
+ * upgraded once it has taken the interpreter exclusive, which it then
+ * keeps for the rest of the evaluation.
+ */
+typedef struct acpi_interpreter_holder
+{
+    ACPI_THREAD_ID          ThreadId;       /* Zero if the slot is free */
+    UINT32                  Depth;          /* Nested evaluations, from a region handler */
+    UINT8                   State;
+
+} ACPI_INTERPRETER_HOLDER;
+
+#define ACPI_INTERPRETER_SHARED         1
+#define ACPI_INTERPRETER_SUSPENDED      2
+#define ACPI_INTERPRETER_UPGRADED       3
+
+/* Serializes accesses to the regions hashed onto it from shared threads */
+
+typedef struct acpi_region_lock
+{
+    ACPI_MUTEX              Mutex;
+    ACPI_THREAD_ID          ThreadId;       /* Owner, zero if free */
+    UINT32                  Depth;
+
+} ACPI_REGION_LOCK;
+
+
 /*
  * Predefined handles for spinlocks used within the subsystem.
  * These spinlocks are created by AcpiUtMutexInitialize
@@ -279,6 +308,118 @@ typedef enum
 } ACPI_INTERPRETER_MODE;
 
 
+/*
+ * Hashed index over the children of a single namespace scope. Only wide
+ * scopes (see AcpiGbl_NamespaceIndexThreshold) carry one; it is keyed on
+ * Name.Integer and uses open addressing with linear probing. The peer list
+ * remains the authoritative record of the scope, the index only accelerates
+ * AcpiNsSearchOneScope and tail insertion.
+ */
+typedef struct acpi_ns_index
+{
+    struct acpi_namespace_node      **Table;        /* Open-addressed slots */
+    struct acpi_namespace_node      *LastChild;     /* Tail of the peer list */
+    UINT32                          Size;           /* Slot count, power of 2 */
+    UINT32                          Count;          /* Live entries */
+    UINT32                          Deleted;        /* Tombstoned slots */
+    UINT32                          Duplicates;     /* Names shadowed by an earlier peer */
+
+} ACPI_NS_INDEX;
+
+#define ACPI_NS_INDEX_DELETED           ACPI_CAST_PTR (ACPI_NAMESPACE_NODE, ACPI_TO_POINTER (1))
+
+
+/*
+ * Map from _HID/_CID strings to device nodes, used by AcpiGetDevices. The
+ * devices are kept in namespace walk order; each device records where its
+ * subtree ends so that a pruned subtree can be skipped by index. Devices
+ * whose IDs come from a method that is not pure are listed as volatile and
+ * have their IDs evaluated on every query. The map is valid only while
+ * Generation matches AcpiGbl_NsPathCacheGeneration and IdGeneration matches
+ * AcpiGbl_NsIdMapGeneration, which is advanced by stores to ID objects.
+ */
+typedef struct acpi_ns_id_device
+{
+    struct acpi_namespace_node      *Node;
+    UINT32                          SubtreeEnd;     /* First device after subtree */
+    UINT32                          Level;          /* Nesting level below root */
+
+} ACPI_NS_ID_DEVICE;
+
+typedef struct acpi_ns_id_entry
+{
+    UINT32                          Hash;           /* Hash of the ID string */
+    UINT32                          Next;           /* Next entry in bucket */
+    UINT32                          Device;         /* Index into Devices */
+    UINT32                          IdOffset;       /* Offset of ID in Strings */
+
+} ACPI_NS_ID_ENTRY;
+
+typedef struct acpi_ns_id_map
+{
+    UINT32                          Generation;     /* Namespace generation at build */
+    UINT32                          IdGeneration;   /* ID store generation at build */
+    UINT32                          ReferenceCount;
+    UINT32                          DeviceCount;
+    UINT32                          VolatileCount;
+    UINT32                          EntryCount;
+    UINT32                          BucketCount;    /* Power of 2 */
+    ACPI_NS_ID_DEVICE               *Devices;       /* Walk order */
+    UINT32                          *Volatile;      /* Ascending device indexes */
+    UINT32                          *Buckets;       /* First entry of each chain */
+    ACPI_NS_ID_ENTRY                *Entries;       /* Chains in device order */
+    char                            *Strings;
+
+} ACPI_NS_ID_MAP;
+
+#define ACPI_NS_ID_MAP_END              ACPI_UINT32_MAX
+
+
+/*
+ * One entry of the absolute pathname lookup cache. An entry is valid only
+ * while its Generation matches AcpiGbl_NsPathCacheGeneration.
+ */
+typedef struct acpi_ns_path_cache_entry
+{
+    struct acpi_namespace_node      *Node;          /* Resolved node */
+    UINT32                          Generation;     /* Namespace generation at fill */
+    UINT32                          Hash;           /* Hash of Pathname */
+    char                            Pathname[ACPI_NS_PATH_CACHE_NAME_LENGTH];
+
+} ACPI_NS_PATH_CACHE_ENTRY;
+
+
+/*
+ * Cache of the name references resolved while executing one control
+ * method, attached to the method object. A slot is keyed by the offset of
+ * the NamePath within the method AML and the scope it was resolved from.
+ * The cache itself is keyed by the method's AML pointer (it is freed with
+ * the method object, so with the owning table), and its slots are valid
+ * only while Generation matches AcpiGbl_NsPathCacheGeneration.
+ */
+typedef struct acpi_method_name_slot
+{
+    struct acpi_namespace_node      *ScopeNode;     /* Scope of the lookup */
+    struct acpi_namespace_node      *Node;          /* Resolved node */
+    UINT32                          AmlOffset;      /* NamePath offset in method */
+
+} ACPI_METHOD_NAME_SLOT;
+
+typedef struct acpi_method_name_cache
+{
+    struct acpi_method_name_cache   *Next;          /* Global cache list */
+    struct acpi_method_name_cache   *Prev;
+    union acpi_operand_object       *MethodDesc;    /* Owning method object */
+    UINT8                           *AmlStart;      /* AML the slots refer to */
+    BOOLEAN                         Referenced;     /* Used since last eviction scan */
+    UINT32                          Generation;
+    UINT32                          SlotMask;
+    UINT32                          Size;           /* Bytes charged to the budget */
+    ACPI_METHOD_NAME_SLOT           Slots[1];       /* SlotMask + 1 slots */
+
+} ACPI_METHOD_NAME_CACHE;
+
+
 /*
  * The Namespace Node describes a named object that appears in the AML.
  * DescriptorType is used to differentiate between internal descriptors.
@@ -300,6 +441,7 @@ typedef struct acpi_namespace_node
     struct acpi_namespace_node      *Parent;        /* Parent node */
     struct acpi_namespace_node      *Child;         /* First child */
     struct acpi_namespace_node      *Peer;          /* First peer */
+    struct acpi_ns_index            *ChildIndex;    /* Hashed children (wide scopes only) */
     ACPI_OWNER_ID                   OwnerId;        /* Node creator */
 
     /*
@@ -328,6 +470,7 @@ typedef struct acpi_namespace_node
 #define ANOBJ_EVALUATED                 0x20    /* Set on first evaluation of node */
 #define ANOBJ_ALLOCATED_BUFFER          0x40    /* Method AML buffer is dynamic (InstallMethod) */
 #define ANOBJ_NODE_EARLY_INIT           0x80    /* AcpiExec only: Node was create via init file (-fi) */
+#define ANOBJ_SLAB_ALLOCATED            0x0100  /* Node lives in an owner's node arena */
 
 #define ANOBJ_IS_EXTERNAL               0x08    /* iASL only: This object created via External() */
 #define ANOBJ_METHOD_NO_RETVAL          0x10    /* iASL only: Method has no return value */
@@ -335,6 +478,33 @@ typedef struct acpi_namespace_node
 #define ANOBJ_IS_REFERENCED             0x80    /* iASL only: Object was referenced */
 
 
+/*
+ * Per-owner node arena. Nodes loaded from one table are allocated from the
+ * slabs of that table's arena, which keeps them close together in memory
+ * and lets AcpiNsDeleteNamespaceByOwner release them all at once. Nodes
+ * freed individually before then are recycled through FreeList (linked
+ * via the Peer field).
+ */
+typedef struct acpi_ns_node_slab
+{
+    struct acpi_ns_node_slab        *Next;          /* Next (older) slab */
+    UINT32                          Used;           /* Nodes carved so far */
+    ACPI_NAMESPACE_NODE             Nodes[ACPI_NS_NODE_SLAB_SIZE];
+
+} ACPI_NS_NODE_SLAB;
+
+typedef struct acpi_ns_node_arena
+{
+    struct acpi_ns_node_arena       *Next;          /* Next owner's arena */
+    ACPI_NS_NODE_SLAB               *Slabs;         /* Newest slab first */
+    ACPI_NAMESPACE_NODE             *FreeList;      /* Recycled nodes */
+    UINT32                          SlabCount;
+    UINT32                          LiveNodes;
+    ACPI_OWNER_ID                   OwnerId;
+
+} ACPI_NS_NODE_ARENA;
+
+
 /* Internal ACPI table management - master table list */
 
 typedef struct acpi_table_list
@@ -1229,6 +1399,60 @@ typedef struct acpi_parse_state
 } ACPI_PARSE_STATE;
 
 
+/*
+ * Pre-decoded form of a control method that computes on integers and
+ * buffers held in Locals, Args, buffer fields of Args and named objects
+ * (psdecode.c). The operations form a small stack machine; branch targets
+ * are indexes into Ops.
+ */
+typedef struct acpi_decoded_op
+{
+    UINT8                           Opcode;         /* ACPI_DOP_* */
+    UINT8                           Index;          /* Local, Arg or field number */
+    UINT16                          AmlOpcode;      /* Math and logical operators */
+    UINT32                          Operand;        /* Branch target, constant, buffer or name index */
+
+} ACPI_DECODED_OP;
+
+typedef struct acpi_decoded_field
+{
+    UINT32                          Offset;         /* Byte offset in the Arg buffer */
+    UINT8                           Arg;
+    UINT8                           Length;         /* 1, 2, 4 or 8 bytes */
+
+} ACPI_DECODED_FIELD;
+
+typedef struct acpi_decoded_name
+{
+    UINT8                           *Path;          /* NameString in the method AML */
+    struct acpi_namespace_node      *Node;
+    UINT8                           Type;           /* ACPI_TYPE_INTEGER or ACPI_TYPE_BUFFER */
+    BOOLEAN                         Shadow;         /* Created by the method, must not resolve */
+
+} ACPI_DECODED_NAME;
+
+typedef struct acpi_decoded_method
+{
+    UINT64                          *Constants;
+    union acpi_operand_object       **Buffers;      /* Buffer constants */
+    ACPI_DECODED_NAME               *Names;
+    ACPI_DECODED_FIELD              *Fields;
+    ACPI_DECODED_OP                 *Ops;
+    UINT32                          OpCount;
+    UINT32                          Generation;     /* Namespace generation Names were resolved in */
+    UINT8                           BufferCount;
+    UINT8                           NameCount;
+    UINT8                           ArgMask;        /* Args read as integers */
+    UINT8                           BufferArgMask;  /* Args read as buffers */
+    UINT8                           AnyArgMask;     /* Args returned whatever their type */
+    UINT8                           Flags;
+
+} ACPI_DECODED_METHOD;
+
+#define ACPI_DECODED_INTERPRETER        0x01    /* Runs only with the interpreter held */
+#define ACPI_DECODED_WRITES             0x02    /* Changes objects outside the invocation */
+
+
 /* Parse object flags */
 
 #define ACPI_PARSEOP_GENERIC                0x01
@@ -288,13 +288,24 @@ AcpiNsLookup (
     ACPI_WALK_STATE         *WalkState,
     ACPI_NAMESPACE_NODE     **RetNode);
 
+ACPI_STATUS
+AcpiNsLookupMethodName (
+    ACPI_WALK_STATE         *WalkState,
+    char                    *AmlPath,
+    ACPI_NAMESPACE_NODE     **RetNode);
+
+void
+AcpiNsDeleteMethodCache (
+    ACPI_OPERAND_OBJECT     *MethodDesc);
+
 
 /*
  * nsalloc - Named object allocation/deallocation
  */
 ACPI_NAMESPACE_NODE *
 AcpiNsCreateNode (
-    UINT32                  Name);
+    UINT32                  Name,
+    ACPI_OWNER_ID           OwnerId);
 
 void
 AcpiNsDeleteNode (
@@ -312,6 +323,10 @@ void
 AcpiNsDeleteNamespaceByOwner (
     ACPI_OWNER_ID           OwnerId);
 
+void
+AcpiNsDeleteNodeArenas (
+    void);
+
 void
 AcpiNsDetachObject (
     ACPI_NAMESPACE_NODE     *Node);
@@ -420,6 +435,38 @@ AcpiNsEvaluate (
     ACPI_EVALUATE_INFO      *Info);
 
 
+/*
+ * nsidmap - Map of device IDs to device nodes
+ */
+ACPI_STATUS
+AcpiNsMatchDeviceId (
+    ACPI_NAMESPACE_NODE     *Node,
+    const char              *Id,
+    BOOLEAN                 *Match);
+
+ACPI_STATUS
+AcpiNsGetDeviceIdMap (
+    ACPI_NS_ID_MAP          **ReturnMap);
+
+void
+AcpiNsReleaseDeviceIdMap (
+    ACPI_NS_ID_MAP          *Map);
+
+ACPI_STATUS
+AcpiNsWalkDeviceIdMap (
+    ACPI_NS_ID_MAP          *Map,
+    ACPI_GET_DEVICES_INFO   *Info,
+    void                    **ReturnValue);
+
+void
+AcpiNsDeleteDeviceIdMap (
+    void);
+
+void
+AcpiNsInvalidateDeviceIdMap (
+    void);
+
+
 /*
  * nsarguments - Argument count/type checking for predefined/reserved names
  */
@@ -528,6 +575,14 @@ AcpiNsGetNodeUnlocked (
     UINT32                  Flags,
     ACPI_NAMESPACE_NODE     **OutNode);
 
+void
+AcpiNsInvalidatePathCache (
+    void);
+
+void
+AcpiNsDeletePathCache (
+    void);
+
 ACPI_STATUS
 AcpiNsGetNode (
     ACPI_NAMESPACE_NODE     *PrefixNode,
@@ -645,6 +700,25 @@ AcpiNsInstallNode (
     ACPI_NAMESPACE_NODE     *Node,
     ACPI_OBJECT_TYPE        Type);
 
+ACPI_STATUS
+AcpiNsBuildScopeIndex (
+    ACPI_NAMESPACE_NODE     *ParentNode);
+
+void
+AcpiNsIndexInsertNode (
+    ACPI_NAMESPACE_NODE     *ParentNode,
+    ACPI_NAMESPACE_NODE     *Node);
+
+void
+AcpiNsIndexRemoveNode (
+    ACPI_NAMESPACE_NODE     *ParentNode,
+    ACPI_NAMESPACE_NODE     *Node,
+    ACPI_NAMESPACE_NODE     *PrevNode);
+
+void
+AcpiNsDeleteScopeIndex (
+    ACPI_NAMESPACE_NODE     *ParentNode);
+
 
 /*
  * nsutils - Utility functions
@@ -206,6 +206,7 @@
 #define AOPOBJ_REG_CONNECTED        0x10    /* _REG was run */
 #define AOPOBJ_SETUP_COMPLETE       0x20    /* Region setup is complete */
 #define AOPOBJ_INVALID              0x40    /* Host OS won't allow a Region address */
+#define AOPOBJ_DEVICE_ID            0x80    /* Value is held by the device ID map */
 
 
 /******************************************************************************
@@ -321,7 +322,7 @@ typedef struct acpi_object_region
 typedef struct acpi_object_method
 {
     ACPI_OBJECT_COMMON_HEADER;
-    UINT8                           InfoFlags;
+    UINT16                          InfoFlags;
     UINT8                           ParamCount;
     UINT8                           SyncLevel;
     union acpi_operand_object       *Mutex;
@@ -336,6 +337,9 @@ typedef struct acpi_object_method
     UINT32                          AmlLength;
     ACPI_OWNER_ID                   OwnerId;
     UINT8                           ThreadCount;
+    struct acpi_method_name_cache   *NameCache;     /* Resolved name references */
+    struct acpi_decoded_method      *Decoded;       /* Pre-decoded form (psdecode.c) */
+    union acpi_operand_object       *ResultCache;   /* Memoized return value (pure methods) */
 
 } ACPI_OBJECT_METHOD;
 
@@ -347,6 +351,9 @@ typedef struct acpi_object_method
 #define ACPI_METHOD_SERIALIZED_PENDING  0x08    /* Method is to be marked serialized */
 #define ACPI_METHOD_IGNORE_SYNC_LEVEL   0x10    /* Method was auto-serialized at table load time */
 #define ACPI_METHOD_MODIFIED_NAMESPACE  0x20    /* Method modified the namespace */
+#define ACPI_METHOD_NOT_DECODABLE       0x40    /* Method has no pre-decoded form */
+#define ACPI_METHOD_PURE                0x80    /* Method result depends only on its AML */
+#define ACPI_METHOD_PARALLEL            0x100   /* Method may run under the shared interpreter */
 
 
 /******************************************************************************
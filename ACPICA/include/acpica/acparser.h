@@ -180,8 +180,27 @@
  *
  *****************************************************************************/
 
-extern const UINT8      AcpiGbl_ShortOpIndex[];
-extern const UINT8      AcpiGbl_LongOpIndex[];
+/*
+ * Slots in the flat opcode index table (AcpiGbl_AmlOpIndex). One-byte
+ * opcodes map to 0x000-0x0FF, extended (0x5B) opcodes to 0x100-0x1FF.
+ * Any other 16-bit value maps to a slot that is never assigned.
+ */
+#define ACPI_NUM_OPCODE_SLOTS           0x200
+#define ACPI_UNKNOWN_OPCODE_SLOT        0x1FF
+
+#define ACPI_OPCODE_SLOT(Opcode) \
+    (((Opcode) <= 0x00FF) ? (Opcode) : \
+    ((((Opcode) & 0xFF00) == AML_EXTENDED_OPCODE) ? \
+        (0x0100 | ((Opcode) & 0x00FF)) : ACPI_UNKNOWN_OPCODE_SLOT))
+
+extern const UINT8      AcpiGbl_AmlOpIndex[];
+
+/*
+ * Opcode info lookup for the parser hot paths. Same result as
+ * AcpiPsGetOpcodeInfo, without the call.
+ */
+#define ACPI_GET_OPCODE_INFO(Opcode) \
+    (&AcpiGbl_AmlOpInfo [AcpiGbl_AmlOpIndex [ACPI_OPCODE_SLOT (Opcode)]])
 
 
 /*
@@ -196,6 +215,18 @@ AcpiPsExecuteTable (
     ACPI_EVALUATE_INFO      *Info);
 
 
+/*
+ * psdecode - Pre-decoded method execution
+ */
+ACPI_STATUS
+AcpiPsExecuteDecodedMethod (
+    ACPI_EVALUATE_INFO      *Info);
+
+void
+AcpiPsDeleteDecodedMethod (
+    ACPI_DECODED_METHOD     *Method);
+
+
 /*
  * psargs - Parse AML opcode arguments
  */
@@ -370,6 +370,65 @@ ACPI_INIT_GLOBAL (BOOLEAN,          AcpiGbl_UseGlobalLock, TRUE);
  */
 ACPI_INIT_GLOBAL (UINT32,           AcpiGbl_MaxLoopIterations, ACPI_MAX_LOOP_TIMEOUT);
 
+/*
+ * Number of children at which a namespace scope gets a hashed child index
+ * for constant-time name lookup. Zero disables the index entirely.
+ */
+ACPI_INIT_GLOBAL (UINT32,           AcpiGbl_NamespaceIndexThreshold, ACPI_NS_INDEX_THRESHOLD);
+
+/*
+ * Cache the results of absolute pathname lookups (AcpiGetHandle,
+ * AcpiEvaluateObject with a "\\" path). Entries are invalidated in bulk
+ * whenever a permanent namespace node is created or deleted.
+ */
+ACPI_INIT_GLOBAL (UINT8,            AcpiGbl_EnableNamespacePathCache, TRUE);
+
+/*
+ * Number of threads that run _STA/_INI for independent device subtrees
+ * during AcpiInitializeObjects, dispatched through AcpiOsExecute. Values
+ * below 2 keep the single serial walk. When enabled, a handler installed
+ * by AcpiInstallInitializationHandler may be called from several threads.
+ */
+ACPI_INIT_GLOBAL (UINT32,           AcpiGbl_DeviceInitThreads, 0);
+
+/*
+ * Memory budget (bytes) for the per-method caches of resolved name
+ * references. Least recently used caches are dropped to stay within the
+ * budget. Zero disables the caches.
+ */
+ACPI_INIT_GLOBAL (UINT32,           AcpiGbl_MethodCacheBudget, ACPI_METHOD_CACHE_BUDGET);
+
+/*
+ * Execute control methods that only compute on integers (no namespace
+ * references, calls or buffers) from a pre-decoded instruction stream
+ * instead of parsing the AML on each invocation.
+ */
+ACPI_INIT_GLOBAL (UINT8,            AcpiGbl_EnableDecodedMethods, TRUE);
+
+/*
+ * Let NotSerialized methods that write nothing but Locals and field units
+ * and use no Mutex, Event or table opcodes run under a shared interpreter
+ * lock, several threads at once. Accesses to one operation region are
+ * still serialized, and anything else that modifies shared state takes
+ * the interpreter exclusive first. Off by default; the host turns it on
+ * before the tables load, since methods are classified as they load.
+ */
+ACPI_INIT_GLOBAL (UINT8,            AcpiGbl_ParallelMethods, FALSE);
+
+/*
+ * Memoize the return value of identification methods (_HID, _UID, _CID,
+ * _CLS, _ADR) that take no arguments and reference no namespace object,
+ * so that device enumeration does not re-run them on every query.
+ */
+ACPI_INIT_GLOBAL (UINT8,            AcpiGbl_MemoizePureMethods, TRUE);
+
+/*
+ * Answer AcpiGetDevices queries for a specific ID from a map of _HID/_CID
+ * strings to device nodes. The map is built on first use and rebuilt after
+ * the namespace changes.
+ */
+ACPI_INIT_GLOBAL (UINT8,            AcpiGbl_EnableDeviceIdMap, TRUE);
+
 /*
  * Optionally ignore AE_NOT_FOUND errors from named reference package elements
  * during DSDT/SSDT table loading. This reduces error "noise" in platforms
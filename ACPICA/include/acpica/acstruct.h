@@ -357,6 +357,69 @@ typedef struct acpi_device_walk_info
 } ACPI_DEVICE_WALK_INFO;
 
 
+/*
+ * Info used by the parallel form of AcpiNsInitializeDevices. Each item is
+ * a device subtree with no Device/Processor/Thermal ancestor other than
+ * \_SB, so items only need to be ordered against each other by _DEP. The
+ * devices of every item are listed in Nodes, in walk order, while the
+ * queue is built with the namespace locked; the workers only evaluate.
+ */
+#define ACPI_INIT_ITEM_PENDING          0
+#define ACPI_INIT_ITEM_RUNNING          1
+#define ACPI_INIT_ITEM_DONE             2
+
+typedef struct acpi_device_init_node
+{
+    ACPI_NAMESPACE_NODE             *Node;
+    UINT32                          SubtreeEnd;     /* Index just past its descendants */
+
+} ACPI_DEVICE_INIT_NODE;
+
+typedef struct acpi_device_init_item
+{
+    ACPI_NAMESPACE_NODE             *Node;          /* Root of the subtree */
+    UINT32                          FirstNode;      /* Entry for Node in Nodes */
+    UINT32                          PendingDeps;    /* Unfinished prerequisites */
+    UINT8                           State;
+    BOOLEAN                         UnderSb;        /* Gated by \_SB._STA */
+
+} ACPI_DEVICE_INIT_ITEM;
+
+typedef struct acpi_device_init_edge
+{
+    UINT32                          Prerequisite;   /* Item that must finish first */
+    UINT32                          Dependent;      /* Item that waits for it */
+
+} ACPI_DEVICE_INIT_EDGE;
+
+typedef struct acpi_device_init_queue
+{
+    ACPI_DEVICE_INIT_ITEM           *Items;
+    ACPI_DEVICE_INIT_EDGE           *Edges;
+    ACPI_DEVICE_INIT_NODE           *Nodes;
+    ACPI_NAMESPACE_NODE             **DepMethods;   /* _DEP methods, run once unlocked */
+    ACPI_NAMESPACE_NODE             *SbNode;
+    ACPI_MUTEX                      Lock;
+    ACPI_SEMAPHORE                  WorkSem;        /* Wakes workers waiting on _DEP */
+    ACPI_SEMAPHORE                  DoneSem;        /* Signalled as each worker exits */
+    ACPI_STATUS                     Status;         /* First failure, stops the queue */
+    UINT32                          ItemCount;
+    UINT32                          ItemSize;
+    UINT32                          EdgeCount;
+    UINT32                          EdgeSize;
+    UINT32                          NodeCount;
+    UINT32                          NodeSize;
+    UINT32                          DepMethodCount;
+    UINT32                          DepMethodSize;
+    UINT32                          Remaining;
+    UINT32                          Running;
+    UINT32                          Waiting;
+    UINT32                          Num_STA;
+    UINT32                          Num_INI;
+
+} ACPI_DEVICE_INIT_QUEUE;
+
+
 /* Info used by Acpi  AcpiDbDisplayFields */
 
 typedef struct acpi_region_walk_info
@@ -433,6 +433,19 @@ typedef UINT64                          ACPI_PHYSICAL_ADDRESS;
 #define ACPI_UNUSED_VAR
 #endif
 
+/*
+ * Pointers published to threads that read them without a lock. The plain
+ * defaults are only ordered on a uniprocessor; compiler headers for SMP
+ * hosts define release/acquire versions.
+ */
+#ifndef ACPI_STORE_RELEASE
+#define ACPI_STORE_RELEASE(Ptr, Value)  ((Ptr) = (Value))
+#endif
+
+#ifndef ACPI_LOAD_ACQUIRE
+#define ACPI_LOAD_ACQUIRE(Ptr)          (Ptr)
+#endif
+
 /*
  * All ACPICA external functions that are available to the rest of the
  * kernel are tagged with these macros which can be defined as appropriate
@@ -1128,6 +1128,10 @@ ACPI_STATUS
 AcpiUtAcquireMutex (
     ACPI_MUTEX_HANDLE       MutexId);
 
+ACPI_STATUS
+AcpiUtAcquireNamespaceForLookup (
+    void);
+
 ACPI_STATUS
 AcpiUtReleaseMutex (
     ACPI_MUTEX_HANDLE       MutexId);
@@ -42,12 +42,12 @@
 #include <mach/semaphore.h>
 #include <IOKit/IOLib.h>
 
-#define ACPI_USE_LOCAL_CACHE
-
 #define ACPI_USE_GPE_POLLING
 
-#define ACPI_SEMAPHORE semaphore_t
-#define ACPI_SPINLOCK IOSimpleLock *
+struct _acpi_os_semaphore;
+#define ACPI_SEMAPHORE struct _acpi_os_semaphore *  /* counting semaphore, see osdarwin.c */
+struct _acpi_os_lock;
+#define ACPI_SPINLOCK struct _acpi_os_lock *     /* ticket lock, see osdarwin.c */
 
 #define ACPI_USE_SYSTEM_CLIBRARY
 
@@ -196,6 +196,14 @@ typedef __builtin_va_list       va_list;
 
 #define ACPI_USE_NATIVE_MATH64
 
+/*
+ * Publish a pointer that other threads read without a lock, and read it:
+ * everything written before the store is visible to a thread whose load
+ * sees the new value.
+ */
+#define ACPI_STORE_RELEASE(Ptr, Value)  __atomic_store_n (&(Ptr), (Value), __ATOMIC_RELEASE)
+#define ACPI_LOAD_ACQUIRE(Ptr)          __atomic_load_n (&(Ptr), __ATOMIC_ACQUIRE)
+
 /* GCC did not support __has_attribute until 5.1. */
 
 #ifndef __has_attribute
@@ -648,6 +648,7 @@ AdReparseOneTable (
     AcpiGbl_RootNodeStruct.Parent       = NULL;
     AcpiGbl_RootNodeStruct.Child        = NULL;
     AcpiGbl_RootNodeStruct.Peer         = NULL;
+    AcpiGbl_RootNodeStruct.ChildIndex   = NULL;
     AcpiGbl_RootNodeStruct.Object       = NULL;
     AcpiGbl_RootNodeStruct.Flags        = 0;
 
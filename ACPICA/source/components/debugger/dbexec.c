@@ -963,6 +963,8 @@ AcpiDbCreateExecutionThreads (
     ACPI_MUTEX              MainThreadGate;
     ACPI_MUTEX              ThreadCompleteGate;
     ACPI_MUTEX              InfoGate;
+    UINT64                  Start;
+    UINT32                  Elapsed;
 
 
     /* Get the arguments */
@@ -1082,6 +1084,7 @@ AcpiDbCreateExecutionThreads (
     AcpiOsPrintf ("Creating %X threads to execute %X times each\n",
         NumThreads, NumLoops);
 
+    Start = AcpiOsGetTimer ();
     for (i = 0; i < (NumThreads); i++)
     {
         Status = AcpiOsExecute (OSL_DEBUGGER_EXEC_THREAD, AcpiDbMethodThread,
@@ -1095,11 +1098,22 @@ AcpiDbCreateExecutionThreads (
     /* Wait for all threads to complete */
 
     (void) AcpiOsWaitSemaphore (MainThreadGate, 1, ACPI_WAIT_FOREVER);
+    Elapsed = (UINT32) (AcpiOsGetTimer () - Start);
 
     AcpiDbSetOutputDestination (ACPI_DB_DUPLICATE_OUTPUT);
     AcpiOsPrintf ("All threads (%X) have completed\n", NumThreads);
     AcpiDbSetOutputDestination (ACPI_DB_CONSOLE_OUTPUT);
 
+    /* Throughput, for comparing runs with different thread counts */
+
+    if (Elapsed)
+    {
+        AcpiOsPrintf ("%u evaluations in %u.%03u ms, %u evaluations/sec\n",
+            NumThreads * NumLoops, Elapsed / 10000, (Elapsed / 10) % 1000,
+            (UINT32) (((UINT64) NumThreads * NumLoops *
+                ACPI_100NSEC_PER_SEC) / Elapsed));
+    }
+
 CleanupAndExit:
 
     /* Cleanup and exit */
@@ -429,9 +429,15 @@ static const ACPI_DB_COMMAND_HELP   AcpiGbl_DbCommandHelp[] =
     {1, "     Disable",                         "Disable tracing\n"},
     {1, "     Method",                          "Enable method execution messages\n"},
     {1, "     Opcode",                          "Enable opcode execution messages\n"},
-    {3, "  Test <TestName>",                    "Invoke a debug test\n"},
+    {7, "  Test <TestName>",                    "Invoke a debug test\n"},
     {1, "     Objects",                         "Read/write/compare all namespace data objects\n"},
     {1, "     Predefined",                      "Validate all ACPI predefined names (_STA, etc.)\n"},
+    {1, "     Namespace [Count]",               "Benchmark lookups in a wide synthetic scope\n"},
+    {1, "     MethodCache [Count]",             "Benchmark _STA evaluation with the name cache\n"},
+    {1, "     AmlBench [Count]",                "Benchmark integer methods, interpreted vs. decoded\n"},
+    {1, "     DeviceMap [Count]",               "Benchmark AcpiGetDevices by ID on synthetic devices\n"},
+    {1, "     Semaphores [Count]",              "Benchmark semaphore acquire/release on 1-64 threads\n"},
+    {1, "     Timer [Count]",                   "Benchmark AcpiOsGetTimer and a timed AML While loop\n"},
     {1, "  Execute predefined",                 "Execute all predefined (public) methods\n"},
 
     {0, "\nControl Method Single-Step Execution:","\n"},
@@ -1353,7 +1359,7 @@ AcpiDbCommandDispatch (
 
     case CMD_TEST:
 
-        AcpiDbExecuteTest (AcpiGbl_DbArgs[1]);
+        AcpiDbExecuteTest (AcpiGbl_DbArgs[1], AcpiGbl_DbArgs[2]);
         break;
 
     case CMD_UNLOAD:
@@ -506,6 +506,7 @@ ACPI_STATUS
 AcpiDbDisplayStatistics (
     char                    *TypeArg)
 {
+    ACPI_NS_NODE_ARENA      *Arena;
     UINT32                  i;
     UINT32                  Temp;
 
@@ -572,6 +573,16 @@ AcpiDbDisplayStatistics (
         AcpiDbListInfo (AcpiGbl_StateCache);
 #endif
 
+        AcpiOsPrintf ("\n----Node Arena Statistics-----------------\n");
+        AcpiOsPrintf ("%8.8s %8.8s %10.10s %10.10s\n",
+            "OWNER", "SLABS", "LIVE", "BYTES");
+
+        for (Arena = AcpiGbl_NsNodeArenas; Arena; Arena = Arena->Next)
+        {
+            AcpiOsPrintf ("%8.3X %8u %10u %10u\n", Arena->OwnerId,
+                Arena->SlabCount, Arena->LiveNodes,
+                Arena->SlabCount * (UINT32) sizeof (ACPI_NS_NODE_SLAB));
+        }
         break;
 
     case CMD_STAT_MISC:
@@ -581,6 +592,18 @@ AcpiDbDisplayStatistics (
             AcpiGbl_PsFindCount);
         AcpiOsPrintf ("%-28s:       %7u\n", "Calls to AcpiNsLookup",
             AcpiGbl_NsLookupCount);
+        AcpiOsPrintf ("%-28s:       %7u\n", "Path cache hits",
+            AcpiGbl_NsPathCacheHits);
+        AcpiOsPrintf ("%-28s:       %7u\n", "Path cache misses",
+            AcpiGbl_NsPathCacheMisses);
+        AcpiOsPrintf ("%-28s:       %7u\n", "Method name cache hits",
+            AcpiGbl_MethodCacheHits);
+        AcpiOsPrintf ("%-28s:       %7u\n", "Method name cache misses",
+            AcpiGbl_MethodCacheMisses);
+        AcpiOsPrintf ("%-28s:       %7u\n", "Method name cache bytes",
+            AcpiGbl_MethodCacheBytes);
+        AcpiOsPrintf ("%-28s:       %7u\n", "Method name cache evictions",
+            AcpiGbl_MethodCacheEvictions);
 
         AcpiOsPrintf ("\nMutex usage:\n\n");
         for (i = 0; i < ACPI_NUM_MUTEX; i++)
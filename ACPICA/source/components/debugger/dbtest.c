@@ -219,6 +219,92 @@ AcpiDbEvaluateOnePredefinedName (
     void                    *Context,
     void                    **ReturnValue);
 
+static void
+AcpiDbTestNamespaceLookup (
+    char                    *CountArg);
+
+static UINT32
+AcpiDbTestMakeName (
+    UINT32                  Index);
+
+static UINT32
+AcpiDbTestTimeLookups (
+    ACPI_NAMESPACE_NODE     *ScopeNode,
+    UINT32                  NodeCount,
+    UINT32                  LookupCount);
+
+static void
+AcpiDbTestMethodCache (
+    char                    *CountArg);
+
+static UINT32
+AcpiDbTestTimeMethods (
+    UINT32                  Iterations,
+    UINT32                  *MethodCount);
+
+static ACPI_STATUS
+AcpiDbTestEvaluateOneMethod (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static void
+AcpiDbTestAmlBench (
+    char                    *CountArg);
+
+static UINT32
+AcpiDbTestTimeAmlMethod (
+    ACPI_HANDLE             Handle,
+    UINT64                  Value,
+    UINT32                  Iterations,
+    UINT64                  *Result);
+
+static void
+AcpiDbTestDeviceIdMap (
+    char                    *CountArg);
+
+static void
+AcpiDbTestMakeId (
+    char                    *Id,
+    UINT32                  Index);
+
+static ACPI_STATUS
+AcpiDbTestAddIdObject (
+    ACPI_NAMESPACE_NODE     *DeviceNode,
+    const char              *Name,
+    const char              *Id);
+
+static UINT32
+AcpiDbTestTimeGetDevices (
+    UINT32                  FirstId,
+    UINT32                  QueryCount,
+    UINT32                  *Matches);
+
+static ACPI_STATUS
+AcpiDbTestCountDevice (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static void
+AcpiDbTestSemaphores (
+    char                    *CountArg);
+
+static UINT32
+AcpiDbTestTimeSemaphore (
+    UINT32                  ThreadCount,
+    UINT32                  Iterations);
+
+static void ACPI_SYSTEM_XFACE
+AcpiDbTestSemaphoreThread (
+    void                    *Context);
+
+static void
+AcpiDbTestTimer (
+    char                    *CountArg);
+
 /*
  * Test subcommands
  */
@@ -226,11 +312,23 @@ static ACPI_DB_ARGUMENT_INFO    AcpiDbTestTypes [] =
 {
     {"OBJECTS"},
     {"PREDEFINED"},
+    {"NAMESPACE"},
+    {"METHODCACHE"},
+    {"AMLBENCH"},
+    {"DEVICEMAP"},
+    {"SEMAPHORES"},
+    {"TIMER"},
     {NULL}           /* Must be null terminated */
 };
 
 #define CMD_TEST_OBJECTS        0
 #define CMD_TEST_PREDEFINED     1
+#define CMD_TEST_NAMESPACE      2
+#define CMD_TEST_METHODCACHE    3
+#define CMD_TEST_AMLBENCH       4
+#define CMD_TEST_DEVICEMAP      5
+#define CMD_TEST_SEMAPHORES     6
+#define CMD_TEST_TIMER          7
 
 #define BUFFER_FILL_VALUE       0xFF
 
@@ -285,12 +383,203 @@ static unsigned char WriteMethodCode[] =
     0x39,0x39,0x02,0x70,0x69,0x68             /* 00000028    "99.pih"   */
 };
 
+/*
+ * Integer-only benchmark methods for the AMLBENCH subcommand. Each one
+ * is evaluated with the pre-decoded method engine disabled and enabled.
+ */
+#if 0
+DefinitionBlock ("ssdt3.aml", "SSDT", 2, "Intel", "DEBUG", 0x00000001)
+{
+    Method (\_T90, 1, NotSerialized)    /* Population count */
+    {
+        Store (Zero, Local0)
+        Store (Arg0, Local1)
+        While (Local1)
+        {
+            Add (Local0, And (Local1, One), Local0)
+            ShiftRight (Local1, One, Local1)
+        }
+        Return (Local0)
+    }
+}
+DefinitionBlock ("ssdt4.aml", "SSDT", 2, "Intel", "DEBUG", 0x00000001)
+{
+    Method (\_T91, 1, NotSerialized)    /* Bitwise CRC-32 of Arg0 */
+    {
+        Store (0xFFFFFFFF, Local0)
+        Store (Zero, Local1)
+        While (LLess (Local1, 64))
+        {
+            Store (And (Xor (Local0, ShiftRight (Arg0, Local1)), One), Local2)
+            ShiftRight (Local0, One, Local0)
+            If (Local2)
+            {
+                Xor (Local0, 0xEDB88320, Local0)
+            }
+            Increment (Local1)
+        }
+        Return (Xor (Local0, 0xFFFFFFFF))
+    }
+}
+DefinitionBlock ("ssdt5.aml", "SSDT", 2, "Intel", "DEBUG", 0x00000001)
+{
+    Method (\_T92, 1, NotSerialized)    /* Integer square root */
+    {
+        If (LLess (Arg0, 2))
+        {
+            Return (Arg0)
+        }
+        Store (Arg0, Local0)
+        Store (ShiftRight (Add (Arg0, One), One), Local1)
+        While (LLess (Local1, Local0))
+        {
+            Store (Local1, Local0)
+            Divide (Arg0, Local0, , Local2)
+            ShiftRight (Add (Local0, Local2), One, Local1)
+        }
+        Return (Local0)
+    }
+}
+DefinitionBlock ("ssdt6.aml", "SSDT", 2, "Intel", "DEBUG", 0x00000001)
+{
+    Method (\_T93, 1, NotSerialized)    /* Flag mask merge */
+    {
+        Store (And (Arg0, 0x1F), Local0)
+        Store (Zero, Local1)
+        Store (Zero, Local2)
+        While (LLess (Local1, 32))
+        {
+            If (And (Arg0, ShiftLeft (One, Local1)))
+            {
+                If (LNot (And (Local0, ShiftLeft (One, Local1))))
+                {
+                    Or (Local2, ShiftLeft (One, Local1), Local2)
+                }
+            }
+            Increment (Local1)
+        }
+        Return (Or (ShiftLeft (Local2, 32), Local0))
+    }
+}
+#endif
+
+static unsigned char _T90MethodCode[] =
+{
+    0x53,0x53,0x44,0x54,0x42,0x00,0x00,0x00,  /* 00000000    "SSDTB..." */
+    0x02,0xCF,0x49,0x6E,0x74,0x65,0x6C,0x00,  /* 00000008    "..Intel." */
+    0x44,0x45,0x42,0x55,0x47,0x00,0x00,0x00,  /* 00000010    "DEBUG..." */
+    0x01,0x00,0x00,0x00,0x49,0x4E,0x54,0x4C,  /* 00000018    "....INTL" */
+    0x01,0x00,0x00,0x00,0x14,0x1D,0x5C,0x5F,  /* 00000020    "......\_" */
+    0x54,0x39,0x30,0x01,0x70,0x00,0x60,0x70,  /* 00000028    "T90.p.`p" */
+    0x68,0x61,0xA2,0x0D,0x61,0x72,0x60,0x7B,  /* 00000030    "ha..ar`{" */
+    0x61,0x01,0x00,0x60,0x7A,0x61,0x01,0x61,  /* 00000038    "a..`za.a" */
+    0xA4,0x60                                 /* 00000040    ".`" */
+};
+
+static unsigned char _T91MethodCode[] =
+{
+    0x53,0x53,0x44,0x54,0x62,0x00,0x00,0x00,  /* 00000000    "SSDTb..." */
+    0x02,0x9F,0x49,0x6E,0x74,0x65,0x6C,0x00,  /* 00000008    "..Intel." */
+    0x44,0x45,0x42,0x55,0x47,0x00,0x00,0x00,  /* 00000010    "DEBUG..." */
+    0x01,0x00,0x00,0x00,0x49,0x4E,0x54,0x4C,  /* 00000018    "....INTL" */
+    0x01,0x00,0x00,0x00,0x14,0x3D,0x5C,0x5F,  /* 00000020    ".....=\_" */
+    0x54,0x39,0x31,0x01,0x70,0x0C,0xFF,0xFF,  /* 00000028    "T91.p..." */
+    0xFF,0xFF,0x60,0x70,0x00,0x61,0xA2,0x22,  /* 00000030    "..`p.a.." */
+    0x95,0x61,0x0A,0x40,0x70,0x7B,0x7F,0x60,  /* 00000038    ".a.@p{.`" */
+    0x7A,0x68,0x61,0x00,0x00,0x01,0x00,0x62,  /* 00000040    "zha....b" */
+    0x7A,0x60,0x01,0x60,0xA0,0x0A,0x62,0x7F,  /* 00000048    "z`.`..b." */
+    0x60,0x0C,0x20,0x83,0xB8,0xED,0x60,0x75,  /* 00000050    "`. ...`u" */
+    0x61,0xA4,0x7F,0x60,0x0C,0xFF,0xFF,0xFF,  /* 00000058    "a..`...." */
+    0xFF,0x00                                 /* 00000060    ".." */
+};
+
+static unsigned char _T92MethodCode[] =
+{
+    0x53,0x53,0x44,0x54,0x56,0x00,0x00,0x00,  /* 00000000    "SSDTV..." */
+    0x02,0x01,0x49,0x6E,0x74,0x65,0x6C,0x00,  /* 00000008    "..Intel." */
+    0x44,0x45,0x42,0x55,0x47,0x00,0x00,0x00,  /* 00000010    "DEBUG..." */
+    0x01,0x00,0x00,0x00,0x49,0x4E,0x54,0x4C,  /* 00000018    "....INTL" */
+    0x01,0x00,0x00,0x00,0x14,0x31,0x5C,0x5F,  /* 00000020    ".....1\_" */
+    0x54,0x39,0x32,0x01,0xA0,0x07,0x95,0x68,  /* 00000028    "T92....h" */
+    0x0A,0x02,0xA4,0x68,0x70,0x68,0x60,0x70,  /* 00000030    "...hph`p" */
+    0x7A,0x72,0x68,0x01,0x00,0x01,0x00,0x61,  /* 00000038    "zrh....a" */
+    0xA2,0x13,0x95,0x61,0x60,0x70,0x61,0x60,  /* 00000040    "...a`pa`" */
+    0x78,0x68,0x60,0x00,0x62,0x7A,0x72,0x60,  /* 00000048    "xh`.bzr`" */
+    0x62,0x00,0x01,0x61,0xA4,0x60             /* 00000050    "b..a.`" */
+};
+
+static unsigned char _T93MethodCode[] =
+{
+    0x53,0x53,0x44,0x54,0x64,0x00,0x00,0x00,  /* 00000000    "SSDTd..." */
+    0x02,0xA8,0x49,0x6E,0x74,0x65,0x6C,0x00,  /* 00000008    "..Intel." */
+    0x44,0x45,0x42,0x55,0x47,0x00,0x00,0x00,  /* 00000010    "DEBUG..." */
+    0x01,0x00,0x00,0x00,0x49,0x4E,0x54,0x4C,  /* 00000018    "....INTL" */
+    0x01,0x00,0x00,0x00,0x14,0x3F,0x5C,0x5F,  /* 00000020    ".....?\_" */
+    0x54,0x39,0x33,0x01,0x70,0x7B,0x68,0x0A,  /* 00000028    "T93.p{h." */
+    0x1F,0x00,0x60,0x70,0x00,0x61,0x70,0x00,  /* 00000030    "..`p.ap." */
+    0x62,0xA2,0x21,0x95,0x61,0x0A,0x20,0xA0,  /* 00000038    "b.!.a. ." */
+    0x19,0x7B,0x68,0x79,0x01,0x61,0x00,0x00,  /* 00000040    ".{hy.a.." */
+    0xA0,0x10,0x92,0x7B,0x60,0x79,0x01,0x61,  /* 00000048    "...{`y.a" */
+    0x00,0x00,0x7D,0x62,0x79,0x01,0x61,0x00,  /* 00000050    "..}by.a." */
+    0x62,0x75,0x61,0xA4,0x7D,0x79,0x62,0x0A,  /* 00000058    "bua.}yb." */
+    0x20,0x00,0x60,0x00                       /* 00000060    " .`." */
+};
+
+/*
+ * While loop for the TIMER subcommand. Every iteration of it is mostly
+ * the interpreter's loop timeout check, which reads AcpiOsGetTimer.
+ */
+#if 0
+DefinitionBlock ("ssdt7.aml", "SSDT", 2, "Intel", "DEBUG", 0x00000001)
+{
+    Method (\_T94, 1, NotSerialized)    /* Count to Arg0 */
+    {
+        Store (Zero, Local0)
+        While (LLess (Local0, Arg0))
+        {
+            Increment (Local0)
+        }
+        Return (Local0)
+    }
+}
+#endif
+
+static unsigned char _T94MethodCode[] =
+{
+    0x53,0x53,0x44,0x54,0x38,0x00,0x00,0x00,  /* 00000000    "SSDT8..." */
+    0x02,0x9A,0x49,0x6E,0x74,0x65,0x6C,0x00,  /* 00000008    "..Intel." */
+    0x44,0x45,0x42,0x55,0x47,0x00,0x00,0x00,  /* 00000010    "DEBUG..." */
+    0x01,0x00,0x00,0x00,0x49,0x4E,0x54,0x4C,  /* 00000018    "....INTL" */
+    0x01,0x00,0x00,0x00,0x14,0x13,0x5C,0x5F,  /* 00000020    "......\_" */
+    0x54,0x39,0x34,0x01,0x70,0x00,0x60,0xA2,  /* 00000028    "T94.p.`." */
+    0x06,0x95,0x60,0x68,0x75,0x60,0xA4,0x60   /* 00000030    "..`hu`.`" */
+};
+
+typedef struct acpi_db_aml_bench
+{
+    char                    *Pathname;
+    unsigned char           *Code;
+    UINT64                  Argument;
+    ACPI_HANDLE             Handle;
+
+} ACPI_DB_AML_BENCH;
+
+static ACPI_DB_AML_BENCH    AcpiDbAmlBenchMethods[] =
+{
+    {"\\_T90", _T90MethodCode, 0x0F0F0F0F0F0F0F0F,     NULL},
+    {"\\_T91", _T91MethodCode, 0x0123456789ABCDEF,     NULL},
+    {"\\_T92", _T92MethodCode, 0x000000E8D4A52B58,     NULL},
+    {"\\_T93", _T93MethodCode, 0x35,                   NULL},
+    {NULL,      NULL,           0,                      NULL}
+};
+
 
 /*******************************************************************************
  *
  * FUNCTION:    AcpiDbExecuteTest
  *
  * PARAMETERS:  TypeArg         - Subcommand
+ *              CountArg        - Optional count for the subcommand
  *
  * RETURN:      None
  *
@@ -302,7 +591,8 @@ static unsigned char WriteMethodCode[] =
 
 void
 AcpiDbExecuteTest (
-    char                    *TypeArg)
+    char                    *TypeArg,
+    char                    *CountArg)
 {
     UINT32                  Temp;
 
@@ -327,6 +617,36 @@ AcpiDbExecuteTest (
         AcpiDbEvaluateAllPredefinedNames (NULL);
         break;
 
+    case CMD_TEST_NAMESPACE:
+
+        AcpiDbTestNamespaceLookup (CountArg);
+        break;
+
+    case CMD_TEST_METHODCACHE:
+
+        AcpiDbTestMethodCache (CountArg);
+        break;
+
+    case CMD_TEST_AMLBENCH:
+
+        AcpiDbTestAmlBench (CountArg);
+        break;
+
+    case CMD_TEST_DEVICEMAP:
+
+        AcpiDbTestDeviceIdMap (CountArg);
+        break;
+
+    case CMD_TEST_SEMAPHORES:
+
+        AcpiDbTestSemaphores (CountArg);
+        break;
+
+    case CMD_TEST_TIMER:
+
+        AcpiDbTestTimer (CountArg);
+        break;
+
     default:
         break;
     }
@@ -1338,3 +1658,1217 @@ AcpiDbEvaluateOnePredefinedName (
 
     return (Status);
 }
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestNamespaceLookup
+ *
+ * PARAMETERS:  CountArg            - Number of synthetic nodes (default 50000)
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: This test implements the NAMESPACE subcommand. It builds one
+ *              very wide synthetic scope and compares the throughput of
+ *              AcpiNsSearchOneScope with and without the hashed child index.
+ *              The scope is deleted again when the test completes.
+ *
+ ******************************************************************************/
+
+#define ACPI_DB_NS_TEST_SCOPE       "_T97"
+#define ACPI_DB_NS_TEST_NODES       50000
+#define ACPI_DB_NS_LINEAR_LOOKUPS   1000
+
+static void
+AcpiDbTestNamespaceLookup (
+    char                    *CountArg)
+{
+    ACPI_NAMESPACE_NODE     *ScopeNode;
+    ACPI_NAMESPACE_NODE     *Node;
+    ACPI_NAME_UNION         ScopeName;
+    ACPI_STATUS             Status;
+    UINT32                  NodeCount = ACPI_DB_NS_TEST_NODES;
+    UINT32                  LinearLookups;
+    UINT32                  Threshold;
+    UINT32                  Elapsed;
+    UINT32                  i;
+
+
+    if (CountArg)
+    {
+        NodeCount = strtoul (CountArg, NULL, 0);
+    }
+
+    if (!NodeCount)
+    {
+        AcpiOsPrintf ("Node count must be non-zero\n");
+        return;
+    }
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_FAILURE (Status))
+    {
+        return;
+    }
+
+    ACPI_COPY_NAMESEG (ScopeName.Ascii, ACPI_DB_NS_TEST_SCOPE);
+    ScopeNode = AcpiNsCreateNode (ScopeName.Integer, 0);
+    if (!ScopeNode)
+    {
+        (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+        return;
+    }
+
+    AcpiNsInstallNode (NULL, AcpiGbl_RootNode, ScopeNode,
+        ACPI_TYPE_LOCAL_SCOPE);
+
+    /* Populate the scope; this also exercises incremental index upkeep */
+
+    Elapsed = (UINT32) AcpiOsGetTimer ();
+    for (i = 0; i < NodeCount; i++)
+    {
+        Node = AcpiNsCreateNode (AcpiDbTestMakeName (i), 0);
+        if (!Node)
+        {
+            AcpiOsPrintf ("Could not allocate node %u\n", i);
+            NodeCount = i;
+            break;
+        }
+
+        AcpiNsInstallNode (NULL, ScopeNode, Node, ACPI_TYPE_ANY);
+    }
+
+    Elapsed = (UINT32) AcpiOsGetTimer () - Elapsed;
+    AcpiOsPrintf ("Installed %u nodes under \\%s in %u.%03u ms (%s)\n",
+        NodeCount, ACPI_DB_NS_TEST_SCOPE, Elapsed / 10000,
+        (Elapsed / 10) % 1000, ScopeNode->ChildIndex ? "indexed" : "linear");
+
+    if (NodeCount)
+    {
+        /* Hashed lookups over every node */
+
+        if (ScopeNode->ChildIndex)
+        {
+            Elapsed = AcpiDbTestTimeLookups (ScopeNode, NodeCount, NodeCount);
+            AcpiOsPrintf ("  Indexed: %u lookups in %u.%03u ms, %u ns/lookup\n",
+                NodeCount, Elapsed / 10000, (Elapsed / 10) % 1000,
+                (UINT32) (((UINT64) Elapsed * 100) / NodeCount));
+        }
+
+        /*
+         * Linear lookups over a sample of the nodes, with the index
+         * temporarily removed. A full pass is quadratic in NodeCount.
+         */
+        Threshold = AcpiGbl_NamespaceIndexThreshold;
+        AcpiGbl_NamespaceIndexThreshold = 0;
+        AcpiNsDeleteScopeIndex (ScopeNode);
+
+        LinearLookups = ACPI_MIN (NodeCount, ACPI_DB_NS_LINEAR_LOOKUPS);
+        Elapsed = AcpiDbTestTimeLookups (ScopeNode, NodeCount, LinearLookups);
+        AcpiOsPrintf ("  Linear:  %u lookups in %u.%03u ms, %u ns/lookup\n",
+            LinearLookups, Elapsed / 10000, (Elapsed / 10) % 1000,
+            (UINT32) (((UINT64) Elapsed * 100) / LinearLookups));
+
+        AcpiGbl_NamespaceIndexThreshold = Threshold;
+    }
+
+    (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+
+    /* Delete the synthetic scope and everything below it */
+
+    AcpiNsDeleteNamespaceSubtree (ScopeNode);
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_SUCCESS (Status))
+    {
+        AcpiNsRemoveNode (ScopeNode);
+        (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestMakeName
+ *
+ * PARAMETERS:  Index               - Ordinal of a synthetic node
+ *
+ * RETURN:      A unique, valid ACPI name for the ordinal
+ *
+ * DESCRIPTION: Encode an ordinal as a four-character ACPI name. The leading
+ *              character is always alphabetic.
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiDbTestMakeName (
+    UINT32                  Index)
+{
+    static const char       Chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    ACPI_NAME_UNION         Name;
+    UINT32                  i;
+
+
+    for (i = 3; i > 0; i--)
+    {
+        Name.Ascii[i] = Chars[Index % 36];
+        Index /= 36;
+    }
+
+    Name.Ascii[0] = (char) ('A' + (Index % 26));
+    return (Name.Integer);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestTimeLookups
+ *
+ * PARAMETERS:  ScopeNode           - Synthetic scope to search
+ *              NodeCount           - Number of children in the scope
+ *              LookupCount         - Number of lookups to perform
+ *
+ * RETURN:      Elapsed time in 100 nanosecond units
+ *
+ * DESCRIPTION: Look up LookupCount children of ScopeNode, visiting them in
+ *              a scattered order so that position in the peer list does not
+ *              favour either search strategy.
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiDbTestTimeLookups (
+    ACPI_NAMESPACE_NODE     *ScopeNode,
+    UINT32                  NodeCount,
+    UINT32                  LookupCount)
+{
+    ACPI_NAMESPACE_NODE     *Node;
+    UINT64                  Start;
+    UINT32                  Misses = 0;
+    UINT32                  i;
+
+
+    Start = AcpiOsGetTimer ();
+    for (i = 0; i < LookupCount; i++)
+    {
+        if (ACPI_FAILURE (AcpiNsSearchOneScope (
+            AcpiDbTestMakeName ((UINT32) (((UINT64) i * 7919) % NodeCount)),
+            ScopeNode, ACPI_TYPE_ANY, &Node)))
+        {
+            Misses++;
+        }
+    }
+
+    Start = AcpiOsGetTimer () - Start;
+    if (Misses)
+    {
+        AcpiOsPrintf ("  %u lookups failed\n", Misses);
+    }
+
+    return ((UINT32) Start);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestMethodCache
+ *
+ * PARAMETERS:  CountArg            - Evaluations per method (default 100)
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: This test implements the METHODCACHE subcommand. It evaluates
+ *              every _STA control method in the namespace repeatedly, first
+ *              with the per-method name cache disabled and then enabled, and
+ *              reports the time per evaluation for both runs.
+ *
+ ******************************************************************************/
+
+#define ACPI_DB_METHOD_CACHE_ITERATIONS     100
+
+static void
+AcpiDbTestMethodCache (
+    char                    *CountArg)
+{
+    UINT32                  Iterations = ACPI_DB_METHOD_CACHE_ITERATIONS;
+    UINT32                  Budget;
+    UINT32                  MethodCount;
+    UINT32                  Hits;
+    UINT32                  Misses;
+    UINT32                  Elapsed;
+
+
+    if (CountArg)
+    {
+        Iterations = strtoul (CountArg, NULL, 0);
+    }
+
+    if (!Iterations)
+    {
+        AcpiOsPrintf ("Iteration count must be non-zero\n");
+        return;
+    }
+
+    Budget = AcpiGbl_MethodCacheBudget;
+    if (!Budget)
+    {
+        Budget = ACPI_METHOD_CACHE_BUDGET;
+    }
+
+    /* Uncached: every name reference goes through AcpiNsLookup */
+
+    AcpiGbl_MethodCacheBudget = 0;
+    Elapsed = AcpiDbTestTimeMethods (Iterations, &MethodCount);
+    if (!MethodCount)
+    {
+        AcpiGbl_MethodCacheBudget = Budget;
+        AcpiOsPrintf ("No _STA methods found in the namespace\n");
+        return;
+    }
+
+    AcpiOsPrintf ("Evaluated %u _STA methods %u times each\n",
+        MethodCount, Iterations);
+    AcpiOsPrintf ("  Uncached: %u.%03u ms, %u ns/evaluation\n",
+        Elapsed / 10000, (Elapsed / 10) % 1000,
+        (UINT32) (((UINT64) Elapsed * 100) / (MethodCount * Iterations)));
+
+    /* Cached: the first evaluation of each method fills its cache */
+
+    AcpiGbl_MethodCacheBudget = Budget;
+    Hits = AcpiGbl_MethodCacheHits;
+    Misses = AcpiGbl_MethodCacheMisses;
+
+    Elapsed = AcpiDbTestTimeMethods (Iterations, &MethodCount);
+    AcpiOsPrintf ("  Cached:   %u.%03u ms, %u ns/evaluation "
+        "(%u hits, %u misses, %u bytes cached)\n",
+        Elapsed / 10000, (Elapsed / 10) % 1000,
+        (UINT32) (((UINT64) Elapsed * 100) / (MethodCount * Iterations)),
+        AcpiGbl_MethodCacheHits - Hits, AcpiGbl_MethodCacheMisses - Misses,
+        AcpiGbl_MethodCacheBytes);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestTimeMethods
+ *
+ * PARAMETERS:  Iterations          - Evaluations per method
+ *              MethodCount         - Where the number of methods is returned
+ *
+ * RETURN:      Elapsed time in 100 nanosecond units
+ *
+ * DESCRIPTION: Evaluate each _STA method in the namespace Iterations times.
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiDbTestTimeMethods (
+    UINT32                  Iterations,
+    UINT32                  *MethodCount)
+{
+    ACPI_DB_EXECUTE_WALK    Info;
+    UINT64                  Start;
+
+
+    Info.Count = 0;
+    Info.MaxCount = Iterations;
+
+    Start = AcpiOsGetTimer ();
+    (void) AcpiWalkNamespace (ACPI_TYPE_METHOD, ACPI_ROOT_OBJECT,
+        ACPI_UINT32_MAX, AcpiDbTestEvaluateOneMethod, NULL,
+        (void *) &Info, NULL);
+
+    *MethodCount = Info.Count;
+    return ((UINT32) (AcpiOsGetTimer () - Start));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestEvaluateOneMethod
+ *
+ * PARAMETERS:  Callback from WalkNamespace
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Evaluate one _STA method Info->MaxCount times. Results are
+ *              discarded; failures are reported once.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiDbTestEvaluateOneMethod (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    ACPI_NAMESPACE_NODE     *Node = (ACPI_NAMESPACE_NODE *) ObjHandle;
+    ACPI_DB_EXECUTE_WALK    *Info = (ACPI_DB_EXECUTE_WALK *) Context;
+    ACPI_BUFFER             ReturnObj;
+    ACPI_STATUS             Status;
+    UINT32                  i;
+
+
+    if (!ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__STA))
+    {
+        return (AE_OK);
+    }
+
+    for (i = 0; i < Info->MaxCount; i++)
+    {
+        ReturnObj.Pointer = NULL;
+        ReturnObj.Length = ACPI_ALLOCATE_BUFFER;
+
+        Status = AcpiEvaluateObject (Node, NULL, NULL, &ReturnObj);
+        if (ACPI_FAILURE (Status))
+        {
+            AcpiOsPrintf ("%4.4s evaluation failed: %s\n",
+                AcpiUtGetNodeName (Node->Parent),
+                AcpiFormatException (Status));
+            break;
+        }
+
+        AcpiOsFree (ReturnObj.Pointer);
+    }
+
+    Info->Count++;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestAmlBench
+ *
+ * PARAMETERS:  CountArg            - Evaluations per method (default 1000)
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: This test implements the AMLBENCH subcommand. It installs a
+ *              small set of integer-only control methods, evaluates each one
+ *              with the pre-decoded method engine disabled and then enabled,
+ *              and reports the time per evaluation for both runs. The two
+ *              results must match.
+ *
+ ******************************************************************************/
+
+#define ACPI_DB_AML_BENCH_ITERATIONS        1000
+
+static void
+AcpiDbTestAmlBench (
+    char                    *CountArg)
+{
+    ACPI_DB_AML_BENCH       *Bench;
+    UINT32                  Iterations = ACPI_DB_AML_BENCH_ITERATIONS;
+    BOOLEAN                 Enabled;
+    UINT64                  Interpreted;
+    UINT64                  Decoded;
+    UINT32                  InterpretedTime;
+    UINT32                  DecodedTime;
+    ACPI_STATUS             Status;
+
+
+    if (CountArg)
+    {
+        Iterations = strtoul (CountArg, NULL, 0);
+    }
+
+    if (!Iterations)
+    {
+        AcpiOsPrintf ("Iteration count must be non-zero\n");
+        return;
+    }
+
+    Enabled = AcpiGbl_EnableDecodedMethods;
+    AcpiOsPrintf ("Evaluating each method %u times\n", Iterations);
+
+    for (Bench = AcpiDbAmlBenchMethods; Bench->Pathname; Bench++)
+    {
+        /* Install the benchmark method once */
+
+        if (!Bench->Handle)
+        {
+            Status = AcpiInstallMethod (Bench->Code);
+            if (ACPI_FAILURE (Status) && (Status != AE_ALREADY_EXISTS))
+            {
+                AcpiOsPrintf ("%s, Could not install benchmark method\n",
+                    AcpiFormatException (Status));
+                break;
+            }
+
+            Status = AcpiGetHandle (NULL, Bench->Pathname, &Bench->Handle);
+            if (ACPI_FAILURE (Status))
+            {
+                AcpiOsPrintf ("Could not get handle for %s\n",
+                    Bench->Pathname);
+                break;
+            }
+        }
+
+        AcpiGbl_EnableDecodedMethods = FALSE;
+        InterpretedTime = AcpiDbTestTimeAmlMethod (Bench->Handle,
+            Bench->Argument, Iterations, &Interpreted);
+
+        AcpiGbl_EnableDecodedMethods = TRUE;
+        DecodedTime = AcpiDbTestTimeAmlMethod (Bench->Handle,
+            Bench->Argument, Iterations, &Decoded);
+
+        if (!InterpretedTime || !DecodedTime)
+        {
+            continue;
+        }
+
+        AcpiOsPrintf ("  %s: interpreted %u ns, decoded %u ns/evaluation "
+            "(%u.%02ux)\n", Bench->Pathname,
+            (UINT32) (((UINT64) InterpretedTime * 100) / Iterations),
+            (UINT32) (((UINT64) DecodedTime * 100) / Iterations),
+            InterpretedTime / DecodedTime,
+            (UINT32) ((((UINT64) InterpretedTime * 100) / DecodedTime) % 100));
+
+        if (Interpreted != Decoded)
+        {
+            AcpiOsPrintf ("  %s: result mismatch, interpreted %8.8X%8.8X, "
+                "decoded %8.8X%8.8X\n", Bench->Pathname,
+                ACPI_FORMAT_UINT64 (Interpreted),
+                ACPI_FORMAT_UINT64 (Decoded));
+        }
+    }
+
+    AcpiGbl_EnableDecodedMethods = Enabled;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestTimeAmlMethod
+ *
+ * PARAMETERS:  Handle              - Method to evaluate
+ *              Value               - Integer argument for the method
+ *              Iterations          - Number of evaluations
+ *              Result              - Where the integer result is returned
+ *
+ * RETURN:      Elapsed time in 100 nanosecond units, zero on failure
+ *
+ * DESCRIPTION: Evaluate a one-argument integer method Iterations times.
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiDbTestTimeAmlMethod (
+    ACPI_HANDLE             Handle,
+    UINT64                  Value,
+    UINT32                  Iterations,
+    UINT64                  *Result)
+{
+    ACPI_OBJECT_LIST        ParamObjects;
+    ACPI_OBJECT             Params[1];
+    ACPI_OBJECT             ReturnValue;
+    ACPI_BUFFER             ReturnObj;
+    ACPI_STATUS             Status;
+    UINT64                  Start;
+    UINT32                  Elapsed;
+    UINT32                  i;
+
+
+    Params[0].Type = ACPI_TYPE_INTEGER;
+    Params[0].Integer.Value = Value;
+
+    ParamObjects.Count = 1;
+    ParamObjects.Pointer = Params;
+
+    *Result = 0;
+    Start = AcpiOsGetTimer ();
+
+    for (i = 0; i < Iterations; i++)
+    {
+        ReturnObj.Pointer = &ReturnValue;
+        ReturnObj.Length = sizeof (ACPI_OBJECT);
+
+        Status = AcpiEvaluateObject (Handle, NULL, &ParamObjects, &ReturnObj);
+        if (ACPI_FAILURE (Status))
+        {
+            AcpiOsPrintf ("%4.4s evaluation failed: %s\n",
+                AcpiUtGetNodeName (Handle), AcpiFormatException (Status));
+            return (0);
+        }
+    }
+
+    Elapsed = (UINT32) (AcpiOsGetTimer () - Start);
+    if (ReturnValue.Type == ACPI_TYPE_INTEGER)
+    {
+        *Result = ReturnValue.Integer.Value;
+    }
+
+    /* Keep the elapsed time non-zero so the caller can tell success */
+
+    return (Elapsed ? Elapsed : 1);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestDeviceIdMap
+ *
+ * PARAMETERS:  CountArg            - Number of synthetic devices (default
+ *                                    10000)
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: This test implements the DEVICEMAP subcommand. It builds a
+ *              synthetic scope of devices with one of a fixed set of _HIDs
+ *              each, and every eighth one a _CID, then times AcpiGetDevices
+ *              queries by ID with the namespace walk and with the device ID
+ *              map. Both must report the same devices. The scope is deleted
+ *              again when the test completes.
+ *
+ ******************************************************************************/
+
+#define ACPI_DB_ID_TEST_SCOPE       "_T96"
+#define ACPI_DB_ID_TEST_DEVICES     10000
+#define ACPI_DB_ID_TEST_IDS         100
+#define ACPI_DB_ID_TEST_CID         "PNP0C02"
+#define ACPI_DB_ID_WALK_QUERIES     10
+
+static void
+AcpiDbTestDeviceIdMap (
+    char                    *CountArg)
+{
+    ACPI_NAMESPACE_NODE     *ScopeNode;
+    ACPI_NAMESPACE_NODE     *Node;
+    ACPI_NAME_UNION         ScopeName;
+    ACPI_STATUS             Status;
+    char                    Id[ACPI_EISAID_STRING_SIZE];
+    UINT32                  DeviceCount = ACPI_DB_ID_TEST_DEVICES;
+    UINT32                  WalkMatches;
+    UINT32                  MapMatches;
+    UINT32                  Elapsed;
+    UINT32                  BuildTime;
+    UINT32                  MapTime;
+    BOOLEAN                 Enabled;
+    UINT32                  i;
+
+
+    if (CountArg)
+    {
+        DeviceCount = strtoul (CountArg, NULL, 0);
+    }
+
+    if (!DeviceCount)
+    {
+        AcpiOsPrintf ("Device count must be non-zero\n");
+        return;
+    }
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_FAILURE (Status))
+    {
+        return;
+    }
+
+    ACPI_COPY_NAMESEG (ScopeName.Ascii, ACPI_DB_ID_TEST_SCOPE);
+    ScopeNode = AcpiNsCreateNode (ScopeName.Integer, 0);
+    if (!ScopeNode)
+    {
+        (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+        return;
+    }
+
+    AcpiNsInstallNode (NULL, AcpiGbl_RootNode, ScopeNode,
+        ACPI_TYPE_LOCAL_SCOPE);
+
+    for (i = 0; i < DeviceCount; i++)
+    {
+        Node = AcpiNsCreateNode (AcpiDbTestMakeName (i), 0);
+        if (!Node)
+        {
+            AcpiOsPrintf ("Could not allocate device %u\n", i);
+            DeviceCount = i;
+            break;
+        }
+
+        AcpiNsInstallNode (NULL, ScopeNode, Node, ACPI_TYPE_DEVICE);
+
+        AcpiDbTestMakeId (Id, i % ACPI_DB_ID_TEST_IDS);
+        Status = AcpiDbTestAddIdObject (Node, METHOD_NAME__HID, Id);
+        if (ACPI_SUCCESS (Status) && !(i % 8))
+        {
+            Status = AcpiDbTestAddIdObject (Node, METHOD_NAME__CID,
+                ACPI_DB_ID_TEST_CID);
+        }
+
+        if (ACPI_FAILURE (Status))
+        {
+            AcpiOsPrintf ("Could not create IDs for device %u\n", i);
+            DeviceCount = i + 1;
+            break;
+        }
+    }
+
+    (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+
+    AcpiOsPrintf ("Created %u devices with %u distinct _HIDs under \\%s\n",
+        DeviceCount, ACPI_MIN (DeviceCount, ACPI_DB_ID_TEST_IDS),
+        ACPI_DB_ID_TEST_SCOPE);
+
+    Enabled = AcpiGbl_EnableDeviceIdMap;
+
+    /* Full namespace walks over a sample of the IDs */
+
+    AcpiGbl_EnableDeviceIdMap = FALSE;
+    Elapsed = AcpiDbTestTimeGetDevices (0, ACPI_DB_ID_WALK_QUERIES,
+        &WalkMatches);
+    AcpiOsPrintf ("  Walk: %u queries in %u.%03u ms, %u us/query\n",
+        ACPI_DB_ID_WALK_QUERIES, Elapsed / 10000, (Elapsed / 10) % 1000,
+        Elapsed / (ACPI_DB_ID_WALK_QUERIES * 10));
+
+    /* The first query with the map enabled builds it */
+
+    AcpiGbl_EnableDeviceIdMap = TRUE;
+    BuildTime = AcpiDbTestTimeGetDevices (ACPI_DB_ID_TEST_IDS, 1,
+        &MapMatches);
+    Elapsed = AcpiDbTestTimeGetDevices (0, ACPI_DB_ID_WALK_QUERIES,
+        &MapMatches);
+    AcpiOsPrintf ("  Map:  %u queries in %u.%03u ms, %u us/query "
+        "(built in %u.%03u ms)\n",
+        ACPI_DB_ID_WALK_QUERIES, Elapsed / 10000, (Elapsed / 10) % 1000,
+        Elapsed / (ACPI_DB_ID_WALK_QUERIES * 10),
+        BuildTime / 10000, (BuildTime / 10) % 1000);
+
+    if (WalkMatches != MapMatches)
+    {
+        AcpiOsPrintf ("  Match count mismatch, walk %u, map %u\n",
+            WalkMatches, MapMatches);
+    }
+
+    /* The compatible ID, shared by every eighth device */
+
+    AcpiGbl_EnableDeviceIdMap = FALSE;
+    Elapsed = AcpiDbTestTimeGetDevices (ACPI_DB_ID_TEST_IDS, 1,
+        &WalkMatches);
+    AcpiGbl_EnableDeviceIdMap = TRUE;
+    MapTime = AcpiDbTestTimeGetDevices (ACPI_DB_ID_TEST_IDS, 1,
+        &MapMatches);
+    AcpiOsPrintf ("  %s: %u devices, walk %u us, map %u us\n",
+        ACPI_DB_ID_TEST_CID, MapMatches, Elapsed / 10, MapTime / 10);
+
+    if (WalkMatches != MapMatches)
+    {
+        AcpiOsPrintf ("  Match count mismatch, walk %u, map %u\n",
+            WalkMatches, MapMatches);
+    }
+
+    AcpiGbl_EnableDeviceIdMap = Enabled;
+
+    /* Delete the synthetic scope and everything below it */
+
+    AcpiNsDeleteNamespaceSubtree (ScopeNode);
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_SUCCESS (Status))
+    {
+        AcpiNsRemoveNode (ScopeNode);
+        (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestMakeId
+ *
+ * PARAMETERS:  Id                  - Where the ID is returned, at least
+ *                                    ACPI_EISAID_STRING_SIZE bytes
+ *              Index               - Ordinal of a synthetic _HID
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Format the synthetic hardware ID "SYNxxxx" for an ordinal.
+ *
+ ******************************************************************************/
+
+static void
+AcpiDbTestMakeId (
+    char                    *Id,
+    UINT32                  Index)
+{
+    UINT32                  i;
+
+
+    strcpy (Id, "SYN");
+    for (i = 0; i < 4; i++)
+    {
+        Id[3 + i] = AcpiUtHexToAsciiChar (Index, (3 - i) * 4);
+    }
+
+    Id[7] = 0;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestAddIdObject
+ *
+ * PARAMETERS:  DeviceNode          - Synthetic device
+ *              Name                - METHOD_NAME__HID or METHOD_NAME__CID
+ *              Id                  - ID string
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Create a string ID object below a synthetic device.
+ *
+ * MUTEX:       Caller must hold the namespace mutex
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiDbTestAddIdObject (
+    ACPI_NAMESPACE_NODE     *DeviceNode,
+    const char              *Name,
+    const char              *Id)
+{
+    ACPI_NAMESPACE_NODE     *Node;
+    ACPI_OPERAND_OBJECT     *ObjDesc;
+    ACPI_NAME_UNION         IdName;
+    ACPI_STATUS             Status;
+
+
+    ObjDesc = AcpiUtCreateStringObject (strlen (Id));
+    if (!ObjDesc)
+    {
+        return (AE_NO_MEMORY);
+    }
+
+    strcpy (ObjDesc->String.Pointer, Id);
+
+    ACPI_COPY_NAMESEG (IdName.Ascii, Name);
+    Node = AcpiNsCreateNode (IdName.Integer, 0);
+    if (!Node)
+    {
+        AcpiUtRemoveReference (ObjDesc);
+        return (AE_NO_MEMORY);
+    }
+
+    AcpiNsInstallNode (NULL, DeviceNode, Node, ACPI_TYPE_STRING);
+    Status = AcpiNsAttachObject (Node, ObjDesc, ACPI_TYPE_STRING);
+    AcpiUtRemoveReference (ObjDesc);
+    return (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestTimeGetDevices
+ *
+ * PARAMETERS:  FirstId             - Ordinal of the first synthetic _HID;
+ *                                    ACPI_DB_ID_TEST_IDS selects the _CID
+ *              QueryCount          - Number of consecutive IDs to query
+ *              Matches             - Where the total device count is
+ *                                    returned
+ *
+ * RETURN:      Elapsed time in 100 nanosecond units
+ *
+ * DESCRIPTION: Run one AcpiGetDevices query for each of QueryCount IDs.
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiDbTestTimeGetDevices (
+    UINT32                  FirstId,
+    UINT32                  QueryCount,
+    UINT32                  *Matches)
+{
+    char                    Id[ACPI_EISAID_STRING_SIZE];
+    UINT64                  Start;
+    UINT32                  i;
+
+
+    *Matches = 0;
+    Start = AcpiOsGetTimer ();
+
+    for (i = 0; i < QueryCount; i++)
+    {
+        if (FirstId + i >= ACPI_DB_ID_TEST_IDS)
+        {
+            strcpy (Id, ACPI_DB_ID_TEST_CID);
+        }
+        else
+        {
+            AcpiDbTestMakeId (Id, FirstId + i);
+        }
+
+        (void) AcpiGetDevices (Id, AcpiDbTestCountDevice, Matches, NULL);
+    }
+
+    return ((UINT32) (AcpiOsGetTimer () - Start));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestCountDevice
+ *
+ * PARAMETERS:  Callback from AcpiGetDevices
+ *
+ * RETURN:      AE_OK
+ *
+ * DESCRIPTION: Count one matching device.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiDbTestCountDevice (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    UINT32                  *Count = Context;
+
+
+    (*Count)++;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestSemaphores
+ *
+ * PARAMETERS:  CountArg            - Acquire/release pairs per thread
+ *                                    (default 100000)
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: This test implements the SEMAPHORES subcommand. For 1, 2, 4,
+ *              ... 64 threads it has every thread acquire and release one
+ *              shared single-unit semaphore, the way AcpiUtAcquireMutex
+ *              uses it, and reports the pairs per second. A count that is
+ *              only updated with the semaphore held must come out exact.
+ *
+ ******************************************************************************/
+
+#define ACPI_DB_SEM_TEST_ITERATIONS     100000
+#define ACPI_DB_SEM_TEST_MAX_THREADS    64
+
+typedef struct acpi_db_sem_test
+{
+    ACPI_SEMAPHORE          Semaphore;      /* Under test, one unit */
+    ACPI_SEMAPHORE          StartGate;
+    ACPI_SEMAPHORE          DoneGate;
+    UINT32                  Iterations;
+    UINT32                  Count;          /* Only changed with Semaphore held */
+
+} ACPI_DB_SEM_TEST;
+
+static void
+AcpiDbTestSemaphores (
+    char                    *CountArg)
+{
+    UINT32                  Iterations = ACPI_DB_SEM_TEST_ITERATIONS;
+    UINT32                  ThreadCount;
+    UINT32                  Elapsed;
+    UINT64                  Pairs;
+
+
+    if (CountArg)
+    {
+        Iterations = strtoul (CountArg, NULL, 0);
+    }
+
+    if (!Iterations)
+    {
+        AcpiOsPrintf ("Iteration count must be non-zero\n");
+        return;
+    }
+
+    AcpiOsPrintf ("Acquiring and releasing one semaphore %u times per thread\n",
+        Iterations);
+
+    for (ThreadCount = 1; ThreadCount <= ACPI_DB_SEM_TEST_MAX_THREADS;
+         ThreadCount *= 2)
+    {
+        Elapsed = AcpiDbTestTimeSemaphore (ThreadCount, Iterations);
+        if (!Elapsed)
+        {
+            break;
+        }
+
+        /* Elapsed is in 100 nanosecond units */
+
+        Pairs = (UINT64) ThreadCount * Iterations;
+        AcpiOsPrintf ("  %2u threads: %u.%03u ms, %u pairs/ms, %u ns/pair\n",
+            ThreadCount, Elapsed / 10000, (Elapsed / 10) % 1000,
+            (UINT32) ((Pairs * 10000) / Elapsed),
+            (UINT32) (((UINT64) Elapsed * 100) / Pairs));
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestTimeSemaphore
+ *
+ * PARAMETERS:  ThreadCount         - Threads to contend for the semaphore
+ *              Iterations          - Acquire/release pairs per thread
+ *
+ * RETURN:      Elapsed time in 100 nanosecond units, zero on failure
+ *
+ * DESCRIPTION: Start ThreadCount threads on a fresh semaphore, release them
+ *              together and time them until the last one is done.
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiDbTestTimeSemaphore (
+    UINT32                  ThreadCount,
+    UINT32                  Iterations)
+{
+    ACPI_DB_SEM_TEST        Test;
+    ACPI_STATUS             Status;
+    UINT64                  Start;
+    UINT32                  Elapsed = 0;
+    UINT32                  Launched;
+    UINT32                  i;
+
+
+    memset (&Test, 0, sizeof (ACPI_DB_SEM_TEST));
+    Test.Iterations = Iterations;
+
+    Status = AcpiOsCreateSemaphore (1, 1, &Test.Semaphore);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiOsCreateSemaphore (ThreadCount, 0, &Test.StartGate);
+    }
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiOsCreateSemaphore (ThreadCount, 0, &Test.DoneGate);
+    }
+    if (ACPI_FAILURE (Status))
+    {
+        AcpiOsPrintf ("Could not create semaphores: %s\n",
+            AcpiFormatException (Status));
+        goto Cleanup;
+    }
+
+    for (Launched = 0; Launched < ThreadCount; Launched++)
+    {
+        Status = AcpiOsExecute (OSL_DEBUGGER_EXEC_THREAD,
+            AcpiDbTestSemaphoreThread, &Test);
+        if (ACPI_FAILURE (Status))
+        {
+            break;
+        }
+    }
+
+    /* Open the gate one unit at a time; not every host signals several */
+
+    Start = AcpiOsGetTimer ();
+    for (i = 0; i < Launched; i++)
+    {
+        (void) AcpiOsSignalSemaphore (Test.StartGate, 1);
+    }
+
+    for (i = 0; i < Launched; i++)
+    {
+        (void) AcpiOsWaitSemaphore (Test.DoneGate, 1, ACPI_WAIT_FOREVER);
+    }
+
+    Elapsed = (UINT32) (AcpiOsGetTimer () - Start);
+
+    if (Launched != ThreadCount)
+    {
+        AcpiOsPrintf ("Could only start %u of %u threads: %s\n",
+            Launched, ThreadCount, AcpiFormatException (Status));
+        Elapsed = 0;
+    }
+    else if (Test.Count != ThreadCount * Iterations)
+    {
+        AcpiOsPrintf ("  %2u threads: count %u, expected %u\n",
+            ThreadCount, Test.Count, ThreadCount * Iterations);
+        Elapsed = 0;
+    }
+    else if (!Elapsed)
+    {
+        Elapsed = 1;
+    }
+
+Cleanup:
+    if (Test.DoneGate)
+    {
+        (void) AcpiOsDeleteSemaphore (Test.DoneGate);
+    }
+    if (Test.StartGate)
+    {
+        (void) AcpiOsDeleteSemaphore (Test.StartGate);
+    }
+    if (Test.Semaphore)
+    {
+        (void) AcpiOsDeleteSemaphore (Test.Semaphore);
+    }
+
+    return (Elapsed);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestSemaphoreThread
+ *
+ * PARAMETERS:  Context             - ACPI_DB_SEM_TEST
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: One SEMAPHORES thread: wait for the start, then acquire and
+ *              release the semaphore under test Iterations times.
+ *
+ ******************************************************************************/
+
+static void ACPI_SYSTEM_XFACE
+AcpiDbTestSemaphoreThread (
+    void                    *Context)
+{
+    ACPI_DB_SEM_TEST        *Test = Context;
+    UINT32                  i;
+
+
+    (void) AcpiOsWaitSemaphore (Test->StartGate, 1, ACPI_WAIT_FOREVER);
+
+    for (i = 0; i < Test->Iterations; i++)
+    {
+        if (ACPI_FAILURE (AcpiOsWaitSemaphore (Test->Semaphore, 1,
+                ACPI_WAIT_FOREVER)))
+        {
+            break;
+        }
+
+        Test->Count++;
+        (void) AcpiOsSignalSemaphore (Test->Semaphore, 1);
+    }
+
+    /* A pair that never happened shows up as a short count */
+
+    (void) AcpiOsSignalSemaphore (Test->DoneGate, 1);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDbTestTimer
+ *
+ * PARAMETERS:  CountArg            - While loop iterations per evaluation
+ *                                    (default 100000)
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: This test implements the TIMER subcommand. It reports the
+ *              cost of one AcpiOsGetTimer call, then times a While loop that
+ *              does nothing but count, interpreted (a timeout check on every
+ *              iteration) and pre-decoded. Both must count to CountArg.
+ *
+ ******************************************************************************/
+
+#define ACPI_DB_TIMER_TEST_ITERATIONS   100000
+#define ACPI_DB_TIMER_TEST_READS        1000000
+#define ACPI_DB_TIMER_TEST_RUNS         10
+#define ACPI_DB_TIMER_TEST_METHOD       "\\_T94"
+
+static void
+AcpiDbTestTimer (
+    char                    *CountArg)
+{
+    static ACPI_HANDLE      Handle = NULL;
+    UINT32                  Iterations = ACPI_DB_TIMER_TEST_ITERATIONS;
+    UINT64                  Start;
+    UINT64                  Sink = 0;
+    UINT64                  Result;
+    UINT64                  Loops;
+    UINT32                  Elapsed;
+    UINT32                  Hundredths;
+    BOOLEAN                 Enabled;
+    BOOLEAN                 Decoded;
+    ACPI_STATUS             Status;
+    UINT32                  i;
+
+
+    if (CountArg)
+    {
+        Iterations = strtoul (CountArg, NULL, 0);
+    }
+
+    if (!Iterations)
+    {
+        AcpiOsPrintf ("Iteration count must be non-zero\n");
+        return;
+    }
+
+    /* The timer itself */
+
+    Start = AcpiOsGetTimer ();
+    for (i = 0; i < ACPI_DB_TIMER_TEST_READS; i++)
+    {
+        Sink += AcpiOsGetTimer ();
+    }
+
+    Elapsed = (UINT32) (AcpiOsGetTimer () - Start);
+    Hundredths = (UINT32) (((UINT64) Elapsed * 10000) /
+        ACPI_DB_TIMER_TEST_READS);
+    AcpiOsPrintf ("AcpiOsGetTimer: %u reads in %u.%03u ms, %u.%02u ns/read\n",
+        ACPI_DB_TIMER_TEST_READS, Elapsed / 10000, (Elapsed / 10) % 1000,
+        Hundredths / 100, Hundredths % 100);
+
+    if (!Sink)
+    {
+        AcpiOsPrintf ("Timer did not advance\n");
+    }
+
+    /* Install the loop method once */
+
+    if (!Handle)
+    {
+        Status = AcpiInstallMethod (_T94MethodCode);
+        if (ACPI_FAILURE (Status) && (Status != AE_ALREADY_EXISTS))
+        {
+            AcpiOsPrintf ("%s, Could not install benchmark method\n",
+                AcpiFormatException (Status));
+            return;
+        }
+
+        Status = AcpiGetHandle (NULL, ACPI_DB_TIMER_TEST_METHOD, &Handle);
+        if (ACPI_FAILURE (Status))
+        {
+            AcpiOsPrintf ("Could not get handle for %s\n",
+                ACPI_DB_TIMER_TEST_METHOD);
+            return;
+        }
+    }
+
+    Enabled = AcpiGbl_EnableDecodedMethods;
+    Loops = (UINT64) Iterations * ACPI_DB_TIMER_TEST_RUNS;
+
+    for (Decoded = FALSE; Decoded <= TRUE; Decoded++)
+    {
+        AcpiGbl_EnableDecodedMethods = Decoded;
+        Elapsed = AcpiDbTestTimeAmlMethod (Handle, Iterations,
+            ACPI_DB_TIMER_TEST_RUNS, &Result);
+        if (!Elapsed)
+        {
+            break;
+        }
+
+        AcpiOsPrintf ("  %-11s %u x %u iterations in %u.%03u ms, "
+            "%u ns/iteration\n",
+            Decoded ? "Pre-decoded" : "Interpreted",
+            ACPI_DB_TIMER_TEST_RUNS, Iterations,
+            Elapsed / 10000, (Elapsed / 10) % 1000,
+            (UINT32) (((UINT64) Elapsed * 100) / Loops));
+
+        if (Result != Iterations)
+        {
+            AcpiOsPrintf ("  Loop counted to %8.8X%8.8X, expected %u\n",
+                ACPI_FORMAT_UINT64 (Result), Iterations);
+        }
+    }
+
+    AcpiGbl_EnableDecodedMethods = Enabled;
+}
@@ -156,6 +156,7 @@
 #include "amlcode.h"
 #include "acdispat.h"
 #include "acnamesp.h"
+#include "acinterp.h"
 
 #define _COMPONENT          ACPI_DISPATCHER
         ACPI_MODULE_NAME    ("dsargs")
@@ -317,6 +318,17 @@ AcpiDsGetBufferFieldArguments (
         return_ACPI_STATUS (AE_OK);
     }
 
+    /*
+     * Running the deferred AML creates objects and changes this one. A
+     * thread that holds the interpreter shared takes it to itself first,
+     * then looks again in case another thread got there while it waited.
+     */
+    AcpiExUpgradeInterpreter ();
+    if (ObjDesc->Common.Flags & AOPOBJ_DATA_VALID)
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
     /* Get the AML pointer (method object) and BufferField node */
 
     ExtraDesc = AcpiNsGetSecondaryObject (ObjDesc);
@@ -366,6 +378,12 @@ AcpiDsGetBankFieldArguments (
         return_ACPI_STATUS (AE_OK);
     }
 
+    AcpiExUpgradeInterpreter ();
+    if (ObjDesc->Common.Flags & AOPOBJ_DATA_VALID)
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
     /* Get the AML pointer (method object) and BankField node */
 
     ExtraDesc = AcpiNsGetSecondaryObject (ObjDesc);
@@ -414,6 +432,12 @@ AcpiDsGetBufferArguments (
         return_ACPI_STATUS (AE_OK);
     }
 
+    AcpiExUpgradeInterpreter ();
+    if (ObjDesc->Common.Flags & AOPOBJ_DATA_VALID)
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
     /* Get the Buffer node */
 
     Node = ObjDesc->Buffer.Node;
@@ -464,6 +488,12 @@ AcpiDsGetPackageArguments (
         return_ACPI_STATUS (AE_OK);
     }
 
+    AcpiExUpgradeInterpreter ();
+    if (ObjDesc->Common.Flags & AOPOBJ_DATA_VALID)
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
     /* Get the Package node */
 
     Node = ObjDesc->Package.Node;
@@ -516,6 +546,12 @@ AcpiDsGetRegionArguments (
         return_ACPI_STATUS (AE_OK);
     }
 
+    AcpiExUpgradeInterpreter ();
+    if (ObjDesc->Region.Flags & AOPOBJ_DATA_VALID)
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
     ExtraDesc = AcpiNsGetSecondaryObject (ObjDesc);
     if (!ExtraDesc)
     {
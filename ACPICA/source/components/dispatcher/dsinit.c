@@ -250,6 +250,18 @@ AcpiDsInitOneObject (
             break;
         }
 
+        /* Identification methods whose result may be memoized */
+
+        if (AcpiGbl_MemoizePureMethods &&
+            (ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__HID) ||
+             ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__UID) ||
+             ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__CID) ||
+             ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__CLS) ||
+             ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__ADR)))
+        {
+            (void) AcpiDsDetectPureMethod (Node, ObjDesc);
+        }
+
         /* Ignore if already serialized */
 
         if (ObjDesc->Method.InfoFlags & ACPI_METHOD_SERIALIZED)
@@ -273,6 +285,13 @@ AcpiDsInitOneObject (
             }
         }
 
+        if (AcpiGbl_ParallelMethods)
+        {
+            /* Parse/scan method for what it may do with the interpreter shared */
+
+            (void) AcpiDsDetectParallelMethod (Node, ObjDesc);
+        }
+
         Info->NonSerialMethodCount++;
         break;
 
@@ -169,6 +169,29 @@ AcpiDsDetectNamedOpcodes (
     ACPI_WALK_STATE         *WalkState,
     ACPI_PARSE_OBJECT       **OutOp);
 
+static ACPI_STATUS
+AcpiDsDetectImpureOpcodes (
+    ACPI_WALK_STATE         *WalkState,
+    ACPI_PARSE_OBJECT       **OutOp);
+
+static ACPI_STATUS
+AcpiDsDetectNameReferences (
+    ACPI_WALK_STATE         *WalkState);
+
+static ACPI_STATUS
+AcpiDsDetectSharedOpcodes (
+    ACPI_WALK_STATE         *WalkState,
+    ACPI_PARSE_OBJECT       **OutOp);
+
+static ACPI_STATUS
+AcpiDsDetectSharedTargets (
+    ACPI_WALK_STATE         *WalkState);
+
+static BOOLEAN
+AcpiDsIsParallelTarget (
+    ACPI_WALK_STATE         *WalkState,
+    ACPI_PARSE_OBJECT       *Target);
+
 static ACPI_STATUS
 AcpiDsCreateMethodMutex (
     ACPI_OPERAND_OBJECT     *MethodDesc);
@@ -311,6 +334,526 @@ AcpiDsDetectNamedOpcodes (
 }
 
 
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDsDetectPureMethod
+ *
+ * PARAMETERS:  Node                        - Namespace Node of the method
+ *              ObjDesc                     - Method object attached to node
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Parse a control method AML to determine whether its result
+ *              depends on nothing but the AML itself. Such a method takes no
+ *              arguments, references no namespace object (so it cannot read
+ *              a field or region, store to a global or call another method,
+ *              by name or through DerefOf of a String) and uses none of the
+ *              opcodes that have a side effect or a time-dependent result.
+ *              Methods that qualify are marked ACPI_METHOD_PURE and their
+ *              return value may be memoized.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiDsDetectPureMethod (
+    ACPI_NAMESPACE_NODE     *Node,
+    ACPI_OPERAND_OBJECT     *ObjDesc)
+{
+    ACPI_STATUS             Status;
+    ACPI_PARSE_OBJECT       *Op = NULL;
+    ACPI_WALK_STATE         *WalkState;
+
+
+    ACPI_FUNCTION_TRACE_PTR (DsDetectPureMethod, Node);
+
+
+    if (ObjDesc->Method.ParamCount ||
+        (ObjDesc->Method.InfoFlags &
+            (ACPI_METHOD_MODULE_LEVEL | ACPI_METHOD_INTERNAL_ONLY)))
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
+    /* Create/Init a root op for the method parse tree */
+
+    Op = AcpiPsAllocOp (AML_METHOD_OP, ObjDesc->Method.AmlStart);
+    if (!Op)
+    {
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    AcpiPsSetName (Op, Node->Name.Integer);
+    Op->Common.Node = Node;
+
+    /* Create and initialize a new walk state */
+
+    WalkState = AcpiDsCreateWalkState (Node->OwnerId, NULL, NULL, NULL);
+    if (!WalkState)
+    {
+        AcpiPsFreeOp (Op);
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    Status = AcpiDsInitAmlWalk (WalkState, Op, Node,
+        ObjDesc->Method.AmlStart, ObjDesc->Method.AmlLength, NULL, 0);
+    if (ACPI_FAILURE (Status))
+    {
+        AcpiDsDeleteWalkState (WalkState);
+        AcpiPsFreeOp (Op);
+        return_ACPI_STATUS (Status);
+    }
+
+    WalkState->DescendingCallback = AcpiDsDetectImpureOpcodes;
+    WalkState->AscendingCallback = AcpiDsDetectNameReferences;
+
+    /*
+     * Assume the method is pure; either callback clears the flag and
+     * aborts the parse as soon as it finds a reason why it is not.
+     */
+    ObjDesc->Method.InfoFlags |= ACPI_METHOD_PURE;
+
+    Status = AcpiPsParseAml (WalkState);
+    if (ACPI_FAILURE (Status))
+    {
+        ObjDesc->Method.InfoFlags &= ~ACPI_METHOD_PURE;
+    }
+
+    if (ObjDesc->Method.InfoFlags & ACPI_METHOD_PURE)
+    {
+        ACPI_DEBUG_PRINT ((ACPI_DB_INFO,
+            "Method is pure [%4.4s] %p\n",
+            AcpiUtGetNodeName (Node), Node));
+    }
+
+    AcpiPsDeleteParseTree (Op);
+    return_ACPI_STATUS (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDsDetectImpureOpcodes
+ *
+ * PARAMETERS:  WalkState       - Current state of the parse tree walk
+ *              OutOp           - Unused, required for parser interface
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Descending callback used by AcpiDsDetectPureMethod. Rejects
+ *              opcodes that create names, reference a namespace object,
+ *              have a side effect outside the method or return a value that
+ *              changes between invocations.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiDsDetectImpureOpcodes (
+    ACPI_WALK_STATE         *WalkState,
+    ACPI_PARSE_OBJECT       **OutOp)
+{
+
+    ACPI_FUNCTION_NAME (AcpiDsDetectImpureOpcodes);
+
+
+    if (!(WalkState->OpInfo->Flags & (AML_NAMED | AML_CREATE | AML_FIELD)))
+    {
+        switch (WalkState->Opcode)
+        {
+        case AML_INT_NAMEPATH_OP:
+        case AML_INT_METHODCALL_OP:
+        case AML_DEBUG_OP:
+        case AML_REF_OF_OP:
+        case AML_CONDITIONAL_REF_OF_OP:
+        case AML_NOTIFY_OP:
+        case AML_SLEEP_OP:
+        case AML_STALL_OP:
+        case AML_ACQUIRE_OP:
+        case AML_RELEASE_OP:
+        case AML_SIGNAL_OP:
+        case AML_WAIT_OP:
+        case AML_RESET_OP:
+        case AML_LOAD_OP:
+        case AML_LOAD_TABLE_OP:
+        case AML_UNLOAD_OP:
+        case AML_FATAL_OP:
+        case AML_TIMER_OP:
+        case AML_BREAKPOINT_OP:
+
+            break;
+
+        default:
+
+            return (AE_OK);
+        }
+    }
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_INFO,
+        "Method not pure [%4.4s] %p - [%s] (%4.4X)\n",
+        WalkState->MethodNode->Name.Ascii, WalkState->MethodNode,
+        WalkState->OpInfo->Name, WalkState->Opcode));
+
+    WalkState->MethodDesc->Method.InfoFlags &= ~ACPI_METHOD_PURE;
+    return (AE_CTRL_TERMINATE);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDsDetectNameReferences
+ *
+ * PARAMETERS:  WalkState       - Current state of the parse tree walk
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Ascending callback used by AcpiDsDetectPureMethod. Target and
+ *              SuperName operands are created directly by the argument
+ *              parser and never reach the descending callback, so check the
+ *              arguments of each completed op for a namestring. DerefOf of
+ *              a String looks the string up as a name at run time, so its
+ *              operand must be an Index, which is always a reference.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiDsDetectNameReferences (
+    ACPI_WALK_STATE         *WalkState)
+{
+    ACPI_PARSE_OBJECT       *Arg;
+
+
+    ACPI_FUNCTION_NAME (AcpiDsDetectNameReferences);
+
+
+    Arg = AcpiPsGetArg (WalkState->Op, 0);
+    if ((WalkState->Op->Common.AmlOpcode == AML_DEREF_OF_OP) &&
+        (!Arg || (Arg->Common.AmlOpcode != AML_INDEX_OP)))
+    {
+        ACPI_DEBUG_PRINT ((ACPI_DB_INFO,
+            "Method not pure [%4.4s] %p - DerefOf a possible name\n",
+            WalkState->MethodNode->Name.Ascii, WalkState->MethodNode));
+
+        WalkState->MethodDesc->Method.InfoFlags &= ~ACPI_METHOD_PURE;
+        return (AE_CTRL_TERMINATE);
+    }
+
+    while (Arg)
+    {
+        /* A null namestring is an omitted target, not a reference */
+
+        if ((Arg->Common.AmlOpcode == AML_INT_NAMEPATH_OP &&
+                Arg->Common.Value.Name) ||
+            (Arg->Common.AmlOpcode == AML_INT_METHODCALL_OP))
+        {
+            ACPI_DEBUG_PRINT ((ACPI_DB_INFO,
+                "Method not pure [%4.4s] %p - name reference\n",
+                WalkState->MethodNode->Name.Ascii, WalkState->MethodNode));
+
+            WalkState->MethodDesc->Method.InfoFlags &= ~ACPI_METHOD_PURE;
+            return (AE_CTRL_TERMINATE);
+        }
+
+        Arg = Arg->Common.Next;
+    }
+
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDsDetectParallelMethod
+ *
+ * PARAMETERS:  Node                        - Namespace Node of the method
+ *              ObjDesc                     - Method object attached to node
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Parse a control method AML to determine whether it may run
+ *              with the interpreter shared (AcpiExEnterInterpreterShared).
+ *              Such a method creates no named object, uses no mutex, event
+ *              or table opcode and does not notify, and stores only to
+ *              Locals, the Debug object or field units. Anything it does at
+ *              run time that changes another shared object (storing through
+ *              a reference, calling a method that is not parallel) takes the
+ *              interpreter exclusive first. Methods that qualify are marked
+ *              ACPI_METHOD_PARALLEL.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiDsDetectParallelMethod (
+    ACPI_NAMESPACE_NODE     *Node,
+    ACPI_OPERAND_OBJECT     *ObjDesc)
+{
+    ACPI_STATUS             Status;
+    ACPI_PARSE_OBJECT       *Op = NULL;
+    ACPI_WALK_STATE         *WalkState;
+
+
+    ACPI_FUNCTION_TRACE_PTR (DsDetectParallelMethod, Node);
+
+
+    if (ObjDesc->Method.InfoFlags &
+        (ACPI_METHOD_MODULE_LEVEL | ACPI_METHOD_INTERNAL_ONLY |
+         ACPI_METHOD_SERIALIZED | ACPI_METHOD_SERIALIZED_PENDING))
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
+    /* Create/Init a root op for the method parse tree */
+
+    Op = AcpiPsAllocOp (AML_METHOD_OP, ObjDesc->Method.AmlStart);
+    if (!Op)
+    {
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    AcpiPsSetName (Op, Node->Name.Integer);
+    Op->Common.Node = Node;
+
+    /* Create and initialize a new walk state */
+
+    WalkState = AcpiDsCreateWalkState (Node->OwnerId, NULL, NULL, NULL);
+    if (!WalkState)
+    {
+        AcpiPsFreeOp (Op);
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    Status = AcpiDsInitAmlWalk (WalkState, Op, Node,
+        ObjDesc->Method.AmlStart, ObjDesc->Method.AmlLength, NULL, 0);
+    if (ACPI_FAILURE (Status))
+    {
+        AcpiDsDeleteWalkState (WalkState);
+        AcpiPsFreeOp (Op);
+        return_ACPI_STATUS (Status);
+    }
+
+    WalkState->DescendingCallback = AcpiDsDetectSharedOpcodes;
+    WalkState->AscendingCallback = AcpiDsDetectSharedTargets;
+
+    /* As for pure methods, either callback clears the flag */
+
+    ObjDesc->Method.InfoFlags |= ACPI_METHOD_PARALLEL;
+
+    Status = AcpiPsParseAml (WalkState);
+    if (ACPI_FAILURE (Status))
+    {
+        ObjDesc->Method.InfoFlags &= ~ACPI_METHOD_PARALLEL;
+    }
+
+    if (ObjDesc->Method.InfoFlags & ACPI_METHOD_PARALLEL)
+    {
+        ACPI_DEBUG_PRINT ((ACPI_DB_INFO,
+            "Method is parallel [%4.4s] %p\n",
+            AcpiUtGetNodeName (Node), Node));
+    }
+
+    AcpiPsDeleteParseTree (Op);
+    return_ACPI_STATUS (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDsDetectSharedOpcodes
+ *
+ * PARAMETERS:  WalkState       - Current state of the parse tree walk
+ *              OutOp           - Unused, required for parser interface
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Descending callback used by AcpiDsDetectParallelMethod.
+ *              Rejects opcodes that create names or that act on the
+ *              namespace, a synchronization object or the OS.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiDsDetectSharedOpcodes (
+    ACPI_WALK_STATE         *WalkState,
+    ACPI_PARSE_OBJECT       **OutOp)
+{
+
+    ACPI_FUNCTION_NAME (AcpiDsDetectSharedOpcodes);
+
+
+    if (!(WalkState->OpInfo->Flags & (AML_NAMED | AML_CREATE | AML_FIELD)))
+    {
+        switch (WalkState->Opcode)
+        {
+        case AML_ACQUIRE_OP:
+        case AML_RELEASE_OP:
+        case AML_SIGNAL_OP:
+        case AML_WAIT_OP:
+        case AML_RESET_OP:
+        case AML_NOTIFY_OP:
+        case AML_LOAD_OP:
+        case AML_LOAD_TABLE_OP:
+        case AML_UNLOAD_OP:
+        case AML_FATAL_OP:
+
+            break;
+
+        default:
+
+            return (AE_OK);
+        }
+    }
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_INFO,
+        "Method not parallel [%4.4s] %p - [%s] (%4.4X)\n",
+        WalkState->MethodNode->Name.Ascii, WalkState->MethodNode,
+        WalkState->OpInfo->Name, WalkState->Opcode));
+
+    WalkState->MethodDesc->Method.InfoFlags &= ~ACPI_METHOD_PARALLEL;
+    return (AE_CTRL_TERMINATE);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDsDetectSharedTargets
+ *
+ * PARAMETERS:  WalkState       - Current state of the parse tree walk
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Ascending callback used by AcpiDsDetectParallelMethod. Checks
+ *              the target operands of each completed op. An Arg may be a
+ *              reference to any object, so stores to Args are rejected.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiDsDetectSharedTargets (
+    ACPI_WALK_STATE         *WalkState)
+{
+    const ACPI_OPCODE_INFO  *OpInfo;
+    ACPI_PARSE_OBJECT       *Arg;
+    ACPI_PARSE_OBJECT       *Target = NULL;
+    ACPI_PARSE_OBJECT       *Prev = NULL;
+
+
+    ACPI_FUNCTION_NAME (AcpiDsDetectSharedTargets);
+
+
+    OpInfo = AcpiPsGetOpcodeInfo (WalkState->Opcode);
+    if (!(OpInfo->Flags & AML_HAS_TARGET) &&
+        (WalkState->Opcode != AML_INCREMENT_OP) &&
+        (WalkState->Opcode != AML_DECREMENT_OP))
+    {
+        return (AE_OK);
+    }
+
+    /* The target is the last operand; Divide has two */
+
+    Arg = AcpiPsGetArg (WalkState->Op, 0);
+    while (Arg)
+    {
+        Prev = Target;
+        Target = Arg;
+        Arg = Arg->Common.Next;
+    }
+
+    if (AcpiDsIsParallelTarget (WalkState, Target) &&
+        ((WalkState->Opcode != AML_DIVIDE_OP) ||
+            AcpiDsIsParallelTarget (WalkState, Prev)))
+    {
+        return (AE_OK);
+    }
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_INFO,
+        "Method not parallel [%4.4s] %p - [%s] target\n",
+        WalkState->MethodNode->Name.Ascii, WalkState->MethodNode,
+        OpInfo->Name));
+
+    WalkState->MethodDesc->Method.InfoFlags &= ~ACPI_METHOD_PARALLEL;
+    return (AE_CTRL_TERMINATE);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiDsIsParallelTarget
+ *
+ * PARAMETERS:  WalkState       - Current state of the parse tree walk
+ *              Target          - Target operand of an op
+ *
+ * RETURN:      TRUE if a parallel method may store to it
+ *
+ * DESCRIPTION: Locals, the Debug object, an omitted target and field units.
+ *              A field unit is written under its region lock. Any other
+ *              named object could be read, changed and written back by two
+ *              threads at once, which NotSerialized methods that do not
+ *              block have always been safe from, so such a store makes the
+ *              method serial.
+ *
+ ******************************************************************************/
+
+static BOOLEAN
+AcpiDsIsParallelTarget (
+    ACPI_WALK_STATE         *WalkState,
+    ACPI_PARSE_OBJECT       *Target)
+{
+    ACPI_NAMESPACE_NODE     *Node;
+    ACPI_STATUS             Status;
+
+
+    if (!Target)
+    {
+        return (FALSE);
+    }
+
+    switch (Target->Common.AmlOpcode)
+    {
+    case AML_LOCAL0:
+    case AML_LOCAL1:
+    case AML_LOCAL2:
+    case AML_LOCAL3:
+    case AML_LOCAL4:
+    case AML_LOCAL5:
+    case AML_LOCAL6:
+    case AML_LOCAL7:
+    case AML_DEBUG_OP:
+
+        return (TRUE);
+
+    case AML_INT_NAMEPATH_OP:
+
+        if (!Target->Common.Value.Name)
+        {
+            return (TRUE);
+        }
+
+        Status = AcpiNsLookup (WalkState->ScopeInfo,
+            Target->Common.Value.Name, ACPI_TYPE_ANY, ACPI_IMODE_EXECUTE,
+            ACPI_NS_SEARCH_PARENT | ACPI_NS_DONT_OPEN_SCOPE, NULL, &Node);
+        if (ACPI_FAILURE (Status))
+        {
+            return (FALSE);
+        }
+
+        switch (Node->Type)
+        {
+        case ACPI_TYPE_LOCAL_REGION_FIELD:
+        case ACPI_TYPE_LOCAL_BANK_FIELD:
+        case ACPI_TYPE_LOCAL_INDEX_FIELD:
+
+            return (TRUE);
+
+        default:
+
+            return (FALSE);
+        }
+
+    default:
+
+        return (FALSE);
+    }
+}
+
+
 /*******************************************************************************
  *
  * FUNCTION:    AcpiDsMethodError
@@ -473,6 +1016,13 @@ AcpiDsBeginMethodExecution (
         return_ACPI_STATUS (AE_NULL_ENTRY);
     }
 
+    /* Only parallel methods may run with the interpreter shared */
+
+    if (!(ObjDesc->Method.InfoFlags & ACPI_METHOD_PARALLEL))
+    {
+        AcpiExUpgradeInterpreter ();
+    }
+
     AcpiExStartTraceMethod (MethodNode, ObjDesc, WalkState);
 
     /* Prevent wraparound of thread count */
@@ -590,13 +1140,17 @@ AcpiDsBeginMethodExecution (
     /*
      * Allocate an Owner ID for this method, only if this is the first thread
      * to begin concurrent execution. We only need one OwnerId, even if the
-     * method is invoked recursively.
+     * method is invoked recursively. Threads running parallel methods get
+     * here at the same time, so the OwnerId and the counts are updated
+     * under the method thread mutex.
      */
+    (void) AcpiOsAcquireMutex (AcpiGbl_MethodThreadMutex, ACPI_WAIT_FOREVER);
     if (!ObjDesc->Method.OwnerId)
     {
         Status = AcpiUtAllocateOwnerId (&ObjDesc->Method.OwnerId);
         if (ACPI_FAILURE (Status))
         {
+            AcpiOsReleaseMutex (AcpiGbl_MethodThreadMutex);
             goto Cleanup;
         }
     }
@@ -607,6 +1161,7 @@ AcpiDsBeginMethodExecution (
      */
     ObjDesc->Method.ThreadCount++;
     AcpiMethodCount++;
+    AcpiOsReleaseMutex (AcpiGbl_MethodThreadMutex);
     return_ACPI_STATUS (Status);
 
 
@@ -918,8 +1473,10 @@ AcpiDsTerminateControlMethod (
          *    case we want make the objects permanent.
          * 2) There are other threads executing the method, in which case we
          *    will wait until the last thread has completed.
+         * 3) This is a parallel method, which creates no namespace objects.
          */
-        if (!(MethodDesc->Method.InfoFlags & ACPI_METHOD_MODULE_LEVEL) &&
+        if (!(MethodDesc->Method.InfoFlags &
+                (ACPI_METHOD_MODULE_LEVEL | ACPI_METHOD_PARALLEL)) &&
              (MethodDesc->Method.ThreadCount == 1))
         {
             /* Delete any direct children of (created by) this method */
@@ -968,6 +1525,7 @@ AcpiDsTerminateControlMethod (
 
     /* Decrement the thread count on the method */
 
+    (void) AcpiOsAcquireMutex (AcpiGbl_MethodThreadMutex, ACPI_WAIT_FOREVER);
     if (MethodDesc->Method.ThreadCount)
     {
         MethodDesc->Method.ThreadCount--;
@@ -1040,6 +1598,7 @@ AcpiDsTerminateControlMethod (
             AcpiUtReleaseOwnerId (&MethodDesc->Method.OwnerId);
         }
     }
+    AcpiOsReleaseMutex (AcpiGbl_MethodThreadMutex);
 
     AcpiExStopTraceMethod ((ACPI_NAMESPACE_NODE *) MethodDesc->Method.Node,
         MethodDesc, WalkState);
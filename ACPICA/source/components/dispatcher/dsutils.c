@@ -685,10 +685,21 @@ AcpiDsCreateOperand (
                 InterpreterMode = ACPI_IMODE_EXECUTE;
             }
 
-            Status = AcpiNsLookup (WalkState->ScopeInfo, NameString,
-                ACPI_TYPE_ANY, InterpreterMode,
-                ACPI_NS_SEARCH_PARENT | ACPI_NS_DONT_OPEN_SCOPE, WalkState,
-                ACPI_CAST_INDIRECT_PTR (ACPI_NAMESPACE_NODE, &ObjDesc));
+            if (InterpreterMode == ACPI_IMODE_EXECUTE)
+            {
+                /* Same reference the parser just resolved, may be cached */
+
+                Status = AcpiNsLookupMethodName (WalkState,
+                    Arg->Common.Value.String,
+                    ACPI_CAST_INDIRECT_PTR (ACPI_NAMESPACE_NODE, &ObjDesc));
+            }
+            else
+            {
+                Status = AcpiNsLookup (WalkState->ScopeInfo, NameString,
+                    ACPI_TYPE_ANY, InterpreterMode,
+                    ACPI_NS_SEARCH_PARENT | ACPI_NS_DONT_OPEN_SCOPE, WalkState,
+                    ACPI_CAST_INDIRECT_PTR (ACPI_NAMESPACE_NODE, &ObjDesc));
+            }
             /*
              * The only case where we pass through (ignore) a NOT_FOUND
              * error is for the CondRefOf opcode.
@@ -303,8 +303,15 @@ AcpiEvAddressSpaceDispatch (
 
     /*
      * It may be the case that the region has never been initialized.
-     * Some types of regions require special init code
+     * Some types of regions require special init code. Setup changes the
+     * region, so a thread holding the interpreter shared takes it to
+     * itself first (and then sees any setup done while it waited).
      */
+    if (!(RegionObj->Region.Flags & AOPOBJ_SETUP_COMPLETE))
+    {
+        AcpiExUpgradeInterpreter ();
+    }
+
     if (!(RegionObj->Region.Flags & AOPOBJ_SETUP_COMPLETE))
     {
         /* This region has not been initialized yet, do it */
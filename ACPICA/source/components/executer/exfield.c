@@ -259,6 +259,7 @@ AcpiExReadDataFromField (
 {
     ACPI_STATUS             Status;
     ACPI_OPERAND_OBJECT     *BufferDesc;
+    ACPI_REGION_LOCK        *RegionLock;
     void                    *Buffer;
     UINT32                  BufferLength;
 
@@ -301,6 +302,7 @@ AcpiExReadDataFromField (
     {
         /* SMBus, GSBus, IPMI serial */
 
+        AcpiExUpgradeInterpreter ();
         Status = AcpiExReadSerialBus (ObjDesc, RetBufferDesc);
         return_ACPI_STATUS (Status);
     }
@@ -353,6 +355,7 @@ AcpiExReadDataFromField (
     {
         /* General Purpose I/O */
 
+        AcpiExUpgradeInterpreter ();
         Status = AcpiExReadGpio (ObjDesc, Buffer);
         goto Exit;
     }
@@ -386,10 +389,12 @@ AcpiExReadDataFromField (
     /* Lock entire transaction if requested */
 
     AcpiExAcquireGlobalLock (ObjDesc->CommonField.FieldFlags);
+    RegionLock = AcpiExAcquireRegionLock (ObjDesc);
 
     /* Read from the field */
 
     Status = AcpiExExtractFromField (ObjDesc, Buffer, BufferLength);
+    AcpiExReleaseRegionLock (RegionLock);
     AcpiExReleaseGlobalLock (ObjDesc->CommonField.FieldFlags);
 
 
@@ -428,6 +433,7 @@ AcpiExWriteDataToField (
     ACPI_OPERAND_OBJECT     **ResultDesc)
 {
     ACPI_STATUS             Status;
+    ACPI_REGION_LOCK        *RegionLock;
     UINT32                  BufferLength;
     UINT32                  DataLength;
     void                    *Buffer;
@@ -463,6 +469,7 @@ AcpiExWriteDataToField (
     {
         /* General Purpose I/O */
 
+        AcpiExUpgradeInterpreter ();
         Status = AcpiExWriteGpio (SourceDesc, ObjDesc, ResultDesc);
         return_ACPI_STATUS (Status);
     }
@@ -475,6 +482,7 @@ AcpiExWriteDataToField (
     {
         /* SMBus, GSBus, IPMI serial */
 
+        AcpiExUpgradeInterpreter ();
         Status = AcpiExWriteSerialBus (SourceDesc, ObjDesc, ResultDesc);
         return_ACPI_STATUS (Status);
     }
@@ -488,6 +496,7 @@ AcpiExWriteDataToField (
          * of the field. This is considered safer because some firmware tools
          * are known to obfiscate named objects.
          */
+        AcpiExUpgradeInterpreter ();
         DataLength = (ACPI_SIZE) ACPI_ROUND_BITS_UP_TO_BYTES (
             ObjDesc->Field.BitLength);
         memcpy (ObjDesc->Field.RegionObj->Field.InternalPccBuffer +
@@ -552,10 +561,12 @@ AcpiExWriteDataToField (
     /* Lock entire transaction if requested */
 
     AcpiExAcquireGlobalLock (ObjDesc->CommonField.FieldFlags);
+    RegionLock = AcpiExAcquireRegionLock (ObjDesc);
 
     /* Write to the field */
 
     Status = AcpiExInsertIntoField (ObjDesc, Buffer, BufferLength);
+    AcpiExReleaseRegionLock (RegionLock);
     AcpiExReleaseGlobalLock (ObjDesc->CommonField.FieldFlags);
     return_ACPI_STATUS (Status);
 }
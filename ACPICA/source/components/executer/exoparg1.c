@@ -1063,7 +1063,11 @@ AcpiExOpcode_1A_0T_1R (
                  * 1) Find the owning Node
                  * 2) Dereference the node to an actual object. Could be a
                  *    Field, so we need to resolve the node to a value.
+                 *
+                 * The lookup goes through the path cache, which is only
+                 * for threads with the interpreter to themselves.
                  */
+                AcpiExUpgradeInterpreter ();
                 Status = AcpiNsGetNodeUnlocked (WalkState->ScopeInfo->Scope.Node,
                     Operand[0]->String.Pointer,
                     ACPI_NS_SEARCH_PARENT,
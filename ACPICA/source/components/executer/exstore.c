@@ -352,6 +352,18 @@ AcpiExStoreObjectToIndex (
     ACPI_FUNCTION_TRACE (ExStoreObjectToIndex);
 
 
+    /* Buffers and packages may be seen by other threads */
+
+    AcpiExUpgradeInterpreter ();
+
+    /* The device ID map may hold the value of this package or string */
+
+    if (((ACPI_OPERAND_OBJECT *) IndexDesc->Reference.Object)->Common.Flags &
+        AOPOBJ_DEVICE_ID)
+    {
+        AcpiNsInvalidateDeviceIdMap ();
+    }
+
     /*
      * Destination must be a reference pointer, and
      * must point to either a buffer or a package
@@ -535,8 +547,30 @@ AcpiExStoreObjectToNode (
     /* Get current type of the node, and object attached to Node */
 
     TargetType = AcpiNsGetType (Node);
+
+    /*
+     * Field units are stored to under their region lock. Anything else
+     * changes a named object in place, which needs the interpreter to
+     * ourselves; look at the node again after getting it.
+     */
+    if ((WalkState->Opcode == AML_COPY_OBJECT_OP) ||
+        ((TargetType != ACPI_TYPE_LOCAL_REGION_FIELD) &&
+         (TargetType != ACPI_TYPE_LOCAL_BANK_FIELD) &&
+         (TargetType != ACPI_TYPE_LOCAL_INDEX_FIELD)))
+    {
+        AcpiExUpgradeInterpreter ();
+        TargetType = AcpiNsGetType (Node);
+    }
+
     TargetDesc = AcpiNsGetAttachedObject (Node);
 
+    /* A _HID or _CID whose value is held by the device ID map */
+
+    if (TargetDesc && (TargetDesc->Common.Flags & AOPOBJ_DEVICE_ID))
+    {
+        AcpiNsInvalidateDeviceIdMap ();
+    }
+
     ACPI_DEBUG_PRINT ((ACPI_DB_EXEC, "Storing %p [%s] to node %p [%s]\n",
         SourceDesc, AcpiUtGetObjectTypeName (SourceDesc),
         Node, AcpiUtGetTypeName (TargetType)));
@@ -180,6 +180,19 @@ AcpiExDigitsNeeded (
     UINT64                  Value,
     UINT32                  Base);
 
+static ACPI_INTERPRETER_HOLDER *
+AcpiExFindHolder (
+    ACPI_THREAD_ID          ThreadId);
+
+static void
+AcpiExTakeShared (
+    ACPI_INTERPRETER_HOLDER *Holder);
+
+static void
+AcpiExReleaseShared (
+    ACPI_INTERPRETER_HOLDER *Holder,
+    UINT8                   State);
+
 
 /*******************************************************************************
  *
@@ -193,18 +206,36 @@ AcpiExDigitsNeeded (
  *              the interpreter region is a fatal system error. Used in
  *              conjunction with ExitInterpreter.
  *
+ *              A thread running a parallel method that let go of the
+ *              interpreter to block gets it back shared, as it had it.
+ *
  ******************************************************************************/
 
 void
 AcpiExEnterInterpreter (
     void)
 {
+    ACPI_INTERPRETER_HOLDER *Holder = NULL;
+    ACPI_CPU_FLAGS          LockFlags;
     ACPI_STATUS             Status;
 
 
     ACPI_FUNCTION_TRACE (ExEnterInterpreter);
 
 
+    if (AcpiGbl_InterpreterHolderCount)
+    {
+        LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+        Holder = AcpiExFindHolder (AcpiOsGetThreadId ());
+        AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+    }
+
+    if (Holder && (Holder->State == ACPI_INTERPRETER_SUSPENDED))
+    {
+        AcpiExTakeShared (Holder);
+        return_VOID;
+    }
+
     Status = AcpiUtAcquireMutex (ACPI_MTX_INTERPRETER);
     if (ACPI_FAILURE (Status))
     {
@@ -241,18 +272,38 @@ AcpiExEnterInterpreter (
  *          method that is currently executing
  *      6) About to invoke a user-installed opregion handler
  *
+ * A thread that holds the interpreter shared is suspended instead, and
+ * gets it back shared from AcpiExEnterInterpreter.
+ *
  ******************************************************************************/
 
 void
 AcpiExExitInterpreter (
     void)
 {
+    ACPI_INTERPRETER_HOLDER *Holder;
+    ACPI_THREAD_ID          ThreadId = AcpiOsGetThreadId ();
+    ACPI_CPU_FLAGS          LockFlags;
     ACPI_STATUS             Status;
 
 
     ACPI_FUNCTION_TRACE (ExExitInterpreter);
 
 
+    if (AcpiGbl_InterpreterHolderCount &&
+        (AcpiGbl_MutexInfo[ACPI_MTX_INTERPRETER].ThreadId != ThreadId))
+    {
+        LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+        Holder = AcpiExFindHolder (ThreadId);
+        AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+        if (Holder && (Holder->State == ACPI_INTERPRETER_SHARED))
+        {
+            AcpiExReleaseShared (Holder, ACPI_INTERPRETER_SUSPENDED);
+            return_VOID;
+        }
+    }
+
     Status = AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
     if (ACPI_FAILURE (Status))
     {
@@ -268,6 +319,503 @@ AcpiExExitInterpreter (
 }
 
 
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExEnterInterpreterShared
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Enter the interpreter to run a parallel method (one marked
+ *              ACPI_METHOD_PARALLEL at load time). Any number of threads can
+ *              hold the interpreter shared; a thread that takes it exclusive
+ *              with AcpiExEnterInterpreter, or takes the namespace mutex,
+ *              waits until they have all left or suspended.
+ *
+ *              The shared holders are kept out of each other's way by the
+ *              region locks (AcpiExAcquireRegionLock) and by taking the
+ *              interpreter exclusive (AcpiExUpgradeInterpreter) before
+ *              anything else that changes an object others can see. Used
+ *              in conjunction with AcpiExExitInterpreterShared.
+ *
+ ******************************************************************************/
+
+void
+AcpiExEnterInterpreterShared (
+    void)
+{
+    ACPI_INTERPRETER_HOLDER *Holder;
+    ACPI_THREAD_ID          ThreadId = AcpiOsGetThreadId ();
+    ACPI_CPU_FLAGS          LockFlags;
+    UINT32                  i;
+
+
+    ACPI_FUNCTION_TRACE (ExEnterInterpreterShared);
+
+
+    /* Method tracing changes the global debug level for the method */
+
+    if (!AcpiGbl_ParallelMethods || AcpiGbl_TraceMethodName)
+    {
+        AcpiExEnterInterpreter ();
+        return_VOID;
+    }
+
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    Holder = AcpiExFindHolder (ThreadId);
+    if (Holder)
+    {
+        /* Evaluation from a region handler called by a shared holder */
+
+        Holder->Depth++;
+        AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+        AcpiExEnterInterpreter ();
+        return_VOID;
+    }
+
+    for (i = 0; i < ACPI_INTERPRETER_MAX_SHARED; i++)
+    {
+        if (!AcpiGbl_InterpreterHolders[i].ThreadId)
+        {
+            Holder = &AcpiGbl_InterpreterHolders[i];
+            Holder->ThreadId = ThreadId;
+            Holder->Depth = 0;
+            Holder->State = ACPI_INTERPRETER_SUSPENDED;
+            AcpiGbl_InterpreterHolderCount++;
+            break;
+        }
+    }
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+    /* Too many threads at once, this one runs alone */
+
+    if (!Holder)
+    {
+        AcpiExEnterInterpreter ();
+        return_VOID;
+    }
+
+    AcpiExTakeShared (Holder);
+    return_VOID;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExExitInterpreterShared
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Exit the interpreter after AcpiExEnterInterpreterShared, in
+ *              whichever mode the thread now holds it.
+ *
+ ******************************************************************************/
+
+void
+AcpiExExitInterpreterShared (
+    void)
+{
+    ACPI_INTERPRETER_HOLDER *Holder;
+    ACPI_CPU_FLAGS          LockFlags;
+
+
+    ACPI_FUNCTION_TRACE (ExExitInterpreterShared);
+
+
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    Holder = AcpiExFindHolder (AcpiOsGetThreadId ());
+    if (Holder && Holder->Depth)
+    {
+        Holder->Depth--;
+        Holder = NULL;
+    }
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+    if (!Holder)
+    {
+        AcpiExExitInterpreter ();
+        return_VOID;
+    }
+
+    if (Holder->State == ACPI_INTERPRETER_SHARED)
+    {
+        AcpiExReleaseShared (Holder, 0);
+        return_VOID;
+    }
+
+    /* Upgraded: release it exclusive, then the slot */
+
+    AcpiExExitInterpreter ();
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    Holder->ThreadId = 0;
+    AcpiGbl_InterpreterHolderCount--;
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+    return_VOID;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExUpgradeInterpreter
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: If the current thread holds the interpreter shared, take it
+ *              exclusive for the rest of the evaluation. Called before
+ *              calling a method that is not parallel, storing to anything
+ *              but a Local or a field unit, and the other operations that
+ *              change an object shared with other threads. No-op otherwise.
+ *
+ *              Like a method blocking, this lets other threads run before
+ *              the caller continues.
+ *
+ ******************************************************************************/
+
+void
+AcpiExUpgradeInterpreter (
+    void)
+{
+    ACPI_INTERPRETER_HOLDER *Holder;
+    ACPI_CPU_FLAGS          LockFlags;
+
+
+    if (!AcpiGbl_InterpreterHolderCount)
+    {
+        return;
+    }
+
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    Holder = AcpiExFindHolder (AcpiOsGetThreadId ());
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+    if (!Holder || (Holder->State != ACPI_INTERPRETER_SHARED))
+    {
+        return;
+    }
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_EXEC,
+        "Thread %u upgrading to the exclusive interpreter\n",
+        (UINT32) Holder->ThreadId));
+
+    AcpiExReleaseShared (Holder, ACPI_INTERPRETER_UPGRADED);
+    AcpiExEnterInterpreter ();
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExInterpreterIsShared
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      TRUE if the current thread holds the interpreter shared
+ *
+ * DESCRIPTION: Used to skip the caches and other global state that a
+ *              thread may only touch with the interpreter to itself.
+ *
+ ******************************************************************************/
+
+BOOLEAN
+AcpiExInterpreterIsShared (
+    void)
+{
+    ACPI_INTERPRETER_HOLDER *Holder;
+    ACPI_CPU_FLAGS          LockFlags;
+
+
+    if (!AcpiGbl_InterpreterHolderCount)
+    {
+        return (FALSE);
+    }
+
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    Holder = AcpiExFindHolder (AcpiOsGetThreadId ());
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+    return (Holder && (Holder->State == ACPI_INTERPRETER_SHARED));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExWaitForSharedHolders
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Wait until no thread holds the interpreter shared. Called by
+ *              AcpiUtAcquireMutex with the namespace mutex just acquired,
+ *              which keeps new shared holders out: every thread that takes
+ *              the interpreter exclusive or changes the namespace holds the
+ *              namespace mutex, so this is all of them waiting.
+ *
+ ******************************************************************************/
+
+void
+AcpiExWaitForSharedHolders (
+    void)
+{
+    ACPI_CPU_FLAGS          LockFlags;
+
+
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    while (AcpiGbl_InterpreterReaders)
+    {
+        AcpiGbl_InterpreterDrainWaiting = TRUE;
+        AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+        (void) AcpiOsWaitSemaphore (AcpiGbl_InterpreterDrained,
+            1, ACPI_WAIT_FOREVER);
+
+        LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    }
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExFindHolder
+ *
+ * PARAMETERS:  ThreadId        - Thread to look for
+ *
+ * RETURN:      The thread's shared holder slot, NULL if it has none
+ *
+ * DESCRIPTION: Caller holds AcpiGbl_InterpreterLock. Only the thread itself
+ *              changes its slot after that, so the slot may be read without
+ *              the lock.
+ *
+ ******************************************************************************/
+
+static ACPI_INTERPRETER_HOLDER *
+AcpiExFindHolder (
+    ACPI_THREAD_ID          ThreadId)
+{
+    UINT32                  i;
+
+
+    for (i = 0; i < ACPI_INTERPRETER_MAX_SHARED; i++)
+    {
+        if (AcpiGbl_InterpreterHolders[i].ThreadId == ThreadId)
+        {
+            return (&AcpiGbl_InterpreterHolders[i]);
+        }
+    }
+
+    return (NULL);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExTakeShared
+ *
+ * PARAMETERS:  Holder          - Current thread's slot, not counted
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Count the thread among the shared holders. Passing through
+ *              the namespace mutex makes it wait for an exclusive holder.
+ *
+ ******************************************************************************/
+
+static void
+AcpiExTakeShared (
+    ACPI_INTERPRETER_HOLDER *Holder)
+{
+    ACPI_MUTEX              NamespaceMutex;
+    ACPI_CPU_FLAGS          LockFlags;
+
+
+    NamespaceMutex = AcpiGbl_MutexInfo[ACPI_MTX_NAMESPACE].Mutex;
+    (void) AcpiOsAcquireMutex (NamespaceMutex, ACPI_WAIT_FOREVER);
+
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    AcpiGbl_InterpreterReaders++;
+    Holder->State = ACPI_INTERPRETER_SHARED;
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+    AcpiOsReleaseMutex (NamespaceMutex);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExReleaseShared
+ *
+ * PARAMETERS:  Holder          - Current thread's slot, counted
+ *              State           - New state, zero to free the slot
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Stop counting the thread among the shared holders, waking
+ *              an exclusive waiter if it was the last.
+ *
+ ******************************************************************************/
+
+static void
+AcpiExReleaseShared (
+    ACPI_INTERPRETER_HOLDER *Holder,
+    UINT8                   State)
+{
+    ACPI_CPU_FLAGS          LockFlags;
+    BOOLEAN                 Wake = FALSE;
+
+
+    LockFlags = AcpiOsAcquireLock (AcpiGbl_InterpreterLock);
+    AcpiGbl_InterpreterReaders--;
+    if (!AcpiGbl_InterpreterReaders && AcpiGbl_InterpreterDrainWaiting)
+    {
+        AcpiGbl_InterpreterDrainWaiting = FALSE;
+        Wake = TRUE;
+    }
+
+    if (State)
+    {
+        Holder->State = State;
+    }
+    else
+    {
+        Holder->ThreadId = 0;
+        AcpiGbl_InterpreterHolderCount--;
+    }
+    AcpiOsReleaseLock (AcpiGbl_InterpreterLock, LockFlags);
+
+    if (Wake)
+    {
+        (void) AcpiOsSignalSemaphore (AcpiGbl_InterpreterDrained, 1);
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExAcquireRegionLock
+ *
+ * PARAMETERS:  ObjDesc         - Field unit about to be read or written
+ *
+ * RETURN:      Lock to pass to AcpiExReleaseRegionLock, NULL if none taken
+ *
+ * DESCRIPTION: Serialize field accesses to one operation region among the
+ *              threads that hold the interpreter shared. An index field is
+ *              keyed by the region of its index register, so the index and
+ *              data accesses are one transaction. Exclusive holders take no
+ *              region lock, and never wait for one.
+ *
+ *              A thread waiting for a region lock is suspended, and one
+ *              that would wait for a second region lock takes the
+ *              interpreter exclusive instead, so region locks cannot
+ *              deadlock with each other or with the interpreter.
+ *
+ ******************************************************************************/
+
+ACPI_REGION_LOCK *
+AcpiExAcquireRegionLock (
+    ACPI_OPERAND_OBJECT     *ObjDesc)
+{
+    ACPI_OPERAND_OBJECT     *RegionObj;
+    ACPI_OPERAND_OBJECT     *IndexObj;
+    ACPI_REGION_LOCK        *Lock;
+    ACPI_THREAD_ID          ThreadId;
+    UINT32                  i;
+
+
+    if (!AcpiExInterpreterIsShared ())
+    {
+        return (NULL);
+    }
+
+    switch (ObjDesc->Common.Type)
+    {
+    case ACPI_TYPE_LOCAL_REGION_FIELD:
+
+        RegionObj = ObjDesc->Field.RegionObj;
+        break;
+
+    case ACPI_TYPE_LOCAL_BANK_FIELD:
+
+        RegionObj = ObjDesc->BankField.RegionObj;
+        break;
+
+    case ACPI_TYPE_LOCAL_INDEX_FIELD:
+
+        IndexObj = ObjDesc->IndexField.IndexObj;
+        RegionObj = (IndexObj->Common.Type == ACPI_TYPE_LOCAL_BANK_FIELD) ?
+            IndexObj->BankField.RegionObj : IndexObj->Field.RegionObj;
+        break;
+
+    default:
+
+        /* Buffer fields are only read by shared holders */
+
+        return (NULL);
+    }
+
+    Lock = &AcpiGbl_RegionLocks[(ACPI_TO_INTEGER (RegionObj) /
+        sizeof (ACPI_OPERAND_OBJECT)) % ACPI_REGION_LOCK_COUNT];
+
+    ThreadId = AcpiOsGetThreadId ();
+    if (Lock->ThreadId == ThreadId)
+    {
+        Lock->Depth++;
+        return (Lock);
+    }
+
+    if (ACPI_FAILURE (AcpiOsAcquireMutex (Lock->Mutex, 0)))
+    {
+        for (i = 0; i < ACPI_REGION_LOCK_COUNT; i++)
+        {
+            if (AcpiGbl_RegionLocks[i].ThreadId == ThreadId)
+            {
+                AcpiExUpgradeInterpreter ();
+                return (NULL);
+            }
+        }
+
+        AcpiExExitInterpreter ();
+        (void) AcpiOsAcquireMutex (Lock->Mutex, ACPI_WAIT_FOREVER);
+        AcpiExEnterInterpreter ();
+    }
+
+    Lock->ThreadId = ThreadId;
+    Lock->Depth = 1;
+    return (Lock);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiExReleaseRegionLock
+ *
+ * PARAMETERS:  Lock            - Returned by AcpiExAcquireRegionLock
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Release a region lock, if one was taken.
+ *
+ ******************************************************************************/
+
+void
+AcpiExReleaseRegionLock (
+    ACPI_REGION_LOCK        *Lock)
+{
+
+    if (!Lock || --Lock->Depth)
+    {
+        return;
+    }
+
+    Lock->ThreadId = 0;
+    AcpiOsReleaseMutex (Lock->Mutex);
+}
+
+
 /*******************************************************************************
  *
  * FUNCTION:    AcpiExTruncateFor32bitTable
@@ -346,6 +894,12 @@ AcpiExAcquireGlobalLock (
         return_VOID;
     }
 
+    /*
+     * The Global Lock is only ever taken with the interpreter exclusive,
+     * so waiting for it never holds up a thread that wants the interpreter
+     */
+    AcpiExUpgradeInterpreter ();
+
     /* Attempt to get the global lock, wait forever */
 
     Status = AcpiExAcquireMutexObject (ACPI_WAIT_FOREVER,
@@ -154,6 +154,7 @@
 #include "amlcode.h"
 #include "acnamesp.h"
 #include "acdispat.h"
+#include "acinterp.h"
 
 #ifdef ACPI_ASL_COMPILER
     #include "acdisasm.h"
@@ -162,6 +163,20 @@
 #define _COMPONENT          ACPI_NAMESPACE
         ACPI_MODULE_NAME    ("nsaccess")
 
+/* Local prototypes */
+
+static ACPI_METHOD_NAME_CACHE *
+AcpiNsCreateMethodCache (
+    ACPI_OPERAND_OBJECT     *MethodDesc);
+
+static void
+AcpiNsUnlinkMethodCache (
+    ACPI_METHOD_NAME_CACHE  *Cache);
+
+static void
+AcpiNsEvictMethodCaches (
+    UINT32                  Needed);
+
 
 /*******************************************************************************
  *
@@ -251,7 +266,7 @@ AcpiNsRootInitialize (
          * predefined names are at the root level. It is much easier to
          * just create and link the new node(s) here.
          */
-        NewNode = AcpiNsCreateNode (*ACPI_CAST_PTR (UINT32, InitVal->Name));
+        NewNode = AcpiNsCreateNode (*ACPI_CAST_PTR (UINT32, InitVal->Name), 0);
         if (!NewNode)
         {
             Status = AE_NO_MEMORY;
@@ -917,3 +932,334 @@ AcpiNsLookup (
     *ReturnNode = ThisNode;
     return_ACPI_STATUS (AE_OK);
 }
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsLookupMethodName
+ *
+ * PARAMETERS:  WalkState       - Current state of the method walk
+ *              AmlPath         - NamePath within the AML of the method
+ *              ReturnNode      - Where the Node is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Resolve a name reference made by executing AML, as
+ *              AcpiNsLookup does in ACPI_IMODE_EXECUTE with parent search
+ *              and without opening a scope. Results for permanent nodes are
+ *              remembered in the method's name cache, so the parser and the
+ *              dispatcher resolve each reference of a hot method (_STA,
+ *              EC _Qxx) once per namespace generation rather than on every
+ *              invocation.
+ *
+ *              Only methods that have no named objects of their own use
+ *              the cache, since such a method-local name could shadow a
+ *              cached result, and only from permanent scopes, since a
+ *              temporary scope can be deleted and its node reused. Other
+ *              temporary names invalidate the cache when they are created
+ *              and deleted (AcpiNsAffectsCachedLookups). Threads that hold
+ *              the interpreter shared look names up without it.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiNsLookupMethodName (
+    ACPI_WALK_STATE         *WalkState,
+    char                    *AmlPath,
+    ACPI_NAMESPACE_NODE     **ReturnNode)
+{
+    ACPI_OPERAND_OBJECT     *MethodDesc = WalkState->MethodDesc;
+    ACPI_METHOD_NAME_CACHE  *Cache = NULL;
+    ACPI_NAMESPACE_NODE     *ScopeNode = NULL;
+    ACPI_METHOD_NAME_SLOT   *Slot;
+    ACPI_STATUS             Status;
+    UINT32                  Offset = 0;
+
+
+    if (AcpiGbl_MethodCacheBudget &&
+        MethodDesc &&
+        (MethodDesc->Common.Type == ACPI_TYPE_METHOD) &&
+        !(MethodDesc->Method.InfoFlags &
+            (ACPI_METHOD_MODULE_LEVEL | ACPI_METHOD_INTERNAL_ONLY)) &&
+        WalkState->MethodNode &&
+        !(WalkState->MethodNode->Flags & ANOBJ_TEMPORARY) &&
+        !WalkState->MethodNode->Child &&
+        WalkState->ScopeInfo &&
+        WalkState->ScopeInfo->Scope.Node &&
+        !(WalkState->ScopeInfo->Scope.Node->Flags & ANOBJ_TEMPORARY) &&
+        (ACPI_CAST_PTR (UINT8, AmlPath) >= MethodDesc->Method.AmlStart) &&
+        (ACPI_CAST_PTR (UINT8, AmlPath) <
+            (MethodDesc->Method.AmlStart + MethodDesc->Method.AmlLength)) &&
+        !AcpiExInterpreterIsShared ())
+    {
+        ScopeNode = WalkState->ScopeInfo->Scope.Node;
+        Offset = (UINT32) ACPI_PTR_DIFF (AmlPath, MethodDesc->Method.AmlStart);
+
+        Cache = MethodDesc->Method.NameCache;
+        if (Cache)
+        {
+            /* Namespace changes (or new AML) invalidate every slot */
+
+            if ((Cache->Generation != AcpiGbl_NsPathCacheGeneration) ||
+                (Cache->AmlStart != MethodDesc->Method.AmlStart))
+            {
+                memset (Cache->Slots, 0,
+                    (Cache->SlotMask + 1) * sizeof (ACPI_METHOD_NAME_SLOT));
+                Cache->Generation = AcpiGbl_NsPathCacheGeneration;
+                Cache->AmlStart = MethodDesc->Method.AmlStart;
+            }
+
+            Slot = &Cache->Slots[((Offset * 0x9E3779B1) >> 16) & Cache->SlotMask];
+            if (Slot->Node &&
+                (Slot->AmlOffset == Offset) &&
+                (Slot->ScopeNode == ScopeNode))
+            {
+                Cache->Referenced = TRUE;
+                AcpiGbl_MethodCacheHits++;
+                *ReturnNode = Slot->Node;
+                return (AE_OK);
+            }
+        }
+
+        AcpiGbl_MethodCacheMisses++;
+    }
+
+    Status = AcpiNsLookup (WalkState->ScopeInfo, AmlPath, ACPI_TYPE_ANY,
+        ACPI_IMODE_EXECUTE, ACPI_NS_SEARCH_PARENT | ACPI_NS_DONT_OPEN_SCOPE,
+        WalkState, ReturnNode);
+    if (ACPI_FAILURE (Status) ||
+        !ScopeNode ||
+        ((*ReturnNode)->Flags & ANOBJ_TEMPORARY))
+    {
+        return (Status);
+    }
+
+    /* Remember the result, creating the cache on the first miss */
+
+    if (!Cache)
+    {
+        Cache = AcpiNsCreateMethodCache (MethodDesc);
+        if (!Cache)
+        {
+            return (Status);
+        }
+    }
+
+    Slot = &Cache->Slots[((Offset * 0x9E3779B1) >> 16) & Cache->SlotMask];
+    Slot->ScopeNode = ScopeNode;
+    Slot->Node = *ReturnNode;
+    Slot->AmlOffset = Offset;
+    Cache->Referenced = TRUE;
+    return (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsCreateMethodCache
+ *
+ * PARAMETERS:  MethodDesc      - Method object that gets the cache
+ *
+ * RETURN:      New, empty name cache (NULL if none could be made)
+ *
+ * DESCRIPTION: Allocate a name cache sized for the method's AML, evicting
+ *              other methods' caches as needed to stay within
+ *              AcpiGbl_MethodCacheBudget.
+ *
+ ******************************************************************************/
+
+static ACPI_METHOD_NAME_CACHE *
+AcpiNsCreateMethodCache (
+    ACPI_OPERAND_OBJECT     *MethodDesc)
+{
+    ACPI_METHOD_NAME_CACHE  *Cache = NULL;
+    ACPI_STATUS             Status;
+    UINT32                  SlotCount = ACPI_METHOD_CACHE_MIN_SLOTS;
+    UINT32                  Size;
+
+
+    while ((SlotCount < ACPI_METHOD_CACHE_MAX_SLOTS) &&
+           ((SlotCount * 16) < MethodDesc->Method.AmlLength))
+    {
+        SlotCount <<= 1;
+    }
+
+    Size = sizeof (ACPI_METHOD_NAME_CACHE) +
+        ((SlotCount - 1) * sizeof (ACPI_METHOD_NAME_SLOT));
+    if (Size > AcpiGbl_MethodCacheBudget)
+    {
+        return (NULL);
+    }
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_CACHES);
+    if (ACPI_FAILURE (Status))
+    {
+        return (NULL);
+    }
+
+    AcpiNsEvictMethodCaches (Size);
+    if ((AcpiGbl_MethodCacheBytes + Size) > AcpiGbl_MethodCacheBudget)
+    {
+        goto UnlockAndExit;
+    }
+
+    Cache = ACPI_ALLOCATE_ZEROED (Size);
+    if (!Cache)
+    {
+        goto UnlockAndExit;
+    }
+
+    Cache->MethodDesc = MethodDesc;
+    Cache->AmlStart = MethodDesc->Method.AmlStart;
+    Cache->Generation = AcpiGbl_NsPathCacheGeneration;
+    Cache->SlotMask = SlotCount - 1;
+    Cache->Size = Size;
+
+    Cache->Next = AcpiGbl_MethodCacheList;
+    if (AcpiGbl_MethodCacheList)
+    {
+        AcpiGbl_MethodCacheList->Prev = Cache;
+    }
+
+    AcpiGbl_MethodCacheList = Cache;
+    AcpiGbl_MethodCacheBytes += Size;
+    MethodDesc->Method.NameCache = Cache;
+
+UnlockAndExit:
+    (void) AcpiUtReleaseMutex (ACPI_MTX_CACHES);
+    return (Cache);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsUnlinkMethodCache
+ *
+ * PARAMETERS:  Cache           - Cache to remove from the global list
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Unlink a name cache and return its bytes to the budget.
+ *              Caller holds ACPI_MTX_CACHES.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsUnlinkMethodCache (
+    ACPI_METHOD_NAME_CACHE  *Cache)
+{
+
+    if (AcpiGbl_MethodCacheClock == Cache)
+    {
+        AcpiGbl_MethodCacheClock = Cache->Next;
+    }
+
+    if (Cache->Prev)
+    {
+        Cache->Prev->Next = Cache->Next;
+    }
+    else
+    {
+        AcpiGbl_MethodCacheList = Cache->Next;
+    }
+
+    if (Cache->Next)
+    {
+        Cache->Next->Prev = Cache->Prev;
+    }
+
+    AcpiGbl_MethodCacheBytes -= Cache->Size;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsEvictMethodCaches
+ *
+ * PARAMETERS:  Needed          - Bytes about to be allocated
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Free least recently used name caches (clock algorithm: a
+ *              cache used since the hand last passed it gets a second
+ *              chance) until Needed more bytes fit within the budget.
+ *              Caller holds ACPI_MTX_CACHES.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsEvictMethodCaches (
+    UINT32                  Needed)
+{
+    ACPI_METHOD_NAME_CACHE  *Cache;
+
+
+    while (AcpiGbl_MethodCacheList &&
+        ((AcpiGbl_MethodCacheBytes + Needed) > AcpiGbl_MethodCacheBudget))
+    {
+        Cache = AcpiGbl_MethodCacheClock;
+        if (!Cache)
+        {
+            Cache = AcpiGbl_MethodCacheList;
+        }
+
+        if (Cache->Referenced)
+        {
+            Cache->Referenced = FALSE;
+            AcpiGbl_MethodCacheClock = Cache->Next;
+            continue;
+        }
+
+        AcpiNsUnlinkMethodCache (Cache);
+        Cache->MethodDesc->Method.NameCache = NULL;
+        ACPI_FREE (Cache);
+        AcpiGbl_MethodCacheEvictions++;
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeleteMethodCache
+ *
+ * PARAMETERS:  MethodDesc      - Method object being deleted
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Free the name cache of a method object, if it has one. This
+ *              is how the caches of a table's methods go away when the
+ *              table is unloaded.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsDeleteMethodCache (
+    ACPI_OPERAND_OBJECT     *MethodDesc)
+{
+    ACPI_METHOD_NAME_CACHE  *Cache;
+    ACPI_STATUS             Status;
+
+
+    if (!MethodDesc->Method.NameCache)
+    {
+        return;
+    }
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_CACHES);
+    if (ACPI_FAILURE (Status))
+    {
+        return;
+    }
+
+    /* May have been evicted meanwhile */
+
+    Cache = MethodDesc->Method.NameCache;
+    if (Cache)
+    {
+        AcpiNsUnlinkMethodCache (Cache);
+        MethodDesc->Method.NameCache = NULL;
+        ACPI_FREE (Cache);
+    }
+
+    (void) AcpiUtReleaseMutex (ACPI_MTX_CACHES);
+}
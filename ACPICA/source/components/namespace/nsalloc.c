@@ -157,22 +157,341 @@
 #define _COMPONENT          ACPI_NAMESPACE
         ACPI_MODULE_NAME    ("nsalloc")
 
+/* Local prototypes */
+
+static ACPI_NS_NODE_ARENA *
+AcpiNsGetNodeArena (
+    ACPI_OWNER_ID           OwnerId,
+    BOOLEAN                 Create);
+
+static ACPI_NAMESPACE_NODE *
+AcpiNsAllocateArenaNode (
+    ACPI_OWNER_ID           OwnerId);
+
+static void
+AcpiNsReleaseArenaNode (
+    ACPI_NAMESPACE_NODE     *Node);
+
+static void
+AcpiNsDeleteNodeArena (
+    ACPI_OWNER_ID           OwnerId);
+
+static BOOLEAN
+AcpiNsAffectsCachedLookups (
+    ACPI_NAMESPACE_NODE     *ParentNode,
+    ACPI_NAMESPACE_NODE     *Node);
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsGetNodeArena
+ *
+ * PARAMETERS:  OwnerId         - Owner (table) whose arena is wanted
+ *              Create          - Allocate an empty arena if none exists
+ *
+ * RETURN:      The owner's node arena, or NULL
+ *
+ * DESCRIPTION: Find the node arena of an owner. The arena of the table that
+ *              is currently loading is kept at the head of the list, so the
+ *              common case is a single comparison.
+ *
+ ******************************************************************************/
+
+static ACPI_NS_NODE_ARENA *
+AcpiNsGetNodeArena (
+    ACPI_OWNER_ID           OwnerId,
+    BOOLEAN                 Create)
+{
+    ACPI_NS_NODE_ARENA      *Arena;
+    ACPI_NS_NODE_ARENA      *Prev = NULL;
+
+
+    for (Arena = AcpiGbl_NsNodeArenas; Arena; Arena = Arena->Next)
+    {
+        if (Arena->OwnerId == OwnerId)
+        {
+            if (Prev)
+            {
+                /* Move to front */
+
+                Prev->Next = Arena->Next;
+                Arena->Next = AcpiGbl_NsNodeArenas;
+                AcpiGbl_NsNodeArenas = Arena;
+            }
+
+            return (Arena);
+        }
+
+        Prev = Arena;
+    }
+
+    if (!Create)
+    {
+        return (NULL);
+    }
+
+    Arena = ACPI_ALLOCATE_ZEROED (sizeof (ACPI_NS_NODE_ARENA));
+    if (!Arena)
+    {
+        return (NULL);
+    }
+
+    Arena->OwnerId = OwnerId;
+    Arena->Next = AcpiGbl_NsNodeArenas;
+    AcpiGbl_NsNodeArenas = Arena;
+    return (Arena);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsAllocateArenaNode
+ *
+ * PARAMETERS:  OwnerId         - Owner of the new node
+ *
+ * RETURN:      Zeroed node from the owner's arena (Null on failure)
+ *
+ * DESCRIPTION: Take a node from the owner's free list, or carve the next
+ *              node from its newest slab, adding a slab when it is full.
+ *
+ ******************************************************************************/
+
+static ACPI_NAMESPACE_NODE *
+AcpiNsAllocateArenaNode (
+    ACPI_OWNER_ID           OwnerId)
+{
+    ACPI_NS_NODE_ARENA      *Arena;
+    ACPI_NS_NODE_SLAB       *Slab;
+    ACPI_NAMESPACE_NODE     *Node;
+
+
+    Arena = AcpiNsGetNodeArena (OwnerId, TRUE);
+    if (!Arena)
+    {
+        return (NULL);
+    }
+
+    if (Arena->FreeList)
+    {
+        Node = Arena->FreeList;
+        Arena->FreeList = Node->Peer;
+        memset (Node, 0, sizeof (ACPI_NAMESPACE_NODE));
+    }
+    else
+    {
+        Slab = Arena->Slabs;
+        if (!Slab || (Slab->Used >= ACPI_NS_NODE_SLAB_SIZE))
+        {
+            Slab = ACPI_ALLOCATE_ZEROED (sizeof (ACPI_NS_NODE_SLAB));
+            if (!Slab)
+            {
+                return (NULL);
+            }
+
+            Slab->Next = Arena->Slabs;
+            Arena->Slabs = Slab;
+            Arena->SlabCount++;
+        }
+
+        Node = &Slab->Nodes[Slab->Used];
+        Slab->Used++;
+    }
+
+    Arena->LiveNodes++;
+    Node->Flags = ANOBJ_SLAB_ALLOCATED;
+    Node->OwnerId = OwnerId;
+    return (Node);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsReleaseArenaNode
+ *
+ * PARAMETERS:  Node            - Arena node being deleted
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Return a node to its owner's arena. The memory itself is
+ *              released with the arena, when the owner is unloaded.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsReleaseArenaNode (
+    ACPI_NAMESPACE_NODE     *Node)
+{
+    ACPI_NS_NODE_ARENA      *Arena;
+
+
+    ACPI_FUNCTION_NAME (NsReleaseArenaNode);
+
+
+    Arena = AcpiNsGetNodeArena (Node->OwnerId, FALSE);
+    if (!Arena)
+    {
+        ACPI_ERROR ((AE_INFO, "No node arena for Owner %3.3X, Node %p",
+            Node->OwnerId, Node));
+        return;
+    }
+
+    ACPI_SET_DESCRIPTOR_TYPE (Node, ACPI_DESC_TYPE_CACHED);
+    Node->Peer = Arena->FreeList;
+    Arena->FreeList = Node;
+    Arena->LiveNodes--;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeleteNodeArena
+ *
+ * PARAMETERS:  OwnerId         - Owner whose arena is to be freed
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Free all slabs of an owner's arena at once. The arena is kept
+ *              if any of its nodes are still in the namespace.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsDeleteNodeArena (
+    ACPI_OWNER_ID           OwnerId)
+{
+    ACPI_NS_NODE_ARENA      *Arena;
+    ACPI_NS_NODE_SLAB       *Slab;
+
+
+    ACPI_FUNCTION_NAME (NsDeleteNodeArena);
+
+
+    /* The arena is moved to the head of the list by the lookup */
+
+    Arena = AcpiNsGetNodeArena (OwnerId, FALSE);
+    if (!Arena)
+    {
+        return;
+    }
+
+    if (Arena->LiveNodes)
+    {
+        ACPI_DEBUG_PRINT ((ACPI_DB_ALLOCATIONS,
+            "Owner %3.3X: %u nodes still live, keeping node arena\n",
+            OwnerId, Arena->LiveNodes));
+        return;
+    }
+
+    AcpiGbl_NsNodeArenas = Arena->Next;
+    while (Arena->Slabs)
+    {
+        Slab = Arena->Slabs;
+        Arena->Slabs = Slab->Next;
+        ACPI_FREE (Slab);
+    }
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_ALLOCATIONS,
+        "Owner %3.3X: freed node arena of %u slabs\n",
+        OwnerId, Arena->SlabCount));
+    ACPI_FREE (Arena);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsAffectsCachedLookups
+ *
+ * PARAMETERS:  ParentNode      - Scope the node is installed in or deleted
+ *                                from
+ *              Node            - Node being installed or deleted
+ *
+ * RETURN:      TRUE if the lookup caches must be invalidated
+ *
+ * DESCRIPTION: Any permanent node can change a cached lookup. A temporary
+ *              node only changes lookups made from its parent's scope or
+ *              below it, and neither cache uses those when the parent is a
+ *              control method (AcpiNsLookupMethodName bypasses a method's
+ *              cache while the method has children) or is itself temporary
+ *              (lookups from temporary scopes are never cached). Temporary
+ *              nodes anywhere else, such as a Name that a method creates in
+ *              \_SB, invalidate like permanent ones, both when they are
+ *              created and when the method's cleanup deletes them.
+ *
+ ******************************************************************************/
+
+static BOOLEAN
+AcpiNsAffectsCachedLookups (
+    ACPI_NAMESPACE_NODE     *ParentNode,
+    ACPI_NAMESPACE_NODE     *Node)
+{
+
+    if (!(Node->Flags & ANOBJ_TEMPORARY) || !ParentNode)
+    {
+        return (TRUE);
+    }
+
+    return ((ParentNode->Type != ACPI_TYPE_METHOD) &&
+        !(ParentNode->Flags & ANOBJ_TEMPORARY));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeleteNodeArenas
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Free all node arenas. Called at namespace termination, after
+ *              every node has been deleted.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsDeleteNodeArenas (
+    void)
+{
+    ACPI_NS_NODE_ARENA      *Arena;
+    ACPI_NS_NODE_SLAB       *Slab;
+
+
+    while (AcpiGbl_NsNodeArenas)
+    {
+        Arena = AcpiGbl_NsNodeArenas;
+        AcpiGbl_NsNodeArenas = Arena->Next;
+
+        while (Arena->Slabs)
+        {
+            Slab = Arena->Slabs;
+            Arena->Slabs = Slab->Next;
+            ACPI_FREE (Slab);
+        }
+
+        ACPI_FREE (Arena);
+    }
+}
+
 
 /*******************************************************************************
  *
  * FUNCTION:    AcpiNsCreateNode
  *
  * PARAMETERS:  Name            - Name of the new node (4 char ACPI name)
+ *              OwnerId         - Table owner of a permanent node, or zero
  *
  * RETURN:      New namespace node (Null on failure)
  *
- * DESCRIPTION: Create a namespace node
+ * DESCRIPTION: Create a namespace node. Nodes with an OwnerId are allocated
+ *              from that owner's node arena, all others from the namespace
+ *              object cache.
  *
  ******************************************************************************/
 
 ACPI_NAMESPACE_NODE *
 AcpiNsCreateNode (
-    UINT32                  Name)
+    UINT32                  Name,
+    ACPI_OWNER_ID           OwnerId)
 {
     ACPI_NAMESPACE_NODE     *Node;
 #ifdef ACPI_DBG_TRACK_ALLOCATIONS
@@ -183,7 +502,15 @@ AcpiNsCreateNode (
     ACPI_FUNCTION_TRACE (NsCreateNode);
 
 
-    Node = AcpiOsAcquireObject (AcpiGbl_NamespaceCache);
+    if (OwnerId)
+    {
+        Node = AcpiNsAllocateArenaNode (OwnerId);
+    }
+    else
+    {
+        Node = AcpiOsAcquireObject (AcpiGbl_NamespaceCache);
+    }
+
     if (!Node)
     {
         return_PTR (NULL);
@@ -263,6 +590,17 @@ AcpiNsDeleteNode (
         ObjDesc = NextDesc;
     }
 
+    /* A scope that is going away no longer needs its child index */
+
+    AcpiNsDeleteScopeIndex (Node);
+
+    /* Cached lookups may resolve to this node, or through its scope */
+
+    if (AcpiNsAffectsCachedLookups (Node->Parent, Node))
+    {
+        AcpiNsInvalidatePathCache ();
+    }
+
     /* Special case for the statically allocated root node */
 
     if (Node == AcpiGbl_RootNode)
@@ -272,7 +610,14 @@ AcpiNsDeleteNode (
 
     /* Now we can delete the node */
 
-    (void) AcpiOsReleaseObject (AcpiGbl_NamespaceCache, Node);
+    if (Node->Flags & ANOBJ_SLAB_ALLOCATED)
+    {
+        AcpiNsReleaseArenaNode (Node);
+    }
+    else
+    {
+        (void) AcpiOsReleaseObject (AcpiGbl_NamespaceCache, Node);
+    }
 
     ACPI_MEM_TRACKING (AcpiGbl_NsNodeList->TotalFreed++);
     ACPI_DEBUG_PRINT ((ACPI_DB_ALLOCATIONS, "Node %p, Remaining %X\n",
@@ -332,6 +677,8 @@ AcpiNsRemoveNode (
         ParentNode->Child = Node->Peer;
     }
 
+    AcpiNsIndexRemoveNode (ParentNode, Node, PrevNode);
+
     /* Delete the node and any attached objects */
 
     AcpiNsDeleteNode (Node);
@@ -353,9 +700,9 @@ AcpiNsRemoveNode (
  * DESCRIPTION: Initialize a new namespace node and install it amongst
  *              its peers.
  *
- *              Note: Current namespace lookup is linear search. This appears
- *              to be sufficient as namespace searches consume only a small
- *              fraction of the execution time of the ACPI subsystem.
+ *              Scopes that reach AcpiGbl_NamespaceIndexThreshold children
+ *              get a hashed child index, which is kept current here and
+ *              also supplies the tail of the peer list.
  *
  ******************************************************************************/
 
@@ -368,6 +715,7 @@ AcpiNsInstallNode (
 {
     ACPI_OWNER_ID           OwnerId = 0;
     ACPI_NAMESPACE_NODE     *ChildNode;
+    UINT32                  ChildCount = 0;
 
 
     ACPI_FUNCTION_TRACE (NsInstallNode);
@@ -405,23 +753,50 @@ AcpiNsInstallNode (
     {
         ParentNode->Child = Node;
     }
+    else if (ParentNode->ChildIndex && ParentNode->ChildIndex->LastChild)
+    {
+        /* Indexed scopes know their tail, no need to walk the peers */
+
+        ParentNode->ChildIndex->LastChild->Peer = Node;
+    }
     else
     {
         /* Add node to the end of the peer list */
 
+        ChildCount = 1;
         while (ChildNode->Peer)
         {
             ChildNode = ChildNode->Peer;
+            ChildCount++;
         }
 
         ChildNode->Peer = Node;
     }
 
+    /* Keep the child index current, or create one once the scope is wide */
+
+    if (ParentNode->ChildIndex)
+    {
+        AcpiNsIndexInsertNode (ParentNode, Node);
+    }
+    else if (AcpiGbl_NamespaceIndexThreshold &&
+        ((ChildCount + 1) >= AcpiGbl_NamespaceIndexThreshold))
+    {
+        (void) AcpiNsBuildScopeIndex (ParentNode);
+    }
+
     /* Init the new entry */
 
     Node->OwnerId = OwnerId;
     Node->Type = (UINT8) Type;
 
+    /* The new name may shadow references cached by methods */
+
+    if (AcpiNsAffectsCachedLookups (ParentNode, Node))
+    {
+        AcpiNsInvalidatePathCache ();
+    }
+
     ACPI_DEBUG_PRINT ((ACPI_DB_NAMES,
         "%4.4s (%s) [Node %p Owner %3.3X] added to %4.4s (%s) [Node %p]\n",
         AcpiUtGetNodeName (Node), AcpiUtGetTypeName (Node->Type), Node, OwnerId,
@@ -483,9 +858,10 @@ AcpiNsDeleteChildren (
         AcpiNsDeleteNode (NodeToDelete);
     }
 
-    /* Clear the parent's child pointer */
+    /* Clear the parent's child pointer and drop its index */
 
     ParentNode->Child = NULL;
+    AcpiNsDeleteScopeIndex (ParentNode);
     return_VOID;
 }
 
@@ -628,6 +1004,7 @@ AcpiNsDeleteNamespaceByOwner (
         return_VOID;
     }
 
+    AcpiNsInvalidatePathCache ();
     DeletionNode = NULL;
     ParentNode = AcpiGbl_RootNode;
     ChildNode = NULL;
@@ -703,6 +1080,10 @@ AcpiNsDeleteNamespaceByOwner (
         }
     }
 
+    /* All of the owner's nodes are gone, free their slabs in one pass */
+
+    AcpiNsDeleteNodeArena (OwnerId);
+
     (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
     return_VOID;
 }
@@ -160,6 +160,16 @@
 #define _COMPONENT          ACPI_NAMESPACE
         ACPI_MODULE_NAME    ("nseval")
 
+/* Local prototypes */
+
+static BOOLEAN
+AcpiNsGetMemoizedResult (
+    ACPI_EVALUATE_INFO      *Info);
+
+static void
+AcpiNsMemoizeResult (
+    ACPI_EVALUATE_INFO      *Info);
+
 
 /*******************************************************************************
  *
@@ -191,6 +201,7 @@ ACPI_STATUS
 AcpiNsEvaluate (
     ACPI_EVALUATE_INFO      *Info)
 {
+    ACPI_DECODED_METHOD     *Decoded;
     ACPI_STATUS             Status;
 
 
@@ -236,6 +247,15 @@ AcpiNsEvaluate (
     Info->NodeFlags = Info->Node->Flags;
     Info->ObjDesc = AcpiNsGetAttachedObject (Info->Node);
 
+    /*
+     * Pure identification methods (_HID, _UID, ...) return the same object
+     * every time; hand out the memoized one without any further checks.
+     */
+    if (AcpiNsGetMemoizedResult (Info))
+    {
+        return_ACPI_STATUS (AE_OK);
+    }
+
     ACPI_DEBUG_PRINT ((ACPI_DB_NAMES, "%s [%p] Value %p\n",
         Info->RelativePathname, Info->Node,
         AcpiNsGetAttachedObject (Info->Node)));
@@ -354,10 +374,46 @@ AcpiNsEvaluate (
          *
          * Execute the method via the interpreter. The interpreter is locked
          * here before calling into the AML parser
+         *
+         * Methods that are already in pre-decoded form and touch no
+         * namespace node and no shared object (psdecode.c) hold only the
+         * namespace reader lock, which keeps table unload out, so they run
+         * in parallel with each other and with the interpreter. Decoded
+         * methods that use names, buffer fields or Serialized are run
+         * below, with the interpreter held.
+         *
+         * Methods marked parallel at load time (AcpiDsDetectParallelMethod)
+         * hold the interpreter shared. They run in parallel with each other,
+         * field accesses to one region are serialized by the region locks,
+         * and anything else that changes a shared object takes the
+         * interpreter exclusive first (AcpiExUpgradeInterpreter).
          */
-        AcpiExEnterInterpreter ();
-        Status = AcpiPsExecuteMethod (Info);
-        AcpiExExitInterpreter ();
+        Status = AE_CTRL_PARSE_CONTINUE;
+        Decoded = ACPI_LOAD_ACQUIRE (Info->ObjDesc->Method.Decoded);
+        if (Decoded && !(Decoded->Flags & ACPI_DECODED_INTERPRETER) &&
+            ACPI_SUCCESS (AcpiUtAcquireReadLock (&AcpiGbl_NamespaceRwLock)))
+        {
+            Status = AcpiPsExecuteDecodedMethod (Info);
+            (void) AcpiUtReleaseReadLock (&AcpiGbl_NamespaceRwLock);
+        }
+
+        if ((Status == AE_CTRL_PARSE_CONTINUE) &&
+            (Info->ObjDesc->Method.InfoFlags & ACPI_METHOD_PARALLEL))
+        {
+            AcpiExEnterInterpreterShared ();
+            Status = AcpiPsExecuteMethod (Info);
+            AcpiExExitInterpreterShared ();
+        }
+        else if (Status == AE_CTRL_PARSE_CONTINUE)
+        {
+            AcpiExEnterInterpreter ();
+            Status = AcpiPsExecuteMethod (Info);
+            AcpiExExitInterpreter ();
+        }
+        else if (ACPI_SUCCESS (Status) && Info->ReturnObject)
+        {
+            Status = AE_CTRL_RETURN_VALUE;
+        }
         break;
 
     default:
@@ -416,6 +472,8 @@ AcpiNsEvaluate (
 
     if (Status == AE_CTRL_RETURN_VALUE)
     {
+        AcpiNsMemoizeResult (Info);
+
         /* If caller does not want the return value, delete it */
 
         if (Info->Flags & ACPI_IGNORE_RETURN_VALUE)
@@ -458,3 +516,157 @@ Cleanup:
     Info->FullPathname = NULL;
     return_ACPI_STATUS (Status);
 }
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsGetMemoizedResult
+ *
+ * PARAMETERS:  Info            - Evaluation info block
+ *
+ * RETURN:      TRUE if Info->ReturnObject was set from the memoized result
+ *
+ * DESCRIPTION: Return the memoized result of a pure method, if there is one.
+ *              It has already been checked and repaired. The caller gets a
+ *              copy of it, which it is free to modify or convert in place.
+ *
+ * MUTEX:       Acquires the namespace reader lock, which keeps table unload
+ *              (and therefore deletion of the method object) out.
+ *
+ ******************************************************************************/
+
+static BOOLEAN
+AcpiNsGetMemoizedResult (
+    ACPI_EVALUATE_INFO      *Info)
+{
+    ACPI_OPERAND_OBJECT     *ObjDesc = Info->ObjDesc;
+    ACPI_OPERAND_OBJECT     *ResultCache;
+    ACPI_STATUS             Status = AE_OK;
+
+
+    if (!AcpiGbl_MemoizePureMethods ||
+        !ObjDesc ||
+        (Info->Node->Type != ACPI_TYPE_METHOD) ||
+        !(ObjDesc->Method.InfoFlags & ACPI_METHOD_PURE) ||
+        !ObjDesc->Method.ResultCache ||
+        (Info->Parameters && Info->Parameters[0]))
+    {
+        return (FALSE);
+    }
+
+    if (ACPI_FAILURE (AcpiUtAcquireReadLock (&AcpiGbl_NamespaceRwLock)))
+    {
+        return (FALSE);
+    }
+
+    ResultCache = ObjDesc->Method.ResultCache;
+    if (ResultCache && !(Info->Flags & ACPI_IGNORE_RETURN_VALUE))
+    {
+        Status = AcpiUtCopyIobjectToIobject (ResultCache,
+            &Info->ReturnObject, NULL);
+    }
+
+    (void) AcpiUtReleaseReadLock (&AcpiGbl_NamespaceRwLock);
+
+    /* Could not copy it: run the method instead */
+
+    return (ResultCache && ACPI_SUCCESS (Status));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsMemoizeResult
+ *
+ * PARAMETERS:  Info            - Evaluation info block, with the checked and
+ *                                repaired return object
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Keep a copy of the return value of a pure method so that
+ *              later evaluations can skip execution. Only data objects are
+ *              kept; a package must contain nothing but integers and strings,
+ *              whose copies share nothing with the original. The memoized
+ *              result lives as long as the method object: a pure method
+ *              references no namespace object, so no table load can change
+ *              its value.
+ *
+ * MUTEX:       Locks interpreter
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsMemoizeResult (
+    ACPI_EVALUATE_INFO      *Info)
+{
+    ACPI_OPERAND_OBJECT     *ObjDesc = Info->ObjDesc;
+    ACPI_OPERAND_OBJECT     *ReturnObject = Info->ReturnObject;
+    ACPI_OPERAND_OBJECT     *ResultCache;
+    UINT32                  i;
+
+
+    if (!AcpiGbl_MemoizePureMethods ||
+        !ObjDesc ||
+        !ReturnObject ||
+        (Info->Node->Type != ACPI_TYPE_METHOD) ||
+        !(ObjDesc->Method.InfoFlags & ACPI_METHOD_PURE) ||
+        ObjDesc->Method.ResultCache ||
+        (ACPI_GET_DESCRIPTOR_TYPE (ReturnObject) != ACPI_DESC_TYPE_OPERAND))
+    {
+        return;
+    }
+
+    switch (ReturnObject->Common.Type)
+    {
+    case ACPI_TYPE_INTEGER:
+    case ACPI_TYPE_STRING:
+    case ACPI_TYPE_BUFFER:
+
+        break;
+
+    case ACPI_TYPE_PACKAGE:
+
+        for (i = 0; i < ReturnObject->Package.Count; i++)
+        {
+            if (!ReturnObject->Package.Elements[i] ||
+                ((ReturnObject->Package.Elements[i]->Common.Type !=
+                    ACPI_TYPE_INTEGER) &&
+                 (ReturnObject->Package.Elements[i]->Common.Type !=
+                    ACPI_TYPE_STRING)))
+            {
+                return;
+            }
+        }
+        break;
+
+    default:
+
+        return;
+    }
+
+    /* The caller owns ReturnObject and may change it */
+
+    if (ACPI_FAILURE (AcpiUtCopyIobjectToIobject (ReturnObject,
+        &ResultCache, NULL)))
+    {
+        return;
+    }
+
+    AcpiExEnterInterpreter ();
+    if (!ObjDesc->Method.ResultCache)
+    {
+        ObjDesc->Method.ResultCache = ResultCache;
+        ResultCache = NULL;
+
+        ACPI_DEBUG_PRINT ((ACPI_DB_NAMES,
+            "Memoized result of %s [%s]\n", Info->FullPathname,
+            AcpiUtGetObjectTypeName (ReturnObject)));
+    }
+
+    AcpiExExitInterpreter ();
+
+    if (ResultCache)
+    {
+        AcpiUtRemoveReference (ResultCache);
+    }
+}
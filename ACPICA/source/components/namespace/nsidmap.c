@@ -0,0 +1,1212 @@
+/******************************************************************************
+ *
+ * Module Name: nsidmap - Map of device IDs (_HID/_CID) to device nodes
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * 1. Copyright Notice
+ *
+ * Some or all of this work - Copyright (c) 1999 - 2025, Intel Corp.
+ * All rights reserved.
+ *
+ * 2. License
+ *
+ * 2.1. This is your license from Intel Corp. under its intellectual property
+ * rights. You may have additional license terms from the party that provided
+ * you this software, covering your right to use that party's intellectual
+ * property rights.
+ *
+ * 2.2. Intel grants, free of charge, to any person ("Licensee") obtaining a
+ * copy of the source code appearing in this file ("Covered Code") an
+ * irrevocable, perpetual, worldwide license under Intel's copyrights in the
+ * base code distributed originally by Intel ("Original Intel Code") to copy,
+ * make derivatives, distribute, use and display any portion of the Covered
+ * Code in any form, with the right to sublicense such rights; and
+ *
+ * 2.3. Intel grants Licensee a non-exclusive and non-transferable patent
+ * license (with the right to sublicense), under only those claims of Intel
+ * patents that are infringed by the Original Intel Code, to make, use, sell,
+ * offer to sell, and import the Covered Code and derivative works thereof
+ * solely to the minimum extent necessary to exercise the above copyright
+ * license, and in no event shall the patent license extend to any additions
+ * to or modifications of the Original Intel Code. No other license or right
+ * is granted directly or by implication, estoppel or otherwise;
+ *
+ * The above copyright and patent license is granted only if the following
+ * conditions are met:
+ *
+ * 3. Conditions
+ *
+ * 3.1. Redistribution of Source with Rights to Further Distribute Source.
+ * Redistribution of source code of any substantial portion of the Covered
+ * Code or modification with rights to further distribute source must include
+ * the above Copyright Notice, the above License, this list of Conditions,
+ * and the following Disclaimer and Export Compliance provision. In addition,
+ * Licensee must cause all Covered Code to which Licensee contributes to
+ * contain a file documenting the changes Licensee made to create that Covered
+ * Code and the date of any change. Licensee must include in that file the
+ * documentation of any changes made by any predecessor Licensee. Licensee
+ * must include a prominent statement that the modification is derived,
+ * directly or indirectly, from Original Intel Code.
+ *
+ * 3.2. Redistribution of Source with no Rights to Further Distribute Source.
+ * Redistribution of source code of any substantial portion of the Covered
+ * Code or modification without rights to further distribute source must
+ * include the following Disclaimer and Export Compliance provision in the
+ * documentation and/or other materials provided with distribution. In
+ * addition, Licensee may not authorize further sublicense of source of any
+ * portion of the Covered Code, and must include terms to the effect that the
+ * license from Licensee to its licensee is limited to the intellectual
+ * property embodied in the software Licensee provides to its licensee, and
+ * not to intellectual property embodied in modifications its licensee may
+ * make.
+ *
+ * 3.3. Redistribution of Executable. Redistribution in executable form of any
+ * substantial portion of the Covered Code or modification must reproduce the
+ * above Copyright Notice, and the following Disclaimer and Export Compliance
+ * provision in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ * 3.4. Intel retains all right, title, and interest in and to the Original
+ * Intel Code.
+ *
+ * 3.5. Neither the name Intel nor any other trademark owned or controlled by
+ * Intel shall be used in advertising or otherwise to promote the sale, use or
+ * other dealings in products derived from or relating to the Covered Code
+ * without prior written authorization from Intel.
+ *
+ * 4. Disclaimer and Export Compliance
+ *
+ * 4.1. INTEL MAKES NO WARRANTY OF ANY KIND REGARDING ANY SOFTWARE PROVIDED
+ * HERE. ANY SOFTWARE ORIGINATING FROM INTEL OR DERIVED FROM INTEL SOFTWARE
+ * IS PROVIDED "AS IS," AND INTEL WILL NOT PROVIDE ANY SUPPORT, ASSISTANCE,
+ * INSTALLATION, TRAINING OR OTHER SERVICES. INTEL WILL NOT PROVIDE ANY
+ * UPDATES, ENHANCEMENTS OR EXTENSIONS. INTEL SPECIFICALLY DISCLAIMS ANY
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, NONINFRINGEMENT AND FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ *
+ * 4.2. IN NO EVENT SHALL INTEL HAVE ANY LIABILITY TO LICENSEE, ITS LICENSEES
+ * OR ANY OTHER THIRD PARTY, FOR ANY LOST PROFITS, LOST DATA, LOSS OF USE OR
+ * COSTS OF PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES, OR FOR ANY INDIRECT,
+ * SPECIAL OR CONSEQUENTIAL DAMAGES ARISING OUT OF THIS AGREEMENT, UNDER ANY
+ * CAUSE OF ACTION OR THEORY OF LIABILITY, AND IRRESPECTIVE OF WHETHER INTEL
+ * HAS ADVANCE NOTICE OF THE POSSIBILITY OF SUCH DAMAGES. THESE LIMITATIONS
+ * SHALL APPLY NOTWITHSTANDING THE FAILURE OF THE ESSENTIAL PURPOSE OF ANY
+ * LIMITED REMEDY.
+ *
+ * 4.3. Licensee shall not export, either directly or indirectly, any of this
+ * software or system incorporating such software without first obtaining any
+ * required license or other approval from the U. S. Department of Commerce or
+ * any other agency or department of the United States Government. In the
+ * event Licensee exports any such software from the United States or
+ * re-exports any such software from a foreign destination, Licensee shall
+ * ensure that the distribution and export/re-export of the software is in
+ * compliance with all laws, regulations, orders, or other restrictions of the
+ * U.S. Export Administration Regulations. Licensee agrees that neither it nor
+ * any of its subsidiaries will export/re-export any technical data, process,
+ * software, or service, directly or indirectly, to any country for which the
+ * United States government or any agency thereof requires an export license,
+ * other governmental approval, or letter of assurance, without first obtaining
+ * such license, approval or letter.
+ *
+ *****************************************************************************
+ *
+ * Alternatively, you may choose to be licensed under the terms of the
+ * following license:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions, and the following disclaimer,
+ *    without modification.
+ * 2. Redistributions in binary form must reproduce at minimum a disclaimer
+ *    substantially similar to the "NO WARRANTY" disclaimer below
+ *    ("Disclaimer") and any redistribution must be conditioned upon
+ *    including a substantially similar Disclaimer requirement for further
+ *    binary redistribution.
+ * 3. Neither the names of the above-listed copyright holders nor the names
+ *    of any contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Alternatively, you may choose to be licensed under the terms of the
+ * GNU General Public License ("GPL") version 2 as published by the Free
+ * Software Foundation.
+ *
+ *****************************************************************************/
+
+#include "acpi.h"
+#include "accommon.h"
+#include "acnamesp.h"
+
+
+#define _COMPONENT          ACPI_NAMESPACE
+        ACPI_MODULE_NAME    ("nsidmap")
+
+/*
+ * State of a map under construction. IDs are evaluated during the walk and
+ * kept here until the hash chains can be laid out in one allocation.
+ */
+typedef struct acpi_ns_id_build
+{
+    ACPI_NS_ID_MAP          *Map;
+    ACPI_PNP_DEVICE_ID      **Hids;
+    ACPI_PNP_DEVICE_ID_LIST **Cids;
+    UINT32                  *Open;          /* Devices whose subtree is open */
+    UINT32                  OpenCount;
+    UINT32                  Capacity;       /* Size of the device arrays */
+    UINT32                  StringLength;
+
+} ACPI_NS_ID_BUILD;
+
+
+/* Local prototypes */
+
+static UINT32
+AcpiNsHashDeviceId (
+    const char              *Id);
+
+static BOOLEAN
+AcpiNsDeviceIdIsStable (
+    ACPI_NAMESPACE_NODE     *Node,
+    const char              *Name);
+
+static BOOLEAN
+AcpiNsDeviceIdMapIsCurrent (
+    ACPI_NS_ID_MAP          *Map);
+
+static ACPI_STATUS
+AcpiNsCountDevices (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static ACPI_STATUS
+AcpiNsOpenDevice (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static ACPI_STATUS
+AcpiNsCloseDevice (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static ACPI_STATUS
+AcpiNsBuildDeviceIdMap (
+    ACPI_NS_ID_MAP          **ReturnMap);
+
+static ACPI_STATUS
+AcpiNsLayoutDeviceIdMap (
+    ACPI_NS_ID_BUILD        *Build);
+
+static void
+AcpiNsInsertDeviceId (
+    ACPI_NS_ID_MAP          *Map,
+    UINT32                  Device,
+    ACPI_PNP_DEVICE_ID      *Id,
+    UINT32                  *Entry,
+    UINT32                  *Offset);
+
+static UINT32
+AcpiNsFindDeviceId (
+    ACPI_NS_ID_MAP          *Map,
+    UINT32                  Entry,
+    UINT32                  Hash,
+    const char              *Id);
+
+static void
+AcpiNsFreeDeviceIdMap (
+    ACPI_NS_ID_MAP          *Map);
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsMatchDeviceId
+ *
+ * PARAMETERS:  Node            - Device node
+ *              Id              - Hardware or compatible ID to match
+ *              Match           - Where the result is returned
+ *
+ * RETURN:      Status. A failure means that _HID or _CID could not be
+ *              evaluated, and AcpiGetDevices does not descend below Node.
+ *
+ * DESCRIPTION: Evaluate _HID and, if it does not match, _CID of a device and
+ *              compare them with Id. A device without _HID never matches.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiNsMatchDeviceId (
+    ACPI_NAMESPACE_NODE     *Node,
+    const char              *Id,
+    BOOLEAN                 *Match)
+{
+    ACPI_STATUS             Status;
+    ACPI_PNP_DEVICE_ID      *Hid;
+    ACPI_PNP_DEVICE_ID_LIST *Cid;
+    UINT32                  i;
+    int                     NoMatch;
+
+
+    *Match = FALSE;
+
+    Status = AcpiUtExecute_HID (Node, &Hid);
+    if (Status == AE_NOT_FOUND)
+    {
+        return (AE_OK);
+    }
+    else if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    NoMatch = strcmp (Hid->String, Id);
+    ACPI_FREE (Hid);
+
+    if (!NoMatch)
+    {
+        *Match = TRUE;
+        return (AE_OK);
+    }
+
+    /*
+     * HID does not match, attempt match within the
+     * list of Compatible IDs (CIDs)
+     */
+    Status = AcpiUtExecute_CID (Node, &Cid);
+    if (Status == AE_NOT_FOUND)
+    {
+        return (AE_OK);
+    }
+    else if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    for (i = 0; i < Cid->Count; i++)
+    {
+        if (strcmp (Cid->Ids[i].String, Id) == 0)
+        {
+            *Match = TRUE;
+            break;
+        }
+    }
+
+    ACPI_FREE (Cid);
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsGetDeviceIdMap
+ *
+ * PARAMETERS:  ReturnMap       - Where a referenced map is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Return the current device ID map, building it first if there
+ *              is none or the namespace has changed since it was built. The
+ *              caller must release the map with AcpiNsReleaseDeviceIdMap.
+ *
+ * MUTEX:       Caller must hold the namespace reader lock and not the
+ *              namespace mutex. The namespace mutex is acquired internally
+ *              and released while IDs are evaluated.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiNsGetDeviceIdMap (
+    ACPI_NS_ID_MAP          **ReturnMap)
+{
+    ACPI_NS_ID_MAP          *Map;
+    ACPI_STATUS             Status;
+
+
+    ACPI_FUNCTION_TRACE (NsGetDeviceIdMap);
+
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_FAILURE (Status))
+    {
+        return_ACPI_STATUS (Status);
+    }
+
+    Map = AcpiGbl_NsIdMap;
+    if (!AcpiNsDeviceIdMapIsCurrent (Map))
+    {
+        Status = AcpiNsBuildDeviceIdMap (&Map);
+        if (ACPI_FAILURE (Status))
+        {
+            (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+            return_ACPI_STATUS (Status);
+        }
+
+        /*
+         * Publish the new map unless another thread has published a
+         * current one while the namespace was unlocked.
+         */
+        if (!AcpiNsDeviceIdMapIsCurrent (AcpiGbl_NsIdMap))
+        {
+            AcpiNsDeleteDeviceIdMap ();
+            Map->ReferenceCount++;
+            AcpiGbl_NsIdMap = Map;
+        }
+    }
+
+    Map->ReferenceCount++;
+    *ReturnMap = Map;
+
+    (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+    return_ACPI_STATUS (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsReleaseDeviceIdMap
+ *
+ * PARAMETERS:  Map             - Map returned by AcpiNsGetDeviceIdMap
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Drop a reference to a device ID map, freeing it if it is no
+ *              longer the current map and has no other user.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsReleaseDeviceIdMap (
+    ACPI_NS_ID_MAP          *Map)
+{
+    ACPI_STATUS             Status;
+
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_FAILURE (Status))
+    {
+        return;
+    }
+
+    Map->ReferenceCount--;
+    if (!Map->ReferenceCount)
+    {
+        AcpiNsFreeDeviceIdMap (Map);
+    }
+
+    (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeleteDeviceIdMap
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Drop the current device ID map. Maps still in use by a query
+ *              are freed when that query releases them.
+ *
+ * MUTEX:       Caller must hold the namespace mutex
+ *
+ ******************************************************************************/
+
+void
+AcpiNsDeleteDeviceIdMap (
+    void)
+{
+    ACPI_NS_ID_MAP          *Map = AcpiGbl_NsIdMap;
+
+
+    if (!Map)
+    {
+        return;
+    }
+
+    AcpiGbl_NsIdMap = NULL;
+    Map->ReferenceCount--;
+    if (!Map->ReferenceCount)
+    {
+        AcpiNsFreeDeviceIdMap (Map);
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsInvalidateDeviceIdMap
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Make the current device ID map stale. Called by the
+ *              interpreter before it changes an object marked
+ *              AOPOBJ_DEVICE_ID, i.e. the value of a _HID or _CID that
+ *              the map holds.
+ *
+ * MUTEX:       Caller must hold the namespace mutex (the interpreter)
+ *
+ ******************************************************************************/
+
+void
+AcpiNsInvalidateDeviceIdMap (
+    void)
+{
+
+    AcpiGbl_NsIdMapGeneration++;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsWalkDeviceIdMap
+ *
+ * PARAMETERS:  Map             - Map returned by AcpiNsGetDeviceIdMap
+ *              Info            - AcpiGetDevices request; Info->Hid is the ID
+ *                                to match
+ *              ReturnValue     - Where the user function may return a value
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Call the user function for every present device that matches
+ *              Info->Hid, in namespace walk order. Produces the same calls
+ *              as the AcpiGetDevices walk: a device that is not present, or
+ *              whose IDs cannot be evaluated, or for which the user function
+ *              returns AE_CTRL_DEPTH, hides the devices below it. Cost is
+ *              proportional to the number of matches plus the number of
+ *              volatile devices.
+ *
+ * MUTEX:       Caller must hold the namespace reader lock and not the
+ *              namespace mutex.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiNsWalkDeviceIdMap (
+    ACPI_NS_ID_MAP          *Map,
+    ACPI_GET_DEVICES_INFO   *Info,
+    void                    **ReturnValue)
+{
+    ACPI_NS_ID_DEVICE       *Device;
+    ACPI_STATUS             Status;
+    UINT32                  Hash;
+    UINT32                  Entry;
+    UINT32                  NextVolatile = 0;
+    UINT32                  LastDevice = ACPI_NS_ID_MAP_END;
+    UINT32                  SkipEnd = 0;
+    UINT32                  Index;
+    UINT32                  Flags;
+    BOOLEAN                 Verified;
+    BOOLEAN                 Match;
+
+
+    ACPI_FUNCTION_TRACE (NsWalkDeviceIdMap);
+
+
+    Hash = AcpiNsHashDeviceId (Info->Hid);
+    Entry = AcpiNsFindDeviceId (Map,
+        Map->Buckets[Hash & (Map->BucketCount - 1)], Hash, Info->Hid);
+
+    while ((Entry != ACPI_NS_ID_MAP_END) ||
+           (NextVolatile < Map->VolatileCount))
+    {
+        /* Take the next candidate in walk order from either list */
+
+        if ((Entry != ACPI_NS_ID_MAP_END) &&
+            ((NextVolatile == Map->VolatileCount) ||
+             (Map->Entries[Entry].Device < Map->Volatile[NextVolatile])))
+        {
+            Index = Map->Entries[Entry].Device;
+            Verified = TRUE;
+
+            Entry = AcpiNsFindDeviceId (Map,
+                Map->Entries[Entry].Next, Hash, Info->Hid);
+        }
+        else
+        {
+            Index = Map->Volatile[NextVolatile];
+            Verified = FALSE;
+            NextVolatile++;
+        }
+
+        /* A device may match by both _HID and _CID; and skip pruned subtrees */
+
+        if ((Index == LastDevice) || (Index < SkipEnd))
+        {
+            continue;
+        }
+
+        LastDevice = Index;
+        Device = &Map->Devices[Index];
+
+        if (!Verified)
+        {
+            Status = AcpiNsMatchDeviceId (Device->Node, Info->Hid, &Match);
+            if (ACPI_FAILURE (Status))
+            {
+                SkipEnd = Device->SubtreeEnd;
+                continue;
+            }
+
+            if (!Match)
+            {
+                continue;
+            }
+        }
+
+        /* Run _STA to determine if device is present */
+
+        Status = AcpiUtExecute_STA (Device->Node, &Flags);
+        if (ACPI_FAILURE (Status) ||
+            (!(Flags & ACPI_STA_DEVICE_PRESENT) &&
+             !(Flags & ACPI_STA_DEVICE_FUNCTIONING)))
+        {
+            SkipEnd = Device->SubtreeEnd;
+            continue;
+        }
+
+        Status = Info->UserFunction (Device->Node, Device->Level,
+            Info->Context, ReturnValue);
+
+        switch (Status)
+        {
+        case AE_OK:
+
+            break;
+
+        case AE_CTRL_DEPTH:
+
+            SkipEnd = Device->SubtreeEnd;
+            break;
+
+        case AE_CTRL_TERMINATE:
+
+            return_ACPI_STATUS (AE_OK);
+
+        default:
+
+            return_ACPI_STATUS (Status);
+        }
+    }
+
+    return_ACPI_STATUS (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsHashDeviceId
+ *
+ * PARAMETERS:  Id              - Null-terminated ID string
+ *
+ * RETURN:      FNV-1a hash of the string
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiNsHashDeviceId (
+    const char              *Id)
+{
+    UINT32                  Hash = 2166136261u;
+
+
+    while (*Id)
+    {
+        Hash = (Hash ^ (UINT8) *Id) * 16777619u;
+        Id++;
+    }
+
+    return (Hash);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeviceIdIsStable
+ *
+ * PARAMETERS:  Node            - Device node
+ *              Name            - METHOD_NAME__HID or METHOD_NAME__CID
+ *
+ * RETURN:      TRUE if the value of the ID object cannot change without
+ *              making the map stale
+ *
+ * DESCRIPTION: An ID is stable when it is absent, a data object, or a
+ *              method classified as pure at table load. A data object is
+ *              marked AOPOBJ_DEVICE_ID (with the elements of a _CID
+ *              package) so that a store to it advances the ID store
+ *              generation. Anything else (a method that reads other
+ *              objects, a field, an alias, or a name created by a running
+ *              method, which goes away without a namespace change) must
+ *              be evaluated on every query.
+ *
+ ******************************************************************************/
+
+static BOOLEAN
+AcpiNsDeviceIdIsStable (
+    ACPI_NAMESPACE_NODE     *Node,
+    const char              *Name)
+{
+    ACPI_NAMESPACE_NODE     *IdNode;
+    ACPI_OPERAND_OBJECT     *ObjDesc;
+    ACPI_STATUS             Status;
+    BOOLEAN                 Stable = FALSE;
+    UINT32                  i;
+
+
+    Status = AcpiNsGetNode (Node, Name, ACPI_NS_NO_UPSEARCH, &IdNode);
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status == AE_NOT_FOUND);
+    }
+
+    if (IdNode->Flags & ANOBJ_TEMPORARY)
+    {
+        return (FALSE);
+    }
+
+    /* The interpreter changes object flags under the namespace mutex */
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_FAILURE (Status))
+    {
+        return (FALSE);
+    }
+
+    ObjDesc = AcpiNsGetAttachedObject (IdNode);
+    switch (IdNode->Type)
+    {
+    case ACPI_TYPE_PACKAGE:
+
+        /* Elements of a package not yet evaluated cannot be marked */
+
+        if (!ObjDesc || !(ObjDesc->Common.Flags & AOPOBJ_DATA_VALID))
+        {
+            break;
+        }
+
+        for (i = 0; i < ObjDesc->Package.Count; i++)
+        {
+            if (ObjDesc->Package.Elements[i])
+            {
+                ObjDesc->Package.Elements[i]->Common.Flags |= AOPOBJ_DEVICE_ID;
+            }
+        }
+
+        ACPI_FALLTHROUGH;
+
+    case ACPI_TYPE_INTEGER:
+    case ACPI_TYPE_STRING:
+
+        if (ObjDesc)
+        {
+            ObjDesc->Common.Flags |= AOPOBJ_DEVICE_ID;
+            Stable = TRUE;
+        }
+        break;
+
+    case ACPI_TYPE_METHOD:
+
+        Stable = (ObjDesc && (ObjDesc->Method.InfoFlags & ACPI_METHOD_PURE));
+        break;
+
+    default:
+
+        break;
+    }
+
+    (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+    return (Stable);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeviceIdMapIsCurrent
+ *
+ * PARAMETERS:  Map             - Device ID map, may be NULL
+ *
+ * RETURN:      TRUE if the map reflects the namespace and the ID objects
+ *
+ * MUTEX:       Caller must hold the namespace mutex
+ *
+ ******************************************************************************/
+
+static BOOLEAN
+AcpiNsDeviceIdMapIsCurrent (
+    ACPI_NS_ID_MAP          *Map)
+{
+
+    return (Map &&
+        (Map->Generation == AcpiGbl_NsPathCacheGeneration) &&
+        (Map->IdGeneration == AcpiGbl_NsIdMapGeneration));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsCountDevices
+ *
+ * PARAMETERS:  Callback from WalkNamespace
+ *
+ * RETURN:      AE_OK
+ *
+ * DESCRIPTION: Count the devices that AcpiNsBuildDeviceIdMap will visit.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsCountDevices (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    UINT32                  *Count = Context;
+
+
+    (*Count)++;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsOpenDevice
+ *
+ * PARAMETERS:  Callback from WalkNamespace
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Descending callback of the map build. Records the device and
+ *              evaluates its IDs if they are stable; otherwise the device is
+ *              listed as volatile.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsOpenDevice (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    ACPI_NS_ID_BUILD        *Build = Context;
+    ACPI_NS_ID_MAP          *Map = Build->Map;
+    ACPI_NAMESPACE_NODE     *Node = ObjHandle;
+    ACPI_PNP_DEVICE_ID      *Hid;
+    ACPI_PNP_DEVICE_ID_LIST *Cid = NULL;
+    ACPI_STATUS             Status;
+    UINT32                  Index;
+    UINT32                  i;
+
+
+    /* The namespace grew since the devices were counted */
+
+    if (Map->DeviceCount >= Build->Capacity)
+    {
+        return (AE_LIMIT);
+    }
+
+    Index = Map->DeviceCount++;
+    Map->Devices[Index].Node = Node;
+    Map->Devices[Index].Level = NestingLevel;
+    Map->Devices[Index].SubtreeEnd = Index + 1;
+    Build->Open[Build->OpenCount++] = Index;
+
+    if (!AcpiNsDeviceIdIsStable (Node, METHOD_NAME__HID) ||
+        !AcpiNsDeviceIdIsStable (Node, METHOD_NAME__CID))
+    {
+        goto Volatile;
+    }
+
+    /* Without a _HID the device never matches, whatever its _CID */
+
+    Status = AcpiUtExecute_HID (Node, &Hid);
+    if (Status == AE_NOT_FOUND)
+    {
+        return (AE_OK);
+    }
+    else if (ACPI_FAILURE (Status))
+    {
+        goto Volatile;
+    }
+
+    Status = AcpiUtExecute_CID (Node, &Cid);
+    if (ACPI_FAILURE (Status) && (Status != AE_NOT_FOUND))
+    {
+        ACPI_FREE (Hid);
+        goto Volatile;
+    }
+
+    Build->Hids[Index] = Hid;
+    Build->StringLength += Hid->Length;
+    Map->EntryCount++;
+
+    if (ACPI_SUCCESS (Status))
+    {
+        Build->Cids[Index] = Cid;
+        for (i = 0; i < Cid->Count; i++)
+        {
+            Build->StringLength += Cid->Ids[i].Length;
+        }
+
+        Map->EntryCount += Cid->Count;
+    }
+
+    return (AE_OK);
+
+
+Volatile:
+    /*
+     * Evaluate the IDs on every query; this also reproduces the pruning
+     * of the walk when they fail to evaluate.
+     */
+    Map->Volatile[Map->VolatileCount++] = Index;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsCloseDevice
+ *
+ * PARAMETERS:  Callback from WalkNamespace
+ *
+ * RETURN:      AE_OK
+ *
+ * DESCRIPTION: Ascending callback of the map build. Every device visited
+ *              since the matching AcpiNsOpenDevice is below this one.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsCloseDevice (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    ACPI_NS_ID_BUILD        *Build = Context;
+
+
+    Build->OpenCount--;
+    Build->Map->Devices[Build->Open[Build->OpenCount]].SubtreeEnd =
+        Build->Map->DeviceCount;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsBuildDeviceIdMap
+ *
+ * PARAMETERS:  ReturnMap       - Where the new, unreferenced map is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Walk the namespace the way AcpiGetDevices does and build a
+ *              map of the IDs of every device. The map is stamped with the
+ *              namespace and ID store generations from before the walk, so
+ *              any change made while the namespace was unlocked makes it
+ *              stale.
+ *
+ * MUTEX:       Caller must hold the namespace mutex
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsBuildDeviceIdMap (
+    ACPI_NS_ID_MAP          **ReturnMap)
+{
+    ACPI_NS_ID_BUILD        Build;
+    ACPI_NS_ID_MAP          *Map;
+    ACPI_STATUS             Status;
+    UINT32                  Generation = AcpiGbl_NsPathCacheGeneration;
+    UINT32                  IdGeneration = AcpiGbl_NsIdMapGeneration;
+    UINT32                  DeviceCount = 0;
+    UINT32                  i;
+
+
+    ACPI_FUNCTION_TRACE (NsBuildDeviceIdMap);
+
+
+    (void) AcpiNsWalkNamespace (ACPI_TYPE_DEVICE, ACPI_ROOT_OBJECT,
+        ACPI_UINT32_MAX, ACPI_NS_WALK_NO_UNLOCK,
+        AcpiNsCountDevices, NULL, &DeviceCount, NULL);
+
+    /* The map, device list and volatile list are one allocation */
+
+    Map = ACPI_ALLOCATE_ZEROED (sizeof (ACPI_NS_ID_MAP) +
+        ((ACPI_SIZE) DeviceCount *
+            (sizeof (ACPI_NS_ID_DEVICE) + sizeof (UINT32))));
+    if (!Map)
+    {
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    Map->Generation = Generation;
+    Map->IdGeneration = IdGeneration;
+    Map->Devices = ACPI_ADD_PTR (ACPI_NS_ID_DEVICE, Map,
+        sizeof (ACPI_NS_ID_MAP));
+    Map->Volatile = ACPI_ADD_PTR (UINT32, Map->Devices,
+        (ACPI_SIZE) DeviceCount * sizeof (ACPI_NS_ID_DEVICE));
+
+    memset (&Build, 0, sizeof (ACPI_NS_ID_BUILD));
+    Build.Map = Map;
+    Build.Capacity = DeviceCount;
+    Build.Hids = ACPI_ALLOCATE_ZEROED ((ACPI_SIZE) (DeviceCount + 1) *
+        (sizeof (ACPI_PNP_DEVICE_ID *) + sizeof (ACPI_PNP_DEVICE_ID_LIST *) +
+         sizeof (UINT32)));
+    if (!Build.Hids)
+    {
+        ACPI_FREE (Map);
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    Build.Cids = ACPI_ADD_PTR (ACPI_PNP_DEVICE_ID_LIST *, Build.Hids,
+        (ACPI_SIZE) (DeviceCount + 1) * sizeof (ACPI_PNP_DEVICE_ID *));
+    Build.Open = ACPI_ADD_PTR (UINT32, Build.Cids,
+        (ACPI_SIZE) (DeviceCount + 1) * sizeof (ACPI_PNP_DEVICE_ID_LIST *));
+
+    Status = AcpiNsWalkNamespace (ACPI_TYPE_DEVICE, ACPI_ROOT_OBJECT,
+        ACPI_UINT32_MAX, ACPI_NS_WALK_UNLOCK,
+        AcpiNsOpenDevice, AcpiNsCloseDevice, &Build, NULL);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiNsLayoutDeviceIdMap (&Build);
+    }
+
+    for (i = 0; i < Map->DeviceCount; i++)
+    {
+        if (Build.Hids[i])
+        {
+            ACPI_FREE (Build.Hids[i]);
+        }
+
+        if (Build.Cids[i])
+        {
+            ACPI_FREE (Build.Cids[i]);
+        }
+    }
+
+    ACPI_FREE (Build.Hids);
+
+    if (ACPI_FAILURE (Status))
+    {
+        AcpiNsFreeDeviceIdMap (Map);
+        return_ACPI_STATUS (Status);
+    }
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_NAMES,
+        "Device ID map: %u devices, %u IDs, %u volatile\n",
+        Map->DeviceCount, Map->EntryCount, Map->VolatileCount));
+
+    *ReturnMap = Map;
+    return_ACPI_STATUS (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsLayoutDeviceIdMap
+ *
+ * PARAMETERS:  Build           - Build state after the namespace walk
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Allocate the hash buckets, entries and ID strings of a map
+ *              as one block and chain every evaluated ID into it.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsLayoutDeviceIdMap (
+    ACPI_NS_ID_BUILD        *Build)
+{
+    ACPI_NS_ID_MAP          *Map = Build->Map;
+    ACPI_PNP_DEVICE_ID_LIST *Cid;
+    UINT32                  Entry = Map->EntryCount;
+    UINT32                  Offset = Build->StringLength;
+    UINT32                  i;
+    UINT32                  j;
+
+
+    Map->BucketCount = 16;
+    while (Map->BucketCount < (Map->EntryCount * 2))
+    {
+        Map->BucketCount <<= 1;
+    }
+
+    Map->Buckets = ACPI_ALLOCATE (
+        ((ACPI_SIZE) Map->BucketCount * sizeof (UINT32)) +
+        ((ACPI_SIZE) Map->EntryCount * sizeof (ACPI_NS_ID_ENTRY)) +
+        Build->StringLength);
+    if (!Map->Buckets)
+    {
+        return (AE_NO_MEMORY);
+    }
+
+    Map->Entries = ACPI_ADD_PTR (ACPI_NS_ID_ENTRY, Map->Buckets,
+        (ACPI_SIZE) Map->BucketCount * sizeof (UINT32));
+    Map->Strings = ACPI_ADD_PTR (char, Map->Entries,
+        (ACPI_SIZE) Map->EntryCount * sizeof (ACPI_NS_ID_ENTRY));
+
+    for (i = 0; i < Map->BucketCount; i++)
+    {
+        Map->Buckets[i] = ACPI_NS_ID_MAP_END;
+    }
+
+    /*
+     * Insert at the head of each chain, in reverse walk order, so that
+     * every chain ends up in walk order.
+     */
+    for (i = Map->DeviceCount; i > 0; i--)
+    {
+        Cid = Build->Cids[i - 1];
+        if (Cid)
+        {
+            for (j = Cid->Count; j > 0; j--)
+            {
+                AcpiNsInsertDeviceId (Map, i - 1, &Cid->Ids[j - 1],
+                    &Entry, &Offset);
+            }
+        }
+
+        if (Build->Hids[i - 1])
+        {
+            AcpiNsInsertDeviceId (Map, i - 1, Build->Hids[i - 1],
+                &Entry, &Offset);
+        }
+    }
+
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsInsertDeviceId
+ *
+ * PARAMETERS:  Map             - Map being laid out
+ *              Device          - Index of the device with this ID
+ *              Id              - The ID
+ *              Entry           - Next free entry, counting down
+ *              Offset          - Next free string offset, counting down
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Copy an ID into the map and push it on its hash chain.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsInsertDeviceId (
+    ACPI_NS_ID_MAP          *Map,
+    UINT32                  Device,
+    ACPI_PNP_DEVICE_ID      *Id,
+    UINT32                  *Entry,
+    UINT32                  *Offset)
+{
+    ACPI_NS_ID_ENTRY        *NewEntry;
+    UINT32                  Bucket;
+
+
+    (*Entry)--;
+    *Offset -= Id->Length;
+    memcpy (&Map->Strings[*Offset], Id->String, Id->Length);
+
+    NewEntry = &Map->Entries[*Entry];
+    NewEntry->Hash = AcpiNsHashDeviceId (Id->String);
+    NewEntry->Device = Device;
+    NewEntry->IdOffset = *Offset;
+
+    Bucket = NewEntry->Hash & (Map->BucketCount - 1);
+    NewEntry->Next = Map->Buckets[Bucket];
+    Map->Buckets[Bucket] = *Entry;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsFindDeviceId
+ *
+ * PARAMETERS:  Map             - Device ID map
+ *              Entry           - First entry to examine
+ *              Hash            - Hash of Id
+ *              Id              - ID to find
+ *
+ * RETURN:      The first entry for Id at or after Entry on its chain, or
+ *              ACPI_NS_ID_MAP_END
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiNsFindDeviceId (
+    ACPI_NS_ID_MAP          *Map,
+    UINT32                  Entry,
+    UINT32                  Hash,
+    const char              *Id)
+{
+
+    while (Entry != ACPI_NS_ID_MAP_END)
+    {
+        if ((Map->Entries[Entry].Hash == Hash) &&
+            !strcmp (&Map->Strings[Map->Entries[Entry].IdOffset], Id))
+        {
+            break;
+        }
+
+        Entry = Map->Entries[Entry].Next;
+    }
+
+    return (Entry);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsFreeDeviceIdMap
+ *
+ * PARAMETERS:  Map             - Device ID map
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Free a device ID map. The buckets, entries and strings share
+ *              one allocation, as do the map, devices and volatile list.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsFreeDeviceIdMap (
+    ACPI_NS_ID_MAP          *Map)
+{
+
+    if (Map->Buckets)
+    {
+        ACPI_FREE (Map->Buckets);
+    }
+
+    ACPI_FREE (Map);
+}
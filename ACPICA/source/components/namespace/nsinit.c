@@ -182,6 +182,78 @@ AcpiNsFindIniMethods (
     void                    *Context,
     void                    **ReturnValue);
 
+static ACPI_STATUS
+AcpiNsInitDevicesParallel (
+    ACPI_DEVICE_WALK_INFO   *Info);
+
+static ACPI_STATUS
+AcpiNsPartitionDevices (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static ACPI_STATUS
+AcpiNsListInitNode (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static ACPI_STATUS
+AcpiNsEndInitNode (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static ACPI_STATUS
+AcpiNsFindDeviceDeps (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue);
+
+static ACPI_STATUS
+AcpiNsAddDeviceDeps (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    UINT32                  Dependent,
+    ACPI_OPERAND_OBJECT     *ObjDesc);
+
+static ACPI_STATUS
+AcpiNsEvaluateDeviceDeps (
+    ACPI_DEVICE_INIT_QUEUE  *Queue);
+
+static ACPI_STATUS
+AcpiNsGrowInitArray (
+    void                    **Array,
+    UINT32                  *Size,
+    UINT32                  Count,
+    ACPI_SIZE               ElementSize);
+
+static UINT32
+AcpiNsGetInitItem (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    ACPI_NAMESPACE_NODE     *Node);
+
+static BOOLEAN
+AcpiNsInitOrderIsAcyclic (
+    ACPI_DEVICE_INIT_QUEUE  *Queue);
+
+static void
+AcpiNsCompleteInitItem (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    UINT32                  Index);
+
+static void
+AcpiNsRunInitQueue (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    ACPI_EVALUATE_INFO      *EvaluateInfo);
+
+static void ACPI_SYSTEM_XFACE
+AcpiNsInitWorker (
+    void                    *Context);
+
 
 /*******************************************************************************
  *
@@ -373,8 +445,15 @@ AcpiNsInitializeDevices (
     {
         /* Walk namespace to execute all _INIs on present devices */
 
-        Status = AcpiNsWalkNamespace (ACPI_TYPE_ANY, ACPI_ROOT_OBJECT,
-            ACPI_UINT32_MAX, FALSE, AcpiNsInitOneDevice, NULL, &Info, NULL);
+        if (AcpiGbl_DeviceInitThreads > 1)
+        {
+            Status = AcpiNsInitDevicesParallel (&Info);
+        }
+        else
+        {
+            Status = AcpiNsWalkNamespace (ACPI_TYPE_ANY, ACPI_ROOT_OBJECT,
+                ACPI_UINT32_MAX, FALSE, AcpiNsInitOneDevice, NULL, &Info, NULL);
+        }
 
         /*
          * Any _OSI requests should be completed by now. If the BIOS has
@@ -875,3 +954,909 @@ AcpiNsInitOneDevice (
 
     return_ACPI_STATUS (Status);
 }
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsInitDevicesParallel
+ *
+ * PARAMETERS:  Info            - Device walk info (counters, evaluate block)
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Parallel form of the _STA/_INI namespace walk. The namespace
+ *              is split into device subtrees that have no Device, Processor
+ *              or Thermal ancestor other than \_SB. Each subtree's devices
+ *              are visited in the order the serial walk would visit them,
+ *              so parents are always initialized before their children.
+ *              Subtrees are ordered against each other by their _DEP
+ *              objects and are run on up to AcpiGbl_DeviceInitThreads
+ *              threads via AcpiOsExecute.
+ *
+ *              The queue, with every subtree's list of devices, is built
+ *              with the namespace locked. The workers only evaluate _STA
+ *              and _INI and never walk the namespace, which the AML they
+ *              run may change. _DEP methods are evaluated in between.
+ *
+ *              Falls back to the serial walk if there is nothing to run in
+ *              parallel, if _DEP has a cycle, or on allocation failure.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsInitDevicesParallel (
+    ACPI_DEVICE_WALK_INFO   *Info)
+{
+    ACPI_DEVICE_INIT_QUEUE  Queue;
+    ACPI_STATUS             Status;
+    BOOLEAN                 Serial = TRUE;
+    UINT32                  Workers;
+    UINT32                  Dispatched = 0;
+    UINT32                  i;
+
+
+    ACPI_FUNCTION_TRACE (NsInitDevicesParallel);
+
+
+    memset (&Queue, 0, sizeof (ACPI_DEVICE_INIT_QUEUE));
+
+    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_FAILURE (Status))
+    {
+        goto Cleanup;
+    }
+
+    /* Split the namespace into independent device subtrees */
+
+    Status = AcpiNsWalkNamespace (ACPI_TYPE_ANY, ACPI_ROOT_OBJECT,
+        ACPI_UINT32_MAX, ACPI_NS_WALK_NO_UNLOCK, AcpiNsPartitionDevices,
+        NULL, &Queue, NULL);
+    if (ACPI_SUCCESS (Status))
+    {
+        /* Order the subtrees by the _DEP objects found within them */
+
+        Status = AcpiNsWalkNamespace (ACPI_TYPE_ANY, ACPI_ROOT_OBJECT,
+            ACPI_UINT32_MAX, ACPI_NS_WALK_NO_UNLOCK, AcpiNsFindDeviceDeps,
+            NULL, &Queue, NULL);
+    }
+
+    (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiNsEvaluateDeviceDeps (&Queue);
+    }
+
+    if (ACPI_FAILURE (Status) || (Queue.ItemCount < 2))
+    {
+        goto Cleanup;
+    }
+
+    if (!AcpiNsInitOrderIsAcyclic (&Queue))
+    {
+        ACPI_WARNING ((AE_INFO,
+            "_DEP dependencies form a cycle, initializing devices serially"));
+        goto Cleanup;
+    }
+
+    Status = AcpiOsCreateMutex (&Queue.Lock);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiOsCreateSemaphore (AcpiGbl_DeviceInitThreads, 0,
+            &Queue.WorkSem);
+    }
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiOsCreateSemaphore (AcpiGbl_DeviceInitThreads, 0,
+            &Queue.DoneSem);
+    }
+    if (ACPI_FAILURE (Status))
+    {
+        goto Cleanup;
+    }
+
+    Serial = FALSE;
+    Queue.Remaining = Queue.ItemCount;
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_INIT,
+        "Initializing %u device subtrees (%u _DEP links) on up to %u threads\n",
+        Queue.ItemCount, Queue.EdgeCount, AcpiGbl_DeviceInitThreads));
+
+    /*
+     * \_SB is initialized first, as the serial walk would before visiting
+     * its children. If it is neither present nor functioning, none of the
+     * subtrees below it are examined.
+     */
+    if (Queue.SbNode)
+    {
+        Status = AcpiNsInitOneDevice (Queue.SbNode, 0, Info, NULL);
+        if (Status == AE_CTRL_DEPTH)
+        {
+            for (i = 0; i < Queue.ItemCount; i++)
+            {
+                if (Queue.Items[i].UnderSb)
+                {
+                    AcpiNsCompleteInitItem (&Queue, i);
+                }
+            }
+        }
+        else if (ACPI_FAILURE (Status))
+        {
+            goto Cleanup;
+        }
+    }
+
+    /* Start the workers; this thread works the queue too */
+
+    Workers = ACPI_MIN (AcpiGbl_DeviceInitThreads, Queue.ItemCount) - 1;
+    for (i = 0; i < Workers; i++)
+    {
+        Status = AcpiOsExecute (OSL_NOTIFY_HANDLER, AcpiNsInitWorker, &Queue);
+        if (ACPI_FAILURE (Status))
+        {
+            break;
+        }
+
+        Dispatched++;
+    }
+
+    AcpiNsRunInitQueue (&Queue, Info->EvaluateInfo);
+
+    while (Dispatched)
+    {
+        (void) AcpiOsWaitSemaphore (Queue.DoneSem, 1, ACPI_WAIT_FOREVER);
+        Dispatched--;
+    }
+
+    Info->Num_STA += Queue.Num_STA;
+    Info->Num_INI += Queue.Num_INI;
+    Status = Queue.Status;
+
+
+Cleanup:
+    if (Queue.DoneSem)
+    {
+        (void) AcpiOsDeleteSemaphore (Queue.DoneSem);
+    }
+    if (Queue.WorkSem)
+    {
+        (void) AcpiOsDeleteSemaphore (Queue.WorkSem);
+    }
+    if (Queue.Lock)
+    {
+        AcpiOsDeleteMutex (Queue.Lock);
+    }
+    if (Queue.DepMethods)
+    {
+        ACPI_FREE (Queue.DepMethods);
+    }
+    if (Queue.Nodes)
+    {
+        ACPI_FREE (Queue.Nodes);
+    }
+    if (Queue.Edges)
+    {
+        ACPI_FREE (Queue.Edges);
+    }
+    if (Queue.Items)
+    {
+        ACPI_FREE (Queue.Items);
+    }
+
+    if (Serial)
+    {
+        Status = AcpiNsWalkNamespace (ACPI_TYPE_ANY, ACPI_ROOT_OBJECT,
+            ACPI_UINT32_MAX, FALSE, AcpiNsInitOneDevice, NULL, Info, NULL);
+    }
+
+    return_ACPI_STATUS (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsPartitionDevices
+ *
+ * PARAMETERS:  ACPI_WALK_CALLBACK
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Namespace walk callback. Adds each outermost device subtree
+ *              that contains an _INI method to the init queue, along with
+ *              the devices within it that the _STA/_INI walk would visit.
+ *              Descends only into \_SB. Namespace is locked.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsPartitionDevices (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    ACPI_DEVICE_INIT_QUEUE  *Queue = ACPI_CAST_PTR (ACPI_DEVICE_INIT_QUEUE, Context);
+    ACPI_NAMESPACE_NODE     *Node = ACPI_CAST_PTR (ACPI_NAMESPACE_NODE, ObjHandle);
+    ACPI_NAMESPACE_NODE     *ParentNode;
+    ACPI_DEVICE_INIT_ITEM   *Item;
+    ACPI_STATUS             Status;
+
+
+    if ((Node->Type != ACPI_TYPE_DEVICE)    &&
+        (Node->Type != ACPI_TYPE_PROCESSOR) &&
+        (Node->Type != ACPI_TYPE_THERMAL))
+    {
+        return (AE_OK);
+    }
+
+    /* Same pruning as AcpiNsInitOneDevice */
+
+    if (!(Node->Flags & ANOBJ_SUBTREE_HAS_INI))
+    {
+        return (AE_CTRL_DEPTH);
+    }
+
+    if ((Node->Parent == AcpiGbl_RootNode) &&
+        ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__SB_))
+    {
+        Queue->SbNode = Node;
+        return (AE_OK);
+    }
+
+    Status = AcpiNsGrowInitArray ((void **) &Queue->Items, &Queue->ItemSize,
+        Queue->ItemCount, sizeof (ACPI_DEVICE_INIT_ITEM));
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    Item = &Queue->Items[Queue->ItemCount];
+    Queue->ItemCount++;
+    Item->Node = Node;
+
+    for (ParentNode = Node->Parent; ParentNode; ParentNode = ParentNode->Parent)
+    {
+        if (ParentNode == Queue->SbNode)
+        {
+            Item->UnderSb = TRUE;
+            break;
+        }
+    }
+
+    /* The subtree root, then its devices in walk order */
+
+    Item->FirstNode = Queue->NodeCount;
+    Status = AcpiNsListInitNode (Node, 0, Queue, NULL);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiNsWalkNamespace (ACPI_TYPE_ANY, Node, ACPI_UINT32_MAX,
+            ACPI_NS_WALK_NO_UNLOCK, AcpiNsListInitNode, AcpiNsEndInitNode,
+            Queue, NULL);
+    }
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    Queue->Nodes[Item->FirstNode].SubtreeEnd = Queue->NodeCount;
+    return (AE_CTRL_DEPTH);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsListInitNode
+ *
+ * PARAMETERS:  ACPI_WALK_CALLBACK
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Descending walk callback. Appends each device that
+ *              AcpiNsInitOneDevice would examine to the queue's node list,
+ *              with the same pruning. Namespace is locked.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsListInitNode (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    ACPI_DEVICE_INIT_QUEUE  *Queue = ACPI_CAST_PTR (ACPI_DEVICE_INIT_QUEUE, Context);
+    ACPI_NAMESPACE_NODE     *Node = ACPI_CAST_PTR (ACPI_NAMESPACE_NODE, ObjHandle);
+    ACPI_STATUS             Status;
+
+
+    if ((Node->Type != ACPI_TYPE_DEVICE)    &&
+        (Node->Type != ACPI_TYPE_PROCESSOR) &&
+        (Node->Type != ACPI_TYPE_THERMAL))
+    {
+        return (AE_OK);
+    }
+
+    if (!(Node->Flags & ANOBJ_SUBTREE_HAS_INI))
+    {
+        return (AE_CTRL_DEPTH);
+    }
+
+    Status = AcpiNsGrowInitArray ((void **) &Queue->Nodes, &Queue->NodeSize,
+        Queue->NodeCount, sizeof (ACPI_DEVICE_INIT_NODE));
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    Queue->Nodes[Queue->NodeCount].Node = Node;
+    Queue->Nodes[Queue->NodeCount].SubtreeEnd = Queue->NodeCount + 1;
+    Queue->NodeCount++;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsEndInitNode
+ *
+ * PARAMETERS:  ACPI_WALK_CALLBACK
+ *
+ * RETURN:      AE_OK
+ *
+ * DESCRIPTION: Ascending walk callback. Once a listed device's children
+ *              have all been visited, records where its subtree ends, so
+ *              a device that is not present can be skipped along with
+ *              everything below it.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsEndInitNode (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    ACPI_DEVICE_INIT_QUEUE  *Queue = ACPI_CAST_PTR (ACPI_DEVICE_INIT_QUEUE, Context);
+    ACPI_NAMESPACE_NODE     *Node = ACPI_CAST_PTR (ACPI_NAMESPACE_NODE, ObjHandle);
+    UINT32                  i;
+
+
+    if (((Node->Type != ACPI_TYPE_DEVICE)    &&
+         (Node->Type != ACPI_TYPE_PROCESSOR) &&
+         (Node->Type != ACPI_TYPE_THERMAL))  ||
+        !(Node->Flags & ANOBJ_SUBTREE_HAS_INI))
+    {
+        return (AE_OK);
+    }
+
+    for (i = Queue->NodeCount; i > 0; i--)
+    {
+        if (Queue->Nodes[i - 1].Node == Node)
+        {
+            Queue->Nodes[i - 1].SubtreeEnd = Queue->NodeCount;
+            break;
+        }
+    }
+
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsGetInitItem
+ *
+ * PARAMETERS:  Queue           - Device init queue
+ *              Node            - Any namespace node
+ *
+ * RETURN:      Index of the queued subtree containing Node, or
+ *              ACPI_UINT32_MAX if Node is not within any of them
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiNsGetInitItem (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    ACPI_NAMESPACE_NODE     *Node)
+{
+    UINT32                  i;
+
+
+    for (; Node; Node = Node->Parent)
+    {
+        for (i = 0; i < Queue->ItemCount; i++)
+        {
+            if (Queue->Items[i].Node == Node)
+            {
+                return (i);
+            }
+        }
+    }
+
+    return (ACPI_UINT32_MAX);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsFindDeviceDeps
+ *
+ * PARAMETERS:  ACPI_WALK_CALLBACK
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Namespace walk callback. For each _DEP package within a
+ *              queued subtree, records that the subtree must wait for the
+ *              subtrees holding the devices it names; _DEP methods are
+ *              set aside for AcpiNsEvaluateDeviceDeps, since no AML can run
+ *              with the namespace locked. Dependencies within a single
+ *              subtree are already met by the walk order.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsFindDeviceDeps (
+    ACPI_HANDLE             ObjHandle,
+    UINT32                  NestingLevel,
+    void                    *Context,
+    void                    **ReturnValue)
+{
+    ACPI_DEVICE_INIT_QUEUE  *Queue = ACPI_CAST_PTR (ACPI_DEVICE_INIT_QUEUE, Context);
+    ACPI_NAMESPACE_NODE     *Node = ACPI_CAST_PTR (ACPI_NAMESPACE_NODE, ObjHandle);
+    ACPI_OPERAND_OBJECT     *ObjDesc;
+    ACPI_STATUS             Status;
+    UINT32                  Dependent;
+
+
+    if (!ACPI_COMPARE_NAMESEG (Node->Name.Ascii, METHOD_NAME__DEP))
+    {
+        return (AE_OK);
+    }
+
+    Dependent = AcpiNsGetInitItem (Queue, Node->Parent);
+    if (Dependent == ACPI_UINT32_MAX)
+    {
+        return (AE_OK);
+    }
+
+    if (Node->Type == ACPI_TYPE_METHOD)
+    {
+        Status = AcpiNsGrowInitArray ((void **) &Queue->DepMethods,
+            &Queue->DepMethodSize, Queue->DepMethodCount,
+            sizeof (ACPI_NAMESPACE_NODE *));
+        if (ACPI_SUCCESS (Status))
+        {
+            Queue->DepMethods[Queue->DepMethodCount] = Node;
+            Queue->DepMethodCount++;
+        }
+
+        return (Status);
+    }
+
+    ObjDesc = AcpiNsGetAttachedObject (Node);
+    if ((Node->Type != ACPI_TYPE_PACKAGE) || !ObjDesc ||
+        !(ObjDesc->Common.Flags & AOPOBJ_DATA_VALID))
+    {
+        return (AE_OK);
+    }
+
+    return (AcpiNsAddDeviceDeps (Queue, Dependent, ObjDesc));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsEvaluateDeviceDeps
+ *
+ * PARAMETERS:  Queue           - Device init queue
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Run the _DEP methods found while the queue was built and
+ *              add the dependencies they return. Called with the namespace
+ *              unlocked, before any subtree has started. A _DEP method
+ *              that fails adds no dependencies.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsEvaluateDeviceDeps (
+    ACPI_DEVICE_INIT_QUEUE  *Queue)
+{
+    ACPI_NAMESPACE_NODE     *Node;
+    ACPI_OPERAND_OBJECT     *ObjDesc;
+    ACPI_STATUS             Status = AE_OK;
+    UINT32                  i;
+
+
+    for (i = 0; (i < Queue->DepMethodCount) && ACPI_SUCCESS (Status); i++)
+    {
+        Node = Queue->DepMethods[i];
+        if (ACPI_FAILURE (AcpiUtEvaluateObject (Node->Parent,
+                METHOD_NAME__DEP, ACPI_BTYPE_PACKAGE, &ObjDesc)))
+        {
+            continue;
+        }
+
+        Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiNsAddDeviceDeps (Queue,
+                AcpiNsGetInitItem (Queue, Node->Parent), ObjDesc);
+            (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
+        }
+
+        AcpiUtRemoveReference (ObjDesc);
+    }
+
+    return (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsAddDeviceDeps
+ *
+ * PARAMETERS:  Queue           - Device init queue
+ *              Dependent       - Subtree whose device has the _DEP
+ *              ObjDesc         - _DEP package
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Add an edge from each other queued subtree that holds a
+ *              device named by the package to the dependent subtree.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsAddDeviceDeps (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    UINT32                  Dependent,
+    ACPI_OPERAND_OBJECT     *ObjDesc)
+{
+    ACPI_OPERAND_OBJECT     *Element;
+    ACPI_STATUS             Status;
+    UINT32                  Prerequisite;
+    UINT32                  i;
+    UINT32                  j;
+
+
+    for (i = 0; i < ObjDesc->Package.Count; i++)
+    {
+        Element = ObjDesc->Package.Elements[i];
+        if (!Element ||
+            (Element->Common.Type != ACPI_TYPE_LOCAL_REFERENCE) ||
+            (Element->Reference.Class != ACPI_REFCLASS_NAME) ||
+            !Element->Reference.Resolved)
+        {
+            continue;
+        }
+
+        Prerequisite = AcpiNsGetInitItem (Queue, Element->Reference.Node);
+        if ((Prerequisite == ACPI_UINT32_MAX) || (Prerequisite == Dependent))
+        {
+            continue;
+        }
+
+        for (j = 0; j < Queue->EdgeCount; j++)
+        {
+            if ((Queue->Edges[j].Prerequisite == Prerequisite) &&
+                (Queue->Edges[j].Dependent == Dependent))
+            {
+                break;
+            }
+        }
+
+        if (j < Queue->EdgeCount)
+        {
+            continue;
+        }
+
+        Status = AcpiNsGrowInitArray ((void **) &Queue->Edges,
+            &Queue->EdgeSize, Queue->EdgeCount, sizeof (ACPI_DEVICE_INIT_EDGE));
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        Queue->Edges[Queue->EdgeCount].Prerequisite = Prerequisite;
+        Queue->Edges[Queue->EdgeCount].Dependent = Dependent;
+        Queue->EdgeCount++;
+        Queue->Items[Dependent].PendingDeps++;
+    }
+
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsGrowInitArray
+ *
+ * PARAMETERS:  Array           - One of the device init queue's arrays
+ *              Size            - Its allocated length, updated
+ *              Count           - Elements in use
+ *              ElementSize     - Size of one element
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Make room for one more element, doubling the array when it
+ *              is full.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiNsGrowInitArray (
+    void                    **Array,
+    UINT32                  *Size,
+    UINT32                  Count,
+    ACPI_SIZE               ElementSize)
+{
+    void                    *NewArray;
+    UINT32                  NewSize;
+
+
+    if (Count < *Size)
+    {
+        return (AE_OK);
+    }
+
+    NewSize = *Size ? (*Size * 2) : 16;
+    NewArray = ACPI_ALLOCATE_ZEROED ((ACPI_SIZE) NewSize * ElementSize);
+    if (!NewArray)
+    {
+        return (AE_NO_MEMORY);
+    }
+
+    if (*Array)
+    {
+        memcpy (NewArray, *Array, (ACPI_SIZE) Count * ElementSize);
+        ACPI_FREE (*Array);
+    }
+
+    *Array = NewArray;
+    *Size = NewSize;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsInitOrderIsAcyclic
+ *
+ * PARAMETERS:  Queue           - Device init queue
+ *
+ * RETURN:      TRUE if every queued subtree can eventually run
+ *
+ * DESCRIPTION: Check that the _DEP links between subtrees have no cycle,
+ *              which would leave the parallel walk waiting forever.
+ *
+ ******************************************************************************/
+
+static BOOLEAN
+AcpiNsInitOrderIsAcyclic (
+    ACPI_DEVICE_INIT_QUEUE  *Queue)
+{
+    UINT32                  *Counts;
+    UINT32                  Done = 0;
+    BOOLEAN                 Progress;
+    UINT32                  i;
+    UINT32                  j;
+
+
+    Counts = ACPI_ALLOCATE ((ACPI_SIZE) Queue->ItemCount * sizeof (UINT32));
+    if (!Counts)
+    {
+        return (FALSE);
+    }
+
+    for (i = 0; i < Queue->ItemCount; i++)
+    {
+        Counts[i] = Queue->Items[i].PendingDeps;
+    }
+
+    do
+    {
+        Progress = FALSE;
+        for (i = 0; i < Queue->ItemCount; i++)
+        {
+            if (Counts[i])
+            {
+                continue;
+            }
+
+            Counts[i] = ACPI_UINT32_MAX;
+            Progress = TRUE;
+            Done++;
+
+            for (j = 0; j < Queue->EdgeCount; j++)
+            {
+                if (Queue->Edges[j].Prerequisite == i)
+                {
+                    Counts[Queue->Edges[j].Dependent]--;
+                }
+            }
+        }
+
+    } while (Progress);
+
+    ACPI_FREE (Counts);
+    return ((BOOLEAN) (Done == Queue->ItemCount));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsCompleteInitItem
+ *
+ * PARAMETERS:  Queue           - Device init queue (lock held)
+ *              Index           - Finished (or skipped) subtree
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Mark a subtree done, release the subtrees waiting on it and
+ *              wake any workers that were waiting for work.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsCompleteInitItem (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    UINT32                  Index)
+{
+    UINT32                  i;
+
+
+    Queue->Items[Index].State = ACPI_INIT_ITEM_DONE;
+    Queue->Remaining--;
+
+    for (i = 0; i < Queue->EdgeCount; i++)
+    {
+        if (Queue->Edges[i].Prerequisite == Index)
+        {
+            Queue->Items[Queue->Edges[i].Dependent].PendingDeps--;
+        }
+    }
+
+    /* One unit at a time, as not every host can signal several at once */
+
+    while (Queue->Waiting)
+    {
+        (void) AcpiOsSignalSemaphore (Queue->WorkSem, 1);
+        Queue->Waiting--;
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsRunInitQueue
+ *
+ * PARAMETERS:  Queue           - Device init queue
+ *              EvaluateInfo    - Evaluate block owned by the calling thread
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Take subtrees whose prerequisites have finished and run
+ *              AcpiNsInitOneDevice on each listed device of the subtree,
+ *              skipping the devices below one that is neither present nor
+ *              functioning, until the queue is empty or a subtree fails.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsRunInitQueue (
+    ACPI_DEVICE_INIT_QUEUE  *Queue,
+    ACPI_EVALUATE_INFO      *EvaluateInfo)
+{
+    ACPI_DEVICE_WALK_INFO   WalkInfo;
+    ACPI_DEVICE_INIT_ITEM   *Item;
+    ACPI_STATUS             Status;
+    UINT32                  End;
+    UINT32                  i;
+    UINT32                  j;
+
+
+    (void) AcpiOsAcquireMutex (Queue->Lock, ACPI_WAIT_FOREVER);
+    while (Queue->Remaining && ACPI_SUCCESS (Queue->Status))
+    {
+        for (i = 0; i < Queue->ItemCount; i++)
+        {
+            if ((Queue->Items[i].State == ACPI_INIT_ITEM_PENDING) &&
+                !Queue->Items[i].PendingDeps)
+            {
+                break;
+            }
+        }
+
+        if (i == Queue->ItemCount)
+        {
+            /* Stop if the rest is already running, else wait for a _DEP */
+
+            if (Queue->Remaining == Queue->Running || !Queue->Running)
+            {
+                break;
+            }
+
+            Queue->Waiting++;
+            (void) AcpiOsReleaseMutex (Queue->Lock);
+            (void) AcpiOsWaitSemaphore (Queue->WorkSem, 1, ACPI_WAIT_FOREVER);
+            (void) AcpiOsAcquireMutex (Queue->Lock, ACPI_WAIT_FOREVER);
+            continue;
+        }
+
+        Item = &Queue->Items[i];
+        Item->State = ACPI_INIT_ITEM_RUNNING;
+        Queue->Running++;
+        (void) AcpiOsReleaseMutex (Queue->Lock);
+
+        /* Exactly what the serial walk does, limited to this subtree */
+
+        memset (&WalkInfo, 0, sizeof (ACPI_DEVICE_WALK_INFO));
+        WalkInfo.EvaluateInfo = EvaluateInfo;
+
+        Status = AE_OK;
+        End = Queue->Nodes[Item->FirstNode].SubtreeEnd;
+        for (j = Item->FirstNode; j < End; )
+        {
+            Status = AcpiNsInitOneDevice (Queue->Nodes[j].Node, 0,
+                &WalkInfo, NULL);
+            if (Status == AE_CTRL_DEPTH)
+            {
+                Status = AE_OK;
+                j = Queue->Nodes[j].SubtreeEnd;
+                continue;
+            }
+            if (ACPI_FAILURE (Status))
+            {
+                break;
+            }
+
+            j++;
+        }
+
+        (void) AcpiOsAcquireMutex (Queue->Lock, ACPI_WAIT_FOREVER);
+        Queue->Num_STA += WalkInfo.Num_STA;
+        Queue->Num_INI += WalkInfo.Num_INI;
+        if (ACPI_FAILURE (Status) && ACPI_SUCCESS (Queue->Status))
+        {
+            Queue->Status = Status;
+        }
+
+        Queue->Running--;
+        AcpiNsCompleteInitItem (Queue, i);
+    }
+
+    (void) AcpiOsReleaseMutex (Queue->Lock);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsInitWorker
+ *
+ * PARAMETERS:  Context         - Device init queue
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: AcpiOsExecute callback for one device init worker thread.
+ *
+ ******************************************************************************/
+
+static void ACPI_SYSTEM_XFACE
+AcpiNsInitWorker (
+    void                    *Context)
+{
+    ACPI_DEVICE_INIT_QUEUE  *Queue = ACPI_CAST_PTR (ACPI_DEVICE_INIT_QUEUE, Context);
+    ACPI_EVALUATE_INFO      *EvaluateInfo;
+
+
+    EvaluateInfo = ACPI_ALLOCATE_ZEROED (sizeof (ACPI_EVALUATE_INFO));
+    if (EvaluateInfo)
+    {
+        AcpiNsRunInitQueue (Queue, EvaluateInfo);
+        ACPI_FREE (EvaluateInfo);
+    }
+
+    (void) AcpiOsSignalSemaphore (Queue->DoneSem, 1);
+}
@@ -526,6 +526,7 @@ AcpiNsRepair_CID (
     ACPI_OPERAND_OBJECT     **ElementPtr;
     ACPI_OPERAND_OBJECT     *OriginalElement;
     UINT16                  OriginalRefCount;
+    UINT8                   OriginalFlags;
     UINT32                  i;
 
     ACPI_FUNCTION_TRACE (NsRepair_CID);
@@ -552,6 +553,7 @@ AcpiNsRepair_CID (
     {
         OriginalElement = *ElementPtr;
         OriginalRefCount = OriginalElement->Common.ReferenceCount;
+        OriginalFlags = OriginalElement->Common.Flags;
 
         Status = AcpiNsRepair_HID (Info, ElementPtr);
         if (ACPI_FAILURE (Status))
@@ -561,10 +563,14 @@ AcpiNsRepair_CID (
 
         if (OriginalElement != *ElementPtr)
         {
-            /* Update reference count of new object */
-
+            /*
+             * Update reference count of new object. The package may be the
+             * _CID object itself, whose elements the device ID map watches.
+             */
             (*ElementPtr)->Common.ReferenceCount =
                 OriginalRefCount;
+            (*ElementPtr)->Common.Flags |=
+                (OriginalFlags & AOPOBJ_DEVICE_ID);
         }
 
         ElementPtr++;
@@ -169,6 +169,21 @@ AcpiNsSearchParentTree (
     ACPI_OBJECT_TYPE        Type,
     ACPI_NAMESPACE_NODE     **ReturnNode);
 
+static UINT32
+AcpiNsIndexHash (
+    UINT32                  Name,
+    UINT32                  Size);
+
+static ACPI_NAMESPACE_NODE *
+AcpiNsIndexLookup (
+    ACPI_NS_INDEX           *Index,
+    UINT32                  TargetName);
+
+static void
+AcpiNsIndexAdd (
+    ACPI_NS_INDEX           *Index,
+    ACPI_NAMESPACE_NODE     *Node);
+
 
 /*******************************************************************************
  *
@@ -189,16 +204,11 @@ AcpiNsSearchParentTree (
  *      Named object lists are built (and subsequently dumped) in the
  *      order in which the names are encountered during the namespace load;
  *
- *      All namespace searching is linear in this implementation, but
- *      could be easily modified to support any improved search
- *      algorithm. However, the linear search was chosen for simplicity
- *      and because the trees are small and the other interpreter
- *      execution overhead is relatively high.
- *
- *      Note: CPU execution analysis has shown that the AML interpreter spends
- *      a very small percentage of its time searching the namespace. Therefore,
- *      the linear search seems to be sufficient, as there would seem to be
- *      little value in improving the search.
+ *      Most scopes are small and are searched linearly. Scopes that have
+ *      grown past AcpiGbl_NamespaceIndexThreshold children carry a hashed
+ *      child index (see AcpiNsBuildScopeIndex), which makes the search
+ *      constant time for wide scopes such as \_SB on large server
+ *      DSDTs and the processor scopes of SSDT-heavy machines.
  *
  ******************************************************************************/
 
@@ -237,35 +247,40 @@ AcpiNsSearchOneScope (
      * Search for name at this namespace level, which is to say that we
      * must search for the name among the children of this object
      */
-    Node = ParentNode->Child;
-    while (Node)
+    if (ParentNode->ChildIndex)
     {
-        /* Check for match against the name */
-
-        if (Node->Name.Integer == TargetName)
+        Node = AcpiNsIndexLookup (ParentNode->ChildIndex, TargetName);
+    }
+    else
+    {
+        Node = ParentNode->Child;
+        while (Node && (Node->Name.Integer != TargetName))
         {
-            /* Resolve a control method alias if any */
+            /* Didn't match name, move on to the next peer object */
 
-            if (AcpiNsGetType (Node) == ACPI_TYPE_LOCAL_METHOD_ALIAS)
-            {
-                Node = ACPI_CAST_PTR (ACPI_NAMESPACE_NODE, Node->Object);
-            }
-
-            /* Found matching entry */
+            Node = Node->Peer;
+        }
+    }
 
-            ACPI_DEBUG_PRINT ((ACPI_DB_NAMES,
-                "Name [%4.4s] (%s) %p found in scope [%4.4s] %p\n",
-                ACPI_CAST_PTR (char, &TargetName),
-                AcpiUtGetTypeName (Node->Type),
-                Node, AcpiUtGetNodeName (ParentNode), ParentNode));
+    if (Node)
+    {
+        /* Resolve a control method alias if any */
 
-            *ReturnNode = Node;
-            return_ACPI_STATUS (AE_OK);
+        if (AcpiNsGetType (Node) == ACPI_TYPE_LOCAL_METHOD_ALIAS)
+        {
+            Node = ACPI_CAST_PTR (ACPI_NAMESPACE_NODE, Node->Object);
         }
 
-        /* Didn't match name, move on to the next peer object */
+        /* Found matching entry */
+
+        ACPI_DEBUG_PRINT ((ACPI_DB_NAMES,
+            "Name [%4.4s] (%s) %p found in scope [%4.4s] %p\n",
+            ACPI_CAST_PTR (char, &TargetName),
+            AcpiUtGetTypeName (Node->Type),
+            Node, AcpiUtGetNodeName (ParentNode), ParentNode));
 
-        Node = Node->Peer;
+        *ReturnNode = Node;
+        return_ACPI_STATUS (AE_OK);
     }
 
     /* Searched entire namespace level, not found */
@@ -529,9 +544,13 @@ AcpiNsSearchAndEnter (
         return_ACPI_STATUS (AE_NOT_FOUND);
     }
 
-    /* Create the new named object */
-
-    NewNode = AcpiNsCreateNode (TargetName);
+    /*
+     * Create the new named object. Permanent nodes are allocated from the
+     * arena of the table that is loading them; temporary (method) nodes
+     * come from the general node cache.
+     */
+    NewNode = AcpiNsCreateNode (TargetName,
+        (WalkState && !(Flags & ACPI_NS_TEMPORARY)) ? WalkState->OwnerId : 0);
     if (!NewNode)
     {
         return_ACPI_STATUS (AE_NO_MEMORY);
@@ -559,3 +578,356 @@ AcpiNsSearchAndEnter (
     *ReturnNode = NewNode;
     return_ACPI_STATUS (AE_OK);
 }
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsIndexHash
+ *
+ * PARAMETERS:  Name            - 4-character ACPI name as an integer
+ *              Size            - Slot count of the index (power of 2)
+ *
+ * RETURN:      Home slot for the name
+ *
+ * DESCRIPTION: Multiplicative hash of an ACPI name. Names are four ASCII
+ *              characters that often share a prefix (PCI0, PCI1, ...), so
+ *              the high bits are folded back in before masking.
+ *
+ ******************************************************************************/
+
+static UINT32
+AcpiNsIndexHash (
+    UINT32                  Name,
+    UINT32                  Size)
+{
+    UINT32                  Hash;
+
+
+    Hash = Name * 0x9E3779B1;
+    Hash ^= (Hash >> 16);
+    return (Hash & (Size - 1));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsIndexLookup
+ *
+ * PARAMETERS:  Index           - Child index of the scope being searched
+ *              TargetName      - Ascii ACPI name to search for
+ *
+ * RETURN:      Matching child node, NULL if not found
+ *
+ * DESCRIPTION: Probe a scope's child index for a name.
+ *
+ ******************************************************************************/
+
+static ACPI_NAMESPACE_NODE *
+AcpiNsIndexLookup (
+    ACPI_NS_INDEX           *Index,
+    UINT32                  TargetName)
+{
+    ACPI_NAMESPACE_NODE     *Node;
+    UINT32                  Slot;
+
+
+    Slot = AcpiNsIndexHash (TargetName, Index->Size);
+    while ((Node = Index->Table[Slot]) != NULL)
+    {
+        if ((Node != ACPI_NS_INDEX_DELETED) &&
+            (Node->Name.Integer == TargetName))
+        {
+            return (Node);
+        }
+
+        Slot = (Slot + 1) & (Index->Size - 1);
+    }
+
+    return (NULL);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsIndexAdd
+ *
+ * PARAMETERS:  Index           - Child index to add to
+ *              Node            - Child node to add
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Enter a node into a child index. The caller guarantees there
+ *              is a free slot. If a peer with the same name is already
+ *              indexed it stays visible, matching the first-match semantics
+ *              of a linear walk of the peer list.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsIndexAdd (
+    ACPI_NS_INDEX           *Index,
+    ACPI_NAMESPACE_NODE     *Node)
+{
+    ACPI_NAMESPACE_NODE     **FreeSlot = NULL;
+    ACPI_NAMESPACE_NODE     *Entry;
+    UINT32                  Slot;
+
+
+    Slot = AcpiNsIndexHash (Node->Name.Integer, Index->Size);
+    while ((Entry = Index->Table[Slot]) != NULL)
+    {
+        if (Entry == ACPI_NS_INDEX_DELETED)
+        {
+            if (!FreeSlot)
+            {
+                FreeSlot = &Index->Table[Slot];
+            }
+        }
+        else if (Entry->Name.Integer == Node->Name.Integer)
+        {
+            Index->Duplicates++;
+            return;
+        }
+
+        Slot = (Slot + 1) & (Index->Size - 1);
+    }
+
+    if (FreeSlot)
+    {
+        Index->Deleted--;
+    }
+    else
+    {
+        FreeSlot = &Index->Table[Slot];
+    }
+
+    *FreeSlot = Node;
+    Index->Count++;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsBuildScopeIndex
+ *
+ * PARAMETERS:  ParentNode      - Scope whose children are to be indexed
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: (Re)build the hashed child index of a scope from its peer
+ *              list. Called by AcpiNsInstallNode once a scope reaches
+ *              AcpiGbl_NamespaceIndexThreshold children, and whenever an
+ *              existing index fills up. The new index replaces any old one
+ *              only after it is complete.
+ *
+ * MUTEX:       Caller must hold the same lock that protects the scope's
+ *              peer list (namespace or interpreter mutex).
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiNsBuildScopeIndex (
+    ACPI_NAMESPACE_NODE     *ParentNode)
+{
+    ACPI_NS_INDEX           *Index;
+    ACPI_NAMESPACE_NODE     *Node;
+    UINT32                  ChildCount = 0;
+    UINT32                  Size = ACPI_NS_INDEX_MIN_SIZE;
+
+
+    ACPI_FUNCTION_TRACE_PTR (NsBuildScopeIndex, ParentNode);
+
+
+    for (Node = ParentNode->Child; Node; Node = Node->Peer)
+    {
+        ChildCount++;
+    }
+
+    /* Keep the load factor at or below one half after a rebuild */
+
+    while (Size < (ChildCount * 2))
+    {
+        Size <<= 1;
+    }
+
+    Index = ACPI_ALLOCATE_ZEROED (sizeof (ACPI_NS_INDEX));
+    if (!Index)
+    {
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    Index->Table = ACPI_ALLOCATE_ZEROED (
+        (ACPI_SIZE) Size * sizeof (ACPI_NAMESPACE_NODE *));
+    if (!Index->Table)
+    {
+        ACPI_FREE (Index);
+        return_ACPI_STATUS (AE_NO_MEMORY);
+    }
+
+    Index->Size = Size;
+    for (Node = ParentNode->Child; Node; Node = Node->Peer)
+    {
+        AcpiNsIndexAdd (Index, Node);
+        Index->LastChild = Node;
+    }
+
+    AcpiNsDeleteScopeIndex (ParentNode);
+    ParentNode->ChildIndex = Index;
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_NAMES,
+        "Indexed %u children of [%4.4s] %p, %u slots\n",
+        ChildCount, AcpiUtGetNodeName (ParentNode), ParentNode, Size));
+
+    return_ACPI_STATUS (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsIndexInsertNode
+ *
+ * PARAMETERS:  ParentNode      - Indexed scope
+ *              Node            - Child just appended to the peer list
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Add a newly installed child to its parent's index, growing
+ *              the index when it is three quarters full. If the index cannot
+ *              be grown it is dropped and the scope reverts to linear search.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsIndexInsertNode (
+    ACPI_NAMESPACE_NODE     *ParentNode,
+    ACPI_NAMESPACE_NODE     *Node)
+{
+    ACPI_NS_INDEX           *Index = ParentNode->ChildIndex;
+
+
+    ACPI_FUNCTION_ENTRY ();
+
+
+    if (!Index)
+    {
+        return;
+    }
+
+    Index->LastChild = Node;
+
+    if (((Index->Count + Index->Deleted + 1) * 4) > (Index->Size * 3))
+    {
+        if (ACPI_FAILURE (AcpiNsBuildScopeIndex (ParentNode)))
+        {
+            AcpiNsDeleteScopeIndex (ParentNode);
+        }
+        return;
+    }
+
+    AcpiNsIndexAdd (Index, Node);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsIndexRemoveNode
+ *
+ * PARAMETERS:  ParentNode      - Indexed scope
+ *              Node            - Child just unlinked from the peer list
+ *              PrevNode        - Peer that preceded Node, NULL if none
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Remove an unlinked child from its parent's index. If the
+ *              child was shadowing a later peer of the same name the index
+ *              is dropped, since that peer must now become visible; it will
+ *              be rebuilt by the next install into the scope.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsIndexRemoveNode (
+    ACPI_NAMESPACE_NODE     *ParentNode,
+    ACPI_NAMESPACE_NODE     *Node,
+    ACPI_NAMESPACE_NODE     *PrevNode)
+{
+    ACPI_NS_INDEX           *Index = ParentNode->ChildIndex;
+    ACPI_NAMESPACE_NODE     *Entry;
+    UINT32                  Slot;
+
+
+    ACPI_FUNCTION_ENTRY ();
+
+
+    if (!Index)
+    {
+        return;
+    }
+
+    if (Index->LastChild == Node)
+    {
+        Index->LastChild = PrevNode;
+    }
+
+    Slot = AcpiNsIndexHash (Node->Name.Integer, Index->Size);
+    while ((Entry = Index->Table[Slot]) != NULL)
+    {
+        if ((Entry != ACPI_NS_INDEX_DELETED) &&
+            (Entry->Name.Integer == Node->Name.Integer))
+        {
+            if (Entry != Node)
+            {
+                /* Node was itself a shadowed duplicate */
+
+                Index->Duplicates--;
+            }
+            else if (Index->Duplicates)
+            {
+                AcpiNsDeleteScopeIndex (ParentNode);
+            }
+            else
+            {
+                Index->Table[Slot] = ACPI_NS_INDEX_DELETED;
+                Index->Count--;
+                Index->Deleted++;
+            }
+            return;
+        }
+
+        Slot = (Slot + 1) & (Index->Size - 1);
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeleteScopeIndex
+ *
+ * PARAMETERS:  ParentNode      - Scope whose index is to be deleted
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Free a scope's child index, if any. The peer list is not
+ *              affected.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsDeleteScopeIndex (
+    ACPI_NAMESPACE_NODE     *ParentNode)
+{
+    ACPI_NS_INDEX           *Index = ParentNode->ChildIndex;
+
+
+    ACPI_FUNCTION_ENTRY ();
+
+
+    if (!Index)
+    {
+        return;
+    }
+
+    ParentNode->ChildIndex = NULL;
+    ACPI_FREE (Index->Table);
+    ACPI_FREE (Index);
+}
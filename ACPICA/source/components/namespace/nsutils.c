@@ -160,6 +160,17 @@
 
 /* Local prototypes */
 
+static ACPI_NS_PATH_CACHE_ENTRY *
+AcpiNsPathCacheLookup (
+    const char              *Pathname,
+    UINT32                  *ReturnHash);
+
+static void
+AcpiNsPathCacheInsert (
+    const char              *Pathname,
+    UINT32                  Hash,
+    ACPI_NAMESPACE_NODE     *Node);
+
 #ifdef ACPI_OBSOLETE_FUNCTIONS
 ACPI_NAME
 AcpiNsFindParentName (
@@ -822,6 +833,9 @@ AcpiNsTerminate (
     }
 
     AcpiNsDeleteNode (AcpiGbl_RootNode);
+    AcpiNsDeletePathCache ();
+    AcpiNsDeleteDeviceIdMap ();
+    AcpiNsDeleteNodeArenas ();
     (void) AcpiUtReleaseMutex (ACPI_MTX_NAMESPACE);
 
     ACPI_DEBUG_PRINT ((ACPI_DB_INFO, "Namespace freed\n"));
@@ -859,6 +873,172 @@ AcpiNsOpensScope (
 }
 
 
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsInvalidatePathCache
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Invalidate every entry of the absolute pathname lookup cache
+ *              and of the per-method name caches by advancing the namespace
+ *              generation. Called whenever a node that could change a
+ *              cached lookup is installed or deleted, and on table load and
+ *              unload.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsInvalidatePathCache (
+    void)
+{
+
+    AcpiGbl_NsPathCacheGeneration++;
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsDeletePathCache
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Free the absolute pathname lookup cache.
+ *
+ ******************************************************************************/
+
+void
+AcpiNsDeletePathCache (
+    void)
+{
+
+    if (AcpiGbl_NsPathCache)
+    {
+        ACPI_FREE (AcpiGbl_NsPathCache);
+        AcpiGbl_NsPathCache = NULL;
+    }
+
+    AcpiNsInvalidatePathCache ();
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsPathCacheLookup
+ *
+ * PARAMETERS:  Pathname        - Absolute pathname in external format
+ *              ReturnHash      - Where the hash of Pathname is returned,
+ *                                zero if the path is too long to be cached
+ *
+ * RETURN:      Matching valid cache entry, NULL on a miss
+ *
+ * DESCRIPTION: Look up an absolute pathname in the lookup cache. The cache
+ *              is direct mapped; the slot is chosen by an FNV-1a hash of the
+ *              external pathname.
+ *
+ ******************************************************************************/
+
+static ACPI_NS_PATH_CACHE_ENTRY *
+AcpiNsPathCacheLookup (
+    const char              *Pathname,
+    UINT32                  *ReturnHash)
+{
+    ACPI_NS_PATH_CACHE_ENTRY    *Entry;
+    UINT32                      Hash = 2166136261u;
+    UINT32                      Length = 0;
+
+
+    *ReturnHash = 0;
+
+    while (Pathname[Length])
+    {
+        if (Length >= (ACPI_NS_PATH_CACHE_NAME_LENGTH - 1))
+        {
+            return (NULL);
+        }
+
+        Hash = (Hash ^ (UINT8) Pathname[Length]) * 16777619u;
+        Length++;
+    }
+
+    /* Zero is reserved for "not cacheable" */
+
+    Hash |= 1;
+    *ReturnHash = Hash;
+
+    if (!AcpiGbl_NsPathCache)
+    {
+        AcpiGbl_NsPathCacheMisses++;
+        return (NULL);
+    }
+
+    Entry = &AcpiGbl_NsPathCache[Hash & (ACPI_NS_PATH_CACHE_SIZE - 1)];
+    if (Entry->Node &&
+        (Entry->Hash == Hash) &&
+        (Entry->Generation == AcpiGbl_NsPathCacheGeneration) &&
+        !strcmp (Entry->Pathname, Pathname))
+    {
+        AcpiGbl_NsPathCacheHits++;
+        return (Entry);
+    }
+
+    AcpiGbl_NsPathCacheMisses++;
+    return (NULL);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiNsPathCacheInsert
+ *
+ * PARAMETERS:  Pathname        - Absolute pathname in external format
+ *              Hash            - Hash returned by AcpiNsPathCacheLookup
+ *              Node            - Node the pathname resolved to
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Record a successful absolute lookup, replacing whatever
+ *              occupied the slot. Temporary (method-local) nodes are never
+ *              cached, so method execution does not have to invalidate the
+ *              cache when it cleans up after itself.
+ *
+ ******************************************************************************/
+
+static void
+AcpiNsPathCacheInsert (
+    const char              *Pathname,
+    UINT32                  Hash,
+    ACPI_NAMESPACE_NODE     *Node)
+{
+    ACPI_NS_PATH_CACHE_ENTRY    *Entry;
+
+
+    if (!Hash || (Node->Flags & ANOBJ_TEMPORARY))
+    {
+        return;
+    }
+
+    if (!AcpiGbl_NsPathCache)
+    {
+        AcpiGbl_NsPathCache = ACPI_ALLOCATE_ZEROED (
+            ACPI_NS_PATH_CACHE_SIZE * sizeof (ACPI_NS_PATH_CACHE_ENTRY));
+        if (!AcpiGbl_NsPathCache)
+        {
+            return;
+        }
+    }
+
+    Entry = &AcpiGbl_NsPathCache[Hash & (ACPI_NS_PATH_CACHE_SIZE - 1)];
+    Entry->Node = Node;
+    Entry->Hash = Hash;
+    Entry->Generation = AcpiGbl_NsPathCacheGeneration;
+    strcpy (Entry->Pathname, Pathname);
+}
+
+
 /*******************************************************************************
  *
  * FUNCTION:    AcpiNsGetNodeUnlocked
@@ -889,8 +1069,10 @@ AcpiNsGetNodeUnlocked (
     ACPI_NAMESPACE_NODE     **ReturnNode)
 {
     ACPI_GENERIC_STATE      ScopeInfo;
+    ACPI_NS_PATH_CACHE_ENTRY    *Entry;
     ACPI_STATUS             Status;
     char                    *InternalPath;
+    UINT32                  CacheHash = 0;
 
 
     ACPI_FUNCTION_TRACE_PTR (NsGetNodeUnlocked, ACPI_CAST_PTR (char, Pathname));
@@ -917,6 +1099,21 @@ AcpiNsGetNodeUnlocked (
         return_ACPI_STATUS (AE_OK);
     }
 
+    /*
+     * Absolute pathnames resolve independently of PrefixNode and Flags,
+     * so they can be answered from the lookup cache.
+     */
+    if (ACPI_IS_ROOT_PREFIX (Pathname[0]) &&
+        AcpiGbl_EnableNamespacePathCache)
+    {
+        Entry = AcpiNsPathCacheLookup (Pathname, &CacheHash);
+        if (Entry)
+        {
+            *ReturnNode = Entry->Node;
+            return_ACPI_STATUS (AE_OK);
+        }
+    }
+
     /* Convert path to internal representation */
 
     Status = AcpiNsInternalizeName (Pathname, &InternalPath);
@@ -939,6 +1136,10 @@ AcpiNsGetNodeUnlocked (
         ACPI_DEBUG_PRINT ((ACPI_DB_EXEC, "%s, %s\n",
             Pathname, AcpiFormatException (Status)));
     }
+    else if (CacheHash)
+    {
+        AcpiNsPathCacheInsert (Pathname, CacheHash, *ReturnNode);
+    }
 
     ACPI_FREE (InternalPath);
     return_ACPI_STATUS (Status);
@@ -980,7 +1181,7 @@ AcpiNsGetNode (
     ACPI_FUNCTION_TRACE_PTR (NsGetNode, ACPI_CAST_PTR (char, Pathname));
 
 
-    Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
+    Status = AcpiUtAcquireNamespaceForLookup ();
     if (ACPI_FAILURE (Status))
     {
         return_ACPI_STATUS (Status);
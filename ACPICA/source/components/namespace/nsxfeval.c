@@ -846,11 +846,7 @@ AcpiNsGetDeviceCallback (
     ACPI_STATUS             Status;
     ACPI_NAMESPACE_NODE     *Node;
     UINT32                  Flags;
-    ACPI_PNP_DEVICE_ID      *Hid;
-    ACPI_PNP_DEVICE_ID_LIST *Cid;
-    UINT32                  i;
     BOOLEAN                 Found;
-    int                     NoMatch;
 
 
     Status = AcpiUtAcquireMutex (ACPI_MTX_NAMESPACE);
@@ -887,54 +883,15 @@ AcpiNsGetDeviceCallback (
      */
     if (Info->Hid != NULL)
     {
-        Status = AcpiUtExecute_HID (Node, &Hid);
-        if (Status == AE_NOT_FOUND)
-        {
-            return (AE_OK);
-        }
-        else if (ACPI_FAILURE (Status))
+        Status = AcpiNsMatchDeviceId (Node, Info->Hid, &Found);
+        if (ACPI_FAILURE (Status))
         {
             return (AE_CTRL_DEPTH);
         }
 
-        NoMatch = strcmp (Hid->String, Info->Hid);
-        ACPI_FREE (Hid);
-
-        if (NoMatch)
+        if (!Found)
         {
-            /*
-             * HID does not match, attempt match within the
-             * list of Compatible IDs (CIDs)
-             */
-            Status = AcpiUtExecute_CID (Node, &Cid);
-            if (Status == AE_NOT_FOUND)
-            {
-                return (AE_OK);
-            }
-            else if (ACPI_FAILURE (Status))
-            {
-                return (AE_CTRL_DEPTH);
-            }
-
-            /* Walk the CID list */
-
-            Found = FALSE;
-            for (i = 0; i < Cid->Count; i++)
-            {
-                if (strcmp (Cid->Ids[i].String, Info->Hid) == 0)
-                {
-                    /* Found a matching CID */
-
-                    Found = TRUE;
-                    break;
-                }
-            }
-
-            ACPI_FREE (Cid);
-            if (!Found)
-            {
-                return (AE_OK);
-            }
+            return (AE_OK);
         }
     }
 
@@ -999,6 +956,7 @@ AcpiGetDevices (
 {
     ACPI_STATUS             Status;
     ACPI_GET_DEVICES_INFO   Info;
+    ACPI_NS_ID_MAP          *Map;
 
 
     ACPI_FUNCTION_TRACE (AcpiGetDevices);
@@ -1019,6 +977,33 @@ AcpiGetDevices (
     Info.Context = Context;
     Info.UserFunction = UserFunction;
 
+    /*
+     * A query for a specific ID is answered from the device ID map when one
+     * can be built. The namespace reader lock keeps table unload out while
+     * the device nodes of the map are in use.
+     */
+    if (HID && AcpiGbl_EnableDeviceIdMap)
+    {
+        Status = AcpiUtAcquireReadLock (&AcpiGbl_NamespaceRwLock);
+        if (ACPI_FAILURE (Status))
+        {
+            return_ACPI_STATUS (Status);
+        }
+
+        Status = AcpiNsGetDeviceIdMap (&Map);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiNsWalkDeviceIdMap (Map, &Info, ReturnValue);
+            AcpiNsReleaseDeviceIdMap (Map);
+            (void) AcpiUtReleaseReadLock (&AcpiGbl_NamespaceRwLock);
+            return_ACPI_STATUS (Status);
+        }
+
+        /* No map could be built, use the namespace walk */
+
+        (void) AcpiUtReleaseReadLock (&AcpiGbl_NamespaceRwLock);
+    }
+
     /*
      * Lock the namespace around the walk.
      * The namespace will be unlocked/locked around each call
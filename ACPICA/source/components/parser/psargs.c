@@ -399,9 +399,7 @@ AcpiPsGetNextNamepath (
      * we just want to lookup the object (must be mode EXECUTE to perform
      * the upsearch)
      */
-    Status = AcpiNsLookup (WalkState->ScopeInfo, Path,
-        ACPI_TYPE_ANY, ACPI_IMODE_EXECUTE,
-        ACPI_NS_SEARCH_PARENT | ACPI_NS_DONT_OPEN_SCOPE, NULL, &Node);
+    Status = AcpiNsLookupMethodName (WalkState, Path, &Node);
 
     /*
      * If this name is a control method invocation, we must
@@ -0,0 +1,2595 @@
+/******************************************************************************
+ *
+ * Module Name: psdecode - Pre-decoded control method execution
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * 1. Copyright Notice
+ *
+ * Some or all of this work - Copyright (c) 1999 - 2025, Intel Corp.
+ * All rights reserved.
+ *
+ * 2. License
+ *
+ * 2.1. This is your license from Intel Corp. under its intellectual property
+ * rights. You may have additional license terms from the party that provided
+ * you this software, covering your right to use that party's intellectual
+ * property rights.
+ *
+ * 2.2. Intel grants, free of charge, to any person ("Licensee") obtaining a
+ * copy of the source code appearing in this file ("Covered Code") an
+ * irrevocable, perpetual, worldwide license under Intel's copyrights in the
+ * base code distributed originally by Intel ("Original Intel Code") to copy,
+ * make derivatives, distribute, use and display any portion of the Covered
+ * Code in any form, with the right to sublicense such rights; and
+ *
+ * 2.3. Intel grants Licensee a non-exclusive and non-transferable patent
+ * license (with the right to sublicense), under only those claims of Intel
+ * patents that are infringed by the Original Intel Code, to make, use, sell,
+ * offer to sell, and import the Covered Code and derivative works thereof
+ * solely to the minimum extent necessary to exercise the above copyright
+ * license, and in no event shall the patent license extend to any additions
+ * to or modifications of the Original Intel Code. No other license or right
+ * is granted directly or by implication, estoppel or otherwise;
+ *
+ * The above copyright and patent license is granted only if the following
+ * conditions are met:
+ *
+ * 3. Conditions
+ *
+ * 3.1. Redistribution of Source with Rights to Further Distribute Source.
+ * Redistribution of source code of any substantial portion of the Covered
+ * Code or modification with rights to further distribute source must include
+ * the above Copyright Notice, the above License, this list of Conditions,
+ * and the following Disclaimer and Export Compliance provision. In addition,
+ * Licensee must cause all Covered Code to which Licensee contributes to
+ * contain a file documenting the changes Licensee made to create that Covered
+ * Code and the date of any change. Licensee must include in that file the
+ * documentation of any changes made by any predecessor Licensee. Licensee
+ * must include a prominent statement that the modification is derived,
+ * directly or indirectly, from Original Intel Code.
+ *
+ * 3.2. Redistribution of Source with no Rights to Further Distribute Source.
+ * Redistribution of source code of any substantial portion of the Covered
+ * Code or modification without rights to further distribute source must
+ * include the following Disclaimer and Export Compliance provision in the
+ * documentation and/or other materials provided with distribution. In
+ * addition, Licensee may not authorize further sublicense of source of any
+ * portion of the Covered Code, and must include terms to the effect that the
+ * license from Licensee to its licensee is limited to the intellectual
+ * property embodied in the software Licensee provides to its licensee, and
+ * not to intellectual property embodied in modifications its licensee may
+ * make.
+ *
+ * 3.3. Redistribution of Executable. Redistribution in executable form of any
+ * substantial portion of the Covered Code or modification must reproduce the
+ * above Copyright Notice, and the following Disclaimer and Export Compliance
+ * provision in the documentation and/or other materials provided with the
+ * distribution.
+ *
+ * 3.4. Intel retains all right, title, and interest in and to the Original
+ * Intel Code.
+ *
+ * 3.5. Neither the name Intel nor any other trademark owned or controlled by
+ * Intel shall be used in advertising or otherwise to promote the sale, use or
+ * other dealings in products derived from or relating to the Covered Code
+ * without prior written authorization from Intel.
+ *
+ * 4. Disclaimer and Export Compliance
+ *
+ * 4.1. INTEL MAKES NO WARRANTY OF ANY KIND REGARDING ANY SOFTWARE PROVIDED
+ * HERE. ANY SOFTWARE ORIGINATING FROM INTEL OR DERIVED FROM INTEL SOFTWARE
+ * IS PROVIDED "AS IS," AND INTEL WILL NOT PROVIDE ANY SUPPORT, ASSISTANCE,
+ * INSTALLATION, TRAINING OR OTHER SERVICES. INTEL WILL NOT PROVIDE ANY
+ * UPDATES, ENHANCEMENTS OR EXTENSIONS. INTEL SPECIFICALLY DISCLAIMS ANY
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, NONINFRINGEMENT AND FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ *
+ * 4.2. IN NO EVENT SHALL INTEL HAVE ANY LIABILITY TO LICENSEE, ITS LICENSEES
+ * OR ANY OTHER THIRD PARTY, FOR ANY LOST PROFITS, LOST DATA, LOSS OF USE OR
+ * COSTS OF PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES, OR FOR ANY INDIRECT,
+ * SPECIAL OR CONSEQUENTIAL DAMAGES ARISING OUT OF THIS AGREEMENT, UNDER ANY
+ * CAUSE OF ACTION OR THEORY OF LIABILITY, AND IRRESPECTIVE OF WHETHER INTEL
+ * HAS ADVANCE NOTICE OF THE POSSIBILITY OF SUCH DAMAGES. THESE LIMITATIONS
+ * SHALL APPLY NOTWITHSTANDING THE FAILURE OF THE ESSENTIAL PURPOSE OF ANY
+ * LIMITED REMEDY.
+ *
+ * 4.3. Licensee shall not export, either directly or indirectly, any of this
+ * software or system incorporating such software without first obtaining any
+ * required license or other approval from the U. S. Department of Commerce or
+ * any other agency or department of the United States Government. In the
+ * event Licensee exports any such software from the United States or
+ * re-exports any such software from a foreign destination, Licensee shall
+ * ensure that the distribution and export/re-export of the software is in
+ * compliance with all laws, regulations, orders, or other restrictions of the
+ * U.S. Export Administration Regulations. Licensee agrees that neither it nor
+ * any of its subsidiaries will export/re-export any technical data, process,
+ * software, or service, directly or indirectly, to any country for which the
+ * United States government or any agency thereof requires an export license,
+ * other governmental approval, or letter of assurance, without first obtaining
+ * such license, approval or letter.
+ *
+ *****************************************************************************
+ *
+ * Alternatively, you may choose to be licensed under the terms of the
+ * following license:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions, and the following disclaimer,
+ *    without modification.
+ * 2. Redistributions in binary form must reproduce at minimum a disclaimer
+ *    substantially similar to the "NO WARRANTY" disclaimer below
+ *    ("Disclaimer") and any redistribution must be conditioned upon
+ *    including a substantially similar Disclaimer requirement for further
+ *    binary redistribution.
+ * 3. Neither the names of the above-listed copyright holders nor the names
+ *    of any contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Alternatively, you may choose to be licensed under the terms of the
+ * GNU General Public License ("GPL") version 2 as published by the Free
+ * Software Foundation.
+ *
+ *****************************************************************************/
+
+#include "acpi.h"
+#include "accommon.h"
+#include "acparser.h"
+#include "acinterp.h"
+#include "acnamesp.h"
+#include "amlcode.h"
+
+
+#define _COMPONENT          ACPI_PARSER
+        ACPI_MODULE_NAME    ("psdecode")
+
+/*
+ * Decoded operations. Operands are taken from and results pushed onto a
+ * small operand stack; a value is an integer, or a buffer object where an
+ * operation says so.
+ */
+#define ACPI_DOP_CONSTANT       0   /* Push Constants[Operand] */
+#define ACPI_DOP_LOCAL          1   /* Push Local[Index] */
+#define ACPI_DOP_ARG            2   /* Push Arg[Index] */
+#define ACPI_DOP_STORE          3   /* Local[Index] = top (not popped) */
+#define ACPI_DOP_POP            4
+#define ACPI_DOP_MATH           5   /* Binary AmlOpcode via AcpiExDoMathOp */
+#define ACPI_DOP_DIVIDE         6   /* Push quotient, remainder to Local[Index] */
+#define ACPI_DOP_MOD            7
+#define ACPI_DOP_NOT            8
+#define ACPI_DOP_LOGICAL        9   /* Binary logical AmlOpcode */
+#define ACPI_DOP_LNOT           10
+#define ACPI_DOP_INCREMENT      11  /* Push ++Local[Index] */
+#define ACPI_DOP_DECREMENT      12  /* Push --Local[Index] */
+#define ACPI_DOP_BRANCH_ZERO    13  /* Pop, branch to Operand if zero */
+#define ACPI_DOP_BRANCH         14  /* Branch to Operand */
+#define ACPI_DOP_LOOP           15  /* Branch back to Operand (While) */
+#define ACPI_DOP_RETURN         16  /* Pop and return */
+#define ACPI_DOP_END            17  /* End of method, no Return */
+#define ACPI_DOP_BUFFER         18  /* Push buffer object Buffers[Operand] */
+#define ACPI_DOP_ARG_OBJECT     19  /* Push the object of Arg[Index] */
+#define ACPI_DOP_CREATE_FIELD   20  /* Check and enable Fields[Index] */
+#define ACPI_DOP_FIELD          21  /* Push Fields[Index] */
+#define ACPI_DOP_STORE_FIELD    22  /* Fields[Index] = top (not popped) */
+#define ACPI_DOP_NAME           23  /* Push named Integer Names[Operand] */
+#define ACPI_DOP_NAME_OBJECT    24  /* Push named Buffer Names[Operand] */
+#define ACPI_DOP_STORE_NAME     25  /* Names[Operand] = top (not popped) */
+#define ACPI_DOP_COMPARE        26  /* Binary logical AmlOpcode on two buffers */
+#define ACPI_DOP_RETURN_OBJECT  27  /* Pop and return the object, a copy if Index */
+
+#define ACPI_DOP_NO_LOCAL       0xFF
+#define ACPI_DOP_NO_TARGET      0xFF
+
+/*
+ * Method-local Names live in the Local slots after the eight Locals, and
+ * buffer fields are found by index. Both are bits in UINT8 masks.
+ */
+#define ACPI_DECODE_MAX_LOCAL_NAMES 8
+#define ACPI_DECODE_MAX_FIELDS      8
+#define ACPI_DECODE_SLOTS           (ACPI_METHOD_NUM_LOCALS + ACPI_DECODE_MAX_LOCAL_NAMES)
+
+/* What an operand writes or reads by reference, beyond the slot bits */
+
+#define ACPI_DECODE_FIELD_ACCESS    (1 << ACPI_DECODE_SLOTS)
+#define ACPI_DECODE_NAME_ACCESS     (1 << (ACPI_DECODE_SLOTS + 1))
+
+/* How often a running loop checks for the loop timeout */
+
+#define ACPI_DECODE_LOOP_CHECK  0xFFFF
+
+
+typedef struct acpi_decode_state
+{
+    ACPI_PARSE_STATE        Parser;         /* Current position in the AML */
+    ACPI_NAMESPACE_NODE     *MethodNode;
+    ACPI_DECODED_OP         *Ops;
+    UINT64                  *Constants;
+    ACPI_OPERAND_OBJECT     *Buffers[ACPI_DECODE_MAX_BUFFERS];
+    ACPI_DECODED_NAME       Names[ACPI_DECODE_MAX_NAMES];
+    UINT32                  NameLengths[ACPI_DECODE_MAX_NAMES];
+    ACPI_DECODED_FIELD      Fields[ACPI_DECODE_MAX_FIELDS];
+    UINT32                  FieldNames[ACPI_DECODE_MAX_FIELDS];
+    UINT32                  LocalNames[ACPI_DECODE_MAX_LOCAL_NAMES];
+    UINT32                  OpCount;
+    UINT32                  MaxOps;
+    UINT32                  ConstantCount;
+    UINT32                  LoopStart;      /* ACPI_UINT32_MAX outside While */
+    UINT32                  BreakChain;     /* Unresolved Breaks of the loop */
+    UINT32                  Depth;          /* Operand stack depth */
+    UINT32                  Writes;         /* Slots, fields, names written by the operand */
+    UINT32                  Generation;     /* Namespace generation of the lookups */
+    UINT8                   BufferCount;
+    UINT8                   NameCount;
+    UINT8                   FieldCount;
+    UINT8                   LocalNameCount;
+    UINT8                   ArgMask;
+    UINT8                   BufferArgMask;
+    UINT8                   AnyArgMask;
+    UINT8                   Flags;
+
+} ACPI_DECODE_STATE;
+
+typedef union acpi_decode_value
+{
+    UINT64                  Integer;
+    ACPI_OPERAND_OBJECT     *Object;
+
+} ACPI_DECODE_VALUE;
+
+
+/* Local prototypes */
+
+static ACPI_DECODED_METHOD *
+AcpiPsDecodeMethod (
+    ACPI_OPERAND_OBJECT     *MethodDesc,
+    ACPI_NAMESPACE_NODE     *MethodNode);
+
+static ACPI_STATUS
+AcpiPsDecodeTermList (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   *End);
+
+static ACPI_STATUS
+AcpiPsDecodeStatement (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   *End);
+
+static ACPI_STATUS
+AcpiPsDecodeCreateField (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Length);
+
+static ACPI_STATUS
+AcpiPsDecodeLocalName (
+    ACPI_DECODE_STATE       *State);
+
+static ACPI_STATUS
+AcpiPsDecodeTermArg (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Want,
+    UINT8                   *Type);
+
+static void
+AcpiPsDecodeTypeArg (
+    ACPI_DECODE_STATE       *State,
+    UINT32                  OpIndex,
+    UINT8                   Type);
+
+static ACPI_STATUS
+AcpiPsDecodeValue (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Want,
+    UINT8                   *Type);
+
+static ACPI_STATUS
+AcpiPsDecodeConstant (
+    ACPI_PARSE_STATE        *Parser,
+    UINT64                  *Value);
+
+static ACPI_STATUS
+AcpiPsDecodeBuffer (
+    ACPI_DECODE_STATE       *State);
+
+static ACPI_STATUS
+AcpiPsDecodeOperands (
+    ACPI_DECODE_STATE       *State,
+    UINT32                  Count,
+    UINT8                   *Type);
+
+static ACPI_STATUS
+AcpiPsDecodeTarget (
+    ACPI_DECODE_STATE       *State,
+    ACPI_DECODED_OP         *Target);
+
+static ACPI_STATUS
+AcpiPsDecodeName (
+    ACPI_DECODE_STATE       *State,
+    BOOLEAN                 Write,
+    ACPI_DECODED_OP         *Ref);
+
+static ACPI_STATUS
+AcpiPsDecodeNameSeg (
+    ACPI_DECODE_STATE       *State,
+    UINT32                  *Name);
+
+static ACPI_STATUS
+AcpiPsDecodeAddName (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   *Path,
+    UINT32                  Length,
+    BOOLEAN                 Shadow,
+    UINT8                   *Index);
+
+static ACPI_STATUS
+AcpiPsDecodeLookup (
+    ACPI_NAMESPACE_NODE     *MethodNode,
+    ACPI_DECODED_NAME       *Name);
+
+static ACPI_STATUS
+AcpiPsDecodeEmit (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Opcode,
+    UINT8                   Index,
+    UINT16                  AmlOpcode,
+    UINT32                  Operand,
+    INT32                   StackChange);
+
+static ACPI_STATUS
+AcpiPsRunDecodedMethod (
+    ACPI_DECODED_METHOD     *Method,
+    ACPI_OPERAND_OBJECT     **Parameters,
+    ACPI_OPERAND_OBJECT     **ReturnObject);
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsExecuteDecodedMethod
+ *
+ * PARAMETERS:  Info            - Method info block, contains:
+ *                  Node            - Method Node to execute
+ *                  ObjDesc         - Method object
+ *                  Parameters      - List of parameters to pass to the method,
+ *                                    terminated by NULL.
+ *                  ReturnObject    - Where to put method's return value (if
+ *                                    any). If NULL, no value is returned.
+ *
+ * RETURN:      Status. AE_CTRL_PARSE_CONTINUE means the method must be run
+ *              by the parser/interpreter (AcpiPsExecuteMethod).
+ *
+ * DESCRIPTION: Execute a control method from its pre-decoded form, decoding
+ *              it on the first call. Methods that compute on integers and
+ *              buffers held in Locals, Args, buffer fields of Args, method-
+ *              local Names and named Integers and Buffers can be decoded.
+ *              Until the method changes anything outside its invocation (a
+ *              buffer field or a named Integer), any condition the decoded
+ *              form does not reproduce exactly (an AML error, an argument
+ *              of another type, a loop timeout, an implicit return) is
+ *              handled by returning AE_CTRL_PARSE_CONTINUE and letting the
+ *              interpreter run the method from the start. After that, AML
+ *              errors are returned as the interpreter would return them.
+ *
+ *              Decoding needs the interpreter to ourselves; a thread that
+ *              holds it shared takes it exclusive first. MethodDesc->Method.
+ *              Decoded is published with release semantics and read with
+ *              acquire, so once it is set a method that touches nothing
+ *              but its own Locals and Args may be run without the
+ *              interpreter at all. Anything else (ACPI_DECODED_INTERPRETER)
+ *              runs with the interpreter held, exclusive when it writes.
+ *              A Serialized method runs exclusive, and only while no other
+ *              invocation of it is in progress.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiPsExecuteDecodedMethod (
+    ACPI_EVALUATE_INFO      *Info)
+{
+    ACPI_OPERAND_OBJECT     *MethodDesc = Info->ObjDesc;
+    ACPI_DECODED_METHOD     *Method;
+    ACPI_OPERAND_OBJECT     *Arg;
+    ACPI_STATUS             Status;
+    BOOLEAN                 Serialized;
+    UINT32                  Generation;
+    UINT32                  i;
+
+
+    ACPI_FUNCTION_TRACE (PsExecuteDecodedMethod);
+
+
+    /*
+     * Values are not truncated for 32-bit tables here. The single-step
+     * debugger goes through the interpreter.
+     */
+    if (!AcpiGbl_EnableDecodedMethods ||
+        (AcpiGbl_IntegerByteWidth == 4) ||
+        (MethodDesc->Method.InfoFlags &
+            (ACPI_METHOD_MODULE_LEVEL | ACPI_METHOD_INTERNAL_ONLY |
+             ACPI_METHOD_NOT_DECODABLE)))
+    {
+        return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+    }
+
+#ifdef ACPI_DEBUGGER
+    if (AcpiGbl_CmSingleStep)
+    {
+        return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+    }
+#endif
+
+    Serialized = (MethodDesc->Method.InfoFlags &
+        (ACPI_METHOD_SERIALIZED | ACPI_METHOD_SERIALIZED_PENDING)) ?
+        TRUE : FALSE;
+
+    Method = ACPI_LOAD_ACQUIRE (MethodDesc->Method.Decoded);
+    if (!Method || Serialized)
+    {
+        /* Another thread holding the interpreter shared may be decoding it */
+
+        AcpiExUpgradeInterpreter ();
+        Method = MethodDesc->Method.Decoded;
+
+        /*
+         * An invocation in progress holds the method's mutex, or has its
+         * method-local names in the namespace where decoding would see them
+         */
+        if ((!Method || Serialized) && MethodDesc->Method.ThreadCount)
+        {
+            return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+        }
+    }
+
+    if (!Method)
+    {
+        if (MethodDesc->Method.InfoFlags & ACPI_METHOD_NOT_DECODABLE)
+        {
+            return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+        }
+
+        Method = AcpiPsDecodeMethod (MethodDesc, Info->Node);
+        if (!Method)
+        {
+            MethodDesc->Method.InfoFlags |= ACPI_METHOD_NOT_DECODABLE;
+            return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+        }
+
+        /* Complete before it is seen by threads without the interpreter */
+
+        ACPI_STORE_RELEASE (MethodDesc->Method.Decoded, Method);
+    }
+
+    /* Every argument must be of the type the method reads it as */
+
+    for (i = 0; i < ACPI_METHOD_NUM_ARGS; i++)
+    {
+        if (!((Method->ArgMask | Method->BufferArgMask | Method->AnyArgMask) &
+            (1 << i)))
+        {
+            continue;
+        }
+
+        Arg = (Info->Parameters && (i < Info->ParamCount)) ?
+            Info->Parameters[i] : NULL;
+        if (!Arg ||
+            (ACPI_GET_DESCRIPTOR_TYPE (Arg) != ACPI_DESC_TYPE_OPERAND) ||
+            ((Method->ArgMask & (1 << i)) &&
+                (Arg->Common.Type != ACPI_TYPE_INTEGER)) ||
+            ((Method->BufferArgMask & (1 << i)) &&
+                (Arg->Common.Type != ACPI_TYPE_BUFFER)))
+        {
+            return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+        }
+    }
+
+    if (Method->Flags & ACPI_DECODED_WRITES)
+    {
+        /* The implicit return value is left to the interpreter */
+
+        if (AcpiGbl_EnableInterpreterSlack)
+        {
+            return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+        }
+
+        AcpiExUpgradeInterpreter ();
+    }
+
+    /* Namespace changes since the names were resolved: resolve them again */
+
+    Generation = AcpiGbl_NsPathCacheGeneration;
+    if (Method->NameCount && (Method->Generation != Generation))
+    {
+        AcpiExUpgradeInterpreter ();
+        for (i = 0; i < Method->NameCount; i++)
+        {
+            Status = AcpiPsDecodeLookup (Info->Node, &Method->Names[i]);
+            if (ACPI_FAILURE (Status))
+            {
+                return_ACPI_STATUS (AE_CTRL_PARSE_CONTINUE);
+            }
+        }
+
+        Method->Generation = Generation;
+    }
+
+    Status = AcpiPsRunDecodedMethod (Method, Info->Parameters,
+        &Info->ReturnObject);
+    return_ACPI_STATUS (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDeleteDecodedMethod
+ *
+ * PARAMETERS:  Method          - Decoded method to delete
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Release the buffer constants of a decoded method and free it.
+ *
+ ******************************************************************************/
+
+void
+AcpiPsDeleteDecodedMethod (
+    ACPI_DECODED_METHOD     *Method)
+{
+    UINT32                  i;
+
+
+    for (i = 0; i < Method->BufferCount; i++)
+    {
+        AcpiUtRemoveReference (Method->Buffers[i]);
+    }
+
+    ACPI_FREE (Method);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeMethod
+ *
+ * PARAMETERS:  MethodDesc      - Method object to decode
+ *              MethodNode      - Its namespace node, the scope of its names
+ *
+ * RETURN:      Decoded method, NULL if the method cannot be decoded
+ *
+ * DESCRIPTION: Translate the AML of a method into decoded operations. Any
+ *              opcode other than integer and buffer constants, Locals,
+ *              Args, names of Integers and Buffers, integer arithmetic and
+ *              logic, buffer comparison, Store/Increment/Decrement,
+ *              Create{Byte|Word|DWord|QWord}Field of an Arg, Name of an
+ *              integer constant, If/Else/While/Break/Continue and Return
+ *              makes the method undecodable. So does any operand that the
+ *              interpreter would implicitly convert to another type.
+ *
+ *              Names are resolved here, in the scope of the method, and
+ *              resolved again whenever the namespace changes. A NameSeg
+ *              declared by the method itself must not resolve to anything
+ *              else from that scope, since a reference to it made before
+ *              it is created would otherwise find that instead.
+ *
+ ******************************************************************************/
+
+static ACPI_DECODED_METHOD *
+AcpiPsDecodeMethod (
+    ACPI_OPERAND_OBJECT     *MethodDesc,
+    ACPI_NAMESPACE_NODE     *MethodNode)
+{
+    ACPI_DECODE_STATE       *State;
+    ACPI_DECODED_METHOD     *Method = NULL;
+    ACPI_STATUS             Status;
+    UINT32                  AmlLength = MethodDesc->Method.AmlLength;
+    UINT32                  i;
+
+
+    ACPI_FUNCTION_TRACE_PTR (PsDecodeMethod, MethodDesc);
+
+
+    if (!AmlLength || (AmlLength > ACPI_DECODE_MAX_AML_LENGTH))
+    {
+        return_PTR (NULL);
+    }
+
+    State = ACPI_ALLOCATE_ZEROED (sizeof (ACPI_DECODE_STATE));
+    if (!State)
+    {
+        return_PTR (NULL);
+    }
+
+    /*
+     * Worst case is four operations per AML byte (Increment of a Local as
+     * a statement), and one constant per AML byte.
+     */
+    State->MaxOps = (AmlLength * 4) + 1;
+    State->LoopStart = ACPI_UINT32_MAX;
+    State->MethodNode = MethodNode;
+    State->Generation = AcpiGbl_NsPathCacheGeneration;
+    State->Parser.Aml = MethodDesc->Method.AmlStart;
+    State->Parser.AmlStart = MethodDesc->Method.AmlStart;
+    State->Parser.AmlEnd = MethodDesc->Method.AmlStart + AmlLength;
+
+    /* The other invocations must wait, and nothing may run it lock-free */
+
+    if (MethodDesc->Method.InfoFlags &
+        (ACPI_METHOD_SERIALIZED | ACPI_METHOD_SERIALIZED_PENDING))
+    {
+        State->Flags |= ACPI_DECODED_INTERPRETER;
+    }
+
+    State->Ops = ACPI_ALLOCATE (State->MaxOps * sizeof (ACPI_DECODED_OP));
+    State->Constants = ACPI_ALLOCATE (AmlLength * sizeof (UINT64));
+    if (!State->Ops || !State->Constants)
+    {
+        goto Cleanup;
+    }
+
+    Status = AcpiPsDecodeTermList (State, State->Parser.AmlEnd);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiPsDecodeEmit (State, ACPI_DOP_END, 0, 0, 0, 0);
+    }
+
+    /* An Arg is read as an integer or as a buffer, not both */
+
+    if (ACPI_FAILURE (Status) || (State->ArgMask & State->BufferArgMask))
+    {
+        goto Cleanup;
+    }
+
+    /* Constants first, keeping them and the object pointers aligned */
+
+    Method = ACPI_ALLOCATE (sizeof (ACPI_DECODED_METHOD) +
+        (State->ConstantCount * sizeof (UINT64)) +
+        (State->BufferCount * sizeof (ACPI_OPERAND_OBJECT *)) +
+        (State->NameCount * sizeof (ACPI_DECODED_NAME)) +
+        (State->FieldCount * sizeof (ACPI_DECODED_FIELD)) +
+        (State->OpCount * sizeof (ACPI_DECODED_OP)));
+    if (!Method)
+    {
+        goto Cleanup;
+    }
+
+    Method->Constants = ACPI_CAST_PTR (UINT64, Method + 1);
+    Method->Buffers = ACPI_CAST_PTR (ACPI_OPERAND_OBJECT *,
+        Method->Constants + State->ConstantCount);
+    Method->Names = ACPI_CAST_PTR (ACPI_DECODED_NAME,
+        Method->Buffers + State->BufferCount);
+    Method->Fields = ACPI_CAST_PTR (ACPI_DECODED_FIELD,
+        Method->Names + State->NameCount);
+    Method->Ops = ACPI_CAST_PTR (ACPI_DECODED_OP,
+        Method->Fields + State->FieldCount);
+    Method->OpCount = State->OpCount;
+    Method->Generation = State->Generation;
+    Method->BufferCount = State->BufferCount;
+    Method->NameCount = State->NameCount;
+    Method->ArgMask = State->ArgMask;
+    Method->BufferArgMask = State->BufferArgMask;
+    Method->AnyArgMask = State->AnyArgMask;
+    Method->Flags = State->Flags;
+
+    memcpy (Method->Constants, State->Constants,
+        State->ConstantCount * sizeof (UINT64));
+    memcpy (Method->Buffers, State->Buffers,
+        State->BufferCount * sizeof (ACPI_OPERAND_OBJECT *));
+    memcpy (Method->Names, State->Names,
+        State->NameCount * sizeof (ACPI_DECODED_NAME));
+    memcpy (Method->Fields, State->Fields,
+        State->FieldCount * sizeof (ACPI_DECODED_FIELD));
+    memcpy (Method->Ops, State->Ops,
+        State->OpCount * sizeof (ACPI_DECODED_OP));
+
+    ACPI_DEBUG_PRINT ((ACPI_DB_PARSE,
+        "Decoded method %p: %u AML bytes, %u operations, %u names\n",
+        MethodDesc, AmlLength, State->OpCount, State->NameCount));
+
+Cleanup:
+    if (!Method)
+    {
+        for (i = 0; i < State->BufferCount; i++)
+        {
+            AcpiUtRemoveReference (State->Buffers[i]);
+        }
+    }
+    if (State->Ops)
+    {
+        ACPI_FREE (State->Ops);
+    }
+    if (State->Constants)
+    {
+        ACPI_FREE (State->Constants);
+    }
+
+    ACPI_FREE (State);
+    return_PTR (Method);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeTermList
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              End             - End of the TermList
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode the statements of a TermList.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeTermList (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   *End)
+{
+    ACPI_STATUS             Status;
+
+
+    while (State->Parser.Aml < End)
+    {
+        Status = AcpiPsDecodeStatement (State, End);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+    }
+
+    /* A statement must not run past the end of its package */
+
+    if (State->Parser.Aml != End)
+    {
+        return (AE_AML_PACKAGE_LIMIT);
+    }
+
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeStatement
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              End             - End of the enclosing TermList
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode one statement: a control opcode, a named object, or
+ *              an expression whose value is discarded.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeStatement (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   *End)
+{
+    ACPI_STATUS             Status;
+    UINT8                   *PkgEnd;
+    UINT32                  Branch;
+    UINT32                  OuterLoopStart;
+    UINT32                  OuterBreakChain;
+    UINT32                  Next;
+    UINT8                   Type;
+
+
+    switch (*State->Parser.Aml)
+    {
+    case AML_IF_OP:
+
+        State->Parser.Aml++;
+        PkgEnd = AcpiPsGetNextPackageEnd (&State->Parser);
+        if (PkgEnd > End)
+        {
+            return (AE_AML_PACKAGE_LIMIT);
+        }
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_INTEGER, NULL);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        Branch = State->OpCount;
+        Status = AcpiPsDecodeEmit (State, ACPI_DOP_BRANCH_ZERO, 0, 0, 0, -1);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiPsDecodeTermList (State, PkgEnd);
+        }
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        if ((State->Parser.Aml < End) && (*State->Parser.Aml == AML_ELSE_OP))
+        {
+            State->Parser.Aml++;
+            PkgEnd = AcpiPsGetNextPackageEnd (&State->Parser);
+            if (PkgEnd > End)
+            {
+                return (AE_AML_PACKAGE_LIMIT);
+            }
+
+            /* The If body skips the Else body */
+
+            State->Ops[Branch].Operand = State->OpCount + 1;
+            Branch = State->OpCount;
+            Status = AcpiPsDecodeEmit (State, ACPI_DOP_BRANCH, 0, 0, 0, 0);
+            if (ACPI_SUCCESS (Status))
+            {
+                Status = AcpiPsDecodeTermList (State, PkgEnd);
+            }
+            if (ACPI_FAILURE (Status))
+            {
+                return (Status);
+            }
+        }
+
+        State->Ops[Branch].Operand = State->OpCount;
+        return (AE_OK);
+
+    case AML_WHILE_OP:
+
+        State->Parser.Aml++;
+        PkgEnd = AcpiPsGetNextPackageEnd (&State->Parser);
+        if (PkgEnd > End)
+        {
+            return (AE_AML_PACKAGE_LIMIT);
+        }
+
+        OuterLoopStart = State->LoopStart;
+        OuterBreakChain = State->BreakChain;
+        State->LoopStart = State->OpCount;
+        State->BreakChain = ACPI_UINT32_MAX;
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_INTEGER, NULL);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        Branch = State->OpCount;
+        Status = AcpiPsDecodeEmit (State, ACPI_DOP_BRANCH_ZERO, 0, 0, 0, -1);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiPsDecodeTermList (State, PkgEnd);
+        }
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiPsDecodeEmit (State, ACPI_DOP_LOOP, 0, 0,
+                State->LoopStart, 0);
+        }
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        /* Loop exit, and every Break in the body, continue here */
+
+        State->Ops[Branch].Operand = State->OpCount;
+        while (State->BreakChain != ACPI_UINT32_MAX)
+        {
+            Next = State->Ops[State->BreakChain].Operand;
+            State->Ops[State->BreakChain].Operand = State->OpCount;
+            State->BreakChain = Next;
+        }
+
+        State->LoopStart = OuterLoopStart;
+        State->BreakChain = OuterBreakChain;
+        return (AE_OK);
+
+    case AML_BREAK_OP:
+
+        if (State->LoopStart == ACPI_UINT32_MAX)
+        {
+            return (AE_AML_BAD_OPCODE);
+        }
+
+        State->Parser.Aml++;
+        Branch = State->OpCount;
+        Status = AcpiPsDecodeEmit (State, ACPI_DOP_BRANCH, 0, 0,
+            State->BreakChain, 0);
+        State->BreakChain = Branch;
+        return (Status);
+
+    case AML_CONTINUE_OP:
+
+        if (State->LoopStart == ACPI_UINT32_MAX)
+        {
+            return (AE_AML_BAD_OPCODE);
+        }
+
+        State->Parser.Aml++;
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_LOOP, 0, 0,
+            State->LoopStart, 0));
+
+    case AML_RETURN_OP:
+
+        State->Parser.Aml++;
+        if ((State->Parser.Aml < State->Parser.AmlEnd) &&
+            (*State->Parser.Aml >= AML_ARG0) && (*State->Parser.Aml <= AML_ARG6))
+        {
+            /* An Arg is returned as it is, whatever its type */
+
+            Next = *State->Parser.Aml++ - AML_FIRST_ARG_OP;
+            State->AnyArgMask |= (UINT8) (1 << Next);
+            Status = AcpiPsDecodeEmit (State, ACPI_DOP_ARG_OBJECT,
+                (UINT8) Next, 0, 0, 1);
+            if (ACPI_FAILURE (Status))
+            {
+                return (Status);
+            }
+
+            return (AcpiPsDecodeEmit (State, ACPI_DOP_RETURN_OBJECT,
+                0, 0, 0, -1));
+        }
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_ANY, &Type);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        if (Type == ACPI_TYPE_INTEGER)
+        {
+            return (AcpiPsDecodeEmit (State, ACPI_DOP_RETURN, 0, 0, 0, -1));
+        }
+
+        if (Type != ACPI_TYPE_BUFFER)
+        {
+            return (AE_AML_OPERAND_TYPE);
+        }
+
+        /* A Buffer() term makes a new object on every evaluation */
+
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_RETURN_OBJECT,
+            State->Ops[State->OpCount - 1].Opcode == ACPI_DOP_BUFFER,
+            0, 0, -1));
+
+    case AML_NOOP_OP:
+
+        State->Parser.Aml++;
+        return (AE_OK);
+
+    case AML_CREATE_BYTE_FIELD_OP:
+
+        return (AcpiPsDecodeCreateField (State, 1));
+
+    case AML_CREATE_WORD_FIELD_OP:
+
+        return (AcpiPsDecodeCreateField (State, 2));
+
+    case AML_CREATE_DWORD_FIELD_OP:
+
+        return (AcpiPsDecodeCreateField (State, 4));
+
+    case AML_CREATE_QWORD_FIELD_OP:
+
+        return (AcpiPsDecodeCreateField (State, 8));
+
+    case AML_NAME_OP:
+
+        return (AcpiPsDecodeLocalName (State));
+
+    default:
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_INTEGER, NULL);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_POP, 0, 0, 0, -1));
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeCreateField
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Length          - Field length in bytes
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode Create{Byte|Word|DWord|QWord}Field (ArgN, Index, Name)
+ *              with a constant byte index. The field is created where the
+ *              statement is; if it is executed again (in a While) the
+ *              interpreter fails with AE_ALREADY_EXISTS, so it is not
+ *              decoded there. The same field may be created in several
+ *              places, If and Else for instance.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeCreateField (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Length)
+{
+    ACPI_PARSE_STATE        *Parser = &State->Parser;
+    ACPI_DECODED_FIELD      *Field;
+    ACPI_STATUS             Status;
+    UINT64                  Offset;
+    UINT32                  Name;
+    UINT8                   Arg;
+    UINT8                   i;
+
+
+    if (State->LoopStart != ACPI_UINT32_MAX)
+    {
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    Parser->Aml++;
+    if ((Parser->Aml >= Parser->AmlEnd) ||
+        (*Parser->Aml < AML_ARG0) || (*Parser->Aml > AML_ARG6))
+    {
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    Arg = (UINT8) (*Parser->Aml++ - AML_FIRST_ARG_OP);
+    State->BufferArgMask |= (UINT8) (1 << Arg);
+
+    Status = AcpiPsDecodeConstant (Parser, &Offset);
+    if (ACPI_SUCCESS (Status) && (Offset > ACPI_UINT16_MAX))
+    {
+        Status = AE_NOT_IMPLEMENTED;
+    }
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiPsDecodeNameSeg (State, &Name);
+    }
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    for (i = 0; i < State->LocalNameCount; i++)
+    {
+        if (State->LocalNames[i] == Name)
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+    }
+
+    for (i = 0; i < State->FieldCount; i++)
+    {
+        if (State->FieldNames[i] == Name)
+        {
+            break;
+        }
+    }
+
+    Field = &State->Fields[i];
+    if (i < State->FieldCount)
+    {
+        if ((Field->Arg != Arg) ||
+            (Field->Offset != (UINT32) Offset) ||
+            (Field->Length != Length))
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+    }
+    else
+    {
+        if (State->FieldCount == ACPI_DECODE_MAX_FIELDS)
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+
+        State->FieldNames[i] = Name;
+        Field->Offset = (UINT32) Offset;
+        Field->Arg = Arg;
+        Field->Length = Length;
+        State->FieldCount++;
+    }
+
+    return (AcpiPsDecodeEmit (State, ACPI_DOP_CREATE_FIELD, i, 0, 0, 0));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeLocalName
+ *
+ * PARAMETERS:  State           - Decoder state
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode Name (NameSeg, Integer constant) in the method body,
+ *              as compiled for the temporary of a Switch. The name gets a
+ *              Local slot of its own, valid from where the Name is. As
+ *              with fields, not in a While.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeLocalName (
+    ACPI_DECODE_STATE       *State)
+{
+    ACPI_STATUS             Status;
+    UINT64                  Value;
+    UINT32                  Name;
+    UINT8                   i;
+
+
+    if (State->LoopStart != ACPI_UINT32_MAX)
+    {
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    State->Parser.Aml++;
+    Status = AcpiPsDecodeNameSeg (State, &Name);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiPsDecodeConstant (&State->Parser, &Value);
+    }
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    for (i = 0; i < State->FieldCount; i++)
+    {
+        if (State->FieldNames[i] == Name)
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+    }
+
+    for (i = 0; i < State->LocalNameCount; i++)
+    {
+        if (State->LocalNames[i] == Name)
+        {
+            break;
+        }
+    }
+
+    if (i == State->LocalNameCount)
+    {
+        if (State->LocalNameCount == ACPI_DECODE_MAX_LOCAL_NAMES)
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+
+        State->LocalNames[State->LocalNameCount++] = Name;
+    }
+
+    State->Flags |= ACPI_DECODED_INTERPRETER;
+    State->Constants[State->ConstantCount] = Value;
+    Status = AcpiPsDecodeEmit (State, ACPI_DOP_CONSTANT, 0, 0,
+        State->ConstantCount++, 1);
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiPsDecodeEmit (State, ACPI_DOP_STORE,
+            (UINT8) (ACPI_METHOD_NUM_LOCALS + i), 0, 0, 0);
+    }
+    if (ACPI_SUCCESS (Status))
+    {
+        Status = AcpiPsDecodeEmit (State, ACPI_DOP_POP, 0, 0, 0, -1);
+    }
+
+    return (Status);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeTermArg
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Want            - ACPI_TYPE_INTEGER, ACPI_TYPE_BUFFER, or
+ *                                ACPI_TYPE_ANY for either
+ *              Type            - Where the type of the value is returned
+ *                                (optional)
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode an expression that leaves one value on the operand
+ *              stack. With ACPI_TYPE_ANY, a bare Arg not yet read as either
+ *              type returns ACPI_TYPE_ANY; the caller gives it its type
+ *              with AcpiPsDecodeTypeArg.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeTermArg (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Want,
+    UINT8                   *Type)
+{
+    ACPI_STATUS             Status;
+    UINT8                   ValueType;
+
+
+    Status = AcpiPsDecodeValue (State, Want, &ValueType);
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    /* No implicit conversion */
+
+    if ((Want != ACPI_TYPE_ANY) && (ValueType != Want))
+    {
+        return (AE_AML_OPERAND_TYPE);
+    }
+
+    if (Type)
+    {
+        *Type = ValueType;
+    }
+
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeTypeArg
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              OpIndex         - The ACPI_DOP_ARG of an untyped Arg
+ *              Type            - ACPI_TYPE_INTEGER or ACPI_TYPE_BUFFER
+ *
+ * RETURN:      None
+ *
+ * DESCRIPTION: Give an Arg decoded with ACPI_TYPE_ANY its type.
+ *
+ ******************************************************************************/
+
+static void
+AcpiPsDecodeTypeArg (
+    ACPI_DECODE_STATE       *State,
+    UINT32                  OpIndex,
+    UINT8                   Type)
+{
+    ACPI_DECODED_OP         *Op = &State->Ops[OpIndex];
+
+
+    if (Type == ACPI_TYPE_BUFFER)
+    {
+        State->BufferArgMask |= (UINT8) (1 << Op->Index);
+        Op->Opcode = ACPI_DOP_ARG_OBJECT;
+    }
+    else
+    {
+        State->ArgMask |= (UINT8) (1 << Op->Index);
+    }
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeValue
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Want            - Type the caller needs, ACPI_TYPE_ANY if
+ *                                either will do
+ *              Type            - Where the type of the value is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode one TermArg. Worker for AcpiPsDecodeTermArg.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeValue (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Want,
+    UINT8                   *Type)
+{
+    ACPI_PARSE_STATE        *Parser = &State->Parser;
+    ACPI_DECODED_OP         Target;
+    ACPI_STATUS             Status;
+    UINT64                  Value;
+    UINT16                  Opcode;
+    UINT8                   Index;
+
+
+    if (Parser->Aml >= Parser->AmlEnd)
+    {
+        return (AE_AML_NO_OPERAND);
+    }
+
+    *Type = ACPI_TYPE_INTEGER;
+
+    Status = AcpiPsDecodeConstant (Parser, &Value);
+    if (Status != AE_NOT_IMPLEMENTED)
+    {
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        State->Constants[State->ConstantCount] = Value;
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_CONSTANT, 0, 0,
+            State->ConstantCount++, 1));
+    }
+
+    Opcode = AcpiPsPeekOpcode (Parser);
+    if (AcpiPsIsLeadingChar (Opcode) ||
+        (Opcode == AML_ROOT_PREFIX) ||
+        (Opcode == AML_PARENT_PREFIX) ||
+        (Opcode == AML_DUAL_NAME_PREFIX) ||
+        (Opcode == AML_MULTI_NAME_PREFIX))
+    {
+        Status = AcpiPsDecodeName (State, FALSE, &Target);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        if (Target.Opcode == ACPI_DOP_NAME_OBJECT)
+        {
+            *Type = ACPI_TYPE_BUFFER;
+        }
+
+        return (AcpiPsDecodeEmit (State, Target.Opcode, Target.Index, 0,
+            Target.Operand, 1));
+    }
+
+    Parser->Aml += AcpiPsGetOpcodeSize (Opcode);
+
+    switch (Opcode)
+    {
+    case AML_BUFFER_OP:
+
+        *Type = ACPI_TYPE_BUFFER;
+        return (AcpiPsDecodeBuffer (State));
+
+    case AML_LOCAL0: case AML_LOCAL1: case AML_LOCAL2: case AML_LOCAL3:
+    case AML_LOCAL4: case AML_LOCAL5: case AML_LOCAL6: case AML_LOCAL7:
+
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_LOCAL,
+            (UINT8) (Opcode - AML_FIRST_LOCAL_OP), 0, 0, 1));
+
+    case AML_ARG0: case AML_ARG1: case AML_ARG2: case AML_ARG3:
+    case AML_ARG4: case AML_ARG5: case AML_ARG6:
+
+        Index = (UINT8) (Opcode - AML_FIRST_ARG_OP);
+        if (Want == ACPI_TYPE_ANY)
+        {
+            Want = (State->ArgMask & (1 << Index)) ? ACPI_TYPE_INTEGER :
+                (State->BufferArgMask & (1 << Index)) ? ACPI_TYPE_BUFFER :
+                ACPI_TYPE_ANY;
+        }
+
+        *Type = Want;
+        if (Want == ACPI_TYPE_BUFFER)
+        {
+            State->BufferArgMask |= (UINT8) (1 << Index);
+            return (AcpiPsDecodeEmit (State, ACPI_DOP_ARG_OBJECT,
+                Index, 0, 0, 1));
+        }
+
+        if (Want == ACPI_TYPE_INTEGER)
+        {
+            State->ArgMask |= (UINT8) (1 << Index);
+        }
+
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_ARG, Index, 0, 0, 1));
+
+    case AML_STORE_OP:                  /* Store (Source, Target) */
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_INTEGER, NULL);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiPsDecodeTarget (State, &Target);
+        }
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        if (Target.Opcode == ACPI_DOP_NO_TARGET)
+        {
+            return (AE_AML_OPERAND_TYPE);
+        }
+
+        return (AcpiPsDecodeEmit (State, Target.Opcode, Target.Index, 0,
+            Target.Operand, 0));
+
+    case AML_INCREMENT_OP:              /* Increment (Local) */
+    case AML_DECREMENT_OP:              /* Decrement (Local) */
+
+        Status = AcpiPsDecodeTarget (State, &Target);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        if (Target.Opcode != ACPI_DOP_STORE)
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+
+        return (AcpiPsDecodeEmit (State,
+            (Opcode == AML_INCREMENT_OP) ?
+                ACPI_DOP_INCREMENT : ACPI_DOP_DECREMENT,
+            Target.Index, 0, 0, 1));
+
+    case AML_ADD_OP:                    /* Operator (Operand, Operand, Target) */
+    case AML_SUBTRACT_OP:
+    case AML_MULTIPLY_OP:
+    case AML_SHIFT_LEFT_OP:
+    case AML_SHIFT_RIGHT_OP:
+    case AML_BIT_AND_OP:
+    case AML_BIT_NAND_OP:
+    case AML_BIT_OR_OP:
+    case AML_BIT_NOR_OP:
+    case AML_BIT_XOR_OP:
+    case AML_MOD_OP:
+
+        Status = AcpiPsDecodeOperands (State, 2, Type);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiPsDecodeEmit (State,
+                (Opcode == AML_MOD_OP) ? ACPI_DOP_MOD : ACPI_DOP_MATH,
+                0, Opcode, 0, -1);
+        }
+        break;
+
+    case AML_DIVIDE_OP:                 /* Divide (Dividend, Divisor, Remainder, Quotient) */
+
+        Status = AcpiPsDecodeOperands (State, 2, Type);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiPsDecodeTarget (State, &Target);
+        }
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        if ((Target.Opcode != ACPI_DOP_STORE) &&
+            (Target.Opcode != ACPI_DOP_NO_TARGET))
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+
+        Status = AcpiPsDecodeEmit (State, ACPI_DOP_DIVIDE,
+            (Target.Opcode == ACPI_DOP_STORE) ?
+                Target.Index : ACPI_DOP_NO_LOCAL, 0, 0, -1);
+        break;
+
+    case AML_BIT_NOT_OP:                /* Not (Operand, Target) */
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_INTEGER, NULL);
+        if (ACPI_SUCCESS (Status))
+        {
+            Status = AcpiPsDecodeEmit (State, ACPI_DOP_NOT, 0, 0, 0, 0);
+        }
+        break;
+
+    case AML_TO_INTEGER_OP:             /* ToInteger (Integer, Target) */
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_INTEGER, NULL);
+        break;
+
+    case AML_LOGICAL_NOT_OP:            /* LNot (Operand) */
+
+        Status = AcpiPsDecodeTermArg (State, ACPI_TYPE_INTEGER, NULL);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_LNOT, 0, 0, 0, 0));
+
+    case AML_LOGICAL_AND_OP:            /* Operator (Operand, Operand) */
+    case AML_LOGICAL_OR_OP:
+
+        Status = AcpiPsDecodeOperands (State, 2, Type);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        return (AcpiPsDecodeEmit (State, ACPI_DOP_LOGICAL,
+            0, Opcode, 0, -1));
+
+    case AML_LOGICAL_EQUAL_OP:          /* Operator (Operand, Operand) */
+    case AML_LOGICAL_GREATER_OP:
+    case AML_LOGICAL_LESS_OP:
+
+        /* Two integers or two buffers, as the first operand decides */
+
+        *Type = ACPI_TYPE_ANY;
+        Status = AcpiPsDecodeOperands (State, 2, Type);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        Status = AcpiPsDecodeEmit (State,
+            (*Type == ACPI_TYPE_BUFFER) ? ACPI_DOP_COMPARE : ACPI_DOP_LOGICAL,
+            0, Opcode, 0, -1);
+        *Type = ACPI_TYPE_INTEGER;
+        return (Status);
+
+    default:
+
+        /* Method calls, strings, packages, ... */
+
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    /* Operators with a Target store their result to it as well */
+
+    Status = AcpiPsDecodeTarget (State, &Target);
+    if (ACPI_FAILURE (Status) || (Target.Opcode == ACPI_DOP_NO_TARGET))
+    {
+        return (Status);
+    }
+
+    return (AcpiPsDecodeEmit (State, Target.Opcode, Target.Index, 0,
+        Target.Operand, 0));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeConstant
+ *
+ * PARAMETERS:  Parser          - Current position in the AML
+ *              Value           - Where the value is returned
+ *
+ * RETURN:      Status. AE_NOT_IMPLEMENTED if the AML is not an integer
+ *              constant, in which case the position is unchanged.
+ *
+ * DESCRIPTION: Decode Zero, One, Ones, or a Byte/Word/DWord/QWord constant.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeConstant (
+    ACPI_PARSE_STATE        *Parser,
+    UINT64                  *Value)
+{
+    UINT8                   Size;
+
+
+    if (Parser->Aml >= Parser->AmlEnd)
+    {
+        return (AE_AML_NO_OPERAND);
+    }
+
+    switch (*Parser->Aml)
+    {
+    case AML_ZERO_OP:
+    case AML_ONE_OP:
+    case AML_ONES_OP:
+
+        Size = 0;
+        break;
+
+    case AML_BYTE_OP:
+
+        Size = 1;
+        break;
+
+    case AML_WORD_OP:
+
+        Size = 2;
+        break;
+
+    case AML_DWORD_OP:
+
+        Size = 4;
+        break;
+
+    case AML_QWORD_OP:
+
+        Size = 8;
+        break;
+
+    default:
+
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    if ((Parser->Aml + 1 + Size) > Parser->AmlEnd)
+    {
+        return (AE_AML_NO_OPERAND);
+    }
+
+    *Value = 0;
+    switch (*Parser->Aml++)
+    {
+    case AML_ONE_OP:
+
+        *Value = 1;
+        break;
+
+    case AML_ONES_OP:
+
+        *Value = ACPI_UINT64_MAX;
+        break;
+
+    case AML_BYTE_OP:
+
+        *Value = (UINT64) ACPI_GET8 (Parser->Aml);
+        break;
+
+    case AML_WORD_OP:
+
+        ACPI_MOVE_16_TO_64 (Value, Parser->Aml);
+        break;
+
+    case AML_DWORD_OP:
+
+        ACPI_MOVE_32_TO_64 (Value, Parser->Aml);
+        break;
+
+    case AML_QWORD_OP:
+
+        ACPI_MOVE_64_TO_64 (Value, Parser->Aml);
+        break;
+
+    default:
+        break;
+    }
+
+    Parser->Aml += Size;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeBuffer
+ *
+ * PARAMETERS:  State           - Decoder state, positioned after the
+ *                                Buffer opcode
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode Buffer (Size) {ByteList} with a constant size, which
+ *              includes ToUUID, into a buffer object kept with the method.
+ *              As in AcpiDsBuildInternalBufferObj, the buffer is as long as
+ *              the larger of the size and the initializer.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeBuffer (
+    ACPI_DECODE_STATE       *State)
+{
+    ACPI_PARSE_STATE        *Parser = &State->Parser;
+    ACPI_OPERAND_OBJECT     *ObjDesc;
+    ACPI_STATUS             Status;
+    UINT8                   *PkgEnd;
+    UINT64                  Size;
+    UINT32                  Length;
+
+
+    PkgEnd = AcpiPsGetNextPackageEnd (Parser);
+    if (PkgEnd > Parser->AmlEnd)
+    {
+        return (AE_AML_PACKAGE_LIMIT);
+    }
+
+    Status = AcpiPsDecodeConstant (Parser, &Size);
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    if ((Parser->Aml > PkgEnd) ||
+        (Size > ACPI_DECODE_MAX_AML_LENGTH) ||
+        (State->BufferCount == ACPI_DECODE_MAX_BUFFERS))
+    {
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    Length = (UINT32) ACPI_PTR_DIFF (PkgEnd, Parser->Aml);
+    ObjDesc = AcpiUtCreateBufferObject (
+        (Size > Length) ? (ACPI_SIZE) Size : Length);
+    if (!ObjDesc)
+    {
+        return (AE_NO_MEMORY);
+    }
+
+    memcpy (ObjDesc->Buffer.Pointer, Parser->Aml, Length);
+    Parser->Aml = PkgEnd;
+
+    State->Buffers[State->BufferCount] = ObjDesc;
+    return (AcpiPsDecodeEmit (State, ACPI_DOP_BUFFER, 0, 0,
+        State->BufferCount++, 1));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeOperands
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Count           - Number of TermArg operands, at most two
+ *              Type            - In: type of the operands, ACPI_TYPE_ANY if
+ *                                the first one decides. Out: their type.
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode the TermArg operands of an operator. The interpreter
+ *              resolves an operand that is just a Local, a name or a field
+ *              when the operator executes, after all operands have been
+ *              evaluated, whereas the decoded form reads it in order.
+ *              Operators where a later operand writes such a reference are
+ *              therefore not decoded.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeOperands (
+    ACPI_DECODE_STATE       *State,
+    UINT32                  Count,
+    UINT8                   *Type)
+{
+    ACPI_STATUS             Status;
+    UINT32                  OuterWrites = State->Writes;
+    UINT32                  Reads = 0;
+    UINT32                  Untyped[2];
+    UINT32                  UntypedCount = 0;
+    UINT32                  First;
+    UINT32                  i;
+    UINT8                   Want = *Type;
+    UINT8                   OperandType;
+
+
+    for (i = 0; i < Count; i++)
+    {
+        First = State->OpCount;
+        State->Writes = 0;
+        Status = AcpiPsDecodeTermArg (State, Want, &OperandType);
+        if (ACPI_FAILURE (Status))
+        {
+            return (Status);
+        }
+
+        if (State->Writes & Reads)
+        {
+            return (AE_NOT_IMPLEMENTED);
+        }
+
+        if (State->OpCount == First + 1)
+        {
+            switch (State->Ops[First].Opcode)
+            {
+            case ACPI_DOP_LOCAL:
+
+                Reads |= (1 << State->Ops[First].Index);
+                break;
+
+            case ACPI_DOP_FIELD:
+            case ACPI_DOP_ARG_OBJECT:
+
+                Reads |= ACPI_DECODE_FIELD_ACCESS;
+                break;
+
+            case ACPI_DOP_NAME:
+            case ACPI_DOP_NAME_OBJECT:
+
+                Reads |= ACPI_DECODE_NAME_ACCESS;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        OuterWrites |= State->Writes;
+
+        if (OperandType == ACPI_TYPE_ANY)
+        {
+            Untyped[UntypedCount++] = First;
+        }
+        else
+        {
+            Want = OperandType;
+        }
+    }
+
+    if (Want == ACPI_TYPE_ANY)
+    {
+        Want = ACPI_TYPE_INTEGER;
+    }
+
+    for (i = 0; i < UntypedCount; i++)
+    {
+        AcpiPsDecodeTypeArg (State, Untyped[i], Want);
+    }
+
+    State->Writes = OuterWrites;
+    *Type = Want;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeTarget
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Target          - Where the store operation is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode a Target or SuperName operand: a Local, a method-
+ *              local Name or buffer field, a named Integer, or the null
+ *              target. Returns the operation that stores to it, or
+ *              ACPI_DOP_NO_TARGET.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeTarget (
+    ACPI_DECODE_STATE       *State,
+    ACPI_DECODED_OP         *Target)
+{
+    UINT8                   Opcode;
+
+
+    if (State->Parser.Aml >= State->Parser.AmlEnd)
+    {
+        return (AE_AML_NO_OPERAND);
+    }
+
+    Opcode = *State->Parser.Aml;
+    if (AcpiPsIsLeadingChar (Opcode) ||
+        (Opcode == AML_ROOT_PREFIX) ||
+        (Opcode == AML_PARENT_PREFIX) ||
+        (Opcode == AML_DUAL_NAME_PREFIX) ||
+        (Opcode == AML_MULTI_NAME_PREFIX))
+    {
+        return (AcpiPsDecodeName (State, TRUE, Target));
+    }
+
+    State->Parser.Aml++;
+    Target->Index = 0;
+    Target->Operand = 0;
+
+    if (Opcode == AML_ZERO_OP)
+    {
+        Target->Opcode = ACPI_DOP_NO_TARGET;
+        return (AE_OK);
+    }
+
+    if ((Opcode >= AML_LOCAL0) && (Opcode <= AML_LOCAL7))
+    {
+        Target->Opcode = ACPI_DOP_STORE;
+        Target->Index = (UINT8) (Opcode - AML_FIRST_LOCAL_OP);
+        return (AE_OK);
+    }
+
+    return (AE_NOT_IMPLEMENTED);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeName
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Write           - TRUE for a Target, FALSE for an operand
+ *              Ref             - Where the operation is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode a NameString. A NameSeg the method declares is its
+ *              Local slot or buffer field; anything else must resolve to a
+ *              named Integer, or for reading to a named Buffer.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeName (
+    ACPI_DECODE_STATE       *State,
+    BOOLEAN                 Write,
+    ACPI_DECODED_OP         *Ref)
+{
+    ACPI_STATUS             Status;
+    UINT8                   *Path;
+    UINT32                  Length;
+    UINT32                  Name;
+    UINT8                   Index;
+    UINT8                   i;
+
+
+    Path = State->Parser.Aml;
+    (void) AcpiPsGetNextNamestring (&State->Parser);
+    if (State->Parser.Aml > State->Parser.AmlEnd)
+    {
+        return (AE_AML_NO_OPERAND);
+    }
+
+    Length = (UINT32) ACPI_PTR_DIFF (State->Parser.Aml, Path);
+    Ref->Index = 0;
+    Ref->Operand = 0;
+
+    if (Length == ACPI_NAMESEG_SIZE)
+    {
+        ACPI_MOVE_32_TO_32 (&Name, Path);
+        for (i = 0; i < State->LocalNameCount; i++)
+        {
+            if (State->LocalNames[i] == Name)
+            {
+                Ref->Opcode = Write ? ACPI_DOP_STORE : ACPI_DOP_LOCAL;
+                Ref->Index = (UINT8) (ACPI_METHOD_NUM_LOCALS + i);
+                return (AE_OK);
+            }
+        }
+
+        for (i = 0; i < State->FieldCount; i++)
+        {
+            if (State->FieldNames[i] == Name)
+            {
+                Ref->Opcode = Write ? ACPI_DOP_STORE_FIELD : ACPI_DOP_FIELD;
+                Ref->Index = i;
+                return (AE_OK);
+            }
+        }
+    }
+
+    Status = AcpiPsDecodeAddName (State, Path, Length, FALSE, &Index);
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    Ref->Operand = Index;
+    if (State->Names[Index].Type == ACPI_TYPE_INTEGER)
+    {
+        Ref->Opcode = Write ? ACPI_DOP_STORE_NAME : ACPI_DOP_NAME;
+        return (AE_OK);
+    }
+
+    if (Write)
+    {
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    Ref->Opcode = ACPI_DOP_NAME_OBJECT;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeNameSeg
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Name            - Where the NameSeg is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Decode the NameSeg of a named object the method creates.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeNameSeg (
+    ACPI_DECODE_STATE       *State,
+    UINT32                  *Name)
+{
+    UINT8                   *Path = State->Parser.Aml;
+    UINT8                   Index;
+
+
+    if (((Path + ACPI_NAMESEG_SIZE) > State->Parser.AmlEnd) ||
+        !AcpiPsIsLeadingChar (*Path))
+    {
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    ACPI_MOVE_32_TO_32 (Name, Path);
+    State->Parser.Aml += ACPI_NAMESEG_SIZE;
+    State->Flags |= ACPI_DECODED_INTERPRETER;
+
+    return (AcpiPsDecodeAddName (State, Path, ACPI_NAMESEG_SIZE,
+        TRUE, &Index));
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeAddName
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Path            - NameString in the method AML
+ *              Length          - Its length
+ *              Shadow          - TRUE for a name the method creates, which
+ *                                must not resolve from the method's scope
+ *              Index           - Where the index in Names is returned
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Find or add a name reference of the method, resolving it.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeAddName (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   *Path,
+    UINT32                  Length,
+    BOOLEAN                 Shadow,
+    UINT8                   *Index)
+{
+    ACPI_DECODED_NAME       *Name;
+    ACPI_STATUS             Status;
+    UINT8                   i;
+
+
+    for (i = 0; i < State->NameCount; i++)
+    {
+        if ((State->NameLengths[i] == Length) &&
+            !memcmp (State->Names[i].Path, Path, Length))
+        {
+            *Index = i;
+            return (AE_OK);
+        }
+    }
+
+    if (State->NameCount == ACPI_DECODE_MAX_NAMES)
+    {
+        return (AE_NOT_IMPLEMENTED);
+    }
+
+    /* The type is that of the object now, and must stay so */
+
+    Name = &State->Names[i];
+    Name->Path = Path;
+    Name->Node = NULL;
+    Name->Type = ACPI_TYPE_ANY;
+    Name->Shadow = Shadow;
+
+    Status = AcpiPsDecodeLookup (State->MethodNode, Name);
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    State->NameLengths[i] = Length;
+    State->Flags |= ACPI_DECODED_INTERPRETER;
+    *Index = State->NameCount++;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeLookup
+ *
+ * PARAMETERS:  MethodNode      - Method node, the scope of the name
+ *              Name            - Name reference to resolve
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Resolve a name reference of a decoded method as the
+ *              interpreter would when executing the method. The object
+ *              must be an Integer or a Buffer, and still of the type it
+ *              was first resolved to; the name of a method-local object
+ *              must still not resolve. Temporary nodes belong to an
+ *              invocation in progress and are not used.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeLookup (
+    ACPI_NAMESPACE_NODE     *MethodNode,
+    ACPI_DECODED_NAME       *Name)
+{
+    ACPI_GENERIC_STATE      ScopeInfo;
+    ACPI_NAMESPACE_NODE     *Node = NULL;
+    ACPI_OPERAND_OBJECT     *ObjDesc;
+    ACPI_STATUS             Status;
+
+
+    ScopeInfo.Scope.Node = MethodNode;
+    Status = AcpiNsLookup (&ScopeInfo, (char *) Name->Path, ACPI_TYPE_ANY,
+        ACPI_IMODE_EXECUTE, ACPI_NS_SEARCH_PARENT | ACPI_NS_DONT_OPEN_SCOPE,
+        NULL, &Node);
+
+    if (Name->Shadow)
+    {
+        return ((Status == AE_NOT_FOUND) ? AE_OK : AE_ALREADY_EXISTS);
+    }
+
+    if (ACPI_FAILURE (Status))
+    {
+        return (Status);
+    }
+
+    if (Node->Flags & ANOBJ_TEMPORARY)
+    {
+        return (AE_NOT_EXIST);
+    }
+
+    ObjDesc = AcpiNsGetAttachedObject (Node);
+    if (!ObjDesc ||
+        ((ObjDesc->Common.Type != ACPI_TYPE_INTEGER) &&
+         (ObjDesc->Common.Type != ACPI_TYPE_BUFFER)) ||
+        ((Name->Type != ACPI_TYPE_ANY) &&
+         (ObjDesc->Common.Type != Name->Type)))
+    {
+        return (AE_AML_OPERAND_TYPE);
+    }
+
+    Name->Type = ObjDesc->Common.Type;
+    Name->Node = Node;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsDecodeEmit
+ *
+ * PARAMETERS:  State           - Decoder state
+ *              Opcode          - ACPI_DOP_* operation
+ *              Index           - Local, Arg or field number
+ *              AmlOpcode       - Operator for math and logical operations
+ *              Operand         - Branch target, constant, buffer or name
+ *                                index
+ *              StackChange     - Effect of the operation on stack depth
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Append one operation, tracking the operand stack depth and
+ *              what the method reads and writes.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsDecodeEmit (
+    ACPI_DECODE_STATE       *State,
+    UINT8                   Opcode,
+    UINT8                   Index,
+    UINT16                  AmlOpcode,
+    UINT32                  Operand,
+    INT32                   StackChange)
+{
+    ACPI_DECODED_OP         *Op;
+
+
+    if (State->OpCount >= State->MaxOps)
+    {
+        return (AE_AML_INTERNAL);
+    }
+
+    State->Depth += StackChange;
+    if (State->Depth > ACPI_DECODE_STACK_DEPTH)
+    {
+        return (AE_AML_OPERAND_VALUE);
+    }
+
+    switch (Opcode)
+    {
+    case ACPI_DOP_DIVIDE:
+
+        if (Index == ACPI_DOP_NO_LOCAL)
+        {
+            break;
+        }
+
+        ACPI_FALLTHROUGH;
+
+    case ACPI_DOP_STORE:
+    case ACPI_DOP_INCREMENT:
+    case ACPI_DOP_DECREMENT:
+
+        State->Writes |= (1 << Index);
+        break;
+
+    case ACPI_DOP_STORE_FIELD:
+
+        State->Writes |= ACPI_DECODE_FIELD_ACCESS;
+        State->Flags |= ACPI_DECODED_WRITES;
+        break;
+
+    case ACPI_DOP_STORE_NAME:
+
+        State->Writes |= ACPI_DECODE_NAME_ACCESS;
+        State->Flags |= ACPI_DECODED_WRITES;
+        break;
+
+    default:
+        break;
+    }
+
+    Op = &State->Ops[State->OpCount++];
+    Op->Opcode = Opcode;
+    Op->Index = Index;
+    Op->AmlOpcode = AmlOpcode;
+    Op->Operand = Operand;
+    return (AE_OK);
+}
+
+
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiPsRunDecodedMethod
+ *
+ * PARAMETERS:  Method          - Decoded method
+ *              Parameters      - Method arguments (validated)
+ *              ReturnObject    - Where the returned object is stored
+ *
+ * RETURN:      AE_OK if the method ended, with or without Return;
+ *              AE_CTRL_PARSE_CONTINUE if the interpreter must run it
+ *              instead; the AML error if the method failed after it
+ *              changed a buffer field or a named object.
+ *
+ * DESCRIPTION: Execute the decoded operations of a method.
+ *
+ ******************************************************************************/
+
+static ACPI_STATUS
+AcpiPsRunDecodedMethod (
+    ACPI_DECODED_METHOD     *Method,
+    ACPI_OPERAND_OBJECT     **Parameters,
+    ACPI_OPERAND_OBJECT     **ReturnObject)
+{
+    ACPI_DECODE_VALUE       Stack[ACPI_DECODE_STACK_DEPTH];
+    UINT64                  Locals[ACPI_DECODE_SLOTS];
+    ACPI_DECODED_OP         *Op;
+    ACPI_DECODED_FIELD      *Field;
+    ACPI_OPERAND_OBJECT     *ObjDesc;
+    ACPI_STATUS             Status;
+    UINT64                  LoopTimeout = 0;
+    UINT64                  Value;
+    UINT32                  LoopCount = 0;
+    UINT32                  Sp = 0;
+    UINT32                  Pc = 0;
+    UINT32                  i;
+    UINT16                  LocalValid = 0;
+    UINT8                   FieldValid = 0;
+    UINT8                   *Data;
+    BOOLEAN                 Changed = FALSE;
+    BOOLEAN                 Result;
+
+
+    for (;;)
+    {
+        Op = &Method->Ops[Pc++];
+        switch (Op->Opcode)
+        {
+        case ACPI_DOP_CONSTANT:
+
+            Stack[Sp++].Integer = Method->Constants[Op->Operand];
+            break;
+
+        case ACPI_DOP_LOCAL:
+
+            if (!(LocalValid & (1 << Op->Index)))
+            {
+                Status = (Op->Index < ACPI_METHOD_NUM_LOCALS) ?
+                    AE_AML_UNINITIALIZED_LOCAL : AE_NOT_FOUND;
+                goto Error;
+            }
+
+            Stack[Sp++].Integer = Locals[Op->Index];
+            break;
+
+        case ACPI_DOP_ARG:
+
+            Stack[Sp++].Integer = Parameters[Op->Index]->Integer.Value;
+            break;
+
+        case ACPI_DOP_ARG_OBJECT:
+
+            Stack[Sp++].Object = Parameters[Op->Index];
+            break;
+
+        case ACPI_DOP_BUFFER:
+
+            Stack[Sp++].Object = Method->Buffers[Op->Operand];
+            break;
+
+        case ACPI_DOP_STORE:
+
+            Locals[Op->Index] = Stack[Sp - 1].Integer;
+            LocalValid |= (UINT16) (1 << Op->Index);
+            break;
+
+        case ACPI_DOP_CREATE_FIELD:
+
+            Field = &Method->Fields[Op->Index];
+            if ((Field->Offset + Field->Length) >
+                Parameters[Field->Arg]->Buffer.Length)
+            {
+                Status = AE_AML_BUFFER_LIMIT;
+                goto Error;
+            }
+
+            FieldValid |= (UINT8) (1 << Op->Index);
+            break;
+
+        case ACPI_DOP_FIELD:
+        case ACPI_DOP_STORE_FIELD:
+
+            if (!(FieldValid & (1 << Op->Index)))
+            {
+                Status = AE_NOT_FOUND;
+                goto Error;
+            }
+
+            /* Little-endian, as AML is; stores truncate to the field */
+
+            Field = &Method->Fields[Op->Index];
+            Data = Parameters[Field->Arg]->Buffer.Pointer + Field->Offset;
+            if (Op->Opcode == ACPI_DOP_FIELD)
+            {
+                Value = 0;
+                for (i = Field->Length; i; i--)
+                {
+                    Value = (Value << 8) | Data[i - 1];
+                }
+
+                Stack[Sp++].Integer = Value;
+                break;
+            }
+
+            Value = Stack[Sp - 1].Integer;
+            for (i = 0; i < Field->Length; i++)
+            {
+                Data[i] = (UINT8) (Value >> (i * 8));
+            }
+
+            Changed = TRUE;
+            break;
+
+        case ACPI_DOP_NAME:
+        case ACPI_DOP_NAME_OBJECT:
+        case ACPI_DOP_STORE_NAME:
+
+            /* Reached by CopyObject, a name may hold another type now */
+
+            ObjDesc = AcpiNsGetAttachedObject (Method->Names[Op->Operand].Node);
+            if (!ObjDesc ||
+                (ObjDesc->Common.Type != Method->Names[Op->Operand].Type))
+            {
+                Status = AE_AML_OPERAND_TYPE;
+                goto Error;
+            }
+
+            if (Op->Opcode == ACPI_DOP_NAME)
+            {
+                Stack[Sp++].Integer = ObjDesc->Integer.Value;
+            }
+            else if (Op->Opcode == ACPI_DOP_NAME_OBJECT)
+            {
+                Stack[Sp++].Object = ObjDesc;
+            }
+            else
+            {
+                ObjDesc->Integer.Value = Stack[Sp - 1].Integer;
+                Changed = TRUE;
+            }
+            break;
+
+        case ACPI_DOP_POP:
+
+            Sp--;
+            break;
+
+        case ACPI_DOP_MATH:
+
+            Sp--;
+            Stack[Sp - 1].Integer = AcpiExDoMathOp (Op->AmlOpcode,
+                Stack[Sp - 1].Integer, Stack[Sp].Integer);
+            break;
+
+        case ACPI_DOP_DIVIDE:
+        case ACPI_DOP_MOD:
+
+            Sp--;
+            if (!Stack[Sp].Integer)
+            {
+                Status = AE_AML_DIVIDE_BY_ZERO;
+                goto Error;
+            }
+
+            if ((Op->Opcode == ACPI_DOP_DIVIDE) &&
+                (Op->Index != ACPI_DOP_NO_LOCAL))
+            {
+                Locals[Op->Index] =
+                    Stack[Sp - 1].Integer % Stack[Sp].Integer;
+                LocalValid |= (UINT16) (1 << Op->Index);
+            }
+
+            Stack[Sp - 1].Integer = (Op->Opcode == ACPI_DOP_DIVIDE) ?
+                Stack[Sp - 1].Integer / Stack[Sp].Integer :
+                Stack[Sp - 1].Integer % Stack[Sp].Integer;
+            break;
+
+        case ACPI_DOP_NOT:
+
+            Stack[Sp - 1].Integer = ~Stack[Sp - 1].Integer;
+            break;
+
+        case ACPI_DOP_LOGICAL:
+
+            Sp--;
+            switch (Op->AmlOpcode)
+            {
+            case AML_LOGICAL_EQUAL_OP:
+
+                Result = (Stack[Sp - 1].Integer == Stack[Sp].Integer);
+                break;
+
+            case AML_LOGICAL_GREATER_OP:
+
+                Result = (Stack[Sp - 1].Integer > Stack[Sp].Integer);
+                break;
+
+            case AML_LOGICAL_LESS_OP:
+
+                Result = (Stack[Sp - 1].Integer < Stack[Sp].Integer);
+                break;
+
+            default:                    /* LAnd, LOr */
+
+                (void) AcpiExDoLogicalNumericOp (Op->AmlOpcode,
+                    Stack[Sp - 1].Integer, Stack[Sp].Integer, &Result);
+                break;
+            }
+
+            Stack[Sp - 1].Integer = Result ? ACPI_UINT64_MAX : 0;
+            break;
+
+        case ACPI_DOP_COMPARE:
+
+            /* Two buffers: no conversion, so nothing is allocated */
+
+            Sp--;
+            Status = AcpiExDoLogicalOp (Op->AmlOpcode,
+                Stack[Sp - 1].Object, Stack[Sp].Object, &Result);
+            if (ACPI_FAILURE (Status))
+            {
+                goto Error;
+            }
+
+            Stack[Sp - 1].Integer = Result ? ACPI_UINT64_MAX : 0;
+            break;
+
+        case ACPI_DOP_LNOT:
+
+            Stack[Sp - 1].Integer = Stack[Sp - 1].Integer ? 0 : ACPI_UINT64_MAX;
+            break;
+
+        case ACPI_DOP_INCREMENT:
+        case ACPI_DOP_DECREMENT:
+
+            if (!(LocalValid & (1 << Op->Index)))
+            {
+                Status = (Op->Index < ACPI_METHOD_NUM_LOCALS) ?
+                    AE_AML_UNINITIALIZED_LOCAL : AE_NOT_FOUND;
+                goto Error;
+            }
+
+            if (Op->Opcode == ACPI_DOP_INCREMENT)
+            {
+                Locals[Op->Index]++;
+            }
+            else
+            {
+                Locals[Op->Index]--;
+            }
+
+            Stack[Sp++].Integer = Locals[Op->Index];
+            break;
+
+        case ACPI_DOP_BRANCH_ZERO:
+
+            if (Stack[--Sp].Integer)
+            {
+                break;
+            }
+
+            Pc = Op->Operand;
+            break;
+
+        case ACPI_DOP_BRANCH:
+
+            Pc = Op->Operand;
+            break;
+
+        case ACPI_DOP_LOOP:
+
+            /*
+             * Same limit as the interpreter's infinite loop detection
+             * (AcpiDsExecEndControlOp), measured from the first loop
+             * iteration of this invocation. The interpreter then runs the
+             * method again and reports the timeout itself.
+             */
+            if (!LoopTimeout)
+            {
+                LoopTimeout = AcpiOsGetTimer () +
+                    ((UINT64) AcpiGbl_MaxLoopIterations * ACPI_100NSEC_PER_SEC);
+            }
+            else if (!(++LoopCount & ACPI_DECODE_LOOP_CHECK) &&
+                ACPI_TIME_AFTER (AcpiOsGetTimer (), LoopTimeout))
+            {
+                Status = AE_AML_LOOP_TIMEOUT;
+                goto Error;
+            }
+
+            Pc = Op->Operand;
+            break;
+
+        case ACPI_DOP_RETURN:
+
+            *ReturnObject = AcpiUtCreateIntegerObject (Stack[--Sp].Integer);
+            return (*ReturnObject ? AE_OK : AE_NO_MEMORY);
+
+        case ACPI_DOP_RETURN_OBJECT:
+
+            ObjDesc = Stack[--Sp].Object;
+            if (!Op->Index)
+            {
+                AcpiUtAddReference (ObjDesc);
+                *ReturnObject = ObjDesc;
+                return (AE_OK);
+            }
+
+            *ReturnObject = AcpiUtCreateBufferObject (ObjDesc->Buffer.Length);
+            if (!*ReturnObject)
+            {
+                return (AE_NO_MEMORY);
+            }
+
+            memcpy ((*ReturnObject)->Buffer.Pointer, ObjDesc->Buffer.Pointer,
+                ObjDesc->Buffer.Length);
+            return (AE_OK);
+
+        case ACPI_DOP_END:
+        default:
+
+            /* The implicit return value is left to the interpreter */
+
+            if (AcpiGbl_EnableInterpreterSlack)
+            {
+                return (AE_CTRL_PARSE_CONTINUE);
+            }
+
+            return (AE_OK);
+        }
+    }
+
+Error:
+    /* Nothing changed yet: the interpreter runs it and reports the error */
+
+    if (!Changed)
+    {
+        return (AE_CTRL_PARSE_CONTINUE);
+    }
+
+    ACPI_EXCEPTION ((AE_INFO, Status,
+        "Pre-decoded method failed after changing an object"));
+    return (Status);
+}
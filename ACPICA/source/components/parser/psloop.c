@@ -484,7 +484,7 @@ AcpiPsParseLoop (
                     return_ACPI_STATUS (Status);
                 }
                 if (AcpiNsOpensScope (
-                    AcpiPsGetOpcodeInfo (WalkState->Opcode)->ObjectType))
+                    ACPI_GET_OPCODE_INFO (WalkState->Opcode)->ObjectType))
                 {
                     /*
                      * If the scope/device op fails to parse, skip the body of
@@ -613,7 +613,7 @@ AcpiPsParseLoop (
          * All arguments have been processed -- Op is complete,
          * prepare for next
          */
-        WalkState->OpInfo = AcpiPsGetOpcodeInfo (Op->Common.AmlOpcode);
+        WalkState->OpInfo = ACPI_GET_OPCODE_INFO (Op->Common.AmlOpcode);
         if (WalkState->OpInfo->Flags & AML_NAMED)
         {
             if (Op->Common.AmlOpcode == AML_REGION_OP ||
@@ -198,7 +198,7 @@ AcpiPsGetAmlOpcode (
      * 2) A name string
      * 3) An unknown/invalid opcode
      */
-    WalkState->OpInfo = AcpiPsGetOpcodeInfo (WalkState->Opcode);
+    WalkState->OpInfo = ACPI_GET_OPCODE_INFO (WalkState->Opcode);
 
     switch (WalkState->OpInfo->Class)
     {
@@ -477,7 +477,7 @@ AcpiPsCreateOp (
 
     /* Create Op structure and append to parent's argument list */
 
-    WalkState->OpInfo = AcpiPsGetOpcodeInfo (WalkState->Opcode);
+    WalkState->OpInfo = ACPI_GET_OPCODE_INFO (WalkState->Opcode);
     Op = AcpiPsAllocOp (WalkState->Opcode, AmlOpStart);
     if (!Op)
     {
@@ -544,7 +544,7 @@ AcpiPsCreateOp (
 
     if (ParentScope)
     {
-        OpInfo = AcpiPsGetOpcodeInfo (ParentScope->Common.AmlOpcode);
+        OpInfo = ACPI_GET_OPCODE_INFO (ParentScope->Common.AmlOpcode);
         if (OpInfo->Flags & AML_HAS_TARGET)
         {
             ArgumentCount = AcpiPsGetArgumentCount (OpInfo->Type);
@@ -648,7 +648,7 @@ AcpiPsCompleteOp (
         if (*Op)
         {
             WalkState->Op = *Op;
-            WalkState->OpInfo = AcpiPsGetOpcodeInfo ((*Op)->Common.AmlOpcode);
+            WalkState->OpInfo = ACPI_GET_OPCODE_INFO ((*Op)->Common.AmlOpcode);
             WalkState->Opcode = (*Op)->Common.AmlOpcode;
 
             Status = WalkState->AscendingCallback (WalkState);
@@ -677,7 +677,7 @@ AcpiPsCompleteOp (
         /* Close this iteration of the While loop */
 
         WalkState->Op = *Op;
-        WalkState->OpInfo = AcpiPsGetOpcodeInfo ((*Op)->Common.AmlOpcode);
+        WalkState->OpInfo = ACPI_GET_OPCODE_INFO ((*Op)->Common.AmlOpcode);
         WalkState->Opcode = (*Op)->Common.AmlOpcode;
 
         Status = WalkState->AscendingCallback (WalkState);
@@ -836,7 +836,7 @@ AcpiPsCompleteFinalOp (
             if (Ascending && WalkState->AscendingCallback != NULL)
             {
                 WalkState->Op = Op;
-                WalkState->OpInfo = AcpiPsGetOpcodeInfo (Op->Common.AmlOpcode);
+                WalkState->OpInfo = ACPI_GET_OPCODE_INFO (Op->Common.AmlOpcode);
                 WalkState->Opcode = Op->Common.AmlOpcode;
 
                 Status = WalkState->AscendingCallback (WalkState);
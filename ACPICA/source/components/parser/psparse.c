@@ -296,7 +296,7 @@ AcpiPsCompleteThisOp (
          * Check if we need to replace the operator and its subtree
          * with a return value op (placeholder op)
          */
-        ParentInfo = AcpiPsGetOpcodeInfo (Op->Common.Parent->Common.AmlOpcode);
+        ParentInfo = ACPI_GET_OPCODE_INFO (Op->Common.Parent->Common.AmlOpcode);
 
         switch (ParentInfo->Class)
         {
@@ -565,6 +565,7 @@ AcpiPsParseAml (
     ACPI_THREAD_STATE       *Thread;
     ACPI_THREAD_STATE       *PrevWalkList = AcpiGbl_CurrentWalkList;
     ACPI_WALK_STATE         *PreviousWalkState;
+    BOOLEAN                 Shared;
 
 
     ACPI_FUNCTION_TRACE (PsParseAml);
@@ -611,9 +612,13 @@ AcpiPsParseAml (
 
     /*
      * This global allows the AML debugger to get a handle to the currently
-     * executing control method.
+     * executing control method. Parallel methods leave it alone.
      */
-    AcpiGbl_CurrentWalkList = Thread;
+    Shared = AcpiExInterpreterIsShared ();
+    if (!Shared)
+    {
+        AcpiGbl_CurrentWalkList = Thread;
+    }
 
     /*
      * Execute the walk loop as long as there is a valid Walk State. This
@@ -838,6 +843,9 @@ AcpiPsParseAml (
 
     AcpiExReleaseAllMutexes (Thread);
     AcpiUtDeleteGenericState (ACPI_CAST_PTR (ACPI_GENERIC_STATE, Thread));
-    AcpiGbl_CurrentWalkList = PrevWalkList;
+    if (!Shared)
+    {
+        AcpiGbl_CurrentWalkList = PrevWalkList;
+    }
     return_ACPI_STATUS (Status);
 }
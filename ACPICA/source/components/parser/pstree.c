@@ -199,7 +199,7 @@ AcpiPsGetArg (
 */
     /* Get the info structure for this opcode */
 
-    OpInfo = AcpiPsGetOpcodeInfo (Op->Common.AmlOpcode);
+    OpInfo = ACPI_GET_OPCODE_INFO (Op->Common.AmlOpcode);
     if (OpInfo->Class == AML_CLASS_UNKNOWN)
     {
         /* Invalid opcode or ASCII character */
@@ -261,7 +261,7 @@ AcpiPsAppendArg (
 
     /* Get the info structure for this opcode */
 
-    OpInfo = AcpiPsGetOpcodeInfo (Op->Common.AmlOpcode);
+    OpInfo = ACPI_GET_OPCODE_INFO (Op->Common.AmlOpcode);
     if (OpInfo->Class == AML_CLASS_UNKNOWN)
     {
         /* Invalid opcode */
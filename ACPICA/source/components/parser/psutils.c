@@ -247,7 +247,7 @@ AcpiPsAllocOp (
     ACPI_FUNCTION_ENTRY ();
 
 
-    OpInfo = AcpiPsGetOpcodeInfo (Opcode);
+    OpInfo = ACPI_GET_OPCODE_INFO (Opcode);
 
     /* Determine type of ParseOp required */
 
@@ -258,6 +258,19 @@ AcpiPsExecuteMethod (
         return_ACPI_STATUS (AE_NULL_ENTRY);
     }
 
+    /* Simple methods run from their pre-decoded form if possible */
+
+    Status = AcpiPsExecuteDecodedMethod (Info);
+    if (Status != AE_CTRL_PARSE_CONTINUE)
+    {
+        if (ACPI_SUCCESS (Status) && Info->ReturnObject)
+        {
+            Status = AE_CTRL_RETURN_VALUE;
+        }
+
+        return_ACPI_STATUS (Status);
+    }
+
     /* Init for new method, wait on concurrency semaphore */
 
     Status = AcpiDsBeginMethodExecution (Info->Node, Info->ObjDesc, NULL);
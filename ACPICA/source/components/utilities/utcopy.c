@@ -851,9 +851,9 @@ AcpiUtCopySimpleObject (
     DestDesc->Common.ReferenceCount = ReferenceCount;
     DestDesc->Common.NextObject = NextObject;
 
-    /* New object is not static, regardless of source */
+    /* New object is not static, nor held by the device ID map */
 
-    DestDesc->Common.Flags &= ~AOPOBJ_STATIC_POINTER;
+    DestDesc->Common.Flags &= ~(AOPOBJ_STATIC_POINTER | AOPOBJ_DEVICE_ID);
 
     /* Handle the objects with extra data */
 
@@ -1043,7 +1043,8 @@ AcpiUtCopyIelementToIelement (
             return (AE_NO_MEMORY);
         }
 
-        TargetObject->Common.Flags = SourceObject->Common.Flags;
+        TargetObject->Common.Flags =
+            SourceObject->Common.Flags & ~AOPOBJ_DEVICE_ID;
 
         /* Pass the new package object back to the package walk routine */
 
@@ -1095,7 +1096,7 @@ AcpiUtCopyIpackageToIpackage (
 
 
     DestObj->Common.Type = SourceObj->Common.Type;
-    DestObj->Common.Flags = SourceObj->Common.Flags;
+    DestObj->Common.Flags = SourceObj->Common.Flags & ~AOPOBJ_DEVICE_ID;
     DestObj->Package.Count = SourceObj->Package.Count;
 
     /*
@@ -154,6 +154,7 @@
 #include "acinterp.h"
 #include "acnamesp.h"
 #include "acevents.h"
+#include "acparser.h"
 
 
 #define _COMPONENT          ACPI_UTILITIES
@@ -333,6 +334,20 @@ AcpiUtDeleteInternalObj (
         {
             Object->Method.Node = NULL;
         }
+
+        AcpiNsDeleteMethodCache (Object);
+
+        if (Object->Method.Decoded)
+        {
+            AcpiPsDeleteDecodedMethod (Object->Method.Decoded);
+            Object->Method.Decoded = NULL;
+        }
+
+        if (Object->Method.ResultCache)
+        {
+            AcpiUtRemoveReference (Object->Method.ResultCache);
+            Object->Method.ResultCache = NULL;
+        }
         break;
 
     case ACPI_TYPE_REGION:
@@ -322,12 +322,31 @@ AcpiUtInitGlobals (
     AcpiGbl_GlobalLockHandle            = 0;
     AcpiGbl_GlobalLockPresent           = FALSE;
 
+    /* Shared interpreter */
+
+    memset (AcpiGbl_InterpreterHolders, 0, sizeof (AcpiGbl_InterpreterHolders));
+    AcpiGbl_InterpreterHolderCount      = 0;
+    AcpiGbl_InterpreterReaders          = 0;
+    AcpiGbl_InterpreterDrainWaiting     = FALSE;
+
     /* Miscellaneous variables */
 
     AcpiGbl_DSDT                        = NULL;
     AcpiGbl_CmSingleStep                = FALSE;
     AcpiGbl_Shutdown                    = FALSE;
     AcpiGbl_NsLookupCount               = 0;
+    AcpiGbl_NsPathCache                 = NULL;
+    AcpiGbl_NsPathCacheGeneration       = 0;
+    AcpiGbl_NsPathCacheHits             = 0;
+    AcpiGbl_NsPathCacheMisses           = 0;
+    AcpiGbl_NsNodeArenas                = NULL;
+    AcpiGbl_NsIdMapGeneration           = 0;
+    AcpiGbl_MethodCacheList             = NULL;
+    AcpiGbl_MethodCacheClock            = NULL;
+    AcpiGbl_MethodCacheBytes            = 0;
+    AcpiGbl_MethodCacheHits             = 0;
+    AcpiGbl_MethodCacheMisses           = 0;
+    AcpiGbl_MethodCacheEvictions        = 0;
     AcpiGbl_PsFindCount                 = 0;
     AcpiGbl_AcpiHardwarePresent         = TRUE;
     AcpiGbl_LastOwnerIdIndex            = 0;
@@ -349,6 +368,7 @@ AcpiUtInitGlobals (
     AcpiGbl_RootNodeStruct.Parent       = NULL;
     AcpiGbl_RootNodeStruct.Child        = NULL;
     AcpiGbl_RootNodeStruct.Peer         = NULL;
+    AcpiGbl_RootNodeStruct.ChildIndex   = NULL;
     AcpiGbl_RootNodeStruct.Object       = NULL;
 
 
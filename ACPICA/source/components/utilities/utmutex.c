@@ -151,6 +151,7 @@
 
 #include "acpi.h"
 #include "accommon.h"
+#include "acinterp.h"
 
 #define _COMPONENT          ACPI_UTILITIES
         ACPI_MODULE_NAME    ("utmutex")
@@ -237,6 +238,30 @@ AcpiUtMutexInitialize (
         return_ACPI_STATUS (Status);
     }
 
+    /* Shared interpreter, region locks and method thread counts */
+
+    Status = AcpiOsCreateLock (&AcpiGbl_InterpreterLock);
+    if (ACPI_FAILURE (Status))
+    {
+        return_ACPI_STATUS (Status);
+    }
+
+    Status = AcpiOsCreateSemaphore (1, 0, &AcpiGbl_InterpreterDrained);
+    if (ACPI_FAILURE (Status))
+    {
+        return_ACPI_STATUS (Status);
+    }
+
+    for (i = 0; i < ACPI_REGION_LOCK_COUNT; i++)
+    {
+        Status = AcpiOsCreateMutex (&AcpiGbl_RegionLocks[i].Mutex);
+        if (ACPI_FAILURE (Status))
+        {
+            return_ACPI_STATUS (Status);
+        }
+    }
+
+    Status = AcpiOsCreateMutex (&AcpiGbl_MethodThreadMutex);
     return_ACPI_STATUS (Status);
 }
 
@@ -282,6 +307,16 @@ AcpiUtMutexTerminate (
     /* Delete the reader/writer lock */
 
     AcpiUtDeleteRwLock (&AcpiGbl_NamespaceRwLock);
+
+    AcpiOsDeleteLock (AcpiGbl_InterpreterLock);
+    AcpiOsDeleteSemaphore (AcpiGbl_InterpreterDrained);
+    for (i = 0; i < ACPI_REGION_LOCK_COUNT; i++)
+    {
+        AcpiOsDeleteMutex (AcpiGbl_RegionLocks[i].Mutex);
+        AcpiGbl_RegionLocks[i].Mutex = NULL;
+    }
+
+    AcpiOsDeleteMutex (AcpiGbl_MethodThreadMutex);
     return_VOID;
 }
 
@@ -428,6 +463,13 @@ AcpiUtAcquireMutex (
 
         AcpiGbl_MutexInfo[MutexId].UseCount++;
         AcpiGbl_MutexInfo[MutexId].ThreadId = ThisThreadId;
+
+        /* Parallel methods leave the namespace alone while it is held */
+
+        if ((MutexId == ACPI_MTX_NAMESPACE) && AcpiGbl_InterpreterReaders)
+        {
+            AcpiExWaitForSharedHolders ();
+        }
     }
     else
     {
@@ -440,6 +482,40 @@ AcpiUtAcquireMutex (
 }
 
 
+/*******************************************************************************
+ *
+ * FUNCTION:    AcpiUtAcquireNamespaceForLookup
+ *
+ * PARAMETERS:  None
+ *
+ * RETURN:      Status
+ *
+ * DESCRIPTION: Acquire the namespace mutex to look names up. Unlike
+ *              AcpiUtAcquireMutex, this does not wait for the threads
+ *              running parallel methods, which never change the namespace.
+ *              Release with AcpiUtReleaseMutex.
+ *
+ ******************************************************************************/
+
+ACPI_STATUS
+AcpiUtAcquireNamespaceForLookup (
+    void)
+{
+    ACPI_STATUS             Status;
+
+
+    Status = AcpiOsAcquireMutex (
+        AcpiGbl_MutexInfo[ACPI_MTX_NAMESPACE].Mutex, ACPI_WAIT_FOREVER);
+    if (ACPI_SUCCESS (Status))
+    {
+        AcpiGbl_MutexInfo[ACPI_MTX_NAMESPACE].UseCount++;
+        AcpiGbl_MutexInfo[ACPI_MTX_NAMESPACE].ThreadId = AcpiOsGetThreadId ();
+    }
+
+    return (Status);
+}
+
+
 /*******************************************************************************
  *
  * FUNCTION:    AcpiUtReleaseMutex
@@ -36,6 +36,7 @@
 
 /* standard includes... */
 #include "acpica/acpi.h"
+#include "acpica/accommon.h"
 #include "acpica/actables.h"  /* For MCFG table definitions */
 
 #include <mach/semaphore.h>
@@ -43,6 +44,11 @@
 #include <mach/machine.h>
 #include <IOKit/IOLib.h>
 #include <mach/thread_status.h>
+#include <kern/cpu_number.h>
+#include <kern/thread.h>
+#include <kern/clock.h>
+#include <kern/sched_prim.h>
+#include <libkern/OSAtomic.h>
 
 /* ACPI OS Layer implementations because yes */
 #define _COMPONENT ACPI_OS_SERVICES
@@ -66,27 +72,70 @@ struct _memory_tag {
 };
 
 /* Cache management structures for ACPICA object caching */
+
+/* A free object in the depot; the link lives in the object's first word. */
 struct _cache_object {
     struct _cache_object *next;
-    /* Object data follows this header */
 };
 
+/*
+ * Objects are carved out of naturally aligned slabs that start with this
+ * header. Like _memory_tag, it begins with a magic number, which is how
+ * AcpiOsFree tells the two kinds of allocation apart.
+ */
+struct _acpi_cache_slab {
+    UINT32 magic;
+    UINT32 free;                        /* objects of this slab sitting in the depot */
+    struct _acpi_cache_slab *next;
+    struct _acpi_cache *cache;
+};
+
+#define ACPI_CACHE_LINE_SIZE        64
+#define ACPI_CACHE_MAGAZINE_SIZE    16
+#define ACPI_CACHE_BATCH            (ACPI_CACHE_MAGAZINE_SIZE / 2)
+#define ACPI_CACHE_SLAB_MIN_OBJECTS 2
+#define ACPI_CACHE_SLAB_HEADER      ACPI_ROUND_UP(sizeof(struct _acpi_cache_slab), 16)
+#define ACPI_CACHE_SLAB(c, o)       ((struct _acpi_cache_slab *)((uintptr_t)(o) & ~((uintptr_t)(c)->slab_size - 1)))
+
+/* Per-CPU magazine, only ever touched by its own CPU with interrupts disabled. */
+struct _acpi_cache_cpu {
+    UINT32 rounds;
+    UINT32 requests;
+    UINT32 hits;
+    UINT32 releases;
+    UINT64 bytes;                       /* bytes asked for, for the AcpiOsAllocate size classes */
+    void *objects[ACPI_CACHE_MAGAZINE_SIZE];
+} __attribute__((aligned(ACPI_CACHE_LINE_SIZE)));
+
 struct _acpi_cache {
     UINT32 magic;
     char name[16];
     ACPI_SIZE object_size;
+    ACPI_SIZE object_stride;
+    ACPI_SIZE slab_size;
+    UINT32 slab_objects;
     UINT16 max_depth;
-    UINT16 current_depth;
-    struct _cache_object *list_head;
+    UINT32 ncpus;
+    struct _acpi_cache_cpu *cpus;
+
+    /* The depot, protected by lock */
     IOSimpleLock *lock;
-    UINT32 requests;
-    UINT32 hits;
+    struct _cache_object *list_head;
+    UINT32 current_depth;               /* objects in the depot */
+    struct _acpi_cache_slab *slabs;
+    UINT32 empty_slabs;                 /* slabs whose objects are all in the depot */
+    UINT32 total;                       /* objects in all slabs */
+    UINT32 high_water;                  /* most objects the cache has ever held */
+    UINT32 contended;                   /* depot lock acquisitions that had to spin */
 };
 
 #define ACPI_CACHE_MAGIC 'cach'
+#define ACPI_CACHE_SLAB_MAGIC 'slab'
+#define ACPI_MEMORY_TAG_MAGIC 'mema'
 
 #define ACPI_OS_PRINTF_USE_KPRINTF 0x1
 #define ACPI_OS_PRINTF_USE_IOLOG   0x2
+#define ACPI_OS_PRINTF_SYNC        0x4     /* print from the caller, not the log ring */
 
 #if DEBUG
 UInt32 gAcpiOsPrintfFlags = ACPI_OS_PRINTF_USE_KPRINTF | ACPI_OS_PRINTF_USE_IOLOG;
@@ -97,10 +146,21 @@ UInt32 gAcpiOsPrintfFlags = ACPI_OS_PRINTF_USE_IOLOG;
 
 /* External functions - see PDACPIPlatform/AcpiOsLayer.cpp */
 extern void *AcpiOsExtMapMemory(ACPI_PHYSICAL_ADDRESS, ACPI_SIZE);
-extern void AcpiOsExtUnmapMemory(void *);
+extern void AcpiOsExtUnmapMemory(void *, ACPI_SIZE);
 extern ACPI_STATUS AcpiOsExtInitialize(void);
 extern ACPI_PHYSICAL_ADDRESS AcpiOsExtGetRootPointer(void);
 extern ACPI_STATUS AcpiOsExtExecute(ACPI_EXECUTE_TYPE Type, ACPI_OSD_EXEC_CALLBACK Function, void *Context);
+extern void AcpiOsExtWaitEventsComplete(void);
+extern void *AcpiOsExtPciEcamAddress(ACPI_PCI_ID *PciId, UINT32 Reg);
+
+static void AcpiOsInitializeAllocator(void);
+static void AcpiOsInitializePciShadow(void);
+static void AcpiOsTerminatePciShadow(void);
+static void AcpiOsInitializeLocks(void);
+static void AcpiOsInitializeSemaphores(void);
+static void AcpiOsInitializeTimer(void);
+static void AcpiOsInitializeLog(void);
+static void AcpiOsTerminateLog(void);
 
 ACPI_STATUS AcpiOsInitialize(void)
 {
@@ -108,17 +168,39 @@ ACPI_STATUS AcpiOsInitialize(void)
     
     PE_parse_boot_argn("acpi_os_log", &gAcpiOsPrintfFlags, sizeof(UInt32));
     
+    AcpiOsInitializeTimer();
+    AcpiOsInitializeLog();
+    AcpiOsInitializeAllocator();
+    AcpiOsInitializeLocks();
+    AcpiOsInitializeSemaphores();
+    
     status = AcpiOsExtInitialize(); /* dispatch to AcpiOsLayer.cpp to establish the memory map tracking + PCI access. */
     if (ACPI_FAILURE(status)) {
         return status;
     }
     
-    /* Initialize ECAM support - this will be done lazily on first PCI access if ACPI tables aren't ready yet */
-    /* AcpiOsInitializePciEcam(); */
+    AcpiOsInitializePciShadow();
     
     return AE_OK;
 }
 
+/* Sum the per-CPU request and hit counters. */
+static void
+AcpiOsCacheCounters(struct _acpi_cache *cache, UINT32 *Requests, UINT32 *Hits)
+{
+    UINT32 requests = 0, hits = 0;
+    
+    for (UINT32 i = 0; i < cache->ncpus; i++) {
+        requests += cache->cpus[i].requests;
+        hits += cache->cpus[i].hits;
+    }
+    
+    *Requests = requests;
+    *Hits = hits;
+}
+
+#ifndef ACPI_USE_LOCAL_CACHE
+
 /* AcpiOsValidateCache (Debug helper) - Validate cache integrity (debug builds only) */
 #if DEBUG
 ACPI_STATUS
@@ -126,34 +208,41 @@ AcpiOsValidateCache(ACPI_CACHE_T *Cache)
 {
     struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
     struct _cache_object *object;
-    UINT16 count = 0;
+    UINT32 count = 0;
+    UINT32 requests, hits;
+    boolean_t istate;
     
     if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
         AcpiOsPrintf("ACPI: Invalid cache object\n");
         return AE_BAD_PARAMETER;
     }
     
+    istate = ml_set_interrupts_enabled(FALSE);
     IOSimpleLockLock(cache->lock);
     
-    /* Count objects in cache */
+    /* Count objects in the depot */
     object = cache->list_head;
-    while (object && count < cache->max_depth + 10) { /* Prevent infinite loops */
+    while (object && count <= cache->total) { /* Prevent infinite loops */
         count++;
         object = object->next;
     }
     
     if (count != cache->current_depth) {
-        AcpiOsPrintf("ACPI: Cache '%s' depth mismatch: reported %d, actual %d\n",
-                     cache->name, cache->current_depth, count);
         IOSimpleLockUnlock(cache->lock);
+        ml_set_interrupts_enabled(istate);
+        AcpiOsPrintf("ACPI: Cache '%s' depth mismatch: reported %u, actual %u\n",
+                     cache->name, cache->current_depth, count);
         return AE_ERROR;
     }
     
     IOSimpleLockUnlock(cache->lock);
+    ml_set_interrupts_enabled(istate);
     
-    AcpiOsPrintf("ACPI: Cache '%s' validated: %d/%d objects, %u requests, %u hits\n",
-                 cache->name, cache->current_depth, cache->max_depth,
-                 cache->requests, cache->hits);
+    AcpiOsCacheCounters(cache, &requests, &hits);
+    AcpiOsPrintf("ACPI: Cache '%s' validated: %u/%u objects in depot, %u requests, %u hits, "
+                 "high water %u, %u contended\n",
+                 cache->name, cache->current_depth, cache->total,
+                 requests, hits, cache->high_water, cache->contended);
     
     return AE_OK;
 }
@@ -164,34 +253,58 @@ ACPI_STATUS
 AcpiOsGetCacheStatistics(ACPI_CACHE_T *Cache, UINT32 *Requests, UINT32 *Hits)
 {
     struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
+    UINT32 requests, hits;
     
     if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
         return AE_BAD_PARAMETER;
     }
     
+    AcpiOsCacheCounters(cache, &requests, &hits);
+    
     if (Requests) {
-        *Requests = cache->requests;
+        *Requests = requests;
     }
     
     if (Hits) {
-        *Hits = cache->hits;
+        *Hits = hits;
+    }
+    
+    return AE_OK;
+}
+
+/* AcpiOsGetCacheContention (Debug helper) - Get cache high water mark and depot lock contention */
+ACPI_STATUS
+AcpiOsGetCacheContention(ACPI_CACHE_T *Cache, UINT32 *HighWater, UINT32 *Contended)
+{
+    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
+    
+    if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    if (HighWater) {
+        *HighWater = cache->high_water;
+    }
+    
+    if (Contended) {
+        *Contended = cache->contended;
     }
     
     return AE_OK;
 }
 
+#endif /* ACPI_USE_LOCAL_CACHE */
+
 ACPI_STATUS AcpiOsTerminate(void)
 {
-    /* Cleanup any OS-specific resources if needed */
-    gPciEcamInitialized = FALSE;
-    gPciEcamBase = 0;
-    gPciEcamSize = 0;
-    gPciStartBus = 0;
-    gPciEndBus = 0;
+    /* ECAM windows are torn down by AcpiOsExtTerminate in AcpiOsLayer.cpp */
+    AcpiOsTerminatePciShadow();
     
     /* Note: ACPICA should clean up its own caches via AcpiOsDeleteCache() */
     /* but we could add cache leak detection here in debug builds */
     
+    AcpiOsTerminateLog();
+    
     return AE_OK;
 }
 
@@ -221,37 +334,7 @@ AcpiOsMapMemory(ACPI_PHYSICAL_ADDRESS Where, ACPI_SIZE Length)
 void
 AcpiOsUnmapMemory(void *LogicalAddress, ACPI_SIZE Length)
 {
-    AcpiOsExtUnmapMemory(LogicalAddress);
-}
-
-void *
-AcpiOsAllocate(ACPI_SIZE Size)
-{
-    void *alloc = IOMalloc(Size + sizeof(struct _memory_tag));
-    struct _memory_tag *mem = alloc;
-    mem->magic = 'mema';
-    mem->size = Size + sizeof(struct _memory_tag);
-    return (alloc + sizeof(struct _memory_tag));
-}
-
-void *
-AcpiOsAllocateZeroed(ACPI_SIZE Size)
-{
-    void *alloc = AcpiOsAllocate(Size);
-    memset(alloc, 0, Size);
-    return alloc;
-}
-
-void
-AcpiOsFree(void *p)
-{
-    struct _memory_tag *m = p - sizeof(struct _memory_tag);
-    if (m->magic == 'mema') {
-        IOFree(m, m->size);
-    } else {
-        /* induce panic? */
-        return;
-    }
+    AcpiOsExtUnmapMemory(LogicalAddress, Length);
 }
 
 /* ZORMEISTER: me is kernel. i can write and read as i want. */
@@ -419,92 +502,33 @@ AcpiOsWritePort(ACPI_IO_ADDRESS Address,
 
 /* PCI Configuration Space Access - MMIO and Port I/O Implementation */
 
-/* Global variables for ECAM/MMIO support */
-static ACPI_PHYSICAL_ADDRESS gPciEcamBase = 0;
-static UINT32 gPciEcamSize = 0;
-static UINT16 gPciStartBus = 0;
-static UINT16 gPciEndBus = 0;
-static boolean_t gPciEcamInitialized = FALSE;
-
-/* Initialize ECAM (Enhanced Configuration Access Mechanism) support */
-static ACPI_STATUS
-AcpiOsInitializePciEcam(void)
-{
-    ACPI_TABLE_MCFG *mcfg_table = NULL;
-    ACPI_STATUS status;
-    
-    if (gPciEcamInitialized) {
-        return AE_OK;
-    }
-    
-    /* Try to get MCFG table for ECAM base address */
-    status = AcpiGetTable(ACPI_SIG_MCFG, 0, (ACPI_TABLE_HEADER **)&mcfg_table);
-    if (ACPI_SUCCESS(status) && mcfg_table) {
-        ACPI_MCFG_ALLOCATION *allocation;
-        
-        /* Get first allocation entry */
-        allocation = (ACPI_MCFG_ALLOCATION *)((UINT8 *)mcfg_table + sizeof(ACPI_TABLE_MCFG));
-        
-        if ((UINT8 *)allocation < (UINT8 *)mcfg_table + mcfg_table->Header.Length) {
-            gPciEcamBase = allocation->Address;
-            gPciStartBus = allocation->PciSegment;  /* Actually start bus */
-            gPciEndBus = allocation->EndBusNumber;
-            gPciEcamSize = (gPciEndBus - gPciStartBus + 1) * 256 * 4096; /* Each bus has 256 devices, 4KB each */
-            
-#if DEBUG
-            AcpiOsPrintf("ACPI: ECAM base 0x%llX, buses %d-%d, size 0x%X\n", 
-                        gPciEcamBase, gPciStartBus, gPciEndBus, gPciEcamSize);
-#endif
-        }
-    }
-    
-    gPciEcamInitialized = TRUE;
-    return AE_OK;
-}
+/*
+ * ECAM windows are owned by AcpiOsLayer.cpp, which maps every MCFG
+ * allocation bus by bus on first use. AcpiOsExtPciEcamAddress returns NULL
+ * for buses no allocation decodes, and those fall back to port I/O.
+ */
 
 /* MMIO-based PCI configuration space access */
 static ACPI_STATUS
-AcpiOsReadPciConfigMmio(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 *Value, UINT32 Width)
-{
-    ACPI_PHYSICAL_ADDRESS config_addr;
-    void *mapped_addr;
-    UINT64 data = 0;
-    
-    /* Calculate ECAM address: Base + (Bus << 20) + (Device << 15) + (Function << 12) + Register */
-    config_addr = gPciEcamBase + 
-                  ((UINT64)PciId->Bus << 20) + 
-                  ((UINT64)PciId->Device << 15) + 
-                  ((UINT64)PciId->Function << 12) + 
-                  Register;
-    
-    /* Map the configuration space */
-    mapped_addr = AcpiOsMapMemory(config_addr, Width / 8);
-    if (!mapped_addr) {
-        return AE_NO_MEMORY;
-    }
-    
-    /* Read the value */
+AcpiOsReadPciConfigMmio(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 *Value, UINT32 Width, void *ConfigAddr)
+{
     switch (Width) {
         case 8:
-            data = *(UINT8 *)mapped_addr;
+            *Value = *(volatile UINT8 *)ConfigAddr;
             break;
         case 16:
-            data = *(UINT16 *)mapped_addr;
+            *Value = *(volatile UINT16 *)ConfigAddr;
             break;
         case 32:
-            data = *(UINT32 *)mapped_addr;
+            *Value = *(volatile UINT32 *)ConfigAddr;
             break;
         default:
-            AcpiOsUnmapMemory(mapped_addr, Width / 8);
             return AE_BAD_PARAMETER;
     }
     
-    *Value = data;
-    AcpiOsUnmapMemory(mapped_addr, Width / 8);
-    
 #if DEBUG
-    AcpiOsPrintf("PCI MMIO read: %02X:%02X:%02X reg 0x%02X width %d = 0x%X\n",
-                 PciId->Bus, PciId->Device, PciId->Function, 
+    AcpiOsPrintf("PCI MMIO read: %04X:%02X:%02X:%02X reg 0x%02X width %d = 0x%X\n",
+                 PciId->Segment, PciId->Bus, PciId->Device, PciId->Function, 
                  Register, Width, (UINT32)*Value);
 #endif
     
@@ -512,47 +536,28 @@ AcpiOsReadPciConfigMmio(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 *Value, UINT
 }
 
 static ACPI_STATUS
-AcpiOsWritePciConfigMmio(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 Value, UINT32 Width)
+AcpiOsWritePciConfigMmio(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 Value, UINT32 Width, void *ConfigAddr)
 {
-    ACPI_PHYSICAL_ADDRESS config_addr;
-    void *mapped_addr;
-    
 #if DEBUG
-    AcpiOsPrintf("PCI MMIO write: %02X:%02X:%02X reg 0x%02X width %d = 0x%X\n",
-                 PciId->Bus, PciId->Device, PciId->Function, 
+    AcpiOsPrintf("PCI MMIO write: %04X:%02X:%02X:%02X reg 0x%02X width %d = 0x%X\n",
+                 PciId->Segment, PciId->Bus, PciId->Device, PciId->Function, 
                  Register, Width, (UINT32)Value);
 #endif
     
-    /* Calculate ECAM address */
-    config_addr = gPciEcamBase + 
-                  ((UINT64)PciId->Bus << 20) + 
-                  ((UINT64)PciId->Device << 15) + 
-                  ((UINT64)PciId->Function << 12) + 
-                  Register;
-    
-    /* Map the configuration space */
-    mapped_addr = AcpiOsMapMemory(config_addr, Width / 8);
-    if (!mapped_addr) {
-        return AE_NO_MEMORY;
-    }
-    
-    /* Write the value */
     switch (Width) {
         case 8:
-            *(UINT8 *)mapped_addr = (UINT8)Value;
+            *(volatile UINT8 *)ConfigAddr = (UINT8)Value;
             break;
         case 16:
-            *(UINT16 *)mapped_addr = (UINT16)Value;
+            *(volatile UINT16 *)ConfigAddr = (UINT16)Value;
             break;
         case 32:
-            *(UINT32 *)mapped_addr = (UINT32)Value;
+            *(volatile UINT32 *)ConfigAddr = (UINT32)Value;
             break;
         default:
-            AcpiOsUnmapMemory(mapped_addr, Width / 8);
             return AE_BAD_PARAMETER;
     }
     
-    AcpiOsUnmapMemory(mapped_addr, Width / 8);
     return AE_OK;
 }
 
@@ -634,199 +639,1185 @@ AcpiOsWritePciConfigPortIo(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 Value, UI
     return AE_OK;
 }
 
-/* Main PCI Configuration Space Access Functions */
-ACPI_STATUS
-AcpiOsReadPciConfiguration(ACPI_PCI_ID *PciId,
-                           UINT32 Register,
-                           UINT64 *Value,
-                           UINT32 Width)
+/* Route a config access to ECAM if an MCFG allocation decodes the bus, else to port I/O */
+static ACPI_STATUS
+AcpiOsReadPciConfigHardware(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 *Value, UINT32 Width)
 {
-    if (!PciId || !Value) {
-        return AE_BAD_PARAMETER;
-    }
-    
-    if (Width != 8 && Width != 16 && Width != 32) {
-        return AE_BAD_PARAMETER;
+    void *ConfigAddr;
+
+    ConfigAddr = AcpiOsExtPciEcamAddress(PciId, Register);
+    if (ConfigAddr) {
+        return AcpiOsReadPciConfigMmio(PciId, Register, Value, Width, ConfigAddr);
     }
-    
-    /* Initialize ECAM support if not done already */
-    AcpiOsInitializePciEcam();
-    
-    /* Try MMIO/ECAM first if available and bus is in range */
-    if (gPciEcamBase != 0 && 
-        PciId->Bus >= gPciStartBus && 
-        PciId->Bus <= gPciEndBus) {
-        return AcpiOsReadPciConfigMmio(PciId, Register, Value, Width);
+
+    /* Port I/O only reaches segment 0 */
+    if (PciId->Segment != 0) {
+        return AE_NOT_EXIST;
     }
-    
-    /* Fall back to legacy Port I/O method */
     return AcpiOsReadPciConfigPortIo(PciId, Register, Value, Width);
 }
 
-ACPI_STATUS
-AcpiOsWritePciConfiguration(ACPI_PCI_ID *PciId,
-                            UINT32 Register,
-                            UINT64 Value,
-                            UINT32 Width)
+static ACPI_STATUS
+AcpiOsWritePciConfigHardware(ACPI_PCI_ID *PciId, UINT32 Register, UINT64 Value, UINT32 Width)
 {
-    if (!PciId) {
-        return AE_BAD_PARAMETER;
-    }
-    
-    if (Width != 8 && Width != 16 && Width != 32) {
-        return AE_BAD_PARAMETER;
+    void *ConfigAddr;
+
+    ConfigAddr = AcpiOsExtPciEcamAddress(PciId, Register);
+    if (ConfigAddr) {
+        return AcpiOsWritePciConfigMmio(PciId, Register, Value, Width, ConfigAddr);
     }
-    
-    /* Initialize ECAM support if not done already */
-    AcpiOsInitializePciEcam();
-    
-    /* Try MMIO/ECAM first if available and bus is in range */
-    if (gPciEcamBase != 0 && 
-        PciId->Bus >= gPciStartBus && 
-        PciId->Bus <= gPciEndBus) {
-        return AcpiOsWritePciConfigMmio(PciId, Register, Value, Width);
+
+    if (PciId->Segment != 0) {
+        return AE_NOT_EXIST;
     }
-    
-    /* Fall back to legacy Port I/O method */
     return AcpiOsWritePciConfigPortIo(PciId, Register, Value, Width);
 }
 
-#pragma mark OS time related functions
+/*
+ * Shadow of the config space bytes that cannot change while a function is
+ * running: vendor/device ID, revision and class code, header type, subsystem
+ * IDs, the capability pointer, interrupt pin and the ID/next bytes of each
+ * capability. AML re-reads these constantly, and each read is a port I/O
+ * pair or an uncached ECAM load.
+ *
+ * The first read of a function snapshots its header and capability list.
+ * Later reads that fall entirely inside read-only bytes are answered from
+ * the shadow. BARs, command and status are never served from it, since the
+ * PCI family reprograms them behind our back. A write to a function
+ * invalidates the values shadowed for it. A write that can renumber or reset
+ * whatever sits behind a bridge (bus numbers, bridge control) drops every
+ * shadow, as does AcpiOsInvalidatePciConfiguration(NULL).
+ */
+#define ACPI_PCI_SHADOW_BUCKETS     64
+#define ACPI_PCI_SHADOW_MAX_CAPS    48
+#define ACPI_PCI_SHADOW_KEY(p)      (((UINT32)(p)->Segment << 16) | (((UINT32)(p)->Bus & 0xFF) << 8) | \
+                                     (((UINT32)(p)->Device & 0x1F) << 3) | ((UINT32)(p)->Function & 0x7))
 
-void AcpiOsSleep(UINT64 ms)
+struct _acpi_pci_shadow
 {
-    IOSleep((UINT32)ms);
-}
+    struct _acpi_pci_shadow     *next;          /* hash chain */
+    UINT32                      key;
+    UINT32                      read_only[8];   /* bit per byte of the first 256 */
+    UINT64                      valid;          /* bit per dword captured in config */
+    UINT32                      config[64];
+    UINT64                      hits;
+    UINT64                      misses;
+};
 
-void AcpiOsStall(UINT32 us)
+static IOSimpleLock *gAcpiOsPciShadowLock;
+static struct _acpi_pci_shadow *gAcpiOsPciShadow[ACPI_PCI_SHADOW_BUCKETS];
+static UINT32 gAcpiOsPciShadowGeneration;      /* bumped by every invalidation */
+
+void AcpiOsInvalidatePciConfiguration(ACPI_PCI_ID *PciId);
+
+static void
+AcpiOsInitializePciShadow(void)
 {
-    IODelay(us);
+    gAcpiOsPciShadowLock = IOSimpleLockAlloc();
 }
 
-/* ZORMEISTER: I think? - 'The current value of the system timer in 100-nanosecond units. '*/
-UInt64 AcpiOsGetTimer(void)
+static void
+AcpiOsTerminatePciShadow(void)
 {
-    UInt64 abs = mach_absolute_time();
-    UInt64 ns = 0;
-    absolutetime_to_nanoseconds(abs, &ns);
-    return (ns / 100);
+    if (gAcpiOsPciShadowLock) {
+        AcpiOsInvalidatePciConfiguration(NULL);
+        IOSimpleLockFree(gAcpiOsPciShadowLock);
+        gAcpiOsPciShadowLock = NULL;
+    }
 }
 
-#pragma mark Lock functions
-
-ACPI_STATUS AcpiOsCreateLock(ACPI_SPINLOCK *Lock)
+static struct _acpi_pci_shadow *
+AcpiOsPciShadowLookup(UINT32 Key)
 {
-    IOSimpleLock *lck = IOSimpleLockAlloc();
-    if (!lck) {
-        return AE_NO_MEMORY;
+    struct _acpi_pci_shadow *shadow = gAcpiOsPciShadow[(Key ^ (Key >> 8)) % ACPI_PCI_SHADOW_BUCKETS];
+
+    while (shadow && shadow->key != Key) {
+        shadow = shadow->next;
     }
-    
-    *Lock = lck;
-    
-    return AE_OK;
-};
+    return shadow;
+}
 
-void AcpiOsDeleteLock(ACPI_SPINLOCK Lock)
+static void
+AcpiOsPciShadowMarkReadOnly(struct _acpi_pci_shadow *shadow, UINT32 Register, UINT32 Length)
 {
-    IOSimpleLockFree(Lock);
+    for (UINT32 i = Register; i < Register + Length; i++) {
+        shadow->read_only[i / 32] |= (1U << (i % 32));
+    }
 }
 
-
-/* 'May be called from interrupt handlers, GPE handlers, and Fixed event handlers.' */
-/* Fun way of saying I should disable interrupts until the lock is released. */
-ACPI_CPU_FLAGS AcpiOsAcquireLock(ACPI_SPINLOCK Lock)
+static BOOLEAN
+AcpiOsPciShadowReadOnly(struct _acpi_pci_shadow *shadow, UINT32 Register, UINT32 Width)
 {
-    ml_set_interrupts_enabled(false);
-    IOSimpleLockLock(Lock);
-    return 0;
+    if (Register + Width / 8 > 256) {
+        return FALSE;
+    }
+    for (UINT32 i = Register; i < Register + Width / 8; i++) {
+        if (!(shadow->read_only[i / 32] & (1U << (i % 32)))) {
+            return FALSE;
+        }
+    }
+    return TRUE;
 }
 
-void AcpiOsReleaseLock(ACPI_SPINLOCK Lock, ACPI_CPU_FLAGS Flags)
+/* Read the header and capability list of a present function. Called without the lock. */
+static BOOLEAN
+AcpiOsPciShadowFill(ACPI_PCI_ID *PciId, struct _acpi_pci_shadow *shadow)
 {
-    IOSimpleLockUnlock(Lock);
-    ml_set_interrupts_enabled(true);
-}
+    UINT64 value;
+    UINT32 header_type, pointer;
 
-#pragma mark Semaphore code
+    for (UINT32 i = 0; i < 16; i++) {
+        if (ACPI_FAILURE(AcpiOsReadPciConfigHardware(PciId, i * 4, &value, 32))) {
+            return FALSE;
+        }
+        shadow->config[i] = (UINT32)value;
+
+        /* Nothing decodes this function; it may be hot-added later, so shadow nothing. */
+        if (i == 0 && ((UINT16)value == 0xFFFF || (UINT16)value == 0)) {
+            return FALSE;
+        }
+    }
+    shadow->valid = 0xFFFF;
+
+    header_type = (shadow->config[0x0C / 4] >> 16) & 0x7F;
+    AcpiOsPciShadowMarkReadOnly(shadow, 0x00, 4);       /* vendor, device */
+    AcpiOsPciShadowMarkReadOnly(shadow, 0x08, 4);       /* revision, class code */
+    AcpiOsPciShadowMarkReadOnly(shadow, 0x0E, 1);       /* header type */
+    if (header_type == 0) {
+        AcpiOsPciShadowMarkReadOnly(shadow, 0x2C, 4);   /* subsystem vendor, subsystem */
+    }
+    if (header_type > 1) {
+        return TRUE;
+    }
+    AcpiOsPciShadowMarkReadOnly(shadow, 0x34, 1);       /* capability pointer */
+    AcpiOsPciShadowMarkReadOnly(shadow, 0x3D, 1);       /* interrupt pin */
+
+    /* Status bit 4 says the capability list exists */
+    if (!(shadow->config[0x04 / 4] & (0x10 << 16))) {
+        return TRUE;
+    }
+
+    pointer = shadow->config[0x34 / 4] & 0xFC;
+    for (UINT32 n = 0; pointer >= 0x40 && n < ACPI_PCI_SHADOW_MAX_CAPS; n++) {
+        if (ACPI_FAILURE(AcpiOsReadPciConfigHardware(PciId, pointer, &value, 32))) {
+            break;
+        }
+        shadow->config[pointer / 4] = (UINT32)value;
+        shadow->valid |= (1ULL << (pointer / 4));
+        AcpiOsPciShadowMarkReadOnly(shadow, pointer, 2); /* capability ID, next pointer */
+        pointer = ((UINT32)value >> 8) & 0xFC;
+    }
+
+    return TRUE;
+}
 
-ACPI_STATUS AcpiOsCreateSemaphore(UInt32 InitialUnits, UInt32 MaxUnits, ACPI_SEMAPHORE *Handle)
+/*
+ * Find the shadow for a function, snapshotting it if this is the first
+ * access. Returns with the lock held and the shadow, or NULL for a function
+ * that is absent or was invalidated while its snapshot was being taken.
+ */
+static struct _acpi_pci_shadow *
+AcpiOsPciShadowGet(ACPI_PCI_ID *PciId)
 {
-    if (Handle == NULL) {
-        return AE_BAD_PARAMETER;
+    struct _acpi_pci_shadow *shadow, *fresh, **bucket;
+    UINT32 key = ACPI_PCI_SHADOW_KEY(PciId);
+    UINT32 generation;
+
+    IOSimpleLockLock(gAcpiOsPciShadowLock);
+    shadow = AcpiOsPciShadowLookup(key);
+    if (shadow) {
+        return shadow;
     }
-    
-    if (semaphore_create(current_task(), Handle, 0, MaxUnits) == KERN_SUCCESS) {
-        return AE_OK;
+    generation = gAcpiOsPciShadowGeneration;
+    IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+
+    fresh = AcpiOsAllocateZeroed(sizeof(struct _acpi_pci_shadow));
+    if (!fresh) {
+        IOSimpleLockLock(gAcpiOsPciShadowLock);
+        return NULL;
+    }
+    fresh->key = key;
+    if (!AcpiOsPciShadowFill(PciId, fresh)) {
+        AcpiOsFree(fresh);
+        IOSimpleLockLock(gAcpiOsPciShadowLock);
+        return NULL;
     }
 
-    return AE_NO_MEMORY;
+    IOSimpleLockLock(gAcpiOsPciShadowLock);
+    shadow = AcpiOsPciShadowLookup(key);
+    if (shadow || generation != gAcpiOsPciShadowGeneration) {
+        /* Lost a race with another snapshot, or a write made ours stale */
+        IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+        AcpiOsFree(fresh);
+        IOSimpleLockLock(gAcpiOsPciShadowLock);
+        return AcpiOsPciShadowLookup(key);
+    }
+    bucket = &gAcpiOsPciShadow[(key ^ (key >> 8)) % ACPI_PCI_SHADOW_BUCKETS];
+    fresh->next = *bucket;
+    *bucket = fresh;
+    return fresh;
 }
 
-ACPI_STATUS AcpiOsDeleteSemaphore(ACPI_SEMAPHORE Handle)
+/* AcpiOsInvalidatePciConfiguration - Drop the shadow of one function after a reset, or of all (PciId NULL) */
+void
+AcpiOsInvalidatePciConfiguration(ACPI_PCI_ID *PciId)
 {
-    return AcpiOsDestroySemaphore(Handle);
+    struct _acpi_pci_shadow *dead = NULL, *shadow, **link;
+    UINT32 key = PciId ? ACPI_PCI_SHADOW_KEY(PciId) : 0;
+
+    IOSimpleLockLock(gAcpiOsPciShadowLock);
+    gAcpiOsPciShadowGeneration++;
+    for (UINT32 i = 0; i < ACPI_PCI_SHADOW_BUCKETS; i++) {
+        link = &gAcpiOsPciShadow[i];
+        while ((shadow = *link)) {
+            if (!PciId || shadow->key == key) {
+                *link = shadow->next;
+                shadow->next = dead;
+                dead = shadow;
+            } else {
+                link = &shadow->next;
+            }
+        }
+    }
+    IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+
+    while (dead) {
+        shadow = dead;
+        dead = dead->next;
+        AcpiOsFree(shadow);
+    }
 }
 
-ACPI_STATUS AcpiOsDestroySemaphore(ACPI_SEMAPHORE Semaphore)
+/*
+ * AcpiOsSnapshotPciConfiguration - Header and capability list of a function
+ *
+ * Config receives the 64 dwords of standard config space as shadowed, and
+ * Valid a bit per dword that was actually read: the 16 header dwords plus the
+ * first dword of each capability. AE_NOT_EXIST if nothing decodes the function.
+ */
+ACPI_STATUS
+AcpiOsSnapshotPciConfiguration(ACPI_PCI_ID *PciId, UINT32 *Config, UINT64 *Valid)
 {
-    if (Semaphore == NULL) {
+    struct _acpi_pci_shadow *shadow;
+
+    if (!PciId || !Config || !Valid) {
         return AE_BAD_PARAMETER;
     }
 
-    semaphore_destroy(current_task(), Semaphore);
+    shadow = AcpiOsPciShadowGet(PciId);
+    if (!shadow) {
+        IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+        return AE_NOT_EXIST;
+    }
+    memcpy(Config, shadow->config, sizeof(shadow->config));
+    *Valid = shadow->valid;
+    IOSimpleLockUnlock(gAcpiOsPciShadowLock);
 
     return AE_OK;
 }
 
-ACPI_STATUS AcpiOsWaitSemaphore(ACPI_SEMAPHORE Semaphore, UInt32 Units, UInt16 Timeout)
+/* AcpiOsPrintPciShadowStatistics (Debug helper) - Shadow hits and misses per function */
+void
+AcpiOsPrintPciShadowStatistics(void)
 {
-    if (Semaphore == NULL) {
-        return AE_BAD_PARAMETER;
-    }
-    
-    if (Timeout == 0xFFFF) {
-        if (semaphore_wait(Semaphore) != KERN_SUCCESS) {
-            return AE_TIME;
-        }
-    } else {
-        if (semaphore_wait_deadline(Semaphore, (Timeout * NSEC_PER_MSEC)) != KERN_SUCCESS) {
-            return AE_TIME;
+    IOSimpleLockLock(gAcpiOsPciShadowLock);
+    for (UINT32 i = 0; i < ACPI_PCI_SHADOW_BUCKETS; i++) {
+        for (struct _acpi_pci_shadow *shadow = gAcpiOsPciShadow[i]; shadow; shadow = shadow->next) {
+            AcpiOsPrintf("ACPI: PCI %04X:%02X:%02X.%X %04X:%04X shadow %llu hits, %llu misses\n",
+                         shadow->key >> 16, (shadow->key >> 8) & 0xFF, (shadow->key >> 3) & 0x1F,
+                         shadow->key & 0x7, shadow->config[0] & 0xFFFF, shadow->config[0] >> 16,
+                         shadow->hits, shadow->misses);
         }
     }
-    
-    return AE_OK;
+    IOSimpleLockUnlock(gAcpiOsPciShadowLock);
 }
 
-ACPI_STATUS AcpiOsSignalSemaphore(ACPI_SEMAPHORE Semaphore, UInt32 Units)
+/* Main PCI Configuration Space Access Functions */
+ACPI_STATUS
+AcpiOsReadPciConfiguration(ACPI_PCI_ID *PciId,
+                           UINT32 Register,
+                           UINT64 *Value,
+                           UINT32 Width)
 {
-    if (Semaphore == NULL) {
+    struct _acpi_pci_shadow *shadow;
+
+    if (!PciId || !Value) {
         return AE_BAD_PARAMETER;
     }
-    
-    if (Units > 1) {
-        semaphore_signal_all(Semaphore);
-    } else {
-        semaphore_signal(Semaphore);
+
+    if (Width != 8 && Width != 16 && Width != 32) {
+        return AE_BAD_PARAMETER;
     }
-    
-    return AE_OK;
-}
 
+    /* Serve read-only registers from the shadow */
+    shadow = AcpiOsPciShadowGet(PciId);
+    if (shadow && AcpiOsPciShadowReadOnly(shadow, Register, Width)) {
+        UINT32 dword = Register / 4;
+        UINT32 key = shadow->key;
+        UINT32 generation;
+        UINT64 data = 0;
+
+        if (shadow->valid & (1ULL << dword)) {
+            memcpy(&data, (UINT8 *)shadow->config + Register, Width / 8);
+            shadow->hits++;
+            IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+            *Value = data;
+            return AE_OK;
+        }
 
-#pragma mark Cache management functions
+        /* Written since the snapshot: refetch the whole dword if the read sits inside one */
+        shadow->misses++;
+        if ((Register & 3) + Width / 8 <= 4) {
+            ACPI_STATUS status;
 
-/* adjustments by csekel (InSaneDarwin)
- * ACPICA Object Cache Implementation for Darwin
- * 
- * ACPICA uses object caching to improve performance by reusing frequently
- * allocated/freed objects like parse tree nodes, namespace entries, etc.
- *
- * Cache objects are stored as a simple linked list (LIFO) for fast
- * acquire/release operations. Each cache maintains its own lock and
- * statistics to minimize contention between different object types.
- */
+            generation = gAcpiOsPciShadowGeneration;
+            IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+
+            status = AcpiOsReadPciConfigHardware(PciId, Register & ~3U, &data, 32);
+            if (ACPI_FAILURE(status)) {
+                return status;
+            }
+
+            IOSimpleLockLock(gAcpiOsPciShadowLock);
+            if (generation == gAcpiOsPciShadowGeneration &&
+                (shadow = AcpiOsPciShadowLookup(key))) {
+                shadow->config[dword] = (UINT32)data;
+                shadow->valid |= (1ULL << dword);
+            }
+            IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+
+            *Value = (data >> ((Register & 3) * 8)) & (Width == 32 ? 0xFFFFFFFFULL : ((1ULL << Width) - 1));
+            return AE_OK;
+        }
+    } else if (shadow) {
+        shadow->misses++;
+    }
+    IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+
+    return AcpiOsReadPciConfigHardware(PciId, Register, Value, Width);
+}
 
-/* AcpiOsCreateCache - Create a cache object for ACPICA */
+ACPI_STATUS
+AcpiOsWritePciConfiguration(ACPI_PCI_ID *PciId,
+                            UINT32 Register,
+                            UINT64 Value,
+                            UINT32 Width)
+{
+    struct _acpi_pci_shadow *shadow;
+    ACPI_STATUS status;
+
+    if (!PciId) {
+        return AE_BAD_PARAMETER;
+    }
+
+    if (Width != 8 && Width != 16 && Width != 32) {
+        return AE_BAD_PARAMETER;
+    }
+
+    status = AcpiOsWritePciConfigHardware(PciId, Register, Value, Width);
+
+    /* Bus numbers (0x18-0x1B) and bridge control (0x3E) of a bridge change what lives below it */
+    if ((Register < 0x1C && Register + Width / 8 > 0x18) ||
+        (Register < 0x40 && Register + Width / 8 > 0x3E)) {
+        AcpiOsInvalidatePciConfiguration(NULL);
+        return status;
+    }
+
+    /*
+     * Anything else may have reset the function (FLR, a D3hot->D0 transition).
+     * Its layout survives that, so keep which bytes are read-only and just
+     * refetch the values, one dword at a time as they are next read.
+     */
+    IOSimpleLockLock(gAcpiOsPciShadowLock);
+    shadow = AcpiOsPciShadowLookup(ACPI_PCI_SHADOW_KEY(PciId));
+    if (shadow) {
+        shadow->valid = 0;
+    }
+    gAcpiOsPciShadowGeneration++;
+    IOSimpleLockUnlock(gAcpiOsPciShadowLock);
+
+    return status;
+}
+
+#pragma mark OS time related functions
+
+/*
+ * The interpreter reads AcpiOsGetTimer on every While iteration (the loop
+ * timeout) and for every Timer opcode, so absolute time is turned into
+ * 100ns units with a multiply and a shift worked out from the timebase at
+ * start-up instead of absolutetime_to_nanoseconds() and a divide. Stall
+ * deadlines are converted the same way in the other direction.
+ *
+ * Stalls up to ACPI_OS_STALL_SPIN_US, and any stall where the thread can't
+ * block, spin on the timebase. Longer ones block until that much is left
+ * and spin the rest, so they still end on time. Sleeps up to
+ * ACPI_OS_SLEEP_PRECISE_MS, the Sleep(1) of AML polling loops, ask for no
+ * timer leeway so coalescing doesn't stretch them; longer ones take the
+ * system default.
+ */
+#define ACPI_OS_STALL_SPIN_US       100         /* ACPI's own limit for Stall */
+#define ACPI_OS_SLEEP_PRECISE_MS    20
+
+struct _acpi_os_scale
+{
+    UInt64 mult;
+    UInt32 shift;
+};
+
+static struct _acpi_os_scale gAcpiOsTimerScale;     /* absolute time -> 100ns */
+static struct _acpi_os_scale gAcpiOsStallScale;     /* microseconds -> absolute time */
+static UInt64 gAcpiOsStallSpin;                     /* ACPI_OS_STALL_SPIN_US in absolute time */
+
+/* Value * Numer / Denom becomes (Value * mult) >> shift, with the largest shift that fits */
+static void
+AcpiOsInitializeScale(struct _acpi_os_scale *Scale, UInt64 Numer, UInt64 Denom)
+{
+    UInt32 shift = 63;
+    
+    while (shift && ((__uint128_t)Numer << shift) / Denom >= (1ULL << 63)) {
+        shift--;
+    }
+    Scale->mult = (UInt64)(((__uint128_t)Numer << shift) / Denom);
+    Scale->shift = shift;
+}
+
+static inline UInt64
+AcpiOsScale(const struct _acpi_os_scale *Scale, UInt64 Value)
+{
+    return (UInt64)(((__uint128_t)Value * Scale->mult) >> Scale->shift);
+}
+
+static void
+AcpiOsInitializeTimer(void)
+{
+    mach_timebase_info_data_t timebase;
+    
+    clock_timebase_info(&timebase);
+    AcpiOsInitializeScale(&gAcpiOsTimerScale, timebase.numer, (UInt64)timebase.denom * 100);
+    AcpiOsInitializeScale(&gAcpiOsStallScale, (UInt64)timebase.denom * NSEC_PER_USEC, timebase.numer);
+    gAcpiOsStallSpin = AcpiOsScale(&gAcpiOsStallScale, ACPI_OS_STALL_SPIN_US);
+}
+
+void AcpiOsSleep(UINT64 ms)
+{
+    if (ms == 0) {
+        thread_block(THREAD_CONTINUE_NULL);     /* nothing asserted, so just yield */
+    } else if (ms <= ACPI_OS_SLEEP_PRECISE_MS) {
+        IOSleepWithLeeway((UInt32)ms, 0);
+    } else {
+        IOSleep((UInt32)ACPI_MIN(ms, ACPI_UINT32_MAX));
+    }
+}
+
+void AcpiOsStall(UINT32 us)
+{
+    UInt64 deadline = mach_absolute_time() + AcpiOsScale(&gAcpiOsStallScale, us);
+    
+    if (us > ACPI_OS_STALL_SPIN_US && ml_get_interrupts_enabled() && !ml_at_interrupt_context()) {
+        /* Nobody wakes this event; the deadline does */
+        assert_wait_deadline((event_t)&deadline, THREAD_UNINT, deadline - gAcpiOsStallSpin);
+        thread_block(THREAD_CONTINUE_NULL);
+    }
+    
+    while (mach_absolute_time() < deadline) {
+        __asm__ volatile("pause" ::: "memory");
+    }
+}
+
+/* The current value of the system timer in 100-nanosecond units */
+UINT64 AcpiOsGetTimer(void)
+{
+    return AcpiOsScale(&gAcpiOsTimerScale, mach_absolute_time());
+}
+
+#pragma mark Lock functions
+
+/*
+ * ACPICA's spinlocks (GPE, hardware, reference count) are ticket locks, so
+ * CPUs get the lock in the order they asked for it and a GPE storm can't
+ * starve a method waiting on the hardware lock. Interrupts go off before a
+ * ticket is taken; the state they were in is returned as the lock's flags
+ * and put back on release, so a caller that already had them masked (the
+ * SCI handler) still has them masked afterwards.
+ *
+ * With acpi_lockstat=1 every lock also counts, in log2 buckets of absolute
+ * time, how long it was held and how long contended acquirers spun. See
+ * AcpiOsPrintLockStatistics.
+ */
+#define ACPI_OS_LOCK_BUCKETS        16
+#define ACPI_OS_LOCK_BUCKET_SHIFT   6           /* bucket 0 is everything under 64 */
+
+struct _acpi_os_lock
+{
+    volatile UINT32 next;                       /* next ticket to hand out */
+    volatile UINT32 owner;                      /* ticket being served */
+    struct _acpi_os_lock *link;                 /* gAcpiOsLocks */
+
+    /* Statistics, updated by the holder */
+    UINT64 acquired;                            /* mach_absolute_time() at acquire */
+    UINT64 acquisitions;
+    UINT64 contended;                           /* acquisitions that had to spin */
+    UINT32 max_waiters;                         /* most CPUs seen queued ahead */
+    UINT64 hold[ACPI_OS_LOCK_BUCKETS];
+    UINT64 wait[ACPI_OS_LOCK_BUCKETS];
+};
+
+static UInt32 gAcpiOsLockStats;
+static IOSimpleLock *gAcpiOsLockListLock;
+static struct _acpi_os_lock *gAcpiOsLocks;
+
+static void
+AcpiOsInitializeLocks(void)
+{
+    PE_parse_boot_argn("acpi_lockstat", &gAcpiOsLockStats, sizeof(UInt32));
+    gAcpiOsLockListLock = IOSimpleLockAlloc();
+}
+
+static UINT32
+AcpiOsLockBucket(UINT64 Delta)
+{
+    UINT32 bits = Delta ? 64 - __builtin_clzll(Delta) : 0;
+    
+    if (bits <= ACPI_OS_LOCK_BUCKET_SHIFT) {
+        return 0;
+    }
+    return ACPI_MIN(bits - ACPI_OS_LOCK_BUCKET_SHIFT, ACPI_OS_LOCK_BUCKETS - 1);
+}
+
+ACPI_STATUS AcpiOsCreateLock(ACPI_SPINLOCK *Lock)
+{
+    struct _acpi_os_lock *lock;
+    
+    if (!Lock) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    lock = IOMalloc(sizeof(struct _acpi_os_lock));
+    if (!lock) {
+        return AE_NO_MEMORY;
+    }
+    bzero(lock, sizeof(struct _acpi_os_lock));
+    
+    if (gAcpiOsLockListLock) {
+        IOSimpleLockLock(gAcpiOsLockListLock);
+        lock->link = gAcpiOsLocks;
+        gAcpiOsLocks = lock;
+        IOSimpleLockUnlock(gAcpiOsLockListLock);
+    }
+    
+    *Lock = lock;
+    
+    return AE_OK;
+};
+
+void AcpiOsDeleteLock(ACPI_SPINLOCK Lock)
+{
+    struct _acpi_os_lock **link;
+    
+    if (!Lock) {
+        return;
+    }
+    
+    if (gAcpiOsLockListLock) {
+        IOSimpleLockLock(gAcpiOsLockListLock);
+        for (link = &gAcpiOsLocks; *link; link = &(*link)->link) {
+            if (*link == Lock) {
+                *link = Lock->link;
+                break;
+            }
+        }
+        IOSimpleLockUnlock(gAcpiOsLockListLock);
+    }
+    
+    IOFree(Lock, sizeof(struct _acpi_os_lock));
+}
+
+/* 'May be called from interrupt handlers, GPE handlers, and Fixed event handlers.' */
+ACPI_CPU_FLAGS AcpiOsAcquireLock(ACPI_SPINLOCK Lock)
+{
+    boolean_t istate = ml_set_interrupts_enabled(FALSE);
+    UINT32 ticket = (UINT32)OSIncrementAtomic((volatile SInt32 *)&Lock->next);
+    /* Acquire loads: nothing in the critical section is read before our ticket comes up */
+    UINT32 owner = __atomic_load_n(&Lock->owner, __ATOMIC_ACQUIRE);
+    
+    if (owner != ticket) {
+        UINT32 waiters = ticket - owner;
+        UINT64 start = gAcpiOsLockStats ? mach_absolute_time() : 0;
+        
+        while (__atomic_load_n(&Lock->owner, __ATOMIC_ACQUIRE) != ticket) {
+            __asm__ volatile("pause" ::: "memory");
+        }
+        
+        if (gAcpiOsLockStats) {
+            Lock->contended++;
+            Lock->wait[AcpiOsLockBucket(mach_absolute_time() - start)]++;
+            if (waiters > Lock->max_waiters) {
+                Lock->max_waiters = waiters;
+            }
+        }
+    }
+    
+    if (gAcpiOsLockStats) {
+        Lock->acquisitions++;
+        Lock->acquired = mach_absolute_time();
+    }
+    
+    return istate;
+}
+
+void AcpiOsReleaseLock(ACPI_SPINLOCK Lock, ACPI_CPU_FLAGS Flags)
+{
+    if (gAcpiOsLockStats) {
+        Lock->hold[AcpiOsLockBucket(mach_absolute_time() - Lock->acquired)]++;
+    }
+    
+    /* Full barrier: the critical section is visible before the next ticket is served */
+    OSIncrementAtomic((volatile SInt32 *)&Lock->owner);
+    ml_set_interrupts_enabled((boolean_t)Flags);
+}
+
+static void
+AcpiOsPrintLockHistogram(const char *Name, const UINT64 *Buckets)
+{
+    UInt64 ns;
+    
+    AcpiOsPrintf("ACPI:   %s", Name);
+    for (UINT32 i = 0; i < ACPI_OS_LOCK_BUCKETS; i++) {
+        if (!Buckets[i]) {
+            continue;
+        }
+        if (i == ACPI_OS_LOCK_BUCKETS - 1) {
+            absolutetime_to_nanoseconds(1ULL << (i + ACPI_OS_LOCK_BUCKET_SHIFT - 1), &ns);
+            AcpiOsPrintf(" >=%lluns:%llu", ns, Buckets[i]);
+        } else {
+            absolutetime_to_nanoseconds(1ULL << (i + ACPI_OS_LOCK_BUCKET_SHIFT), &ns);
+            AcpiOsPrintf(" <%lluns:%llu", ns, Buckets[i]);
+        }
+    }
+    AcpiOsPrintf("\n");
+}
+
+/* AcpiOsPrintLockStatistics (Debug helper) - Hold and wait histograms per spinlock (acpi_lockstat=1) */
+void
+AcpiOsPrintLockStatistics(void)
+{
+    if (!gAcpiOsLockStats || !gAcpiOsLockListLock) {
+        AcpiOsPrintf("ACPI: Lock statistics are off; boot with acpi_lockstat=1\n");
+        return;
+    }
+    
+    IOSimpleLockLock(gAcpiOsLockListLock);
+    for (struct _acpi_os_lock *lock = gAcpiOsLocks; lock; lock = lock->link) {
+        AcpiOsPrintf("ACPI: Lock %p %llu acquisitions, %llu contended, at most %u waiting\n",
+                     lock, lock->acquisitions, lock->contended, lock->max_waiters);
+        if (lock->acquisitions) {
+            AcpiOsPrintLockHistogram("hold", lock->hold);
+            AcpiOsPrintLockHistogram("wait", lock->wait);
+        }
+    }
+    IOSimpleLockUnlock(gAcpiOsLockListLock);
+}
+
+#pragma mark Semaphore code
+
+/*
+ * ACPICA semaphores back every AML Mutex and AcpiUtAcquireMutex, and are
+ * almost never contended, so units are an atomic count: a wait that finds
+ * enough units takes them with one compare-and-swap and a signal with no
+ * sleepers is one atomic add. Only a wait that comes up short takes the
+ * semaphore's IOLock, and it spins for a while first in case the holder is
+ * about to let go. The spin budget adapts per semaphore: it doubles when
+ * spinning paid off and halves when the waiter had to sleep anyway, and it
+ * is zero on a uniprocessor, where the holder can't run while we spin.
+ *
+ * waiters is raised before the count is checked under the lock, and a
+ * signal reads it after adding its units, so one of the two always sees the
+ * other. A one-unit signal wakes one sleeper; a wider signal, or one made
+ * while some sleeper wants more than a unit, wakes them all to sort it out.
+ */
+#define ACPI_OS_SEMAPHORE_SPIN_MIN  16
+#define ACPI_OS_SEMAPHORE_SPIN_MAX  4096
+
+struct _acpi_os_semaphore
+{
+    volatile UInt32 units;                      /* units available */
+    UInt32 max_units;                           /* ACPI_NO_UNIT_LIMIT (all ones) if unbounded */
+    volatile SInt32 waiters;                    /* threads in the slow path */
+    volatile SInt32 multi_waiters;              /* ... of which want more than one unit */
+    volatile UINT32 spin;                       /* current spin budget, in pause loops */
+    IOLock *lock;                               /* sleepers wait on &units */
+};
+
+static UINT32 gAcpiOsSemaphoreSpin;             /* spin ceiling, 0 on a uniprocessor */
+
+static void
+AcpiOsInitializeSemaphores(void)
+{
+    gAcpiOsSemaphoreSpin = ml_get_max_cpus() > 1 ? ACPI_OS_SEMAPHORE_SPIN_MAX : 0;
+}
+
+static BOOLEAN
+AcpiOsSemaphoreTake(struct _acpi_os_semaphore *sem, UInt32 Units)
+{
+    UInt32 units = sem->units;
+    
+    while (units >= Units) {
+        if (OSCompareAndSwap(units, units - Units, &sem->units)) {
+            return TRUE;
+        }
+        units = sem->units;
+    }
+    return FALSE;
+}
+
+/* Spin while the count is short, in the hope that the holder signals before the budget runs out */
+static BOOLEAN
+AcpiOsSemaphoreSpin(struct _acpi_os_semaphore *sem, UInt32 Units)
+{
+    UINT32 budget = sem->spin;
+    
+    for (UINT32 i = 0; i < budget; i++) {
+        if (sem->units >= Units && AcpiOsSemaphoreTake(sem, Units)) {
+            if (budget < gAcpiOsSemaphoreSpin) {
+                sem->spin = budget * 2;
+            }
+            return TRUE;
+        }
+        __asm__ volatile("pause" ::: "memory");
+    }
+    if (budget > ACPI_OS_SEMAPHORE_SPIN_MIN) {
+        sem->spin = budget / 2;
+    }
+    return FALSE;
+}
+
+ACPI_STATUS AcpiOsCreateSemaphore(UInt32 MaxUnits, UInt32 InitialUnits, ACPI_SEMAPHORE *Handle)
+{
+    struct _acpi_os_semaphore *sem;
+    
+    if (Handle == NULL || InitialUnits > MaxUnits) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    sem = IOMalloc(sizeof(struct _acpi_os_semaphore));
+    if (!sem) {
+        return AE_NO_MEMORY;
+    }
+    bzero(sem, sizeof(struct _acpi_os_semaphore));
+    
+    sem->lock = IOLockAlloc();
+    if (!sem->lock) {
+        IOFree(sem, sizeof(struct _acpi_os_semaphore));
+        return AE_NO_MEMORY;
+    }
+    sem->units = InitialUnits;
+    sem->max_units = MaxUnits;
+    sem->spin = gAcpiOsSemaphoreSpin ? ACPI_OS_SEMAPHORE_SPIN_MIN : 0;
+    
+    *Handle = sem;
+    
+    return AE_OK;
+}
+
+ACPI_STATUS AcpiOsDestroySemaphore(ACPI_SEMAPHORE Semaphore)
+{
+    if (Semaphore == NULL) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    IOLockFree(Semaphore->lock);
+    IOFree(Semaphore, sizeof(struct _acpi_os_semaphore));
+    
+    return AE_OK;
+}
+
+ACPI_STATUS AcpiOsDeleteSemaphore(ACPI_SEMAPHORE Handle)
+{
+    return AcpiOsDestroySemaphore(Handle);
+}
+
+ACPI_STATUS AcpiOsWaitSemaphore(ACPI_SEMAPHORE Semaphore, UInt32 Units, UInt16 Timeout)
+{
+    ACPI_STATUS status = AE_OK;
+    UInt64 deadline = 0;
+    int result;
+    
+    if (Semaphore == NULL || Units == 0) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    if (AcpiOsSemaphoreTake(Semaphore, Units)) {
+        return AE_OK;
+    }
+    if (Timeout == 0) {
+        return AE_TIME;
+    }
+    if (Semaphore->spin && AcpiOsSemaphoreSpin(Semaphore, Units)) {
+        return AE_OK;
+    }
+    
+    /* Timeout is relative milliseconds; the sleep wants an absolute deadline */
+    if (Timeout != ACPI_WAIT_FOREVER) {
+        clock_interval_to_deadline(Timeout, kMillisecondScale, &deadline);
+    }
+    
+    IOLockLock(Semaphore->lock);
+    OSIncrementAtomic(&Semaphore->waiters);
+    if (Units > 1) {
+        OSIncrementAtomic(&Semaphore->multi_waiters);
+    }
+    
+    while (!AcpiOsSemaphoreTake(Semaphore, Units)) {
+        if (Timeout == ACPI_WAIT_FOREVER) {
+            IOLockSleep(Semaphore->lock, (void *)&Semaphore->units, THREAD_UNINT);
+            continue;
+        }
+        result = IOLockSleepDeadline(Semaphore->lock, (void *)&Semaphore->units, deadline, THREAD_UNINT);
+        if (result == THREAD_TIMED_OUT) {
+            if (!AcpiOsSemaphoreTake(Semaphore, Units)) {
+                status = AE_TIME;
+            }
+            break;
+        }
+    }
+    
+    if (Units > 1) {
+        OSDecrementAtomic(&Semaphore->multi_waiters);
+    }
+    OSDecrementAtomic(&Semaphore->waiters);
+    IOLockUnlock(Semaphore->lock);
+    
+    return status;
+}
+
+ACPI_STATUS AcpiOsSignalSemaphore(ACPI_SEMAPHORE Semaphore, UInt32 Units)
+{
+    UInt32 units;
+    
+    if (Semaphore == NULL || Units == 0) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    /* Add the units, refusing to go past the limit the semaphore was created with */
+    do {
+        units = Semaphore->units;
+        if (Units > Semaphore->max_units - units) {
+            return AE_LIMIT;
+        }
+    } while (!OSCompareAndSwap(units, units + Units, &Semaphore->units));
+    
+    if (Semaphore->waiters == 0) {
+        return AE_OK;
+    }
+    
+    IOLockLock(Semaphore->lock);
+    if (Units == 1 && Semaphore->multi_waiters == 0) {
+        IOLockWakeup(Semaphore->lock, (void *)&Semaphore->units, true);
+    } else {
+        IOLockWakeup(Semaphore->lock, (void *)&Semaphore->units, false);
+    }
+    IOLockUnlock(Semaphore->lock);
+    
+    return AE_OK;
+}
+
+
+#pragma mark Cache management functions
+
+/* adjustments by csekel (InSaneDarwin)
+ * ACPICA Object Cache Implementation for Darwin
+ * 
+ * ACPICA uses object caching to improve performance by reusing frequently
+ * allocated/freed objects like parse tree nodes, namespace entries, etc.
+ *
+ * Each CPU keeps a small magazine of free objects that it acquires from and
+ * releases to with interrupts disabled and no lock held. Only when its
+ * magazine runs empty or full does a CPU take the cache lock, and then it
+ * moves ACPI_CACHE_BATCH objects at once between the magazine and the depot.
+ * The depot is a LIFO list of free objects carved out of naturally aligned
+ * slabs. When the depot holds more than MaxDepth objects, slabs whose objects
+ * are all back in the depot are returned to the kernel.
+ */
+
+/* Take the depot lock (interrupts must be disabled), counting contention. */
+static void
+AcpiOsCacheLockDepot(struct _acpi_cache *cache)
+{
+    if (!IOSimpleLockTryLock(cache->lock)) {
+        IOSimpleLockLock(cache->lock);
+        cache->contended++;
+    }
+}
+
+/*
+ * Detach fully free slabs until the depot is down to Keep objects and return
+ * them as a list. The caller frees them once interrupts are enabled again.
+ */
+static struct _acpi_cache_slab *
+AcpiOsCacheReclaim(struct _acpi_cache *cache, UINT32 Keep)
+{
+    struct _acpi_cache_slab **link = &cache->slabs;
+    struct _acpi_cache_slab *victims = NULL;
+    struct _cache_object **object;
+    
+    while (*link && cache->empty_slabs && cache->current_depth > Keep) {
+        struct _acpi_cache_slab *slab = *link;
+        
+        if (slab->free != cache->slab_objects) {
+            link = &slab->next;
+            continue;
+        }
+        
+        /* A slab with none of its objects in the depot is never on the list below. */
+        *link = slab->next;
+        slab->free = 0;
+        slab->next = victims;
+        victims = slab;
+        cache->empty_slabs--;
+        cache->current_depth -= cache->slab_objects;
+        cache->total -= cache->slab_objects;
+    }
+    
+    if (victims) {
+        object = &cache->list_head;
+        while (*object) {
+            if (ACPI_CACHE_SLAB(cache, *object)->free == 0) {
+                *object = (*object)->next;
+            } else {
+                object = &(*object)->next;
+            }
+        }
+    }
+    
+    return victims;
+}
+
+static void
+AcpiOsCacheFreeSlabs(struct _acpi_cache *cache, struct _acpi_cache_slab *slab)
+{
+    struct _acpi_cache_slab *next;
+    
+    while (slab) {
+        next = slab->next;
+        IOFreeAligned(slab, cache->slab_size);
+        slab = next;
+    }
+}
+
+/* Move up to ACPI_CACHE_BATCH objects from the depot into an empty magazine. */
+static BOOLEAN
+AcpiOsCacheRefill(struct _acpi_cache *cache, struct _acpi_cache_cpu *cpu)
+{
+    struct _cache_object *object;
+    struct _acpi_cache_slab *slab;
+    
+    AcpiOsCacheLockDepot(cache);
+    
+    while (cpu->rounds < ACPI_CACHE_BATCH && cache->list_head) {
+        object = cache->list_head;
+        cache->list_head = object->next;
+        cache->current_depth--;
+        
+        slab = ACPI_CACHE_SLAB(cache, object);
+        if (slab->free-- == cache->slab_objects) {
+            cache->empty_slabs--;
+        }
+        
+        cpu->objects[cpu->rounds++] = object;
+    }
+    
+    IOSimpleLockUnlock(cache->lock);
+    
+    return cpu->rounds != 0;
+}
+
+/* Move the Count oldest objects of a magazine to the depot. */
+static struct _acpi_cache_slab *
+AcpiOsCacheFlush(struct _acpi_cache *cache, struct _acpi_cache_cpu *cpu, UINT32 Count)
+{
+    struct _cache_object *object;
+    struct _acpi_cache_slab *slab;
+    struct _acpi_cache_slab *victims = NULL;
+    
+    AcpiOsCacheLockDepot(cache);
+    
+    for (UINT32 i = 0; i < Count; i++) {
+        object = (struct _cache_object *)cpu->objects[i];
+        object->next = cache->list_head;
+        cache->list_head = object;
+        cache->current_depth++;
+        
+        slab = ACPI_CACHE_SLAB(cache, object);
+        if (++slab->free == cache->slab_objects) {
+            cache->empty_slabs++;
+        }
+    }
+    
+    if (cache->empty_slabs && cache->current_depth > cache->max_depth) {
+        victims = AcpiOsCacheReclaim(cache, cache->max_depth);
+    }
+    
+    IOSimpleLockUnlock(cache->lock);
+    
+    cpu->rounds -= Count;
+    memmove(&cpu->objects[0], &cpu->objects[Count], cpu->rounds * sizeof(void *));
+    
+    return victims;
+}
+
+/* Add a fresh slab to the depot. */
+static ACPI_STATUS
+AcpiOsCacheGrow(struct _acpi_cache *cache)
+{
+    struct _acpi_cache_slab *slab;
+    struct _cache_object *first = NULL, *object;
+    boolean_t istate;
+    
+    slab = (struct _acpi_cache_slab *)IOMallocAligned(cache->slab_size, cache->slab_size);
+    if (!slab) {
+        return AE_NO_MEMORY;
+    }
+    
+    slab->magic = ACPI_CACHE_SLAB_MAGIC;
+    slab->free = cache->slab_objects;
+    slab->cache = cache;
+    
+    /* Chain the objects up front to first, outside the lock. */
+    for (UINT32 i = cache->slab_objects; i-- > 0; ) {
+        object = (struct _cache_object *)((char *)slab + ACPI_CACHE_SLAB_HEADER + i * cache->object_stride);
+        object->next = first;
+        first = object;
+    }
+    object = (struct _cache_object *)((char *)slab + ACPI_CACHE_SLAB_HEADER +
+                                      (cache->slab_objects - 1) * cache->object_stride);
+    
+    istate = ml_set_interrupts_enabled(FALSE);
+    AcpiOsCacheLockDepot(cache);
+    
+    slab->next = cache->slabs;
+    cache->slabs = slab;
+    object->next = cache->list_head;
+    cache->list_head = first;
+    cache->current_depth += cache->slab_objects;
+    cache->empty_slabs++;
+    cache->total += cache->slab_objects;
+    if (cache->total > cache->high_water) {
+        cache->high_water = cache->total;
+    }
+    
+    IOSimpleLockUnlock(cache->lock);
+    ml_set_interrupts_enabled(istate);
+    
+    return AE_OK;
+}
+
+/* Fill in a cache; shared by AcpiOsCreateCache and the AcpiOsAllocate size classes. */
+static ACPI_STATUS
+AcpiOsCacheSetup(struct _acpi_cache *cache, const char *Name, ACPI_SIZE ObjectSize, UINT16 MaxDepth)
+{
+    memset(cache, 0, sizeof(struct _acpi_cache));
+    strncpy(cache->name, Name, sizeof(cache->name) - 1);
+    cache->name[sizeof(cache->name) - 1] = '\0';
+    cache->object_size = ObjectSize;
+    cache->max_depth = MaxDepth;
+    
+    /* Slabs are a power of two in size so an object finds its slab by masking. */
+    cache->object_stride = ACPI_ROUND_UP(ACPI_MAX(ObjectSize, sizeof(struct _cache_object)), sizeof(UINT64));
+    cache->slab_size = PAGE_SIZE;
+    while (cache->slab_size < ACPI_CACHE_SLAB_HEADER + ACPI_CACHE_SLAB_MIN_OBJECTS * cache->object_stride) {
+        cache->slab_size <<= 1;
+    }
+    cache->slab_objects = (UINT32)((cache->slab_size - ACPI_CACHE_SLAB_HEADER) / cache->object_stride);
+    
+    /* One magazine per CPU */
+    cache->ncpus = ml_get_max_cpus();
+    cache->cpus = (struct _acpi_cache_cpu *)IOMallocAligned(cache->ncpus * sizeof(struct _acpi_cache_cpu),
+                                                            ACPI_CACHE_LINE_SIZE);
+    if (!cache->cpus) {
+        return AE_NO_MEMORY;
+    }
+    memset(cache->cpus, 0, cache->ncpus * sizeof(struct _acpi_cache_cpu));
+    
+    /* Create lock for the depot */
+    cache->lock = IOSimpleLockAlloc();
+    if (!cache->lock) {
+        IOFreeAligned(cache->cpus, cache->ncpus * sizeof(struct _acpi_cache_cpu));
+        return AE_NO_MEMORY;
+    }
+    
+    cache->magic = ACPI_CACHE_MAGIC;
+    return AE_OK;
+}
+
+/* Release everything a cache owns, wherever its objects are cached. */
+static void
+AcpiOsCacheTeardown(struct _acpi_cache *cache)
+{
+    AcpiOsCacheFreeSlabs(cache, cache->slabs);
+    IOFreeAligned(cache->cpus, cache->ncpus * sizeof(struct _acpi_cache_cpu));
+    IOSimpleLockFree(cache->lock);
+    cache->magic = 0; /* Invalidate */
+}
+
+/* Take an object off this CPU's magazine, refilling or growing as needed. Not cleared. */
+static void *
+AcpiOsCacheAlloc(struct _acpi_cache *cache, ACPI_SIZE Bytes)
+{
+    struct _acpi_cache_cpu *cpu;
+    void *object;
+    BOOLEAN grown = FALSE;
+    boolean_t istate;
+    
+    for (;;) {
+        istate = ml_set_interrupts_enabled(FALSE);
+        cpu = &cache->cpus[cpu_number()];
+        
+        if (cpu->rounds || AcpiOsCacheRefill(cache, cpu)) {
+            object = cpu->objects[--cpu->rounds];
+            cpu->requests++;
+            cpu->bytes += Bytes;
+            if (!grown) {
+                cpu->hits++;
+            }
+            ml_set_interrupts_enabled(istate);
+            return object;
+        }
+        
+        ml_set_interrupts_enabled(istate);
+        
+        /* Depot is empty, add a slab and try again */
+        if (ACPI_FAILURE(AcpiOsCacheGrow(cache))) {
+            return NULL;
+        }
+        grown = TRUE;
+    }
+}
+
+/* Put an object on this CPU's magazine, handing the older half to the depot if it is full. */
+static void
+AcpiOsCacheFree(struct _acpi_cache *cache, void *Object)
+{
+    struct _acpi_cache_cpu *cpu;
+    struct _acpi_cache_slab *victims = NULL;
+    boolean_t istate;
+    
+    istate = ml_set_interrupts_enabled(FALSE);
+    cpu = &cache->cpus[cpu_number()];
+    
+    if (cpu->rounds == ACPI_CACHE_MAGAZINE_SIZE) {
+        victims = AcpiOsCacheFlush(cache, cpu, ACPI_CACHE_BATCH);
+    }
+    cpu->objects[cpu->rounds++] = Object;
+    cpu->releases++;
+    
+    ml_set_interrupts_enabled(istate);
+    
+    AcpiOsCacheFreeSlabs(cache, victims);
+}
+
+#ifndef ACPI_USE_LOCAL_CACHE
+
+/* AcpiOsCreateCache - Create a cache object for ACPICA */
 ACPI_STATUS
 AcpiOsCreateCache(char *CacheName,
                   UINT16 ObjectSize,
@@ -845,21 +1836,7 @@ AcpiOsCreateCache(char *CacheName,
         return AE_NO_MEMORY;
     }
     
-    /* Initialize cache structure */
-    memset(cache, 0, sizeof(struct _acpi_cache));
-    cache->magic = ACPI_CACHE_MAGIC;
-    strncpy(cache->name, CacheName, sizeof(cache->name) - 1);
-    cache->name[sizeof(cache->name) - 1] = '\0';
-    cache->object_size = ObjectSize;
-    cache->max_depth = MaxDepth;
-    cache->current_depth = 0;
-    cache->list_head = NULL;
-    cache->requests = 0;
-    cache->hits = 0;
-    
-    /* Create lock for thread safety */
-    cache->lock = IOSimpleLockAlloc();
-    if (!cache->lock) {
+    if (ACPI_FAILURE(AcpiOsCacheSetup(cache, CacheName, ObjectSize, MaxDepth))) {
         IOFree(cache, sizeof(struct _acpi_cache));
         return AE_NO_MEMORY;
     }
@@ -867,8 +1844,8 @@ AcpiOsCreateCache(char *CacheName,
     *ReturnCache = (ACPI_CACHE_T *)cache;
     
 #if DEBUG
-    AcpiOsPrintf("ACPI: Created cache '%s', object size %d, max depth %d\n",
-                 CacheName, ObjectSize, MaxDepth);
+    AcpiOsPrintf("ACPI: Created cache '%s', object size %d, max depth %d, %u objects per slab\n",
+                 CacheName, ObjectSize, MaxDepth, cache->slab_objects);
 #endif
     
     return AE_OK;
@@ -878,160 +1855,372 @@ AcpiOsCreateCache(char *CacheName,
 ACPI_STATUS
 AcpiOsDeleteCache(ACPI_CACHE_T *Cache)
 {
-    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
-    struct _cache_object *object, *next;
+    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
+    
+    if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
+        return AE_BAD_PARAMETER;
+    }
+    
+#if DEBUG
+    UINT32 requests, hits;
+    
+    AcpiOsCacheCounters(cache, &requests, &hits);
+    AcpiOsPrintf("ACPI: Deleting cache '%s', requests %u, hits %u (%.1f%%), high water %u, %u contended\n",
+                 cache->name, requests, hits,
+                 requests ? (hits * 100.0 / requests) : 0.0,
+                 cache->high_water, cache->contended);
+#endif
+    
+    AcpiOsCacheTeardown(cache);
+    IOFree(cache, sizeof(struct _acpi_cache));
+    
+    return AE_OK;
+}
+
+/* AcpiOsPurgeCache - Free all objects within a cache */
+ACPI_STATUS
+AcpiOsPurgeCache(ACPI_CACHE_T *Cache)
+{
+    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
+    struct _acpi_cache_cpu *cpu;
+    struct _acpi_cache_slab *victims, *flushed;
+    boolean_t istate;
+    
+    if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    /*
+     * Only this CPU's magazine can be emptied from here; objects in the
+     * other magazines keep their slabs alive until they are flushed.
+     */
+    istate = ml_set_interrupts_enabled(FALSE);
+    cpu = &cache->cpus[cpu_number()];
+    flushed = AcpiOsCacheFlush(cache, cpu, cpu->rounds);
+    
+    AcpiOsCacheLockDepot(cache);
+    victims = AcpiOsCacheReclaim(cache, 0);
+    IOSimpleLockUnlock(cache->lock);
+    ml_set_interrupts_enabled(istate);
+    
+    AcpiOsCacheFreeSlabs(cache, flushed);
+    AcpiOsCacheFreeSlabs(cache, victims);
+    
+#if DEBUG
+    AcpiOsPrintf("ACPI: Purged cache '%s', %u objects left in slabs\n", cache->name, cache->total);
+#endif
+    
+    return AE_OK;
+}
+
+/* AcpiOsAcquireObject - Get an object from the cache or allocate a new one */
+void *
+AcpiOsAcquireObject(ACPI_CACHE_T *Cache)
+{
+    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
+    void *return_object;
+    
+    if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
+        return NULL;
+    }
+    
+    return_object = AcpiOsCacheAlloc(cache, cache->object_size);
+    if (!return_object) {
+        return NULL;
+    }
+    
+    /* Clear the object data */
+    memset(return_object, 0, cache->object_size);
+    
+    return return_object;
+}
+
+/* AcpiOsReleaseObject - Release an object back to the cache */
+ACPI_STATUS
+AcpiOsReleaseObject(ACPI_CACHE_T *Cache, void *Object)
+{
+    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
+    
+    /* Objects belong to their cache's slabs, so there is nothing to free here. */
+    if (!cache || cache->magic != ACPI_CACHE_MAGIC || !Object) {
+        return AE_BAD_PARAMETER;
+    }
+    
+    AcpiOsCacheFree(cache, Object);
+    
+    return AE_OK;
+}
+
+#endif /* ACPI_USE_LOCAL_CACHE */
+
+#pragma mark Memory allocation
+
+/*
+ * AcpiOsAllocate serves requests up to the largest size class from one
+ * object cache per class, so those allocations carry no header: the slabs
+ * of these caches are exactly one page and start with a header naming the
+ * cache, which AcpiOsFree finds by rounding the pointer down to its page.
+ * Larger requests, and any made before AcpiOsInitialize, get page aligned
+ * memory with a _memory_tag in front, which puts their header at the same
+ * place.
+ */
+
+static const UINT16 gAcpiOsSizeClassSize[] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1344, 2032
+};
+
+#define ACPI_OS_SIZE_CLASSES        ACPI_ARRAY_LENGTH(gAcpiOsSizeClassSize)
+#define ACPI_OS_SIZE_CLASS_MAX      2032
+#define ACPI_OS_SIZE_CLASS_SHIFT    4
+#define ACPI_OS_SIZE_CLASS_DEPTH    128
+#define ACPI_OS_PAGE_BASE(p)        ((void *)((uintptr_t)(p) & ~((uintptr_t)PAGE_SIZE - 1)))
+
+static struct _acpi_cache gAcpiOsSizeClass[ACPI_OS_SIZE_CLASSES];
+static UINT8 gAcpiOsSizeClassIndex[(ACPI_OS_SIZE_CLASS_MAX >> ACPI_OS_SIZE_CLASS_SHIFT) + 1];
+static BOOLEAN gAcpiOsSizeClassesReady = FALSE;
+static UInt64 gAcpiOsAllocatorStart;
+static volatile SInt64 gAcpiOsLargeAllocations;
+static volatile SInt64 gAcpiOsLargeFrees;
+static volatile SInt64 gAcpiOsLargeBytes;
+
+static void
+AcpiOsInitializeAllocator(void)
+{
+    char name[16];
+    UINT32 i, index = 0;
+    
+    if (gAcpiOsSizeClassesReady) {
+        return;
+    }
+    
+    for (i = 0; i < ACPI_OS_SIZE_CLASSES; i++) {
+        snprintf(name, sizeof(name), "Acpi-Alloc-%u", gAcpiOsSizeClassSize[i]);
+        if (ACPI_FAILURE(AcpiOsCacheSetup(&gAcpiOsSizeClass[i], name, gAcpiOsSizeClassSize[i], ACPI_OS_SIZE_CLASS_DEPTH))) {
+            break;
+        }
+        if (gAcpiOsSizeClass[i].slab_size != PAGE_SIZE) {
+            AcpiOsCacheTeardown(&gAcpiOsSizeClass[i]);
+            break;
+        }
+    }
+    
+    if (i != ACPI_OS_SIZE_CLASSES) {
+        /* Leave everything to the page aligned path */
+        while (i-- > 0) {
+            AcpiOsCacheTeardown(&gAcpiOsSizeClass[i]);
+        }
+        return;
+    }
+    
+    for (i = 0; i < ACPI_ARRAY_LENGTH(gAcpiOsSizeClassIndex); i++) {
+        while ((i << ACPI_OS_SIZE_CLASS_SHIFT) > gAcpiOsSizeClassSize[index]) {
+            index++;
+        }
+        gAcpiOsSizeClassIndex[i] = (UINT8)index;
+    }
+    
+    gAcpiOsAllocatorStart = mach_absolute_time();
+    gAcpiOsSizeClassesReady = TRUE;
+}
+
+void *
+AcpiOsAllocate(ACPI_SIZE Size)
+{
+    struct _memory_tag *mem;
+    
+    if (gAcpiOsSizeClassesReady && Size <= ACPI_OS_SIZE_CLASS_MAX) {
+        UINT8 class = gAcpiOsSizeClassIndex[(Size + (1 << ACPI_OS_SIZE_CLASS_SHIFT) - 1) >> ACPI_OS_SIZE_CLASS_SHIFT];
+        return AcpiOsCacheAlloc(&gAcpiOsSizeClass[class], Size);
+    }
+    
+    mem = (struct _memory_tag *)IOMallocAligned(Size + sizeof(struct _memory_tag), PAGE_SIZE);
+    if (!mem) {
+        return NULL;
+    }
+    mem->magic = ACPI_MEMORY_TAG_MAGIC;
+    mem->size = Size + sizeof(struct _memory_tag);
+    
+    OSIncrementAtomic64(&gAcpiOsLargeAllocations);
+    OSAddAtomic64(Size, &gAcpiOsLargeBytes);
+    
+    return (mem + 1);
+}
+
+void *
+AcpiOsAllocateZeroed(ACPI_SIZE Size)
+{
+    void *alloc = AcpiOsAllocate(Size);
+    if (alloc) {
+        memset(alloc, 0, Size);
+    }
+    return alloc;
+}
+
+void
+AcpiOsFree(void *p)
+{
+    struct _acpi_cache_slab *slab = ACPI_OS_PAGE_BASE(p);
+    struct _memory_tag *m = ACPI_OS_PAGE_BASE(p);
+    
+    if (!p) {
+        return;
+    }
+    
+    if (slab->magic == ACPI_CACHE_SLAB_MAGIC) {
+        AcpiOsCacheFree(slab->cache, p);
+    } else if (m->magic == ACPI_MEMORY_TAG_MAGIC && (void *)(m + 1) == p) {
+        OSIncrementAtomic64(&gAcpiOsLargeFrees);
+        IOFreeAligned(m, m->size);
+    } else {
+        /* induce panic? */
+        return;
+    }
+}
+
+/* AcpiOsPrintAllocatorStatistics (Debug helper) - Allocation rate and fragmentation of AcpiOsAllocate */
+void
+AcpiOsPrintAllocatorStatistics(void)
+{
+    UInt64 elapsed = 0;
+    UINT64 allocations = 0;
     
-    if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
-        return AE_BAD_PARAMETER;
+    if (!gAcpiOsSizeClassesReady) {
+        return;
     }
     
-#if DEBUG
-    AcpiOsPrintf("ACPI: Deleting cache '%s', requests %u, hits %u (%.1f%%)\n",
-                 cache->name, cache->requests, cache->hits,
-                 cache->requests ? (cache->hits * 100.0 / cache->requests) : 0.0);
-#endif
-    
-    /* Purge all objects from cache */
-    IOSimpleLockLock(cache->lock);
+    absolutetime_to_nanoseconds(mach_absolute_time() - gAcpiOsAllocatorStart, &elapsed);
     
-    object = cache->list_head;
-    while (object) {
-        next = object->next;
-        IOFree(object, sizeof(struct _cache_object) + cache->object_size);
-        object = next;
+    for (UINT32 i = 0; i < ACPI_OS_SIZE_CLASSES; i++) {
+        struct _acpi_cache *cache = &gAcpiOsSizeClass[i];
+        UINT64 requests = 0, releases = 0, bytes = 0;
+        UINT32 live, used, rounding;
+        
+        for (UINT32 cpu = 0; cpu < cache->ncpus; cpu++) {
+            requests += cache->cpus[cpu].requests;
+            releases += cache->cpus[cpu].releases;
+            bytes += cache->cpus[cpu].bytes;
+        }
+        allocations += requests;
+        
+        if (!requests) {
+            continue;
+        }
+        
+        /* Slab space not in use, and the share of handed out bytes lost to rounding up to the class */
+        live = (UINT32)(requests - releases);
+        used = cache->total ? (UINT32)(((UINT64)live * 100) / cache->total) : 0;
+        rounding = (UINT32)(100 - (bytes * 100) / (requests * cache->object_size));
+        
+        AcpiOsPrintf("ACPI: %-15s %llu allocs, %llu frees, %u live of %u in slabs (%u%% used), "
+                     "%u%% lost to rounding, high water %u, %u contended\n",
+                     cache->name, requests, releases, live, cache->total, used,
+                     rounding, cache->high_water, cache->contended);
     }
     
-    IOSimpleLockUnlock(cache->lock);
-    
-    /* Free the lock and cache structure */
-    IOSimpleLockFree(cache->lock);
-    cache->magic = 0; /* Invalidate */
-    IOFree(cache, sizeof(struct _acpi_cache));
+    allocations += gAcpiOsLargeAllocations;
     
-    return AE_OK;
+    AcpiOsPrintf("ACPI: Large allocations: %lld, %lld frees, %lld bytes\n",
+                 gAcpiOsLargeAllocations, gAcpiOsLargeFrees, gAcpiOsLargeBytes);
+    AcpiOsPrintf("ACPI: %llu allocations in %llu ms (%llu per second)\n",
+                 allocations, elapsed / NSEC_PER_MSEC,
+                 elapsed ? (allocations * NSEC_PER_SEC) / elapsed : 0);
 }
 
-/* AcpiOsPurgeCache - Free all objects within a cache */
+#pragma mark Scratch arenas
+
+/*
+ * A scratch arena hands out memory for work bounded by one method
+ * invocation and gives all of it back with a single AcpiOsReleaseScratch.
+ * Nothing from an arena may reach AcpiOsFree or end up in an ACPICA object,
+ * as those can outlive the invocation, so the interpreter itself keeps to
+ * AcpiOsAllocate; arenas are for callers marshalling arguments and results
+ * around an evaluation.
+ */
+struct _acpi_scratch_chunk {
+    struct _acpi_scratch_chunk *next;
+    ACPI_SIZE size;
+};
+
+struct _acpi_scratch {
+    UINT32 magic;
+    struct _acpi_scratch_chunk *chunks;
+    char *next;
+    char *end;
+};
+
+#define ACPI_SCRATCH_MAGIC          'scra'
+#define ACPI_SCRATCH_CHUNK_SIZE     (4 * PAGE_SIZE)
+#define ACPI_SCRATCH_HEADER         ACPI_ROUND_UP(sizeof(struct _acpi_scratch_chunk), sizeof(UINT64))
+
 ACPI_STATUS
-AcpiOsPurgeCache(ACPI_CACHE_T *Cache)
+AcpiOsCreateScratch(void **ReturnArena)
 {
-    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
-    struct _cache_object *object, *next;
-    UINT16 purged = 0;
+    struct _acpi_scratch *arena;
     
-    if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
+    if (!ReturnArena) {
         return AE_BAD_PARAMETER;
     }
     
-    IOSimpleLockLock(cache->lock);
-    
-    object = cache->list_head;
-    while (object) {
-        next = object->next;
-        IOFree(object, sizeof(struct _cache_object) + cache->object_size);
-        object = next;
-        purged++;
+    arena = (struct _acpi_scratch *)IOMalloc(sizeof(struct _acpi_scratch));
+    if (!arena) {
+        return AE_NO_MEMORY;
     }
     
-    cache->list_head = NULL;
-    cache->current_depth = 0;
-    
-    IOSimpleLockUnlock(cache->lock);
-    
-#if DEBUG
-    AcpiOsPrintf("ACPI: Purged %d objects from cache '%s'\n", purged, cache->name);
-#endif
+    memset(arena, 0, sizeof(struct _acpi_scratch));
+    arena->magic = ACPI_SCRATCH_MAGIC;
     
+    *ReturnArena = arena;
     return AE_OK;
 }
 
-/* AcpiOsAcquireObject - Get an object from the cache or allocate a new one */
 void *
-AcpiOsAcquireObject(ACPI_CACHE_T *Cache)
+AcpiOsAllocateScratch(void *Arena, ACPI_SIZE Size)
 {
-    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
-    struct _cache_object *object;
-    void *return_object = NULL;
+    struct _acpi_scratch *arena = (struct _acpi_scratch *)Arena;
+    struct _acpi_scratch_chunk *chunk;
+    void *p;
     
-    if (!cache || cache->magic != ACPI_CACHE_MAGIC) {
+    if (!arena || arena->magic != ACPI_SCRATCH_MAGIC) {
         return NULL;
     }
     
-    IOSimpleLockLock(cache->lock);
-    
-    cache->requests++;
-    
-    /* Try to get an object from the cache first */
-    if (cache->list_head) {
-        object = cache->list_head;
-        cache->list_head = object->next;
-        cache->current_depth--;
-        cache->hits++;
-        
-        /* Return pointer to data area (after the header) */
-        return_object = (void *)((char *)object + sizeof(struct _cache_object));
+    Size = ACPI_ROUND_UP(Size, sizeof(UINT64));
+    if (Size > (ACPI_SIZE)(arena->end - arena->next)) {
+        ACPI_SIZE chunk_size = ACPI_MAX(ACPI_SCRATCH_CHUNK_SIZE, ACPI_SCRATCH_HEADER + Size);
         
-        IOSimpleLockUnlock(cache->lock);
-        
-        /* Clear the object data */
-        memset(return_object, 0, cache->object_size);
-        
-        return return_object;
-    }
-    
-    IOSimpleLockUnlock(cache->lock);
-    
-    /* Cache is empty, allocate a new object */
-    object = (struct _cache_object *)IOMalloc(sizeof(struct _cache_object) + cache->object_size);
-    if (!object) {
-        return NULL;
+        chunk = (struct _acpi_scratch_chunk *)IOMalloc(chunk_size);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->size = chunk_size;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->next = (char *)chunk + ACPI_SCRATCH_HEADER;
+        arena->end = (char *)chunk + chunk_size;
     }
     
-    /* Clear the entire object */
-    memset(object, 0, sizeof(struct _cache_object) + cache->object_size);
-    
-    /* Return pointer to data area */
-    return_object = (void *)((char *)object + sizeof(struct _cache_object));
-    
-    return return_object;
+    p = arena->next;
+    arena->next += Size;
+    return p;
 }
 
-/* AcpiOsReleaseObject - Release an object back to the cache */
-ACPI_STATUS
-AcpiOsReleaseObject(ACPI_CACHE_T *Cache, void *Object)
+void
+AcpiOsReleaseScratch(void *Arena)
 {
-    struct _acpi_cache *cache = (struct _acpi_cache *)Cache;
-    struct _cache_object *cache_object;
+    struct _acpi_scratch *arena = (struct _acpi_scratch *)Arena;
+    struct _acpi_scratch_chunk *chunk, *next;
     
-    if (!cache || cache->magic != ACPI_CACHE_MAGIC || !Object) {
-        /* If cache is invalid, just free the object */
-        if (Object) {
-            cache_object = (struct _cache_object *)((char *)Object - sizeof(struct _cache_object));
-            IOFree(cache_object, sizeof(struct _cache_object) + (cache ? cache->object_size : 0));
-        }
-        return AE_BAD_PARAMETER;
+    if (!arena || arena->magic != ACPI_SCRATCH_MAGIC) {
+        return;
     }
     
-    /* Get pointer to cache object header */
-    cache_object = (struct _cache_object *)((char *)Object - sizeof(struct _cache_object));
-    
-    IOSimpleLockLock(cache->lock);
-    
-    /* If cache is full, just free the object */
-    if (cache->current_depth >= cache->max_depth) {
-        IOSimpleLockUnlock(cache->lock);
-        IOFree(cache_object, sizeof(struct _cache_object) + cache->object_size);
-        return AE_OK;
+    for (chunk = arena->chunks; chunk; chunk = next) {
+        next = chunk->next;
+        IOFree(chunk, chunk->size);
     }
     
-    /* Add object back to cache */
-    cache_object->next = cache->list_head;
-    cache->list_head = cache_object;
-    cache->current_depth++;
-    
-    IOSimpleLockUnlock(cache->lock);
-    
-    return AE_OK;
+    arena->magic = 0; /* Invalidate */
+    IOFree(arena, sizeof(struct _acpi_scratch));
 }
 
 #pragma mark thread related stuff
@@ -1050,8 +2239,7 @@ ACPI_STATUS AcpiOsExecute(ACPI_EXECUTE_TYPE Type, ACPI_OSD_EXEC_CALLBACK Functio
 void AcpiOsWaitEventsComplete(void)
 {
     /* Wait for all queued asynchronous events to complete */
-    /* Implementation depends on how AcpiOsExecute queues work */
-    /* For now, this is a no-op since AcpiOsExecute delegates to external implementation */
+    AcpiOsExtWaitEventsComplete();
 }
 
 #pragma mark Override functions - they do nothing.
@@ -1114,6 +2302,540 @@ ACPI_STATUS AcpiOsSignal(UINT32 Function, void *Info)
     return AE_OK;
 }
 
+#pragma mark Log ring
+
+/*
+ * Broken firmware can make ACPICA print warnings in bursts, from GPE and
+ * notify handlers and sometimes with interrupts off, and IOLog and kprintf
+ * (a serial port, when that is where it goes) are slow. So AcpiOsVprintf
+ * only formats the text and copies it into a ring that belongs to its CPU.
+ * A drain thread later passes the lines to IOLog/kprintf in time order and
+ * keeps the last ACPI_OS_LOG_HISTORY_SIZE bytes for AcpiOsReadLog.
+ *
+ * Each ring has one producer, its own CPU with interrupts disabled, and one
+ * consumer, the drain thread, so it needs no lock: head and tail are each
+ * written by one side only, with a barrier before they are published.
+ * ACPICA builds a line from several AcpiOsPrintf calls (prefix, message,
+ * module suffix), and the pieces gather in a per-CPU line buffer until the
+ * newline. A line longer than the buffer goes into the ring as several
+ * records, which print as one line again. A thread that migrates halfway
+ * through a line leaves it in two pieces.
+ *
+ * Error and warning lines are rate-limited per message. A message is
+ * identified by the format strings the line was built from, not by its
+ * text, so the same warning about different objects counts as one message.
+ * After ACPI_OS_LOG_BURST lines in ACPI_OS_LOG_INTERVAL_MS on one CPU, the
+ * rest are only counted until the interval ends. Lines that don't fit in
+ * the ring are counted as dropped. Both counts are written to the log by
+ * the drain thread.
+ *
+ * Arguments can't be kept to be formatted later: ACPICA passes pathnames
+ * and node names that it frees as soon as the call returns.
+ *
+ * Printers, readers and the statistics count themselves in gAcpiOsLogUsers
+ * while they use the rings or the history. AcpiOsTerminateLog closes the
+ * log to new users (they print synchronously), waits for the others to
+ * leave, and only then has the drain thread empty the rings and exit.
+ */
+#define ACPI_OS_LOG_RING_SIZE       16384       /* per CPU, power of two */
+#define ACPI_OS_LOG_LINE_MAX        256         /* per record */
+#define ACPI_OS_LOG_PRINTF_MAX      4096        /* per AcpiOsPrintf call */
+#define ACPI_OS_LOG_HISTORY_SIZE    65536
+#define ACPI_OS_LOG_IDS             64          /* rate limit slots per CPU */
+#define ACPI_OS_LOG_BURST           10
+#define ACPI_OS_LOG_INTERVAL_MS     1000
+#define ACPI_OS_LOG_DRAIN_MS        50
+#define ACPI_OS_LOG_WRAP            0xFFFF      /* record length: skip to the start of the ring */
+
+struct _acpi_os_log_record
+{
+    UINT64 time;                        /* mach_absolute_time() at the newline */
+    UINT32 suppressed;                  /* lines like this one rate-limited before it */
+    UINT16 length;                      /* text bytes that follow, or ACPI_OS_LOG_WRAP */
+    UINT16 reserved;
+};
+
+#define ACPI_OS_LOG_RECORD_SIZE(n)  ACPI_ROUND_UP(sizeof(struct _acpi_os_log_record) + (n), 8)
+
+struct _acpi_os_log_limit
+{
+    uintptr_t id;
+    UINT64 window;                      /* start of the current interval */
+    UINT32 count;                       /* lines let through in it */
+    UINT32 suppressed;
+};
+
+struct _acpi_os_log_cpu
+{
+    volatile UINT32 head;               /* next byte the CPU writes */
+    volatile UINT32 tail;               /* next byte the drain thread reads */
+    volatile UINT32 dropped;            /* lines that didn't fit */
+    volatile UINT32 suppressed;         /* lines rate-limited */
+
+    /* The line being put together, touched only by this CPU */
+    thread_t owner;
+    uintptr_t id;                       /* hash of the line's format strings */
+    UINT32 used;
+    BOOLEAN limited;                    /* error or warning, subject to the rate limit */
+    BOOLEAN continued;                  /* records of this line have gone out already */
+    BOOLEAN dropping;                   /* and were rate-limited */
+    char line[ACPI_OS_LOG_LINE_MAX];
+    struct _acpi_os_log_limit limit[ACPI_OS_LOG_IDS];
+
+    UINT8 ring[ACPI_OS_LOG_RING_SIZE];
+} __attribute__((aligned(ACPI_CACHE_LINE_SIZE)));
+
+static struct _acpi_os_log_cpu *gAcpiOsLog;         /* NULL: print synchronously */
+static UInt32 gAcpiOsLogCpus;
+static UInt64 gAcpiOsLogInterval;                   /* ACPI_OS_LOG_INTERVAL_MS in absolute time */
+static thread_t gAcpiOsLogThread;
+static volatile UInt32 gAcpiOsLogStopping;          /* 1: drain thread asked to exit, 2: it has */
+static volatile UInt32 gAcpiOsLogClosed;            /* new users print synchronously */
+static volatile SInt32 gAcpiOsLogUsers;
+
+/* Drain thread output, for AcpiOsReadLog; protected by gAcpiOsLogHistoryLock */
+static IOLock *gAcpiOsLogHistoryLock;
+static char *gAcpiOsLogHistory;
+static UInt64 gAcpiOsLogHistoryEnd;                 /* bytes ever written */
+static UInt64 gAcpiOsLogLines;
+static UInt64 gAcpiOsLogDroppedSeen;
+
+/* Lines that start like this are rate-limited */
+static const char *const gAcpiOsLogLimited[] = {
+    ACPI_MSG_ERROR,
+    ACPI_MSG_WARNING,
+    ACPI_MSG_BIOS_ERROR,
+    ACPI_MSG_BIOS_WARNING,
+};
+
+/* Straight to the console, the old way; also used by the drain thread */
+static void
+AcpiOsLogWrite(const char *Text)
+{
+    if (gAcpiOsPrintfFlags & ACPI_OS_PRINTF_USE_KPRINTF) {
+        kprintf("%s", Text);
+    }
+    
+    if (gAcpiOsPrintfFlags & ACPI_OS_PRINTF_USE_IOLOG) {
+        /* Allegedly IOLog can't be used within an interrupt context. I believe. */
+        if (!ml_at_interrupt_context()) {
+            IOLog("%s", Text);
+        }
+    }
+}
+
+/* FALSE once the log is closed or not there; print synchronously then */
+static BOOLEAN
+AcpiOsLogEnter(void)
+{
+    if (!gAcpiOsLog) {
+        return FALSE;
+    }
+    
+    /* A full barrier, against the store to gAcpiOsLogClosed in AcpiOsTerminateLog */
+    OSIncrementAtomic(&gAcpiOsLogUsers);
+    if (gAcpiOsLogClosed) {
+        OSDecrementAtomic(&gAcpiOsLogUsers);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+AcpiOsLogExit(void)
+{
+    OSDecrementAtomic(&gAcpiOsLogUsers);
+}
+
+/* Interrupts disabled, running on Log's CPU */
+static void
+AcpiOsLogPut(struct _acpi_os_log_cpu *Log, UINT32 Suppressed)
+{
+    struct _acpi_os_log_record *rec;
+    UINT32 head = Log->head;
+    UINT32 used = head - Log->tail;
+    UINT32 offset = head & (ACPI_OS_LOG_RING_SIZE - 1);
+    UINT32 size = ACPI_OS_LOG_RECORD_SIZE(Log->used);
+    UINT32 pad = 0;
+    
+    /* Records don't wrap; the end of the ring is skipped instead */
+    if (offset + size > ACPI_OS_LOG_RING_SIZE) {
+        pad = ACPI_OS_LOG_RING_SIZE - offset;
+    }
+    if (used + pad + size > ACPI_OS_LOG_RING_SIZE) {
+        Log->dropped++;
+        Log->suppressed += Suppressed;
+        return;
+    }
+    
+    if (pad) {
+        if (pad >= sizeof(struct _acpi_os_log_record)) {
+            rec = (struct _acpi_os_log_record *)&Log->ring[offset];
+            rec->length = ACPI_OS_LOG_WRAP;
+        }
+        offset = 0;
+    }
+    
+    rec = (struct _acpi_os_log_record *)&Log->ring[offset];
+    rec->time = mach_absolute_time();
+    rec->suppressed = Suppressed;
+    rec->length = (UINT16)Log->used;
+    memcpy(rec + 1, Log->line, Log->used);
+    
+    OSMemoryBarrier();
+    Log->head = head + pad + size;
+    
+    /* Don't leave a filling ring to the next drain period */
+    if (used <= ACPI_OS_LOG_RING_SIZE / 2 && used + pad + size > ACPI_OS_LOG_RING_SIZE / 2) {
+        thread_wakeup((event_t)&gAcpiOsLogThread);
+    }
+}
+
+/*
+ * Interrupts disabled; the line in Log->line is complete (or being cut short),
+ * or Partial and full. How many lines an ID lost in one interval is printed
+ * ahead of its first line in a later one, like printk_ratelimit. The records
+ * of a long line share its first one's fate.
+ */
+static void
+AcpiOsLogCommit(struct _acpi_os_log_cpu *Log, BOOLEAN Partial)
+{
+    struct _acpi_os_log_limit *limit;
+    UINT32 suppressed = 0;
+    UINT64 now;
+    BOOLEAN continued = Log->continued;
+    
+    Log->continued = Partial;
+    if (continued) {
+        if (!Log->dropping && Log->used) {
+            AcpiOsLogPut(Log, 0);
+        }
+        Log->used = 0;
+        return;
+    }
+    
+    Log->dropping = FALSE;
+    if (Log->limited) {
+        limit = &Log->limit[(Log->id >> 32) % ACPI_OS_LOG_IDS];
+        now = mach_absolute_time();
+        
+        if (limit->id != Log->id || now - limit->window >= gAcpiOsLogInterval) {
+            suppressed = limit->suppressed;
+            limit->id = Log->id;
+            limit->window = now;
+            limit->count = 0;
+            limit->suppressed = 0;
+        }
+        if (limit->count >= ACPI_OS_LOG_BURST) {
+            limit->suppressed++;
+            Log->suppressed++;
+            Log->dropping = TRUE;
+            Log->used = 0;
+            return;
+        }
+        limit->count++;
+    }
+    
+    AcpiOsLogPut(Log, suppressed);
+    Log->used = 0;
+}
+
+static void
+AcpiOsLogAppend(const char *Format, const char *Text, UINT32 Length)
+{
+    struct _acpi_os_log_cpu *log;
+    thread_t self = current_thread();
+    boolean_t istate;
+    UINT32 n;
+    
+    istate = ml_set_interrupts_enabled(FALSE);
+    log = &gAcpiOsLog[cpu_number()];
+    
+    /* Another thread's unfinished line goes out as it is */
+    if ((log->used || log->continued) && log->owner != self) {
+        AcpiOsLogCommit(log, FALSE);
+    }
+    
+    if (!log->used && !log->continued) {
+        log->owner = self;
+        log->id = 0;
+        log->limited = FALSE;
+        for (UINT32 i = 0; i < ACPI_ARRAY_LENGTH(gAcpiOsLogLimited); i++) {
+            if (!strncmp(Text, gAcpiOsLogLimited[i], strlen(gAcpiOsLogLimited[i]))) {
+                log->limited = TRUE;
+                break;
+            }
+        }
+    }
+    log->id = (log->id ^ (uintptr_t)Format) * 0x9E3779B97F4A7C15ULL;
+    
+    while (Length) {
+        n = ACPI_MIN(Length, ACPI_OS_LOG_LINE_MAX - log->used);
+        memcpy(&log->line[log->used], Text, n);
+        log->used += n;
+        Text += n;
+        Length -= n;
+        
+        if (log->line[log->used - 1] == '\n') {
+            AcpiOsLogCommit(log, FALSE);
+        } else if (log->used == ACPI_OS_LOG_LINE_MAX) {
+            AcpiOsLogCommit(log, TRUE);
+        }
+    }
+    
+    ml_set_interrupts_enabled(istate);
+}
+
+/* The CPU whose next record is oldest, or NULL when all rings are empty */
+static struct _acpi_os_log_cpu *
+AcpiOsLogNext(struct _acpi_os_log_record **Record)
+{
+    struct _acpi_os_log_cpu *next = NULL;
+    struct _acpi_os_log_record *rec;
+    UINT32 offset;
+    
+    *Record = NULL;
+    for (UInt32 cpu = 0; cpu < gAcpiOsLogCpus; cpu++) {
+        struct _acpi_os_log_cpu *log = &gAcpiOsLog[cpu];
+        
+        while (log->tail != log->head) {
+            OSMemoryBarrier();
+            offset = log->tail & (ACPI_OS_LOG_RING_SIZE - 1);
+            rec = (struct _acpi_os_log_record *)&log->ring[offset];
+            if (ACPI_OS_LOG_RING_SIZE - offset < sizeof(struct _acpi_os_log_record) ||
+                rec->length == ACPI_OS_LOG_WRAP) {
+                log->tail += ACPI_OS_LOG_RING_SIZE - offset;
+                continue;
+            }
+            if (!*Record || rec->time < (*Record)->time) {
+                *Record = rec;
+                next = log;
+            }
+            break;
+        }
+    }
+    return next;
+}
+
+static void
+AcpiOsLogHistoryAppend(const char *Text, UINT32 Length)
+{
+    UINT32 offset;
+    UINT32 n;
+    
+    IOLockLock(gAcpiOsLogHistoryLock);
+    while (Length) {
+        offset = gAcpiOsLogHistoryEnd & (ACPI_OS_LOG_HISTORY_SIZE - 1);
+        n = ACPI_MIN(Length, ACPI_OS_LOG_HISTORY_SIZE - offset);
+        memcpy(&gAcpiOsLogHistory[offset], Text, n);
+        gAcpiOsLogHistoryEnd += n;
+        Text += n;
+        Length -= n;
+    }
+    IOLockUnlock(gAcpiOsLogHistoryLock);
+}
+
+static void
+AcpiOsLogEmit(const char *Text)
+{
+    UINT32 length = (UINT32)strlen(Text);
+    
+    AcpiOsLogWrite(Text);
+    AcpiOsLogHistoryAppend(Text, length);
+}
+
+static void
+AcpiOsLogDrain(void)
+{
+    struct _acpi_os_log_cpu *log;
+    struct _acpi_os_log_record *rec;
+    char text[ACPI_OS_LOG_LINE_MAX + 64];
+    UInt64 dropped = 0;
+    
+    while ((log = AcpiOsLogNext(&rec))) {
+        if (rec->suppressed) {
+            snprintf(text, sizeof(text), "ACPI: %u similar messages suppressed\n", rec->suppressed);
+            AcpiOsLogEmit(text);
+        }
+        memcpy(text, rec + 1, rec->length);
+        text[rec->length] = 0;
+        
+        OSMemoryBarrier();
+        log->tail += ACPI_OS_LOG_RECORD_SIZE(rec->length);
+        
+        AcpiOsLogEmit(text);
+        gAcpiOsLogLines++;
+    }
+    
+    for (UInt32 cpu = 0; cpu < gAcpiOsLogCpus; cpu++) {
+        dropped += gAcpiOsLog[cpu].dropped;
+    }
+    if (dropped != gAcpiOsLogDroppedSeen) {
+        snprintf(text, sizeof(text), "ACPI: %llu log lines dropped, ring full\n", dropped - gAcpiOsLogDroppedSeen);
+        AcpiOsLogEmit(text);
+        gAcpiOsLogDroppedSeen = dropped;
+    }
+}
+
+static void
+AcpiOsLogDrainMain(void *Context, wait_result_t Result)
+{
+    while (!gAcpiOsLogStopping) {
+        AcpiOsLogDrain();
+        assert_wait_timeout((event_t)&gAcpiOsLogThread, THREAD_UNINT, ACPI_OS_LOG_DRAIN_MS, kMillisecondScale);
+        thread_block(THREAD_CONTINUE_NULL);
+    }
+    AcpiOsLogDrain();
+    
+    IOLockLock(gAcpiOsLogHistoryLock);
+    gAcpiOsLogStopping = 2;
+    IOLockWakeup(gAcpiOsLogHistoryLock, (event_t)&gAcpiOsLogStopping, false);
+    IOLockUnlock(gAcpiOsLogHistoryLock);
+    thread_terminate(current_thread());
+}
+
+static void
+AcpiOsInitializeLog(void)
+{
+    if (gAcpiOsPrintfFlags & ACPI_OS_PRINTF_SYNC) {
+        return;
+    }
+    
+    gAcpiOsLogCpus = ml_get_max_cpus();
+    nanoseconds_to_absolutetime(ACPI_OS_LOG_INTERVAL_MS * NSEC_PER_MSEC, &gAcpiOsLogInterval);
+    gAcpiOsLogHistoryLock = IOLockAlloc();
+    gAcpiOsLogHistory = IOMalloc(ACPI_OS_LOG_HISTORY_SIZE);
+    gAcpiOsLog = IOMallocAligned(gAcpiOsLogCpus * sizeof(struct _acpi_os_log_cpu), ACPI_CACHE_LINE_SIZE);
+    
+    if (!gAcpiOsLogHistoryLock || !gAcpiOsLogHistory || !gAcpiOsLog) {
+        goto fail;
+    }
+    bzero(gAcpiOsLog, gAcpiOsLogCpus * sizeof(struct _acpi_os_log_cpu));
+    
+    gAcpiOsLogStopping = 0;
+    gAcpiOsLogClosed = FALSE;
+    if (kernel_thread_start(&AcpiOsLogDrainMain, NULL, &gAcpiOsLogThread) != KERN_SUCCESS) {
+        goto fail;
+    }
+    return;
+    
+fail:
+    if (gAcpiOsLog) {
+        IOFreeAligned(gAcpiOsLog, gAcpiOsLogCpus * sizeof(struct _acpi_os_log_cpu));
+        gAcpiOsLog = NULL;
+    }
+    if (gAcpiOsLogHistory) {
+        IOFree(gAcpiOsLogHistory, ACPI_OS_LOG_HISTORY_SIZE);
+        gAcpiOsLogHistory = NULL;
+    }
+    if (gAcpiOsLogHistoryLock) {
+        IOLockFree(gAcpiOsLogHistoryLock);
+        gAcpiOsLogHistoryLock = NULL;
+    }
+}
+
+/*
+ * Drivers may still print or read the log; they are fenced off first, and
+ * whatever they left in the rings is printed before the rings go.
+ */
+static void
+AcpiOsTerminateLog(void)
+{
+    struct _acpi_os_log_cpu *log = gAcpiOsLog;
+    
+    if (!log) {
+        return;
+    }
+    
+    gAcpiOsLogClosed = TRUE;
+    OSMemoryBarrier();
+    while (gAcpiOsLogUsers) {
+        IOSleep(1);
+    }
+    
+    IOLockLock(gAcpiOsLogHistoryLock);
+    gAcpiOsLogStopping = 1;
+    thread_wakeup((event_t)&gAcpiOsLogThread);
+    while (gAcpiOsLogStopping != 2) {
+        IOLockSleep(gAcpiOsLogHistoryLock, (event_t)&gAcpiOsLogStopping, THREAD_UNINT);
+    }
+    IOLockUnlock(gAcpiOsLogHistoryLock);
+    
+    gAcpiOsLog = NULL;
+    thread_deallocate(gAcpiOsLogThread);
+    gAcpiOsLogThread = NULL;
+    IOFreeAligned(log, gAcpiOsLogCpus * sizeof(struct _acpi_os_log_cpu));
+    IOFree(gAcpiOsLogHistory, ACPI_OS_LOG_HISTORY_SIZE);
+    gAcpiOsLogHistory = NULL;
+    IOLockFree(gAcpiOsLogHistoryLock);
+    gAcpiOsLogHistoryLock = NULL;
+}
+
+/*
+ * AcpiOsReadLog - Copy published log text after *Cursor into Buffer
+ *
+ * Cursor starts at 0 and is advanced past what was copied. A reader that
+ * falls more than ACPI_OS_LOG_HISTORY_SIZE bytes behind skips ahead to the
+ * oldest whole line still kept. Returns the number of bytes copied.
+ */
+UINT32
+AcpiOsReadLog(UINT64 *Cursor, char *Buffer, UINT32 Length)
+{
+    UINT64 start;
+    UINT32 copied = 0;
+    UINT32 offset;
+    UINT32 n;
+    
+    if (!Cursor || !Buffer || !AcpiOsLogEnter()) {
+        return 0;
+    }
+    
+    IOLockLock(gAcpiOsLogHistoryLock);
+    start = *Cursor;
+    if (start > gAcpiOsLogHistoryEnd) {
+        start = gAcpiOsLogHistoryEnd;
+    }
+    if (gAcpiOsLogHistoryEnd - start > ACPI_OS_LOG_HISTORY_SIZE) {
+        /* Resume at the first whole line still kept */
+        start = gAcpiOsLogHistoryEnd - ACPI_OS_LOG_HISTORY_SIZE;
+        while (start < gAcpiOsLogHistoryEnd &&
+               gAcpiOsLogHistory[start++ & (ACPI_OS_LOG_HISTORY_SIZE - 1)] != '\n') {
+        }
+    }
+    
+    while (copied < Length && start < gAcpiOsLogHistoryEnd) {
+        offset = start & (ACPI_OS_LOG_HISTORY_SIZE - 1);
+        n = (UINT32)ACPI_MIN(gAcpiOsLogHistoryEnd - start, ACPI_OS_LOG_HISTORY_SIZE - offset);
+        n = ACPI_MIN(n, Length - copied);
+        memcpy(Buffer + copied, &gAcpiOsLogHistory[offset], n);
+        copied += n;
+        start += n;
+    }
+    *Cursor = start;
+    IOLockUnlock(gAcpiOsLogHistoryLock);
+    AcpiOsLogExit();
+    
+    return copied;
+}
+
+/* AcpiOsGetLogStatistics - Lines published, and lines rate-limited or dropped on the way */
+void
+AcpiOsGetLogStatistics(UINT64 *Lines, UINT64 *Suppressed, UINT64 *Dropped)
+{
+    *Lines = *Suppressed = *Dropped = 0;
+    
+    if (!AcpiOsLogEnter()) {
+        return;
+    }
+    
+    *Lines = gAcpiOsLogLines;
+    for (UInt32 cpu = 0; cpu < gAcpiOsLogCpus; cpu++) {
+        *Suppressed += gAcpiOsLog[cpu].suppressed;
+        *Dropped += gAcpiOsLog[cpu].dropped;
+    }
+    AcpiOsLogExit();
+}
+
 void AcpiOsPrintf(const char *fmt, ...)
 {
     va_list va;
@@ -1124,17 +2846,18 @@ void AcpiOsPrintf(const char *fmt, ...)
 
 void AcpiOsVprintf(const char *fmt, va_list list)
 {
-    char msg[4096]; /* I don't think a message will exceed this size in one go. */
-    vsnprintf(msg, 4096, fmt, list);
-
-    if (gAcpiOsPrintfFlags & ACPI_OS_PRINTF_USE_KPRINTF) {
-        kprintf("%s", msg);
+    char msg[ACPI_OS_LOG_PRINTF_MAX]; /* I don't think a message will exceed this size in one go. */
+    int length;
+    
+    length = vsnprintf(msg, sizeof(msg), fmt, list);
+    if (length <= 0) {
+        return;
     }
     
-    if (gAcpiOsPrintfFlags & ACPI_OS_PRINTF_USE_IOLOG) {
-        /* Allegedly IOLog can't be used within an interrupt context. I believe. */
-        if (!ml_at_interrupt_context()) {
-            IOLog("%s", msg);
-        }
+    if (!AcpiOsLogEnter()) {
+        AcpiOsLogWrite(msg);
+        return;
     }
+    AcpiOsLogAppend(fmt, msg, (UINT32)ACPI_MIN(length, (int)sizeof(msg) - 1));
+    AcpiOsLogExit();
 }
@@ -40,10 +40,9 @@
 #include <IOKit/IOMemoryDescriptor.h>
 #include <IOKit/IORegistryEntry.h>
 #include <IOKit/IODeviceTreeSupport.h>
-#include <IOKit/IOCommand.h>
-#include <IOKit/IOCommandGate.h>
-#include <libkern/c++/OSSet.h>
-#include <libkern/c++/OSCollectionIterator.h>
+#include <kern/thread.h>
+#include <kern/sched_prim.h>
+#include <kern/clock.h>
 #include <pexpert/i386/efi.h>
 #include <pexpert/i386/boot.h>
 
@@ -56,150 +55,737 @@ extern "C" ACPI_STATUS AcpiOsExtInitialize(void);
 extern "C" ACPI_PHYSICAL_ADDRESS AcpiOsExtGetRootPointer(void);
 extern "C" ACPI_STATUS AcpiOsExtExecute(ACPI_EXECUTE_TYPE Type, ACPI_OSD_EXEC_CALLBACK Function, void *Context);
 extern "C" void AcpiOsExtWaitEventsComplete(void);
-
-IOWorkLoop *gAcpiOsThreadWorkLoop;
-IOCommandGate *gAcpiOsThreadCommandGate;
+extern "C" void AcpiOsExtPrintExecuteStatistics(void);
+extern "C" void *AcpiOsExtPciEcamAddress(ACPI_PCI_ID *PciId, UInt32 Reg);
 
 /* PCI config space stuff. */
 ACPI_MCFG_ALLOCATION gPCIFromPE;
 ACPI_MCFG_ALLOCATION *gPCIDataFromMCFG;
 size_t gPCIMCFGEntryCount;
 
-/* Enhanced PCI access state */
-static boolean_t gPCIEcamAvailable = false;
-static IOMemoryMap *gPCIEcamMap = NULL;
-static void *gPCIEcamVirtualBase = NULL;
+/*
+ * ECAM (PCIe enhanced configuration access).
+ *
+ * Every MCFG allocation, plus the one the booter hands us, is recorded per
+ * segment as the physical base of each bus it decodes. A bus's 1 MB window
+ * is mapped the first time one of its functions is touched and stays mapped
+ * until termination, so a config access is a couple of table loads. Segments
+ * hang off a two-level directory indexed by the high and low byte of the
+ * segment number; in practice only row 0 is ever allocated.
+ */
+#define kAcpiOsEcamBusShift     20
+#define kAcpiOsEcamBusCount     256
+
+struct AcpiOsEcamSegment
+{
+    UInt8 *volatile Window[kAcpiOsEcamBusCount];        /* NULL until first access */
+    ACPI_PHYSICAL_ADDRESS Phys[kAcpiOsEcamBusCount];    /* 0 if no allocation decodes the bus */
+    IOMemoryMap *Map[kAcpiOsEcamBusCount];
+};
+
+static AcpiOsEcamSegment **gAcpiOsEcamDirectory[256];
+static IOLock *gAcpiOsEcamLock;                         /* serializes adding and mapping */
+
+/*
+ * Physical mapping cache.
+ *
+ * ACPICA maps the same table headers, operation regions and ECAM pages over
+ * and over again. Mappings are page granular and shared by reference count.
+ * Active mappings never overlap and are kept sorted by physical base, so a
+ * request is answered by a binary search for the mapping that covers it.
+ * Every live mapping (active or retired) is also kept sorted by virtual base
+ * for AcpiOsExtUnmapMemory. A request that straddles cached mappings gets a
+ * new mapping spanning all of them; the old ones are retired and go away with
+ * their last user. Mappings nobody uses stay cached, least recently used
+ * first out once there are more than kAcpiOsMapIdleLimit of them.
+ */
+struct AcpiOsMapping
+{
+    ACPI_PHYSICAL_ADDRESS PhysBase;
+    ACPI_SIZE Length;
+    IOVirtualAddress VirtBase;
+    IOMemoryMap *Map;
+    UInt32 RefCount;
+    bool Retired;
+    AcpiOsMapping *IdlePrev;
+    AcpiOsMapping *IdleNext;
+};
+
+#define kAcpiOsMapIdleLimit 64
+#define kAcpiOsMapPageMask ((ACPI_PHYSICAL_ADDRESS)PAGE_SIZE - 1)
 
 IOLock *gAcpiOsExtMemoryMapLock;
-OSSet *gAcpiOsExtMemoryMapSet;
-OSCollectionIterator *gAcpiOsExtMemoryMapIterator;
+static AcpiOsMapping **gAcpiOsMapByPhys;     /* active mappings, by PhysBase */
+static UInt32 gAcpiOsMapByPhysCount;
+static AcpiOsMapping **gAcpiOsMapByVirt;     /* all live mappings, by VirtBase */
+static UInt32 gAcpiOsMapByVirtCount;
+static UInt32 gAcpiOsMapCapacity;            /* capacity of both arrays */
+static AcpiOsMapping *gAcpiOsMapIdleHead;    /* most recently used */
+static AcpiOsMapping *gAcpiOsMapIdleTail;    /* least recently used */
+static UInt32 gAcpiOsMapIdleCount;
 
-/* Enhanced execution tracking */
-static UInt32 gPendingExecutions = 0;
-static IOLock *gExecutionLock;
+/*
+ * Deferred execution.
+ *
+ * AcpiOsExecute queues the callback on the queue for its ACPI_EXECUTE_TYPE
+ * and returns. A fixed pool of worker threads drains the queues with
+ * interrupts enabled, taking from the queues in priority order. Each queue
+ * runs one callback at a time, so GPE methods, notifies and EC work each
+ * stay in the order they were queued while different kinds run side by
+ * side. The exception is a callback waiting for the others to complete:
+ * its worker runs what is queued behind it meanwhile. Debugger threads loop for as long as the debugger is attached, so
+ * they get a thread of their own instead of a pool worker.
+ *
+ * GPE dispatch queues work with interrupts off and ACPICA's GPE lock held,
+ * so queueing must not block: items come off a free list filled up front,
+ * the queues are under a simple lock, and sleepers are woken once it is
+ * dropped. When the free list runs dry the callback is refused with
+ * AE_NO_MEMORY, as a failed allocation would be.
+ */
+#define kAcpiOsExecWorkers      4
+#define kAcpiOsExecItems        256
+#define kAcpiOsExecQueues       (OSL_EC_BURST_HANDLER + 1)
 
-struct _iocmdq_callback_data
+struct AcpiOsExecItem
 {
+    AcpiOsExecItem *Next;
     ACPI_OSD_EXEC_CALLBACK Callback;
     void *Context;
+    UInt64 Queued;              /* mach_absolute_time() at AcpiOsExecute */
 };
 
-IOReturn AcpiOsThreadDispatch(OSObject *, void *field0, void *, void *, void *)
+struct AcpiOsExecQueue
 {
-    _iocmdq_callback_data *d = (_iocmdq_callback_data *)field0;
-    
-    ml_set_interrupts_enabled(false); /* disable interrupts */
+    AcpiOsExecItem *Head;
+    AcpiOsExecItem *Tail;
+    bool Running;
+    thread_t Owner;             /* the worker running it */
+    UInt64 Queued;
+    UInt64 Completed;
+    UInt64 Refused;             /* no free item */
+    UInt64 WaitTime;            /* absolute time between queueing and starting */
+    UInt64 MaxWaitTime;
+    UInt64 RunTime;
+};
+
+/* Queues in the order idle workers look at them */
+static const ACPI_EXECUTE_TYPE gAcpiOsExecPriority[] = {
+    OSL_GLOBAL_LOCK_HANDLER,
+    OSL_GPE_HANDLER,
+    OSL_EC_BURST_HANDLER,
+    OSL_EC_POLL_HANDLER,
+    OSL_NOTIFY_HANDLER,
+};
+
+static IOSimpleLock *gExecutionLock;        /* protects everything below */
+static AcpiOsExecQueue gAcpiOsExecQueue[kAcpiOsExecQueues];
+static AcpiOsExecItem *gAcpiOsExecItems;    /* kAcpiOsExecItems of them */
+static AcpiOsExecItem *gAcpiOsExecFree;
+static UInt32 gPendingExecutions = 0;       /* queued or running on a worker */
+static UInt32 gAcpiOsExecWaiting;           /* callbacks inside AcpiOsExtWaitEventsComplete */
+static thread_t gAcpiOsExecWorker[kAcpiOsExecWorkers];
+static UInt32 gAcpiOsExecWorkersRunning;
+static bool gAcpiOsExecStopping;
+
+/*
+ * The first queue, in priority order, with an item that self can run: the
+ * queue must be idle, or its callback must be self's own and waiting in
+ * AcpiOsExtWaitEventsComplete. Nobody else can run what is queued behind
+ * a waiting callback, so its worker does.
+ */
+static AcpiOsExecQueue *AcpiOsExecNextQueue(thread_t self)
+{
+    for (UInt32 i = 0; i < sizeof(gAcpiOsExecPriority) / sizeof(gAcpiOsExecPriority[0]); i++) {
+        AcpiOsExecQueue *q = &gAcpiOsExecQueue[gAcpiOsExecPriority[i]];
+        if (q->Head && (!q->Running || q->Owner == self)) {
+            return q;
+        }
+    }
+    return NULL;
+}
+
+static bool AcpiOsExecOnWorker(void)
+{
+    thread_t self = current_thread();
+
+    for (UInt32 i = 0; i < kAcpiOsExecWorkers; i++) {
+        if (gAcpiOsExecWorker[i] == self) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Sleep on event with gExecutionLock dropped. The wait is asserted before
+ * the lock goes, so a wakeup in between isn't lost.
+ */
+static IOInterruptState AcpiOsExecSleep(event_t event, IOInterruptState is)
+{
+    assert_wait(event, THREAD_UNINT);
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+    thread_block(THREAD_CONTINUE_NULL);
+    return IOSimpleLockLockDisableInterrupt(gExecutionLock);
+}
+
+/*
+ * Work is queued: wake an idle worker, and the waiting ones too since an
+ * idle worker may not be left to take it.
+ */
+static void AcpiOsExecWakeWorkers(bool waiting)
+{
+    thread_wakeup_one(&gAcpiOsExecQueue);
+    if (waiting) {
+        thread_wakeup(&gPendingExecutions);
+    }
+}
+
+/*
+ * Run the callback at the head of q with gExecutionLock dropped. A worker
+ * running what was queued behind its own waiting callback finds q already
+ * running; it stays that way once the inner callback is done.
+ */
+static IOInterruptState AcpiOsExecRun(AcpiOsExecQueue *q, IOInterruptState is)
+{
+    AcpiOsExecItem *d = q->Head;
+    bool running = q->Running;
+    thread_t owner = q->Owner;
+
+    q->Head = d->Next;
+    if (!q->Head) {
+        q->Tail = NULL;
+    }
+    q->Running = true;
+    q->Owner = current_thread();
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+
+    UInt64 start = mach_absolute_time();
+    d->Callback(d->Context);
+    UInt64 end = mach_absolute_time();
+
+    is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+    q->Running = running;
+    q->Owner = owner;
+    q->Completed++;
+    q->WaitTime += start - d->Queued;
+    if (start - d->Queued > q->MaxWaitTime) {
+        q->MaxWaitTime = start - d->Queued;
+    }
+    q->RunTime += end - start;
+    d->Next = gAcpiOsExecFree;
+    gAcpiOsExecFree = d;
+
+    /* The queue may have more for another worker now that it is free */
+    bool more = q->Head != NULL && !q->Running;
+    bool waiting = gAcpiOsExecWaiting != 0;
+    bool drained = --gPendingExecutions <= gAcpiOsExecWaiting;
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+
+    if (more) {
+        AcpiOsExecWakeWorkers(waiting);
+    }
+    if (drained) {
+        thread_wakeup(&gPendingExecutions);
+    }
+    return IOSimpleLockLockDisableInterrupt(gExecutionLock);
+}
+
+static void AcpiOsExecWorkerMain(void *, wait_result_t)
+{
+    thread_t self = current_thread();
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+
+    for (;;) {
+        AcpiOsExecQueue *q = AcpiOsExecNextQueue(self);
+        if (!q) {
+            if (gAcpiOsExecStopping) {
+                break;
+            }
+            is = AcpiOsExecSleep(&gAcpiOsExecQueue, is);
+            continue;
+        }
+        is = AcpiOsExecRun(q, is);
+    }
+
+    gAcpiOsExecWorkersRunning--;
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+    thread_wakeup(&gAcpiOsExecWorkersRunning);
+    thread_terminate(current_thread());
+}
+
+static void AcpiOsExecDebuggerMain(void *field0, wait_result_t)
+{
+    AcpiOsExecItem *d = (AcpiOsExecItem *)field0;
+
     d->Callback(d->Context);
-    ml_set_interrupts_enabled(true); /* enable interrupts */
+    IOFree(d, sizeof(AcpiOsExecItem));
+    thread_terminate(current_thread());
+}
+
+static ACPI_STATUS AcpiOsExecStart(void)
+{
+    gExecutionLock = IOSimpleLockAlloc();
+    gAcpiOsExecItems = (AcpiOsExecItem *)IOMalloc(kAcpiOsExecItems * sizeof(AcpiOsExecItem));
+    if (!gExecutionLock || !gAcpiOsExecItems) {
+        return AE_NO_MEMORY;
+    }
+
+    gAcpiOsExecFree = NULL;
+    for (UInt32 i = 0; i < kAcpiOsExecItems; i++) {
+        gAcpiOsExecItems[i].Next = gAcpiOsExecFree;
+        gAcpiOsExecFree = &gAcpiOsExecItems[i];
+    }
+    gPendingExecutions = 0;
+    gAcpiOsExecStopping = false;
+    for (UInt32 i = 0; i < kAcpiOsExecWorkers; i++) {
+        if (kernel_thread_start(&AcpiOsExecWorkerMain, NULL, &gAcpiOsExecWorker[i]) != KERN_SUCCESS) {
+            break;
+        }
+        IOInterruptState is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+        gAcpiOsExecWorkersRunning++;
+        IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+    }
+
+    return gAcpiOsExecWorkersRunning ? AE_OK : AE_NO_MEMORY;
+}
 
-    /* Update pending execution count */
-    IOLockLock(gExecutionLock);
-    if (gPendingExecutions > 0) {
-        gPendingExecutions--;
+static void AcpiOsExecStop(void)
+{
+    if (!gExecutionLock) {
+        return;
     }
-    IOLockUnlock(gExecutionLock);
 
-    /* we no longer have need for our callback data, and we have exited the cautious period without interrupts. */
-    IOFree(d, sizeof(_iocmdq_callback_data));
-    return kIOReturnSuccess;
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+    gAcpiOsExecStopping = true;
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+    thread_wakeup(&gAcpiOsExecQueue);
+
+    is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+    while (gAcpiOsExecWorkersRunning) {
+        is = AcpiOsExecSleep(&gAcpiOsExecWorkersRunning, is);
+    }
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+
+    for (UInt32 i = 0; i < kAcpiOsExecWorkers; i++) {
+        if (gAcpiOsExecWorker[i]) {
+            thread_deallocate(gAcpiOsExecWorker[i]);
+            gAcpiOsExecWorker[i] = NULL;
+        }
+    }
+}
+
+static AcpiOsEcamSegment *AcpiOsEcamSegmentFor(UInt16 segment)
+{
+    AcpiOsEcamSegment **row = gAcpiOsEcamDirectory[segment >> 8];
+    return row ? row[segment & 0xFF] : NULL;
 }
 
 /*
- * Initialize ECAM/MMIO PCI Configuration Space Access
- * This sets up memory mapping for the PCI configuration space base
- * obtained from boot arguments or MCFG table.
+ * Record the buses an MCFG allocation decodes. The base address is the
+ * window of bus 0 even when the allocation starts at a later bus. A bus
+ * that is already covered keeps its first window.
  */
-static ACPI_STATUS InitializePCIEcam(void)
+ACPI_STATUS AcpiOsExtAddPciEcam(const ACPI_MCFG_ALLOCATION *Allocation)
 {
-    if (gPCIEcamAvailable) {
-        return AE_OK;
+    if (!Allocation || !Allocation->Address ||
+        Allocation->EndBusNumber < Allocation->StartBusNumber) {
+        return AE_BAD_PARAMETER;
     }
-    
-    /* Use boot args data if available */
-    if (gPCIFromPE.Address != 0) {
-        ACPI_SIZE ecam_size = (gPCIFromPE.EndBusNumber - gPCIFromPE.StartBusNumber + 1) * 256 * 4096;
-        
-        IOMemoryDescriptor *desc = IOMemoryDescriptor::withAddressRange(
-            gPCIFromPE.Address, ecam_size, 
-            kIOMemoryDirectionInOut | kIOMemoryMapperNone, 
-            kernel_task
-        );
-        
-        if (desc) {
-            gPCIEcamMap = desc->map();
-            if (gPCIEcamMap) {
-                gPCIEcamVirtualBase = (void *)gPCIEcamMap->getVirtualAddress();
-                gPCIEcamAvailable = true;
-                
-                IOLog("ACPI: ECAM initialized at 0x%llx, buses %d-%d\n", 
-                      gPCIFromPE.Address, gPCIFromPE.StartBusNumber, gPCIFromPE.EndBusNumber);
+
+    UInt16 segment = Allocation->PciSegment;
+    ACPI_STATUS status = AE_OK;
+
+    IOLockLock(gAcpiOsEcamLock);
+    AcpiOsEcamSegment **row = gAcpiOsEcamDirectory[segment >> 8];
+    if (!row) {
+        row = (AcpiOsEcamSegment **)IOMalloc(256 * sizeof(AcpiOsEcamSegment *));
+        if (!row) {
+            status = AE_NO_MEMORY;
+            goto out;
+        }
+        bzero(row, 256 * sizeof(AcpiOsEcamSegment *));
+        gAcpiOsEcamDirectory[segment >> 8] = row;
+    }
+
+    if (!row[segment & 0xFF]) {
+        AcpiOsEcamSegment *seg = (AcpiOsEcamSegment *)IOMalloc(sizeof(AcpiOsEcamSegment));
+        if (!seg) {
+            status = AE_NO_MEMORY;
+            goto out;
+        }
+        bzero(seg, sizeof(AcpiOsEcamSegment));
+        row[segment & 0xFF] = seg;
+    }
+
+    for (UInt32 bus = Allocation->StartBusNumber; bus <= Allocation->EndBusNumber; bus++) {
+        AcpiOsEcamSegment *seg = row[segment & 0xFF];
+        if (!seg->Phys[bus]) {
+            seg->Phys[bus] = Allocation->Address + ((ACPI_PHYSICAL_ADDRESS)bus << kAcpiOsEcamBusShift);
+        }
+    }
+
+    IOLog("ACPI: ECAM segment %u buses %u-%u at 0x%llx\n", segment,
+          Allocation->StartBusNumber, Allocation->EndBusNumber, (UInt64)Allocation->Address);
+out:
+    IOLockUnlock(gAcpiOsEcamLock);
+    return status;
+}
+
+static UInt8 *AcpiOsEcamMapWindow(ACPI_PHYSICAL_ADDRESS phys, IOMemoryMap **map)
+{
+    IOMemoryDescriptor *desc = IOMemoryDescriptor::withAddressRange(
+        phys, 1 << kAcpiOsEcamBusShift,
+        kIOMemoryDirectionInOut | kIOMemoryMapperNone,
+        kernel_task
+    );
+    if (!desc) {
+        return NULL;
+    }
+    *map = desc->map(kIOMapInhibitCache);
+    desc->release();
+    return *map ? (UInt8 *)(*map)->getVirtualAddress() : NULL;
+}
+
+static UInt8 *AcpiOsEcamMapBus(AcpiOsEcamSegment *seg, UInt32 bus)
+{
+    IOLockLock(gAcpiOsEcamLock);
+    UInt8 *window = seg->Window[bus];
+    if (!window) {
+        window = AcpiOsEcamMapWindow(seg->Phys[bus], &seg->Map[bus]);
+        seg->Window[bus] = window;
+    }
+    IOLockUnlock(gAcpiOsEcamLock);
+    return window;
+}
+
+/*
+ * Virtual address of a function's config register through ECAM, or NULL
+ * if no MCFG allocation decodes the bus. Shared with osdarwin.c.
+ */
+void *AcpiOsExtPciEcamAddress(ACPI_PCI_ID *PciId, UInt32 Reg)
+{
+    if (PciId->Bus >= kAcpiOsEcamBusCount || PciId->Device >= 32 ||
+        PciId->Function >= 8 || Reg >= 4096) {
+        return NULL;
+    }
+
+    AcpiOsEcamSegment *seg = AcpiOsEcamSegmentFor(PciId->Segment);
+    if (!seg) {
+        return NULL;
+    }
+
+    UInt8 *window = seg->Window[PciId->Bus];
+    if (!window) {
+        if (!seg->Phys[PciId->Bus]) {
+            return NULL;
+        }
+        window = AcpiOsEcamMapBus(seg, PciId->Bus);
+        if (!window) {
+            return NULL;
+        }
+    }
+
+    return window + (PciId->Device << 15) + (PciId->Function << 12) + Reg;
+}
+
+static void AcpiOsEcamTerminate(void)
+{
+    for (UInt32 i = 0; i < 256; i++) {
+        AcpiOsEcamSegment **row = gAcpiOsEcamDirectory[i];
+        if (!row) {
+            continue;
+        }
+        for (UInt32 j = 0; j < 256; j++) {
+            AcpiOsEcamSegment *seg = row[j];
+            if (!seg) {
+                continue;
             }
-            desc->release();
+            for (UInt32 bus = 0; bus < kAcpiOsEcamBusCount; bus++) {
+                if (seg->Map[bus]) {
+                    seg->Map[bus]->release();
+                }
+            }
+            IOFree(seg, sizeof(AcpiOsEcamSegment));
         }
+        IOFree(row, 256 * sizeof(AcpiOsEcamSegment *));
+        gAcpiOsEcamDirectory[i] = NULL;
     }
-    
-    return gPCIEcamAvailable ? AE_OK : AE_NOT_FOUND;
 }
 
 ACPI_STATUS AcpiOsExtInitialize(void)
 {
     /* Initialize local resources. */
     gAcpiOsExtMemoryMapLock = IOLockAlloc();
-    gAcpiOsExtMemoryMapSet = OSSet::withCapacity(4); /* OSSet's can expand if need be, right? */
-    gAcpiOsExtMemoryMapIterator = OSCollectionIterator::withCollection(gAcpiOsExtMemoryMapSet);
-
-    /* Initialize execution tracking */
-    gExecutionLock = IOLockAlloc();
-    gPendingExecutions = 0;
 
     /* init the execution system */
-    gAcpiOsThreadWorkLoop = IOWorkLoop::workLoop();
-    gAcpiOsThreadCommandGate = IOCommandGate::commandGate(NULL);
-    gAcpiOsThreadCommandGate->setWorkLoop(gAcpiOsThreadWorkLoop);
+    ACPI_STATUS status = AcpiOsExecStart();
+    if (ACPI_FAILURE(status)) {
+        return status;
+    }
     
-    /* Fetch MCFG data from PE boot args, at least until PlatformExpert updates the data. */
+    /* Fetch MCFG data from PE boot args, PlatformExpert adds the MCFG's own allocations later. */
+    gAcpiOsEcamLock = IOLockAlloc();
     boot_args *args = (boot_args *)PE_state.bootArgs;
     gPCIFromPE.Address = args->pciConfigSpaceBaseAddress;
     gPCIFromPE.PciSegment = 0;
     gPCIFromPE.StartBusNumber = args->pciConfigSpaceStartBusNumber;
     gPCIFromPE.EndBusNumber = args->pciConfigSpaceEndBusNumber;
     
-    /* Initialize ECAM if available */
-    InitializePCIEcam();
+    if (gPCIFromPE.Address != 0) {
+        AcpiOsExtAddPciEcam(&gPCIFromPE);
+    }
     
     return AE_OK;
 }
 
+/* Number of active mappings whose physical base is <= addr. */
+static UInt32 AcpiOsMapPhysIndex(ACPI_PHYSICAL_ADDRESS addr)
+{
+    UInt32 lo = 0, hi = gAcpiOsMapByPhysCount;
+
+    while (lo < hi) {
+        UInt32 mid = (lo + hi) / 2;
+        if (gAcpiOsMapByPhys[mid]->PhysBase <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Number of live mappings whose virtual base is <= va. */
+static UInt32 AcpiOsMapVirtIndex(IOVirtualAddress va)
+{
+    UInt32 lo = 0, hi = gAcpiOsMapByVirtCount;
+
+    while (lo < hi) {
+        UInt32 mid = (lo + hi) / 2;
+        if (gAcpiOsMapByVirt[mid]->VirtBase <= va) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void AcpiOsMapArrayInsert(AcpiOsMapping **array, UInt32 *count, UInt32 index, AcpiOsMapping *m)
+{
+    memmove(&array[index + 1], &array[index], (*count - index) * sizeof(AcpiOsMapping *));
+    array[index] = m;
+    (*count)++;
+}
+
+static void AcpiOsMapArrayRemove(AcpiOsMapping **array, UInt32 *count, UInt32 index)
+{
+    (*count)--;
+    memmove(&array[index], &array[index + 1], (*count - index) * sizeof(AcpiOsMapping *));
+}
+
+/* Make room for one more mapping in both indexes. */
+static bool AcpiOsMapReserve(void)
+{
+    if (gAcpiOsMapByVirtCount < gAcpiOsMapCapacity) {
+        return true;
+    }
+
+    UInt32 capacity = gAcpiOsMapCapacity ? gAcpiOsMapCapacity * 2 : 32;
+    AcpiOsMapping **byPhys = (AcpiOsMapping **)IOMalloc(capacity * sizeof(AcpiOsMapping *));
+    AcpiOsMapping **byVirt = (AcpiOsMapping **)IOMalloc(capacity * sizeof(AcpiOsMapping *));
+    if (!byPhys || !byVirt) {
+        if (byPhys) {
+            IOFree(byPhys, capacity * sizeof(AcpiOsMapping *));
+        }
+        if (byVirt) {
+            IOFree(byVirt, capacity * sizeof(AcpiOsMapping *));
+        }
+        return false;
+    }
+
+    if (gAcpiOsMapCapacity) {
+        bcopy(gAcpiOsMapByPhys, byPhys, gAcpiOsMapByPhysCount * sizeof(AcpiOsMapping *));
+        bcopy(gAcpiOsMapByVirt, byVirt, gAcpiOsMapByVirtCount * sizeof(AcpiOsMapping *));
+        IOFree(gAcpiOsMapByPhys, gAcpiOsMapCapacity * sizeof(AcpiOsMapping *));
+        IOFree(gAcpiOsMapByVirt, gAcpiOsMapCapacity * sizeof(AcpiOsMapping *));
+    }
+    gAcpiOsMapByPhys = byPhys;
+    gAcpiOsMapByVirt = byVirt;
+    gAcpiOsMapCapacity = capacity;
+    return true;
+}
+
+static void AcpiOsMapIdleInsert(AcpiOsMapping *m)
+{
+    m->IdlePrev = NULL;
+    m->IdleNext = gAcpiOsMapIdleHead;
+    if (gAcpiOsMapIdleHead) {
+        gAcpiOsMapIdleHead->IdlePrev = m;
+    } else {
+        gAcpiOsMapIdleTail = m;
+    }
+    gAcpiOsMapIdleHead = m;
+    gAcpiOsMapIdleCount++;
+}
+
+static void AcpiOsMapIdleRemove(AcpiOsMapping *m)
+{
+    if (m->IdlePrev) {
+        m->IdlePrev->IdleNext = m->IdleNext;
+    } else {
+        gAcpiOsMapIdleHead = m->IdleNext;
+    }
+    if (m->IdleNext) {
+        m->IdleNext->IdlePrev = m->IdlePrev;
+    } else {
+        gAcpiOsMapIdleTail = m->IdlePrev;
+    }
+    m->IdlePrev = m->IdleNext = NULL;
+    gAcpiOsMapIdleCount--;
+}
+
+/* Drop a mapping from every index and release it. */
+static void AcpiOsMapDestroy(AcpiOsMapping *m)
+{
+    if (!m->Retired) {
+        if (m->RefCount == 0) {
+            AcpiOsMapIdleRemove(m);
+        }
+        AcpiOsMapArrayRemove(gAcpiOsMapByPhys, &gAcpiOsMapByPhysCount, AcpiOsMapPhysIndex(m->PhysBase) - 1);
+    }
+    AcpiOsMapArrayRemove(gAcpiOsMapByVirt, &gAcpiOsMapByVirtCount, AcpiOsMapVirtIndex(m->VirtBase) - 1);
+
+    m->Map->release();
+    IOFree(m, sizeof(AcpiOsMapping));
+}
+
+/* Take a mapping out of the physical index; it lives on while it has users. */
+static void AcpiOsMapRetire(AcpiOsMapping *m)
+{
+    if (m->RefCount == 0) {
+        AcpiOsMapDestroy(m);
+        return;
+    }
+    AcpiOsMapArrayRemove(gAcpiOsMapByPhys, &gAcpiOsMapByPhysCount, AcpiOsMapPhysIndex(m->PhysBase) - 1);
+    m->Retired = true;
+}
+
+/*
+ * Map the page range [start, end), widened to cover every active mapping it
+ * overlaps, and index it in place of those. Returns with one reference held.
+ */
+static AcpiOsMapping *AcpiOsMapCreate(ACPI_PHYSICAL_ADDRESS start, ACPI_PHYSICAL_ADDRESS end)
+{
+    UInt32 first = AcpiOsMapPhysIndex(start);
+    if (first && gAcpiOsMapByPhys[first - 1]->PhysBase + gAcpiOsMapByPhys[first - 1]->Length > start) {
+        first--;
+    }
+
+    UInt32 last = first;
+    while (last < gAcpiOsMapByPhysCount && gAcpiOsMapByPhys[last]->PhysBase < end) {
+        AcpiOsMapping *old = gAcpiOsMapByPhys[last++];
+        if (old->PhysBase < start) {
+            start = old->PhysBase;
+        }
+        if (old->PhysBase + old->Length > end) {
+            end = old->PhysBase + old->Length;
+        }
+    }
+
+    if (!AcpiOsMapReserve()) {
+        return NULL;
+    }
+
+    IOMemoryDescriptor *desc = IOMemoryDescriptor::withAddressRange(start, end - start, kIOMemoryDirectionInOut | kIOMemoryMapperNone, kernel_task);
+    if (!desc) {
+        return NULL;
+    }
+    IOMemoryMap *map = desc->map();
+    desc->release();
+    if (!map) {
+        return NULL;
+    }
+
+    AcpiOsMapping *m = (AcpiOsMapping *)IOMalloc(sizeof(AcpiOsMapping));
+    if (!m) {
+        map->release();
+        return NULL;
+    }
+    bzero(m, sizeof(AcpiOsMapping));
+    m->PhysBase = start;
+    m->Length = end - start;
+    m->VirtBase = map->getVirtualAddress();
+    m->Map = map;
+    m->RefCount = 1;
+
+    /* Back to front, so the indexes of the ones still to go stay put. */
+    while (last > first) {
+        AcpiOsMapRetire(gAcpiOsMapByPhys[--last]);
+    }
+
+    AcpiOsMapArrayInsert(gAcpiOsMapByPhys, &gAcpiOsMapByPhysCount, AcpiOsMapPhysIndex(start), m);
+    AcpiOsMapArrayInsert(gAcpiOsMapByVirt, &gAcpiOsMapByVirtCount, AcpiOsMapVirtIndex(m->VirtBase), m);
+    return m;
+}
+
 void *AcpiOsExtMapMemory(ACPI_PHYSICAL_ADDRESS addr, ACPI_SIZE size)
 {
-    IOMemoryDescriptor *desc = IOMemoryDescriptor::withAddressRange(addr, size, kIOMemoryDirectionInOut | kIOMemoryMapperNone, kernel_task);
-    if (desc) {
-        IOMemoryMap *map = desc->map();
-        if (map) {
-            IOVirtualAddress va = map->getVirtualAddress();
-            IOLockLock(gAcpiOsExtMemoryMapLock);
-            gAcpiOsExtMemoryMapSet->setObject(map);
-            IOLockUnlock(gAcpiOsExtMemoryMapLock);
-            /* Don't release the map here - we need it for unmapping */
-            desc->release();
-            return (void *)va;
+    ACPI_PHYSICAL_ADDRESS start = addr & ~kAcpiOsMapPageMask;
+    ACPI_PHYSICAL_ADDRESS end = (addr + (size ? size : 1) + kAcpiOsMapPageMask) & ~kAcpiOsMapPageMask;
+    AcpiOsMapping *m;
+    void *va = NULL;
+
+    if (end <= start) {
+        return NULL; /* wraps around the top of the address space */
+    }
+
+    IOLockLock(gAcpiOsExtMemoryMapLock);
+    UInt32 index = AcpiOsMapPhysIndex(start);
+    if (index && gAcpiOsMapByPhys[index - 1]->PhysBase + gAcpiOsMapByPhys[index - 1]->Length >= end) {
+        m = gAcpiOsMapByPhys[index - 1];
+        if (m->RefCount++ == 0) {
+            AcpiOsMapIdleRemove(m);
         }
-        desc->release();
+    } else {
+        m = AcpiOsMapCreate(start, end);
     }
-    return NULL;
+    if (m) {
+        va = (void *)(m->VirtBase + (IOVirtualAddress)(addr - m->PhysBase));
+    }
+    IOLockUnlock(gAcpiOsExtMemoryMapLock);
+    return va;
 }
 
 void AcpiOsExtUnmapMemory(void *p, ACPI_SIZE size)
 {
     IOVirtualAddress va = (IOVirtualAddress)p;
+    AcpiOsMapping *m = NULL;
+
+    /* The size is implied by the mapping the address falls in. */
+    (void)size;
 
     IOLockLock(gAcpiOsExtMemoryMapLock);
-    gAcpiOsExtMemoryMapIterator->reset();
-    while (IOMemoryMap *map = OSDynamicCast(IOMemoryMap, gAcpiOsExtMemoryMapIterator->getNextObject())) {
-        if (map->getVirtualAddress() == va && map->getLength() == size) {
-            gAcpiOsExtMemoryMapSet->removeObject(map);
-            map->release(); /* Now we can release it */
-            break;
+    UInt32 index = AcpiOsMapVirtIndex(va);
+    if (index) {
+        m = gAcpiOsMapByVirt[index - 1];
+        if (va >= m->VirtBase + m->Length || m->RefCount == 0) {
+            m = NULL;
+        }
+    }
+    if (!m) {
+        IOLockUnlock(gAcpiOsExtMemoryMapLock);
+        IOLog("ACPI: unmap of unmapped address %p\n", p);
+        return;
+    }
+
+    if (--m->RefCount == 0) {
+        if (m->Retired) {
+            AcpiOsMapDestroy(m);
+        } else {
+            AcpiOsMapIdleInsert(m);
+            if (gAcpiOsMapIdleCount > kAcpiOsMapIdleLimit) {
+                AcpiOsMapDestroy(gAcpiOsMapIdleTail);
+            }
         }
     }
     IOLockUnlock(gAcpiOsExtMemoryMapLock);
@@ -249,69 +835,129 @@ ACPI_PHYSICAL_ADDRESS AcpiOsExtGetRootPointer(void)
 
 ACPI_STATUS AcpiOsExtExecute(ACPI_EXECUTE_TYPE Type, ACPI_OSD_EXEC_CALLBACK Function, void *Context)
 {
-    _iocmdq_callback_data *d = (_iocmdq_callback_data *)IOMalloc(sizeof(_iocmdq_callback_data));
+    if (!Function || (UInt32)Type >= kAcpiOsExecQueues) {
+        return AE_BAD_PARAMETER;
+    }
+
+    /* Debugger threads are started from thread context; they can allocate */
+    if (Type == OSL_DEBUGGER_MAIN_THREAD || Type == OSL_DEBUGGER_EXEC_THREAD) {
+        AcpiOsExecItem *d = (AcpiOsExecItem *)IOMalloc(sizeof(AcpiOsExecItem));
+        thread_t thread;
+        if (!d) {
+            return AE_NO_MEMORY;
+        }
+        d->Callback = Function;
+        d->Context = Context;
+        if (kernel_thread_start(&AcpiOsExecDebuggerMain, d, &thread) != KERN_SUCCESS) {
+            IOFree(d, sizeof(AcpiOsExecItem));
+            return AE_ERROR;
+        }
+        thread_deallocate(thread);
+        return AE_OK;
+    }
+
+    AcpiOsExecQueue *q = &gAcpiOsExecQueue[Type];
+    UInt64 now = mach_absolute_time();
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+    AcpiOsExecItem *d = gAcpiOsExecFree;
     if (!d) {
+        q->Refused++;
+        IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
         return AE_NO_MEMORY;
     }
-    
+    gAcpiOsExecFree = d->Next;
+
+    d->Next = NULL;
     d->Callback = Function;
     d->Context = Context;
-    
-    /* Track pending executions */
-    IOLockLock(gExecutionLock);
-    gPendingExecutions++;
-    IOLockUnlock(gExecutionLock);
-    
-    IOReturn result = gAcpiOsThreadCommandGate->runAction(&AcpiOsThreadDispatch, d);
-    
-    /* If execution failed, decrement counter */
-    if (result != kIOReturnSuccess) {
-        IOLockLock(gExecutionLock);
-        if (gPendingExecutions > 0) {
-            gPendingExecutions--;
-        }
-        IOLockUnlock(gExecutionLock);
-        IOFree(d, sizeof(_iocmdq_callback_data));
-        return AE_ERROR;
+    d->Queued = now;
+    if (q->Tail) {
+        q->Tail->Next = d;
+    } else {
+        q->Head = d;
     }
-    
+    q->Tail = d;
+    q->Queued++;
+    gPendingExecutions++;
+    bool waiting = gAcpiOsExecWaiting != 0;
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+
+    AcpiOsExecWakeWorkers(waiting);
     return AE_OK;
 }
 
 /*
- * Wait for all pending ACPI executions to complete
- * This addresses the previous comment: "How do I check that my IOCommandGate has finished all of it's runAction calls?"
+ * Wait for all queued ACPI executions to complete.
+ * A callback can get here too (by removing a handler, for instance). Its
+ * worker runs what else it can meanwhile, the rest of its own queue above
+ * all since nobody else will, and the callbacks waiting in here are not
+ * counted, or they would wait on themselves and each other. Anyone else
+ * waits for every callback to return.
  */
 void AcpiOsExtWaitEventsComplete(void)
 {
-    const int max_wait_ms = 5000; /* Maximum wait time: 5 seconds */
-    const int poll_interval_ms = 10; /* Poll every 10ms */
-    int waited_ms = 0;
+    thread_t self = current_thread();
+    bool worker = AcpiOsExecOnWorker();
     
-    /* Poll until all executions complete or timeout */
-    while (waited_ms < max_wait_ms) {
-        IOLockLock(gExecutionLock);
-        UInt32 pending = gPendingExecutions;
-        IOLockUnlock(gExecutionLock);
-        
-        if (pending == 0) {
-            break; /* All executions completed */
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+    if (!worker) {
+        while (gPendingExecutions) {
+            is = AcpiOsExecSleep(&gPendingExecutions, is);
         }
-        
-        IOSleep(poll_interval_ms);
-        waited_ms += poll_interval_ms;
+        IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+        return;
+    }
+
+    gAcpiOsExecWaiting++;
+    /* Other waiters may have been waiting on this callback */
+    if (gPendingExecutions <= gAcpiOsExecWaiting) {
+        IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+        thread_wakeup(&gPendingExecutions);
+        is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
     }
+    while (gPendingExecutions > gAcpiOsExecWaiting) {
+        AcpiOsExecQueue *q = AcpiOsExecNextQueue(self);
+        if (q) {
+            is = AcpiOsExecRun(q, is);
+        } else {
+            is = AcpiOsExecSleep(&gPendingExecutions, is);
+        }
+    }
+    gAcpiOsExecWaiting--;
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+}
+
+/* Queue wait and run times per execution type, for debugging */
+void AcpiOsExtPrintExecuteStatistics(void)
+{
+    static const char *names[kAcpiOsExecQueues] = {
+        "GlobalLock", "Notify", "Gpe", "DebuggerMain", "DebuggerExec", "EcPoll", "EcBurst"
+    };
+    AcpiOsExecQueue stats[kAcpiOsExecQueues];
     
-    if (waited_ms >= max_wait_ms) {
-        IOLockLock(gExecutionLock);
-        UInt32 remaining = gPendingExecutions;
-        IOLockUnlock(gExecutionLock);
+    /* IOLog can block; copy out first */
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(gExecutionLock);
+    memcpy(stats, gAcpiOsExecQueue, sizeof(stats));
+    IOSimpleLockUnlockEnableInterrupt(gExecutionLock, is);
+
+    for (UInt32 i = 0; i < kAcpiOsExecQueues; i++) {
+        AcpiOsExecQueue *q = &stats[i];
+        UInt64 wait = 0, maxWait = 0, run = 0;
         
-        IOLog("ACPI: Warning - %u executions still pending after %d ms timeout\n", 
-              remaining, max_wait_ms);
+        if (!q->Completed && !q->Refused) {
+            continue;
+        }
+        if (q->Completed) {
+            absolutetime_to_nanoseconds(q->WaitTime / q->Completed, &wait);
+            absolutetime_to_nanoseconds(q->RunTime / q->Completed, &run);
+        }
+        absolutetime_to_nanoseconds(q->MaxWaitTime, &maxWait);
+        IOLog("ACPI: %-12s %llu queued, %llu done, %llu refused, wait %llu us avg %llu us max, run %llu us avg\n",
+              names[i], q->Queued, q->Completed, q->Refused, wait / 1000, maxWait / 1000, run / 1000);
     }
 }
 
+
 /*
  * Enhanced PCI Configuration Space Access using ECAM/MMIO
  * This implements the missing AcpiOsReadPCIConfigSpace function
@@ -326,28 +972,18 @@ ACPI_STATUS AcpiOsReadPCIConfigSpace(ACPI_PCI_ID *PciId, UInt32 Reg, UInt64 *Val
         return AE_BAD_PARAMETER;
     }
     
-    /* Try ECAM/MMIO first if available */
-    if (gPCIEcamAvailable && gPCIEcamVirtualBase &&
-        PciId->Bus >= gPCIFromPE.StartBusNumber && 
-        PciId->Bus <= gPCIFromPE.EndBusNumber) {
-        
-        /* Calculate ECAM offset: (Bus << 20) + (Device << 15) + (Function << 12) + Register */
-        UInt32 bus_offset = (PciId->Bus - gPCIFromPE.StartBusNumber) << 20;
-        UInt32 device_offset = PciId->Device << 15;
-        UInt32 function_offset = PciId->Function << 12;
-        UInt32 total_offset = bus_offset + device_offset + function_offset + Reg;
-        
-        void *config_addr = (char *)gPCIEcamVirtualBase + total_offset;
-        
+    /* Try ECAM/MMIO first if the bus is decoded */
+    volatile void *config_addr = AcpiOsExtPciEcamAddress(PciId, Reg);
+    if (config_addr) {
         switch (Width) {
             case 8:
-                *Value = *(UInt8 *)config_addr;
+                *Value = *(volatile UInt8 *)config_addr;
                 break;
             case 16:
-                *Value = *(UInt16 *)config_addr;
+                *Value = *(volatile UInt16 *)config_addr;
                 break;
             case 32:
-                *Value = *(UInt32 *)config_addr;
+                *Value = *(volatile UInt32 *)config_addr;
                 break;
         }
         
@@ -373,28 +1009,18 @@ ACPI_STATUS AcpiOsWritePCIConfigSpace(ACPI_PCI_ID *PciId, UInt32 Reg, UInt64 Val
         return AE_BAD_PARAMETER;
     }
     
-    /* Try ECAM/MMIO first if available */
-    if (gPCIEcamAvailable && gPCIEcamVirtualBase &&
-        PciId->Bus >= gPCIFromPE.StartBusNumber && 
-        PciId->Bus <= gPCIFromPE.EndBusNumber) {
-        
-        /* Calculate ECAM offset */
-        UInt32 bus_offset = (PciId->Bus - gPCIFromPE.StartBusNumber) << 20;
-        UInt32 device_offset = PciId->Device << 15;
-        UInt32 function_offset = PciId->Function << 12;
-        UInt32 total_offset = bus_offset + device_offset + function_offset + Reg;
-        
-        void *config_addr = (char *)gPCIEcamVirtualBase + total_offset;
-        
+    /* Try ECAM/MMIO first if the bus is decoded */
+    volatile void *config_addr = AcpiOsExtPciEcamAddress(PciId, Reg);
+    if (config_addr) {
         switch (Width) {
             case 8:
-                *(UInt8 *)config_addr = (UInt8)Value;
+                *(volatile UInt8 *)config_addr = (UInt8)Value;
                 break;
             case 16:
-                *(UInt16 *)config_addr = (UInt16)Value;
+                *(volatile UInt16 *)config_addr = (UInt16)Value;
                 break;
             case 32:
-                *(UInt32 *)config_addr = (UInt32)Value;
+                *(volatile UInt32 *)config_addr = (UInt32)Value;
                 break;
         }
         
@@ -509,34 +1135,29 @@ ACPI_STATUS AcpiOsExtTerminate(void)
     /* Wait for all pending executions to complete */
     AcpiOsExtWaitEventsComplete();
     
-    /* Cleanup ECAM mapping */
-    if (gPCIEcamMap) {
-        gPCIEcamMap->release();
-        gPCIEcamMap = NULL;
-        gPCIEcamVirtualBase = NULL;
-        gPCIEcamAvailable = false;
+    /* Cleanup ECAM mappings */
+    if (gAcpiOsEcamLock) {
+        AcpiOsEcamTerminate();
+        IOLockFree(gAcpiOsEcamLock);
+        gAcpiOsEcamLock = NULL;
     }
     
-    /* Cleanup work loop and command gate */
-    if (gAcpiOsThreadCommandGate) {
-        gAcpiOsThreadCommandGate->release();
-        gAcpiOsThreadCommandGate = NULL;
-    }
-    
-    if (gAcpiOsThreadWorkLoop) {
-        gAcpiOsThreadWorkLoop->release();
-        gAcpiOsThreadWorkLoop = NULL;
-    }
+    /* Stop the execution workers */
+    AcpiOsExecStop();
     
     /* Cleanup memory maps */
-    if (gAcpiOsExtMemoryMapIterator) {
-        gAcpiOsExtMemoryMapIterator->release();
-        gAcpiOsExtMemoryMapIterator = NULL;
-    }
-    
-    if (gAcpiOsExtMemoryMapSet) {
-        gAcpiOsExtMemoryMapSet->release();
-        gAcpiOsExtMemoryMapSet = NULL;
+    if (gAcpiOsExtMemoryMapLock) {
+        IOLockLock(gAcpiOsExtMemoryMapLock);
+        while (gAcpiOsMapByVirtCount) {
+            AcpiOsMapDestroy(gAcpiOsMapByVirt[gAcpiOsMapByVirtCount - 1]);
+        }
+        if (gAcpiOsMapCapacity) {
+            IOFree(gAcpiOsMapByPhys, gAcpiOsMapCapacity * sizeof(AcpiOsMapping *));
+            IOFree(gAcpiOsMapByVirt, gAcpiOsMapCapacity * sizeof(AcpiOsMapping *));
+            gAcpiOsMapByPhys = gAcpiOsMapByVirt = NULL;
+            gAcpiOsMapCapacity = 0;
+        }
+        IOLockUnlock(gAcpiOsExtMemoryMapLock);
     }
     
     /* Cleanup locks */
@@ -546,9 +1167,13 @@ ACPI_STATUS AcpiOsExtTerminate(void)
     }
     
     if (gExecutionLock) {
-        IOLockFree(gExecutionLock);
+        IOSimpleLockFree(gExecutionLock);
         gExecutionLock = NULL;
     }
+    if (gAcpiOsExecItems) {
+        IOFree(gAcpiOsExecItems, kAcpiOsExecItems * sizeof(AcpiOsExecItem));
+        gAcpiOsExecItems = gAcpiOsExecFree = NULL;
+    }
     
     return AE_OK;
 }
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2006-2012 Apple Inc. All rights reserved.
+ *
+ * @APPLE_OSREFERENCE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. The rights granted to you under the License
+ * may not be used to create, or enable the creation or redistribution of,
+ * unlawful or unlicensed copies of an Apple operating system, or to
+ * circumvent, violate, or enable the circumvention or violation of, any
+ * terms of an Apple operating system software license agreement.
+ *
+ * Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_OSREFERENCE_LICENSE_HEADER_END@
+ */
+
+/*
+ * The part of osfmk/i386/pmCPU.h a power management kext registers with.
+ */
+
+#ifndef _I386_PMCPU_H_
+#define _I386_PMCPU_H_
+
+#include <kern/kern_types.h>
+
+#define PM_DISPATCH_VERSION     102
+
+typedef struct x86_lcpu x86_lcpu_t;
+
+/*
+ * Dispatch table to functions that get installed when the
+ * Power Management KEXT loads.
+ */
+typedef struct{
+	kern_return_t   (*pmCPUStateInit)(void);
+	void            (*cstateInit)(void);
+	uint64_t        (*MachineIdle)(uint64_t maxIdleDuration);
+	uint64_t        (*GetDeadline)(x86_lcpu_t *lcpu);
+	uint64_t        (*SetDeadline)(x86_lcpu_t *lcpu, uint64_t);
+	void            (*Deadline)(x86_lcpu_t *lcpu);
+	boolean_t       (*exitIdle)(x86_lcpu_t *lcpu);
+	void            (*markCPURunning)(x86_lcpu_t *lcpu);
+	int             (*pmCPUControl)(uint32_t cmd, void *datap);
+	void            (*pmCPUHalt)(void);
+	uint64_t        (*getMaxSnoop)(void);
+	void            (*setMaxBusDelay)(uint64_t time);
+	uint64_t        (*getMaxBusDelay)(void);
+	void            (*setMaxIntDelay)(uint64_t time);
+	uint64_t        (*getMaxIntDelay)(void);
+	void            (*pmCPUSafeMode)(x86_lcpu_t *lcpu, uint32_t flags);
+	void            (*pmTimerStateSave)(void);
+	void            (*pmTimerStateRestore)(void);
+	kern_return_t   (*exitHalt)(x86_lcpu_t *lcpu);
+	kern_return_t   (*exitHaltToOff)(x86_lcpu_t *lcpu);
+	void            (*markAllCPUsOff)(void);
+	void            (*pmSetRunCount)(uint32_t count);
+	boolean_t       (*pmIsCPUUnAvailable)(x86_lcpu_t *lcpu);
+	int             (*pmChooseCPU)(int startCPU, int endCPU, int preferredCPU);
+	int             (*pmIPIHandler)(void *state);
+	void            (*pmThreadTellUrgency)(int urgency, uint64_t rt_period, uint64_t rt_deadline);
+	void            (*pmActiveRTThreads)(boolean_t active);
+	boolean_t       (*pmInterruptPrewakeApplicable)(void);
+	void            (*pmThreadGoingOffCore)(thread_t old_thread, boolean_t transfer_load,
+	    uint64_t last_dispatch, boolean_t thread_runnable);
+} pmDispatch_t;
+
+/* The kernel's callbacks for the kext; passing NULL skips them */
+typedef struct pmCallBacks pmCallBacks_t;
+
+__BEGIN_DECLS
+void pmKextRegister(uint32_t version, pmDispatch_t *cpuFuncs,
+    pmCallBacks_t *callbacks);
+__END_DECLS
+
+#endif /* _I386_PMCPU_H_ */
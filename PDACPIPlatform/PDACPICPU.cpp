@@ -36,7 +36,18 @@
 #include "PDACPICPU.h"
 #include <IOKit/IOLib.h>
 #include <i386/machine_routines.h>
+#include <i386/proc_reg.h>
+#include <kern/thread_call.h>
+#include <libkern/OSAtomic.h>
 #include "PDACPICPUInterruptController.h"
+#include "PDACPIPerformance.h"
+#include "PDACPIIdle.h"
+
+#if __has_include(<i386/pmCPU.h>)
+#include <i386/pmCPU.h>
+#else
+#include "ExternalHeaders/i386/pmCPU.h"
+#endif
 
 #ifndef SDK_IS_PRIVATE
 
@@ -51,11 +62,413 @@ ml_processor_register(
     boolean_t       start);
 #endif
 
+/* i386/mp.h: run action on every CPU at once, interrupts off */
+extern "C" void mp_rendezvous_no_intrs(void (*action_func)(void *), void *arg);
+/* not in every SDK's i386/machine_routines.h */
+extern "C" uint32_t ml_get_apicid(uint32_t cpu);
+extern "C" uint8_t ml_port_io_read8(uint16_t ioport);
+
 PDACPICPUInterruptController *gCPUInterruptController;
 
 #define super IOService
 OSDefineMetaClassAndStructors(PDACPICPU, IOCPU)
 
+/*
+ * P-states.
+ *
+ * One engine covers every CPU, since _PSD domains span them. The first CPU
+ * to start creates it and each adds its own processor object. A thread call
+ * runs the governor every sampling period. Busy time is MPERF, which ticks
+ * at a fixed rate only in C0, against the TSC; every CPU reads both in one
+ * rendezvous. FFixedHW control writes go to the performance control MSR in
+ * another rendezvous, I/O and memory ones through AcpiWrite.
+ * gPDACPIPerformanceLock serializes the engine.
+ */
+#define kPDACPIMSRMPerf             0xE7
+#define kPDACPIMSRIntelPerfCtl      0x199
+#define kPDACPIMSRAMDPerfCtl        0xC0010062
+#define kPDACPIIntelPerfCtlMask     0xFFFFULL       /* the rest of IA32_PERF_CTL is left alone */
+#define kPDACPICPUIDVendorAMD       0x68747541      /* "Auth" of AuthenticAMD */
+
+static PDACPIPerformance *gPDACPIPerformance;
+static IOLock *gPDACPIPerformanceLock;
+static thread_call_t gPDACPIPerformanceCall;
+static bool gPDACPIPerformanceAMD;
+static bool gPDACPIPerformanceSampling;             /* MPERF exists, so the governor can run */
+static bool gPDACPIPerformanceRunning;
+static UInt32 gPDACPIPerformanceCPUs;               /* started CPUs; the last to stop tears down */
+
+struct PDACPICPURendezvous {
+    PDACPIPerformanceSample *samples;
+    UInt32 sampleCount;
+    const PDACPIPerformanceWrite *writes;
+    UInt32 writeCount;
+};
+
+static void PDACPICPUCpuid(UInt32 leaf, UInt32 regs[4])
+{
+    asm volatile("cpuid" : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3]) : "a"(leaf), "c"(0));
+}
+
+static void PDACPICPURendezvousAction(void *arg)
+{
+    PDACPICPURendezvous *r = (PDACPICPURendezvous *)arg;
+    UInt32 cpu = cpu_number();
+
+    if (cpu < r->sampleCount) {
+        r->samples[cpu].busy = rdmsr64(kPDACPIMSRMPerf);
+        r->samples[cpu].elapsed = rdtsc64();
+        r->samples[cpu].valid = true;
+    }
+
+    for (UInt32 i = 0; i < r->writeCount; i++) {
+        const PDACPIPerformanceWrite *w = &r->writes[i];
+        if (w->cpu != cpu || w->reg->SpaceId != ACPI_ADR_SPACE_FIXED_HARDWARE) {
+            continue;
+        }
+        if (gPDACPIPerformanceAMD) {
+            wrmsr64(kPDACPIMSRAMDPerfCtl, w->value);
+        } else {
+            UInt64 ctl = rdmsr64(kPDACPIMSRIntelPerfCtl);
+            wrmsr64(kPDACPIMSRIntelPerfCtl, (ctl & ~kPDACPIIntelPerfCtlMask) | (w->value & kPDACPIIntelPerfCtlMask));
+        }
+    }
+}
+
+static void PDACPICPUPerformanceSample(void *, PDACPIPerformanceSample *samples, UInt32 count)
+{
+    PDACPICPURendezvous r = { samples, count, NULL, 0 };
+
+    if (gPDACPIPerformanceSampling) {
+        mp_rendezvous_no_intrs(PDACPICPURendezvousAction, &r);
+    }
+}
+
+static void PDACPICPUPerformanceWrite(void *, const PDACPIPerformanceWrite *writes, UInt32 count)
+{
+    PDACPICPURendezvous r = { NULL, 0, writes, count };
+    bool msr = false;
+
+    for (UInt32 i = 0; i < count; i++) {
+        if (writes[i].reg->SpaceId == ACPI_ADR_SPACE_FIXED_HARDWARE) {
+            msr = true;
+        } else {
+            AcpiWrite(writes[i].value, (ACPI_GENERIC_ADDRESS *)writes[i].reg);
+        }
+    }
+    if (msr) {
+        mp_rendezvous_no_intrs(PDACPICPURendezvousAction, &r);
+    }
+}
+
+static void PDACPICPUPerformanceTick(thread_call_param_t, thread_call_param_t)
+{
+    uint64_t deadline;
+
+    IOLockLock(gPDACPIPerformanceLock);
+    if (!gPDACPIPerformanceRunning) {
+        /* stopPerformance is waiting for this call to finish */
+        IOLockUnlock(gPDACPIPerformanceLock);
+        return;
+    }
+    PDACPIPerformanceUpdate(gPDACPIPerformance);
+    clock_interval_to_deadline(PDACPIPerformanceGetSamplingInterval(gPDACPIPerformance), kMillisecondScale, &deadline);
+    thread_call_enter_delayed(gPDACPIPerformanceCall, deadline);
+    IOLockUnlock(gPDACPIPerformanceLock);
+}
+
+/* settings is the personality's "Performance Governor" dictionary, if any */
+static void PDACPICPUCreatePerformance(OSDictionary *settings)
+{
+    PDACPIPerformanceBackend backend = { PDACPICPUPerformanceSample, PDACPICPUPerformanceWrite, NULL };
+    PDACPIPerformanceGovernor governor = {};
+    UInt32 regs[4];
+
+    if (settings) {
+        OSNumber *n;
+        if ((n = OSDynamicCast(OSNumber, settings->getObject("Sampling Interval")))) {
+            governor.samplingMS = n->unsigned32BitValue();
+        }
+        if ((n = OSDynamicCast(OSNumber, settings->getObject("Up Threshold")))) {
+            governor.upThreshold = n->unsigned32BitValue();
+        }
+        if ((n = OSDynamicCast(OSNumber, settings->getObject("Target Load")))) {
+            governor.targetLoad = n->unsigned32BitValue();
+        }
+        if ((n = OSDynamicCast(OSNumber, settings->getObject("Down Samples")))) {
+            governor.downSamples = n->unsigned32BitValue();
+        }
+    }
+
+    PDACPICPUCpuid(0, regs);
+    gPDACPIPerformanceAMD = regs[1] == kPDACPICPUIDVendorAMD;
+    if (regs[0] >= 6) {
+        PDACPICPUCpuid(6, regs);
+        gPDACPIPerformanceSampling = regs[2] & 1;   /* APERF/MPERF */
+    }
+    if (!gPDACPIPerformanceSampling) {
+        IOLog("ACPI: no MPERF, P-states are set by hand only\n");
+    }
+
+    gPDACPIPerformanceCall = thread_call_allocate(PDACPICPUPerformanceTick, NULL);
+    if (gPDACPIPerformanceCall) {
+        gPDACPIPerformance = PDACPIPerformanceCreate(ml_get_max_cpus(), &backend, &governor);
+    }
+}
+
+void PDACPICPU::startPerformance()
+{
+    if (!gPDACPIPerformanceLock) {
+        IOLock *lock = IOLockAlloc();
+        if (lock && !OSCompareAndSwapPtr(NULL, lock, (void * volatile *)&gPDACPIPerformanceLock)) {
+            IOLockFree(lock);
+        }
+        if (!gPDACPIPerformanceLock) {
+            return;
+        }
+    }
+
+    IOLockLock(gPDACPIPerformanceLock);
+    if (!gPDACPIPerformance) {
+        PDACPICPUCreatePerformance(OSDynamicCast(OSDictionary, getProperty("Performance Governor")));
+    }
+    bool added = gPDACPIPerformance &&
+                 PDACPIPerformanceAddProcessor(gPDACPIPerformance, logicalCPU, acpiProcessor) == kIOReturnSuccess;
+    if (added) {
+        gPDACPIPerformanceCPUs++;
+    }
+    if (added && gPDACPIPerformanceSampling && !gPDACPIPerformanceRunning) {
+        gPDACPIPerformanceRunning = true;
+        thread_call_enter(gPDACPIPerformanceCall);
+    }
+    IOLockUnlock(gPDACPIPerformanceLock);
+
+    performanceStarted = added;
+    if (added) {
+        publishPStates();
+        /* Notify 0x80: _PPC changed */
+        AcpiInstallNotifyHandler(acpiProcessor, ACPI_DEVICE_NOTIFY, processorNotify, this);
+    }
+}
+
+void PDACPICPU::stopPerformance()
+{
+    thread_call_t call = NULL;
+    PDACPIPerformance *perf = NULL;
+
+    IOLockLock(gPDACPIPerformanceLock);
+    PDACPIPerformanceRemoveProcessor(gPDACPIPerformance, logicalCPU);
+    if (!--gPDACPIPerformanceCPUs) {
+        /* The engine and its thread call go with the last CPU; the next to start makes new ones */
+        gPDACPIPerformanceRunning = false;
+        call = gPDACPIPerformanceCall;
+        perf = gPDACPIPerformance;
+        gPDACPIPerformanceCall = NULL;
+        gPDACPIPerformance = NULL;
+    }
+    IOLockUnlock(gPDACPIPerformanceLock);
+    performanceStarted = false;
+
+    if (call) {
+        /* A tick already running sees gPDACPIPerformanceRunning clear and doesn't re-arm */
+        thread_call_cancel_wait(call);
+        thread_call_free(call);
+    }
+    if (perf) {
+        PDACPIPerformanceDestroy(perf);
+    }
+}
+
+void PDACPICPU::publishPStates()
+{
+    const PDACPIPState *states;
+    UInt32 count = PDACPIPerformanceGetStates(gPDACPIPerformance, logicalCPU, &states);
+
+    pStateArray = OSArray::withCapacity(count);
+    if (!pStateArray) {
+        return;
+    }
+    for (UInt32 i = 0; i < count; i++) {
+        OSDictionary *dict = OSDictionary::withCapacity(5);
+        if (!dict) {
+            continue;
+        }
+        OSNumber *num;
+        if ((num = OSNumber::withNumber(states[i].frequency, 32))) {
+            dict->setObject("Frequency", num);
+            num->release();
+        }
+        if ((num = OSNumber::withNumber(states[i].power, 32))) {
+            dict->setObject("Power", num);
+            num->release();
+        }
+        if ((num = OSNumber::withNumber(states[i].latency, 32))) {
+            dict->setObject("Latency", num);
+            num->release();
+        }
+        if ((num = OSNumber::withNumber(states[i].control, 64))) {
+            dict->setObject("Control", num);
+            num->release();
+        }
+        /* Entries keep their _PSS index, so switchToPState's index is the array's */
+        dict->setObject("Valid", states[i].valid ? kOSBooleanTrue : kOSBooleanFalse);
+        pStateArray->setObject(dict);
+        dict->release();
+    }
+    setProperty("P-States", pStateArray);
+}
+
+void PDACPICPU::processorNotify(ACPI_HANDLE, UINT32 value, void *context)
+{
+    PDACPICPU *cpu = (PDACPICPU *)context;
+
+    if (value != 0x80) {
+        return;
+    }
+    IOLockLock(gPDACPIPerformanceLock);
+    PDACPIPerformanceUpdateLimit(gPDACPIPerformance, cpu->logicalCPU);
+    cpu->currentPState = PDACPIPerformanceGetCurrentState(gPDACPIPerformance, cpu->logicalCPU);
+    IOLockUnlock(gPDACPIPerformanceLock);
+}
+
+/*
+ * C-states.
+ *
+ * One engine covers every CPU so it can be sized once; each CPU only ever
+ * touches its own slot, so nothing is locked. enterCState and
+ * getBestCStateForLatency number states from 1 in the order the engine
+ * keeps them, which makes 1 the HLT state it always has first.
+ *
+ * The kernel's idle loop calls whatever power management dispatch is
+ * registered, interrupts off, and halts by itself when there is none. The
+ * first CPU with idle states registers ours. It can only be done once and
+ * never undone, and a second registration panics, so this can't share a
+ * kernel with AppleIntelCPUPowerManagement or XCPM; a PureDarwin kernel
+ * has neither. The latency limit is the kernel's interrupt delay bound,
+ * which it sets through the same table.
+ */
+static PDACPIIdle *gPDACPIIdle;
+static PDACPICPU **gPDACPIIdleCPUs;                 /* by cpu_number(), NULL until that CPU's states are in */
+static volatile UInt32 gPDACPIIdleRegistered;
+static volatile UInt32 gPDACPIIdleCPUCount;         /* CPUs in gPDACPIIdleCPUs */
+static volatile UInt64 gPDACPIIdleMaxIntDelay = ~0ULL;  /* ns */
+
+/* I/O C3 only disables bus master arbitration once every CPU is in it */
+static IOSimpleLock *gPDACPIIdleC3Lock;
+static UInt32 gPDACPIIdleC3Count;
+
+static uint64_t PDACPICPUMachineIdle(uint64_t)
+{
+    PDACPICPU *cpu = gPDACPIIdleCPUs[cpu_number()];
+
+    if (!cpu) {
+        asm volatile("sti; hlt; cli" : : : "memory");
+        return 0;
+    }
+    UInt64 limit = gPDACPIIdleMaxIntDelay / 1000;
+    cpu->enterCState(cpu->getBestCStateForLatency((uint32_t)ACPI_MIN(limit, 0xFFFFFFFFULL)));
+    return 0;
+}
+
+static void PDACPICPUSetMaxIntDelay(uint64_t time)
+{
+    gPDACPIIdleMaxIntDelay = time ? time : ~0ULL;
+}
+
+static uint64_t PDACPICPUGetMaxIntDelay(void)
+{
+    return gPDACPIIdleMaxIntDelay == ~0ULL ? 0 : gPDACPIIdleMaxIntDelay;
+}
+
+static pmDispatch_t gPDACPIIdleDispatch;
+
+void PDACPICPU::startIdle()
+{
+    UInt32 cpuCount = ml_get_max_cpus();
+
+    if (!gPDACPIIdle) {
+        PDACPIIdle *idle = PDACPIIdleCreate(cpuCount);
+        if (idle && !OSCompareAndSwapPtr(NULL, idle, (void * volatile *)&gPDACPIIdle)) {
+            PDACPIIdleDestroy(idle);
+        }
+        if (!gPDACPIIdle) {
+            return;
+        }
+    }
+    if (!gPDACPIIdleC3Lock) {
+        IOSimpleLock *lock = IOSimpleLockAlloc();
+        if (lock && !OSCompareAndSwapPtr(NULL, lock, (void * volatile *)&gPDACPIIdleC3Lock)) {
+            IOSimpleLockFree(lock);
+        }
+    }
+    if (!gPDACPIIdleCPUs) {
+        PDACPICPU **cpus = (PDACPICPU **)IOMalloc(cpuCount * sizeof(PDACPICPU *));
+        if (cpus) {
+            bzero(cpus, cpuCount * sizeof(PDACPICPU *));
+            if (!OSCompareAndSwapPtr(NULL, cpus, (void * volatile *)&gPDACPIIdleCPUs)) {
+                IOFree(cpus, cpuCount * sizeof(PDACPICPU *));
+            }
+        }
+    }
+
+    if (PDACPIIdleAddProcessor(gPDACPIIdle, logicalCPU, acpiProcessor) != kIOReturnSuccess) {
+        return;
+    }
+    publishCStates();
+
+    if (!gPDACPIIdleCPUs || !gPDACPIIdleC3Lock) {
+        IOLog("ACPI: no memory for the idle dispatch, CPU %u halts instead\n", logicalCPU);
+        return;
+    }
+    OSIncrementAtomic((volatile SInt32 *)&gPDACPIIdleCPUCount);
+    OSMemoryBarrier();
+    gPDACPIIdleCPUs[logicalCPU] = this;
+
+    if (OSCompareAndSwap(0, 1, &gPDACPIIdleRegistered)) {
+        gPDACPIIdleDispatch.MachineIdle = PDACPICPUMachineIdle;
+        gPDACPIIdleDispatch.setMaxIntDelay = PDACPICPUSetMaxIntDelay;
+        gPDACPIIdleDispatch.getMaxIntDelay = PDACPICPUGetMaxIntDelay;
+        pmKextRegister(PM_DISPATCH_VERSION, &gPDACPIIdleDispatch, NULL);
+    }
+}
+
+void PDACPICPU::publishCStates()
+{
+    const PDACPICState *states;
+    UInt32 count = PDACPIIdleGetStates(gPDACPIIdle, logicalCPU, &states);
+
+    cStateArray = OSArray::withCapacity(count);
+    if (!cStateArray) {
+        return;
+    }
+    for (UInt32 i = 0; i < count; i++) {
+        OSDictionary *dict = OSDictionary::withCapacity(4);
+        if (!dict) {
+            continue;
+        }
+        OSNumber *num;
+        if ((num = OSNumber::withNumber(states[i].type, 32))) {
+            dict->setObject("Type", num);
+            num->release();
+        }
+        if ((num = OSNumber::withNumber(states[i].latency, 32))) {
+            dict->setObject("Latency", num);
+            num->release();
+        }
+        if ((num = OSNumber::withNumber(states[i].residency, 32))) {
+            dict->setObject("Residency", num);
+            num->release();
+        }
+        if ((num = OSNumber::withNumber(states[i].power, 32))) {
+            dict->setObject("Power", num);
+            num->release();
+        }
+        cStateArray->setObject(dict);
+        dict->release();
+    }
+    setProperty("C-States", cStateArray);
+}
+
 bool PDACPICPU::start(IOService *provider)
 {
     IOLog("PDACPICPU::start\n");
@@ -74,10 +487,43 @@ bool PDACPICPU::start(IOService *provider)
     /* ^ so when the hell do i 'boot' the CPU? when do i 'start' the CPU? */
     /* do i call ml_processor_register again? what */
 
+    /* cpu_number() is what the P-state engine and its rendezvous go by */
+    logicalCPU = kPDACPIPerformanceNoState;
+    for (uint32_t cpu = 0; cpu < ml_get_max_cpus(); cpu++) {
+        if (ml_get_apicid(cpu) == lapic->unsigned32BitValue()) {
+            logicalCPU = cpu;
+            setCPUNumber(cpu);
+            break;
+        }
+    }
+    acpiProcessor = id ? PDACPIFindProcessor(id->unsigned32BitValue()) : NULL;
+    if (acpiProcessor && logicalCPU != kPDACPIPerformanceNoState) {
+        startPerformance();
+        startIdle();
+    }
+
     registerService();
     return true;
 }
 
+void PDACPICPU::stop(IOService *provider)
+{
+    if (acpiProcessor) {
+        AcpiRemoveNotifyHandler(acpiProcessor, ACPI_DEVICE_NOTIFY, processorNotify);
+    }
+    if (performanceStarted) {
+        stopPerformance();
+    }
+    if (gPDACPIIdleCPUs && gPDACPIIdleCPUs[logicalCPU] == this) {
+        /* The dispatch stays registered; this CPU goes back to plain halts */
+        gPDACPIIdleCPUs[logicalCPU] = NULL;
+        OSDecrementAtomic((volatile SInt32 *)&gPDACPIIdleCPUCount);
+    }
+    OSSafeReleaseNULL(pStateArray);
+    OSSafeReleaseNULL(cStateArray);
+    super::stop(provider);
+}
+
 void PDACPICPU::initCPU(bool boot)
 {
     /* mmm... */
@@ -111,35 +557,122 @@ kern_return_t PDACPICPU::startCPU(vm_offset_t, vm_offset_t)
     return KERN_SUCCESS;
 }
 
+/*
+ * Halt until an interrupt, with interrupts off going in and coming out. STI
+ * only takes effect after the next instruction, so one arriving between it
+ * and HLT still wakes us; the handler runs before CLI.
+ */
 void PDACPICPU::enterC1()
 {
-    asm volatile("hlt");
+    asm volatile("sti; hlt; cli" : : : "memory");
+}
+
+/* Read the I/O port that enters state; C3 keeps bus masters off the bus while the caches don't snoop */
+static void PDACPICPUEnterIO(const PDACPICState *state)
+{
+    bool arbiter = state->busMasterAvoid && AcpiGbl_FADT.XPm2ControlBlock.Address && AcpiGbl_FADT.Pm2ControlLength;
+    UINT64 dummy;
+
+    if (arbiter) {
+        IOSimpleLockLock(gPDACPIIdleC3Lock);
+        if (++gPDACPIIdleC3Count == gPDACPIIdleCPUCount) {
+            AcpiWriteBitRegister(ACPI_BITREG_ARB_DISABLE, 1);
+        }
+        IOSimpleLockUnlock(gPDACPIIdleC3Lock);
+    } else if (state->busMasterAvoid) {
+        /* No arbiter to turn off: write back the caches instead */
+        asm volatile("wbinvd" : : : "memory");
+    }
+
+    ml_port_io_read8((uint16_t)state->address);
+    /* Some chipsets only stop the clock on the next bus cycle; give them one */
+    AcpiRead(&dummy, &AcpiGbl_FADT.XPmTimerBlock);
+
+    if (arbiter) {
+        IOSimpleLockLock(gPDACPIIdleC3Lock);
+        if (gPDACPIIdleC3Count-- == gPDACPIIdleCPUCount) {
+            AcpiWriteBitRegister(ACPI_BITREG_ARB_DISABLE, 0);
+        }
+        IOSimpleLockUnlock(gPDACPIIdleC3Lock);
+    }
 }
 
+/* Called on this CPU with interrupts off; cstateType counts from 1, as getBestCStateForLatency returns */
 void PDACPICPU::enterCState(uint32_t cstateType)
 {
-    switch (cstateType)
-    {
-        case 1:
+    const PDACPICState *states;
+    UInt32 count = gPDACPIIdle ? PDACPIIdleGetStates(gPDACPIIdle, logicalCPU, &states) : 0;
+
+    if (!count) {
+        if (cstateType == 1) {
             enterC1();
+        }
+        return;
+    }
+    if (cstateType < 1 || cstateType > count) {
+        return;
+    }
+
+    UInt32 index = cstateType - 1;
+    UINT32 busMaster = 0;
+
+    /* Bus masters were active since we last looked: clear the status and settle for a state that doesn't mind */
+    if (states[index].busMasterAvoid) {
+        AcpiReadBitRegister(ACPI_BITREG_BUS_MASTER_STATUS, &busMaster);
+        if (busMaster) {
+            AcpiWriteBitRegister(ACPI_BITREG_BUS_MASTER_STATUS, 1);
+            while (index && states[index].busMasterAvoid) {
+                index--;
+            }
+        }
+    }
+
+    const PDACPICState *state = &states[index];
+    uint64_t start = mach_absolute_time();
+    uint64_t idleNS;
+
+    switch (state->method) {
+        case kPDACPIIdleMethodMwait:
+            asm volatile("monitor" : : "a"(&idleMonitor), "c"(0), "d"(0));
+            /* ECX bit 0: an interrupt wakes us even though they're masked */
+            asm volatile("mwait" : : "a"((uint32_t)state->address), "c"(1) : "memory");
+            break;
+        case kPDACPIIdleMethodIO:
+            PDACPICPUEnterIO(state);
             break;
         default:
+            enterC1();
             break;
     }
+
+    absolutetime_to_nanoseconds(mach_absolute_time() - start, &idleNS);
+    PDACPIIdleReflect(gPDACPIIdle, logicalCPU, index, idleNS / 1000);
 }
 
 bool PDACPICPU::switchToPState(uint32_t index)
 {
-    if (index == currentPState)
-        return true;
+    if (!gPDACPIPerformanceLock)
+        return false;
 
-    IOLog("PDACPICPU: Switching to P-State %u\n", index);
-    currentPState = index;
-    return true;
+    /* The engine goes away when the last CPU stops, so look for it under the lock */
+    IOLockLock(gPDACPIPerformanceLock);
+    if (!gPDACPIPerformance) {
+        IOLockUnlock(gPDACPIPerformanceLock);
+        return false;
+    }
+    IOReturn ret = PDACPIPerformanceSetState(gPDACPIPerformance, logicalCPU, index);
+    currentPState = PDACPIPerformanceGetCurrentState(gPDACPIPerformance, logicalCPU);
+    IOLockUnlock(gPDACPIPerformanceLock);
+
+    /* The governor is free to move it again next period */
+    return ret == kIOReturnSuccess;
 }
 
 uint32_t PDACPICPU::getBestCStateForLatency(uint32_t maxAllowedLatencyUs)
 {
-    // Simulated: always return C1
-    return 1;
+    if (!gPDACPIIdle)
+        return 1;
+
+    /* The next timer deadline isn't ours to see; go by recent idle periods alone */
+    return PDACPIIdleSelect(gPDACPIIdle, logicalCPU, maxAllowedLatencyUs, kPDACPIIdleNoTimer) + 1;
 }
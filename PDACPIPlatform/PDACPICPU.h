@@ -56,9 +56,21 @@ private:
     uint32_t currentPState;
     OSArray* pStateArray;
     OSArray* cStateArray;
+    uint32_t logicalCPU;        /* cpu_number() of this CPU */
+    ACPI_HANDLE acpiProcessor;  /* Processor object or ACPI0007 device */
+    uint64_t idleMonitor;       /* MONITOR target for MWAIT idle states */
+    bool performanceStarted;    /* added to the P-state engine */
+
+    void startPerformance(void);
+    void stopPerformance(void);
+    void publishPStates(void);
+    void startIdle(void);
+    void publishCStates(void);
+    static void processorNotify(ACPI_HANDLE handle, UINT32 value, void *context);
 
 public:
     virtual bool start(IOService* provider) override;
+    virtual void stop(IOService* provider) override;
     
     virtual kern_return_t startCPU(vm_offset_t start_paddr, vm_offset_t arg_paddr) override;
     virtual void initCPU(bool boot) override;
@@ -0,0 +1,765 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#include "PDACPIEmbeddedController.h"
+#include <IOKit/IOLib.h>
+#include <kern/clock.h>
+#include <kern/sched_prim.h>
+
+#define super OSObject
+OSDefineMetaClassAndStructors(PDACPIEmbeddedController, OSObject)
+
+/* ACPI 6.5, 12.2.1 and 12.3 */
+#define kPDACPIECStatusOBF              0x01    /* output buffer full */
+#define kPDACPIECStatusIBF              0x02    /* input buffer full */
+#define kPDACPIECStatusBurst            0x10
+#define kPDACPIECStatusSCIEvent         0x20    /* a query is waiting */
+
+#define kPDACPIECCommandRead            0x80
+#define kPDACPIECCommandWrite           0x81
+#define kPDACPIECCommandBurstEnable     0x82
+#define kPDACPIECCommandBurstDisable    0x83
+#define kPDACPIECCommandQuery           0x84
+#define kPDACPIECBurstAcknowledge       0x90
+
+#define kPDACPIECTimeoutMS              500     /* without the EC taking a step */
+#define kPDACPIECPollDelayUS            10
+#define kPDACPIECPollSpins              100     /* busy-poll this long before blocking between polls */
+#define kPDACPIECMaxQueries             32      /* queries fetched per SCI_EVT */
+#define kPDACPIECChunk                  8       /* transactions queued at once by transfer() */
+#define kPDACPIECGlobalLockTimeoutMS    1000
+#define kPDACPIECQueryPollMS            100     /* SCI_EVT poll until the GPE is seen */
+
+/*
+ * One EC command. data[0, writeLength) goes to the EC after the command
+ * byte, then readLength bytes come back into data[writeLength...]. The
+ * transaction lives on the submitter's stack and is off the queue by the
+ * time runTransactions returns.
+ */
+struct PDACPIECTransaction {
+    PDACPIECTransaction *next;
+    UInt8 command;
+    UInt8 data[2];
+    UInt8 writeLength;
+    UInt8 readLength;
+    UInt8 index;
+    bool started;           /* command byte written */
+    bool notify;            /* the submitter waits on this one */
+    volatile bool done;
+};
+
+static void PDACPIECQueryWork(void *context)
+{
+    ((PDACPIEmbeddedController *)context)->fetchQueries();
+}
+
+static void PDACPIECEvaluateWork(void *context)
+{
+    ((PDACPIEmbeddedController *)context)->evaluateQueries();
+}
+
+static void PDACPIECPollTimer(thread_call_param_t context, thread_call_param_t)
+{
+    ((PDACPIEmbeddedController *)context)->pollQueries();
+}
+
+static UINT32 PDACPIECGPEHandler(ACPI_HANDLE, UINT32, void *context)
+{
+    return ((PDACPIEmbeddedController *)context)->handleGPE();
+}
+
+/* EC OperationRegion accesses, by way of the platform expert's space registry. */
+static IOReturn PDACPIECSpaceHandler(UInt32 operation, IOACPIAddress address, UInt64 *value,
+                                     UInt32 bitWidth, UInt32, void *context)
+{
+    PDACPIEmbeddedController *ec = (PDACPIEmbeddedController *)context;
+    UInt32 length = bitWidth / 8;
+    UInt8 bytes[8];
+
+    if (!value || !length || length > sizeof(bytes) || (bitWidth & 7) || address.addr64 + length > 256) {
+        return kIOReturnBadArgument;
+    }
+
+    if (operation == kIOACPIAddressSpaceOpWrite) {
+        for (UInt32 i = 0; i < length; i++) {
+            bytes[i] = (UInt8)(*value >> (i * 8));
+        }
+        return ec->write((UInt8)address.addr64, bytes, length);
+    }
+
+    IOReturn ret = ec->read((UInt8)address.addr64, bytes, length);
+    if (ret == kIOReturnSuccess) {
+        *value = 0;
+        for (UInt32 i = 0; i < length; i++) {
+            *value |= (UInt64)bytes[i] << (i * 8);
+        }
+    }
+    return ret;
+}
+
+PDACPIEmbeddedController *PDACPIEmbeddedController::withECDT(const ACPI_TABLE_ECDT *ecdt, UInt32 length)
+{
+    if (!ecdt || length < sizeof(ACPI_TABLE_ECDT) ||
+        ecdt->Control.SpaceId != ACPI_ADR_SPACE_SYSTEM_IO || ecdt->Data.SpaceId != ACPI_ADR_SPACE_SYSTEM_IO ||
+        !ecdt->Control.Address || !ecdt->Data.Address) {
+        return NULL;
+    }
+
+    /* Id is the EC's namepath; it may not resolve until the namespace has the device */
+    ACPI_HANDLE device = NULL;
+    if (length > sizeof(ACPI_TABLE_ECDT) && memchr(ecdt->Id, 0, length - sizeof(ACPI_TABLE_ECDT))) {
+        AcpiGetHandle(NULL, (char *)ecdt->Id, &device);
+    }
+
+    PDACPIEmbeddedController *ec = OSTypeAlloc(PDACPIEmbeddedController);
+    if (ec && !ec->initWithPorts((ACPI_IO_ADDRESS)ecdt->Control.Address, (ACPI_IO_ADDRESS)ecdt->Data.Address,
+                                 device, ecdt->Gpe, true)) {
+        ec->release();
+        return NULL;
+    }
+    return ec;
+}
+
+struct PDACPIECResources {
+    ACPI_IO_ADDRESS port[2];
+    UInt32 count;
+};
+
+static ACPI_STATUS PDACPIECResourceCallback(ACPI_RESOURCE *resource, void *context)
+{
+    PDACPIECResources *res = (PDACPIECResources *)context;
+
+    if (res->count >= 2) {
+        return AE_CTRL_TERMINATE;
+    }
+    if (resource->Type == ACPI_RESOURCE_TYPE_IO) {
+        res->port[res->count++] = resource->Data.Io.Minimum;
+    } else if (resource->Type == ACPI_RESOURCE_TYPE_FIXED_IO) {
+        res->port[res->count++] = resource->Data.FixedIo.Address;
+    }
+    return AE_OK;
+}
+
+PDACPIEmbeddedController *PDACPIEmbeddedController::withDevice(ACPI_HANDLE device)
+{
+    PDACPIECResources res = {};
+
+    /* _CRS lists the data port first, then command/status */
+    if (ACPI_FAILURE(AcpiWalkResources(device, (char *)METHOD_NAME__CRS, PDACPIECResourceCallback, &res)) ||
+        res.count < 2) {
+        IOLog("ACPI: EC has no usable _CRS\n");
+        return NULL;
+    }
+
+    /* _GPE may also be a package naming a GPE block device; only the FADT blocks are handled here */
+    ACPI_OBJECT gpe;
+    ACPI_BUFFER buffer = { sizeof(gpe), &gpe };
+    bool hasGPE = ACPI_SUCCESS(AcpiEvaluateObjectTyped(device, (char *)"_GPE", NULL, &buffer, ACPI_TYPE_INTEGER));
+
+    PDACPIEmbeddedController *ec = OSTypeAlloc(PDACPIEmbeddedController);
+    if (ec && !ec->initWithPorts(res.port[1], res.port[0], device, hasGPE ? (UInt32)gpe.Integer.Value : 0, hasGPE)) {
+        ec->release();
+        return NULL;
+    }
+    return ec;
+}
+
+bool PDACPIEmbeddedController::initWithPorts(ACPI_IO_ADDRESS command, ACPI_IO_ADDRESS data, ACPI_HANDLE device,
+                                             UInt32 gpe, bool hasGPE)
+{
+    if (!super::init()) {
+        return false;
+    }
+
+    this->m_lock = IOSimpleLockAlloc();
+    this->m_pollCall = thread_call_allocate(PDACPIECPollTimer, this);
+    if (!this->m_lock || !this->m_pollCall) {
+        return false;
+    }
+
+    this->m_commandPort = command;
+    this->m_dataPort = data;
+    this->m_device = device;
+    this->m_gpe = gpe;
+    this->m_hasGPE = hasGPE;
+
+    IOLog("ACPI: EC at 0x%llx/0x%llx, GPE %d\n", (UInt64)command, (UInt64)data, hasGPE ? (int)gpe : -1);
+    return true;
+}
+
+void PDACPIEmbeddedController::free(void)
+{
+    if (this->m_pollCall) {
+        thread_call_free(this->m_pollCall);
+        this->m_pollCall = NULL;
+    }
+    if (this->m_lock) {
+        IOSimpleLockFree(this->m_lock);
+        this->m_lock = NULL;
+    }
+    super::free();
+}
+
+bool PDACPIEmbeddedController::attach(IOACPIPlatformExpert *platform)
+{
+    return platform->registerAddressSpaceHandler(NULL, kIOACPIAddressSpaceIDEmbeddedController,
+                                                 PDACPIECSpaceHandler, this, 0) == kIOReturnSuccess;
+}
+
+void PDACPIEmbeddedController::detach(IOACPIPlatformExpert *platform)
+{
+    platform->unregisterAddressSpaceHandler(NULL, kIOACPIAddressSpaceIDEmbeddedController, PDACPIECSpaceHandler, 0);
+
+    if (this->m_gpeInstalled) {
+        AcpiDisableGpe(NULL, this->m_gpe);
+        AcpiRemoveGpeHandler(NULL, this->m_gpe, PDACPIECGPEHandler);
+        this->m_gpeInstalled = false;
+    }
+
+    /* The timer only rearms itself while m_polling is set */
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    this->m_polling = false;
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+    thread_call_cancel_wait(this->m_pollCall);
+
+    /* Query and _Qxx workers hold a pointer to us */
+    AcpiOsWaitEventsComplete();
+
+    IOLog("ACPI: EC %llu transactions (%llu timed out, %llu burst transfers), %llu GPEs, "
+          "%llu queries (%llu coalesced, %llu found by polling)\n",
+          this->m_transactions, this->m_timeouts, this->m_burstTransfers, this->m_gpeCount,
+          this->m_queries, this->m_queriesCoalesced, this->m_queryPolls);
+}
+
+bool PDACPIEmbeddedController::enableEvents(void)
+{
+    ACPI_STATUS status = AE_NOT_EXIST;
+
+    if (this->m_device) {
+        ACPI_OBJECT glk;
+        ACPI_BUFFER buffer = { sizeof(glk), &glk };
+        if (ACPI_SUCCESS(AcpiEvaluateObjectTyped(this->m_device, (char *)"_GLK", NULL, &buffer, ACPI_TYPE_INTEGER))) {
+            this->m_globalLock = glk.Integer.Value != 0;
+        }
+    }
+
+    if (this->m_hasGPE && !this->m_gpeInstalled) {
+        status = AcpiInstallGpeHandler(NULL, this->m_gpe, ACPI_GPE_EDGE_TRIGGERED, PDACPIECGPEHandler, this);
+        if (ACPI_SUCCESS(status)) {
+            status = AcpiEnableGpe(NULL, this->m_gpe);
+            if (ACPI_FAILURE(status)) {
+                AcpiRemoveGpeHandler(NULL, this->m_gpe, PDACPIECGPEHandler);
+            }
+        }
+        if (ACPI_FAILURE(status)) {
+            IOLog("ACPI: EC GPE %u not usable (%s), polling\n", this->m_gpe, AcpiFormatException(status));
+        } else {
+            this->m_gpeInstalled = true;
+        }
+    }
+
+    /* Pick up an event raised before the handler went in, and look for more until a GPE shows up */
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    bool query = this->advanceLocked();
+    if (this->m_device && !this->m_polling && !this->m_gpeSeen) {
+        this->m_polling = true;
+        this->schedulePollLocked();
+    }
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+    if (query) {
+        this->scheduleQuery();
+    }
+    return this->m_gpeInstalled;
+}
+
+void PDACPIEmbeddedController::schedulePollLocked(void)
+{
+    UInt64 deadline;
+
+    clock_interval_to_deadline(kPDACPIECQueryPollMS, kMillisecondScale, &deadline);
+    thread_call_enter_delayed(this->m_pollCall, deadline);
+}
+
+/*
+ * Poll timer: without a GPE, SCI_EVT is otherwise only noticed when an
+ * access happens to read the status register. Stops once a GPE is seen.
+ */
+void PDACPIEmbeddedController::pollQueries(void)
+{
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    bool query = this->advanceLocked();
+    if (query) {
+        this->m_queryPolls++;
+    }
+    if (this->m_polling && !this->m_gpeSeen) {
+        this->schedulePollLocked();
+    } else {
+        this->m_polling = false;
+    }
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+    if (query) {
+        this->scheduleQuery();
+    }
+}
+
+UInt8 PDACPIEmbeddedController::readStatus(void)
+{
+    UInt32 value = 0;
+    AcpiOsReadPort(this->m_commandPort, &value, 8);
+    return (UInt8)value;
+}
+
+/*
+ * Move the head transaction one step if the EC is ready for it. Returns
+ * false when the EC has to do something first.
+ */
+bool PDACPIEmbeddedController::stepLocked(UInt8 status)
+{
+    PDACPIECTransaction *txn = this->m_head;
+    UInt32 value;
+
+    if (!txn) {
+        return false;
+    }
+
+    if (!txn->started) {
+        if (status & kPDACPIECStatusIBF) {
+            return false;
+        }
+        if (status & kPDACPIECStatusOBF) {
+            /* Left over from a transaction that was given up on */
+            AcpiOsReadPort(this->m_dataPort, &value, 8);
+        }
+        AcpiOsWritePort(this->m_commandPort, txn->command, 8);
+        txn->started = true;
+        return true;
+    }
+
+    if (txn->index < txn->writeLength) {
+        if (status & kPDACPIECStatusIBF) {
+            return false;
+        }
+        AcpiOsWritePort(this->m_dataPort, txn->data[txn->index++], 8);
+        return true;
+    }
+
+    if (txn->index < txn->writeLength + txn->readLength) {
+        if (!(status & kPDACPIECStatusOBF)) {
+            return false;
+        }
+        AcpiOsReadPort(this->m_dataPort, &value, 8);
+        txn->data[txn->index++] = (UInt8)value;
+        if (txn->index < txn->writeLength + txn->readLength) {
+            return true;
+        }
+    } else if (status & kPDACPIECStatusIBF) {
+        /* Done once the EC has taken the last byte */
+        return false;
+    }
+
+    this->completeLocked(txn);
+    return true;
+}
+
+void PDACPIEmbeddedController::completeLocked(PDACPIECTransaction *txn)
+{
+    this->m_head = txn->next;
+    if (!this->m_head) {
+        this->m_tail = NULL;
+    }
+
+    if (txn->command == kPDACPIECCommandBurstEnable) {
+        this->m_burst = txn->data[0] == kPDACPIECBurstAcknowledge;
+    } else if (txn->command == kPDACPIECCommandBurstDisable) {
+        this->m_burst = false;
+    }
+
+    txn->done = true;
+    if (txn->notify) {
+        thread_wakeup((event_t)txn);
+    }
+}
+
+/*
+ * Run the queue as far as the EC allows. Returns true if the caller should
+ * schedule the query worker once it has dropped the lock.
+ */
+bool PDACPIEmbeddedController::advanceLocked(void)
+{
+    UInt8 status;
+
+    for (;;) {
+        status = this->readStatus();
+        if (!this->stepLocked(status)) {
+            break;
+        }
+        this->m_steps++;
+    }
+
+    /* The EC may leave burst mode on its own; don't keep spinning for it */
+    if (this->m_burst && !(status & kPDACPIECStatusBurst)) {
+        this->m_burst = false;
+    }
+
+    if ((status & kPDACPIECStatusSCIEvent) && !this->m_queryScheduled && this->m_device) {
+        this->m_queryScheduled = true;
+        return true;
+    }
+    return false;
+}
+
+/* Take the unfinished ones of txn[0, count) off the queue. */
+void PDACPIEmbeddedController::cancelLocked(PDACPIECTransaction *txn, UInt32 count)
+{
+    PDACPIECTransaction **link = &this->m_head;
+    PDACPIECTransaction *prev = NULL;
+
+    while (*link) {
+        PDACPIECTransaction *cur = *link;
+        if (cur >= txn && cur < txn + count) {
+            *link = cur->next;
+        } else {
+            prev = cur;
+            link = &cur->next;
+        }
+    }
+    this->m_tail = prev;
+}
+
+void PDACPIEmbeddedController::scheduleQuery(void)
+{
+    if (ACPI_FAILURE(AcpiOsExecute(OSL_EC_POLL_HANDLER, PDACPIECQueryWork, this))) {
+        IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+        this->m_queryScheduled = false;
+        IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+    }
+}
+
+/*
+ * Queue txn[0, count) back to back and wait for the last one. Waits for the
+ * GPE once one has been seen; otherwise, and in burst mode, polls the
+ * status register, spinning briefly before blocking between polls so the
+ * spin never keeps the CPU from whatever the EC is waiting on. Gives up
+ * once the EC has taken no step for kPDACPIECTimeoutMS.
+ */
+IOReturn PDACPIEmbeddedController::runTransactions(PDACPIECTransaction *txn, UInt32 count)
+{
+    PDACPIECTransaction *last = &txn[count - 1];
+    UInt64 deadline;
+    UInt64 steps;
+    UInt32 polls = 0;
+    bool query;
+
+    for (UInt32 i = 0; i < count; i++) {
+        txn[i].next = i + 1 < count ? &txn[i + 1] : NULL;
+        txn[i].index = 0;
+        txn[i].started = false;
+        txn[i].notify = &txn[i] == last;
+        txn[i].done = false;
+    }
+    clock_interval_to_deadline(kPDACPIECTimeoutMS, kMillisecondScale, &deadline);
+
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    if (this->m_tail) {
+        this->m_tail->next = txn;
+    } else {
+        this->m_head = txn;
+    }
+    this->m_tail = last;
+    this->m_transactions += count;
+    steps = this->m_steps;
+    query = this->advanceLocked();
+
+    while (!last->done) {
+        if (this->m_steps != steps) {
+            steps = this->m_steps;
+            clock_interval_to_deadline(kPDACPIECTimeoutMS, kMillisecondScale, &deadline);
+        } else if (mach_absolute_time() > deadline) {
+            this->cancelLocked(txn, count);
+            this->m_timeouts++;
+            IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+            IOLog("ACPI: EC transaction 0x%02x timed out\n", txn->command);
+            return kIOReturnTimeout;
+        }
+
+        bool spin = (!this->m_gpeSeen || this->m_burst) && polls++ < kPDACPIECPollSpins;
+        if (!spin) {
+            assert_wait_timeout((event_t)last, THREAD_UNINT, 1, kMillisecondScale);
+        }
+        IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+        if (query) {
+            this->scheduleQuery();
+            query = false;
+        }
+        if (spin) {
+            IODelay(kPDACPIECPollDelayUS);
+        } else {
+            thread_block(THREAD_CONTINUE_NULL);
+        }
+
+        is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+        query |= this->advanceLocked();
+    }
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+    if (query) {
+        this->scheduleQuery();
+    }
+    return kIOReturnSuccess;
+}
+
+/*
+ * With _GLK set, AML and the EC firmware share the EC through the Global
+ * Lock, so every transfer and query holds it. AcpiAcquireGlobalLock nests
+ * when AML already holds it on this thread for a field declared with Lock.
+ */
+bool PDACPIEmbeddedController::acquireGlobalLock(UInt32 *handle)
+{
+    *handle = 0;
+    if (!this->m_globalLock) {
+        return true;
+    }
+
+    ACPI_STATUS status = AcpiAcquireGlobalLock(kPDACPIECGlobalLockTimeoutMS, handle);
+    if (ACPI_FAILURE(status)) {
+        IOLog("ACPI: EC could not take the Global Lock: %s\n", AcpiFormatException(status));
+        return false;
+    }
+    return true;
+}
+
+void PDACPIEmbeddedController::releaseGlobalLock(UInt32 handle)
+{
+    if (this->m_globalLock) {
+        AcpiReleaseGlobalLock(handle);
+    }
+}
+
+void PDACPIEmbeddedController::beginBurst(void)
+{
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    bool enable = this->m_burstUsers++ == 0;
+    this->m_burstTransfers++;
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+    /* Without an acknowledge the transfer still works, just at normal speed */
+    if (enable) {
+        PDACPIECTransaction txn = {};
+        txn.command = kPDACPIECCommandBurstEnable;
+        txn.readLength = 1;
+        this->runTransactions(&txn, 1);
+    }
+}
+
+void PDACPIEmbeddedController::endBurst(void)
+{
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    bool disable = --this->m_burstUsers == 0;
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+    if (disable) {
+        PDACPIECTransaction txn = {};
+        txn.command = kPDACPIECCommandBurstDisable;
+        this->runTransactions(&txn, 1);
+    }
+}
+
+IOReturn PDACPIEmbeddedController::transfer(bool write, UInt8 address, UInt8 *buffer, UInt32 length)
+{
+    PDACPIECTransaction txn[kPDACPIECChunk];
+    IOReturn ret = kIOReturnSuccess;
+
+    if (!buffer || !length || address + length > 256) {
+        return kIOReturnBadArgument;
+    }
+
+    UInt32 globalLock;
+    if (!this->acquireGlobalLock(&globalLock)) {
+        return kIOReturnTimeout;
+    }
+
+    bool burst = length > 1;
+    if (burst) {
+        this->beginBurst();
+    }
+
+    for (UInt32 done = 0; done < length && ret == kIOReturnSuccess;) {
+        UInt32 count = length - done < kPDACPIECChunk ? length - done : kPDACPIECChunk;
+
+        bzero(txn, sizeof(txn));
+        for (UInt32 i = 0; i < count; i++) {
+            txn[i].command = write ? kPDACPIECCommandWrite : kPDACPIECCommandRead;
+            txn[i].data[0] = (UInt8)(address + done + i);
+            if (write) {
+                txn[i].data[1] = buffer[done + i];
+                txn[i].writeLength = 2;
+            } else {
+                txn[i].writeLength = 1;
+                txn[i].readLength = 1;
+            }
+        }
+
+        ret = this->runTransactions(txn, count);
+        if (ret == kIOReturnSuccess && !write) {
+            for (UInt32 i = 0; i < count; i++) {
+                buffer[done + i] = txn[i].data[1];
+            }
+        }
+        done += count;
+    }
+
+    if (burst) {
+        this->endBurst();
+    }
+    this->releaseGlobalLock(globalLock);
+    return ret;
+}
+
+IOReturn PDACPIEmbeddedController::read(UInt8 address, UInt8 *buffer, UInt32 length)
+{
+    return this->transfer(false, address, buffer, length);
+}
+
+IOReturn PDACPIEmbeddedController::write(UInt8 address, const UInt8 *buffer, UInt32 length)
+{
+    return this->transfer(true, address, (UInt8 *)buffer, length);
+}
+
+UInt32 PDACPIEmbeddedController::handleGPE(void)
+{
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    this->m_gpeSeen = true;
+    this->m_gpeCount++;
+    bool query = this->advanceLocked();
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+    if (query) {
+        this->scheduleQuery();
+    }
+    return ACPI_INTERRUPT_HANDLED | ACPI_REENABLE_GPE;
+}
+
+/*
+ * Query worker: read query numbers until the EC has none left. A number
+ * already waiting for its _Qxx is dropped, so a storm of the same event
+ * costs one evaluation per run of the _Qxx worker, not one per SCI.
+ * SCI_EVT is looked at again on the way out: an event raised after the
+ * last query, or left over past kPDACPIECMaxQueries, has no GPE of its own
+ * to bring the worker back.
+ */
+void PDACPIEmbeddedController::fetchQueries(void)
+{
+    bool recheck = true;
+
+    for (UInt32 i = 0; i < kPDACPIECMaxQueries; i++) {
+        PDACPIECTransaction txn = {};
+        UInt32 globalLock;
+        txn.command = kPDACPIECCommandQuery;
+        txn.readLength = 1;
+        if (!this->acquireGlobalLock(&globalLock)) {
+            recheck = false;
+            break;
+        }
+        IOReturn ret = this->runTransactions(&txn, 1);
+        this->releaseGlobalLock(globalLock);
+        if (ret != kIOReturnSuccess) {
+            recheck = false;
+            break;
+        }
+        if (!txn.data[0]) {
+            break;
+        }
+
+        UInt8 query = txn.data[0];
+        bool evaluate = false;
+
+        IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+        this->m_queries++;
+        if (this->m_queryPending[query >> 5] & (1U << (query & 31))) {
+            this->m_queriesCoalesced++;
+        } else {
+            this->m_queryPending[query >> 5] |= 1U << (query & 31);
+            this->m_queryRing[this->m_queryTail++] = query;
+            if (!this->m_evaluateScheduled) {
+                this->m_evaluateScheduled = evaluate = true;
+            }
+        }
+        IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+        if (evaluate && ACPI_FAILURE(AcpiOsExecute(OSL_NOTIFY_HANDLER, PDACPIECEvaluateWork, this))) {
+            is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+            this->m_evaluateScheduled = false;
+            IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+        }
+    }
+
+    IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+    this->m_queryScheduled = false;
+    bool query = recheck && this->advanceLocked();
+    IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+    if (query) {
+        this->scheduleQuery();
+    }
+}
+
+/*
+ * _Qxx worker: run queued queries in the order the EC reported them. The
+ * pending bit is cleared before the method runs, so an event raised while
+ * its _Qxx is running is run again afterwards.
+ */
+void PDACPIEmbeddedController::evaluateQueries(void)
+{
+    char method[5];
+
+    for (;;) {
+        IOInterruptState is = IOSimpleLockLockDisableInterrupt(this->m_lock);
+        if (this->m_queryHead == this->m_queryTail) {
+            this->m_evaluateScheduled = false;
+            IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+            return;
+        }
+        UInt8 query = this->m_queryRing[this->m_queryHead++];
+        this->m_queryPending[query >> 5] &= ~(1U << (query & 31));
+        IOSimpleLockUnlockEnableInterrupt(this->m_lock, is);
+
+        snprintf(method, sizeof(method), "_Q%02X", query);
+        ACPI_STATUS status = AcpiEvaluateObject(this->m_device, method, NULL, NULL);
+        if (ACPI_FAILURE(status) && status != AE_NOT_FOUND) {
+            IOLog("ACPI: EC %s failed: %s\n", method, AcpiFormatException(status));
+        }
+    }
+}
@@ -0,0 +1,146 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#ifndef _PDACPI_EMBEDDEDCONTROLLER_H
+#define _PDACPI_EMBEDDEDCONTROLLER_H
+
+#include <libkern/c++/OSObject.h>
+#include <IOKit/IOLocks.h>
+#include <IOKit/acpi/IOACPIPlatformExpert.h>
+#include <kern/thread_call.h>
+
+extern "C" {
+#include "acpica/acpi.h"
+}
+
+struct PDACPIECTransaction;
+
+/*
+ * ACPI Embedded Controller (ECDT / PNP0C09).
+ *
+ * Every EC command is a transaction on a FIFO queue. The transaction at the
+ * head is moved along by whoever looks at the status register next: the
+ * EC's GPE, or the thread waiting on it when no GPE has arrived yet (or the
+ * EC is in burst mode, where it answers in microseconds). Accesses wider
+ * than a byte run in burst mode and queue all their bytes at once.
+ *
+ * SCI_EVT is answered by one query worker at a time, and a _Qxx that is
+ * already waiting to run is not queued a second time. Until the EC's GPE
+ * has been seen, a timer looks for SCI_EVT too, so events are not left
+ * waiting for the next access. When the EC's _GLK asks for it, every
+ * access and query holds the ACPI Global Lock.
+ */
+class PDACPIEmbeddedController : public OSObject {
+    OSDeclareDefaultStructors(PDACPIEmbeddedController);
+
+public:
+    static PDACPIEmbeddedController *withECDT(const ACPI_TABLE_ECDT *ecdt, UInt32 length);
+    static PDACPIEmbeddedController *withDevice(ACPI_HANDLE device);
+
+    /* Route EC OperationRegions to this EC, and back */
+    bool attach(IOACPIPlatformExpert *platform);
+    void detach(IOACPIPlatformExpert *platform);
+
+    /* Read _GLK, take the EC's GPE and start polling for queries; call once the namespace is initialized */
+    bool enableEvents(void);
+
+    IOReturn read(UInt8 address, UInt8 *buffer, UInt32 length);
+    IOReturn write(UInt8 address, const UInt8 *buffer, UInt32 length);
+
+    ACPI_HANDLE getDevice(void) const { return m_device; }
+    void setDevice(ACPI_HANDLE device) { if (!m_device) m_device = device; }
+
+    /* Called from the GPE, query and _Qxx contexts; not for drivers */
+    UInt32 handleGPE(void);
+    void fetchQueries(void);
+    void evaluateQueries(void);
+    void pollQueries(void);
+
+protected:
+    virtual bool initWithPorts(ACPI_IO_ADDRESS command, ACPI_IO_ADDRESS data, ACPI_HANDLE device,
+                               UInt32 gpe, bool hasGPE);
+    virtual void free(void) override;
+
+private:
+    UInt8 readStatus(void);
+    bool stepLocked(UInt8 status);
+    bool advanceLocked(void);
+    void completeLocked(PDACPIECTransaction *txn);
+    void cancelLocked(PDACPIECTransaction *txn, UInt32 count);
+    void scheduleQuery(void);
+    IOReturn runTransactions(PDACPIECTransaction *txn, UInt32 count);
+    IOReturn transfer(bool write, UInt8 address, UInt8 *buffer, UInt32 length);
+    void beginBurst(void);
+    void endBurst(void);
+    bool acquireGlobalLock(UInt32 *handle);
+    void releaseGlobalLock(UInt32 handle);
+    void schedulePollLocked(void);
+
+private:
+    ACPI_IO_ADDRESS m_commandPort;              /* status on read, command on write */
+    ACPI_IO_ADDRESS m_dataPort;
+    ACPI_HANDLE m_device;                       /* for _Qxx; may be late for an ECDT EC */
+    UInt32 m_gpe;
+    bool m_hasGPE;
+    bool m_gpeInstalled;
+    bool m_globalLock;                          /* _GLK */
+    thread_call_t m_pollCall;
+
+    IOSimpleLock *m_lock;                       /* protects everything below; taken from the GPE */
+    PDACPIECTransaction *m_head;                /* transaction the EC is working on */
+    PDACPIECTransaction *m_tail;
+    bool m_gpeSeen;                             /* completion can wait for the GPE */
+    bool m_burst;                               /* EC acknowledged burst mode, and still shows BURST */
+    UInt32 m_burstUsers;
+    bool m_polling;                             /* m_pollCall may be armed */
+
+    bool m_queryScheduled;                      /* query worker queued or running */
+    bool m_evaluateScheduled;                   /* _Qxx worker queued or running */
+    UInt32 m_queryPending[256 / 32];            /* _Qxx numbers waiting in m_queryRing */
+    UInt8 m_queryRing[256];
+    UInt8 m_queryHead;
+    UInt8 m_queryTail;
+
+    UInt64 m_steps;                             /* moves made by stepLocked, to tell a slow EC from a hung one */
+    UInt64 m_transactions;
+    UInt64 m_timeouts;
+    UInt64 m_burstTransfers;
+    UInt64 m_gpeCount;
+    UInt64 m_queries;
+    UInt64 m_queriesCoalesced;
+    UInt64 m_queryPolls;                        /* SCI_EVT found by the poll timer */
+};
+
+#endif /* _PDACPI_EMBEDDEDCONTROLLER_H */
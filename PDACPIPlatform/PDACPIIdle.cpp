@@ -0,0 +1,337 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#include "PDACPIIdle.h"
+#include "PDACPIPerformance.h"
+#include <IOKit/IOLib.h>
+
+/* _CST FFixedHW register, Intel's encoding */
+#define kPDACPIIdleClassNative          2       /* BitOffset: MWAIT, hint in Address */
+#define kPDACPIIdleFlagBusMaster        0x2     /* AccessWidth: bus master avoidance required */
+
+/* _CST doesn't give a target residency; a state is worth it after twice its exit latency */
+#define kPDACPIIdleResidencyFactor      2
+
+/* _LPI */
+#define kPDACPILPIFieldCount            10
+#define kPDACPILPIEnabled               0x1
+
+struct PDACPIIdleCPU {
+    bool present;
+    PDACPICState states[kPDACPIIdleMaxStates];
+    UInt32 count;
+    UInt32 history[kPDACPIIdleHistory];     /* us, last idle periods */
+    UInt32 historyNext;
+    UInt32 latencyLimit;                    /* from the last Select */
+    PDACPIIdleStatistics stats[kPDACPIIdleMaxStates];
+};
+
+struct PDACPIIdle {
+    UInt32 cpuCount;
+    PDACPIIdleCPU *cpus;
+};
+
+PDACPIIdle *PDACPIIdleCreate(UInt32 cpuCount)
+{
+    if (!cpuCount) {
+        return NULL;
+    }
+
+    PDACPIIdle *idle = (PDACPIIdle *)IOMalloc(sizeof(PDACPIIdle));
+    if (!idle) {
+        return NULL;
+    }
+    idle->cpuCount = cpuCount;
+    idle->cpus = (PDACPIIdleCPU *)IOMalloc(cpuCount * sizeof(PDACPIIdleCPU));
+    if (!idle->cpus) {
+        IOFree(idle, sizeof(PDACPIIdle));
+        return NULL;
+    }
+    bzero(idle->cpus, cpuCount * sizeof(PDACPIIdleCPU));
+    return idle;
+}
+
+void PDACPIIdleDestroy(PDACPIIdle *idle)
+{
+    if (idle) {
+        IOFree(idle->cpus, idle->cpuCount * sizeof(PDACPIIdleCPU));
+        IOFree(idle, sizeof(PDACPIIdle));
+    }
+}
+
+#pragma mark Parsing
+
+/* How to enter a state whose entry register is reg; false if we can't */
+static bool PDACPIIdleEntryMethod(const ACPI_GENERIC_ADDRESS *reg, UInt32 type, PDACPICState *state)
+{
+    switch (reg->SpaceId) {
+        case ACPI_ADR_SPACE_FIXED_HARDWARE:
+            if (reg->BitOffset == kPDACPIIdleClassNative) {
+                state->method = kPDACPIIdleMethodMwait;
+                state->address = reg->Address & 0xFFFFFFFF;
+                state->busMasterAvoid = (reg->AccessWidth & kPDACPIIdleFlagBusMaster) != 0;
+            } else {
+                state->method = kPDACPIIdleMethodHalt;
+            }
+            return true;
+        case ACPI_ADR_SPACE_SYSTEM_IO:
+            /* C1 is HLT whatever the register says */
+            state->method = type == 1 ? kPDACPIIdleMethodHalt : kPDACPIIdleMethodIO;
+            state->address = reg->Address;
+            /* An I/O C3 stops snooping, so bus masters have to be quiet (ACPI 8.1.4) */
+            state->busMasterAvoid = type >= 3;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Keep states in order of exit latency; a repeat or an out-of-order one is dropped */
+static void PDACPIIdleAppend(PDACPIIdleCPU *cpu, const PDACPICState *state)
+{
+    if (cpu->count == kPDACPIIdleMaxStates) {
+        return;
+    }
+    if (cpu->count) {
+        const PDACPICState *last = &cpu->states[cpu->count - 1];
+        if (state->latency < last->latency ||
+            (state->method == last->method && state->address == last->address)) {
+            return;
+        }
+    }
+    cpu->states[cpu->count++] = *state;
+}
+
+/* _CST: Package { Count, Package { Register, Type, Latency, Power }, ... } */
+static bool PDACPIIdleParseCST(PDACPIIdleCPU *cpu, const ACPI_OBJECT *cst)
+{
+    for (UInt32 i = 1; i < cst->Package.Count; i++) {
+        const ACPI_OBJECT *entry = &cst->Package.Elements[i];
+        if (entry->Type != ACPI_TYPE_PACKAGE || entry->Package.Count < 4 ||
+            entry->Package.Elements[1].Type != ACPI_TYPE_INTEGER ||
+            entry->Package.Elements[2].Type != ACPI_TYPE_INTEGER ||
+            entry->Package.Elements[3].Type != ACPI_TYPE_INTEGER) {
+            continue;
+        }
+
+        PDACPICState state = {};
+        ACPI_GENERIC_ADDRESS reg;
+        state.type = (UInt32)entry->Package.Elements[1].Integer.Value;
+        state.latency = (UInt32)entry->Package.Elements[2].Integer.Value;
+        state.power = (UInt32)entry->Package.Elements[3].Integer.Value;
+        state.residency = state.latency * kPDACPIIdleResidencyFactor;
+        if (state.type < 1 || state.type > 3 ||
+            !PDACPIGetRegister(&entry->Package.Elements[0], &reg) ||
+            !PDACPIIdleEntryMethod(&reg, state.type, &state)) {
+            continue;
+        }
+        PDACPIIdleAppend(cpu, &state);
+    }
+    return cpu->count > 0;
+}
+
+/*
+ * _LPI: Package { Revision, LevelID, Count, Package { MinResidency,
+ * WakeLatency, Flags, ArchContextLost, ResidencyCounterFrequency,
+ * EnableParentState, EntryMethod, ResidencyCounter, UsageCounter, Name }, ... }
+ * Only the processor's own level is used; states whose entry method is an
+ * integer (to be combined with a processor container's) are skipped.
+ */
+static bool PDACPIIdleParseLPI(PDACPIIdleCPU *cpu, const ACPI_OBJECT *lpi)
+{
+    for (UInt32 i = 3; i < lpi->Package.Count; i++) {
+        const ACPI_OBJECT *entry = &lpi->Package.Elements[i];
+        if (entry->Type != ACPI_TYPE_PACKAGE || entry->Package.Count < kPDACPILPIFieldCount ||
+            entry->Package.Elements[0].Type != ACPI_TYPE_INTEGER ||
+            entry->Package.Elements[1].Type != ACPI_TYPE_INTEGER ||
+            entry->Package.Elements[2].Type != ACPI_TYPE_INTEGER ||
+            !(entry->Package.Elements[2].Integer.Value & kPDACPILPIEnabled)) {
+            continue;
+        }
+
+        PDACPICState state = {};
+        ACPI_GENERIC_ADDRESS reg;
+        state.type = cpu->count + 1;
+        state.residency = (UInt32)entry->Package.Elements[0].Integer.Value;
+        state.latency = (UInt32)entry->Package.Elements[1].Integer.Value;
+        if (!PDACPIGetRegister(&entry->Package.Elements[6], &reg) ||
+            !PDACPIIdleEntryMethod(&reg, state.type, &state)) {
+            continue;
+        }
+        PDACPIIdleAppend(cpu, &state);
+    }
+    return cpu->count > 0;
+}
+
+IOReturn PDACPIIdleAddProcessor(PDACPIIdle *idle, UInt32 cpuNumber, ACPI_HANDLE processor)
+{
+    if (cpuNumber >= idle->cpuCount || idle->cpus[cpuNumber].present || !processor) {
+        return kIOReturnBadArgument;
+    }
+
+    PDACPIIdleCPU *cpu = &idle->cpus[cpuNumber];
+    ACPI_BUFFER buffer = { ACPI_ALLOCATE_BUFFER, NULL };
+    const char *source = "neither _LPI nor _CST";
+
+    bzero(cpu, sizeof(*cpu));
+    if (ACPI_SUCCESS(AcpiEvaluateObjectTyped(processor, (char *)"_LPI", NULL, &buffer, ACPI_TYPE_PACKAGE))) {
+        if (PDACPIIdleParseLPI(cpu, (ACPI_OBJECT *)buffer.Pointer)) {
+            source = "_LPI";
+        }
+        ACPI_FREE(buffer.Pointer);
+        buffer.Pointer = NULL;
+        buffer.Length = ACPI_ALLOCATE_BUFFER;
+    }
+    if (!cpu->count) {
+        if (ACPI_SUCCESS(AcpiEvaluateObjectTyped(processor, (char *)"_CST", NULL, &buffer, ACPI_TYPE_PACKAGE))) {
+            if (PDACPIIdleParseCST(cpu, (ACPI_OBJECT *)buffer.Pointer)) {
+                source = "_CST";
+            }
+            ACPI_FREE(buffer.Pointer);
+        }
+    }
+
+    /* C1 is always there, even when the firmware lists nothing */
+    if (!cpu->count || cpu->states[0].type != 1) {
+        if (cpu->count == kPDACPIIdleMaxStates) {
+            cpu->count--;
+        }
+        memmove(&cpu->states[1], &cpu->states[0], cpu->count * sizeof(PDACPICState));
+        bzero(&cpu->states[0], sizeof(PDACPICState));
+        cpu->states[0].type = 1;
+        cpu->states[0].method = kPDACPIIdleMethodHalt;
+        cpu->count++;
+    }
+    cpu->present = true;
+
+    IOLog("ACPI: CPU %u: %u idle states from %s, deepest wakes in %u us\n",
+          cpuNumber, cpu->count, source,
+          cpu->states[cpu->count - 1].latency);
+    return kIOReturnSuccess;
+}
+
+IOReturn PDACPIIdleSetStates(PDACPIIdle *idle, UInt32 cpuNumber, const PDACPICState *states, UInt32 count)
+{
+    if (cpuNumber >= idle->cpuCount || !count || count > kPDACPIIdleMaxStates) {
+        return kIOReturnBadArgument;
+    }
+
+    PDACPIIdleCPU *cpu = &idle->cpus[cpuNumber];
+    bzero(cpu, sizeof(*cpu));
+    memcpy(cpu->states, states, count * sizeof(PDACPICState));
+    cpu->count = count;
+    cpu->present = true;
+    return kIOReturnSuccess;
+}
+
+#pragma mark Governor
+
+UInt32 PDACPIIdleSelect(PDACPIIdle *idle, UInt32 cpuNumber, UInt32 latencyLimitUS, UInt64 nextTimerUS)
+{
+    if (cpuNumber >= idle->cpuCount || !idle->cpus[cpuNumber].present) {
+        return 0;
+    }
+
+    PDACPIIdleCPU *cpu = &idle->cpus[cpuNumber];
+    UInt64 predicted = 0;
+
+    /*
+     * The plain average: a run of short periods pulls it down within a few
+     * wakeups, and a lone short one among long ones doesn't. Discarding
+     * outliers first did worse on recorded traces; without the next timer to
+     * fall back on, it sticks to the old pattern for too long.
+     */
+    for (UInt32 i = 0; i < kPDACPIIdleHistory; i++) {
+        predicted += cpu->history[i];
+    }
+    predicted = ACPI_MIN(predicted / kPDACPIIdleHistory, nextTimerUS);
+    cpu->latencyLimit = latencyLimitUS;
+
+    UInt32 index = 0;
+    for (UInt32 i = 1; i < cpu->count; i++) {
+        if (cpu->states[i].residency > predicted) {
+            break;
+        }
+        if (cpu->states[i].latency > latencyLimitUS) {
+            cpu->stats[index].latencyLimited++;
+            break;
+        }
+        index = i;
+    }
+    return index;
+}
+
+void PDACPIIdleReflect(PDACPIIdle *idle, UInt32 cpuNumber, UInt32 index, UInt64 idleUS)
+{
+    if (cpuNumber >= idle->cpuCount || !idle->cpus[cpuNumber].present ||
+        index >= idle->cpus[cpuNumber].count) {
+        return;
+    }
+
+    PDACPIIdleCPU *cpu = &idle->cpus[cpuNumber];
+    PDACPIIdleStatistics *stats = &cpu->stats[index];
+    stats->entries++;
+    stats->residency += idleUS;
+    if (index && idleUS < cpu->states[index].residency) {
+        stats->tooDeep++;
+    } else if (index + 1 < cpu->count && idleUS >= cpu->states[index + 1].residency &&
+               cpu->states[index + 1].latency <= cpu->latencyLimit) {
+        stats->tooShallow++;
+    }
+
+    cpu->history[cpu->historyNext] = (UInt32)ACPI_MIN(idleUS, 0xFFFFFFFF);
+    cpu->historyNext = (cpu->historyNext + 1) % kPDACPIIdleHistory;
+}
+
+#pragma mark Queries
+
+UInt32 PDACPIIdleGetStates(const PDACPIIdle *idle, UInt32 cpu, const PDACPICState **states)
+{
+    if (cpu >= idle->cpuCount || !idle->cpus[cpu].present) {
+        *states = NULL;
+        return 0;
+    }
+    *states = idle->cpus[cpu].states;
+    return idle->cpus[cpu].count;
+}
+
+bool PDACPIIdleGetStatistics(const PDACPIIdle *idle, UInt32 cpu, UInt32 index, PDACPIIdleStatistics *stats)
+{
+    if (cpu >= idle->cpuCount || !idle->cpus[cpu].present || index >= idle->cpus[cpu].count) {
+        return false;
+    }
+    *stats = idle->cpus[cpu].stats[index];
+    return true;
+}
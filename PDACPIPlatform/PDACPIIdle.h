@@ -0,0 +1,107 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#ifndef _PDACPI_IDLE_H
+#define _PDACPI_IDLE_H
+
+#include <libkern/OSTypes.h>
+#include <IOKit/IOReturn.h>
+
+extern "C" {
+#include "acpica/acpi.h"
+}
+
+/*
+ * ACPI processor idle states (_LPI, or _CST when there is none).
+ *
+ * The engine keeps each processor's idle states, shallowest first, and picks
+ * one each time the CPU goes idle; entering it is up to the caller, which
+ * then reports how long the CPU stayed idle. The pick is the deepest state
+ * whose exit latency fits the caller's limit and whose target residency
+ * fits the predicted idle time. The prediction is the average of the last
+ * few idle periods, capped by the next timer when the caller knows it.
+ *
+ * Select and Reflect for a CPU are meant to be called on that CPU with
+ * interrupts disabled, and touch only its own state.
+ */
+
+#define kPDACPIIdleMaxStates            8
+#define kPDACPIIdleHistory              8       /* idle periods the prediction looks at */
+#define kPDACPIIdleNoTimer              0xFFFFFFFFFFFFFFFFULL
+
+/* How a state is entered */
+#define kPDACPIIdleMethodHalt           0       /* HLT */
+#define kPDACPIIdleMethodMwait          1       /* MONITOR/MWAIT, address is the hint */
+#define kPDACPIIdleMethodIO             2       /* read the I/O port at address */
+
+struct PDACPICState {
+    UInt32 type;                        /* _CST type (1-3), or depth for _LPI */
+    UInt32 method;
+    UInt64 address;
+    UInt32 latency;                     /* us to wake up */
+    UInt32 residency;                   /* us the CPU must stay for the state to pay off */
+    UInt32 power;                       /* mW, 0 if unknown */
+    bool busMasterAvoid;                /* bus master activity must be off: I/O C3, or FFixedHW that asks */
+};
+
+struct PDACPIIdleStatistics {
+    UInt64 entries;
+    UInt64 residency;                   /* us spent in the state */
+    UInt64 tooDeep;                     /* woke before the state's residency */
+    UInt64 tooShallow;                  /* stayed long enough for the next state down */
+    UInt64 latencyLimited;              /* a deeper state fit the prediction but not the latency limit */
+};
+
+struct PDACPIIdle;
+
+PDACPIIdle *PDACPIIdleCreate(UInt32 cpuCount);
+void PDACPIIdleDestroy(PDACPIIdle *idle);
+
+/* Evaluate the processor object's _LPI or _CST for cpu */
+IOReturn PDACPIIdleAddProcessor(PDACPIIdle *idle, UInt32 cpu, ACPI_HANDLE processor);
+
+/* Use these states for cpu instead, shallowest first */
+IOReturn PDACPIIdleSetStates(PDACPIIdle *idle, UInt32 cpu, const PDACPICState *states, UInt32 count);
+
+/* The state to enter now; nextTimerUS is kPDACPIIdleNoTimer when unknown */
+UInt32 PDACPIIdleSelect(PDACPIIdle *idle, UInt32 cpu, UInt32 latencyLimitUS, UInt64 nextTimerUS);
+
+/* cpu left state index after idleUS */
+void PDACPIIdleReflect(PDACPIIdle *idle, UInt32 cpu, UInt32 index, UInt64 idleUS);
+
+UInt32 PDACPIIdleGetStates(const PDACPIIdle *idle, UInt32 cpu, const PDACPICState **states);
+bool PDACPIIdleGetStatistics(const PDACPIIdle *idle, UInt32 cpu, UInt32 index, PDACPIIdleStatistics *stats);
+
+#endif /* _PDACPI_IDLE_H */
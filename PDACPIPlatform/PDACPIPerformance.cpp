@@ -0,0 +1,632 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#include "PDACPIPerformance.h"
+#include <IOKit/IOLib.h>
+
+/* Generic Register Descriptor, ACPI 6.5, 6.4.3.7 */
+#define kPDACPIGenericRegisterTag       0x82
+#define kPDACPIGenericRegisterSize      15      /* tag, 2-byte length, 12 bytes of body */
+
+struct PDACPIPerformanceCPU {
+    bool present;
+    bool sampled;                       /* lastBusy/lastElapsed hold a sample */
+    ACPI_HANDLE handle;
+    PDACPIPState states[kPDACPIPerformanceMaxStates];   /* by _PSS index, fastest first */
+    UInt32 count;                       /* _PSS entries kept, valid or not */
+    UInt32 limit;                       /* _PPC: fastest state allowed */
+    ACPI_GENERIC_ADDRESS control;
+    ACPI_GENERIC_ADDRESS status;
+    UInt32 domain;                      /* index into PDACPIPerformance::domains */
+
+    UInt32 request;                     /* state this CPU wants */
+    UInt32 current;                     /* state last written, or kPDACPIPerformanceNoState */
+    UInt32 slowerWanted;                /* periods in a row that wanted a slower state */
+    UInt32 slowerTarget;                /* fastest state wanted during them */
+    UInt64 lastBusy;
+    UInt64 lastElapsed;
+};
+
+struct PDACPIPerformanceDomain {
+    UInt32 id;                          /* _PSD domain number */
+    UInt32 coordination;
+    bool shared;                        /* from _PSD; others belong to one CPU */
+    UInt32 target;                      /* scratch for PDACPIPerformanceApply */
+    UInt32 limit;
+    bool written;
+};
+
+struct PDACPIPerformance {
+    PDACPIPerformanceBackend backend;
+    PDACPIPerformanceGovernor governor;
+    UInt32 cpuCount;
+    UInt32 domainCount;
+    UInt32 maxLatency;                  /* us, slowest transition of any CPU */
+    UInt64 transitions;                 /* control register writes */
+    PDACPIPerformanceCPU *cpus;
+    PDACPIPerformanceDomain *domains;   /* cpuCount entries; a CPU adds at most one */
+    PDACPIPerformanceSample *samples;
+    PDACPIPerformanceWrite *writes;
+};
+
+PDACPIPerformance *PDACPIPerformanceCreate(UInt32 cpuCount, const PDACPIPerformanceBackend *backend,
+                                           const PDACPIPerformanceGovernor *governor)
+{
+    if (!cpuCount || !backend || !backend->sample || !backend->write) {
+        return NULL;
+    }
+
+    PDACPIPerformance *perf = (PDACPIPerformance *)IOMalloc(sizeof(PDACPIPerformance));
+    if (!perf) {
+        return NULL;
+    }
+    bzero(perf, sizeof(PDACPIPerformance));
+    perf->backend = *backend;
+    perf->cpuCount = cpuCount;
+
+    perf->governor.samplingMS = kPDACPIPerformanceDefaultSamplingMS;
+    perf->governor.upThreshold = kPDACPIPerformanceDefaultUpThreshold;
+    perf->governor.targetLoad = kPDACPIPerformanceDefaultTargetLoad;
+    perf->governor.downSamples = kPDACPIPerformanceDefaultDownSamples;
+    if (governor) {
+        if (governor->samplingMS) {
+            perf->governor.samplingMS = governor->samplingMS;
+        }
+        if (governor->upThreshold && governor->upThreshold <= 100) {
+            perf->governor.upThreshold = governor->upThreshold;
+        }
+        if (governor->targetLoad) {
+            perf->governor.targetLoad = governor->targetLoad;
+        }
+        if (governor->downSamples) {
+            perf->governor.downSamples = governor->downSamples;
+        }
+    }
+    if (perf->governor.targetLoad > perf->governor.upThreshold) {
+        perf->governor.targetLoad = perf->governor.upThreshold;
+    }
+
+    perf->cpus = (PDACPIPerformanceCPU *)IOMalloc(cpuCount * sizeof(PDACPIPerformanceCPU));
+    perf->domains = (PDACPIPerformanceDomain *)IOMalloc(cpuCount * sizeof(PDACPIPerformanceDomain));
+    perf->samples = (PDACPIPerformanceSample *)IOMalloc(cpuCount * sizeof(PDACPIPerformanceSample));
+    perf->writes = (PDACPIPerformanceWrite *)IOMalloc(cpuCount * sizeof(PDACPIPerformanceWrite));
+    if (!perf->cpus || !perf->domains || !perf->samples || !perf->writes) {
+        PDACPIPerformanceDestroy(perf);
+        return NULL;
+    }
+    bzero(perf->cpus, cpuCount * sizeof(PDACPIPerformanceCPU));
+    return perf;
+}
+
+void PDACPIPerformanceDestroy(PDACPIPerformance *perf)
+{
+    if (!perf) {
+        return;
+    }
+    if (perf->cpus) {
+        IOFree(perf->cpus, perf->cpuCount * sizeof(PDACPIPerformanceCPU));
+    }
+    if (perf->domains) {
+        IOFree(perf->domains, perf->cpuCount * sizeof(PDACPIPerformanceDomain));
+    }
+    if (perf->samples) {
+        IOFree(perf->samples, perf->cpuCount * sizeof(PDACPIPerformanceSample));
+    }
+    if (perf->writes) {
+        IOFree(perf->writes, perf->cpuCount * sizeof(PDACPIPerformanceWrite));
+    }
+    IOFree(perf, sizeof(PDACPIPerformance));
+}
+
+#pragma mark Parsing
+
+static bool PDACPIPerformanceInteger(const ACPI_OBJECT *object, UInt64 *value)
+{
+    if (object->Type != ACPI_TYPE_INTEGER) {
+        return false;
+    }
+    *value = object->Integer.Value;
+    return true;
+}
+
+/* ResourceTemplate () { Register (...) } */
+bool PDACPIGetRegister(const ACPI_OBJECT *object, ACPI_GENERIC_ADDRESS *reg)
+{
+    if (object->Type != ACPI_TYPE_BUFFER || object->Buffer.Length < kPDACPIGenericRegisterSize) {
+        return false;
+    }
+
+    const UInt8 *bytes = object->Buffer.Pointer;
+    if (bytes[0] != kPDACPIGenericRegisterTag) {
+        return false;
+    }
+    reg->SpaceId = bytes[3];
+    reg->BitWidth = bytes[4];
+    reg->BitOffset = bytes[5];
+    reg->AccessWidth = bytes[6];
+    memcpy(&reg->Address, &bytes[7], sizeof(reg->Address));
+    return true;
+}
+
+static bool PDACPIPerformanceRegister(const ACPI_OBJECT *object, ACPI_GENERIC_ADDRESS *reg)
+{
+    return PDACPIGetRegister(object, reg) &&
+           (reg->SpaceId == ACPI_ADR_SPACE_FIXED_HARDWARE ||
+            reg->SpaceId == ACPI_ADR_SPACE_SYSTEM_IO ||
+            reg->SpaceId == ACPI_ADR_SPACE_SYSTEM_MEMORY);
+}
+
+/*
+ * States keep their _PSS index, which is what _PPC and the status register
+ * go by. An entry that isn't six integers, lists no frequency, or isn't
+ * slower than the valid one before it stays in place but is marked invalid
+ * and never used. cpu->states is zeroed by the caller.
+ */
+static bool PDACPIPerformanceParsePSS(PDACPIPerformanceCPU *cpu, const ACPI_OBJECT *pss)
+{
+    UInt64 field[6];
+    UInt64 slowest = 0;                 /* frequency of the last valid state */
+
+    if (pss->Type != ACPI_TYPE_PACKAGE || !pss->Package.Count) {
+        return false;
+    }
+
+    cpu->count = ACPI_MIN(pss->Package.Count, kPDACPIPerformanceMaxStates);
+    for (UInt32 i = 0; i < cpu->count; i++) {
+        const ACPI_OBJECT *state = &pss->Package.Elements[i];
+        bool wellFormed = state->Type == ACPI_TYPE_PACKAGE && state->Package.Count >= 6;
+        for (UInt32 f = 0; wellFormed && f < 6; f++) {
+            wellFormed = PDACPIPerformanceInteger(&state->Package.Elements[f], &field[f]);
+        }
+        if (!wellFormed) {
+            continue;
+        }
+
+        PDACPIPState *p = &cpu->states[i];
+        p->frequency = (UInt32)field[0];
+        p->power = (UInt32)field[1];
+        p->latency = (UInt32)field[2];
+        p->busMasterLatency = (UInt32)field[3];
+        p->control = field[4];
+        p->status = field[5];
+        p->valid = field[0] && field[0] <= ACPI_UINT32_MAX && (!slowest || field[0] < slowest);
+        if (p->valid) {
+            slowest = field[0];
+        }
+    }
+    return slowest != 0;
+}
+
+/* The fastest valid state no faster than index, or the slowest valid one if none is */
+static UInt32 PDACPIPerformanceValidState(const PDACPIPerformanceCPU *cpu, UInt32 index)
+{
+    UInt32 slowest = kPDACPIPerformanceNoState;
+
+    for (UInt32 i = 0; i < cpu->count; i++) {
+        if (cpu->states[i].valid) {
+            if (i >= index) {
+                return i;
+            }
+            slowest = i;
+        }
+    }
+    return slowest;
+}
+
+/* Evaluate method on handle into a freshly allocated buffer; the caller frees it with ACPI_FREE */
+static ACPI_OBJECT *PDACPIPerformanceEvaluate(ACPI_HANDLE handle, const char *method, ACPI_OBJECT_TYPE type)
+{
+    ACPI_BUFFER buffer = { ACPI_ALLOCATE_BUFFER, NULL };
+
+    if (ACPI_FAILURE(AcpiEvaluateObjectTyped(handle, (char *)method, NULL, &buffer, type))) {
+        return NULL;
+    }
+    return (ACPI_OBJECT *)buffer.Pointer;
+}
+
+static UInt32 PDACPIPerformanceEvaluatePPC(PDACPIPerformanceCPU *cpu)
+{
+    ACPI_OBJECT object;
+    ACPI_BUFFER buffer = { sizeof(object), &object };
+
+    if (ACPI_FAILURE(AcpiEvaluateObjectTyped(cpu->handle, (char *)"_PPC", NULL, &buffer, ACPI_TYPE_INTEGER))) {
+        return PDACPIPerformanceValidState(cpu, 0);
+    }
+    return PDACPIPerformanceValidState(cpu, (UInt32)ACPI_MIN(object.Integer.Value, (UInt64)cpu->count));
+}
+
+/* The CPU's domain: the _PSD one it shares, or one of its own */
+static UInt32 PDACPIPerformanceJoinDomain(PDACPIPerformance *perf, ACPI_HANDLE handle)
+{
+    UInt64 field[5];
+    UInt32 id = 0;
+    UInt32 coordination = kPDACPICoordinationHardwareAll;
+    bool shared = false;
+
+    ACPI_OBJECT *psd = PDACPIPerformanceEvaluate(handle, "_PSD", ACPI_TYPE_PACKAGE);
+    if (psd && psd->Package.Count && psd->Package.Elements[0].Type == ACPI_TYPE_PACKAGE) {
+        const ACPI_OBJECT *entry = &psd->Package.Elements[0];
+        shared = entry->Package.Count >= 5;
+        for (UInt32 f = 0; shared && f < 5; f++) {
+            shared = PDACPIPerformanceInteger(&entry->Package.Elements[f], &field[f]);
+        }
+        if (shared) {
+            id = (UInt32)field[2];
+            coordination = (UInt32)field[3];
+            if (coordination != kPDACPICoordinationSoftwareAny && coordination != kPDACPICoordinationHardwareAll) {
+                coordination = kPDACPICoordinationSoftwareAll;
+            }
+        }
+    }
+    if (psd) {
+        ACPI_FREE(psd);
+    }
+
+    if (shared) {
+        for (UInt32 d = 0; d < perf->domainCount; d++) {
+            if (perf->domains[d].shared && perf->domains[d].id == id) {
+                return d;
+            }
+        }
+    }
+
+    /* Once CPUs have been removed and added back the slots can run out; reuse one left empty */
+    UInt32 d = perf->domainCount;
+    if (d < perf->cpuCount) {
+        perf->domainCount++;
+    } else {
+        for (d = 0; d < perf->domainCount; d++) {
+            UInt32 i;
+            for (i = 0; i < perf->cpuCount && !(perf->cpus[i].present && perf->cpus[i].domain == d); i++) {
+            }
+            if (i == perf->cpuCount) {
+                break;
+            }
+        }
+    }
+
+    PDACPIPerformanceDomain *domain = &perf->domains[d];
+    bzero(domain, sizeof(*domain));
+    domain->id = id;
+    domain->coordination = coordination;
+    domain->shared = shared;
+    return d;
+}
+
+IOReturn PDACPIPerformanceAddProcessor(PDACPIPerformance *perf, UInt32 cpuNumber, ACPI_HANDLE processor)
+{
+    if (cpuNumber >= perf->cpuCount || perf->cpus[cpuNumber].present || !processor) {
+        return kIOReturnBadArgument;
+    }
+
+    PDACPIPerformanceCPU *cpu = &perf->cpus[cpuNumber];
+    bzero(cpu, sizeof(*cpu));
+    cpu->handle = processor;
+
+    ACPI_OBJECT *pss = PDACPIPerformanceEvaluate(processor, "_PSS", ACPI_TYPE_PACKAGE);
+    ACPI_OBJECT *pct = PDACPIPerformanceEvaluate(processor, "_PCT", ACPI_TYPE_PACKAGE);
+    bool valid = pss && pct && pct->Package.Count >= 2 &&
+                 PDACPIPerformanceParsePSS(cpu, pss) &&
+                 PDACPIPerformanceRegister(&pct->Package.Elements[0], &cpu->control) &&
+                 PDACPIPerformanceRegister(&pct->Package.Elements[1], &cpu->status);
+    if (valid && pss->Package.Count > kPDACPIPerformanceMaxStates) {
+        IOLog("ACPI: CPU %u: _PSS lists %u P-states, only the fastest %u are used\n",
+              cpuNumber, pss->Package.Count, kPDACPIPerformanceMaxStates);
+    }
+    if (pss) {
+        ACPI_FREE(pss);
+    }
+    if (pct) {
+        ACPI_FREE(pct);
+    }
+    if (!valid) {
+        return kIOReturnUnsupported;
+    }
+
+    cpu->limit = PDACPIPerformanceEvaluatePPC(cpu);
+    cpu->domain = PDACPIPerformanceJoinDomain(perf, processor);
+    cpu->request = cpu->limit;
+    cpu->current = kPDACPIPerformanceNoState;
+    cpu->present = true;
+
+    UInt32 usable = 0;
+    for (UInt32 i = 0; i < cpu->count; i++) {
+        if (cpu->states[i].valid) {
+            perf->maxLatency = ACPI_MAX(perf->maxLatency, cpu->states[i].latency);
+            usable++;
+        }
+    }
+    if (usable < cpu->count) {
+        IOLog("ACPI: CPU %u: %u of its _PSS entries are malformed or out of order, and unused\n",
+              cpuNumber, cpu->count - usable);
+    }
+
+    const PDACPIPerformanceDomain *domain = &perf->domains[cpu->domain];
+    IOLog("ACPI: CPU %u: %u P-states, %u-%u MHz, control in space 0x%x, %s domain %u (0x%x)\n",
+          cpuNumber, usable, cpu->states[PDACPIPerformanceValidState(cpu, cpu->count)].frequency,
+          cpu->states[PDACPIPerformanceValidState(cpu, 0)].frequency,
+          cpu->control.SpaceId, domain->shared ? "_PSD" : "own", domain->id, domain->coordination);
+    return kIOReturnSuccess;
+}
+
+#pragma mark Governor
+
+/*
+ * Pick the state for one CPU from how busy it was. A CPU past upThreshold
+ * goes to the fastest state allowed at once; otherwise it wants the slowest
+ * state that would have kept it targetLoad busy. Going faster happens right
+ * away. Going slower waits until downSamples periods in a row want it, and
+ * then goes only as far as the least of those asked for, so a CPU doesn't
+ * flap between states on a bursty load.
+ */
+static UInt32 PDACPIPerformanceGovern(PDACPIPerformance *perf, PDACPIPerformanceCPU *cpu, UInt32 load)
+{
+    const PDACPIPerformanceGovernor *gov = &perf->governor;
+
+    if (load >= gov->upThreshold) {
+        cpu->slowerWanted = 0;
+        return cpu->limit;
+    }
+
+    /* Utilization is relative to the speed actually run at, which a domain may have raised */
+    UInt64 needed = (UInt64)cpu->states[cpu->current].frequency * load / gov->targetLoad;
+    UInt32 want = cpu->limit;
+    for (UInt32 i = cpu->limit + 1; i < cpu->count; i++) {
+        if (!cpu->states[i].valid) {
+            continue;
+        }
+        if (cpu->states[i].frequency < needed) {
+            break;
+        }
+        want = i;
+    }
+
+    if (want <= cpu->request) {
+        cpu->slowerWanted = 0;
+        return want;
+    }
+
+    cpu->slowerTarget = cpu->slowerWanted ? ACPI_MIN(cpu->slowerTarget, want) : want;
+    if (++cpu->slowerWanted < gov->downSamples) {
+        return cpu->request;
+    }
+    cpu->slowerWanted = 0;
+    return cpu->slowerTarget;
+}
+
+/*
+ * Turn requests into writes. A software-coordinated domain runs at the
+ * fastest state any of its CPUs wants, held back by the strictest _PPC among
+ * them: SW_ALL writes it on every CPU, SW_ANY on one. HW_ALL CPUs (and CPUs
+ * without _PSD) each write their own request.
+ */
+static void PDACPIPerformanceApply(PDACPIPerformance *perf)
+{
+    UInt32 count = 0;
+
+    for (UInt32 d = 0; d < perf->domainCount; d++) {
+        perf->domains[d].target = kPDACPIPerformanceNoState;
+        perf->domains[d].limit = 0;
+        perf->domains[d].written = false;
+    }
+    for (UInt32 i = 0; i < perf->cpuCount; i++) {
+        PDACPIPerformanceCPU *cpu = &perf->cpus[i];
+        if (cpu->present) {
+            PDACPIPerformanceDomain *domain = &perf->domains[cpu->domain];
+            domain->target = ACPI_MIN(domain->target, cpu->request);
+            domain->limit = ACPI_MAX(domain->limit, cpu->limit);
+        }
+    }
+
+    for (UInt32 i = 0; i < perf->cpuCount; i++) {
+        PDACPIPerformanceCPU *cpu = &perf->cpus[i];
+        if (!cpu->present) {
+            continue;
+        }
+
+        PDACPIPerformanceDomain *domain = &perf->domains[cpu->domain];
+        UInt32 state;
+        if (domain->coordination == kPDACPICoordinationHardwareAll) {
+            state = ACPI_MAX(cpu->request, cpu->limit);
+        } else {
+            state = ACPI_MAX(domain->target, domain->limit);
+        }
+        state = PDACPIPerformanceValidState(cpu, state);
+
+        if (state == cpu->current) {
+            continue;
+        }
+        cpu->current = state;
+        if (domain->coordination == kPDACPICoordinationSoftwareAny && domain->written) {
+            continue;
+        }
+        domain->written = true;
+
+        perf->writes[count].cpu = i;
+        perf->writes[count].reg = &cpu->control;
+        perf->writes[count].value = cpu->states[state].control;
+        count++;
+    }
+
+    if (count) {
+        perf->transitions += count;
+        perf->backend.write(perf->backend.context, perf->writes, count);
+    }
+}
+
+void PDACPIPerformanceUpdate(PDACPIPerformance *perf)
+{
+    bzero(perf->samples, perf->cpuCount * sizeof(PDACPIPerformanceSample));
+    perf->backend.sample(perf->backend.context, perf->samples, perf->cpuCount);
+
+    for (UInt32 i = 0; i < perf->cpuCount; i++) {
+        PDACPIPerformanceCPU *cpu = &perf->cpus[i];
+        const PDACPIPerformanceSample *sample = &perf->samples[i];
+        if (!cpu->present || !sample->valid) {
+            continue;
+        }
+
+        UInt64 busy = sample->busy - cpu->lastBusy;
+        UInt64 elapsed = sample->elapsed - cpu->lastElapsed;
+        bool first = !cpu->sampled;
+        cpu->lastBusy = sample->busy;
+        cpu->lastElapsed = sample->elapsed;
+        cpu->sampled = true;
+        if (first || !elapsed || cpu->current == kPDACPIPerformanceNoState) {
+            continue;
+        }
+
+        UInt32 load = busy >= elapsed ? 100 : (UInt32)(busy * 100 / elapsed);
+        cpu->request = PDACPIPerformanceGovern(perf, cpu, load);
+    }
+
+    PDACPIPerformanceApply(perf);
+}
+
+void PDACPIPerformanceRemoveProcessor(PDACPIPerformance *perf, UInt32 cpuNumber)
+{
+    if (cpuNumber >= perf->cpuCount || !perf->cpus[cpuNumber].present) {
+        return;
+    }
+
+    /* The rest of its domain is no longer held back by its request or _PPC */
+    perf->cpus[cpuNumber].present = false;
+    PDACPIPerformanceApply(perf);
+}
+
+void PDACPIPerformanceUpdateLimit(PDACPIPerformance *perf, UInt32 cpuNumber)
+{
+    if (cpuNumber >= perf->cpuCount || !perf->cpus[cpuNumber].present) {
+        return;
+    }
+
+    PDACPIPerformanceCPU *cpu = &perf->cpus[cpuNumber];
+    cpu->limit = PDACPIPerformanceEvaluatePPC(cpu);
+    cpu->request = ACPI_MAX(cpu->request, cpu->limit);
+    PDACPIPerformanceApply(perf);
+}
+
+IOReturn PDACPIPerformanceSetState(PDACPIPerformance *perf, UInt32 cpuNumber, UInt32 index)
+{
+    if (cpuNumber >= perf->cpuCount || !perf->cpus[cpuNumber].present ||
+        index >= perf->cpus[cpuNumber].count || !perf->cpus[cpuNumber].states[index].valid) {
+        return kIOReturnBadArgument;
+    }
+
+    PDACPIPerformanceCPU *cpu = &perf->cpus[cpuNumber];
+    cpu->request = ACPI_MAX(index, cpu->limit);
+    cpu->slowerWanted = 0;
+    PDACPIPerformanceApply(perf);
+    return cpu->request == index ? kIOReturnSuccess : kIOReturnNotPermitted;
+}
+
+#pragma mark Queries
+
+UInt32 PDACPIPerformanceGetSamplingInterval(const PDACPIPerformance *perf)
+{
+    /* A transition of N us every N ms keeps switching overhead at 0.1% */
+    return ACPI_MAX(perf->governor.samplingMS, perf->maxLatency);
+}
+
+UInt32 PDACPIPerformanceGetStates(const PDACPIPerformance *perf, UInt32 cpu, const PDACPIPState **states)
+{
+    if (cpu >= perf->cpuCount || !perf->cpus[cpu].present) {
+        *states = NULL;
+        return 0;
+    }
+    *states = perf->cpus[cpu].states;
+    return perf->cpus[cpu].count;
+}
+
+UInt32 PDACPIPerformanceGetCurrentState(const PDACPIPerformance *perf, UInt32 cpu)
+{
+    if (cpu >= perf->cpuCount || !perf->cpus[cpu].present) {
+        return kPDACPIPerformanceNoState;
+    }
+    return perf->cpus[cpu].current;
+}
+
+UInt64 PDACPIPerformanceGetTransitions(const PDACPIPerformance *perf)
+{
+    return perf->transitions;
+}
+
+#pragma mark Processor lookup
+
+struct PDACPIProcessorSearch {
+    UInt32 id;
+    ACPI_HANDLE found;
+};
+
+static ACPI_STATUS PDACPIFindProcessorObject(ACPI_HANDLE object, UINT32, void *context, void **)
+{
+    PDACPIProcessorSearch *search = (PDACPIProcessorSearch *)context;
+    ACPI_OBJECT processor;
+    ACPI_BUFFER buffer = { sizeof(processor), &processor };
+
+    /* Evaluating a Processor object yields its ProcId */
+    if (ACPI_SUCCESS(AcpiEvaluateObjectTyped(object, NULL, NULL, &buffer, ACPI_TYPE_PROCESSOR)) &&
+        processor.Processor.ProcId == search->id) {
+        search->found = object;
+        return AE_CTRL_TERMINATE;
+    }
+    return AE_OK;
+}
+
+static ACPI_STATUS PDACPIFindProcessorDevice(ACPI_HANDLE object, UINT32, void *context, void **)
+{
+    PDACPIProcessorSearch *search = (PDACPIProcessorSearch *)context;
+    ACPI_OBJECT uid;
+    ACPI_BUFFER buffer = { sizeof(uid), &uid };
+
+    if (ACPI_SUCCESS(AcpiEvaluateObjectTyped(object, (char *)METHOD_NAME__UID, NULL, &buffer, ACPI_TYPE_INTEGER)) &&
+        uid.Integer.Value == search->id) {
+        search->found = object;
+        return AE_CTRL_TERMINATE;
+    }
+    return AE_OK;
+}
+
+ACPI_HANDLE PDACPIFindProcessor(UInt32 processorID)
+{
+    PDACPIProcessorSearch search = { processorID, NULL };
+
+    AcpiWalkNamespace(ACPI_TYPE_PROCESSOR, ACPI_ROOT_OBJECT, ACPI_UINT32_MAX,
+                      PDACPIFindProcessorObject, NULL, &search, NULL);
+    if (!search.found) {
+        AcpiGetDevices((char *)"ACPI0007", PDACPIFindProcessorDevice, &search, NULL);
+    }
+    return search.found;
+}
@@ -0,0 +1,145 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#ifndef _PDACPI_PERFORMANCE_H
+#define _PDACPI_PERFORMANCE_H
+
+#include <libkern/OSTypes.h>
+#include <IOKit/IOReturn.h>
+
+extern "C" {
+#include "acpica/acpi.h"
+}
+
+/*
+ * ACPI processor performance states (_PSS, _PCT, _PPC, _PSD).
+ *
+ * The engine keeps each processor's P-state table and runs the governor;
+ * it doesn't touch hardware itself. Every sampling period the backend
+ * reports how busy each CPU was, the governor picks a state per CPU, the
+ * picks are coordinated across _PSD domains, and the backend is handed the
+ * control register writes that result. PDACPICPU supplies the backend that
+ * uses MSRs and I/O ports; anything else (a simulation) can supply its own.
+ *
+ * None of these functions lock. The caller serializes calls on one engine.
+ */
+
+#define kPDACPIPerformanceMaxStates     16
+
+/* _PSD CoordType */
+#define kPDACPICoordinationSoftwareAll  0xFC    /* OSPM writes the domain's state on every CPU in it */
+#define kPDACPICoordinationSoftwareAny  0xFD    /* a write on any one CPU sets the whole domain */
+#define kPDACPICoordinationHardwareAll  0xFE    /* every CPU writes its own; hardware picks */
+
+#define kPDACPIPerformanceNoState       0xFFFFFFFF
+
+struct PDACPIPState {
+    UInt32 frequency;                   /* MHz */
+    UInt32 power;                       /* mW */
+    UInt32 latency;                     /* us, worst case to get here */
+    UInt32 busMasterLatency;            /* us */
+    UInt64 control;                     /* value for the _PCT control register */
+    UInt64 status;                      /* value the _PCT status register reads once here */
+    bool valid;                         /* false for a malformed or out of order _PSS entry, never used */
+};
+
+/* Busy and elapsed time since some fixed point, in any one unit; from the backend */
+struct PDACPIPerformanceSample {
+    UInt64 busy;
+    UInt64 elapsed;
+    bool valid;
+};
+
+struct PDACPIPerformanceWrite {
+    UInt32 cpu;                         /* must run on this CPU for FFixedHW */
+    const ACPI_GENERIC_ADDRESS *reg;    /* the CPU's _PCT control register */
+    UInt64 value;
+};
+
+struct PDACPIPerformanceBackend {
+    /* Fill samples[0..count-1], one per CPU; leave valid false where it can't tell */
+    void (*sample)(void *context, PDACPIPerformanceSample *samples, UInt32 count);
+    /* Carry out the writes */
+    void (*write)(void *context, const PDACPIPerformanceWrite *writes, UInt32 count);
+    void *context;
+};
+
+struct PDACPIPerformanceGovernor {
+    UInt32 samplingMS;                  /* between samples; raised to 1000x the slowest transition */
+    UInt32 upThreshold;                 /* % busy that goes straight to the fastest allowed state */
+    UInt32 targetLoad;                  /* % busy aimed for below that */
+    UInt32 downSamples;                 /* periods in a row a slower state must be wanted */
+};
+
+#define kPDACPIPerformanceDefaultSamplingMS     50
+#define kPDACPIPerformanceDefaultUpThreshold    80
+#define kPDACPIPerformanceDefaultTargetLoad     60
+#define kPDACPIPerformanceDefaultDownSamples    3
+
+struct PDACPIPerformance;
+
+/* governor may be NULL for the defaults */
+PDACPIPerformance *PDACPIPerformanceCreate(UInt32 cpuCount, const PDACPIPerformanceBackend *backend,
+                                           const PDACPIPerformanceGovernor *governor);
+void PDACPIPerformanceDestroy(PDACPIPerformance *perf);
+
+/* Evaluate the processor object's _PSS, _PCT, _PPC and _PSD for cpu */
+IOReturn PDACPIPerformanceAddProcessor(PDACPIPerformance *perf, UInt32 cpu, ACPI_HANDLE processor);
+
+/* Stop governing cpu; it may be added again */
+void PDACPIPerformanceRemoveProcessor(PDACPIPerformance *perf, UInt32 cpu);
+
+/* Re-evaluate _PPC (after Notify 0x80) and slow down now if it has to */
+void PDACPIPerformanceUpdateLimit(PDACPIPerformance *perf, UInt32 cpu);
+
+/* One sampling period: sample, govern, coordinate, write */
+void PDACPIPerformanceUpdate(PDACPIPerformance *perf);
+
+/* Ask for a state on cpu now, as the governor would; it may move on next period */
+IOReturn PDACPIPerformanceSetState(PDACPIPerformance *perf, UInt32 cpu, UInt32 index);
+
+UInt32 PDACPIPerformanceGetSamplingInterval(const PDACPIPerformance *perf);
+/* The _PSS entries by index, valid or not, up to kPDACPIPerformanceMaxStates of them */
+UInt32 PDACPIPerformanceGetStates(const PDACPIPerformance *perf, UInt32 cpu, const PDACPIPState **states);
+UInt32 PDACPIPerformanceGetCurrentState(const PDACPIPerformance *perf, UInt32 cpu);
+UInt64 PDACPIPerformanceGetTransitions(const PDACPIPerformance *perf);
+
+/* The Processor object or ACPI0007 device for a MADT processor UID, or NULL */
+ACPI_HANDLE PDACPIFindProcessor(UInt32 processorID);
+
+/* The Register () in a ResourceTemplate buffer, as _PCT and _CST carry them */
+bool PDACPIGetRegister(const ACPI_OBJECT *object, ACPI_GENERIC_ADDRESS *reg);
+
+#endif /* _PDACPI_PERFORMANCE_H */
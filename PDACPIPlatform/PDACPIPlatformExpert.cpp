@@ -34,6 +34,8 @@
 */
 
 #include "PDACPIPlatformExpert.h"
+#include "PDACPIEmbeddedController.h"
+#include "PDACPITableIndex.h"
 #include <IOKit/IOLib.h>
 
 #if __has_include(<IOKit/pci/IOPCIPrivate.h>)
@@ -53,10 +55,19 @@ extern "C" {
 OSDefineMetaClassAndStructors(PDACPIPlatformExpert, IOACPIPlatformExpert)
 
 ACPI_TABLE_MADT *gAPICTable;
+static PDACPIPlatformExpert *gPDACPIPlatformExpert;    /* for ACPICA address space callbacks */
 
 /* AcpiOsLayer.cpp */
 extern ACPI_MCFG_ALLOCATION *gPCIDataFromMCFG;
 extern size_t gPCIMCFGEntryCount;
+extern ACPI_STATUS AcpiOsExtAddPciEcam(const ACPI_MCFG_ALLOCATION *Allocation);
+
+/* exfield.c */
+extern "C" ACPI_STATUS AcpiExGetProtocolBufferLength(UINT32 ProtocolId, UINT32 *ReturnLength);
+
+/* osdarwin.c */
+extern "C" UINT32 AcpiOsReadLog(UINT64 *Cursor, char *Buffer, UINT32 Length);
+extern "C" void AcpiOsGetLogStatistics(UINT64 *Lines, UINT64 *Suppressed, UINT64 *Dropped);
 
 bool PDACPIPlatformExpert::initializeACPICA()
 {
@@ -92,6 +103,7 @@ bool PDACPIPlatformExpert::initializeACPICA()
     
     this->catalogACPITables();
     this->fetchPCIData();
+    this->probeEmbeddedController();
 
     status = AcpiEnableSubsystem(ACPI_FULL_INITIALIZATION);
     if (ACPI_FAILURE(status)) {
@@ -106,24 +118,60 @@ bool PDACPIPlatformExpert::initializeACPICA()
         AcpiTerminate(); // Cleanup
         return false;
     }
+    
+    /* _Qxx methods can run now that _INI has */
+    this->startEmbeddedController();
+    
+    return true;
 }
 
 /* this is so IOPCIFamily gets our ACPI tables. */
 OSObject *PDACPIPlatformExpert::copyProperty(const char *property) const
 {
-    if (strncmp(property, "ACPI Tables", strlen(property)) == 0) {
-        return this->m_tableDict->copyCollection();
+    if (this->m_tableDict && strcmp(property, "ACPI Tables") == 0) {
+        this->m_tableDict->retain();
+        return this->m_tableDict;
+    }
+    
+    if (strcmp(property, "ACPI Log Statistics") == 0) {
+        UINT64 lines, suppressed, dropped;
+        OSDictionary *stats = OSDictionary::withCapacity(3);
+        
+        if (stats) {
+            AcpiOsGetLogStatistics(&lines, &suppressed, &dropped);
+            OSNumber *number = OSNumber::withNumber(lines, 64);
+            stats->setObject("Lines", number);
+            OSSafeReleaseNULL(number);
+            number = OSNumber::withNumber(suppressed, 64);
+            stats->setObject("Suppressed", number);
+            OSSafeReleaseNULL(number);
+            number = OSNumber::withNumber(dropped, 64);
+            stats->setObject("Dropped", number);
+            OSSafeReleaseNULL(number);
+        }
+        return stats;
     }
     
     return super::copyProperty(property);
 }
 
+IOReturn PDACPIPlatformExpert::readACPILog(UInt64 *cursor, void *buffer, UInt32 *length)
+{
+    if (!cursor || !buffer || !length) {
+        return kIOReturnBadArgument;
+    }
+    
+    *length = AcpiOsReadLog(cursor, (char *)buffer, *length);
+    return kIOReturnSuccess;
+}
+
 bool PDACPIPlatformExpert::fetchPCIData()
 {
     const OSData *table = this->getACPITableData("MCFG", 0);
     
     if (!table) {
         IOLog("ACPI: No MCFG table found in the ACPI table collection.\n");
+        return false;
     }
     
     ACPI_TABLE_MCFG *mcfg = (ACPI_TABLE_MCFG *)table->getBytesNoCopy();
@@ -131,79 +179,117 @@ bool PDACPIPlatformExpert::fetchPCIData()
     gPCIMCFGEntryCount = (mcfg->Header.Length - sizeof(ACPI_TABLE_MCFG)) / sizeof(ACPI_MCFG_ALLOCATION);
     gPCIDataFromMCFG = (ACPI_MCFG_ALLOCATION *)(table->getBytesNoCopy() + sizeof(ACPI_TABLE_MCFG));
     
+    /* Hand every allocation to the OSL's ECAM engine, not just the booter's segment 0 range. */
+    for (size_t i = 0; i < gPCIMCFGEntryCount; i++) {
+        AcpiOsExtAddPciEcam(&gPCIDataFromMCFG[i]);
+    }
+    
     /* While we're here; kindly tell IOPCIFamily to initialize MMIO mapping services. */
     IOPCIPlatformInitialize();
     
     return true;
 }
 
-/* This was based off of osbsdtbl.c's shenanigans */
-struct AcpiTableMap {
-    char Signature[4];
-    UInt8 instance;
-    ACPI_TABLE_HEADER *Tbl; /* well we've already mapped the damn thing so, might as well reuse the pointer. */
-};
+static ACPI_STATUS PDACPIFindFirstDevice(ACPI_HANDLE object, UINT32, void *, void **ret)
+{
+    *ret = object;
+    return AE_CTRL_TERMINATE;
+}
+
+/*
+ * Bring up the ECDT's EC before the namespace is initialized, so _REG and
+ * _INI methods that touch EC fields work; the ECDT exists for exactly this.
+ * Nothing is evaluated here: _HID, _STA and _CRS may themselves need _INI,
+ * or the EC.
+ */
+void PDACPIPlatformExpert::probeEmbeddedController()
+{
+    const OSData *table = this->getACPITableData("ECDT", 0);
+    if (!table) {
+        return;
+    }
+    
+    this->m_embeddedController = PDACPIEmbeddedController::withECDT((const ACPI_TABLE_ECDT *)table->getBytesNoCopy(),
+                                                                    table->getLength());
+    if (this->m_embeddedController && !this->m_embeddedController->attach(this)) {
+        IOLog("ACPI: EC address space handler not installed\n");
+        OSSafeReleaseNULL(this->m_embeddedController);
+    }
+}
+
+/*
+ * Once _INI has run: the PNP0C09 device is the EC when there is no ECDT,
+ * and names the ECDT's EC for _Qxx when the ECDT's path didn't resolve.
+ * Attaching here runs the EC regions' _REG.
+ */
+void PDACPIPlatformExpert::startEmbeddedController()
+{
+    ACPI_HANDLE device = NULL;
+    AcpiGetDevices((char *)"PNP0C09", PDACPIFindFirstDevice, NULL, &device);
+    
+    if (!this->m_embeddedController && device) {
+        this->m_embeddedController = PDACPIEmbeddedController::withDevice(device);
+        if (this->m_embeddedController && !this->m_embeddedController->attach(this)) {
+            IOLog("ACPI: EC address space handler not installed\n");
+            OSSafeReleaseNULL(this->m_embeddedController);
+        }
+    }
+    if (!this->m_embeddedController) {
+        return;
+    }
+    
+    if (device) {
+        this->m_embeddedController->setDevice(device);
+    }
+    this->m_embeddedController->enableEvents();
+}
 
 bool PDACPIPlatformExpert::catalogACPITables()
 {
     char name[32];
-    ACPI_TABLE_HEADER *Table;
     UInt32 tables = AcpiGbl_RootTableList.CurrentTableCount;
-    this->m_tableDict = OSDictionary::withCapacity(tables + 1);
-
-    AcpiTableMap *tmp = IOMalloc(sizeof(AcpiTableMap) * tables);
-
-    /* ZORMEISTER: God this is such a hack... */
+    
+    ACPI_TABLE_HEADER **list = (ACPI_TABLE_HEADER **)IOMalloc(sizeof(ACPI_TABLE_HEADER *) * (tables + 1));
+    if (!list) {
+        return false;
+    }
+    
     for (UInt32 i = 0; i < tables; i++) {
-        AcpiGetTableByIndex(i, &Table);
-        for (UInt32 j = i; 0 > j; t--) { /* ZORMEISTER: walk backwards from our current position. */
-            if (strncmp(tmp[j].Signature, Table->Signature, 4) == 0) {
-                if (tmp[j].instance == 0) {
-                    tmp[j].instance++;
-                }
-
-                tmp[i].instance = tmp[j].instance + 1;
-            }
+        if (ACPI_FAILURE(AcpiGetTableByIndex(i, &list[i]))) {
+            list[i] = NULL;
         }
     }
-
-    /* ZORMEISTER: now do it again. */
-
-    for (UInt32 k = 0; k < tables; k++) {
-        /* Allocate an OSData using the ACPI table length. */
-        OSData *data = OSData::withBytesNoCopy(tmp[k].Tbl, tmp[k].Tbl->Length);
-        memset(name, 0, 32); /* clear out the stack variable */
-        if (tmp[k].instance > 0) {
-            snprintf(name, 32, "%4.4s-%u", tmp[k].Tbl->Signature, tmp[k].instance);
-        } else {
-            snprintf(name, 32, "%4.4s", tmp[k].Tbl->Signature);
+    
+    this->m_tableIndex = AcpiTableIndexBuild(list, tables, &this->m_tableIndexSize);
+    IOFree(list, sizeof(ACPI_TABLE_HEADER *) * (tables + 1));
+    if (!this->m_tableIndex) {
+        return false;
+    }
+    
+    /* Build the dictionary once; copyProperty hands out this same, immutable, object. */
+    this->m_tableDict = OSDictionary::withCapacity(tables + 1);
+    if (!this->m_tableDict) {
+        return false;
+    }
+    
+    for (UInt32 k = 0; k < this->m_tableIndexSize; k++) {
+        AcpiTableIndexEntry *entry = &this->m_tableIndex[k];
+        if (!entry->Data) {
+            continue;
         }
-
-        this->m_tableDict->setObject(name, data);
-        OSSafeReleaseNULL(data);
+        
+        AcpiTableIndexName(entry, name, sizeof(name));
+        this->m_tableDict->setObject(name, entry->Data);
     }
     
-    IOFree(tmp, sizeof(AcpiTableMap) * tables);
+    this->m_tableDict->setOptions(OSCollection::kImmutable, OSCollection::kImmutable);
 
     return true;
 }
 
 const OSData *PDACPIPlatformExpert::getACPITableData(const char *name, UInt32 TableIndex)
 {
-    char tbl[32];
-
-    if (TableIndex > 0) {
-        snprintf(tbl, 32, "%4.4s-%u", name, TableIndex);
-    } else {
-        snprintf(tbl, 32, "%4.4s", name);
-    }
-
-    OSObject *obj = this->m_tableDict->getObject(name);
-    if (obj) {
-        return OSDynamicCast(OSData, obj);
-    }
-    
-    return nullptr;
+    return AcpiTableIndexLookup(this->m_tableIndex, this->m_tableIndexSize, name, TableIndex);
 }
 
 
@@ -218,9 +304,16 @@ bool PDACPIPlatformExpert::start(IOService *provider)
     
     this->m_provider = OSDynamicCast(IOPlatformExpertDevice, provider);
     
+    this->m_spaceLock = IOLockAlloc();
+    if (!this->m_spaceLock) {
+        return false;
+    }
+    gPDACPIPlatformExpert = this;
+    
     /* Respond to certain boot arguemnts */
     PE_parse_boot_argn("acpi_layer", &AcpiDbgLayer, 4);
     PE_parse_boot_argn("acpi_level", &AcpiDbgLevel, 4);
+    PE_parse_boot_argn("acpi_parallel", &AcpiGbl_ParallelMethods, sizeof(AcpiGbl_ParallelMethods));
 
     if (!this->initializeACPICA()) {
         panic("ACPI: ACPICA layer failed to initialize.\n");
@@ -238,6 +331,18 @@ bool PDACPIPlatformExpert::start(IOService *provider)
 void PDACPIPlatformExpert::stop(IOService *provider)
 {
     IOLog("PDACPIPlatformExpert::stop\n");
+    
+    if (this->m_embeddedController) {
+        this->m_embeddedController->detach(this);
+        OSSafeReleaseNULL(this->m_embeddedController);
+    }
+    this->removeAcpiAddressSpaces();
+    OSSafeReleaseNULL(this->m_tableDict);
+    if (this->m_tableIndex) {
+        AcpiTableIndexFree(this->m_tableIndex, this->m_tableIndexSize);
+        this->m_tableIndex = NULL;
+    }
+    
     super::stop(provider);
 }
 
@@ -273,50 +378,370 @@ void PDACPIPlatformExpert::performACPIPowerOff()
     while (1) asm volatile("hlt");
 }
 
+/*
+ * Address space handlers.
+ *
+ * One slot per ACPI space ID (0-255), which covers EC, SMBus, CMOS, IPMI,
+ * GPIO, GenericSerialBus, PCC and the vendor range. System memory, system
+ * I/O and PCI configuration are served here directly and can't be replaced.
+ *
+ * Dispatch never takes a lock. It counts itself into one of the slot's two
+ * in-flight counters (the one the slot's epoch currently selects), reads the
+ * slot's PDACPIAddressSpaceHandler and calls it. Registration publishes the
+ * new record, then flips the epoch and waits for the counter it left to
+ * drain, twice, before freeing the old record. New dispatches always count
+ * into the other counter, so the wait ends even while the space is busy, and
+ * once unregisterAddressSpaceHandler returns the old handler is not running
+ * and won't be called again. A handler must not (un)register its own space
+ * from inside a call.
+ */
+struct PDACPIAddressSpaceHandler {
+    IOACPIAddressSpaceHandler handler;
+    PDACPIAddressSpaceBufferHandler bufferHandler;
+    void *context;
+};
+
+/*
+ * The context ACPICA's handler for a space is installed with. ACPICA writes
+ * PCC, FFixedHW and Connection() details into the front of it before it
+ * calls the handler, so it has to be real memory with room for the largest.
+ */
+struct PDACPIAddressSpaceAcpiContext {
+    union {
+        ACPI_CONNECTION_INFO connection;
+        ACPI_PCC_INFO pcc;
+        ACPI_FFH_INFO ffh;
+    } info;
+    IOACPIAddressSpaceID spaceID;
+};
+
+static bool PDACPIAddressSpaceIsBuiltIn(IOACPIAddressSpaceID spaceID)
+{
+    return spaceID == kIOACPIAddressSpaceIDSystemMemory ||
+           spaceID == kIOACPIAddressSpaceIDSystemIO ||
+           spaceID == kIOACPIAddressSpaceIDPCIConfiguration;
+}
+
+/* Spaces whose fields ACPICA hands over as a buffer (or, for GPIO, with a connection) */
+static bool PDACPIAddressSpaceIsBuffered(IOACPIAddressSpaceID spaceID)
+{
+    switch (spaceID) {
+        case ACPI_ADR_SPACE_SMBUS:
+        case ACPI_ADR_SPACE_IPMI:
+        case ACPI_ADR_SPACE_GPIO:
+        case ACPI_ADR_SPACE_GSBUS:
+        case ACPI_ADR_SPACE_PLATFORM_COMM:
+        case ACPI_ADR_SPACE_PLATFORM_RT:
+        case ACPI_ADR_SPACE_FIXED_HARDWARE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Describe the buffer behind Value as exserial.c and exfield.c sized it */
+static void PDACPIAddressSpaceDescribe(const PDACPIAddressSpaceAcpiContext *context, UINT32 Function,
+                                       UINT64 *Value, PDACPIAddressSpaceRequest *request)
+{
+    UINT32 length = 0;
+
+    bzero(request, sizeof(*request));
+    request->buffer = (UInt8 *)Value;
+    request->protocol = Function >> 16;
+
+    switch (context->spaceID) {
+        case ACPI_ADR_SPACE_SMBUS:
+            request->length = ACPI_SMBUS_BUFFER_SIZE;
+            break;
+        case ACPI_ADR_SPACE_IPMI:
+            request->length = ACPI_IPMI_BUFFER_SIZE;
+            break;
+        case ACPI_ADR_SPACE_GSBUS:
+            if (ACPI_SUCCESS(AcpiExGetProtocolBufferLength(request->protocol, &length))) {
+                request->length = ACPI_SERIAL_HEADER_SIZE + length;
+            }
+            /* fall through */
+        case ACPI_ADR_SPACE_GPIO:
+            if (context->spaceID == ACPI_ADR_SPACE_GPIO) {
+                request->length = sizeof(UINT64);
+            }
+            request->connection = context->info.connection.Connection;
+            request->connectionLength = context->info.connection.Length;
+            request->accessLength = context->info.connection.AccessLength;
+            break;
+        case ACPI_ADR_SPACE_PLATFORM_COMM:
+            request->length = context->info.pcc.Length;
+            request->subspace = context->info.pcc.SubspaceId;
+            break;
+        case ACPI_ADR_SPACE_PLATFORM_RT:
+            request->length = ACPI_PRM_INPUT_BUFFER_SIZE;
+            break;
+        case ACPI_ADR_SPACE_FIXED_HARDWARE:
+            request->length = ACPI_FFH_INPUT_BUFFER_SIZE;
+            request->regionOffset = context->info.ffh.Offset;
+            request->regionLength = context->info.ffh.Length;
+            break;
+        default:
+            break;
+    }
+}
+
+/* ACPICA's side of a registered space: AML OperationRegions land here. */
+static ACPI_STATUS PDACPIAddressSpaceAcpiHandler(UINT32 Function, ACPI_PHYSICAL_ADDRESS Address, UINT32 BitWidth,
+                                                 UINT64 *Value, void *HandlerContext, void *)
+{
+    PDACPIAddressSpaceAcpiContext *context = (PDACPIAddressSpaceAcpiContext *)HandlerContext;
+    UInt32 operation = (Function & ACPI_IO_MASK) == ACPI_WRITE ? kIOACPIAddressSpaceOpWrite : kIOACPIAddressSpaceOpRead;
+    IOACPIAddress address;
+    IOReturn ret;
+
+    address.addr64 = Address;
+    if (PDACPIAddressSpaceIsBuffered(context->spaceID)) {
+        PDACPIAddressSpaceRequest request;
+        PDACPIAddressSpaceDescribe(context, Function, Value, &request);
+        ret = gPDACPIPlatformExpert->dispatchAddressSpaceBuffer(operation, context->spaceID, address, &request, BitWidth);
+    } else {
+        ret = gPDACPIPlatformExpert->dispatchAddressSpace(operation, context->spaceID, address, Value, BitWidth, 0);
+    }
+
+    switch (ret) {
+        case kIOReturnSuccess:
+            return AE_OK;
+        case kIOReturnNotFound:
+            return AE_NOT_EXIST;
+        case kIOReturnBadArgument:
+            return AE_BAD_PARAMETER;
+        case kIOReturnTimeout:
+            return AE_TIME;
+        default:
+            return AE_ERROR;
+    }
+}
+
+void PDACPIPlatformExpert::publishAddressSpaceHandler(IOACPIAddressSpaceID spaceID, PDACPIAddressSpaceHandler *record)
+{
+    PDACPIAddressSpaceHandler *old = this->m_spaceHandler[spaceID];
+
+    /* Full barrier: a dispatch that has not yet counted itself in will see the new record. */
+    OSCompareAndSwapPtr(old, record, (void * volatile *)&this->m_spaceHandler[spaceID]);
+
+    for (UInt32 pass = 0; pass < 2; pass++) {
+        UInt32 drain = this->m_spaceEpoch[spaceID] & 1;
+        OSIncrementAtomic(&this->m_spaceEpoch[spaceID]);
+        while (this->m_spaceActive[spaceID][drain]) {
+            IOSleep(1);
+        }
+    }
+
+    if (old) {
+        IOFree(old, sizeof(PDACPIAddressSpaceHandler));
+    }
+}
+
+IOReturn PDACPIPlatformExpert::registerAddressSpace(IOACPIAddressSpaceID spaceID, IOACPIAddressSpaceHandler handler,
+                                                    PDACPIAddressSpaceBufferHandler bufferHandler, void *context)
+{
+    /* We don't care about the specific device; we care about the handler itself */
+    if (spaceID >= kPDACPIAddressSpaceCount || (!handler && !bufferHandler)) {
+        IOLog("PDACPIPlatformExpert::%s: Invalid attempt at registering an address space handler\n", __PRETTY_FUNCTION__);
+        return kIOReturnBadArgument;
+    }
+    if (PDACPIAddressSpaceIsBuiltIn(spaceID)) {
+        return kIOReturnUnsupported;
+    }
+
+    PDACPIAddressSpaceHandler *record = (PDACPIAddressSpaceHandler *)IOMalloc(sizeof(PDACPIAddressSpaceHandler));
+    if (!record) {
+        return kIOReturnNoMemory;
+    }
+    record->handler = handler;
+    record->bufferHandler = bufferHandler;
+    record->context = context;
+
+    IOLockLock(this->m_spaceLock);
+    this->publishAddressSpaceHandler(spaceID, record);
+
+    /* Route AML accesses to the space through us. Stays installed; an empty slot answers AE_NOT_EXIST. */
+    if (!this->m_spaceContext[spaceID]) {
+        PDACPIAddressSpaceAcpiContext *acpiContext = (PDACPIAddressSpaceAcpiContext *)IOMalloc(sizeof(PDACPIAddressSpaceAcpiContext));
+        if (acpiContext) {
+            bzero(acpiContext, sizeof(*acpiContext));
+            acpiContext->spaceID = spaceID;
+            ACPI_STATUS status = AcpiInstallAddressSpaceHandler(ACPI_ROOT_OBJECT, (ACPI_ADR_SPACE_TYPE)spaceID,
+                                                                PDACPIAddressSpaceAcpiHandler, NULL, acpiContext);
+            if (ACPI_SUCCESS(status)) {
+                this->m_spaceContext[spaceID] = acpiContext;
+            } else {
+                IOLog("PDACPIPlatformExpert::%s: AML can't reach address space 0x%x: %s\n",
+                      __PRETTY_FUNCTION__, spaceID, AcpiFormatException(status));
+                IOFree(acpiContext, sizeof(*acpiContext));
+            }
+        }
+    }
+    IOLockUnlock(this->m_spaceLock);
+
+    IOLog("PDACPIPlatformExpert::%s: Registered handler for address space 0x%x\n", __PRETTY_FUNCTION__, spaceID);
+    return kIOReturnSuccess;
+}
+
+void PDACPIPlatformExpert::unregisterAddressSpace(IOACPIAddressSpaceID spaceID, IOACPIAddressSpaceHandler handler,
+                                                  PDACPIAddressSpaceBufferHandler bufferHandler)
+{
+    if (spaceID >= kPDACPIAddressSpaceCount || PDACPIAddressSpaceIsBuiltIn(spaceID)) {
+        IOLog("PDACPIPlatformExpert::%s: Invalid attempt at removing an address space handler\n", __PRETTY_FUNCTION__);
+        return;
+    }
+
+    IOLockLock(this->m_spaceLock);
+    PDACPIAddressSpaceHandler *current = this->m_spaceHandler[spaceID];
+    if (current && (handler ? current->handler == handler :
+                    bufferHandler ? current->bufferHandler == bufferHandler : true)) {
+        this->publishAddressSpaceHandler(spaceID, NULL);
+        IOLog("PDACPIPlatformExpert::%s: Removed handler for address space 0x%x\n", __PRETTY_FUNCTION__, spaceID);
+    }
+    IOLockUnlock(this->m_spaceLock);
+}
+
+/* Take our handlers out of ACPICA; only once nothing can evaluate AML any more */
+void PDACPIPlatformExpert::removeAcpiAddressSpaces()
+{
+    for (UInt32 spaceID = 0; spaceID < kPDACPIAddressSpaceCount; spaceID++) {
+        if (this->m_spaceContext[spaceID]) {
+            AcpiRemoveAddressSpaceHandler(ACPI_ROOT_OBJECT, (ACPI_ADR_SPACE_TYPE)spaceID, PDACPIAddressSpaceAcpiHandler);
+            IOFree(this->m_spaceContext[spaceID], sizeof(PDACPIAddressSpaceAcpiContext));
+            this->m_spaceContext[spaceID] = NULL;
+        }
+        if (this->m_spaceHandler[spaceID]) {
+            this->publishAddressSpaceHandler(spaceID, NULL);
+        }
+    }
+}
+
 IOReturn PDACPIPlatformExpert::registerAddressSpaceHandler(IOACPIPlatformDevice *,
                                                            IOACPIAddressSpaceID spaceID,
                                                            IOACPIAddressSpaceHandler Handler,
                                                            void *context, IOOptionBits options)
 {
-    /* We don't care about the specific device; we care about the handler itself */
-    switch (spaceID) {
-        case kIOACPIAddressSpaceIDEmbeddedController:
-            this->m_ecSpaceHandler = Handler;
-            this->m_ecSpaceContext = context;
-            IOLog("PDACPIPlatformExpert::%s: Registered handler for the EC address space\n", __PRETTY_FUNCTION__);
-            return kIOReturnSuccess;
-        case kIOACPIAddressSpaceIDSMBus:
-            this->m_smbusSpaceHandler = Handler;
-            this->m_smbusSpaceContext = context;
-            IOLog("PDACPIPlatformExpert::%s: Registered handler for the SMBus address space\n", __PRETTY_FUNCTION__);
-            return kIOReturnSuccess;
-        default:
-            IOLog("PDACPIPlatformExpert::%s: Invalid attempt at registering an address space handler\n", __PRETTY_FUNCTION__);
-            return kIOReturnInvalid;
+    if (!Handler) {
+        return kIOReturnBadArgument;
     }
+    return this->registerAddressSpace(spaceID, Handler, NULL, context);
 }
 
 void PDACPIPlatformExpert::unregisterAddressSpaceHandler(IOACPIPlatformDevice *,
                                                          IOACPIAddressSpaceID spaceID,
-                                                         IOACPIAddressSpaceHandler,
+                                                         IOACPIAddressSpaceHandler Handler,
                                                          IOOptionBits)
 {
-    /* Remove the specified handlers */
+    this->unregisterAddressSpace(spaceID, Handler, NULL);
+}
+
+IOReturn PDACPIPlatformExpert::registerAddressSpaceBufferHandler(IOACPIAddressSpaceID spaceID,
+                                                                 PDACPIAddressSpaceBufferHandler handler,
+                                                                 void *context)
+{
+    if (!handler) {
+        return kIOReturnBadArgument;
+    }
+    return this->registerAddressSpace(spaceID, NULL, handler, context);
+}
+
+void PDACPIPlatformExpert::unregisterAddressSpaceBufferHandler(IOACPIAddressSpaceID spaceID,
+                                                               PDACPIAddressSpaceBufferHandler handler)
+{
+    this->unregisterAddressSpace(spaceID, NULL, handler);
+}
+
+UInt32 PDACPIPlatformExpert::enterAddressSpace(IOACPIAddressSpaceID spaceID)
+{
+    UInt32 epoch = this->m_spaceEpoch[spaceID] & 1;
+    OSIncrementAtomic(&this->m_spaceActive[spaceID][epoch]);
+    return epoch;
+}
+
+void PDACPIPlatformExpert::leaveAddressSpace(IOACPIAddressSpaceID spaceID, UInt32 epoch)
+{
+    OSDecrementAtomic(&this->m_spaceActive[spaceID][epoch]);
+}
+
+/* Access a built-in space, or call the registered handler with the slot entered. */
+IOReturn PDACPIPlatformExpert::dispatchAddressSpace(UInt32 operation, IOACPIAddressSpaceID spaceID, IOACPIAddress address,
+                                                    UInt64 *value, UInt32 bitWidth, UInt32 bitOffset)
+{
+    ACPI_STATUS status;
+
     switch (spaceID) {
-        case kIOACPIAddressSpaceIDEmbeddedController:
-            this->m_ecSpaceHandler = nullptr;
-            this->m_ecSpaceContext = nullptr;
-            IOLog("PDACPIPlatformExpert::%s: Removed handler for the EC address space\n", __PRETTY_FUNCTION__);
-            return;
-        case kIOACPIAddressSpaceIDSMBus:
-            this->m_smbusSpaceHandler = nullptr;
-            this->m_smbusSpaceContext = nullptr;
-            IOLog("PDACPIPlatformExpert::%s: Removed handler for the SMBus address space\n", __PRETTY_FUNCTION__);
-            return;
+        case kIOACPIAddressSpaceIDSystemMemory:
+            if (operation == kIOACPIAddressSpaceOpWrite) {
+                status = AcpiOsWriteMemory(address.addr64, *value, bitWidth);
+            } else {
+                status = AcpiOsReadMemory(address.addr64, value, bitWidth);
+            }
+            return ACPI_FAILURE(status) ? kIOReturnError : kIOReturnSuccess;
+
+        case kIOACPIAddressSpaceIDSystemIO:
+            if (operation == kIOACPIAddressSpaceOpWrite) {
+                status = AcpiOsWritePort((ACPI_IO_ADDRESS)address.addr64, (UInt32)*value, bitWidth);
+            } else {
+                UInt32 port = 0;
+                status = AcpiOsReadPort((ACPI_IO_ADDRESS)address.addr64, &port, bitWidth);
+                *value = port;
+            }
+            return ACPI_FAILURE(status) ? kIOReturnError : kIOReturnSuccess;
+
+        case kIOACPIAddressSpaceIDPCIConfiguration: {
+            ACPI_PCI_ID pci = { (UINT16)address.pci.segment, (UINT16)address.pci.bus,
+                                (UINT16)address.pci.device, (UINT16)address.pci.function };
+            if (operation == kIOACPIAddressSpaceOpWrite) {
+                status = AcpiOsWritePciConfiguration(&pci, address.pci.offset, *value, bitWidth);
+            } else {
+                status = AcpiOsReadPciConfiguration(&pci, address.pci.offset, value, bitWidth);
+            }
+            return ACPI_FAILURE(status) ? kIOReturnError : kIOReturnSuccess;
+        }
+
         default:
-            IOLog("PDACPIPlatformExpert::%s: Invalid attempt at removing an address space handler\n", __PRETTY_FUNCTION__);
             break;
     }
+
+    if (spaceID >= kPDACPIAddressSpaceCount) {
+        return kIOReturnBadArgument;
+    }
+
+    UInt32 epoch = this->enterAddressSpace(spaceID);
+    PDACPIAddressSpaceHandler *record = this->m_spaceHandler[spaceID];
+    IOReturn ret = !record ? kIOReturnNotFound :
+                   !record->handler ? kIOReturnUnsupported :
+                   record->handler(operation, address, value, bitWidth, bitOffset, record->context);
+    this->leaveAddressSpace(spaceID, epoch);
+
+    return ret;
+}
+
+/*
+ * A buffer-valued access from AML. A handler registered the IOACPIPlatformExpert
+ * way still gets it, with value pointing at the buffer as it always did.
+ */
+IOReturn PDACPIPlatformExpert::dispatchAddressSpaceBuffer(UInt32 operation, IOACPIAddressSpaceID spaceID, IOACPIAddress address,
+                                                          PDACPIAddressSpaceRequest *request, UInt32 bitWidth)
+{
+    if (spaceID >= kPDACPIAddressSpaceCount || PDACPIAddressSpaceIsBuiltIn(spaceID)) {
+        return kIOReturnBadArgument;
+    }
+
+    UInt32 epoch = this->enterAddressSpace(spaceID);
+    PDACPIAddressSpaceHandler *record = this->m_spaceHandler[spaceID];
+    IOReturn ret;
+    if (!record) {
+        ret = kIOReturnNotFound;
+    } else if (record->bufferHandler) {
+        ret = record->bufferHandler(operation, address, request, bitWidth, record->context);
+    } else {
+        ret = record->handler(operation, address, (UInt64 *)request->buffer, bitWidth, 0, record->context);
+    }
+    this->leaveAddressSpace(spaceID, epoch);
+
+    return ret;
 }
 
 IOReturn PDACPIPlatformExpert::readAddressSpace(UInt64 *value,
@@ -326,34 +751,67 @@ IOReturn PDACPIPlatformExpert::readAddressSpace(UInt64 *value,
                                                 UInt32 bitOffset,
                                                 IOOptionBits options)
 {
-    switch (spaceID) {
-        case kIOACPIAddressSpaceIDSystemMemory: {
-            ACPI_STATUS status = AcpiOsReadMemory(address.addr64, value, bitWidth);
-            if (ACPI_FAILURE(status)) {
-                return kIOReturnError;
-            } else {
-                return kIOReturnSuccess;
+    if (!value) {
+        return kIOReturnBadArgument;
+    }
+    return this->dispatchAddressSpace(kIOACPIAddressSpaceOpRead, spaceID, address, value, bitWidth, bitOffset);
+}
+
+IOReturn PDACPIPlatformExpert::writeAddressSpace(UInt64 value,
+                                                 IOACPIAddressSpaceID spaceID,
+                                                 IOACPIAddress address,
+                                                 UInt32 bitWidth,
+                                                 UInt32 bitOffset,
+                                                 IOOptionBits options)
+{
+    return this->dispatchAddressSpace(kIOACPIAddressSpaceOpWrite, spaceID, address, &value, bitWidth, bitOffset);
+}
+
+/*
+ * Run a list of accesses, in order. Runs of accesses to the same registered
+ * space enter the slot once and keep the same handler throughout, so a
+ * driver reading a block of EC or PCC fields sees one consistent handler and
+ * pays for one enter/leave. Every access gets its own status; the first
+ * failure is returned, and the remaining accesses are still attempted.
+ */
+IOReturn PDACPIPlatformExpert::accessAddressSpaceBatch(PDACPIAddressSpaceAccess *accesses, UInt32 count)
+{
+    IOReturn result = kIOReturnSuccess;
+
+    if (!accesses && count) {
+        return kIOReturnBadArgument;
+    }
+
+    for (UInt32 i = 0; i < count;) {
+        IOACPIAddressSpaceID spaceID = accesses[i].spaceID;
+        UInt32 end = i + 1;
+
+        if (spaceID >= kPDACPIAddressSpaceCount || PDACPIAddressSpaceIsBuiltIn(spaceID)) {
+            accesses[i].status = this->dispatchAddressSpace(accesses[i].operation, spaceID, accesses[i].address,
+                                                            &accesses[i].value, accesses[i].bitWidth, accesses[i].bitOffset);
+        } else {
+            while (end < count && accesses[end].spaceID == spaceID) {
+                end++;
             }
-            break;
-        }
-        case kIOACPIAddressSpaceIDSystemIO: {
-            ACPI_STATUS status = AcpiOsReadPort((ACPI_IO_ADDRESS)address.addr64, (UInt32 *)value, bitWidth);
-            if (ACPI_FAILURE(status)) {
-                return kIOReturnError;
-            } else {
-                return kIOReturnSuccess;
+
+            UInt32 epoch = this->enterAddressSpace(spaceID);
+            PDACPIAddressSpaceHandler *record = this->m_spaceHandler[spaceID];
+            for (UInt32 j = i; j < end; j++) {
+                PDACPIAddressSpaceAccess *a = &accesses[j];
+                a->status = !record ? kIOReturnNotFound :
+                            !record->handler ? kIOReturnUnsupported :
+                            record->handler(a->operation, a->address, &a->value, a->bitWidth, a->bitOffset, record->context);
             }
-            break;
+            this->leaveAddressSpace(spaceID, epoch);
         }
-        case kIOACPIAddressSpaceIDEmbeddedController:
-            if (this->m_ecSpaceHandler && this->m_ecSpaceContext) {
-                return this->m_ecSpaceHandler(kIOACPIAddressSpaceOpRead, address, value, bitWidth, bitOffset, this->m_ecSpaceContext);
-            }
-        case kIOACPIAddressSpaceIDSMBus:
-            if (this->m_smbusSpaceHandler && this->m_smbusSpaceContext) {
-                return this->m_smbusSpaceHandler(kIOACPIAddressSpaceOpRead, address, value, bitWidth, bitOffset, this->m_smbusSpaceContext);
+
+        for (UInt32 j = i; j < end; j++) {
+            if (result == kIOReturnSuccess && accesses[j].status != kIOReturnSuccess) {
+                result = accesses[j].status;
             }
-        default:
-            break;
+        }
+        i = end;
     }
+
+    return result;
 }
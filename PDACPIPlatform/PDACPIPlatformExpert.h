@@ -39,6 +39,47 @@
 #include <IOKit/acpi/IOACPIPlatformExpert.h>
 #include <IOKit/rtc/IORTCController.h>
 
+#define kPDACPIAddressSpaceCount    256     /* ACPI space IDs are a byte */
+
+struct PDACPIAddressSpaceHandler;
+struct PDACPIAddressSpaceAcpiContext;
+class PDACPIEmbeddedController;
+
+/*
+ * One access to a space whose fields don't carry a plain integer. SMBus,
+ * IPMI, GenericSerialBus, PCC, PRM and FFixedHW fields move a buffer, and
+ * GenericSerialBus and GPIO fields reach their device through the field's
+ * Connection() resource. Handlers for these spaces register with
+ * registerAddressSpaceBufferHandler and get one of these per access.
+ */
+struct PDACPIAddressSpaceRequest {
+    UInt8 *buffer;                  /* transfer buffer; GPIO: the pin values, as a UInt64 */
+    UInt32 length;                  /* bytes at buffer */
+    UInt32 protocol;                /* SMBus, GenericSerialBus: the field's AccessAs attribute */
+    const UInt8 *connection;        /* GenericSerialBus, GPIO: the Connection() resource descriptor */
+    UInt32 connectionLength;
+    UInt32 accessLength;            /* GenericSerialBus: AccessAs byte count */
+    UInt32 subspace;                /* PCC: subspace ID */
+    UInt64 regionOffset;            /* FFixedHW: the region's offset and length */
+    UInt64 regionLength;
+};
+
+/* address and bitWidth are as ACPICA passes them; for GPIO, the first pin and the pin count */
+typedef IOReturn (*PDACPIAddressSpaceBufferHandler)(UInt32 operation, IOACPIAddress address,
+                                                    PDACPIAddressSpaceRequest *request,
+                                                    UInt32 bitWidth, void *context);
+
+/* One access in a PDACPIPlatformExpert::accessAddressSpaceBatch list */
+struct PDACPIAddressSpaceAccess {
+    UInt32 operation;               /* kIOACPIAddressSpaceOpRead / kIOACPIAddressSpaceOpWrite */
+    IOACPIAddressSpaceID spaceID;
+    IOACPIAddress address;
+    UInt64 value;                   /* in for writes, out for reads */
+    UInt32 bitWidth;
+    UInt32 bitOffset;
+    IOReturn status;                /* out */
+};
+
 class PDACPIPlatformExpert : public IOACPIPlatformExpert {
     OSDeclareDefaultStructors(PDACPIPlatformExpert);
     
@@ -82,6 +123,25 @@ public:
                                     UInt32 bitWidth,
                                     UInt32 bitOffset,
                                     IOOptionBits options) override;
+    
+    /* Handlers for the buffer-valued spaces; see PDACPIAddressSpaceRequest */
+    virtual IOReturn registerAddressSpaceBufferHandler(IOACPIAddressSpaceID spaceID,
+                                                       PDACPIAddressSpaceBufferHandler handler,
+                                                       void *context);
+    virtual void unregisterAddressSpaceBufferHandler(IOACPIAddressSpaceID spaceID,
+                                                     PDACPIAddressSpaceBufferHandler handler);
+
+    /* Run many accesses in one call; see PDACPIAddressSpaceAccess */
+    virtual IOReturn accessAddressSpaceBatch(PDACPIAddressSpaceAccess *accesses, UInt32 count);
+    
+    /* Access one space: built-in ones directly, the rest through the registered handler */
+    IOReturn dispatchAddressSpace(UInt32 operation, IOACPIAddressSpaceID spaceID, IOACPIAddress address,
+                                  UInt64 *value, UInt32 bitWidth, UInt32 bitOffset);
+    IOReturn dispatchAddressSpaceBuffer(UInt32 operation, IOACPIAddressSpaceID spaceID, IOACPIAddress address,
+                                        PDACPIAddressSpaceRequest *request, UInt32 bitWidth);
+
+    /* Copy ACPICA log text after *cursor (start at 0); *length is the buffer size in, bytes copied out */
+    IOReturn readACPILog(UInt64 *cursor, void *buffer, UInt32 *length);
 
     // Device power management
 
@@ -100,17 +160,31 @@ private:
     void performACPIPowerOff(void);
     bool catalogACPITables(void);
     bool fetchPCIData(void);
+    void probeEmbeddedController(void);
+    void startEmbeddedController(void);
     void createCPUNubs(void); /* walk MADT and enumerate the CPU devices/objects available. */
     void systemStateChange(void);
+    IOReturn registerAddressSpace(IOACPIAddressSpaceID spaceID, IOACPIAddressSpaceHandler handler,
+                                  PDACPIAddressSpaceBufferHandler bufferHandler, void *context);
+    void unregisterAddressSpace(IOACPIAddressSpaceID spaceID, IOACPIAddressSpaceHandler handler,
+                                PDACPIAddressSpaceBufferHandler bufferHandler);
+    void removeAcpiAddressSpaces(void);
+    void publishAddressSpaceHandler(IOACPIAddressSpaceID spaceID, PDACPIAddressSpaceHandler *record);
+    UInt32 enterAddressSpace(IOACPIAddressSpaceID spaceID);
+    void leaveAddressSpace(IOACPIAddressSpaceID spaceID, UInt32 epoch);
     
 private:
-    OSDictionary *m_tableDict;
+    OSDictionary *m_tableDict;                  /* immutable "ACPI Tables" view, built once */
+    struct AcpiTableIndexEntry *m_tableIndex;   /* (signature, instance) -> table */
+    UInt32 m_tableIndexSize;
     
-    /* PIO == ACPIPE, MMIO == ACPIPE, PCI CFG == ACPIPE, we have handlers for all of these. */
-    IOACPIAddressSpaceHandler m_ecSpaceHandler;
-    void *m_ecSpaceContext;
-    IOACPIAddressSpaceHandler m_smbusSpaceHandler;
-    void *m_smbusSpaceContext;
+    /* PIO == ACPIPE, MMIO == ACPIPE, PCI CFG == ACPIPE, everything else is registered per space ID. */
+    PDACPIAddressSpaceHandler *volatile m_spaceHandler[kPDACPIAddressSpaceCount];
+    volatile SInt32 m_spaceActive[kPDACPIAddressSpaceCount][2]; /* dispatches inside the handler, per epoch */
+    volatile SInt32 m_spaceEpoch[kPDACPIAddressSpaceCount];     /* low bit picks the counter new dispatches use */
+    PDACPIAddressSpaceAcpiContext *m_spaceContext[kPDACPIAddressSpaceCount];  /* ACPICA handler installed with it */
+    IOLock *m_spaceLock;                                         /* serializes (un)registration */
+    PDACPIEmbeddedController *m_embeddedController;
     IORTC *m_localRTC;
     IOPlatformExpertDevice *m_provider;
 };
@@ -0,0 +1,142 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#include "PDACPITableIndex.h"
+#include <IOKit/IOLib.h>
+#include <libkern/c++/OSData.h>
+
+static UInt32 AcpiTableIndexHash(UInt32 signature, UInt32 instance)
+{
+    UInt32 h = signature ^ (instance * 0x01000193);
+    h ^= h >> 16;
+    h *= 0x7FEB352D;
+    h ^= h >> 15;
+    h *= 0x846CA68B;
+    h ^= h >> 16;
+    return h;
+}
+
+static AcpiTableIndexEntry *AcpiTableIndexSlot(AcpiTableIndexEntry *index, UInt32 size, UInt32 signature, UInt32 instance)
+{
+    UInt32 mask = size - 1;
+    
+    for (UInt32 i = AcpiTableIndexHash(signature, instance) & mask;; i = (i + 1) & mask) {
+        if (!index[i].Signature || (index[i].Signature == signature && index[i].Instance == instance)) {
+            return &index[i];
+        }
+    }
+}
+
+static UInt32 AcpiTableSignature(const char *name)
+{
+    char sig[4] = { 0 };
+    UInt32 signature;
+    
+    memcpy(sig, name, strnlen(name, sizeof(sig)));
+    memcpy(&signature, sig, sizeof(signature));
+    return signature;
+}
+
+AcpiTableIndexEntry *AcpiTableIndexBuild(ACPI_TABLE_HEADER **tables, UInt32 count, UInt32 *size)
+{
+    UInt32 slots = 16;
+    while (slots < count * 2) {
+        slots <<= 1;
+    }
+    
+    AcpiTableIndexEntry *index = (AcpiTableIndexEntry *)IOMalloc(slots * sizeof(AcpiTableIndexEntry));
+    if (!index) {
+        return NULL;
+    }
+    bzero(index, slots * sizeof(AcpiTableIndexEntry));
+    
+    for (UInt32 i = 0; i < count; i++) {
+        ACPI_TABLE_HEADER *table = tables[i];
+        UInt32 signature;
+        
+        if (!table) {
+            continue;
+        }
+        memcpy(&signature, table->Signature, sizeof(signature));
+        if (!signature) {
+            continue;
+        }
+        
+        AcpiTableIndexEntry *first = AcpiTableIndexSlot(index, slots, signature, 0);
+        AcpiTableIndexEntry *slot = first;
+        if (first->Signature) {
+            slot = AcpiTableIndexSlot(index, slots, signature, first->Count);
+            slot->Instance = first->Count;
+        }
+        first->Count++;
+        
+        slot->Signature = signature;
+        slot->Data = OSData::withBytesNoCopy(table, table->Length);
+    }
+    
+    *size = slots;
+    return index;
+}
+
+OSData *AcpiTableIndexLookup(AcpiTableIndexEntry *index, UInt32 size, const char *name, UInt32 instance)
+{
+    if (!index || !name) {
+        return NULL;
+    }
+    
+    UInt32 signature = AcpiTableSignature(name);
+    if (!signature) {
+        return NULL;
+    }
+    
+    return AcpiTableIndexSlot(index, size, signature, instance)->Data;
+}
+
+void AcpiTableIndexName(const AcpiTableIndexEntry *entry, char *name, size_t length)
+{
+    if (entry->Instance > 0) {
+        snprintf(name, length, "%4.4s-%u", (const char *)&entry->Signature, entry->Instance);
+    } else {
+        snprintf(name, length, "%4.4s", (const char *)&entry->Signature);
+    }
+}
+
+void AcpiTableIndexFree(AcpiTableIndexEntry *index, UInt32 size)
+{
+    for (UInt32 i = 0; i < size; i++) {
+        OSSafeReleaseNULL(index[i].Data);
+    }
+    IOFree(index, size * sizeof(AcpiTableIndexEntry));
+}
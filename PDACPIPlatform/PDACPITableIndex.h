@@ -0,0 +1,72 @@
+/*
+*
+* Copyright (c) 2007-Present The PureDarwin Project.
+* All rights reserved.
+*
+* @PUREDARWIN_LICENSE_HEADER_START@
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+* IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+* THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+* PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @PUREDARWIN_LICENSE_HEADER_END@
+*
+* PDACPIPlatform Open Source Version of Apples AppleACPIPlatform
+* Created by github.com/csekel (InSaneDarwin)
+*
+*/
+
+#ifndef _PDACPI_TABLE_INDEX_H
+#define _PDACPI_TABLE_INDEX_H
+
+#include <libkern/OSTypes.h>
+
+extern "C" {
+#include "acpica/acpi.h"
+}
+
+class OSData;
+
+/*
+ * ACPI table index.
+ *
+ * An open-addressed hash of (signature, instance) to the OSData wrapping the
+ * table, built in one pass over the root table list. Each signature's
+ * instance 0 slot counts the tables seen with that signature, so numbering
+ * the next one is a single probe. Lookups hash the four signature bytes and
+ * never format a name; names are only built once, for the "ACPI Tables"
+ * dictionary IOPCIFamily asks for.
+ */
+struct AcpiTableIndexEntry {
+    UInt32 Signature;   /* 0 marks an empty slot */
+    UInt32 Instance;
+    UInt32 Count;       /* instance 0 only: tables seen with this signature */
+    OSData *Data;
+};
+
+/* Number the tables by signature and wrap each in an OSData. Size comes back as the slot count. */
+AcpiTableIndexEntry *AcpiTableIndexBuild(ACPI_TABLE_HEADER **tables, UInt32 count, UInt32 *size);
+/* The table with this signature and instance, or NULL */
+OSData *AcpiTableIndexLookup(AcpiTableIndexEntry *index, UInt32 size, const char *name, UInt32 instance);
+/* An entry's name in the "ACPI Tables" dictionary: "SSDT" for instance 0, then "SSDT-1" on */
+void AcpiTableIndexName(const AcpiTableIndexEntry *entry, char *name, size_t length);
+void AcpiTableIndexFree(AcpiTableIndexEntry *index, UInt32 size);
+
+#endif /* _PDACPI_TABLE_INDEX_H */
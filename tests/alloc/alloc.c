@@ -0,0 +1,269 @@
+/*
+ * osdarwin.c's AcpiOsAllocate: threads on their own CPUs allocate and free
+ * a mix of sizes, handing some blocks to each other to free, and every
+ * block keeps its contents while it is live. Afterwards every object is
+ * back in its slab, and once the size classes are torn down every slab and
+ * page block has gone back to IOMalloc. Also the scratch arena, and the
+ * time per allocate and free against the tag-per-allocation path it
+ * replaced. The test includes osdarwin.c to see its caches.
+ */
+
+#include "osdarwin.c"
+
+/* acdarwin.h defines the stdio streams away for the kernel */
+#undef stderr
+#undef stdout
+#undef EOF
+#include "test.h"
+#include <pthread.h>
+#include <time.h>
+
+#define kThreads        4
+#define kOperations     1000000
+#define kHeldMax        400
+#define kBursts         2000000
+
+struct Block {
+    UINT8 *p;
+    ACPI_SIZE size;
+};
+
+static struct Block * volatile gHandoff;
+
+/* Mostly names and small objects, some buffers, the odd large one */
+static ACPI_SIZE PickSize(unsigned *seed)
+{
+    unsigned r = rand_r(seed) % 100;
+
+    if (r < 60) {
+        return 1 + rand_r(seed) % 40;
+    }
+    if (r < 90) {
+        return 40 + rand_r(seed) % 300;
+    }
+    if (r < 99) {
+        return 300 + rand_r(seed) % 1800;
+    }
+    return 2000 + rand_r(seed) % 9000;
+}
+
+/* What a live block is filled with; overlapping blocks would overwrite each other's */
+static UINT8 Fill(const struct Block *b)
+{
+    return (UINT8)((((uintptr_t)b->p >> 3) ^ b->size) | 1);
+}
+
+static void CheckBlock(const struct Block *b)
+{
+    UINT8 fill = Fill(b);
+
+    for (ACPI_SIZE i = 0; i < b->size; i++) {
+        CHECK(b->p[i] == fill, "%zu byte block at %p changed at %zu", (size_t)b->size, b->p, (size_t)i);
+    }
+}
+
+static void Release(struct Block *b)
+{
+    CheckBlock(b);
+    AcpiOsFree(b->p);
+}
+
+static void *Churn(void *arg)
+{
+    struct Block held[kHeldMax], *mine;
+    unsigned seed = (unsigned)(intptr_t)arg + 7;
+    int n = 0;
+
+    xnu_set_cpu_number((int)(intptr_t)arg);
+    for (int i = 0; i < kOperations; i++) {
+        if (n < kHeldMax && (rand_r(&seed) % 2 || !n)) {
+            struct Block *b = &held[n++];
+
+            b->size = PickSize(&seed);
+            b->p = AcpiOsAllocate(b->size);
+            CHECK(b->p, "can't allocate %zu bytes", (size_t)b->size);
+            CHECK(!((uintptr_t)b->p & 7), "%zu bytes at %p are misaligned", (size_t)b->size, b->p);
+            memset(b->p, Fill(b), b->size);
+        } else {
+            int k = rand_r(&seed) % n;
+
+            /* Now and then another CPU frees it */
+            if (rand_r(&seed) % 16 == 0) {
+                mine = malloc(sizeof(*mine));
+                *mine = held[k];
+                mine = __atomic_exchange_n(&gHandoff, mine, __ATOMIC_ACQ_REL);
+            } else {
+                mine = NULL;
+                Release(&held[k]);
+            }
+            if (mine) {
+                Release(mine);
+                free(mine);
+            }
+            held[k] = held[--n];
+        }
+    }
+    while (n) {
+        Release(&held[--n]);
+    }
+    return NULL;
+}
+
+/* The path AcpiOsAllocate took for everything before the size classes */
+static void *TagAllocate(ACPI_SIZE Size)
+{
+    struct _memory_tag *mem = IOMalloc(Size + sizeof(struct _memory_tag));
+
+    mem->magic = ACPI_MEMORY_TAG_MAGIC;
+    mem->size = Size + sizeof(struct _memory_tag);
+    return mem + 1;
+}
+
+static void TagFree(void *p)
+{
+    struct _memory_tag *mem = (struct _memory_tag *)p - 1;
+
+    IOFree(mem, mem->size);
+}
+
+/* Interpreter-like bursts of short-lived names, strings and buffers, freed in reverse */
+static const ACPI_SIZE kBurst[16] = { 5, 8, 16, 24, 40, 72, 9, 13, 32, 64, 120, 200, 16, 48, 24, 8 };
+
+struct Bench {
+    int cpu;
+    void *(*allocate)(ACPI_SIZE);
+    void (*free)(void *);
+};
+
+static void *Burst(void *arg)
+{
+    struct Bench *bench = arg;
+    void *p[16];
+
+    xnu_set_cpu_number(bench->cpu);
+    for (int i = 0; i < kBursts; i++) {
+        for (int k = 0; k < 16; k++) {
+            p[k] = bench->allocate(kBurst[(k + i) & 15]);
+        }
+        for (int k = 15; k >= 0; k--) {
+            bench->free(p[k]);
+        }
+    }
+    return NULL;
+}
+
+static double Time(void *(*allocate)(ACPI_SIZE), void (*free)(void *), int threads)
+{
+    struct Bench bench[kThreads];
+    pthread_t thread[kThreads];
+    UInt64 start = mach_absolute_time();
+
+    for (int i = 0; i < threads; i++) {
+        bench[i] = (struct Bench){ i, allocate, free };
+        pthread_create(&thread[i], NULL, Burst, &bench[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    return (double)(mach_absolute_time() - start) / ((double)threads * kBursts * 16);
+}
+
+int main(void)
+{
+    pthread_t thread[kThreads];
+    int baseline = xnu_allocations_live;
+    void *early, *arena;
+    UINT32 slabs = 0;
+
+    /* Before the size classes exist everything takes the page path */
+    early = AcpiOsAllocate(24);
+    CHECK(early && ((uintptr_t)early & PAGE_MASK) == sizeof(struct _memory_tag), "early allocation at %p", early);
+    AcpiOsInitializeAllocator();
+    CHECK(gAcpiOsSizeClassesReady, "no size classes");
+    AcpiOsFree(early);
+
+    for (ACPI_SIZE size = 1; size <= ACPI_OS_SIZE_CLASS_MAX; size++) {
+        UINT8 class = gAcpiOsSizeClassIndex[(size + (1 << ACPI_OS_SIZE_CLASS_SHIFT) - 1) >> ACPI_OS_SIZE_CLASS_SHIFT];
+
+        CHECK(gAcpiOsSizeClassSize[class] >= size && (!class || gAcpiOsSizeClassSize[class - 1] < size),
+              "%zu bytes come from the %u byte class", (size_t)size, gAcpiOsSizeClassSize[class]);
+    }
+
+    for (int i = 0; i < kThreads; i++) {
+        pthread_create(&thread[i], NULL, Churn, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < kThreads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    if (gHandoff) {
+        Release(gHandoff);
+        free(gHandoff);
+    }
+
+    CHECK(gAcpiOsLargeAllocations == gAcpiOsLargeFrees, "%lld large allocations, %lld frees",
+          (long long)gAcpiOsLargeAllocations, (long long)gAcpiOsLargeFrees);
+
+    /* Empty every magazine from its own CPU; then every object is in the depot */
+    for (UINT32 i = 0; i < ACPI_OS_SIZE_CLASSES; i++) {
+        struct _acpi_cache *cache = &gAcpiOsSizeClass[i];
+        struct _acpi_cache_slab *slab;
+        UINT64 requests = 0, releases = 0;
+        UINT32 objects = 0;
+
+        for (UINT32 cpu = 0; cpu < cache->ncpus; cpu++) {
+            requests += cache->cpus[cpu].requests;
+            releases += cache->cpus[cpu].releases;
+            xnu_set_cpu_number(cpu);
+            AcpiOsCacheFreeSlabs(cache, AcpiOsCacheFlush(cache, &cache->cpus[cpu], cache->cpus[cpu].rounds));
+        }
+        CHECK(requests == releases, "%s: %llu allocations, %llu frees", cache->name,
+              (unsigned long long)requests, (unsigned long long)releases);
+        CHECK(cache->slab_size == PAGE_SIZE, "%s has %zu byte slabs", cache->name, (size_t)cache->slab_size);
+
+        for (slab = cache->slabs; slab; slab = slab->next) {
+            CHECK(slab->free == cache->slab_objects, "%s slab %p has %u of %u objects free", cache->name,
+                  slab, slab->free, cache->slab_objects);
+            objects += cache->slab_objects;
+            slabs++;
+        }
+        CHECK(objects == cache->total && cache->current_depth == cache->total, "%s: %u objects in slabs, %u counted, %u in the depot",
+              cache->name, objects, cache->total, cache->current_depth);
+    }
+
+    /* The statistics go to IOLog */
+    setenv("XNU_VERBOSE", "1", 1);
+    AcpiOsPrintAllocatorStatistics();
+    unsetenv("XNU_VERBOSE");
+
+    /* A scratch arena hands out aligned memory and gives it all back at once */
+    CHECK(AcpiOsCreateScratch(&arena) == AE_OK, "no scratch arena");
+    for (int i = 0; i < 10000; i++) {
+        UINT8 *p = AcpiOsAllocateScratch(arena, 1 + i % 100);
+
+        CHECK(p && !((uintptr_t)p & 7), "scratch allocation %d at %p", i, p);
+        memset(p, i, 1 + i % 100);
+    }
+    CHECK(AcpiOsAllocateScratch(arena, 100000), "no large scratch allocation");
+    AcpiOsReleaseScratch(arena);
+
+    for (UINT32 i = 0; i < ACPI_OS_SIZE_CLASSES; i++) {
+        AcpiOsCacheTeardown(&gAcpiOsSizeClass[i]);
+    }
+    CHECK(xnu_allocations_live == baseline, "%d blocks still allocated", xnu_allocations_live - baseline);
+    printf("alloc: %d threads, %d operations each, %u slabs kept at the end, all returned\n",
+           kThreads, kOperations, slabs);
+
+    /* The old path is the baseline; IOMalloc is glibc malloc here */
+    gAcpiOsSizeClassesReady = FALSE;
+    AcpiOsInitializeAllocator();
+    for (int threads = 1; threads <= kThreads; threads *= kThreads) {
+        double before = Time(TagAllocate, TagFree, threads);
+        double after = Time(AcpiOsAllocate, AcpiOsFree, threads);
+
+        printf("alloc: %d thread(s): %.1f ns per allocate and free with a tag, %.1f ns from the size classes\n",
+               threads, before, after);
+    }
+
+    printf("alloc: ok\n");
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * What osunixxf.c wants from the debugger, which the tests leave out.
+ */
+
+#include "acpi.h"
+
+ACPI_STATUS
+AcpiOsInitializeDebugger (
+    void)
+{
+    return (AE_OK);
+}
+
+void
+AcpiOsTerminateDebugger (
+    void)
+{
+}
+
+ACPI_STATUS
+AcpiOsWaitCommandReady (
+    void)
+{
+    return (AE_OK);
+}
+
+ACPI_STATUS
+AcpiOsNotifyCommandComplete (
+    void)
+{
+    return (AE_OK);
+}
@@ -0,0 +1,183 @@
+#
+# Just enough of an AML encoder to write test tables without iasl.
+# Every helper returns the encoded bytes; table() wraps a body in a header.
+#
+
+import struct
+
+
+def pkglen(body):
+    n = len(body)
+    for extra in range(4):
+        total = n + 1 + extra
+        if extra == 0 and total < 64:
+            return bytes([total]) + body
+        if extra > 0 and total < (1 << (4 + 8 * extra)):
+            b = [(extra << 6) | (total & 0xF)]
+            t = total >> 4
+            for i in range(extra):
+                b.append(t & 0xFF)
+                t >>= 8
+            return bytes(b) + body
+    raise ValueError('package too long')
+
+
+def nseg(s):
+    return s.ljust(4, '_').encode()
+
+
+def path(p):
+    """"\\_SB.PCI0", "^FOO" or "ORD" to a NameString"""
+    out = b''
+    if p.startswith('\\'):
+        out, p = b'\\', p[1:]
+    while p.startswith('^'):
+        out, p = out + b'^', p[1:]
+    segs = p.split('.') if p else []
+    if not segs:
+        return out + b'\x00'
+    if len(segs) == 1:
+        return out + nseg(segs[0])
+    if len(segs) == 2:
+        return out + b'\x2e' + nseg(segs[0]) + nseg(segs[1])
+    return out + b'\x2f' + bytes([len(segs)]) + b''.join(nseg(s) for s in segs)
+
+
+def integer(v):
+    if v == 0:
+        return b'\x00'
+    if v == 1:
+        return b'\x01'
+    if v == 0xFFFFFFFFFFFFFFFF:
+        return b'\xff'
+    if v < 1 << 8:
+        return b'\x0a' + bytes([v])
+    if v < 1 << 16:
+        return b'\x0b' + struct.pack('<H', v)
+    if v < 1 << 32:
+        return b'\x0c' + struct.pack('<I', v)
+    return b'\x0e' + struct.pack('<Q', v)
+
+
+def string(s):
+    return b'\x0d' + s.encode() + b'\x00'
+
+
+def buffer(bs, size=None):
+    return b'\x11' + pkglen(integer(len(bs) if size is None else size) + bytes(bs))
+
+
+def package(elems):
+    return b'\x12' + pkglen(bytes([len(elems)]) + b''.join(elems))
+
+
+def eisaid(s):
+    """EISAID("PNP0C09") as the integer iasl makes of it"""
+    v = ((ord(s[0]) - 0x40) << 26) | ((ord(s[1]) - 0x40) << 21) | ((ord(s[2]) - 0x40) << 16) | int(s[3:], 16)
+    return integer(struct.unpack('>I', struct.pack('<I', v))[0])
+
+
+def name(n, val):
+    return b'\x08' + path(n) + val
+
+
+def scope(n, body):
+    return b'\x10' + pkglen(path(n) + body)
+
+
+def device(n, body):
+    return b'\x5b\x82' + pkglen(path(n) + body)
+
+
+def processor(n, pid, body, pblk=0, pblklen=0):
+    return b'\x5b\x83' + pkglen(path(n) + bytes([pid]) + struct.pack('<I', pblk) + bytes([pblklen]) + body)
+
+
+def method(n, args, body, serialized=False):
+    return b'\x14' + pkglen(path(n) + bytes([args | (8 if serialized else 0)]) + body)
+
+
+def mutex(n, level=0):
+    return b'\x5b\x01' + path(n) + bytes([level])
+
+
+def opregion(n, space, offset, length):
+    return b'\x5b\x80' + path(n) + bytes([space]) + integer(offset) + integer(length)
+
+
+def field(region, flags, units):
+    """units: (name, bits) pairs; a name of None is Offset()-style padding"""
+    body = path(region) + bytes([flags])
+    for n, bits in units:
+        body += (b'\x00' if n is None else nseg(n)) + _bitlen(bits)
+    return b'\x5b\x81' + pkglen(body)
+
+
+def _bitlen(bits):
+    """A field unit's length: PkgLength's encoding, without counting itself"""
+    if bits < 64:
+        return bytes([bits])
+    for extra in range(1, 4):
+        if bits < (1 << (4 + 8 * extra)):
+            b = [(extra << 6) | (bits & 0xF)]
+            t = bits >> 4
+            for i in range(extra):
+                b.append(t & 0xFF)
+                t >>= 8
+            return bytes(b)
+    raise ValueError('field too long')
+
+
+# Operand and statement opcodes
+def local(n): return bytes([0x60 + n])
+def arg(n): return bytes([0x68 + n])
+def ret(v): return b'\xa4' + v
+def store(src, dst): return b'\x70' + src + dst
+def add(a, b, dst=b'\x00'): return b'\x72' + a + b + dst
+def subtract(a, b, dst=b'\x00'): return b'\x74' + a + b + dst
+def multiply(a, b, dst=b'\x00'): return b'\x77' + a + b + dst
+def shiftleft(a, b, dst=b'\x00'): return b'\x79' + a + b + dst
+def and_(a, b, dst=b'\x00'): return b'\x7b' + a + b + dst
+def or_(a, b, dst=b'\x00'): return b'\x7d' + a + b + dst
+def mod(a, b, dst=b'\x00'): return b'\x85' + a + b + dst
+def tointeger(v, dst=b'\x00'): return b'\x99' + v + dst
+def land(a, b): return b'\x90' + a + b
+def lequal(a, b): return b'\x93' + a + b
+def lgreater(a, b): return b'\x94' + a + b
+def lless(a, b): return b'\x95' + a + b
+def lnot(a): return b'\x92' + a
+def increment(t): return b'\x75' + t
+def decrement(t): return b'\x76' + t
+def sizeof(t): return b'\x87' + t
+def index(src, i, dst=b'\x00'): return b'\x88' + src + i + dst
+def derefof(t): return b'\x83' + t
+def refof(t): return b'\x71' + t
+def notify(t, v): return b'\x86' + t + v
+def sleep(ms): return b'\x5b\x22' + integer(ms)
+def stall(us): return b'\x5b\x21' + integer(us)
+def acquire(m, timeout=0xFFFF): return b'\x5b\x23' + m + struct.pack('<H', timeout)
+def release(m): return b'\x5b\x27' + m
+def createdwordfield(src, i, n): return b'\x8a' + src + i + path(n)
+def toUUID(s):
+    """ToUUID("...") as iasl emits it: a 16 byte buffer"""
+    h = s.replace('-', '')
+    b = bytes.fromhex(h)
+    return buffer(b[3::-1] + b[5:3:-1] + b[7:5:-1] + b[8:])
+def if_(cond, body): return b'\xa0' + pkglen(cond + body)
+def else_(body): return b'\xa1' + pkglen(body)
+def while_(cond, body): return b'\xa2' + pkglen(cond + body)
+def break_(): return b'\xa5'
+def call(n, *args): return path(n) + b''.join(args)
+
+
+def table(sig, body, oem_table='TESTTBL', revision=2):
+    hdr = bytearray(sig.encode() + struct.pack('<I', 36 + len(body)) + bytes([revision, 0]) +
+                    b'TEST  ' + oem_table.ljust(8).encode() + struct.pack('<I', 1) + b'INTL' + struct.pack('<I', 1))
+    t = hdr + body
+    t[9] = (-sum(t)) & 0xFF
+    return bytes(t)
+
+
+def gas(space, width, offset, access, address):
+    """ResourceTemplate() { Register(...) } as a buffer body"""
+    return bytes([0x82, 0x0c, 0x00, space, width, offset, access]) + struct.pack('<Q', address) + bytes([0x79, 0])
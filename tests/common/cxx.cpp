@@ -0,0 +1,17 @@
+/*
+ * AcpiOsLayer.cpp includes acpi.h outside extern "C", so its calls into
+ * ACPICA's OS layer come out with C++ linkage; forward them to osunixxf.
+ */
+
+#include <stdarg.h>
+
+extern "C" void AcpiOsVprintf(const char *Format, va_list Args);
+
+void AcpiOsPrintf(const char *Format, ...)
+{
+    va_list args;
+
+    va_start(args, Format);
+    AcpiOsVprintf(Format, args);
+    va_end(args);
+}
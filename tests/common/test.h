@@ -0,0 +1,71 @@
+/*
+ * Shared helpers for the host tests: checks that stop the test with a
+ * message, and bringing ACPICA up on one AML table.
+ */
+
+#ifndef _TESTS_TEST_H_
+#define _TESTS_TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(cond, ...) do {                                                   \
+    if (!(cond)) {                                                              \
+        fprintf(stderr, "%s:%d: check failed: %s\n    ", __FILE__, __LINE__, #cond); \
+        fprintf(stderr, __VA_ARGS__);                                           \
+        fputc('\n', stderr);                                                    \
+        exit(1);                                                                \
+    }                                                                           \
+} while (0)
+
+#define CHECK_STATUS(expr) do {                                                 \
+    ACPI_STATUS checkStatus_ = (expr);                                          \
+    CHECK(ACPI_SUCCESS(checkStatus_), "%s", AcpiFormatException(checkStatus_)); \
+} while (0)
+
+#ifdef ACPI_APPLICATION
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "acpi.h"
+#include "accommon.h"
+#include "actables.h"
+#ifdef __cplusplus
+}
+#endif
+
+/* Bring ACPICA up with path as the DSDT; init adds _INI and the rest of AcpiInitializeObjects */
+static inline void
+TestLoadTable(const char *path, int init)
+{
+    static UINT8 *table;
+    FILE *f = fopen(path, "rb");
+    UINT32 index;
+    long size;
+
+    CHECK(f, "can't open %s", path);
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    rewind(f);
+    table = (UINT8 *)malloc(size);
+    CHECK(fread(table, 1, size, f) == (size_t)size, "short read on %s", path);
+    fclose(f);
+
+    AcpiDbgLevel = 0;
+    CHECK_STATUS(AcpiInitializeSubsystem());
+    CHECK_STATUS(AcpiAllocateRootTable(16));   /* no RSDP on a host */
+    CHECK_STATUS(AcpiLoadTable((ACPI_TABLE_HEADER *)table, &index));
+    AcpiGbl_DSDT = (ACPI_TABLE_HEADER *)table;
+    memcpy(&AcpiGbl_OriginalDsdtHeader, table, sizeof(ACPI_TABLE_HEADER));
+    AcpiUtSetIntegerWidth(AcpiGbl_DSDT->Revision);  /* done with the FADT otherwise */
+    if (init) {
+        CHECK_STATUS(AcpiEnableSubsystem(ACPI_NO_HARDWARE_INIT | ACPI_NO_ACPI_ENABLE | ACPI_NO_EVENT_INIT | ACPI_NO_HANDLER_INIT));
+        CHECK_STATUS(AcpiInitializeObjects(ACPI_FULL_INITIALIZATION));
+    }
+}
+
+#endif
+
+#endif /* _TESTS_TEST_H_ */
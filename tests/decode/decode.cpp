@@ -0,0 +1,311 @@
+/*
+ * The pre-decoded method engine on a PCI host bridge _OSC and a _DSM as
+ * firmware writes them: both decode, and return what the interpreter
+ * returns and leave the same names behind, for matching and mismatching
+ * UUIDs, revisions, capabilities buffers and function indexes. A name a
+ * later table adds is found, an error after a store is reported rather
+ * than the method run again, and the time an evaluation takes with and
+ * without the decoded form.
+ */
+
+#include "test.h"
+#include <time.h>
+
+extern "C" {
+#include "acnamesp.h"
+}
+
+#define kIterations 20000
+
+static const char *kPciHostUuid = "33DB4D5B-1FF7-401C-9657-7441C03DD766";
+static const char *kDsmUuid = "E5C937D0-3553-4D7A-9117-EA4D19C3434D";
+static const char *kNames[] = { "\\_SB.PCI0.SUPP", "\\_SB.PCI0.CTRL", "\\DSMC", "\\ERRC" };
+
+#define kNameCount  (sizeof(kNames) / sizeof(kNames[0]))
+
+static int gCases;
+
+/* An evaluation: its status, what it returned, and the names afterwards */
+struct Result {
+    ACPI_STATUS status;
+    ACPI_OBJECT_TYPE type;
+    UINT64 value;
+    UINT8 bytes[16];
+    UINT32 length;
+    UINT64 names[kNameCount];
+};
+
+static ACPI_OPERAND_OBJECT *Integer(const char *path)
+{
+    ACPI_HANDLE handle;
+    ACPI_OPERAND_OBJECT *object;
+
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)path, &handle));
+    object = AcpiNsGetAttachedObject(AcpiNsValidateHandle(handle));
+    CHECK(object && object->Common.Type == ACPI_TYPE_INTEGER, "%s is not an Integer", path);
+    return object;
+}
+
+static ACPI_OPERAND_OBJECT *Method(const char *path)
+{
+    ACPI_HANDLE handle;
+
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)path, &handle));
+    return AcpiNsGetAttachedObject(AcpiNsValidateHandle(handle));
+}
+
+/* ToUUID's byte order: the first three fields little-endian */
+static void Uuid(const char *string, UINT8 *uuid)
+{
+    static const UINT8 offset[16] = { 6, 4, 2, 0, 11, 9, 16, 14, 19, 21, 24, 26, 28, 30, 32, 34 };
+
+    for (int i = 0; i < 16; i++) {
+        uuid[i] = (AcpiUtAsciiCharToHex(string[offset[i]]) << 4) | AcpiUtAsciiCharToHex(string[offset[i] + 1]);
+    }
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Evaluate path once from the same starting names, decoded or not; buffer arguments are copied first */
+static Result Evaluate(const char *path, ACPI_OBJECT *args, UINT32 count, BOOLEAN decoded)
+{
+    ACPI_BUFFER out = { ACPI_ALLOCATE_BUFFER, NULL };
+    ACPI_OBJECT_LIST list;
+    ACPI_OBJECT copy[4];
+    UINT8 data[4][16];
+    Result result;
+
+    memset(&result, 0, sizeof(result));
+    for (UINT32 i = 0; i < count; i++) {
+        copy[i] = args[i];
+        if (args[i].Type == ACPI_TYPE_BUFFER) {
+            memcpy(data[i], args[i].Buffer.Pointer, args[i].Buffer.Length);
+            copy[i].Buffer.Pointer = data[i];
+        }
+    }
+    for (UINT32 i = 0; i < kNameCount; i++) {
+        Integer(kNames[i])->Integer.Value = 0;
+    }
+    list.Count = count;
+    list.Pointer = copy;
+
+    AcpiGbl_EnableDecodedMethods = decoded;
+    result.status = AcpiEvaluateObject(NULL, (char *)path, &list, &out);
+    AcpiGbl_EnableDecodedMethods = TRUE;
+
+    if (ACPI_SUCCESS(result.status) && out.Pointer) {
+        ACPI_OBJECT *object = (ACPI_OBJECT *)out.Pointer;
+
+        result.type = object->Type;
+        if (object->Type == ACPI_TYPE_INTEGER) {
+            result.value = object->Integer.Value;
+        } else if (object->Type == ACPI_TYPE_BUFFER) {
+            CHECK(object->Buffer.Length <= sizeof(result.bytes), "%s returned %u bytes", path, object->Buffer.Length);
+            result.length = object->Buffer.Length;
+            memcpy(result.bytes, object->Buffer.Pointer, result.length);
+        }
+        ACPI_FREE(out.Pointer);
+    }
+    for (UINT32 i = 0; i < kNameCount; i++) {
+        result.names[i] = Integer(kNames[i])->Integer.Value;
+    }
+    return result;
+}
+
+/* The interpreter and the decoded form agree; returns the decoded result */
+static Result Compare(const char *what, const char *path, ACPI_OBJECT *args, UINT32 count)
+{
+    Result interpreted = Evaluate(path, args, count, FALSE);
+    Result decoded = Evaluate(path, args, count, TRUE);
+
+    gCases++;
+
+    CHECK(interpreted.status == decoded.status, "%s: %s interpreted, %s decoded", what,
+          AcpiFormatException(interpreted.status), AcpiFormatException(decoded.status));
+    CHECK(interpreted.type == decoded.type && interpreted.value == decoded.value &&
+          interpreted.length == decoded.length && !memcmp(interpreted.bytes, decoded.bytes, decoded.length),
+          "%s: returned type %u value %llx length %u interpreted, type %u value %llx length %u decoded", what,
+          interpreted.type, (unsigned long long)interpreted.value, interpreted.length,
+          decoded.type, (unsigned long long)decoded.value, decoded.length);
+    for (UINT32 i = 0; i < kNameCount; i++) {
+        CHECK(interpreted.names[i] == decoded.names[i], "%s: %s is %llx interpreted, %llx decoded", what, kNames[i],
+              (unsigned long long)interpreted.names[i], (unsigned long long)decoded.names[i]);
+    }
+    return decoded;
+}
+
+static void Decoded(const char *path)
+{
+    ACPI_OPERAND_OBJECT *method = Method(path);
+
+    CHECK(method->Method.Decoded && !(method->Method.InfoFlags & ACPI_METHOD_NOT_DECODABLE), "%s was not decoded", path);
+}
+
+/* ns per evaluation */
+static double Time(const char *path, ACPI_OBJECT *args, UINT32 count, BOOLEAN decoded)
+{
+    ACPI_BUFFER out;
+    ACPI_OBJECT_LIST list = { count, args };
+    double start;
+
+    AcpiGbl_EnableDecodedMethods = decoded;
+    start = Now();
+    for (int i = 0; i < kIterations; i++) {
+        out.Length = ACPI_ALLOCATE_BUFFER;
+        out.Pointer = NULL;
+        CHECK_STATUS(AcpiEvaluateObject(NULL, (char *)path, &list, &out));
+        ACPI_FREE(out.Pointer);
+    }
+    start = Now() - start;
+    AcpiGbl_EnableDecodedMethods = TRUE;
+    return start / kIterations;
+}
+
+static void SetInteger(ACPI_OBJECT *object, UINT64 value)
+{
+    object->Type = ACPI_TYPE_INTEGER;
+    object->Integer.Value = value;
+}
+
+static void SetBuffer(ACPI_OBJECT *object, UINT8 *data, UINT32 length)
+{
+    object->Type = ACPI_TYPE_BUFFER;
+    object->Buffer.Pointer = data;
+    object->Buffer.Length = length;
+}
+
+static UINT32 Dword(const Result &result, int i)
+{
+    return result.bytes[4 * i] | (result.bytes[4 * i + 1] << 8) | (result.bytes[4 * i + 2] << 16) |
+        ((UINT32)result.bytes[4 * i + 3] << 24);
+}
+
+int main()
+{
+    UINT8 pciHost[16], dsm[16], other[16], caps[12];
+    ACPI_OBJECT osc[4], args[4];
+    Result result;
+    double interpreted[2], decoded[2];
+    static UINT8 *ssdt;
+    UINT32 index;
+    FILE *f;
+    long size;
+
+    TestLoadTable("decode.aml", 1);
+    Uuid(kPciHostUuid, pciHost);
+    Uuid(kDsmUuid, dsm);
+    Uuid(kDsmUuid, other);
+    other[15] ^= 1;
+
+    /* _OSC: the OS asks for every control with support for ASPM, Clock PM and MSI */
+    memset(caps, 0, sizeof(caps));
+    caps[4] = 0x16;
+    caps[8] = 0x1F;
+    SetBuffer(&osc[0], pciHost, 16);
+    SetInteger(&osc[1], 1);
+    SetInteger(&osc[2], 3);
+    SetBuffer(&osc[3], caps, 12);
+    result = Compare("_OSC", "\\_SB.PCI0._OSC", osc, 4);
+    Decoded("\\_SB.PCI0._OSC");
+    CHECK(result.type == ACPI_TYPE_BUFFER && Dword(result, 0) == 0x10 && Dword(result, 2) == 0x1D,
+          "_OSC returned status %x control %x", Dword(result, 0), Dword(result, 2));
+    CHECK(result.names[0] == 0x16 && result.names[1] == 0x1D, "_OSC left SUPP %llx CTRL %llx",
+          (unsigned long long)result.names[0], (unsigned long long)result.names[1]);
+
+    /* Without MSI, no native hot plug either */
+    caps[4] = 0x06;
+    result = Compare("_OSC without MSI", "\\_SB.PCI0._OSC", osc, 4);
+    CHECK(Dword(result, 2) == 0x1C, "_OSC without MSI granted %x", Dword(result, 2));
+
+    /* An unknown revision, then an unknown UUID */
+    SetInteger(&osc[1], 2);
+    result = Compare("_OSC revision 2", "\\_SB.PCI0._OSC", osc, 4);
+    CHECK(Dword(result, 0) & 0x08, "_OSC accepted revision 2");
+    SetInteger(&osc[1], 1);
+    SetBuffer(&osc[0], other, 16);
+    result = Compare("_OSC with another UUID", "\\_SB.PCI0._OSC", osc, 4);
+    CHECK(Dword(result, 0) == 0x04 && !result.names[1], "_OSC accepted another UUID");
+
+    /* A capabilities buffer too short for CDW3 fails before anything is stored */
+    SetBuffer(&osc[0], pciHost, 16);
+    osc[3].Buffer.Length = 8;
+    result = Compare("_OSC with 8 bytes", "\\_SB.PCI0._OSC", osc, 4);
+    CHECK(result.status == AE_AML_BUFFER_LIMIT, "_OSC with 8 bytes: %s", AcpiFormatException(result.status));
+    osc[3].Buffer.Length = 12;
+
+    /* _DSM: functions 0, 1 and 5, one it doesn't have, and another UUID */
+    SetBuffer(&args[0], dsm, 16);
+    SetInteger(&args[1], 1);
+    args[3].Type = ACPI_TYPE_PACKAGE;
+    args[3].Package.Count = 0;
+    args[3].Package.Elements = NULL;
+    SetInteger(&args[2], 0);
+    result = Compare("_DSM 0", "\\_SB.PCI0.DEV0._DSM", args, 4);
+    Decoded("\\_SB.PCI0.DEV0._DSM");
+    CHECK(result.length == 1 && result.bytes[0] == 0x23, "_DSM 0 returned %u bytes, %x", result.length, result.bytes[0]);
+    SetInteger(&args[2], 1);
+    result = Compare("_DSM 1", "\\_SB.PCI0.DEV0._DSM", args, 4);
+    CHECK(result.type == ACPI_TYPE_INTEGER && result.value == 0x20, "_DSM 1 returned %llx", (unsigned long long)result.value);
+    SetInteger(&args[2], 5);
+    result = Compare("_DSM 5", "\\_SB.PCI0.DEV0._DSM", args, 4);
+    CHECK(result.bytes[0] == 1 && result.names[2] == 1, "_DSM 5 ran DSMC up to %llx", (unsigned long long)result.names[2]);
+    SetInteger(&args[2], 7);
+    result = Compare("_DSM 7", "\\_SB.PCI0.DEV0._DSM", args, 4);
+    CHECK(result.length == 1 && !result.bytes[0], "_DSM 7 returned %x", result.bytes[0]);
+    SetBuffer(&args[0], other, 16);
+    SetInteger(&args[2], 5);
+    result = Compare("_DSM with another UUID", "\\_SB.PCI0.DEV0._DSM", args, 4);
+    CHECK(!result.bytes[0] && !result.names[2], "_DSM ran function 5 for another UUID");
+
+    /* An Integer where the UUID goes: the interpreter's error, from the interpreter */
+    SetInteger(&args[0], 0);
+    Compare("_DSM with an Integer UUID", "\\_SB.PCI0.DEV0._DSM", args, 4);
+    SetBuffer(&args[0], dsm, 16);
+
+    /* A store and then a divide by zero: the store is done once, and the error returned */
+    SetInteger(&args[0], 3);
+    result = Compare("ERRM 3", "\\ERRM", args, 1);
+    CHECK(result.value == 1 && result.names[3] == 1, "ERRM 3 returned %llx", (unsigned long long)result.value);
+    SetInteger(&args[0], 0);
+    result = Compare("ERRM 0", "\\ERRM", args, 1);
+    Decoded("\\ERRM");
+    CHECK(result.status == AE_AML_DIVIDE_BY_ZERO && result.names[3] == 1, "ERRM 0: %s, ERRC %llx",
+          AcpiFormatException(result.status), (unsigned long long)result.names[3]);
+
+    SetBuffer(&args[0], dsm, 16);
+    SetInteger(&args[2], 1);
+    caps[4] = 0x16;
+    interpreted[0] = Time("\\_SB.PCI0._OSC", osc, 4, FALSE);
+    decoded[0] = Time("\\_SB.PCI0._OSC", osc, 4, TRUE);
+    interpreted[1] = Time("\\_SB.PCI0.DEV0._DSM", args, 4, FALSE);
+    decoded[1] = Time("\\_SB.PCI0.DEV0._DSM", args, 4, TRUE);
+    CHECK(decoded[0] < interpreted[0] && decoded[1] < interpreted[1], "decoded _OSC %.0f ns, _DSM %.0f ns, "
+          "interpreted %.0f ns, %.0f ns", decoded[0], decoded[1], interpreted[0], interpreted[1]);
+
+    /* A HIDD in DEV0 itself now comes first in the _DSM's search */
+    f = fopen("decode-ssdt.aml", "rb");
+    CHECK(f, "can't open decode-ssdt.aml");
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    rewind(f);
+    ssdt = (UINT8 *)malloc(size);
+    CHECK(fread(ssdt, 1, size, f) == (size_t)size, "short read on decode-ssdt.aml");
+    fclose(f);
+    CHECK_STATUS(AcpiLoadTable((ACPI_TABLE_HEADER *)ssdt, &index));
+    result = Compare("_DSM 1 after the SSDT", "\\_SB.PCI0.DEV0._DSM", args, 4);
+    CHECK(result.value == 0x30, "_DSM 1 returned %llx after the SSDT", (unsigned long long)result.value);
+
+    printf("decode: %d evaluations of _OSC, _DSM and ERRM returned and stored what the interpreter does\n", gCases);
+    printf("decode: _OSC %.0f ns interpreted, %.0f ns decoded; _DSM %.0f ns interpreted, %.0f ns decoded\n",
+           interpreted[0], decoded[0], interpreted[1], decoded[1]);
+
+    CHECK_STATUS(AcpiTerminate());
+    printf("decode: ok\n");
+    return 0;
+}
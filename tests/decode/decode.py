@@ -0,0 +1,55 @@
+#
+# A PCI host bridge _OSC and a device _DSM as firmware writes them, for the
+# pre-decoded method engine: CreateDWordField over the capabilities buffer,
+# ToUUID compares, named Integers read and written, a Switch on the function
+# index (a method-local Name in a Serialized method) and Buffer returns.
+# ERRM stores to a name before it divides by its argument. The second table
+# adds a HIDD nearer to the _DSM than the one it found first.
+#
+
+import os
+import sys
+from aml import *
+
+PCI_HOST_UUID = '33DB4D5B-1FF7-401C-9657-7441C03DD766'
+DSM_UUID = 'E5C937D0-3553-4D7A-9117-EA4D19C3434D'
+
+osc = createdwordfield(arg(3), integer(0), 'CDW1')
+osc += if_(lequal(arg(0), toUUID(PCI_HOST_UUID)),
+           createdwordfield(arg(3), integer(4), 'CDW2') +
+           createdwordfield(arg(3), integer(8), 'CDW3') +
+           store(path('CDW2'), path('SUPP')) +
+           store(path('CDW3'), path('CTRL')) +
+           # No native hot plug without ASPM, Clock PM and MSI
+           if_(lnot(lequal(and_(path('SUPP'), integer(0x16)), integer(0x16))),
+               and_(path('CTRL'), integer(0x1E), path('CTRL'))) +
+           and_(path('CTRL'), integer(0x1D), path('CTRL')) +
+           if_(lnot(lequal(arg(1), integer(1))),
+               or_(path('CDW1'), integer(0x08), path('CDW1'))) +
+           if_(lnot(lequal(path('CDW3'), path('CTRL'))),
+               or_(path('CDW1'), integer(0x10), path('CDW1'))) +
+           store(path('CTRL'), path('CDW3')) +
+           ret(arg(3)))
+osc += else_(or_(path('CDW1'), integer(0x04), path('CDW1')) + ret(arg(3)))
+
+# Switch (ToInteger (Arg2)) { Case (0) ... Case (1) ... Case (5) ... }
+switch = store(tointeger(arg(2)), path('_T_0'))
+switch += if_(lequal(path('_T_0'), integer(0)), ret(buffer([0x23])))
+switch += else_(if_(lequal(path('_T_0'), integer(1)), ret(path('HIDD'))) +
+                else_(if_(lequal(path('_T_0'), integer(5)),
+                          add(path('DSMC'), integer(1), path('DSMC')) + ret(buffer([0x01])))))
+switch += break_()
+dsm = name('_T_0', integer(0))
+dsm += if_(lequal(arg(0), toUUID(DSM_UUID)), while_(integer(1), switch))
+dsm += ret(buffer([0x00]))
+
+errm = add(path('ERRC'), integer(1), path('ERRC')) + mod(integer(10), arg(0), local(0)) + ret(local(0))
+
+root = name('HIDD', integer(0x20)) + name('DSMC', integer(0)) + name('ERRC', integer(0))
+root += method('ERRM', 1, errm)
+pci = name('SUPP', integer(0)) + name('CTRL', integer(0)) + method('_OSC', 4, osc)
+pci += device('DEV0', name('_ADR', integer(0)) + method('_DSM', 4, dsm, serialized=True))
+
+open(sys.argv[1], 'wb').write(table('DSDT', root + scope('\\_SB', device('PCI0', pci))))
+open(os.path.join(os.path.dirname(sys.argv[1]), 'decode-ssdt.aml'), 'wb').write(
+    table('SSDT', scope('\\_SB.PCI0.DEV0', name('HIDD', integer(0x30))), oem_table='DECODE'))
@@ -0,0 +1,148 @@
+/*
+ * The parallel _STA/_INI walk against the serial one, on 2 to 8 threads:
+ * the same _INI methods run, each once, parents before their children and
+ * _DEP prerequisites (packages and methods) before their dependents, while
+ * the _INI methods create and delete method-local names. Also the time
+ * each walk takes.
+ */
+
+#include "test.h"
+#include <time.h>
+
+extern "C" {
+#include "acnamesp.h"
+}
+
+#define kSubtrees   16      /* devinit.py */
+#define kDevices    (kSubtrees * 3)
+#define kRuns       5
+
+/* DVnn, DVnn.CHnn and DVnn.CHnn.GCnn are gDevice[3 * nn] to [3 * nn + 2] */
+static struct {
+    char path[32];
+    UINT64 start;
+    UINT64 done;
+    UINT64 runs;
+    UINT64 expected;
+} gDevice[kDevices];
+
+static ACPI_OPERAND_OBJECT *Integer(const char *path)
+{
+    ACPI_HANDLE handle;
+    ACPI_OPERAND_OBJECT *object;
+
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)path, &handle));
+    object = AcpiNsGetAttachedObject(AcpiNsValidateHandle(handle));
+    CHECK(object && object->Common.Type == ACPI_TYPE_INTEGER, "%s is not an Integer", path);
+    return object;
+}
+
+static UINT64 &Value(const char *device, const char *name)
+{
+    char path[40];
+
+    snprintf(path, sizeof(path), "%s.%s", device, name);
+    return Integer(path)->Integer.Value;
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* One device walk; returns its time in ms, and the most _INI methods seen running at once */
+static double Run(UINT32 threads, UINT64 *concurrent)
+{
+    double start;
+
+    for (int d = 0; d < kDevices; d++) {
+        Value(gDevice[d].path, "STRT") = Value(gDevice[d].path, "DONE") = Value(gDevice[d].path, "RUNS") = 0;
+    }
+    Integer("\\SEQ")->Integer.Value = Integer("\\CUR")->Integer.Value = Integer("\\MAXC")->Integer.Value = 0;
+
+    AcpiGbl_DeviceInitThreads = threads;
+    start = Now();
+    CHECK_STATUS(AcpiNsInitializeDevices(ACPI_NO_ADDRESS_SPACE_INIT));
+    start = Now() - start;
+
+    for (int d = 0; d < kDevices; d++) {
+        gDevice[d].start = Value(gDevice[d].path, "STRT");
+        gDevice[d].done = Value(gDevice[d].path, "DONE");
+        gDevice[d].runs = Value(gDevice[d].path, "RUNS");
+    }
+    *concurrent = Integer("\\MAXC")->Integer.Value;
+    return start;
+}
+
+static void Check(UINT32 threads)
+{
+    for (int d = 0; d < kDevices; d++) {
+        CHECK(gDevice[d].runs == gDevice[d].expected, "%s._INI ran %llu times on %u threads, expected %llu",
+              gDevice[d].path, (unsigned long long)gDevice[d].runs, threads, (unsigned long long)gDevice[d].expected);
+    }
+
+    for (int i = 0; i < kSubtrees; i++) {
+        /* Parents first */
+        for (int d = 3 * i; d < 3 * i + 2; d++) {
+            if (gDevice[d].runs && gDevice[d + 1].runs) {
+                CHECK(gDevice[d].done < gDevice[d + 1].start, "%s started before its parent finished on %u threads",
+                      gDevice[d + 1].path, threads);
+            }
+        }
+
+        /* Odd subtrees wait for the whole of the even one before them */
+        if (i % 2 && gDevice[3 * i].runs) {
+            for (int d = 3 * (i - 1); d < 3 * i; d++) {
+                CHECK(!gDevice[d].runs || gDevice[d].done < gDevice[3 * i].start,
+                      "%s started before %s, named by its _DEP, finished on %u threads",
+                      gDevice[3 * i].path, gDevice[d].path, threads);
+            }
+        }
+    }
+}
+
+int main()
+{
+    UINT64 concurrent, most = 0;
+    double serial, parallel[9];
+
+    for (int i = 0; i < kSubtrees; i++) {
+        snprintf(gDevice[3 * i].path, sizeof(gDevice[0].path), "\\_SB.DV%02d", i);
+        snprintf(gDevice[3 * i + 1].path, sizeof(gDevice[0].path), "\\_SB.DV%02d.CH%02d", i, i);
+        snprintf(gDevice[3 * i + 2].path, sizeof(gDevice[0].path), "\\_SB.DV%02d.CH%02d.GC%02d", i, i, i);
+        for (int d = 3 * i; d < 3 * i + 3; d++) {
+            gDevice[d].expected = i == 14 || (i == 12 && d == 3 * i) ? 0 : 1;
+        }
+    }
+
+    /* Everything but the device walk, which the test runs itself */
+    TestLoadTable("devinit.aml", 0);
+    CHECK_STATUS(AcpiEnableSubsystem(ACPI_NO_HARDWARE_INIT | ACPI_NO_ACPI_ENABLE | ACPI_NO_EVENT_INIT | ACPI_NO_HANDLER_INIT));
+    CHECK_STATUS(AcpiInitializeObjects(ACPI_NO_DEVICE_INIT));
+
+    serial = Run(0, &concurrent);
+    Check(0);
+    CHECK(concurrent == 1, "%llu _INI methods ran at once in the serial walk", (unsigned long long)concurrent);
+
+    for (UINT32 threads = 2; threads <= 8; threads++) {
+        parallel[threads] = 0;
+        for (int run = 0; run < kRuns; run++) {
+            parallel[threads] += Run(threads, &concurrent) / kRuns;
+            Check(threads);
+            most = concurrent > most ? concurrent : most;
+        }
+    }
+    CHECK(most > 1, "the parallel walk never ran two _INI methods at once");
+
+    printf("devinit: %d runs on 2-8 threads ran the serial walk's _INI methods, in _DEP order, up to %llu at once\n",
+           7 * kRuns, (unsigned long long)most);
+    printf("devinit: serial %.0f ms, 2 threads %.0f ms, 4 threads %.0f ms, 8 threads %.0f ms\n",
+           serial, parallel[2], parallel[4], parallel[8]);
+
+    CHECK_STATUS(AcpiTerminate());
+    printf("devinit: ok\n");
+    return 0;
+}
@@ -0,0 +1,47 @@
+#
+# Sixteen device subtrees for the parallel _STA/_INI walk. Every _INI logs
+# when it starts and finishes, sleeps so other subtrees can run, and has a
+# method-local Name that comes and goes while the walk is running. Each
+# odd subtree depends on the even one before it, by a _DEP package or a
+# _DEP method, and the even one holds a slow grandchild. DV12 is
+# functioning but not present, so only its children run; DV14 is neither,
+# so none of its subtree does.
+#
+
+import sys
+from aml import *
+
+SUBTREES = 16
+
+
+def ini(slow=False):
+    body = name('TMPN', integer(1))
+    body += increment(path('\\SEQ')) + store(path('\\SEQ'), path('STRT'))
+    body += increment(path('\\CUR'))
+    body += if_(lgreater(path('\\CUR'), path('\\MAXC')), store(path('\\CUR'), path('\\MAXC')))
+    body += sleep(20 if slow else 1)
+    body += decrement(path('\\CUR'))
+    body += increment(path('\\SEQ')) + store(path('\\SEQ'), path('DONE'))
+    body += increment(path('RUNS'))
+    return name('STRT', integer(0)) + name('DONE', integer(0)) + name('RUNS', integer(0)) + method('_INI', 0, body)
+
+
+sb = b''
+for i in range(SUBTREES):
+    grandchild = device('GC%02d' % i, ini(slow=i % 2 == 0))
+    child = device('CH%02d' % i, ini() + grandchild + device('NI%02d' % i, name('_UID', integer(i))))
+    body = ini() + child
+    if i % 2:
+        prerequisite = path('\\_SB.DV%02d' % (i - 1))
+        if i % 4 == 1:
+            body += name('_DEP', package([prerequisite]))
+        else:
+            body += method('_DEP', 0, ret(package([path('\\_SB.DV%02d.CH%02d' % (i - 1, i - 1))])))
+    if i == 12:
+        body += method('_STA', 0, ret(integer(0x08)))
+    if i == 14:
+        body += method('_STA', 0, ret(integer(0)))
+    sb += device('DV%02d' % i, body)
+
+root = name('SEQ', integer(0)) + name('CUR', integer(0)) + name('MAXC', integer(0))
+open(sys.argv[1], 'wb').write(table('DSDT', root + scope('\\_SB', sb)))
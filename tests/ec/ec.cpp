@@ -0,0 +1,605 @@
+/*
+ * PDACPIEmbeddedController against an emulated EC: threads reading and
+ * writing EC RAM with every byte checked, AML going through the EC address
+ * space, queries found by the poll timer before any GPE, the Global Lock
+ * held around every EC access when _GLK asks for it, a storm of events
+ * through the GPE, firmware dropping out of burst mode, and a hung EC
+ * timing out and coming back. Nothing is checked against the clock but
+ * the hung EC's timeout, which only runs while the EC takes no step.
+ */
+
+#include "PDACPIEmbeddedController.h"
+#include "test.h"
+#include <deque>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#define kCommandPort    0x66        /* ec.py */
+#define kDataPort       0x62
+#define kLatencyUS      50          /* firmware time per byte outside burst mode */
+#define kThreads        4
+#define kSlice          0x30        /* EC RAM each thread owns, from 0x40 */
+
+#define OBF             0x01
+#define IBF             0x02
+#define CMD             0x08
+#define BURST           0x10
+#define SCI_EVT         0x20
+
+/*
+ * The EC firmware. The host writes one byte at a time into the input
+ * buffer; the firmware thread takes it kLatencyUS later (at once in burst
+ * mode), then raises the EC's GPE when the test has connected one.
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool exiting;
+
+    UInt8 status;
+    UInt8 input;
+    UInt8 output;
+    UInt8 command;                  /* waiting for its address or data byte, or 0 */
+    UInt8 address;
+    int phase;
+    UInt8 ram[256];
+    std::deque<UInt8> events;
+
+    bool hung;                      /* take nothing from the input buffer */
+    bool dropBurst;                 /* leave burst mode after every byte taken in it */
+    UInt64 burstBytes;              /* taken in burst mode */
+    bool checkGlobalLock;
+    UInt64 unlockedAccesses;        /* command and data port accesses without the Global Lock */
+
+    pthread_mutex_t gpeLock;        /* held across a GPE, so the EC can be taken away */
+    PDACPIEmbeddedController *gpe;
+} gEmu;
+
+static int gInFlight;               /* EcExecute callbacks queued or running */
+
+static void EmuCheckLockLocked(void)
+{
+    if (gEmu.checkGlobalLock && !AcpiGbl_GlobalLockAcquired) {
+        gEmu.unlockedAccesses++;
+    }
+}
+
+static void EmuOutputLocked(UInt8 value)
+{
+    gEmu.output = value;
+    gEmu.status |= OBF;
+}
+
+static void EmuProcessLocked(void)
+{
+    UInt8 input = gEmu.input;
+
+    if (gEmu.status & CMD) {
+        gEmu.command = 0;
+        gEmu.phase = 0;
+        switch (input) {
+        case 0x80:
+        case 0x81:
+            gEmu.command = input;
+            break;
+        case 0x82:
+            gEmu.status |= BURST;
+            EmuOutputLocked(0x90);
+            break;
+        case 0x83:
+            gEmu.status &= ~BURST;
+            break;
+        case 0x84:
+            if (gEmu.events.empty()) {
+                EmuOutputLocked(0);
+            } else {
+                EmuOutputLocked(gEmu.events.front());
+                gEmu.events.pop_front();
+            }
+            if (gEmu.events.empty()) {
+                gEmu.status &= ~SCI_EVT;
+            }
+            break;
+        }
+        return;
+    }
+
+    if (gEmu.command && gEmu.phase == 0) {
+        gEmu.address = input;
+        gEmu.phase = 1;
+        if (gEmu.command == 0x80) {
+            EmuOutputLocked(gEmu.ram[gEmu.address]);
+            gEmu.command = 0;
+        }
+    } else if (gEmu.command == 0x81) {
+        gEmu.ram[gEmu.address] = input;
+        gEmu.command = 0;
+    }
+}
+
+static void EmuGPE(void)
+{
+    pthread_mutex_lock(&gEmu.gpeLock);
+    if (gEmu.gpe) {
+        xnu_set_interrupt_context(true);
+        gEmu.gpe->handleGPE();
+        xnu_set_interrupt_context(false);
+    }
+    pthread_mutex_unlock(&gEmu.gpeLock);
+}
+
+static void *EmuFirmware(void *)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    for (;;) {
+        while (!gEmu.exiting && (!(gEmu.status & IBF) || gEmu.hung)) {
+            pthread_cond_wait(&gEmu.cond, &gEmu.lock);
+        }
+        if (gEmu.exiting) {
+            break;
+        }
+        if (!(gEmu.status & BURST)) {
+            pthread_mutex_unlock(&gEmu.lock);
+            usleep(kLatencyUS);
+            pthread_mutex_lock(&gEmu.lock);
+        } else {
+            gEmu.burstBytes++;
+            if (gEmu.dropBurst) {
+                gEmu.status &= ~BURST;
+            }
+        }
+        EmuProcessLocked();
+        gEmu.status &= ~(IBF | CMD);
+        pthread_mutex_unlock(&gEmu.lock);
+        EmuGPE();
+        pthread_mutex_lock(&gEmu.lock);
+    }
+    pthread_mutex_unlock(&gEmu.lock);
+    return NULL;
+}
+
+static void EmuRaise(UInt8 query)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    gEmu.events.push_back(query);
+    gEmu.status |= SCI_EVT;
+    pthread_mutex_unlock(&gEmu.lock);
+    EmuGPE();
+}
+
+static void EmuSetHung(bool hung)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    gEmu.hung = hung;
+    pthread_cond_signal(&gEmu.cond);
+    pthread_mutex_unlock(&gEmu.lock);
+}
+
+static void EmuSetDropBurst(bool drop)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    gEmu.dropBurst = drop;
+    pthread_mutex_unlock(&gEmu.lock);
+}
+
+static UInt64 EmuBurstBytes(void)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    UInt64 bytes = gEmu.burstBytes;
+    pthread_mutex_unlock(&gEmu.lock);
+    return bytes;
+}
+
+static UInt8 EmuPeek(UInt8 address)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    UInt8 value = gEmu.ram[address];
+    pthread_mutex_unlock(&gEmu.lock);
+    return value;
+}
+
+/* The EC's port I/O and deferred calls; the Makefile points the EC's AcpiOs calls here */
+extern "C" ACPI_STATUS EcReadPort(ACPI_IO_ADDRESS address, UINT32 *value, UINT32 width)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    if (address == kCommandPort) {
+        *value = gEmu.status;
+    } else if (address == kDataPort) {
+        EmuCheckLockLocked();
+        *value = gEmu.output;
+        gEmu.status &= ~OBF;
+    } else {
+        *value = 0xFF;
+    }
+    pthread_mutex_unlock(&gEmu.lock);
+    return AE_OK;
+}
+
+extern "C" ACPI_STATUS EcWritePort(ACPI_IO_ADDRESS address, UINT32 value, UINT32 width)
+{
+    pthread_mutex_lock(&gEmu.lock);
+    if (address == kCommandPort || address == kDataPort) {
+        EmuCheckLockLocked();
+        gEmu.input = (UInt8)value;
+        gEmu.status |= IBF | (address == kCommandPort ? CMD : 0);
+        pthread_cond_signal(&gEmu.cond);
+    }
+    pthread_mutex_unlock(&gEmu.lock);
+    return AE_OK;
+}
+
+struct ExecArgs {
+    ACPI_OSD_EXEC_CALLBACK function;
+    void *context;
+};
+
+static void *ExecMain(void *arg)
+{
+    ExecArgs *args = (ExecArgs *)arg;
+
+    args->function(args->context);
+    delete args;
+    __atomic_sub_fetch(&gInFlight, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+extern "C" ACPI_STATUS EcExecute(ACPI_EXECUTE_TYPE type, ACPI_OSD_EXEC_CALLBACK function, void *context)
+{
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    __atomic_add_fetch(&gInFlight, 1, __ATOMIC_ACQUIRE);
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    CHECK(pthread_create(&thread, &attr, ExecMain, new ExecArgs { function, context }) == 0, "pthread_create");
+    pthread_attr_destroy(&attr);
+    return AE_OK;
+}
+
+extern "C" void EcWaitEventsComplete(void)
+{
+    while (__atomic_load_n(&gInFlight, __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+    }
+}
+
+/* Connects the EC's address space handler to ACPICA the way the platform expert does */
+class TestPlatform : public IOACPIPlatformExpert {
+public:
+    IOReturn registerAddressSpaceHandler(IOACPIPlatformDevice *device, IOACPIAddressSpaceID space,
+                                         IOACPIAddressSpaceHandler handler, void *context, IOOptionBits options) override
+    {
+        this->handler = handler;
+        this->context = context;
+        return ACPI_SUCCESS(AcpiInstallAddressSpaceHandler(ACPI_ROOT_OBJECT, space, Bridge, NULL, this))
+            ? kIOReturnSuccess : kIOReturnError;
+    }
+
+    void unregisterAddressSpaceHandler(IOACPIPlatformDevice *device, IOACPIAddressSpaceID space,
+                                       IOACPIAddressSpaceHandler handler, IOOptionBits options) override
+    {
+        CHECK_STATUS(AcpiRemoveAddressSpaceHandler(ACPI_ROOT_OBJECT, space, Bridge));
+        this->handler = NULL;
+    }
+
+private:
+    static ACPI_STATUS Bridge(UINT32 function, ACPI_PHYSICAL_ADDRESS address, UINT32 width,
+                              UINT64 *value, void *handlerContext, void *regionContext)
+    {
+        TestPlatform *platform = (TestPlatform *)regionContext;
+        IOACPIAddress where;
+
+        where.addr64 = address;
+        return platform->handler(function == ACPI_WRITE ? kIOACPIAddressSpaceOpWrite : kIOACPIAddressSpaceOpRead,
+                                 where, value, width, 0, platform->context) == kIOReturnSuccess ? AE_OK : AE_ERROR;
+    }
+
+    IOACPIAddressSpaceHandler handler;
+    void *context;
+};
+
+static TestPlatform gPlatform;
+static ACPI_HANDLE gDevice;
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static UINT64 Evaluate(const char *path, UINT64 *arg)
+{
+    ACPI_OBJECT argument, result;
+    ACPI_OBJECT_LIST list = { 1, &argument };
+    ACPI_BUFFER buffer = { sizeof(result), &result };
+
+    argument.Type = ACPI_TYPE_INTEGER;
+    argument.Integer.Value = arg ? *arg : 0;
+    result.Type = ACPI_TYPE_ANY;
+    CHECK_STATUS(AcpiEvaluateObject(gDevice, (char *)path, arg ? &list : NULL, &buffer));
+    return result.Type == ACPI_TYPE_INTEGER ? result.Integer.Value : 0;
+}
+
+/* Wait up to ms for Cxx to reach count */
+static bool WaitCount(const char *counter, UINT64 count, int ms)
+{
+    double until = Now() + ms;
+
+    while (Evaluate(counter, NULL) < count) {
+        if (Now() > until) {
+            return false;
+        }
+        usleep(1000);
+    }
+    return true;
+}
+
+/* Wait until the EC has no event left and nothing it queued is still running */
+static bool WaitQuiet(int ms)
+{
+    double until = Now() + ms;
+
+    for (int quiet = 0; quiet < 20; ) {
+        if (Now() > until) {
+            return false;
+        }
+        pthread_mutex_lock(&gEmu.lock);
+        bool idle = gEmu.events.empty() && !(gEmu.status & SCI_EVT);
+        pthread_mutex_unlock(&gEmu.lock);
+        idle = idle && !__atomic_load_n(&gInFlight, __ATOMIC_ACQUIRE);
+        quiet = idle ? quiet + 1 : 0;
+        usleep(1000);
+    }
+    return true;
+}
+
+static PDACPIEmbeddedController *StartEC(UINT64 globalLock, bool gpe)
+{
+    PDACPIEmbeddedController *ec;
+
+    Evaluate("SGLK", &globalLock);
+    ec = PDACPIEmbeddedController::withDevice(gDevice);
+    CHECK(ec, "no EC from the PNP0C09 device");
+    CHECK(ec->attach(&gPlatform), "attach");
+    if (gpe) {
+        pthread_mutex_lock(&gEmu.gpeLock);
+        gEmu.gpe = ec;
+        pthread_mutex_unlock(&gEmu.gpeLock);
+    }
+    /* There is no FADT GPE block on a host, so the EC's own GPE never installs */
+    CHECK(!ec->enableEvents(), "the EC's GPE installed");
+    return ec;
+}
+
+static void StopEC(PDACPIEmbeddedController *ec)
+{
+    pthread_mutex_lock(&gEmu.gpeLock);
+    gEmu.gpe = NULL;
+    pthread_mutex_unlock(&gEmu.gpeLock);
+    ec->detach(&gPlatform);
+    ec->release();
+}
+
+static PDACPIEmbeddedController *gEC;
+static int gRounds;
+
+/* Random reads and writes of 1-8 bytes within this thread's slice, checked against the emulator */
+static void *Worker(void *context)
+{
+    int t = (int)(intptr_t)context;
+    unsigned seed = t + 1;
+    UInt8 base = 0x40 + t * kSlice;
+    UInt8 data[8], back[8];
+
+    for (int i = 0; i < gRounds; i++) {
+        UInt32 length = 1 << (rand_r(&seed) % 4);
+        UInt8 address = base + rand_r(&seed) % (kSlice - length + 1);
+
+        for (UInt32 j = 0; j < length; j++) {
+            data[j] = rand_r(&seed);
+        }
+        CHECK(gEC->write(address, data, length) == kIOReturnSuccess, "write of %u at 0x%02x", length, address);
+        CHECK(gEC->read(address, back, length) == kIOReturnSuccess, "read of %u at 0x%02x", length, address);
+        CHECK(!memcmp(data, back, length), "thread %d read back other bytes at 0x%02x", t, address);
+        for (UInt32 j = 0; j < length; j++) {
+            CHECK(EmuPeek(address + j) == data[j], "EC RAM at 0x%02x is not what thread %d wrote", address + j, t);
+        }
+    }
+    return NULL;
+}
+
+static void RunWorkers(int threads, int rounds)
+{
+    pthread_t thread[kThreads];
+
+    gRounds = rounds;
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&thread[t], NULL, Worker, (void *)(intptr_t)t);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(thread[t], NULL);
+    }
+}
+
+/* Microseconds to read 8 bytes, in one burst transfer or a byte at a time */
+static double TimeReads(int count, bool burst)
+{
+    UInt8 data[8];
+    double start = Now();
+
+    for (int i = 0; i < count; i++) {
+        if (burst) {
+            CHECK(gEC->read(0x40, data, sizeof(data)) == kIOReturnSuccess, "8 byte read");
+        } else {
+            for (UInt32 j = 0; j < sizeof(data); j++) {
+                CHECK(gEC->read(0x40 + j, &data[j], 1) == kIOReturnSuccess, "1 byte read");
+            }
+        }
+    }
+    return (Now() - start) * 1e3 / count;
+}
+
+static volatile bool gHeldReadDone;
+
+static void *HeldRead(void *)
+{
+    UInt8 value;
+
+    CHECK(gEC->read(0x40, &value, 1) == kIOReturnSuccess, "read behind the Global Lock");
+    gHeldReadDone = true;
+    return NULL;
+}
+
+int main()
+{
+    static const UInt8 word[4] = { 0x78, 0x56, 0x34, 0x12 };
+    UINT64 value, before[6], bytes;
+    UInt8 byte;
+    double start, burst, noBurst;
+
+    pthread_mutex_init(&gEmu.lock, NULL);
+    pthread_cond_init(&gEmu.cond, NULL);
+    pthread_mutex_init(&gEmu.gpeLock, NULL);
+    pthread_create(&gEmu.thread, NULL, EmuFirmware, NULL);
+
+    TestLoadTable("ec.aml", 1);
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)"\\_SB.EC0", &gDevice));
+
+    /* Poll mode: no GPE at all */
+    gEC = StartEC(0, false);
+    CHECK(gEC->write(0x20, word, sizeof(word)) == kIOReturnSuccess, "write");
+    CHECK(Evaluate("RD32", NULL) == 0x12345678, "RD32 read 0x%llx", (unsigned long long)Evaluate("RD32", NULL));
+    value = 0xCAFEF00D;
+    Evaluate("WR32", &value);
+    CHECK(EmuPeek(0x20) == 0x0D && EmuPeek(0x23) == 0xCA, "WR32 did not reach EC RAM");
+
+    RunWorkers(kThreads, 200);
+    printf("ec: %d threads x 200 checked read/write pairs of 1-8 bytes, polling\n", kThreads);
+
+    /* Nothing touches the EC, so only the poll timer can find this one */
+    start = Now();
+    EmuRaise(0x10);
+    CHECK(WaitCount("C10", 1, 1000), "_Q10 did not run without an EC access");
+    printf("ec: event with no GPE and no access ran _Q10 after %.0f ms\n", Now() - start);
+
+    /* Time is only reported: what the EC took in burst mode is what's checked */
+    bytes = EmuBurstBytes();
+    burst = TimeReads(50, true);
+    CHECK(EmuBurstBytes() - bytes >= 50 * 16, "%llu bytes of 50 burst reads taken in burst mode",
+          (unsigned long long)(EmuBurstBytes() - bytes));
+    bytes = EmuBurstBytes();
+    noBurst = TimeReads(50, false);
+    CHECK(EmuBurstBytes() == bytes, "single byte reads used burst mode");
+    printf("ec: 8 bytes: %.0f us in one burst transfer, %.0f us a byte at a time\n", burst, noBurst);
+
+    /* Firmware leaving burst mode halfway through a transfer */
+    EmuSetDropBurst(true);
+    RunWorkers(1, 50);
+    EmuSetDropBurst(false);
+
+    /* Without _GLK nothing takes the Global Lock, which shows the check below can fail */
+    pthread_mutex_lock(&gEmu.lock);
+    gEmu.checkGlobalLock = true;
+    gEmu.unlockedAccesses = 0;
+    pthread_mutex_unlock(&gEmu.lock);
+    RunWorkers(1, 10);
+    CHECK(gEmu.unlockedAccesses > 0, "accesses without _GLK held the Global Lock");
+    gEmu.checkGlobalLock = false;
+
+    EmuSetHung(true);
+    start = Now();
+    CHECK(gEC->read(0x40, &byte, 1) == kIOReturnTimeout, "a hung EC did not time out");
+    printf("ec: hung EC timed out after %.0f ms\n", Now() - start);
+    EmuSetHung(false);
+    RunWorkers(1, 20);
+    StopEC(gEC);
+
+    /* _GLK: every EC access holds the Global Lock, AML and the test's own included */
+    gEC = StartEC(1, false);
+    pthread_mutex_lock(&gEmu.lock);
+    gEmu.checkGlobalLock = true;
+    gEmu.unlockedAccesses = 0;
+    pthread_mutex_unlock(&gEmu.lock);
+    RunWorkers(kThreads, 50);
+    Evaluate("RD32", NULL);
+    EmuRaise(0x11);
+    CHECK(WaitCount("C11", 1, 1000), "_Q11 did not run");
+    CHECK(gEmu.unlockedAccesses == 0, "%llu EC accesses without the Global Lock",
+          (unsigned long long)gEmu.unlockedAccesses);
+
+    UINT32 handle;
+    CHECK_STATUS(AcpiAcquireGlobalLock(0xFFFF, &handle));
+    pthread_t held;
+    pthread_create(&held, NULL, HeldRead, NULL);
+    usleep(50000);
+    CHECK(!gHeldReadDone, "an EC read went ahead while the test held the Global Lock");
+    CHECK_STATUS(AcpiReleaseGlobalLock(handle));
+    pthread_join(held, NULL);
+    CHECK(gHeldReadDone, "the EC read never finished");
+    gEmu.checkGlobalLock = false;
+    printf("ec: _GLK set: every access held the Global Lock, and waited for it\n");
+    StopEC(gEC);
+
+    /* GPE mode: a storm of events across six queries while threads use the EC */
+    gEC = StartEC(0, true);
+    EmuRaise(0x12);
+    CHECK(WaitCount("C12", 1, 1000), "_Q12 did not run");
+    for (int q = 0; q < 6; q++) {
+        char counter[8];
+        snprintf(counter, sizeof(counter), "C1%X", q);
+        before[q] = Evaluate(counter, NULL);
+    }
+
+    pthread_t thread[2];
+    gRounds = 100;
+    for (int t = 0; t < 2; t++) {
+        pthread_create(&thread[t], NULL, Worker, (void *)(intptr_t)t);
+    }
+    for (int i = 0; i < 2000; i++) {
+        EmuRaise(0x10 + i % 6);
+        if (i % 50 == 0) {
+            sched_yield();
+        }
+    }
+    for (int t = 0; t < 2; t++) {
+        pthread_join(thread[t], NULL);
+    }
+    CHECK(WaitQuiet(5000), "%zu events still waiting, %d workers running after the storm",
+          gEmu.events.size(), gInFlight);
+
+    UINT64 runs = 0;
+    for (int q = 0; q < 6; q++) {
+        char counter[8];
+        snprintf(counter, sizeof(counter), "C1%X", q);
+        value = Evaluate(counter, NULL) - before[q];
+        CHECK(value >= 1, "_Q1%X never ran during the storm", q);
+        runs += value;
+    }
+    CHECK(runs <= 2000, "%llu _Qxx runs for 2000 events", (unsigned long long)runs);
+    printf("ec: 2000 events over 6 queries through the GPE: %llu _Qxx runs\n", (unsigned long long)runs);
+
+    /* And none is lost once the storm is over */
+    for (int q = 0; q < 6; q++) {
+        char counter[8];
+        snprintf(counter, sizeof(counter), "C1%X", q);
+        value = Evaluate(counter, NULL);
+        EmuRaise(0x10 + q);
+        CHECK(WaitCount(counter, value + 1, 1000), "_Q1%X did not run after the storm", q);
+    }
+    StopEC(gEC);
+
+    pthread_mutex_lock(&gEmu.lock);
+    gEmu.exiting = true;
+    pthread_cond_signal(&gEmu.cond);
+    pthread_mutex_unlock(&gEmu.lock);
+    pthread_join(gEmu.thread, NULL);
+
+    CHECK_STATUS(AcpiTerminate());
+    printf("ec: ok\n");
+    return 0;
+}
@@ -0,0 +1,33 @@
+#
+# An Embedded Controller at ports 0x62/0x66 with GPE 0x17, as ec.cpp
+# emulates it. _GLK returns GLKV so each EC the test brings up can be told
+# whether to take the Global Lock (SGLK sets it). _Q10-_Q15 count their runs; RD32 and
+# WR32 go through the EC address space handler.
+#
+
+import sys
+from aml import *
+
+
+def io(port):
+    """IO (Decode16, port, port, 0, 1)"""
+    return bytes([0x47, 0x01, port & 0xFF, port >> 8, port & 0xFF, port >> 8, 0x00, 0x01])
+
+
+crs = buffer(io(0x62) + io(0x66) + bytes([0x79, 0x00]))
+
+ec = name('_HID', eisaid('PNP0C09'))
+ec += name('_CRS', crs)
+ec += name('_GPE', integer(0x17))
+ec += name('GLKV', integer(0))
+ec += method('_GLK', 0, ret(path('GLKV')))
+ec += method('SGLK', 1, store(arg(0), path('GLKV')))
+ec += opregion('ECOR', 3, 0, 0x100)
+ec += field('ECOR', 0x00, [(None, 0x20 * 8), ('F32', 32)])
+ec += method('RD32', 0, ret(path('F32')))
+ec += method('WR32', 1, store(arg(0), path('F32')))
+for q in range(0x10, 0x16):
+    ec += name('C%02X' % q, integer(0))
+    ec += method('_Q%02X' % q, 0, increment(path('C%02X' % q)))
+
+open(sys.argv[1], 'wb').write(table('DSDT', scope('\\_SB', device('EC0', ec))))
@@ -0,0 +1,184 @@
+/*
+ * AcpiOsLayer's ECAM config access, over host buffers standing in for the
+ * windows: the booter's range and MCFG allocations on two segments, one
+ * starting past bus 0 and one overlapping buses already covered. Reads and
+ * writes of every width land where the bus, device, function and register
+ * say; undecoded segments and buses and out-of-range device, function and
+ * register numbers get nothing; and a bus is mapped once, on first touch,
+ * however many CPUs race to touch it.
+ */
+
+#include "iokit.h"
+#include <pexpert/i386/boot.h>
+#include "test.h"
+#include <pthread.h>
+
+extern "C" ACPI_STATUS AcpiOsExtInitialize(void);
+extern "C" void *AcpiOsExtPciEcamAddress(ACPI_PCI_ID *PciId, UInt32 Reg);
+ACPI_STATUS AcpiOsExtAddPciEcam(const ACPI_MCFG_ALLOCATION *Allocation);
+ACPI_STATUS AcpiOsReadPCIConfigSpace(ACPI_PCI_ID *PciId, UInt32 Reg, UInt64 *Value, UInt32 Width);
+ACPI_STATUS AcpiOsWritePCIConfigSpace(ACPI_PCI_ID *PciId, UInt32 Reg, UInt64 Value, UInt32 Width);
+ACPI_STATUS AcpiOsExtTerminate(void);
+
+#define kBus            (1 << 20)
+#define kSegment        0x101       /* in the directory's second row */
+#define kThreads        4
+
+/* Segment 0: the booter's buses 0-3, then an MCFG entry for 2-5 that only adds 4 and 5 */
+static UInt8 *gBoot, *gHigh;
+/* Segment kSegment: buses 0x10-0x13, with the base still naming bus 0 */
+static UInt8 *gSegment;
+
+/* Where a register should be, or NULL */
+static UInt8 *Expected(UInt16 segment, UInt32 bus, UInt32 dev, UInt32 fn, UInt32 reg)
+{
+    UInt8 *window = NULL;
+
+    if (dev >= 32 || fn >= 8 || reg >= 4096) {
+        return NULL;
+    }
+    if (segment == 0 && bus <= 3) {
+        window = gBoot + bus * kBus;
+    } else if (segment == 0 && bus >= 4 && bus <= 5) {
+        window = gHigh + (bus - 4) * kBus;
+    } else if (segment == kSegment && bus >= 0x10 && bus <= 0x13) {
+        window = gSegment + (bus - 0x10) * kBus;
+    }
+    return window ? window + (dev << 15) + (fn << 12) + reg : NULL;
+}
+
+static ACPI_PCI_ID Id(UInt16 segment, UInt32 bus, UInt32 dev, UInt32 fn)
+{
+    ACPI_PCI_ID id = { segment, (UINT16)bus, (UINT16)dev, (UINT16)fn };
+    return id;
+}
+
+static void *Touch(void *arg)
+{
+    ACPI_PCI_ID id = Id(0, 5, 1, 0);
+
+    for (int i = 0; i < 1000; i++) {
+        CHECK(AcpiOsExtPciEcamAddress(&id, 0) == Expected(0, 5, 1, 0, 0), "bus 5 moved");
+    }
+    return NULL;
+}
+
+int main()
+{
+    static boot_args args;
+    ACPI_MCFG_ALLOCATION mcfg;
+    ACPI_PCI_ID id;
+    pthread_t thread[kThreads];
+    UInt64 value;
+    int made;
+
+    gBoot = (UInt8 *)calloc(4, kBus);
+    gHigh = (UInt8 *)calloc(2, kBus);
+    gSegment = (UInt8 *)calloc(4, kBus);
+    args.pciConfigSpaceBaseAddress = (uintptr_t)gBoot;
+    args.pciConfigSpaceStartBusNumber = 0;
+    args.pciConfigSpaceEndBusNumber = 3;
+    PE_state.bootArgs = &args;
+    CHECK_STATUS(AcpiOsExtInitialize());
+
+    memset(&mcfg, 0, sizeof(mcfg));
+    mcfg.Address = (uintptr_t)gHigh - 4 * kBus;
+    mcfg.PciSegment = 0;
+    mcfg.StartBusNumber = 2;
+    mcfg.EndBusNumber = 5;
+    CHECK_STATUS(AcpiOsExtAddPciEcam(&mcfg));
+    mcfg.Address = (uintptr_t)gSegment - 0x10 * kBus;
+    mcfg.PciSegment = kSegment;
+    mcfg.StartBusNumber = 0x10;
+    mcfg.EndBusNumber = 0x13;
+    CHECK_STATUS(AcpiOsExtAddPciEcam(&mcfg));
+    mcfg.StartBusNumber = 0x14;
+    CHECK(AcpiOsExtAddPciEcam(&mcfg) == AE_BAD_PARAMETER, "took an allocation ending before it starts");
+    mcfg.Address = 0;
+    mcfg.StartBusNumber = 0;
+    CHECK(AcpiOsExtAddPciEcam(&mcfg) == AE_BAD_PARAMETER, "took an allocation at 0");
+    CHECK(xnu_maps_made == 0, "%d windows mapped before any access", xnu_maps_made);
+
+    /* Only what is touched gets mapped, once */
+    for (int i = 0; i < 100; i++) {
+        id = Id(0, 3, i % 32, i % 8);
+        CHECK(AcpiOsExtPciEcamAddress(&id, i) == Expected(0, 3, i % 32, i % 8, i), "bus 3 register %d", i);
+        id = Id(kSegment, 0x11, i % 32, i % 8);
+        CHECK(AcpiOsExtPciEcamAddress(&id, i) == Expected(kSegment, 0x11, i % 32, i % 8, i), "segment %#x register %d", kSegment, i);
+    }
+    CHECK(xnu_maps_made == 2, "two buses touched, %d windows mapped", xnu_maps_made);
+
+    /* Nothing for what no allocation decodes, or that isn't a register */
+    const struct { UInt16 segment; UInt32 bus, dev, fn, reg; } none[] = {
+        { 0, 6, 0, 0, 0 }, { 0, 0xFF, 0, 0, 0 }, { 1, 0, 0, 0, 0 }, { 0x100, 0x10, 0, 0, 0 },
+        { kSegment, 0x0F, 0, 0, 0 }, { kSegment, 0x14, 0, 0, 0 }, { 0xFFFF, 0, 0, 0, 0 },
+        { 0, 0, 32, 0, 0 }, { 0, 0, 0, 8, 0 }, { 0, 0, 0, 0, 4096 }, { 0, 256, 0, 0, 0 },
+    };
+    for (size_t i = 0; i < sizeof(none) / sizeof(none[0]); i++) {
+        id = Id(none[i].segment, none[i].bus, none[i].dev, none[i].fn);
+        CHECK(!AcpiOsExtPciEcamAddress(&id, none[i].reg), "%04x:%02x:%02x.%x+%#x has an address", none[i].segment,
+              none[i].bus, none[i].dev, none[i].fn, none[i].reg);
+        CHECK(AcpiOsReadPCIConfigSpace(&id, none[i].reg, &value, 32) == AE_NOT_IMPLEMENTED,
+              "%04x:%02x:%02x.%x+%#x read", none[i].segment, none[i].bus, none[i].dev, none[i].fn, none[i].reg);
+    }
+    id = Id(0, 0, 0, 0);
+    CHECK(AcpiOsReadPCIConfigSpace(&id, 0, &value, 64) == AE_BAD_PARAMETER, "64-bit config read");
+    CHECK(AcpiOsWritePCIConfigSpace(&id, 0, 0, 24) == AE_BAD_PARAMETER, "24-bit config write");
+    CHECK(xnu_maps_made == 2, "undecoded accesses mapped %d windows", xnu_maps_made - 2);
+
+    /* A window that fails to map isn't remembered as missing */
+    xnu_maps_fail_after = 0;
+    id = Id(0, 4, 0, 0);
+    CHECK(!AcpiOsExtPciEcamAddress(&id, 0), "bus 4 has an address when its window couldn't be mapped");
+    xnu_maps_fail_after = -1;
+    CHECK(AcpiOsExtPciEcamAddress(&id, 0) == Expected(0, 4, 0, 0, 0), "bus 4 after mapping failed once");
+
+    /* CPUs racing to touch bus 5 first map it once */
+    made = xnu_maps_made;
+    for (int i = 0; i < kThreads; i++) {
+        pthread_create(&thread[i], NULL, Touch, NULL);
+    }
+    for (int i = 0; i < kThreads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    CHECK(xnu_maps_made == made + 1, "%d threads mapped bus 5 %d times", kThreads, xnu_maps_made - made);
+
+    /* Every width, anywhere decoded, lands at its offset and leaves its neighbours */
+    srand(1);
+    for (int i = 0; i < 200000; i++) {
+        static const UInt32 widths[] = { 8, 16, 32 };
+        static const UInt16 segments[] = { 0, 0, kSegment };
+        UInt32 width = widths[rand() % 3];
+        UInt16 segment = segments[rand() % 3];
+        UInt32 bus = segment ? 0x10 + rand() % 4 : rand() % 6;
+        UInt32 dev = rand() % 32, fn = rand() % 8, reg = (rand() % 4096) & ~(width / 8 - 1);
+        UInt8 *at = Expected(segment, bus, dev, fn, reg), before[2], *edge = at - (reg ? 1 : 0);
+        UInt64 written = (UInt64)rand() << 16 ^ rand(), mask = width == 32 ? 0xFFFFFFFF : (1ULL << width) - 1, read;
+        UInt32 direct = 0;
+
+        id = Id(segment, bus, dev, fn);
+        CHECK(AcpiOsExtPciEcamAddress(&id, reg) == at, "%04x:%02x:%02x.%x+%#x", segment, bus, dev, fn, reg);
+        before[0] = *edge;
+        before[1] = reg + width / 8 < 4096 ? at[width / 8] : 0;
+
+        CHECK_STATUS(AcpiOsWritePCIConfigSpace(&id, reg, written, width));
+        memcpy(&direct, at, width / 8);
+        CHECK(direct == (written & mask), "%u-bit write of %#llx at %04x:%02x:%02x.%x+%#x left %#x", width,
+              (unsigned long long)written, segment, bus, dev, fn, reg, direct);
+        CHECK((!reg || *edge == before[0]) && (reg + width / 8 >= 4096 || at[width / 8] == before[1]),
+              "%u-bit write at %04x:%02x:%02x.%x+%#x spilled over", width, segment, bus, dev, fn, reg);
+
+        direct = (UInt32)rand() << 1 ^ rand();
+        memcpy(at, &direct, width / 8);
+        CHECK_STATUS(AcpiOsReadPCIConfigSpace(&id, reg, &read, width));
+        CHECK(read == (direct & mask), "%u-bit read at %04x:%02x:%02x.%x+%#x got %#llx for %#x", width,
+              segment, bus, dev, fn, reg, (unsigned long long)read, direct & (UInt32)mask);
+    }
+    CHECK(xnu_maps_made == 10, "ten buses decoded, %d windows mapped", xnu_maps_made);
+
+    CHECK_STATUS(AcpiOsExtTerminate());
+    CHECK(!xnu_maps_live, "%d windows left mapped after termination", xnu_maps_live);
+    printf("ecam: %d windows mapped for 10 buses on 2 segments\n", xnu_maps_made);
+    printf("ecam: ok\n");
+    return 0;
+}
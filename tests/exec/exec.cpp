@@ -0,0 +1,235 @@
+/*
+ * AcpiOsLayer's deferred execution: per-queue ordering with one callback at
+ * a time on each queue, queueing from interrupt context with a simple lock
+ * held (as GPE dispatch does), the fixed item pool running dry and
+ * refilling, waiting for completion from inside a callback (with more
+ * queued behind it, and with every worker doing so), and shutdown.
+ */
+
+#include "iokit.h"
+#include <pexpert/i386/boot.h>
+#include "test.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+extern "C" ACPI_STATUS AcpiOsExtInitialize(void);
+extern "C" ACPI_STATUS AcpiOsExtExecute(ACPI_EXECUTE_TYPE Type, ACPI_OSD_EXEC_CALLBACK Function, void *Context);
+extern "C" void AcpiOsExtWaitEventsComplete(void);
+extern "C" void AcpiOsExtPrintExecuteStatistics(void);
+ACPI_STATUS AcpiOsExtTerminate(void);
+
+#define kPool   256     /* kAcpiOsExecItems */
+
+static const ACPI_EXECUTE_TYPE kTypes[] = {
+    OSL_GLOBAL_LOCK_HANDLER, OSL_NOTIFY_HANDLER, OSL_GPE_HANDLER, OSL_EC_POLL_HANDLER, OSL_EC_BURST_HANDLER
+};
+
+static int gRunning[OSL_EC_BURST_HANDLER + 1];
+static UInt64 gNext[OSL_EC_BURST_HANDLER + 1];
+static UInt64 gDone;
+static UInt64 gBusy;            /* time spent in callbacks */
+
+struct Job {
+    ACPI_EXECUTE_TYPE type;
+    UInt64 seq;
+    unsigned delay;
+};
+
+static void Run(void *context)
+{
+    Job *j = (Job *)context;
+
+    CHECK(__atomic_add_fetch(&gRunning[j->type], 1, __ATOMIC_ACQ_REL) == 1, "two callbacks at once on queue %d", j->type);
+    CHECK(j->seq == gNext[j->type], "queue %d ran %llu, expected %llu", j->type,
+          (unsigned long long)j->seq, (unsigned long long)gNext[j->type]);
+    gNext[j->type]++;
+    if (j->delay) {
+        UInt64 start = mach_absolute_time();
+        usleep(j->delay);       /* waiting on the hardware, say */
+        __atomic_add_fetch(&gBusy, mach_absolute_time() - start, __ATOMIC_RELAXED);
+    }
+    __atomic_sub_fetch(&gRunning[j->type], 1, __ATOMIC_ACQ_REL);
+    __atomic_add_fetch(&gDone, 1, __ATOMIC_RELAXED);
+    delete j;
+}
+
+/* Queue, waiting for a free item when the pool is out */
+static void Queue(Job *j)
+{
+    while (AcpiOsExtExecute(j->type, Run, j) == AE_NO_MEMORY) {
+        sched_yield();
+    }
+}
+
+/* Like a GPE: interrupt context, interrupts off, a spin lock held */
+static UInt64 gSeq[OSL_EC_BURST_HANDLER + 1];
+static IOSimpleLock *gGpeLock;
+
+static void *Interrupt(void *)
+{
+    xnu_set_interrupt_context(true);
+    for (int i = 0; i < 20000; i++) {
+        ACPI_EXECUTE_TYPE type = i % 2 ? OSL_GPE_HANDLER : OSL_NOTIFY_HANDLER;
+        Job *j = new Job{type, 0, 0};
+        for (;;) {
+            IOInterruptState is = IOSimpleLockLockDisableInterrupt(gGpeLock);
+            j->seq = gSeq[type];
+            ACPI_STATUS status = AcpiOsExtExecute(type, Run, j);
+            if (ACPI_SUCCESS(status)) {
+                gSeq[type]++;
+            }
+            IOSimpleLockUnlockEnableInterrupt(gGpeLock, is);
+            if (status != AE_NO_MEMORY) {
+                CHECK_STATUS(status);
+                break;
+            }
+            sched_yield();
+        }
+    }
+    xnu_set_interrupt_context(false);
+    return NULL;
+}
+
+static volatile bool gGate;
+
+static void Wait(void *)
+{
+    while (!__atomic_load_n(&gGate, __ATOMIC_ACQUIRE)) {
+        IODelay(100);
+    }
+    __atomic_add_fetch(&gDone, 1, __ATOMIC_RELAXED);
+}
+
+static UInt64 gWaiting;
+
+static void WaitForAll(void *)
+{
+    __atomic_add_fetch(&gWaiting, 1, __ATOMIC_RELAXED);
+    AcpiOsExtWaitEventsComplete();
+    __atomic_add_fetch(&gDone, 1, __ATOMIC_RELAXED);
+}
+
+/* Queued behind WaitForAll on the same queue, which can't return before this runs */
+static void Behind(void *)
+{
+    __atomic_add_fetch(&gDone, 1, __ATOMIC_RELAXED);
+}
+
+static void WaitForBehind(void *)
+{
+    AcpiOsExtWaitEventsComplete();
+    CHECK(__atomic_load_n(&gDone, __ATOMIC_RELAXED) == 1, "returned with the callback queued behind it not run");
+    __atomic_add_fetch(&gDone, 1, __ATOMIC_RELAXED);
+}
+
+static double Seconds()
+{
+    return mach_absolute_time() / 1e9;
+}
+
+int main()
+{
+    static boot_args args;
+
+    PE_state.bootArgs = &args;
+    CHECK_STATUS(AcpiOsExtInitialize());
+
+    /* Each queue in order and one at a time, all of them at once */
+    const int n = 200000;
+    double start = Seconds();
+    for (int i = 0; i < n; i++) {
+        ACPI_EXECUTE_TYPE type = kTypes[i % 5];
+        Queue(new Job{type, gSeq[type]++, 0});
+    }
+    AcpiOsExtWaitEventsComplete();
+    CHECK(gDone == n, "%llu of %d done", (unsigned long long)gDone, n);
+    printf("%.0f callbacks a second end to end\n", n / (Seconds() - start));
+
+    /* From interrupt context, with a second producer in thread context */
+    gGpeLock = IOSimpleLockAlloc();
+    gDone = 0;
+    pthread_t interrupt;
+    pthread_create(&interrupt, NULL, Interrupt, NULL);
+    for (int i = 0; i < 20000; i++) {
+        Job *j = new Job{OSL_EC_POLL_HANDLER, 0, 0};
+        IOInterruptState is = IOSimpleLockLockDisableInterrupt(gGpeLock);
+        j->seq = gSeq[OSL_EC_POLL_HANDLER]++;
+        IOSimpleLockUnlockEnableInterrupt(gGpeLock, is);
+        Queue(j);
+    }
+    pthread_join(interrupt, NULL);
+    AcpiOsExtWaitEventsComplete();
+    CHECK(gDone == 40000, "%llu of 40000 done", (unsigned long long)gDone);
+
+    /* The pool runs dry with every worker stuck, then refills */
+    gDone = 0;
+    gGate = false;
+    int queued = 0;
+    for (int i = 0; i < 2 * kPool; i++) {
+        if (AcpiOsExtExecute(kTypes[i % 5], Wait, NULL) == AE_NO_MEMORY) {
+            break;
+        }
+        queued++;
+    }
+    CHECK(queued == kPool, "%d queued before the pool ran out", queued);
+    __atomic_store_n(&gGate, true, __ATOMIC_RELEASE);
+    AcpiOsExtWaitEventsComplete();
+    CHECK(gDone == (UInt64)kPool, "%llu of %d done", (unsigned long long)gDone, kPool);
+    for (int i = 0; i < kPool; i++) {
+        CHECK_STATUS(AcpiOsExtExecute(kTypes[i % 5], Wait, NULL));
+    }
+    AcpiOsExtWaitEventsComplete();
+
+    /* Waiting for everything from a callback, on two queues at once */
+    gDone = 0;
+    CHECK_STATUS(AcpiOsExtExecute(OSL_NOTIFY_HANDLER, WaitForAll, NULL));
+    CHECK_STATUS(AcpiOsExtExecute(OSL_GPE_HANDLER, WaitForAll, NULL));
+    AcpiOsExtWaitEventsComplete();
+    CHECK(gDone == 2, "%llu of 2 waiters done", (unsigned long long)gDone);
+
+    /* A callback waiting with another queued behind it on its own queue */
+    gDone = 0;
+    CHECK_STATUS(AcpiOsExtExecute(OSL_GPE_HANDLER, WaitForBehind, NULL));
+    CHECK_STATUS(AcpiOsExtExecute(OSL_GPE_HANDLER, Behind, NULL));
+    AcpiOsExtWaitEventsComplete();
+    CHECK(gDone == 2, "%llu of 2 done", (unsigned long long)gDone);
+
+    /* Every worker waiting, with work on a fifth queue and more behind each of them */
+    gDone = 0;
+    gWaiting = 0;
+    for (int i = 0; i < 4; i++) {
+        CHECK_STATUS(AcpiOsExtExecute(kTypes[i], WaitForAll, NULL));
+    }
+    while (__atomic_load_n(&gWaiting, __ATOMIC_RELAXED) < 4) {
+        IOSleep(1);
+    }
+    for (int i = 0; i < 5; i++) {
+        CHECK_STATUS(AcpiOsExtExecute(kTypes[i], Behind, NULL));
+    }
+    AcpiOsExtWaitEventsComplete();
+    CHECK(gDone == 9, "%llu of 9 done", (unsigned long long)gDone);
+
+    /* Slow callbacks on different queues overlap, and the caller never waits on them */
+    double queueing = 0;
+    gDone = 0;
+    start = Seconds();
+    for (int i = 0; i < 200; i++) {
+        ACPI_EXECUTE_TYPE type = kTypes[1 + i % 4];
+        double t = Seconds();
+        Queue(new Job{type, gSeq[type]++, 200});
+        queueing += Seconds() - t;
+    }
+    AcpiOsExtWaitEventsComplete();
+    double elapsed = Seconds() - start;
+    printf("200 us callbacks: queued in %.2f us on average, done in %.0f ms, %.0f ms one after another\n",
+           queueing / 200 * 1e6, elapsed * 1e3, gBusy / 1e6);
+    CHECK(elapsed < gBusy / 1e9 * 0.5, "%.0f ms for %.0f ms of callbacks: the queues did not overlap",
+          elapsed * 1e3, gBusy / 1e6);
+
+    AcpiOsExtPrintExecuteStatistics();
+    CHECK_STATUS(AcpiOsExtTerminate());
+    IOSimpleLockFree(gGpeLock);
+    printf("exec: ok\n");
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * PDACPIIdle: _CST/_LPI parsing, and the governor replayed over idle traces
+ * against an oracle that knows each period's length in advance.
+ *
+ * Energy for one period of d us in a state is power * d plus a wakeup cost
+ * of kActivePower * latency. The traces are generated from a fixed seed so
+ * every run sees the same ones.
+ */
+
+extern "C" {
+#include "acpi.h"
+#include "accommon.h"
+}
+#include "PDACPIIdle.h"
+#include "test.h"
+#include <math.h>
+#include <vector>
+
+#define kActivePower    2000.0
+
+struct Result {
+    double energy;
+    UInt64 tooDeep, tooShallow, overLimit;
+};
+
+enum Policy { kGovernor, kAlwaysC1, kLastValue, kOracle };
+
+static const char *kPolicyNames[] = { "governor", "always C1", "last value", "oracle" };
+
+static double Energy(const PDACPICState *s, UInt32 i, double d)
+{
+    return s[i].power * d + kActivePower * s[i].latency;
+}
+
+static Result Replay(const std::vector<UInt32> &trace, const PDACPICState *s, UInt32 n, Policy policy,
+                     UInt32 limit, bool timer)
+{
+    PDACPIIdle *idle = PDACPIIdleCreate(1);
+    Result r = {};
+    UInt32 last = 0;
+
+    PDACPIIdleSetStates(idle, 0, s, n);
+    for (UInt32 d : trace) {
+        UInt32 i = 0;
+        switch (policy) {
+            case kGovernor:
+                i = PDACPIIdleSelect(idle, 0, limit, timer ? d : kPDACPIIdleNoTimer);
+                break;
+            case kAlwaysC1:
+                break;
+            case kLastValue:
+                for (UInt32 j = 1; j < n && s[j].residency <= last && s[j].latency <= limit; j++) {
+                    i = j;
+                }
+                break;
+            case kOracle: {
+                double best = 1e300;
+                for (UInt32 j = 0; j < n && s[j].latency <= limit; j++) {
+                    if (Energy(s, j, d) < best) {
+                        best = Energy(s, j, d);
+                        i = j;
+                    }
+                }
+                break;
+            }
+        }
+        r.overLimit += s[i].latency > limit;
+        r.energy += Energy(s, i, d);
+        if (i && d < s[i].residency) {
+            r.tooDeep++;
+        } else if (i + 1 < n && d >= s[i + 1].residency && s[i + 1].latency <= limit) {
+            r.tooShallow++;
+        }
+        PDACPIIdleReflect(idle, 0, i, d);
+        last = d;
+    }
+    PDACPIIdleDestroy(idle);
+    return r;
+}
+
+/* xorshift64*, so the traces don't depend on the C library */
+static UInt64 gSeed = 0x2545F4914F6CDD1DULL;
+
+static double Uniform()
+{
+    gSeed ^= gSeed >> 12;
+    gSeed ^= gSeed << 25;
+    gSeed ^= gSeed >> 27;
+    return ((gSeed * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static UInt32 Around(double mean, double spread)
+{
+    double v = mean + (Uniform() * 2 - 1) * spread;
+    return v < 1 ? 1 : (UInt32)v;
+}
+
+struct Trace {
+    const char *name;
+    std::vector<UInt32> periods;
+};
+
+static std::vector<Trace> MakeTraces(size_t length)
+{
+    std::vector<Trace> traces(5);
+
+    /* a 500 us tick with the odd early interrupt */
+    traces[0].name = "periodic";
+    for (size_t k = 0; k < length; k++) {
+        traces[0].periods.push_back(Uniform() < 0.05 ? Around(40, 15) : Around(500, 25));
+    }
+    /* runs of short and long periods, like a busy device that goes quiet */
+    traces[1].name = "bimodal";
+    while (traces[1].periods.size() < length) {
+        bool shortRun = traces[1].periods.size() / 13 % 2 == 0;
+        traces[1].periods.push_back(shortRun ? Around(30, 15) : Around(3000, 600));
+    }
+    /* exponential, mean 130 us */
+    traces[2].name = "random";
+    for (size_t k = 0; k < length; k++) {
+        traces[2].periods.push_back((UInt32)(-130.0 * log(1 - Uniform())) + 1);
+    }
+    /* mostly long, with rare very short ones */
+    traces[3].name = "sparse";
+    for (size_t k = 0; k < length; k++) {
+        traces[3].periods.push_back(Uniform() < 0.04 ? Around(5, 4) : Around(4000, 200));
+    }
+    /* mostly short, with rare long ones */
+    traces[4].name = "burst";
+    for (size_t k = 0; k < length; k++) {
+        traces[4].periods.push_back(Uniform() < 0.02 ? Around(7900, 150) : Around(48, 12));
+    }
+    return traces;
+}
+
+static void CheckParsing(PDACPIIdle *idle)
+{
+    const PDACPICState *s;
+    UInt32 n;
+
+    /* FFixedHW: the repeat and the out-of-order entry are dropped */
+    n = PDACPIIdleGetStates(idle, 0, &s);
+    CHECK(n == 3, "CPU0 has %u states", n);
+    CHECK(s[0].method == kPDACPIIdleMethodHalt && s[0].type == 1, "CPU0 C1 method %u", s[0].method);
+    CHECK(s[1].method == kPDACPIIdleMethodMwait && s[1].address == 0x10 && !s[1].busMasterAvoid, "CPU0 C2");
+    CHECK(s[2].method == kPDACPIIdleMethodMwait && s[2].address == 0x20 && s[2].busMasterAvoid &&
+          s[2].latency == 100, "CPU0 C3");
+
+    /* I/O: a halt C1 goes in front; C3 needs bus masters quiet */
+    n = PDACPIIdleGetStates(idle, 1, &s);
+    CHECK(n == 3, "CPU1 has %u states", n);
+    CHECK(s[0].method == kPDACPIIdleMethodHalt, "CPU1 C1 method %u", s[0].method);
+    CHECK(s[1].method == kPDACPIIdleMethodIO && s[1].address == 0x414 && !s[1].busMasterAvoid, "CPU1 C2");
+    CHECK(s[2].method == kPDACPIIdleMethodIO && s[2].address == 0x415 && s[2].busMasterAvoid, "CPU1 C3");
+
+    /* _LPI: the disabled state and the integer entry method are left out */
+    n = PDACPIIdleGetStates(idle, 2, &s);
+    CHECK(n == 2, "CPU2 has %u states", n);
+    CHECK(s[1].latency == 120 && s[1].residency == 300 && s[1].address == 0x20, "CPU2 deep state");
+
+    /* Nothing at all: HLT */
+    n = PDACPIIdleGetStates(idle, 3, &s);
+    CHECK(n == 1 && s[0].method == kPDACPIIdleMethodHalt, "CPU3 has %u states", n);
+}
+
+int main()
+{
+    static const char *paths[] = { "\\_SB.CPU0", "\\_SB.CPU1", "\\_SB.CPU2", "\\_SB.CPU3" };
+    PDACPIIdle *idle;
+    const PDACPICState *s;
+    UInt32 n;
+
+    TestLoadTable("idle.aml", 0);
+    idle = PDACPIIdleCreate(4);
+    CHECK(idle, "create");
+    for (int cpu = 0; cpu < 4; cpu++) {
+        ACPI_HANDLE h;
+        CHECK_STATUS(AcpiGetHandle(NULL, (char *)paths[cpu], &h));
+        CHECK(PDACPIIdleAddProcessor(idle, cpu, h) == kIOReturnSuccess, "add CPU%d", cpu);
+    }
+    CHECK(PDACPIIdleAddProcessor(idle, 0, (ACPI_HANDLE)1) != kIOReturnSuccess, "adding CPU0 twice");
+    CheckParsing(idle);
+    n = PDACPIIdleGetStates(idle, 0, &s);
+
+    /*
+     * Any one trace can favour a simpler policy; last value wins on long
+     * runs of one kind, for one. Across all of them the governor has to win,
+     * and stay near the oracle: these are regression bounds, with a margin,
+     * on what it scores today.
+     */
+    std::vector<Trace> traces = MakeTraces(30000);
+    for (UInt32 limit : { 1000u, 50u }) {
+        double governor = 0, lastValue = 0, overhead = 0;
+        for (const Trace &t : traces) {
+            Result r[4];
+            for (int p = 0; p < 4; p++) {
+                r[p] = Replay(t.periods, s, n, (Policy)p, limit, false);
+            }
+            Result timed = Replay(t.periods, s, n, kGovernor, limit, true);
+
+            printf("%-8s limit %4u us:", t.name, limit);
+            for (int p = 0; p < 3; p++) {
+                printf("  %s %+5.1f%%", kPolicyNames[p], 100 * (r[p].energy / r[kOracle].energy - 1));
+            }
+            printf("  with timer %+5.1f%%\n", 100 * (timed.energy / r[kOracle].energy - 1));
+
+            /* Never deeper than the latency limit allows */
+            CHECK(!r[kGovernor].overLimit && !timed.overLimit, "%s: %llu over the limit", t.name,
+                  (unsigned long long)r[kGovernor].overLimit);
+            CHECK(r[kGovernor].energy < r[kAlwaysC1].energy, "%s: worse than always C1", t.name);
+            /* Knowing the next timer only helps */
+            CHECK(timed.energy <= r[kGovernor].energy * 1.001, "%s: the timer made it worse", t.name);
+
+            governor += r[kGovernor].energy / r[kOracle].energy;
+            lastValue += r[kLastValue].energy / r[kOracle].energy;
+            overhead += r[kGovernor].energy / r[kOracle].energy - 1;
+        }
+        overhead /= traces.size();
+        CHECK(governor < lastValue, "limit %u: last value did better overall", limit);
+        CHECK(overhead < (limit > 100 ? 0.50 : 0.10), "limit %u: %.1f%% over the oracle on average",
+              limit, 100 * overhead);
+    }
+
+    /* Statistics add up to what was reflected */
+    PDACPIIdleStatistics stats;
+    PDACPIIdleReflect(idle, 0, 2, 500);
+    PDACPIIdleReflect(idle, 0, 2, 10);
+    CHECK(PDACPIIdleGetStatistics(idle, 0, 2, &stats), "statistics");
+    CHECK(stats.entries == 2 && stats.residency == 510 && stats.tooDeep == 1, "C3: %llu entries, %llu us, %llu too deep",
+          (unsigned long long)stats.entries, (unsigned long long)stats.residency, (unsigned long long)stats.tooDeep);
+
+    PDACPIIdleDestroy(idle);
+    printf("idle: ok\n");
+    return 0;
+}
@@ -0,0 +1,39 @@
+#
+# Four processors: FFixedHW _CST (with a repeat and an out-of-order entry),
+# I/O _CST with no C1, _LPI, and one with nothing.
+#
+
+import sys
+from aml import *
+
+FFH = 0x7f
+
+
+def cst(entries):
+    return name('_CST', package([integer(len(entries))] +
+                                [package([buffer(r), integer(t), integer(l), integer(p)]) for r, t, l, p in entries]))
+
+
+def lpi(res, lat, flags, entry):
+    return package([integer(res), integer(lat), integer(flags), integer(0), integer(0), integer(0), entry,
+                    buffer(gas(0, 0, 0, 0, 0)), buffer(gas(0, 0, 0, 0, 0)), string('X')])
+
+
+sb = b''
+# C1 is FFixedHW class 1 (halt); C2 and C3 native MWAIT, C3 asking for bus master avoidance
+sb += processor('CPU0', 0, cst([(gas(FFH, 1, 1, 0, 0), 1, 1, 1000),
+                                (gas(FFH, 1, 2, 1, 0x10), 2, 20, 500),
+                                (gas(FFH, 1, 2, 3, 0x20), 3, 100, 100),
+                                (gas(FFH, 1, 2, 1, 0x10), 2, 20, 500),
+                                (gas(FFH, 1, 2, 1, 0x30), 3, 50, 90)]))
+sb += processor('CPU1', 1, cst([(gas(1, 8, 0, 0, 0x414), 2, 50, 400),
+                                (gas(1, 8, 0, 0, 0x415), 3, 150, 80)]))
+# _LPI: enabled, disabled, enabled, and one entered by an integer (a container level)
+sb += processor('CPU2', 2, name('_LPI', package([integer(0), integer(0), integer(4),
+                                                 lpi(1, 1, 1, buffer(gas(FFH, 32, 2, 0, 0x00))),
+                                                 lpi(50, 20, 0, buffer(gas(FFH, 32, 2, 0, 0x10))),
+                                                 lpi(300, 120, 1, buffer(gas(FFH, 32, 2, 0, 0x20))),
+                                                 lpi(1000, 400, 1, integer(0x1000000))])))
+sb += processor('CPU3', 3, b'')
+
+open(sys.argv[1], 'wb').write(table('DSDT', scope('\\_SB', sb)))
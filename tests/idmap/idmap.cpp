@@ -0,0 +1,122 @@
+/*
+ * The device ID map against the AcpiGetDevices walk, after the map has
+ * been built and AML then changes a _HID or _CID it holds: stores to the
+ * _HID, to a _CID package element and to a byte of one, and a _HID that a
+ * method creates under a device for as long as the method runs. Also the
+ * memoized results of pure _HID methods: each caller gets its own copy,
+ * and a method that reads a name through DerefOf is not memoized.
+ */
+
+#include "test.h"
+
+extern "C" {
+#include "acnamesp.h"
+}
+
+#define kQuerySpace 0x80    /* idmap.py */
+
+static ACPI_STATUS Count(ACPI_HANDLE object, UINT32 level, void *context, void **ret)
+{
+    (*(int *)context)++;
+    return AE_OK;
+}
+
+static int Query(const char *hid, BOOLEAN map)
+{
+    int count = 0;
+
+    AcpiGbl_EnableDeviceIdMap = map;
+    CHECK_STATUS(AcpiGetDevices((char *)hid, Count, &count, NULL));
+    AcpiGbl_EnableDeviceIdMap = TRUE;
+    return count;
+}
+
+/* The map gives what the walk does, and that is expected */
+static void Expect(const char *hid, int expected)
+{
+    int walk = Query(hid, FALSE), map = Query(hid, TRUE);
+
+    CHECK(walk == expected, "the walk found %d devices with %s, expected %d", walk, hid, expected);
+    CHECK(map == walk, "the map found %d devices with %s, the walk %d", map, hid, walk);
+}
+
+static void Evaluate(const char *path)
+{
+    CHECK_STATUS(AcpiEvaluateObject(NULL, (char *)path, NULL, NULL));
+}
+
+/* Evaluate path's _HID, which must be hid, and overwrite what the caller got */
+static void ExpectHid(const char *path, const char *hid)
+{
+    ACPI_EVALUATE_INFO info;
+    ACPI_OPERAND_OBJECT *method;
+    ACPI_HANDLE handle;
+
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)path, &handle));
+    method = AcpiNsGetAttachedObject(AcpiNsValidateHandle(handle));
+    memset(&info, 0, sizeof(info));
+    info.PrefixNode = AcpiNsValidateHandle(handle);
+    CHECK_STATUS(AcpiNsEvaluate(&info));
+    CHECK(info.ReturnObject && info.ReturnObject->Common.Type == ACPI_TYPE_STRING &&
+          !strcmp(info.ReturnObject->String.Pointer, hid), "%s is not %s", path, hid);
+    CHECK(info.ReturnObject != method->Method.ResultCache, "%s returned its memoized result itself", path);
+    info.ReturnObject->String.Pointer[0] = 'X';
+    AcpiUtRemoveReference(info.ReturnObject);
+}
+
+static UINT8 Pure(const char *path)
+{
+    ACPI_HANDLE handle;
+
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)path, &handle));
+    return AcpiNsGetAttachedObject(AcpiNsValidateHandle(handle))->Method.InfoFlags & ACPI_METHOD_PURE;
+}
+
+static int gInMethod = -1;
+
+/* Runs in MK with the interpreter released, while \_SB.D2._HID exists */
+static ACPI_STATUS QueryHandler(UINT32 function, ACPI_PHYSICAL_ADDRESS address, UINT32 width,
+                                UINT64 *value, void *handlerContext, void *regionContext)
+{
+    gInMethod = Query("TEMP0001", TRUE);
+    *value = 0;
+    return AE_OK;
+}
+
+int main()
+{
+    TestLoadTable("idmap.aml", 1);
+    CHECK_STATUS(AcpiInstallAddressSpaceHandler(ACPI_ROOT_OBJECT, kQuerySpace, QueryHandler, NULL, NULL));
+
+    Expect("ABCD0001", 1);
+    Expect("CIDS0001", 1);
+
+    Evaluate("\\_SB.S3");
+    Expect("CIDS0001", 0);
+    Expect("CIDS0003", 1);
+
+    Evaluate("\\_SB.S2");
+    Expect("CIDS0003", 0);
+    Expect("CIDS0002", 1);
+
+    Evaluate("\\_SB.S1");
+    Expect("ABCD0001", 0);
+    Expect("ABCD0002", 1);
+
+    Expect("TEMP0001", 0);
+    Evaluate("\\_SB.MK");
+    CHECK(gInMethod == 1, "the map found %d devices with a _HID created by a running method", gInMethod);
+    Expect("TEMP0001", 0);
+
+    CHECK(Pure("\\_SB.D3._HID") && !Pure("\\_SB.D4._HID"), "D3._HID is%s pure, D4._HID is%s",
+          Pure("\\_SB.D3._HID") ? "" : " not", Pure("\\_SB.D4._HID") ? "" : " not");
+    ExpectHid("\\_SB.D3._HID", "PURE0001");
+    ExpectHid("\\_SB.D3._HID", "PURE0001");
+    ExpectHid("\\_SB.D4._HID", "HIDV0001");
+    Evaluate("\\_SB.S4");
+    ExpectHid("\\_SB.D4._HID", "HIDV0002");
+
+    CHECK_STATUS(AcpiTerminate());
+    printf("idmap: ok\n");
+    return 0;
+}
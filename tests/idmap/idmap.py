@@ -0,0 +1,30 @@
+#
+# Devices whose IDs change after the device ID map has been built: a _HID
+# and a _CID package stored to by methods (whole, by element, and a byte of
+# an element), and a _HID that a method creates under a device and that
+# goes away when the method returns. MK reads a field in space 0x80, whose
+# handler in idmap.cpp queries the map while the _HID exists. D3's _HID
+# method is pure; D4's reads HIDV through DerefOf of a String.
+#
+
+import sys
+from aml import *
+
+sb = device('D1', name('_HID', string('ABCD0001')) +
+                  name('_CID', package([string('CIDS0001')])))
+sb += device('D2', name('_UID', integer(2)))
+sb += opregion('QRY', 0x80, 0, 1)
+sb += field('QRY', 0x01, [('QRYF', 8)])
+
+# A byte of the _CID string, then the _CID element, then the _HID
+sb += method('S3', 0, store(integer(ord('3')), index(derefof(index(path('\\_SB.D1._CID'), integer(0))), integer(7))))
+sb += method('S2', 0, store(string('CIDS0002'), index(path('\\_SB.D1._CID'), integer(0))))
+sb += method('S1', 0, store(string('ABCD0002'), path('\\_SB.D1._HID')))
+sb += method('MK', 0, name('\\_SB.D2._HID', string('TEMP0001')) + ret(path('QRYF')))
+
+sb += device('D3', method('_HID', 0, ret(string('PURE0001'))))
+sb += name('HIDV', string('HIDV0001'))
+sb += device('D4', method('_HID', 0, store(string('\\_SB.HIDV'), local(0)) + ret(derefof(local(0)))))
+sb += method('S4', 0, store(string('HIDV0002'), path('\\_SB.HIDV')))
+
+open(sys.argv[1], 'wb').write(table('DSDT', scope('\\_SB', sb)))
@@ -0,0 +1 @@
+#include "iokit.h"
@@ -0,0 +1 @@
+#include "xnu.h"
@@ -0,0 +1,54 @@
+/*
+ * The address space types of IOACPITypes.h, and the part of
+ * IOACPIPlatformExpert a kext driver registers handlers with. A test
+ * subclasses it to route a space to a driver.
+ */
+
+#ifndef _TESTS_IOACPIPLATFORMEXPERT_H_
+#define _TESTS_IOACPIPLATFORMEXPERT_H_
+
+#include "iokit.h"
+
+typedef UInt32 IOACPIAddressSpaceID;
+
+enum {
+    kIOACPIAddressSpaceIDSystemMemory       = 0,
+    kIOACPIAddressSpaceIDSystemIO           = 1,
+    kIOACPIAddressSpaceIDPCIConfiguration   = 2,
+    kIOACPIAddressSpaceIDEmbeddedController = 3,
+    kIOACPIAddressSpaceIDSMBus              = 4
+};
+
+enum {
+    kIOACPIAddressSpaceOpRead               = 0,
+    kIOACPIAddressSpaceOpWrite              = 1
+};
+
+union IOACPIAddress {
+    UInt64 addr64;
+    struct {
+        unsigned int offset     :16;
+        unsigned int function   :3;
+        unsigned int device     :5;
+        unsigned int bus        :8;
+        unsigned int segment    :16;
+        unsigned int reserved   :16;
+    } pci;
+};
+
+typedef IOReturn (*IOACPIAddressSpaceHandler)(UInt32 operation, IOACPIAddress address, UInt64 *value,
+                                              UInt32 bitWidth, UInt32 bitOffset, void *context);
+
+class IOACPIPlatformDevice;
+
+class IOACPIPlatformExpert : public OSObject
+{
+public:
+    virtual IOReturn registerAddressSpaceHandler(IOACPIPlatformDevice *device, IOACPIAddressSpaceID spaceID,
+                                                 IOACPIAddressSpaceHandler handler, void *context,
+                                                 IOOptionBits options) = 0;
+    virtual void unregisterAddressSpaceHandler(IOACPIPlatformDevice *device, IOACPIAddressSpaceID spaceID,
+                                               IOACPIAddressSpaceHandler handler, IOOptionBits options) = 0;
+};
+
+#endif /* _TESTS_IOACPIPLATFORMEXPERT_H_ */
@@ -0,0 +1,101 @@
+/*
+ * The few IOKit classes the kext's OS layer uses, for building it on a host.
+ * "Physical" addresses are host addresses: mapping a range hands the same
+ * address back, so a test can stand a buffer in for device memory, unless
+ * the test places mappings itself.
+ * kern/iokit.cpp implements them.
+ */
+
+#ifndef _TESTS_IOKIT_H_
+#define _TESTS_IOKIT_H_
+
+#include "xnu.h"
+
+typedef UInt32 IODirection;
+#define kIODirectionIn              1
+#define kIODirectionOut             2
+#define kIODirectionOutIn           (kIODirectionOut | kIODirectionIn)
+#define kIODirectionInOut           kIODirectionOutIn
+#define kIOMemoryDirectionInOut     kIODirectionInOut
+#define kIOMemoryMapperNone         0x00000800
+#define kIOMapInhibitCache          0x00000100
+
+extern task_t kernel_task;
+
+/* free() runs when the last reference goes; init() and free() are overridden as in the kernel */
+class OSObject
+{
+public:
+    OSObject() : retainCount(1) {}
+    virtual ~OSObject() {}
+    virtual bool init() { return true; }
+    void retain() const { __atomic_add_fetch(&retainCount, 1, __ATOMIC_RELAXED); }
+    void release() const;
+protected:
+    virtual void free() { delete this; }
+private:
+    mutable int retainCount;
+};
+
+#define OSDynamicCast(type, object) dynamic_cast<type *>(object)
+
+class OSData : public OSObject
+{
+public:
+    static OSData *withBytes(const void *bytes, unsigned int length);
+    static OSData *withBytesNoCopy(void *bytes, unsigned int length);
+    unsigned int getLength() const { return length; }
+    const void *getBytesNoCopy() const { return bytes; }
+    virtual ~OSData();
+private:
+    void *bytes;
+    unsigned int length;
+    bool owned;
+};
+
+class IOMemoryMap : public OSObject
+{
+public:
+    IOVirtualAddress getVirtualAddress() { return address; }
+    IOByteCount getLength() { return length; }
+    virtual ~IOMemoryMap();
+private:
+    friend class IOMemoryDescriptor;
+    IOVirtualAddress address;
+    IOByteCount length;
+};
+
+class IOMemoryDescriptor : public OSObject
+{
+public:
+    static IOMemoryDescriptor *withAddressRange(UInt64 address, UInt64 length, IOOptionBits options, task_t task);
+    IOMemoryMap *map(IOOptionBits options = 0);
+    IOByteCount readBytes(IOByteCount offset, void *bytes, IOByteCount length);
+    IOByteCount writeBytes(IOByteCount offset, const void *bytes, IOByteCount length);
+private:
+    UInt64 address;
+    UInt64 length;
+};
+
+class IORegistryPlane;
+extern const IORegistryPlane *gIODTPlane;
+
+/* Nothing is ever found: there is no device tree on a host */
+class IORegistryEntry : public OSObject
+{
+public:
+    static IORegistryEntry *fromPath(const char *path, const IORegistryPlane *plane = 0);
+    OSObject *getProperty(const char *key) const { return 0; }
+};
+
+/*
+ * Test controls: the number of mappings made and still mapped, the number
+ * of map() calls left before one fails (negative for never), and where
+ * map() puts a mapping (unset, at its physical address).
+ */
+extern int xnu_maps_made;
+extern int xnu_maps_live;
+extern int xnu_maps_fail_after;
+extern IOVirtualAddress (*xnu_map_address)(UInt64 address, UInt64 length);
+
+#endif /* _TESTS_IOKIT_H_ */
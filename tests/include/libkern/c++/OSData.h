@@ -0,0 +1,11 @@
+/*
+ * OSData, for kext sources built on a host; include/iokit.h has it.
+ */
+
+#ifndef _TESTS_LIBKERN_OSDATA_H_
+#define _TESTS_LIBKERN_OSDATA_H_
+
+#include "iokit.h"
+#include <libkern/c++/OSObject.h>
+
+#endif /* _TESTS_LIBKERN_OSDATA_H_ */
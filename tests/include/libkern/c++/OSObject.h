@@ -0,0 +1,23 @@
+/*
+ * OSObject's class macros, for kext classes built on a host. There is no
+ * runtime type information beyond C++'s own.
+ */
+
+#ifndef _TESTS_LIBKERN_OSOBJECT_H_
+#define _TESTS_LIBKERN_OSOBJECT_H_
+
+#include "iokit.h"
+
+#define OSDeclareDefaultStructors(className)        \
+    public:                                         \
+        className() {}                              \
+    protected:                                      \
+        virtual ~className() {}                     \
+    private:                                        \
+        typedef int className##Structors
+
+#define OSDefineMetaClassAndStructors(className, superclassName)
+#define OSTypeAlloc(type)           (new type)
+#define OSSafeReleaseNULL(object)   do { if (object) { (object)->release(); (object) = NULL; } } while (0)
+
+#endif /* _TESTS_LIBKERN_OSOBJECT_H_ */
@@ -0,0 +1,16 @@
+/*
+ * The booter's arguments, as far as the kext reads them.
+ */
+
+#ifndef _TESTS_PEXPERT_I386_BOOT_H_
+#define _TESTS_PEXPERT_I386_BOOT_H_
+
+#include "xnu.h"
+
+typedef struct boot_args {
+    UInt64 pciConfigSpaceBaseAddress;
+    UInt32 pciConfigSpaceStartBusNumber;
+    UInt32 pciConfigSpaceEndBusNumber;
+} boot_args;
+
+#endif /* _TESTS_PEXPERT_I386_BOOT_H_ */
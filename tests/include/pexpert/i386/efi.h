@@ -0,0 +1,15 @@
+/*
+ * EFI configuration table entries, as the booter publishes them.
+ */
+
+#ifndef _TESTS_PEXPERT_I386_EFI_H_
+#define _TESTS_PEXPERT_I386_EFI_H_
+
+#include "xnu.h"
+
+typedef UInt64 EFI_PHYSICAL_ADDRESS;
+typedef struct { UInt32 Data1; UInt16 Data2, Data3; UInt8 Data4[8]; } EFI_GUID;
+typedef struct { EFI_GUID VendorGuid; UInt32 VendorTable; } EFI_CONFIGURATION_TABLE_32;
+typedef struct { EFI_GUID VendorGuid; UInt64 VendorTable; } EFI_CONFIGURATION_TABLE_64;
+
+#endif /* _TESTS_PEXPERT_I386_EFI_H_ */
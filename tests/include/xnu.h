@@ -0,0 +1,254 @@
+/*
+ * The slice of the xnu KPI the kext uses, for building its sources on a
+ * host. Declarations follow the kernel's; kern/xnu.c implements them on
+ * pthreads. The IOKit/, libkern/, kern/ and mach/ headers next to this one
+ * all just include it.
+ */
+
+#ifndef _TESTS_XNU_H_
+#define _TESTS_XNU_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#ifndef KERNEL
+#include <stdio.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t     UInt8;
+typedef uint16_t    UInt16;
+typedef uint32_t    UInt32;
+typedef uint64_t    UInt64;
+typedef int8_t      SInt8;
+typedef int16_t     SInt16;
+typedef int32_t     SInt32;
+typedef int64_t     SInt64;
+typedef uint8_t     Boolean;
+typedef uint32_t    IOOptionBits;
+typedef uint64_t    IOByteCount;
+typedef uintptr_t   IOVirtualAddress;
+typedef uint64_t    IOPhysicalAddress;
+typedef int         kern_return_t;
+typedef int         boolean_t;
+typedef int         wait_result_t;
+typedef uint64_t    vm_offset_t;
+typedef uint64_t    vm_size_t;
+typedef uint64_t    addr64_t;
+
+#define PAGE_SIZE                   4096
+#define PAGE_MASK                   (PAGE_SIZE - 1)
+
+#define KERN_SUCCESS                0
+#define KERN_FAILURE                5
+#define KERN_OPERATION_TIMED_OUT    49
+
+/* IOReturn.h */
+typedef int IOReturn;
+#define iokit_common_err(e)         ((IOReturn)(0xe0000000 | (e)))
+#define kIOReturnSuccess            0
+#define kIOReturnError              iokit_common_err(0x2bc)
+#define kIOReturnNoMemory           iokit_common_err(0x2bd)
+#define kIOReturnNoResources        iokit_common_err(0x2be)
+#define kIOReturnNoDevice           iokit_common_err(0x2c0)
+#define kIOReturnNotPrivileged      iokit_common_err(0x2c1)
+#define kIOReturnBadArgument        iokit_common_err(0x2c2)
+#define kIOReturnExclusiveAccess    iokit_common_err(0x2c5)
+#define kIOReturnBadMessageID       iokit_common_err(0x2c6)
+#define kIOReturnUnsupported        iokit_common_err(0x2c7)
+#define kIOReturnIOError            iokit_common_err(0x2ca)
+#define kIOReturnCannotLock         iokit_common_err(0x2cc)
+#define kIOReturnBusy               iokit_common_err(0x2d5)
+#define kIOReturnTimeout            iokit_common_err(0x2d6)
+#define kIOReturnNotReady           iokit_common_err(0x2d8)
+#define kIOReturnMessageTooLarge    iokit_common_err(0x2e1)
+#define kIOReturnOverrun            iokit_common_err(0x2e4)
+#define kIOReturnAborted            iokit_common_err(0x2eb)
+#define kIOReturnNotPermitted       iokit_common_err(0x2e2)
+#define kIOReturnNotFound           iokit_common_err(0x2f0)
+
+/*
+ * Kernel code built with KERNEL gets the kernel's printf family rather than
+ * stdio.h, whose stdout and stderr acdarwin.h defines away.
+ */
+#ifdef KERNEL
+int printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+int snprintf(char *str, size_t size, const char *format, ...) __attribute__((format(printf, 3, 4)));
+int vsnprintf(char *str, size_t size, const char *format, va_list ap) __attribute__((format(printf, 3, 0)));
+#endif
+
+/* Memory */
+void *IOMalloc(vm_size_t size);
+void IOFree(void *address, vm_size_t size);
+void *IOMallocAligned(vm_size_t size, vm_offset_t alignment);
+void IOFreeAligned(void *address, vm_size_t size);
+
+/* Logging; IOLog output is kept quiet unless XNU_VERBOSE is set in the environment */
+void IOLog(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void kprintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void panic(const char *format, ...) __attribute__((noreturn, format(printf, 1, 2)));
+boolean_t PE_parse_boot_argn(const char *arg, void *value, int size);
+typedef struct PE_state {
+    boolean_t initialized;
+    void *bootArgs;                 /* a boot_args from pexpert/i386/boot.h; tests fill it in */
+} PE_state_t;
+extern PE_state_t PE_state;
+
+/* Sleeping locks */
+typedef struct _IOLock IOLock;
+IOLock *IOLockAlloc(void);
+void IOLockFree(IOLock *lock);
+void IOLockLock(IOLock *lock);
+bool IOLockTryLock(IOLock *lock);
+void IOLockUnlock(IOLock *lock);
+int IOLockSleep(IOLock *lock, void *event, UInt32 interType);
+int IOLockSleepDeadline(IOLock *lock, void *event, UInt64 deadline, UInt32 interType);
+void IOLockWakeup(IOLock *lock, void *event, bool oneThread);
+#define THREAD_UNINT                0
+#define THREAD_INTERRUPTIBLE        1
+#define THREAD_ABORTSAFE            2
+#define THREAD_AWAKENED             0
+#define THREAD_TIMED_OUT            1
+#define THREAD_INTERRUPTED          2
+#define THREAD_WAITING              -1
+
+/* Spin locks; "interrupts" are a per-thread flag that only the blocking checks look at */
+typedef struct _IOSimpleLock IOSimpleLock;
+typedef int IOInterruptState;
+IOSimpleLock *IOSimpleLockAlloc(void);
+void IOSimpleLockFree(IOSimpleLock *lock);
+void IOSimpleLockLock(IOSimpleLock *lock);
+bool IOSimpleLockTryLock(IOSimpleLock *lock);
+void IOSimpleLockUnlock(IOSimpleLock *lock);
+IOInterruptState IOSimpleLockLockDisableInterrupt(IOSimpleLock *lock);
+void IOSimpleLockUnlockEnableInterrupt(IOSimpleLock *lock, IOInterruptState state);
+
+/* Time, in nanosecond "absolute time" units */
+#define kNanosecondScale            1
+#define kMicrosecondScale           1000
+#define kMillisecondScale           1000000
+#define kSecondScale                1000000000
+#define NSEC_PER_USEC               1000ULL
+#define NSEC_PER_MSEC               1000000ULL
+#define NSEC_PER_SEC                1000000000ULL
+typedef struct { uint32_t numer, denom; } mach_timebase_info_data_t;
+uint64_t mach_absolute_time(void);
+void absolutetime_to_nanoseconds(uint64_t abstime, uint64_t *result);
+void nanoseconds_to_absolutetime(uint64_t nanoseconds, uint64_t *result);
+void clock_interval_to_deadline(uint32_t interval, uint32_t scale_factor, uint64_t *result);
+void clock_interval_to_absolutetime_interval(uint32_t interval, uint32_t scale_factor, uint64_t *result);
+void clock_timebase_info(mach_timebase_info_data_t *info);
+void clock_get_uptime(uint64_t *result);
+void IOSleep(unsigned milliseconds);
+void IOSleepWithLeeway(unsigned milliseconds, unsigned leeway);
+void IODelay(unsigned microseconds);
+
+/* Atomics */
+SInt32 OSAddAtomic(SInt32 amount, volatile SInt32 *address);
+SInt64 OSAddAtomic64(SInt64 amount, volatile SInt64 *address);
+SInt32 OSIncrementAtomic(volatile SInt32 *address);
+SInt32 OSDecrementAtomic(volatile SInt32 *address);
+SInt64 OSIncrementAtomic64(volatile SInt64 *address);
+SInt64 OSDecrementAtomic64(volatile SInt64 *address);
+Boolean OSCompareAndSwap(UInt32 oldValue, UInt32 newValue, volatile UInt32 *address);
+Boolean OSCompareAndSwap64(UInt64 oldValue, UInt64 newValue, volatile UInt64 *address);
+Boolean OSCompareAndSwapPtr(void *oldValue, void *newValue, void * volatile *address);
+UInt32 OSBitOrAtomic(UInt32 mask, volatile UInt32 *address);
+UInt32 OSBitAndAtomic(UInt32 mask, volatile UInt32 *address);
+void OSMemoryBarrier(void);
+
+/* Threads and waits */
+typedef struct _thread *thread_t;
+typedef void *event_t;
+typedef void (*thread_continue_t)(void *parameter, wait_result_t wresult);
+kern_return_t kernel_thread_start(thread_continue_t continuation, void *parameter, thread_t *new_thread);
+void thread_deallocate(thread_t thread);
+void thread_terminate(thread_t thread);
+thread_t current_thread(void);
+uint64_t thread_tid(thread_t thread);
+wait_result_t assert_wait(event_t event, int interruptible);
+wait_result_t assert_wait_timeout(event_t event, int interruptible, uint32_t interval, uint32_t scale_factor);
+wait_result_t assert_wait_deadline(event_t event, int interruptible, uint64_t deadline);
+wait_result_t thread_block(thread_continue_t continuation);
+kern_return_t thread_wakeup_prim(event_t event, boolean_t one_thread, wait_result_t result);
+#define thread_wakeup(e)            thread_wakeup_prim((e), 0, THREAD_AWAKENED)
+#define thread_wakeup_one(e)        thread_wakeup_prim((e), 1, THREAD_AWAKENED)
+#define THREAD_CONTINUE_NULL        ((thread_continue_t)0)
+
+/* Thread calls */
+typedef struct _thread_call *thread_call_t;
+typedef void *thread_call_param_t;
+typedef void (*thread_call_func_t)(thread_call_param_t param0, thread_call_param_t param1);
+thread_call_t thread_call_allocate(thread_call_func_t func, thread_call_param_t param0);
+boolean_t thread_call_enter(thread_call_t call);
+boolean_t thread_call_enter1(thread_call_t call, thread_call_param_t param1);
+boolean_t thread_call_enter_delayed(thread_call_t call, uint64_t deadline);
+boolean_t thread_call_cancel(thread_call_t call);
+boolean_t thread_call_cancel_wait(thread_call_t call);
+boolean_t thread_call_free(thread_call_t call);
+
+/* Semaphores */
+typedef struct _semaphore *semaphore_t;
+typedef int task_t;
+#define SYNC_POLICY_FIFO            0
+#define current_task()              0
+#define KERN_ABORTED                14
+typedef struct { unsigned int tv_sec; int tv_nsec; } mach_timespec_t;
+kern_return_t semaphore_create(task_t task, semaphore_t *semaphore, int policy, int value);
+kern_return_t semaphore_destroy(task_t task, semaphore_t semaphore);
+kern_return_t semaphore_signal(semaphore_t semaphore);
+kern_return_t semaphore_wait(semaphore_t semaphore);
+kern_return_t semaphore_timedwait(semaphore_t semaphore, mach_timespec_t wait_time);
+
+/* CPUs. Every host thread counts as its own CPU, numbered as it first asks. */
+#define XNU_MAX_CPUS                64
+int cpu_number(void);
+unsigned int ml_get_max_cpus(void);
+boolean_t ml_get_interrupts_enabled(void);
+boolean_t ml_set_interrupts_enabled(boolean_t enable);
+boolean_t ml_at_interrupt_context(void);
+
+/* Physical memory is host memory; port I/O goes to the test's handlers below */
+unsigned int ml_phys_read_byte_64(addr64_t paddr);
+unsigned int ml_phys_read_half_64(addr64_t paddr);
+unsigned int ml_phys_read_word_64(addr64_t paddr);
+unsigned long long ml_phys_read_double_64(addr64_t paddr);
+void ml_phys_write_byte_64(addr64_t paddr, unsigned int data);
+void ml_phys_write_half_64(addr64_t paddr, unsigned int data);
+void ml_phys_write_word_64(addr64_t paddr, unsigned int data);
+void ml_phys_write_double_64(addr64_t paddr, unsigned long long data);
+vm_offset_t ml_vtophys(vm_offset_t vaddr);
+uint8_t ml_port_io_read8(uint16_t ioport);
+uint16_t ml_port_io_read16(uint16_t ioport);
+uint32_t ml_port_io_read32(uint16_t ioport);
+void ml_port_io_write8(uint16_t ioport, uint8_t val);
+void ml_port_io_write16(uint16_t ioport, uint16_t val);
+void ml_port_io_write32(uint16_t ioport, uint32_t val);
+
+/*
+ * Test controls. The calling thread becomes CPU cpu; xnu_max_cpus is what
+ * ml_get_max_cpus reports (4 unless a test changes it before first use).
+ * Anything that can block panics when called with interrupts off, inside
+ * a simple lock or in interrupt context, as it would in the kernel.
+ */
+extern unsigned int xnu_max_cpus;
+extern int xnu_allocations_live;            /* IOMalloc and IOMallocAligned blocks not yet freed */
+void xnu_set_cpu_number(int cpu);
+void xnu_set_interrupt_context(boolean_t interrupt);
+
+/* Port I/O of width bytes; reads float high and writes go nowhere unless a test takes them */
+extern uint32_t (*xnu_port_read)(uint16_t port, int width);
+extern void (*xnu_port_write)(uint16_t port, uint32_t value, int width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TESTS_XNU_H_ */
@@ -0,0 +1,172 @@
+/*
+ * The shared interpreter: which methods are detected as parallel, four
+ * threads running them at once with every result checked (field writes
+ * that read-modify-write the same dword, and methods that upgrade to the
+ * exclusive interpreter part way through), and the time a stall-bound
+ * method takes with the interpreter exclusive and shared.
+ */
+
+#include "test.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+
+extern "C" {
+#include "acnamesp.h"
+}
+
+#define kBase       0x60000000UL    /* interp.py */
+#define kThreads    4
+
+static pthread_barrier_t gStart;
+static volatile int gRunning;
+static int gIterations;
+static int gRounds;
+static int gStall;
+
+static UINT64 Evaluate(const char *path, int count, UINT64 a0, UINT64 a1)
+{
+    ACPI_OBJECT args[2], *result;
+    ACPI_OBJECT_LIST list = { (UINT32)count, args };
+    ACPI_BUFFER buffer = { ACPI_ALLOCATE_BUFFER, NULL };
+    UINT64 value;
+
+    args[0].Type = args[1].Type = ACPI_TYPE_INTEGER;
+    args[0].Integer.Value = a0;
+    args[1].Integer.Value = a1;
+    CHECK_STATUS(AcpiEvaluateObject(NULL, (char *)path, &list, &buffer));
+    result = (ACPI_OBJECT *)buffer.Pointer;
+    CHECK(result && result->Type == ACPI_TYPE_INTEGER, "%s returned no integer", path);
+    value = result->Integer.Value;
+    AcpiOsFree(result);
+    return value;
+}
+
+static bool IsParallel(const char *path)
+{
+    ACPI_HANDLE handle;
+    ACPI_OPERAND_OBJECT *method;
+
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)path, &handle));
+    method = AcpiNsGetAttachedObject(AcpiNsValidateHandle(handle));
+    CHECK(method && method->Common.Type == ACPI_TYPE_METHOD, "%s is not a method", path);
+    return (method->Method.InfoFlags & ACPI_METHOD_PARALLEL) != 0;
+}
+
+/* Each round is one call of Tn; it returns its own counter, which only it changes */
+static void *Worker(void *context)
+{
+    int t = (int)(intptr_t)context;
+    char path[8];
+    UINT64 count = *(volatile UINT32 *)(kBase + 0x100 * (t + 1));
+    UINT64 r;
+
+    snprintf(path, sizeof(path), "\\T%d", t);
+    pthread_barrier_wait(&gStart);
+    for (int i = 0; i < gRounds; i++) {
+        r = Evaluate(path, 2, gIterations, gStall);
+        CHECK(!(r & 0x80000000), "%s read back a byte another thread clobbered at %llu", path,
+              (unsigned long long)(r & 0x7FFFFFFF));
+        count += gIterations;
+        CHECK(r == count, "%s counted %llu, expected %llu", path, (unsigned long long)r, (unsigned long long)count);
+    }
+
+    /* Un stores to its field, then calls NSET, which is not parallel */
+    snprintf(path, sizeof(path), "\\U%d", t);
+    for (int i = 1; i <= gRounds; i++) {
+        r = Evaluate(path, 1, i * kThreads + t, 0);
+        CHECK(r == 2 * (UINT64)(i * kThreads + t), "%s(%d) returned %llu", path, i * kThreads + t, (unsigned long long)r);
+    }
+    __atomic_sub_fetch(&gRunning, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/* Run the workers; returns the time taken, and the most threads seen holding the interpreter shared */
+static double Run(int iterations, int rounds, int stall, UINT32 *maxReaders)
+{
+    pthread_t threads[kThreads];
+    struct timespec start, end;
+
+    gIterations = iterations;
+    gRounds = rounds;
+    gStall = stall;
+    gRunning = kThreads;
+    *maxReaders = 0;
+    pthread_barrier_init(&gStart, NULL, kThreads + 1);
+    for (int t = 0; t < kThreads; t++) {
+        pthread_create(&threads[t], NULL, Worker, (void *)(intptr_t)t);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_barrier_wait(&gStart);
+    while (__atomic_load_n(&gRunning, __ATOMIC_ACQUIRE)) {
+        UINT32 readers = __atomic_load_n(&AcpiGbl_InterpreterReaders, __ATOMIC_RELAXED);
+        if (readers > *maxReaders) {
+            *maxReaders = readers;
+        }
+        sched_yield();
+    }
+    for (int t = 0; t < kThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_barrier_destroy(&gStart);
+
+    CHECK(AcpiGbl_InterpreterReaders == 0 && AcpiGbl_InterpreterHolderCount == 0,
+          "%u readers and %u holders left", AcpiGbl_InterpreterReaders, AcpiGbl_InterpreterHolderCount);
+    return (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+int main()
+{
+    void *memory;
+    UINT32 readers;
+    double exclusive, shared;
+
+    memory = mmap((void *)kBase, 0x1000, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    CHECK(memory == (void *)kBase, "can't map the regions' memory at %#lx", kBase);
+
+    /* Off by default, and methods are classified as the table loads */
+    CHECK(!AcpiGbl_ParallelMethods, "parallel methods are on by default");
+    AcpiGbl_ParallelMethods = TRUE;
+    TestLoadTable("interp.aml", 1);
+    CHECK_STATUS(AcpiInstallAddressSpaceHandler(ACPI_ROOT_OBJECT, ACPI_ADR_SPACE_SYSTEM_MEMORY,
+                                                ACPI_DEFAULT_HANDLER, NULL, NULL));
+
+    /* Detection */
+    for (int t = 0; t < kThreads; t++) {
+        char path[8];
+        snprintf(path, sizeof(path), "\\T%d", t);
+        CHECK(IsParallel(path), "%s not detected as parallel", path);
+        snprintf(path, sizeof(path), "\\U%d", t);
+        CHECK(IsParallel(path), "%s not detected as parallel", path);
+    }
+    CHECK(IsParallel("\\DIVF"), "a field unit remainder made DIVF serial");
+    CHECK(IsParallel("\\RNAM"), "reading a Name made RNAM serial");
+    CHECK(!IsParallel("\\NSET"), "NSET stores to a Name");
+    CHECK(!IsParallel("\\SARG"), "SARG stores to an Arg");
+    CHECK(!IsParallel("\\NTFY"), "NTFY notifies");
+    CHECK(!IsParallel("\\MKNM"), "MKNM creates a Name");
+    CHECK(Evaluate("\\DIVF", 1, 23, 0) == 3, "Divide with a field unit remainder");
+    CHECK(*(volatile UINT32 *)(kBase + 0x100) == 2, "Divide's remainder did not reach O0");
+    *(volatile UINT32 *)(kBase + 0x100) = 0;
+
+    /* Correctness, as fast as the threads can go */
+    Run(200, 50, 0, &readers);
+    printf("interp: %d threads x 50 calls x 200 field round trips, results checked\n", kThreads);
+
+    /* Exclusive against shared, for a method that stalls on each iteration */
+    AcpiGbl_ParallelMethods = FALSE;
+    exclusive = Run(10, 10, 1, &readers);
+    CHECK(readers == 0, "%u shared holders with parallel methods off", readers);
+
+    AcpiGbl_ParallelMethods = TRUE;
+    shared = Run(10, 10, 1, &readers);
+    CHECK(readers > 1, "the threads never held the interpreter shared together");
+    printf("interp: stall-bound methods on %d threads: exclusive %.1f ms, shared %.1f ms (%.2fx), up to %u at once\n",
+           kThreads, exclusive, shared, exclusive / shared, readers);
+
+    CHECK_STATUS(AcpiTerminate());
+    printf("interp: ok\n");
+    return 0;
+}
@@ -0,0 +1,47 @@
+#
+# Methods for the shared interpreter. Four threads each run Tn, which
+# writes its byte of one SystemMemory dword (so every write is a read-
+# modify-write of bytes the other threads own), reads it back, and counts
+# in a dword region of its own; Un also calls a method that is not
+# parallel. The rest are there for the parallel method detection.
+#
+
+import sys
+from aml import *
+
+BASE = 0x60000000       # interp.cpp maps host memory here
+STALL = 50
+
+
+def worker(t):
+    v = and_(local(0), integer(0xFF))
+    body = store(integer(0), local(0))
+    body += while_(lless(local(0), arg(0)),
+                   store(v, path('F%d' % t)) +
+                   store(add(path('O%d' % t), integer(1)), path('O%d' % t)) +
+                   if_(lnot(lequal(path('F%d' % t), v)), ret(or_(integer(0x80000000), local(0)))) +
+                   if_(arg(1), stall(STALL)) +
+                   increment(local(0)))
+    body += ret(path('O%d' % t))
+    return method('T%d' % t, 2, body)
+
+
+sb = opregion('SHRD', 0, BASE, 4)
+sb += field('SHRD', 0x03, [('F0', 8), ('F1', 8), ('F2', 8), ('F3', 8)])
+for t in range(4):
+    sb += opregion('OWN%d' % t, 0, BASE + 0x100 * (t + 1), 4)
+    sb += field('OWN%d' % t, 0x03, [('O%d' % t, 32)])
+    sb += worker(t)
+    sb += method('U%d' % t, 1, store(arg(0), path('O%d' % t)) + ret(add(call('NSET', arg(0)), path('O%d' % t))))
+
+sb += name('NAM0', integer(0))
+# Not parallel: stores to a Name, to an Arg, notifies, creates a Name
+sb += method('NSET', 1, store(arg(0), path('NAM0')) + ret(path('NAM0')))
+sb += method('SARG', 1, store(integer(1), arg(0)) + ret(arg(0)))
+sb += method('NTFY', 0, notify(path('\\_SB'), integer(0x80)))
+sb += method('MKNM', 0, name('TMP0', integer(1)) + ret(path('TMP0')))
+# Parallel: a field unit target through Divide's remainder, and a read of a Name
+sb += method('DIVF', 1, b'\x78' + arg(0) + integer(7) + path('O0') + local(1) + ret(local(1)))
+sb += method('RNAM', 0, ret(path('NAM0')))
+
+open(sys.argv[1], 'wb').write(table('DSDT', scope('\\_SB', b'') + sb))
@@ -0,0 +1,95 @@
+/*
+ * IOKit classes on the host; see include/iokit.h.
+ */
+
+#include "iokit.h"
+
+task_t kernel_task;
+const IORegistryPlane *gIODTPlane;
+PE_state_t PE_state;
+
+int xnu_maps_made;
+int xnu_maps_live;
+int xnu_maps_fail_after = -1;
+IOVirtualAddress (*xnu_map_address)(UInt64 address, UInt64 length);
+
+void OSObject::release() const
+{
+    if (__atomic_sub_fetch(&retainCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        const_cast<OSObject *>(this)->free();
+    }
+}
+
+OSData *OSData::withBytes(const void *bytes, unsigned int length)
+{
+    OSData *data = new OSData;
+
+    data->bytes = malloc(length);
+    data->length = length;
+    data->owned = true;
+    memcpy(data->bytes, bytes, length);
+    return data;
+}
+
+OSData *OSData::withBytesNoCopy(void *bytes, unsigned int length)
+{
+    OSData *data = new OSData;
+
+    data->bytes = bytes;
+    data->length = length;
+    data->owned = false;
+    return data;
+}
+
+OSData::~OSData()
+{
+    if (owned) {
+        ::free(bytes);
+    }
+}
+
+IOMemoryMap::~IOMemoryMap()
+{
+    __atomic_sub_fetch(&xnu_maps_live, 1, __ATOMIC_RELAXED);
+}
+
+IOMemoryDescriptor *IOMemoryDescriptor::withAddressRange(UInt64 address, UInt64 length, IOOptionBits options,
+                                                         task_t task)
+{
+    IOMemoryDescriptor *desc = new IOMemoryDescriptor;
+
+    desc->address = address;
+    desc->length = length;
+    return desc;
+}
+
+IOMemoryMap *IOMemoryDescriptor::map(IOOptionBits options)
+{
+    if (xnu_maps_fail_after >= 0 && __atomic_fetch_sub(&xnu_maps_fail_after, 1, __ATOMIC_RELAXED) == 0) {
+        return NULL;
+    }
+
+    IOMemoryMap *map = new IOMemoryMap;
+    map->address = xnu_map_address ? xnu_map_address(address, length) : (IOVirtualAddress)address;
+    map->length = length;
+    __atomic_add_fetch(&xnu_maps_made, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&xnu_maps_live, 1, __ATOMIC_RELAXED);
+    return map;
+}
+
+IOByteCount IOMemoryDescriptor::readBytes(IOByteCount offset, void *bytes, IOByteCount length)
+{
+    memcpy(bytes, (const UInt8 *)(uintptr_t)address + offset, length);
+    return length;
+}
+
+IOByteCount IOMemoryDescriptor::writeBytes(IOByteCount offset, const void *bytes, IOByteCount length)
+{
+    memcpy((UInt8 *)(uintptr_t)address + offset, bytes, length);
+    return length;
+}
+
+IORegistryEntry *IORegistryEntry::fromPath(const char *path, const IORegistryPlane *plane)
+{
+    return NULL;
+}
@@ -0,0 +1,880 @@
+/*
+ * xnu KPI on pthreads; see include/xnu.h.
+ */
+
+#define _GNU_SOURCE
+#include "xnu.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+unsigned int xnu_max_cpus = 4;
+
+static __thread int tCPU = -1;
+static __thread int tInterruptsOff;
+static __thread int tInterruptContext;
+static __thread int tSimpleLocks;
+static int gNextCPU;
+
+/* Anything that may block checks this first, as the kernel would assert */
+static void MayBlock(const char *what)
+{
+    if (tInterruptsOff || tSimpleLocks || tInterruptContext) {
+        panic("%s would block: interrupts %s, %d simple lock(s) held%s", what,
+              tInterruptsOff ? "off" : "on", tSimpleLocks, tInterruptContext ? ", in interrupt context" : "");
+    }
+}
+
+#pragma mark Memory and logging
+
+int xnu_allocations_live;
+
+void *IOMalloc(vm_size_t size)
+{
+    MayBlock("IOMalloc");
+    __atomic_add_fetch(&xnu_allocations_live, 1, __ATOMIC_RELAXED);
+    return malloc(size);
+}
+
+void IOFree(void *address, vm_size_t size)
+{
+    if (address) {
+        __atomic_sub_fetch(&xnu_allocations_live, 1, __ATOMIC_RELAXED);
+    }
+    free(address);
+}
+
+void *IOMallocAligned(vm_size_t size, vm_offset_t alignment)
+{
+    void *p;
+
+    MayBlock("IOMallocAligned");
+    if (posix_memalign(&p, alignment < sizeof(void *) ? sizeof(void *) : alignment, size)) {
+        return NULL;
+    }
+    __atomic_add_fetch(&xnu_allocations_live, 1, __ATOMIC_RELAXED);
+    return p;
+}
+
+void IOFreeAligned(void *address, vm_size_t size)
+{
+    if (address) {
+        __atomic_sub_fetch(&xnu_allocations_live, 1, __ATOMIC_RELAXED);
+    }
+    free(address);
+}
+
+void IOLog(const char *format, ...)
+{
+    va_list ap;
+
+    if (!getenv("XNU_VERBOSE")) {
+        return;
+    }
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+}
+
+void kprintf(const char *format, ...)
+{
+    va_list ap;
+
+    if (!getenv("XNU_VERBOSE")) {
+        return;
+    }
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+}
+
+void panic(const char *format, ...)
+{
+    va_list ap;
+
+    fprintf(stderr, "panic: ");
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fprintf(stderr, "\n");
+    abort();
+}
+
+/* XNU_BOOT_ARGS="name=value -flag ...": numbers only, like most callers */
+boolean_t PE_parse_boot_argn(const char *arg, void *value, int size)
+{
+    const char *args = getenv("XNU_BOOT_ARGS");
+    size_t len = strlen(arg);
+
+    for (const char *p = args; p && *p; ) {
+        while (*p == ' ') {
+            p++;
+        }
+        if (!strncmp(p, arg, len) && (p[len] == '=' || p[len] == ' ' || !p[len])) {
+            unsigned long long v = p[len] == '=' ? strtoull(p + len + 1, NULL, 0) : 1;
+            memcpy(value, &v, size < (int)sizeof(v) ? size : sizeof(v));
+            return 1;
+        }
+        p = strchr(p, ' ');
+    }
+    return 0;
+}
+
+#pragma mark CPUs
+
+int cpu_number(void)
+{
+    if (tCPU < 0) {
+        tCPU = __atomic_fetch_add(&gNextCPU, 1, __ATOMIC_RELAXED) % xnu_max_cpus;
+    }
+    return tCPU;
+}
+
+void xnu_set_cpu_number(int cpu)
+{
+    tCPU = cpu;
+}
+
+unsigned int ml_get_max_cpus(void)
+{
+    return xnu_max_cpus;
+}
+
+boolean_t ml_get_interrupts_enabled(void)
+{
+    return !tInterruptsOff;
+}
+
+boolean_t ml_set_interrupts_enabled(boolean_t enable)
+{
+    boolean_t was = !tInterruptsOff;
+
+    tInterruptsOff = !enable;
+    return was;
+}
+
+boolean_t ml_at_interrupt_context(void)
+{
+    return tInterruptContext;
+}
+
+void xnu_set_interrupt_context(boolean_t interrupt)
+{
+    tInterruptContext = interrupt;
+    tInterruptsOff = interrupt;
+}
+
+#pragma mark Physical memory and port I/O
+
+uint32_t (*xnu_port_read)(uint16_t port, int width);
+void (*xnu_port_write)(uint16_t port, uint32_t value, int width);
+
+unsigned int ml_phys_read_byte_64(addr64_t paddr)
+{
+    return *(volatile uint8_t *)(uintptr_t)paddr;
+}
+
+unsigned int ml_phys_read_half_64(addr64_t paddr)
+{
+    return *(volatile uint16_t *)(uintptr_t)paddr;
+}
+
+unsigned int ml_phys_read_word_64(addr64_t paddr)
+{
+    return *(volatile uint32_t *)(uintptr_t)paddr;
+}
+
+unsigned long long ml_phys_read_double_64(addr64_t paddr)
+{
+    return *(volatile uint64_t *)(uintptr_t)paddr;
+}
+
+void ml_phys_write_byte_64(addr64_t paddr, unsigned int data)
+{
+    *(volatile uint8_t *)(uintptr_t)paddr = (uint8_t)data;
+}
+
+void ml_phys_write_half_64(addr64_t paddr, unsigned int data)
+{
+    *(volatile uint16_t *)(uintptr_t)paddr = (uint16_t)data;
+}
+
+void ml_phys_write_word_64(addr64_t paddr, unsigned int data)
+{
+    *(volatile uint32_t *)(uintptr_t)paddr = data;
+}
+
+void ml_phys_write_double_64(addr64_t paddr, unsigned long long data)
+{
+    *(volatile uint64_t *)(uintptr_t)paddr = data;
+}
+
+vm_offset_t ml_vtophys(vm_offset_t vaddr)
+{
+    return vaddr;
+}
+
+static uint32_t PortRead(uint16_t port, int width)
+{
+    return xnu_port_read ? xnu_port_read(port, width) : 0xFFFFFFFF;
+}
+
+static void PortWrite(uint16_t port, uint32_t value, int width)
+{
+    if (xnu_port_write) {
+        xnu_port_write(port, value, width);
+    }
+}
+
+uint8_t ml_port_io_read8(uint16_t ioport)
+{
+    return (uint8_t)PortRead(ioport, 1);
+}
+
+uint16_t ml_port_io_read16(uint16_t ioport)
+{
+    return (uint16_t)PortRead(ioport, 2);
+}
+
+uint32_t ml_port_io_read32(uint16_t ioport)
+{
+    return PortRead(ioport, 4);
+}
+
+void ml_port_io_write8(uint16_t ioport, uint8_t val)
+{
+    PortWrite(ioport, val, 1);
+}
+
+void ml_port_io_write16(uint16_t ioport, uint16_t val)
+{
+    PortWrite(ioport, val, 2);
+}
+
+void ml_port_io_write32(uint16_t ioport, uint32_t val)
+{
+    PortWrite(ioport, val, 4);
+}
+
+#pragma mark Time
+
+uint64_t mach_absolute_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void absolutetime_to_nanoseconds(uint64_t abstime, uint64_t *result)
+{
+    *result = abstime;
+}
+
+void nanoseconds_to_absolutetime(uint64_t nanoseconds, uint64_t *result)
+{
+    *result = nanoseconds;
+}
+
+void clock_interval_to_absolutetime_interval(uint32_t interval, uint32_t scale_factor, uint64_t *result)
+{
+    *result = (uint64_t)interval * scale_factor;
+}
+
+void clock_interval_to_deadline(uint32_t interval, uint32_t scale_factor, uint64_t *result)
+{
+    *result = mach_absolute_time() + (uint64_t)interval * scale_factor;
+}
+
+void clock_timebase_info(mach_timebase_info_data_t *info)
+{
+    info->numer = info->denom = 1;
+}
+
+void clock_get_uptime(uint64_t *result)
+{
+    *result = mach_absolute_time();
+}
+
+/* Timed waits go by CLOCK_MONOTONIC, like mach_absolute_time */
+static void InitCond(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void SleepNS(uint64_t ns)
+{
+    struct timespec ts = { (time_t)(ns / NSEC_PER_SEC), (long)(ns % NSEC_PER_SEC) };
+
+    while (nanosleep(&ts, &ts) && errno == EINTR) {
+    }
+}
+
+void IOSleep(unsigned milliseconds)
+{
+    MayBlock("IOSleep");
+    SleepNS(milliseconds * NSEC_PER_MSEC);
+}
+
+void IOSleepWithLeeway(unsigned milliseconds, unsigned leeway)
+{
+    IOSleep(milliseconds);
+}
+
+void IODelay(unsigned microseconds)
+{
+    uint64_t end = mach_absolute_time() + microseconds * NSEC_PER_USEC;
+
+    while (mach_absolute_time() < end) {
+    }
+}
+
+#pragma mark Atomics
+
+SInt32 OSAddAtomic(SInt32 amount, volatile SInt32 *address)
+{
+    return __atomic_fetch_add(address, amount, __ATOMIC_SEQ_CST);
+}
+
+SInt64 OSAddAtomic64(SInt64 amount, volatile SInt64 *address)
+{
+    return __atomic_fetch_add(address, amount, __ATOMIC_SEQ_CST);
+}
+
+SInt32 OSIncrementAtomic(volatile SInt32 *address)
+{
+    return OSAddAtomic(1, address);
+}
+
+SInt32 OSDecrementAtomic(volatile SInt32 *address)
+{
+    return OSAddAtomic(-1, address);
+}
+
+SInt64 OSIncrementAtomic64(volatile SInt64 *address)
+{
+    return OSAddAtomic64(1, address);
+}
+
+SInt64 OSDecrementAtomic64(volatile SInt64 *address)
+{
+    return OSAddAtomic64(-1, address);
+}
+
+Boolean OSCompareAndSwap(UInt32 oldValue, UInt32 newValue, volatile UInt32 *address)
+{
+    return __atomic_compare_exchange_n(address, &oldValue, newValue, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+Boolean OSCompareAndSwap64(UInt64 oldValue, UInt64 newValue, volatile UInt64 *address)
+{
+    return __atomic_compare_exchange_n(address, &oldValue, newValue, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+Boolean OSCompareAndSwapPtr(void *oldValue, void *newValue, void * volatile *address)
+{
+    return __atomic_compare_exchange_n(address, &oldValue, newValue, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+UInt32 OSBitOrAtomic(UInt32 mask, volatile UInt32 *address)
+{
+    return __atomic_fetch_or(address, mask, __ATOMIC_SEQ_CST);
+}
+
+UInt32 OSBitAndAtomic(UInt32 mask, volatile UInt32 *address)
+{
+    return __atomic_fetch_and(address, mask, __ATOMIC_SEQ_CST);
+}
+
+void OSMemoryBarrier(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#pragma mark Waits
+
+/*
+ * One wait queue for everything, as small as it can be: a thread asserts a
+ * wait on an event, then blocks until a wakeup on that event or its deadline.
+ */
+struct _thread {
+    pthread_t pthread;
+    thread_continue_t continuation;
+    void *parameter;
+    uint64_t tid;
+    int refs;
+    event_t event;                  /* asserted wait, or NULL */
+    uint64_t deadline;              /* 0 for none */
+    wait_result_t result;
+    pthread_cond_t cond;
+    struct _thread *next;           /* on gWaiters */
+};
+
+static pthread_mutex_t gWaitLock = PTHREAD_MUTEX_INITIALIZER;
+static struct _thread *gWaiters;
+static uint64_t gNextTid = 1;
+static __thread struct _thread *tThread;
+
+thread_t current_thread(void)
+{
+    if (!tThread) {
+        tThread = calloc(1, sizeof(*tThread));
+        tThread->pthread = pthread_self();
+        tThread->tid = __atomic_fetch_add(&gNextTid, 1, __ATOMIC_RELAXED);
+        tThread->refs = 1;
+        InitCond(&tThread->cond);
+    }
+    return tThread;
+}
+
+uint64_t thread_tid(thread_t thread)
+{
+    return thread->tid;
+}
+
+wait_result_t assert_wait_deadline(event_t event, int interruptible, uint64_t deadline)
+{
+    thread_t self = current_thread();
+
+    pthread_mutex_lock(&gWaitLock);
+    self->event = event;
+    self->deadline = deadline;
+    self->result = THREAD_WAITING;
+    self->next = gWaiters;
+    gWaiters = self;
+    pthread_mutex_unlock(&gWaitLock);
+    return THREAD_WAITING;
+}
+
+wait_result_t assert_wait(event_t event, int interruptible)
+{
+    return assert_wait_deadline(event, interruptible, 0);
+}
+
+wait_result_t assert_wait_timeout(event_t event, int interruptible, uint32_t interval, uint32_t scale_factor)
+{
+    uint64_t deadline;
+
+    clock_interval_to_deadline(interval, scale_factor, &deadline);
+    return assert_wait_deadline(event, interruptible, deadline);
+}
+
+static void Dequeue(thread_t thread)
+{
+    for (struct _thread **p = &gWaiters; *p; p = &(*p)->next) {
+        if (*p == thread) {
+            *p = thread->next;
+            break;
+        }
+    }
+}
+
+wait_result_t thread_block(thread_continue_t continuation)
+{
+    thread_t self = current_thread();
+    wait_result_t result;
+
+    MayBlock("thread_block");
+    pthread_mutex_lock(&gWaitLock);
+    while (self->result == THREAD_WAITING) {
+        if (!self->deadline) {
+            pthread_cond_wait(&self->cond, &gWaitLock);
+            continue;
+        }
+        uint64_t now = mach_absolute_time();
+        if (now >= self->deadline) {
+            Dequeue(self);
+            self->result = THREAD_TIMED_OUT;
+            break;
+        }
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t at = (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec + (self->deadline - now);
+        ts.tv_sec = at / NSEC_PER_SEC;
+        ts.tv_nsec = at % NSEC_PER_SEC;
+        pthread_cond_timedwait(&self->cond, &gWaitLock, &ts);
+    }
+    result = self->result;
+    self->event = NULL;
+    pthread_mutex_unlock(&gWaitLock);
+
+    if (continuation) {
+        continuation(self->parameter, result);
+        thread_terminate(self);
+    }
+    return result;
+}
+
+kern_return_t thread_wakeup_prim(event_t event, boolean_t one_thread, wait_result_t result)
+{
+    kern_return_t ret = KERN_FAILURE;
+
+    pthread_mutex_lock(&gWaitLock);
+    for (struct _thread **p = &gWaiters; *p; ) {
+        struct _thread *t = *p;
+        if (t->event != event) {
+            p = &t->next;
+            continue;
+        }
+        *p = t->next;
+        t->result = result;
+        pthread_cond_signal(&t->cond);
+        ret = KERN_SUCCESS;
+        if (one_thread) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&gWaitLock);
+    return ret;
+}
+
+#pragma mark Threads
+
+static void *ThreadMain(void *arg)
+{
+    struct _thread *thread = arg;
+
+    tThread = thread;
+    thread->continuation(thread->parameter, THREAD_AWAKENED);
+    thread_terminate(thread);
+    return NULL;
+}
+
+kern_return_t kernel_thread_start(thread_continue_t continuation, void *parameter, thread_t *new_thread)
+{
+    struct _thread *thread = calloc(1, sizeof(*thread));
+
+    thread->continuation = continuation;
+    thread->parameter = parameter;
+    thread->tid = __atomic_fetch_add(&gNextTid, 1, __ATOMIC_RELAXED);
+    thread->refs = 2;               /* the thread's own, and the caller's */
+    InitCond(&thread->cond);
+    if (pthread_create(&thread->pthread, NULL, ThreadMain, thread)) {
+        free(thread);
+        return KERN_FAILURE;
+    }
+    pthread_detach(thread->pthread);
+    *new_thread = thread;
+    return KERN_SUCCESS;
+}
+
+void thread_deallocate(thread_t thread)
+{
+    if (__atomic_sub_fetch(&thread->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        pthread_cond_destroy(&thread->cond);
+        free(thread);
+    }
+}
+
+/* Only ever a thread ending itself, which is all the kext does */
+void thread_terminate(thread_t thread)
+{
+    if (thread != tThread) {
+        panic("thread_terminate of another thread");
+    }
+    tThread = NULL;
+    thread_deallocate(thread);
+    pthread_exit(NULL);
+}
+
+#pragma mark Locks
+
+struct _IOLock {
+    pthread_mutex_t mutex;
+};
+
+IOLock *IOLockAlloc(void)
+{
+    IOLock *lock = malloc(sizeof(*lock));
+
+    pthread_mutex_init(&lock->mutex, NULL);
+    return lock;
+}
+
+void IOLockFree(IOLock *lock)
+{
+    pthread_mutex_destroy(&lock->mutex);
+    free(lock);
+}
+
+void IOLockLock(IOLock *lock)
+{
+    MayBlock("IOLockLock");
+    pthread_mutex_lock(&lock->mutex);
+}
+
+bool IOLockTryLock(IOLock *lock)
+{
+    return pthread_mutex_trylock(&lock->mutex) == 0;
+}
+
+void IOLockUnlock(IOLock *lock)
+{
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+int IOLockSleepDeadline(IOLock *lock, void *event, UInt64 deadline, UInt32 interType)
+{
+    assert_wait_deadline(event, interType, deadline);
+    IOLockUnlock(lock);
+    int result = thread_block(THREAD_CONTINUE_NULL);
+    IOLockLock(lock);
+    return result;
+}
+
+int IOLockSleep(IOLock *lock, void *event, UInt32 interType)
+{
+    return IOLockSleepDeadline(lock, event, 0, interType);
+}
+
+void IOLockWakeup(IOLock *lock, void *event, bool oneThread)
+{
+    thread_wakeup_prim(event, oneThread, THREAD_AWAKENED);
+}
+
+struct _IOSimpleLock {
+    pthread_spinlock_t spin;
+};
+
+IOSimpleLock *IOSimpleLockAlloc(void)
+{
+    IOSimpleLock *lock = malloc(sizeof(*lock));
+
+    pthread_spin_init(&lock->spin, PTHREAD_PROCESS_PRIVATE);
+    return lock;
+}
+
+void IOSimpleLockFree(IOSimpleLock *lock)
+{
+    pthread_spin_destroy(&lock->spin);
+    free(lock);
+}
+
+void IOSimpleLockLock(IOSimpleLock *lock)
+{
+    pthread_spin_lock(&lock->spin);
+    tSimpleLocks++;
+}
+
+bool IOSimpleLockTryLock(IOSimpleLock *lock)
+{
+    if (pthread_spin_trylock(&lock->spin)) {
+        return false;
+    }
+    tSimpleLocks++;
+    return true;
+}
+
+void IOSimpleLockUnlock(IOSimpleLock *lock)
+{
+    tSimpleLocks--;
+    pthread_spin_unlock(&lock->spin);
+}
+
+IOInterruptState IOSimpleLockLockDisableInterrupt(IOSimpleLock *lock)
+{
+    IOInterruptState state = ml_set_interrupts_enabled(0);
+
+    IOSimpleLockLock(lock);
+    return state;
+}
+
+void IOSimpleLockUnlockEnableInterrupt(IOSimpleLock *lock, IOInterruptState state)
+{
+    IOSimpleLockUnlock(lock);
+    ml_set_interrupts_enabled(state);
+}
+
+#pragma mark Thread calls
+
+/* Each call gets a worker thread of its own; enough for the few the kext makes */
+struct _thread_call {
+    thread_call_func_t func;
+    thread_call_param_t param0;
+    thread_call_param_t param1;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t worker;
+    uint64_t deadline;              /* when pending */
+    bool pending;
+    bool running;
+    bool exiting;
+};
+
+static void *ThreadCallMain(void *arg)
+{
+    thread_call_t call = arg;
+
+    pthread_mutex_lock(&call->lock);
+    while (!call->exiting) {
+        if (!call->pending) {
+            pthread_cond_wait(&call->cond, &call->lock);
+            continue;
+        }
+        uint64_t now = mach_absolute_time();
+        if (call->deadline > now) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            uint64_t at = (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec + (call->deadline - now);
+            ts.tv_sec = at / NSEC_PER_SEC;
+            ts.tv_nsec = at % NSEC_PER_SEC;
+            pthread_cond_timedwait(&call->cond, &call->lock, &ts);
+            continue;
+        }
+        call->pending = false;
+        call->running = true;
+        thread_call_param_t param1 = call->param1;
+        pthread_mutex_unlock(&call->lock);
+        call->func(call->param0, param1);
+        pthread_mutex_lock(&call->lock);
+        call->running = false;
+        pthread_cond_broadcast(&call->cond);
+    }
+    pthread_mutex_unlock(&call->lock);
+    return NULL;
+}
+
+thread_call_t thread_call_allocate(thread_call_func_t func, thread_call_param_t param0)
+{
+    thread_call_t call = calloc(1, sizeof(*call));
+
+    call->func = func;
+    call->param0 = param0;
+    pthread_mutex_init(&call->lock, NULL);
+    InitCond(&call->cond);
+    pthread_create(&call->worker, NULL, ThreadCallMain, call);
+    return call;
+}
+
+static boolean_t Enter(thread_call_t call, thread_call_param_t param1, uint64_t deadline)
+{
+    pthread_mutex_lock(&call->lock);
+    boolean_t was = call->pending;
+    call->pending = true;
+    call->param1 = param1;
+    call->deadline = deadline;
+    pthread_cond_broadcast(&call->cond);
+    pthread_mutex_unlock(&call->lock);
+    return was;
+}
+
+boolean_t thread_call_enter(thread_call_t call)
+{
+    return Enter(call, NULL, 0);
+}
+
+boolean_t thread_call_enter1(thread_call_t call, thread_call_param_t param1)
+{
+    return Enter(call, param1, 0);
+}
+
+boolean_t thread_call_enter_delayed(thread_call_t call, uint64_t deadline)
+{
+    return Enter(call, NULL, deadline);
+}
+
+boolean_t thread_call_cancel(thread_call_t call)
+{
+    pthread_mutex_lock(&call->lock);
+    boolean_t was = call->pending;
+    call->pending = false;
+    pthread_mutex_unlock(&call->lock);
+    return was;
+}
+
+boolean_t thread_call_cancel_wait(thread_call_t call)
+{
+    MayBlock("thread_call_cancel_wait");
+    pthread_mutex_lock(&call->lock);
+    boolean_t was = call->pending;
+    call->pending = false;
+    while (call->running) {
+        pthread_cond_wait(&call->cond, &call->lock);
+    }
+    pthread_mutex_unlock(&call->lock);
+    return was;
+}
+
+/* Like the kernel, refuses a call that is still pending or running */
+boolean_t thread_call_free(thread_call_t call)
+{
+    pthread_mutex_lock(&call->lock);
+    if (call->pending || call->running) {
+        pthread_mutex_unlock(&call->lock);
+        return 0;
+    }
+    call->exiting = true;
+    pthread_cond_broadcast(&call->cond);
+    pthread_mutex_unlock(&call->lock);
+    pthread_join(call->worker, NULL);
+    pthread_cond_destroy(&call->cond);
+    pthread_mutex_destroy(&call->lock);
+    free(call);
+    return 1;
+}
+
+#pragma mark Semaphores
+
+struct _semaphore {
+    sem_t sem;
+};
+
+kern_return_t semaphore_create(task_t task, semaphore_t *semaphore, int policy, int value)
+{
+    semaphore_t s = malloc(sizeof(*s));
+
+    sem_init(&s->sem, 0, value);
+    *semaphore = s;
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_destroy(task_t task, semaphore_t semaphore)
+{
+    sem_destroy(&semaphore->sem);
+    free(semaphore);
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_signal(semaphore_t semaphore)
+{
+    sem_post(&semaphore->sem);
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_wait(semaphore_t semaphore)
+{
+    MayBlock("semaphore_wait");
+    while (sem_wait(&semaphore->sem) && errno == EINTR) {
+    }
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_timedwait(semaphore_t semaphore, mach_timespec_t wait_time)
+{
+    struct timespec ts;
+
+    if (wait_time.tv_sec || wait_time.tv_nsec) {
+        MayBlock("semaphore_timedwait");
+    }
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += wait_time.tv_sec;
+    ts.tv_nsec += wait_time.tv_nsec;
+    if (ts.tv_nsec >= (long)NSEC_PER_SEC) {
+        ts.tv_sec++;
+        ts.tv_nsec -= NSEC_PER_SEC;
+    }
+    while (sem_timedwait(&semaphore->sem, &ts)) {
+        if (errno == ETIMEDOUT) {
+            return KERN_OPERATION_TIMED_OUT;
+        }
+    }
+    return KERN_SUCCESS;
+}
@@ -0,0 +1,194 @@
+/*
+ * osdarwin.c's ticket spinlocks: acquiring hands back the interrupt state
+ * it found and releasing puts exactly that back, nested or not; CPUs are
+ * served in the order they queued; eight CPUs hammering one lock lose no
+ * updates and share it evenly; and with acpi_lockstat=1 the counts and
+ * histograms add up. The test includes osdarwin.c to see its locks.
+ */
+
+#include "osdarwin.c"
+
+/* acdarwin.h defines the stdio streams away for the kernel */
+#undef stderr
+#undef stdout
+#undef EOF
+#include "test.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define kThreads        8
+#define kSeconds        2
+
+static ACPI_SPINLOCK gLock;
+static UINT64 gCounter;                 /* only touched under gLock */
+static UINT32 gInside;                  /* CPUs in the critical section */
+static BOOLEAN gCounting, gStop;
+
+struct Worker {
+    int cpu;
+    UINT64 acquisitions;
+    UINT64 counted;                     /* while every CPU was queueing */
+};
+
+static void *Hammer(void *arg)
+{
+    struct Worker *worker = arg;
+
+    xnu_set_cpu_number(worker->cpu);
+    for (int i = 0; !__atomic_load_n(&gStop, __ATOMIC_RELAXED); i++) {
+        boolean_t masked = i % 4 == 0;
+        ACPI_CPU_FLAGS flags;
+
+        /* Now and then come in with interrupts already off, as the SCI handler does */
+        ml_set_interrupts_enabled(!masked);
+        flags = AcpiOsAcquireLock(gLock);
+        CHECK(flags == !masked && !ml_get_interrupts_enabled(), "CPU %d got flags %lu with interrupts %s",
+              worker->cpu, (unsigned long)flags, ml_get_interrupts_enabled() ? "on" : "off");
+        CHECK(__atomic_add_fetch(&gInside, 1, __ATOMIC_RELAXED) == 1, "two CPUs hold the lock");
+        gCounter++;
+        __atomic_add_fetch(&worker->acquisitions, 1, __ATOMIC_RELAXED);
+        worker->counted += __atomic_load_n(&gCounting, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&gInside, 1, __ATOMIC_RELAXED);
+        AcpiOsReleaseLock(gLock, flags);
+        CHECK(ml_get_interrupts_enabled() == !masked, "CPU %d left with interrupts %s", worker->cpu,
+              ml_get_interrupts_enabled() ? "on" : "off");
+    }
+    ml_set_interrupts_enabled(TRUE);
+    return NULL;
+}
+
+/* Queue behind the lock and note when we got it */
+static UINT32 gServed[kThreads], gServedCount;
+
+static void *Queue(void *arg)
+{
+    int cpu = (int)(intptr_t)arg;
+    ACPI_CPU_FLAGS flags;
+
+    xnu_set_cpu_number(cpu);
+    flags = AcpiOsAcquireLock(gLock);
+    gServed[gServedCount++] = cpu;
+    AcpiOsReleaseLock(gLock, flags);
+    return NULL;
+}
+
+static UINT64 Sum(const UINT64 *buckets)
+{
+    UINT64 sum = 0;
+
+    for (UINT32 i = 0; i < ACPI_OS_LOCK_BUCKETS; i++) {
+        sum += buckets[i];
+    }
+    return sum;
+}
+
+int main(void)
+{
+    struct Worker workers[kThreads];
+    pthread_t thread[kThreads];
+    ACPI_SPINLOCK other;
+    ACPI_SPINLOCK gone;
+    ACPI_CPU_FLAGS outer, inner;
+    UINT64 min = ~0ULL, max = 0, total = 0, contended;
+    UINT32 locks = 0;
+    int baseline = xnu_allocations_live;
+
+    xnu_max_cpus = kThreads;
+    setenv("XNU_BOOT_ARGS", "acpi_lockstat=1", 1);
+    AcpiOsInitializeLocks();
+    CHECK(gAcpiOsLockStats, "acpi_lockstat=1 didn't turn the statistics on");
+    CHECK(AcpiOsCreateLock(NULL) == AE_BAD_PARAMETER, "a lock with nowhere to go");
+    CHECK(AcpiOsCreateLock(&gLock) == AE_OK && AcpiOsCreateLock(&gone) == AE_OK && AcpiOsCreateLock(&other) == AE_OK,
+          "can't create locks");
+
+    /* Flags are the interrupt state found, and release puts it back */
+    xnu_set_cpu_number(0);
+    ml_set_interrupts_enabled(TRUE);
+    outer = AcpiOsAcquireLock(gLock);
+    CHECK(outer && !ml_get_interrupts_enabled(), "interrupts on inside the lock");
+    inner = AcpiOsAcquireLock(other);
+    CHECK(!inner, "nested acquire found interrupts on");
+    AcpiOsReleaseLock(other, inner);
+    CHECK(!ml_get_interrupts_enabled(), "inner release turned interrupts on inside the outer lock");
+    AcpiOsReleaseLock(gLock, outer);
+    CHECK(ml_get_interrupts_enabled(), "outer release left interrupts off");
+
+    ml_set_interrupts_enabled(FALSE);
+    outer = AcpiOsAcquireLock(gLock);
+    AcpiOsReleaseLock(gLock, outer);
+    CHECK(!outer && !ml_get_interrupts_enabled(), "release turned on interrupts the caller had off");
+    ml_set_interrupts_enabled(TRUE);
+
+    /* Deleted locks leave the statistics list */
+    AcpiOsDeleteLock(gone);
+    for (struct _acpi_os_lock *lock = gAcpiOsLocks; lock; lock = lock->link) {
+        CHECK(lock != gone, "deleted lock still listed");
+        locks++;
+    }
+    CHECK(locks == 2, "%u locks listed", locks);
+
+    /* CPUs get the lock in the order they queued for it */
+    outer = AcpiOsAcquireLock(gLock);
+    for (int i = 1; i <= kThreads - 1; i++) {
+        pthread_create(&thread[i], NULL, Queue, (void *)(intptr_t)i);
+        while (__atomic_load_n(&gLock->next, __ATOMIC_ACQUIRE) - gLock->owner != (UINT32)i + 1) {
+            sched_yield();
+        }
+    }
+    AcpiOsReleaseLock(gLock, outer);
+    for (int i = 1; i <= kThreads - 1; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    for (UINT32 i = 0; i < kThreads - 1; i++) {
+        CHECK(gServed[i] == i + 1, "CPU %u was served %uth", gServed[i], i + 1);
+    }
+
+    /* Eight CPUs on one lock: no lost updates, and nobody starved */
+    gCounter = 0;
+    for (int i = 0; i < kThreads; i++) {
+        workers[i] = (struct Worker){ i, 0, 0 };
+        pthread_create(&thread[i], NULL, Hammer, &workers[i]);
+    }
+    /* Whoever starts first has the lock to itself until the others queue; count after that */
+    for (int i = 0; i < kThreads; i++) {
+        while (!__atomic_load_n(&workers[i].acquisitions, __ATOMIC_RELAXED)) {
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&gCounting, TRUE, __ATOMIC_RELAXED);
+    sleep(kSeconds);
+    __atomic_store_n(&gStop, TRUE, __ATOMIC_RELAXED);
+    for (int i = 0; i < kThreads; i++) {
+        pthread_join(thread[i], NULL);
+        total += workers[i].acquisitions;
+        min = workers[i].counted < min ? workers[i].counted : min;
+        max = workers[i].counted > max ? workers[i].counted : max;
+    }
+    CHECK(gCounter == total, "%llu updates for %llu acquisitions", (unsigned long long)gCounter,
+          (unsigned long long)total);
+    CHECK(min >= max / 2, "CPUs got the lock %llu to %llu times", (unsigned long long)min, (unsigned long long)max);
+
+    /* The statistics count every acquisition once; 10 were made before the hammering */
+    CHECK(gLock->acquisitions == total + 10, "%llu acquisitions counted for %llu",
+          (unsigned long long)gLock->acquisitions, (unsigned long long)total + 10);
+    CHECK(Sum(gLock->hold) == gLock->acquisitions && Sum(gLock->wait) == gLock->contended,
+          "histograms have %llu holds and %llu waits for %llu acquisitions, %llu contended",
+          (unsigned long long)Sum(gLock->hold), (unsigned long long)Sum(gLock->wait),
+          (unsigned long long)gLock->acquisitions, (unsigned long long)gLock->contended);
+    CHECK(gLock->contended && gLock->max_waiters >= kThreads - 1 && gLock->max_waiters < kThreads,
+          "%llu contended, at most %u waiting", (unsigned long long)gLock->contended, gLock->max_waiters);
+    setenv("XNU_VERBOSE", "1", 1);
+    AcpiOsPrintLockStatistics();
+    unsetenv("XNU_VERBOSE");
+
+    contended = gLock->contended;
+    AcpiOsDeleteLock(gLock);
+    AcpiOsDeleteLock(other);
+    CHECK(!gAcpiOsLocks && xnu_allocations_live == baseline, "locks left after deletion");
+    printf("locks: %d CPUs: %llu acquisitions, %llu contended; %llu to %llu per CPU in %d s\n", kThreads,
+           (unsigned long long)total, (unsigned long long)contended, (unsigned long long)min, (unsigned long long)max,
+           kSeconds);
+    printf("locks: ok\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * AcpiOsLayer's physical mapping cache, with map() placing every mapping at
+ * an address of its own: random map and unmap calls get addresses that
+ * translate back to what was asked for, the indexes stay sorted with the
+ * active mappings disjoint, the idle list stays bounded and nothing is left
+ * mapped after termination. Also repeated small accesses to one page, which
+ * share one mapping, and a map() that fails. The test includes
+ * AcpiOsLayer.cpp to look at its indexes.
+ */
+
+#include "test.h"
+#include "AcpiOsLayer.cpp"
+#include <map>
+#include <vector>
+
+#define kOperations 2000000
+#define kHeldMax    200
+
+/* Every mapping map() has made, by virtual base; addresses are never reused */
+struct Placed {
+    UInt64 phys;
+    UInt64 length;
+};
+static std::map<IOVirtualAddress, Placed> gPlaced;
+static IOVirtualAddress gNextAddress = 0x100000000ULL;
+
+static IOVirtualAddress Place(UInt64 address, UInt64 length)
+{
+    CHECK(!(address & PAGE_MASK) && !(length & PAGE_MASK) && length, "map of %#llx+%#llx is not page granular",
+          (unsigned long long)address, (unsigned long long)length);
+
+    IOVirtualAddress va = gNextAddress;
+    gPlaced[va] = Placed{address, length};
+    gNextAddress += length + (rand() % 3) * PAGE_SIZE;
+    return va;
+}
+
+static UInt64 Translate(void *p)
+{
+    IOVirtualAddress va = (IOVirtualAddress)p;
+    auto it = gPlaced.upper_bound(va);
+
+    CHECK(it != gPlaced.begin(), "%p is below every mapping", p);
+    --it;
+    CHECK(va < it->first + it->second.length, "%p is past the end of its mapping", p);
+    return it->second.phys + (va - it->first);
+}
+
+static void CheckIndexes(void)
+{
+    for (UInt32 i = 1; i < gAcpiOsMapByPhysCount; i++) {
+        CHECK(gAcpiOsMapByPhys[i - 1]->PhysBase + gAcpiOsMapByPhys[i - 1]->Length <= gAcpiOsMapByPhys[i]->PhysBase,
+              "active mappings %u and %u overlap or are out of order", i - 1, i);
+    }
+    for (UInt32 i = 1; i < gAcpiOsMapByVirtCount; i++) {
+        CHECK(gAcpiOsMapByVirt[i - 1]->VirtBase < gAcpiOsMapByVirt[i]->VirtBase,
+              "live mappings %u and %u are out of order", i - 1, i);
+    }
+    CHECK(gAcpiOsMapByVirtCount == (UInt32)xnu_maps_live, "%u mappings indexed, %d mapped",
+          gAcpiOsMapByVirtCount, xnu_maps_live);
+    CHECK(gAcpiOsMapIdleCount <= kAcpiOsMapIdleLimit, "%u idle mappings", gAcpiOsMapIdleCount);
+}
+
+int main()
+{
+    struct Held {
+        void *va;
+        UInt64 address;
+        UInt64 size;
+    };
+    std::vector<Held> held;
+    static boot_args args;
+    int made;
+
+    PE_state.bootArgs = &args;
+    xnu_map_address = Place;
+    srand(1);
+    CHECK_STATUS(AcpiOsExtInitialize());
+
+    /* Mostly small ranges over 2 MB, so they meet and straddle each other; some span pages */
+    for (int i = 0; i < kOperations; i++) {
+        if (held.size() < kHeldMax && (rand() % 2 || held.empty())) {
+            UInt64 address = (UInt64)(rand() % 512) * PAGE_SIZE + rand() % PAGE_SIZE;
+            UInt64 size = 1 + rand() % (rand() % 8 ? 64 : 5 * PAGE_SIZE);
+            void *va = AcpiOsExtMapMemory(address, size);
+
+            CHECK(va, "can't map %#llx+%#llx", (unsigned long long)address, (unsigned long long)size);
+            CHECK(Translate(va) == address && Translate((UInt8 *)va + size - 1) == address + size - 1,
+                  "%#llx+%#llx mapped at %p, which is %#llx", (unsigned long long)address,
+                  (unsigned long long)size, va, (unsigned long long)Translate(va));
+            held.push_back(Held{va, address, size});
+        } else {
+            size_t k = rand() % held.size();
+
+            CHECK(Translate(held[k].va) == held[k].address, "%#llx moved while mapped",
+                  (unsigned long long)held[k].address);
+            AcpiOsExtUnmapMemory(held[k].va, held[k].size);
+            held[k] = held.back();
+            held.pop_back();
+        }
+        if (i % 100000 == 0) {
+            CheckIndexes();
+        }
+    }
+
+    for (size_t k = 0; k < held.size(); k++) {
+        AcpiOsExtUnmapMemory(held[k].va, held[k].size);
+    }
+    CheckIndexes();
+    CHECK(gAcpiOsMapByVirtCount == gAcpiOsMapIdleCount, "%u mappings left, %u of them idle",
+          gAcpiOsMapByVirtCount, gAcpiOsMapIdleCount);
+    printf("mapcache: %d map and unmap calls made %d mappings\n", kOperations, xnu_maps_made);
+
+    /* ECAM-style: a million 4-byte accesses to one page */
+    made = xnu_maps_made;
+    for (int i = 0; i < 1000000; i++) {
+        void *va = AcpiOsExtMapMemory(0xE0000000ULL + (i % 1024) * 4, 4);
+
+        AcpiOsExtUnmapMemory(va, 4);
+    }
+    CHECK(xnu_maps_made - made == 1, "a million accesses to one page made %d mappings", xnu_maps_made - made);
+
+    /* A failed map() leaves nothing behind */
+    made = xnu_maps_live;
+    xnu_maps_fail_after = 0;
+    CHECK(!AcpiOsExtMapMemory(0x40000000ULL, 16), "a failed map() returned an address");
+    xnu_maps_fail_after = -1;
+    CHECK(xnu_maps_live == made, "a failed map() changed the live mappings from %d to %d", made, xnu_maps_live);
+    CheckIndexes();
+
+    CHECK_STATUS(AcpiOsExtTerminate());
+    CHECK(!xnu_maps_live, "%d mappings left after termination", xnu_maps_live);
+    printf("mapcache: ok\n");
+    return 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * osdarwin.c's PCI config shadow, over a fake bus behind ports 0xCF8/0xCFC
+ * that counts how often it is read: an AML-like loop over IDs, class and
+ * capabilities reads the hardware once per function, BARs and command
+ * always go to the hardware, and writes, bridge bus numbers and
+ * AcpiOsInvalidatePciConfiguration let changed IDs through. Also absent
+ * and hot-added functions, AcpiOsSnapshotPciConfiguration, the statistics,
+ * and readers racing writers. The test includes osdarwin.c to see its
+ * shadows.
+ */
+
+#include "osdarwin.c"
+
+/* acdarwin.h defines the stdio streams away for the kernel */
+#undef stderr
+#undef stdout
+#undef EOF
+#include "test.h"
+#include <pexpert/i386/boot.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define kRounds         1000
+#define kThreads        4
+
+struct Function {
+    ACPI_PCI_ID id;
+    BOOLEAN present;
+    UINT8 caps[8];              /* capability offsets, in list order */
+    UINT8 config[256];
+};
+
+enum { kHost, kBridge, kNic, kHotPlug };
+static struct Function gBus[] = {
+    { { 0, 0x00, 0x00, 0 }, TRUE, { 0x40, 0x50, 0x60 } },
+    { { 0, 0x00, 0x1C, 0 }, TRUE, { 0x40, 0x80 } },
+    { { 0, 0x01, 0x00, 0 }, TRUE, { 0xC8, 0xD0, 0xE0, 0xA0 } },
+    { { 0, 0x00, 0x1F, 7 }, FALSE, { 0x40 } },
+};
+#define kFunctions      (sizeof(gBus) / sizeof(gBus[0]))
+
+/*
+ * The address latch is per thread. On real hardware 0xCF8 is one register
+ * for every CPU; serializing it is up to whoever uses port I/O config
+ * access, and these tests are about the shadow.
+ */
+static __thread UINT32 tAddress;
+static UINT32 gHardwareReads;
+
+static struct Function *Decode(UINT32 address)
+{
+    for (UINT32 i = 0; i < kFunctions; i++) {
+        ACPI_PCI_ID *id = &gBus[i].id;
+
+        if (gBus[i].present && (address & 0x80FFFF00) ==
+            (0x80000000 | ((UINT32)id->Bus << 16) | ((UINT32)id->Device << 11) | ((UINT32)id->Function << 8))) {
+            return &gBus[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t ConfigRead(uint16_t port, int width)
+{
+    struct Function *f = Decode(tAddress);
+    uint32_t value = 0xFFFFFFFF;
+
+    CHECK(port >= 0xCFC && port + width <= 0xD00, "%d-byte read of port %#x", width, port);
+    __atomic_add_fetch(&gHardwareReads, 1, __ATOMIC_RELAXED);
+    if (f) {
+        memcpy(&value, &f->config[(tAddress & 0xFC) + port - 0xCFC], width);
+        value &= width == 4 ? 0xFFFFFFFF : (1U << (width * 8)) - 1;
+    }
+    return value;
+}
+
+static void ConfigWrite(uint16_t port, uint32_t value, int width)
+{
+    struct Function *f;
+
+    if (port == 0xCF8 && width == 4) {
+        tAddress = value;
+        return;
+    }
+    CHECK(port >= 0xCFC && port + width <= 0xD00, "%d-byte write of port %#x", width, port);
+    f = Decode(tAddress);
+    if (f) {
+        memcpy(&f->config[(tAddress & 0xFC) + port - 0xCFC], &value, width);
+    }
+}
+
+static void Set(struct Function *f, UINT32 reg, UINT32 value, UINT32 bytes)
+{
+    memcpy(&f->config[reg], &value, bytes);
+}
+
+static UINT32 Get(struct Function *f, UINT32 reg, UINT32 bytes)
+{
+    UINT32 value = 0;
+
+    memcpy(&value, &f->config[reg], bytes);
+    return value;
+}
+
+static void Build(struct Function *f, UINT32 ids, UINT32 class, UINT8 header, UINT8 cap_ids[])
+{
+    Set(f, 0x00, ids, 4);
+    Set(f, 0x04, 0x00100406, 4);                /* capability list, bus master, memory */
+    Set(f, 0x08, class, 4);
+    Set(f, 0x0E, header, 1);
+    Set(f, 0x34, f->caps[0], 1);
+    Set(f, 0x3D, 1, 1);
+    for (UINT32 i = 0; i < sizeof(f->caps) && f->caps[i]; i++) {
+        Set(f, f->caps[i], cap_ids[i], 1);
+        Set(f, f->caps[i] + 1, i + 1 < sizeof(f->caps) ? f->caps[i + 1] : 0, 1);
+    }
+}
+
+static UINT32 Read(struct Function *f, UINT32 reg, UINT32 width)
+{
+    UINT64 value;
+
+    CHECK(AcpiOsReadPciConfiguration(&f->id, reg, &value, width) == AE_OK, "AcpiOsReadPciConfiguration");
+    return (UINT32)value;
+}
+
+/* Hardware reads an expression made */
+#define HARDWARE(expr) ({ UINT32 before_ = gHardwareReads; (void)(expr); gHardwareReads - before_; })
+
+/* What AML reads over and over: IDs, class, header type, subsystem, the capability list */
+static void Survey(struct Function *f)
+{
+    UINT8 header = Get(f, 0x0E, 1) & 0x7F;
+    UINT32 pointer;
+
+    CHECK(Read(f, 0x00, 16) == Get(f, 0x00, 2), "vendor of %02x:%02x.%x", f->id.Bus, f->id.Device, f->id.Function);
+    CHECK(Read(f, 0x02, 16) == Get(f, 0x02, 2), "device of %02x:%02x.%x", f->id.Bus, f->id.Device, f->id.Function);
+    CHECK(Read(f, 0x08, 32) == Get(f, 0x08, 4), "class of %02x:%02x.%x", f->id.Bus, f->id.Device, f->id.Function);
+    CHECK(Read(f, 0x0B, 8) == Get(f, 0x0B, 1), "base class of %02x:%02x.%x", f->id.Bus, f->id.Device, f->id.Function);
+    CHECK(Read(f, 0x0E, 8) == Get(f, 0x0E, 1), "header type of %02x:%02x.%x", f->id.Bus, f->id.Device, f->id.Function);
+    if (header == 0) {
+        CHECK(Read(f, 0x2C, 32) == Get(f, 0x2C, 4), "subsystem of %02x:%02x.%x", f->id.Bus, f->id.Device, f->id.Function);
+    }
+    CHECK(Read(f, 0x3D, 8) == 1, "interrupt pin of %02x:%02x.%x", f->id.Bus, f->id.Device, f->id.Function);
+    for (pointer = Read(f, 0x34, 8); pointer; pointer = Read(f, pointer + 1, 8)) {
+        CHECK(Read(f, pointer, 8) == Get(f, pointer, 1), "capability at %#x of %02x:%02x.%x", pointer,
+              f->id.Bus, f->id.Device, f->id.Function);
+    }
+}
+
+/* Reads that take a snapshot: the header and every capability */
+static UINT32 Fill(struct Function *f)
+{
+    UINT32 n = 16;
+
+    while (n - 16 < sizeof(f->caps) && f->caps[n - 16]) {
+        n++;
+    }
+    return n;
+}
+
+static BOOLEAN gStop;
+
+static void *Reader(void *arg)
+{
+    xnu_set_cpu_number((int)(intptr_t)arg);
+    for (int i = 0; i < 20000; i++) {
+        for (UINT32 k = kHost; k <= kNic; k++) {
+            Survey(&gBus[k]);
+        }
+        CHECK(Read(&gBus[kNic], 0x10, 32) == 0xF7C00000, "NIC BAR");
+    }
+    return NULL;
+}
+
+static void *Writer(void *arg)
+{
+    xnu_set_cpu_number((int)(intptr_t)arg);
+    for (int i = 0; !__atomic_load_n(&gStop, __ATOMIC_RELAXED); i++) {
+        switch (i % 3) {
+            case 0:
+                CHECK(AcpiOsWritePciConfiguration(&gBus[kNic].id, 0x04, 0x0406, 16) == AE_OK, "AcpiOsWritePciConfiguration");
+                break;
+            case 1:
+                AcpiOsInvalidatePciConfiguration(&gBus[kHost].id);
+                break;
+            case 2:
+                CHECK(AcpiOsWritePciConfiguration(&gBus[kBridge].id, 0x19, 1, 8) == AE_OK, "AcpiOsWritePciConfiguration");
+                break;
+        }
+        sched_yield();
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    static boot_args args;          /* no ECAM: everything takes port I/O */
+    struct Function *host = &gBus[kHost], *bridge = &gBus[kBridge], *nic = &gBus[kNic], *hot = &gBus[kHotPlug];
+    ACPI_PCI_ID id;
+    UINT32 config[64], reads = 0, hardware;
+    UINT64 valid, value, cursor = 0;
+    pthread_t thread[kThreads + 1];
+    char log[16384] = "";
+    UINT32 logged = 0;
+
+    Build(host, 0x3E308086, 0x0600000A, 0x00, (UINT8[]){ 0x09, 0x01, 0x05 });
+    Set(host, 0x2C, 0x50001458, 4);
+    Build(bridge, 0xA33C8086, 0x060400F0, 0x81, (UINT8[]){ 0x10, 0x05 });
+    Set(bridge, 0x18, 0x00010100, 4);           /* primary 0, secondary 1, subordinate 1 */
+    Build(nic, 0x10D38086, 0x02000006, 0x00, (UINT8[]){ 0x01, 0x05, 0x10, 0x11 });
+    Set(nic, 0x10, 0xF7C00000, 4);
+    Set(nic, 0x2C, 0xA01F8086, 4);
+    Build(hot, 0x15B88086, 0x0C033000, 0x00, (UINT8[]){ 0x01 });
+
+    xnu_port_read = ConfigRead;
+    xnu_port_write = ConfigWrite;
+    PE_state.bootArgs = &args;
+    xnu_max_cpus = kThreads + 1;    /* the readers and a writer */
+    CHECK(AcpiOsInitialize() == AE_OK, "AcpiOsInitialize");
+
+    /* After the first survey of each function, the hardware isn't asked again */
+    hardware = gHardwareReads;
+    for (int round = 0; round < kRounds; round++) {
+        for (UINT32 k = kHost; k <= kNic; k++) {
+            UINT32 before = gHardwareReads;
+
+            Survey(&gBus[k]);
+            CHECK(gHardwareReads - before == (round ? 0 : Fill(&gBus[k])), "survey %d of function %u read the hardware %u times",
+                  round, k, gHardwareReads - before);
+        }
+    }
+    hardware = gHardwareReads - hardware;
+    for (UINT32 k = kHost; k <= kNic; k++) {
+        struct _acpi_pci_shadow *shadow = AcpiOsPciShadowLookup(ACPI_PCI_SHADOW_KEY(&gBus[k].id));
+
+        CHECK(shadow, "no shadow for function %u", k);
+        reads += shadow->hits + shadow->misses;
+    }
+    printf("pci: %u config reads, %u of them from the hardware\n", reads, hardware);
+
+    /* BARs and command go to the hardware every time, and see what it has */
+    CHECK(HARDWARE(Read(nic, 0x10, 32)) == 1 && HARDWARE(Read(nic, 0x04, 16)) == 1, "BAR or command from the shadow");
+    Set(nic, 0x10, 0xFFF00000, 4);              /* sized behind our back */
+    CHECK(Read(nic, 0x10, 32) == 0xFFF00000, "stale BAR");
+    Set(nic, 0x10, 0xF7C00000, 4);
+
+    /* Unwritten IDs come from the shadow, stale or not */
+    Set(host, 0x02, 0x3E31, 2);
+    CHECK(Read(host, 0x02, 16) == 0x3E30, "host device ID not shadowed");
+
+    /* AcpiOsInvalidatePciConfiguration drops one function and snapshots it again on the next read */
+    AcpiOsInvalidatePciConfiguration(&host->id);
+    CHECK(HARDWARE(value = Read(host, 0x02, 16)) == Fill(host), "host not snapshotted again");
+    CHECK(value == 0x3E31, "host device ID stale after invalidation");
+    CHECK(HARDWARE(Survey(nic)) == 0, "invalidating the host dropped the NIC");
+
+    /* A write refetches the function's values a dword at a time, once each */
+    Set(nic, 0x02, 0x10D4, 2);                  /* a reset changed the ID */
+    CHECK(AcpiOsWritePciConfiguration(&nic->id, 0x04, 0x0406, 16) == AE_OK, "AcpiOsWritePciConfiguration");
+    CHECK(HARDWARE(value = Read(nic, 0x02, 16)) == 1 && value == 0x10D4, "NIC device ID stale after a write");
+    CHECK(HARDWARE(Read(nic, 0x00, 16)) == 0 && HARDWARE(Read(nic, 0x08, 32)) == 1 &&
+          HARDWARE(Read(nic, 0xC8, 8)) == 1 && HARDWARE(Read(nic, 0xC8, 8)) == 0, "NIC not refetched once per dword");
+    Set(nic, 0x02, 0x10D3, 2);
+    CHECK(AcpiOsWritePciConfiguration(&nic->id, 0x04, 0x0406, 16) == AE_OK, "AcpiOsWritePciConfiguration");
+
+    /* New bus numbers behind a bridge drop every shadow */
+    CHECK(AcpiOsWritePciConfiguration(&bridge->id, 0x19, 1, 8) == AE_OK, "AcpiOsWritePciConfiguration");
+    CHECK(HARDWARE(Survey(host)) == Fill(host) && HARDWARE(Survey(nic)) == Fill(nic), "bus numbers kept the shadows");
+
+    /* An absent function isn't shadowed, so a hot-added one shows up */
+    CHECK(HARDWARE(value = Read(hot, 0x00, 32)) == 2 && value == 0xFFFFFFFF, "absent function not read through");
+    hot->present = TRUE;
+    CHECK(HARDWARE(Survey(hot)) == Fill(hot) && HARDWARE(Survey(hot)) == 0, "hot-added function not shadowed");
+
+    /* Snapshots: the header and each capability's first dword */
+    CHECK(AcpiOsSnapshotPciConfiguration(&nic->id, config, &valid) == AE_OK, "AcpiOsSnapshotPciConfiguration");
+    CHECK(valid == (0xFFFF | (1ULL << (0xC8 / 4)) | (1ULL << (0xD0 / 4)) | (1ULL << (0xE0 / 4)) | (1ULL << (0xA0 / 4))),
+          "NIC snapshot has dwords %#llx", (unsigned long long)valid);
+    for (UINT32 i = 0; i < 64; i++) {
+        CHECK(!(valid & (1ULL << i)) || config[i] == Get(nic, i * 4, 4), "NIC snapshot dword %u is %#x", i, config[i]);
+    }
+    hot->present = FALSE;
+    AcpiOsInvalidatePciConfiguration(&hot->id);
+    CHECK(AcpiOsSnapshotPciConfiguration(&hot->id, config, &valid) == AE_NOT_EXIST, "snapshot of an absent function");
+    CHECK(AcpiOsSnapshotPciConfiguration(NULL, config, &valid) == AE_BAD_PARAMETER, "snapshot of nothing");
+
+    /* Port I/O reaches only segment 0, and only real widths */
+    id = nic->id;
+    id.Segment = 1;
+    CHECK(AcpiOsReadPciConfiguration(&id, 0, &value, 32) == AE_NOT_EXIST, "read on segment 1");
+    CHECK(AcpiOsReadPciConfiguration(&nic->id, 0, &value, 64) == AE_BAD_PARAMETER, "64-bit read");
+    CHECK(AcpiOsWritePciConfiguration(&nic->id, 0, 0, 64) == AE_BAD_PARAMETER, "64-bit write");
+
+    /* Readers see the right IDs while another CPU writes and invalidates */
+    for (int i = 0; i < kThreads; i++) {
+        pthread_create(&thread[i], NULL, Reader, (void *)(intptr_t)i);
+    }
+    pthread_create(&thread[kThreads], NULL, Writer, (void *)(intptr_t)kThreads);
+    for (int i = 0; i < kThreads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    __atomic_store_n(&gStop, TRUE, __ATOMIC_RELAXED);
+    pthread_join(thread[kThreads], NULL);
+
+    /* The statistics reach the log; the writer may have dropped every shadow last */
+    Survey(nic);
+    AcpiOsPrintPciShadowStatistics();
+    for (int i = 0; i < 100 && !strstr(log, "PCI 0000:01:00.0 8086:10D3 shadow"); i++) {
+        IOSleep(10);
+        logged += AcpiOsReadLog(&cursor, log + logged, sizeof(log) - 1 - logged);
+        log[logged] = '\0';
+    }
+    CHECK(strstr(log, "PCI 0000:01:00.0 8086:10D3 shadow"), "no NIC statistics in the log:\n%s", log);
+    fputs(log, stdout);
+
+    CHECK(AcpiOsTerminate() == AE_OK, "AcpiOsTerminate");
+    CHECK(!gAcpiOsPciShadowLock, "shadow lock left after termination");
+    printf("pci: ok\n");
+    return 0;
+}
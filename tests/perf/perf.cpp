@@ -0,0 +1,272 @@
+/*
+ * PDACPIPerformance: _PSS/_PCT/_PPC/_PSD parsing and coordination against a
+ * simulated MSR and port, and the governor replayed over 20 minutes of a
+ * bursty load at three downSamples settings.
+ *
+ * A simulated CPU runs at the frequency of the last state written to its
+ * control register. Each period it is handed work as a fraction of what its
+ * fastest state gets done; work past what the current state can do is
+ * unmet. The loads are generated from a fixed seed so every run sees the
+ * same ones.
+ */
+
+extern "C" {
+#include "acpi.h"
+#include "accommon.h"
+#include "acnamesp.h"
+}
+#include "PDACPIPerformance.h"
+#include "test.h"
+
+#define kCPUs           6       /* perf.py */
+#define kPeriodTicks    1000000 /* elapsed time per sampling period, in sample units */
+#define kTraceMinutes   20
+
+static PDACPIPerformance *gPerf;
+static UInt32 gLimit4;          /* the _PSS index CPU4's _PPC allows, as the test set it */
+static UInt32 gLastWrites;      /* writes in the last batch */
+
+static struct {
+    UInt32 frequency;           /* MHz it runs at */
+    UInt32 fastest;             /* MHz of its fastest valid state */
+    double demand;              /* this period's work, as a fraction of the fastest state's */
+    UInt64 busy;
+    UInt64 elapsed;
+} gCPU[kCPUs];
+
+static void Sample(void *, PDACPIPerformanceSample *samples, UInt32 count)
+{
+    for (UInt32 i = 0; i < count && i < kCPUs; i++) {
+        samples[i].busy = gCPU[i].busy;
+        samples[i].elapsed = gCPU[i].elapsed;
+        samples[i].valid = true;
+    }
+}
+
+/* Only ever a valid state, within _PPC; CPU2 and CPU3 share their port, so a write there sets both */
+static void Write(void *, const PDACPIPerformanceWrite *writes, UInt32 count)
+{
+    for (UInt32 w = 0; w < count; w++) {
+        const PDACPIPState *s;
+        UInt32 n = PDACPIPerformanceGetStates(gPerf, writes[w].cpu, &s);
+        UInt32 i;
+
+        for (i = 0; i < n && !(s[i].valid && s[i].control == writes[w].value); i++) {
+        }
+        CHECK(i < n, "CPU%u: wrote 0x%llx, no valid state's control", writes[w].cpu,
+              (unsigned long long)writes[w].value);
+        CHECK(writes[w].cpu != 4 || i >= gLimit4, "CPU4 put in state %u, _PPC allows %u", i, gLimit4);
+
+        if (writes[w].reg->SpaceId == ACPI_ADR_SPACE_SYSTEM_IO) {
+            gCPU[2].frequency = gCPU[3].frequency = s[i].frequency;
+        } else {
+            gCPU[writes[w].cpu].frequency = s[i].frequency;
+        }
+    }
+    gLastWrites = count;
+}
+
+static ACPI_HANDLE Processor(UInt32 cpu)
+{
+    char path[16];
+    ACPI_HANDLE handle;
+
+    snprintf(path, sizeof(path), "\\_SB.CPU%u", cpu);
+    CHECK_STATUS(AcpiGetHandle(NULL, path, &handle));
+    return handle;
+}
+
+static void SetPPC(UInt32 value, UInt32 limit)
+{
+    ACPI_HANDLE handle;
+
+    CHECK_STATUS(AcpiGetHandle(NULL, (char *)"\\PPCV", &handle));
+    AcpiNsGetAttachedObject(AcpiNsValidateHandle(handle))->Integer.Value = value;
+    gLimit4 = limit;
+}
+
+static PDACPIPerformance *Create(UInt32 downSamples)
+{
+    PDACPIPerformanceBackend backend = { Sample, Write, NULL };
+    PDACPIPerformanceGovernor governor = { 0, 0, 0, downSamples };
+
+    gPerf = PDACPIPerformanceCreate(kCPUs, &backend, &governor);
+    CHECK(gPerf, "create");
+    for (UInt32 cpu = 0; cpu < kCPUs; cpu++) {
+        CHECK(PDACPIPerformanceAddProcessor(gPerf, cpu, Processor(cpu)) == kIOReturnSuccess, "add CPU%u", cpu);
+    }
+    for (UInt32 cpu = 0; cpu < kCPUs; cpu++) {
+        const PDACPIPState *s;
+        UInt32 n = PDACPIPerformanceGetStates(gPerf, cpu, &s);
+        UInt32 i;
+        for (i = 0; i < n && !s[i].valid; i++) {
+        }
+        CHECK(i < n, "CPU%u has no valid state", cpu);
+        gCPU[cpu].fastest = gCPU[cpu].frequency = s[i].frequency;
+        gCPU[cpu].busy = gCPU[cpu].elapsed = 0;
+    }
+    return gPerf;
+}
+
+static void CheckParsing(void)
+{
+    const PDACPIPState *s;
+    UInt32 n;
+
+    CHECK(PDACPIFindProcessor(4) == Processor(4), "PDACPIFindProcessor(4)");
+
+    /* Bad entries keep their place, so _PPC and the status register still line up */
+    n = PDACPIPerformanceGetStates(gPerf, 4, &s);
+    CHECK(n == 6, "CPU4 has %u states", n);
+    CHECK(s[0].valid && s[1].valid && !s[2].valid && !s[3].valid && s[4].valid && s[5].valid, "CPU4 validity");
+    CHECK(s[4].frequency == 1800 && s[4].control == 0x1200 && s[5].frequency == 1000, "CPU4 state 4 is %u MHz",
+          s[4].frequency);
+
+    /* Truncated to the fastest 16 */
+    n = PDACPIPerformanceGetStates(gPerf, 5, &s);
+    CHECK(n == kPDACPIPerformanceMaxStates && s[15].frequency == 2500 && s[15].valid, "CPU5 has %u states", n);
+}
+
+static void CheckCoordination(void)
+{
+    /* The first period writes every CPU's fastest allowed state, the SW_ANY domain once */
+    PDACPIPerformanceUpdate(gPerf);
+    CHECK(gLastWrites == 5, "%u writes to start", gLastWrites);
+    CHECK(PDACPIPerformanceGetCurrentState(gPerf, 4) == 1, "CPU4 starts in state %u",
+          PDACPIPerformanceGetCurrentState(gPerf, 4));
+
+    /* SW_ALL: the fastest request in the domain, written on both */
+    gLastWrites = 0;
+    CHECK(PDACPIPerformanceSetState(gPerf, 1, 3) == kIOReturnSuccess, "CPU1 to 3");
+    CHECK(!gLastWrites && PDACPIPerformanceGetCurrentState(gPerf, 1) == 0, "CPU1 left CPU0's domain state");
+    CHECK(PDACPIPerformanceSetState(gPerf, 0, 3) == kIOReturnSuccess, "CPU0 to 3");
+    CHECK(gLastWrites == 2 && gCPU[0].frequency == 800 && gCPU[1].frequency == 800, "SW_ALL: %u writes", gLastWrites);
+
+    /* SW_ANY: one write moves the domain */
+    gLastWrites = 0;
+    CHECK(PDACPIPerformanceSetState(gPerf, 2, 2) == kIOReturnSuccess && !gLastWrites, "CPU2 to 2");
+    CHECK(PDACPIPerformanceSetState(gPerf, 3, 2) == kIOReturnSuccess, "CPU3 to 2");
+    CHECK(gLastWrites == 1 && gCPU[2].frequency == 1600 && gCPU[3].frequency == 1600, "SW_ANY: %u writes",
+          gLastWrites);
+
+    /* _PPC goes by _PSS index; one naming a bad entry means the next valid one */
+    CHECK(PDACPIPerformanceSetState(gPerf, 4, 2) == kIOReturnBadArgument, "CPU4 to a bad entry");
+    CHECK(PDACPIPerformanceSetState(gPerf, 4, 0) == kIOReturnNotPermitted &&
+          PDACPIPerformanceGetCurrentState(gPerf, 4) == 1, "CPU4 past _PPC");
+    SetPPC(3, 4);
+    PDACPIPerformanceUpdateLimit(gPerf, 4);
+    CHECK(PDACPIPerformanceGetCurrentState(gPerf, 4) == 4 && gCPU[4].frequency == 1800, "CPU4 under _PPC 3 in state %u",
+          PDACPIPerformanceGetCurrentState(gPerf, 4));
+    CHECK(PDACPIPerformanceSetState(gPerf, 4, 5) == kIOReturnSuccess && gCPU[4].frequency == 1000, "CPU4 to 5");
+    SetPPC(1, 1);
+    PDACPIPerformanceUpdateLimit(gPerf, 4);
+
+    /* A removed CPU stops holding its domain back, and can come back */
+    CHECK(PDACPIPerformanceSetState(gPerf, 0, 0) == kIOReturnSuccess && gCPU[1].frequency == 2400, "CPU0 to 0");
+    PDACPIPerformanceRemoveProcessor(gPerf, 0);
+    CHECK(PDACPIPerformanceGetCurrentState(gPerf, 1) == 3 && gCPU[1].frequency == 800, "CPU1 alone in state %u",
+          PDACPIPerformanceGetCurrentState(gPerf, 1));
+    CHECK(PDACPIPerformanceAddProcessor(gPerf, 0, Processor(0)) == kIOReturnSuccess, "add CPU0 back");
+
+    /* Over and over, so the domain slots have to be reused */
+    for (int k = 0; k < 4; k++) {
+        PDACPIPerformanceRemoveProcessor(gPerf, 5);
+        CHECK(PDACPIPerformanceAddProcessor(gPerf, 5, Processor(5)) == kIOReturnSuccess, "add CPU5 back");
+    }
+    CHECK(PDACPIPerformanceSetState(gPerf, 5, 7) == kIOReturnSuccess &&
+          PDACPIPerformanceGetCurrentState(gPerf, 5) == 7, "CPU5 to 7");
+    CHECK(PDACPIPerformanceSetState(gPerf, 4, 4) == kIOReturnSuccess &&
+          PDACPIPerformanceGetCurrentState(gPerf, 4) == 4 && PDACPIPerformanceGetCurrentState(gPerf, 5) == 7,
+          "CPU4 to 4 moved CPU5");
+}
+
+static UInt32 gSeed = 1;
+
+static double Uniform(void)
+{
+    gSeed = gSeed * 1103515245 + 12345;
+    return ((gSeed >> 8) & 0xFFFFFF) / (double)0x1000000;
+}
+
+struct Result {
+    double writesPerSecond;     /* per CPU */
+    double unmet;               /* share of the work asked for */
+    double speed;               /* average frequency, as a share of the fastest */
+};
+
+/*
+ * Quiet stretches of 5-15% with one-period spikes, and busy ones anywhere
+ * from 30 to 100% from one period to the next, each lasting a second or so
+ * on average.
+ */
+static Result Replay(UInt32 downSamples)
+{
+    bool busy[kCPUs] = {};
+    double asked = 0, unmet = 0, speed = 0;
+
+    gSeed = 1;
+    Create(downSamples);
+    UInt32 periodMS = PDACPIPerformanceGetSamplingInterval(gPerf);
+    UInt32 periods = kTraceMinutes * 60 * 1000 / periodMS;
+
+    for (UInt32 p = 0; p < periods; p++) {
+        for (UInt32 c = 0; c < kCPUs; c++) {
+            if (Uniform() < periodMS / 1000.0) {
+                busy[c] = !busy[c];
+            }
+            if (busy[c]) {
+                gCPU[c].demand = 0.3 + 0.7 * Uniform();
+            } else {
+                gCPU[c].demand = Uniform() < 0.03 ? 0.9 : 0.05 + 0.1 * Uniform();
+            }
+
+            double capacity = gCPU[c].frequency / (double)gCPU[c].fastest;
+            double done = gCPU[c].demand < capacity ? gCPU[c].demand : capacity;
+            gCPU[c].busy += (UInt64)(kPeriodTicks * done / capacity);
+            gCPU[c].elapsed += kPeriodTicks;
+            asked += gCPU[c].demand;
+            unmet += gCPU[c].demand - done;
+            speed += capacity;
+        }
+        PDACPIPerformanceUpdate(gPerf);
+    }
+
+    Result r;
+    r.writesPerSecond = PDACPIPerformanceGetTransitions(gPerf) / (periods * periodMS / 1000.0) / kCPUs;
+    r.unmet = unmet / asked;
+    r.speed = speed / periods / kCPUs;
+    PDACPIPerformanceDestroy(gPerf);
+    return r;
+}
+
+int main()
+{
+    TestLoadTable("perf.aml", 0);
+    SetPPC(1, 1);
+
+    Create(kPDACPIPerformanceDefaultDownSamples);
+    CHECK(PDACPIPerformanceAddProcessor(gPerf, 0, Processor(0)) == kIOReturnBadArgument, "adding CPU0 twice");
+    CheckParsing();
+    CheckCoordination();
+    PDACPIPerformanceDestroy(gPerf);
+
+    /*
+     * Waiting longer to slow down costs fewer writes for little unmet work.
+     * These are regression bounds, with a margin, on what it does today.
+     */
+    Result r[3];
+    UInt32 settings[3] = { 1, kPDACPIPerformanceDefaultDownSamples, 5 };
+    for (int i = 0; i < 3; i++) {
+        r[i] = Replay(settings[i]);
+        printf("downSamples %u: %.1f writes/s per CPU, %.1f%% unmet work, %.0f%% of full speed\n",
+               settings[i], r[i].writesPerSecond, 100 * r[i].unmet, 100 * r[i].speed);
+        CHECK(r[i].unmet < 0.05, "downSamples %u: %.1f%% unmet", settings[i], 100 * r[i].unmet);
+        CHECK(r[i].speed < 0.9, "downSamples %u: %.0f%% of full speed", settings[i], 100 * r[i].speed);
+    }
+    CHECK(r[0].writesPerSecond > r[1].writesPerSecond && r[1].writesPerSecond > r[2].writesPerSecond,
+          "more downSamples, more writes");
+    CHECK(r[1].writesPerSecond < r[0].writesPerSecond / 2, "the default halves the writes of none at all");
+
+    printf("perf: ok\n");
+    return 0;
+}
@@ -0,0 +1,50 @@
+#
+# Six processors for the P-state engine: CPU0 and CPU1 are a SW_ALL domain
+# with FFixedHW control, CPU2 and CPU3 a SW_ANY domain sharing one I/O port,
+# CPU4 has no _PSD, a _PPC method and two bad _PSS entries, and CPU5 lists
+# more states than the engine keeps.
+#
+
+import sys
+from aml import *
+
+FFH = 0x7f
+SW_ALL, SW_ANY = 0xFC, 0xFD
+
+
+def pss(states):
+    return name('_PSS', package([s if isinstance(s, bytes) else
+                                 package([integer(v) for v in s]) for s in states]))
+
+
+def pct(reg):
+    return name('_PCT', package([buffer(reg), buffer(reg)]))
+
+
+def psd(domain, coordination, processors):
+    return name('_PSD', package([package([integer(5), integer(0), integer(domain),
+                                          integer(coordination), integer(processors)])]))
+
+
+# MHz, mW, latency, bus master latency, control, status
+FOUR = [(2400, 35000, 10, 10, 0x1800, 0x1800), (2000, 25000, 10, 10, 0x1400, 0x1400),
+        (1600, 18000, 10, 10, 0x1000, 0x1000), (800, 8000, 10, 10, 0x0800, 0x0800)]
+MSR = gas(FFH, 64, 0, 0, 0x199)
+PORT = gas(1, 16, 0, 2, 0x880)
+
+sb = b''
+sb += processor('CPU0', 0, pss(FOUR) + pct(MSR) + psd(0, SW_ALL, 2))
+sb += processor('CPU1', 1, pss(FOUR) + pct(MSR) + psd(0, SW_ALL, 2))
+sb += processor('CPU2', 2, pss(FOUR) + pct(PORT) + psd(1, SW_ANY, 2))
+sb += processor('CPU3', 3, pss(FOUR) + pct(PORT) + psd(1, SW_ANY, 2))
+# Index 2 isn't six integers and index 3 repeats a frequency; 4 and 5 keep their indices
+sb += processor('CPU4', 4, pss([(3000, 50000, 10, 10, 0x1e00, 0x1e00), (2600, 40000, 10, 10, 0x1a00, 0x1a00),
+                                package([integer(2200), string('X')]),
+                                (2600, 40000, 10, 10, 0x1a01, 0x1a01),
+                                (1800, 20000, 10, 10, 0x1200, 0x1200), (1000, 9000, 10, 10, 0x0a00, 0x0a00)]) +
+                    pct(MSR) + method('_PPC', 0, ret(path('\\PPCV'))))
+sb += processor('CPU5', 5, pss([(4000 - 100 * i, 40000 - 1000 * i, 10, 10, 0x2800 - i, 0x2800 - i)
+                                for i in range(20)]) + pct(MSR))
+
+root = name('PPCV', integer(1))
+open(sys.argv[1], 'wb').write(table('DSDT', root + scope('\\_SB', sb)))
@@ -0,0 +1,139 @@
+/*
+ * PDACPITableIndex over a canned root table list of 34 tables, 15 of them
+ * SSDTs, interleaved as firmware lists them: every instance resolves to its
+ * table, missing instances and signatures get NULL, and the dictionary
+ * names are the "%4.4s-%u" ones catalogACPITables always used. Then larger
+ * lists from a few signatures, against a std::map.
+ */
+
+#include "iokit.h"
+#include "test.h"
+#include "PDACPITableIndex.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+static const char *const kCanned[] = {
+    "FACP", "FACS", "DSDT", "SSDT", "SSDT", "APIC", "HPET", "MCFG", "SSDT", "SSDT", "SSDT", "BGRT",
+    "DMAR", "SSDT", "FPDT", "SSDT", "SSDT", "TPM2", "SSDT", "WSMT", "LPIT", "SSDT", "SSDT", "ECDT",
+    "WDAT", "SSDT", "UEFI", "UEFI", "SSDT", "DBGP", "DBG2", "SSDT", "ASF!", "SSDT",
+};
+#define kCannedCount    (sizeof(kCanned) / sizeof(kCanned[0]))
+
+typedef std::map<std::pair<std::string, UInt32>, ACPI_TABLE_HEADER *> Expected;
+
+static ACPI_TABLE_HEADER *MakeTable(const char *signature, UInt32 length)
+{
+    ACPI_TABLE_HEADER *table = (ACPI_TABLE_HEADER *)calloc(1, length);
+
+    memcpy(table->Signature, signature, 4);
+    table->Length = length;
+    return table;
+}
+
+/* Index the list and check it against what the old numbering would give */
+static void Check(std::vector<ACPI_TABLE_HEADER *> &list, const char *what)
+{
+    Expected expected;
+    std::map<std::string, UInt32> counts;
+    std::set<std::string> names, indexed;
+    AcpiTableIndexEntry *index;
+    UInt32 size = 0, tables = 0;
+    int baseline = xnu_allocations_live;
+    char name[32];
+
+    for (ACPI_TABLE_HEADER *table : list) {
+        if (!table || !*(UInt32 *)table->Signature) {
+            continue;
+        }
+        std::string signature(table->Signature, 4);
+        UInt32 instance = counts[signature]++;
+
+        expected[{ signature, instance }] = table;
+        snprintf(name, sizeof(name), instance ? "%4.4s-%u" : "%4.4s", signature.c_str(), instance);
+        names.insert(name);
+    }
+
+    index = AcpiTableIndexBuild(list.data(), (UInt32)list.size(), &size);
+    CHECK(index, "%s: no index", what);
+    CHECK(size && !(size & (size - 1)) && size >= list.size() * 2, "%s: %u slots for %zu tables", what, size, list.size());
+
+    for (auto &e : expected) {
+        OSData *data = AcpiTableIndexLookup(index, size, e.first.first.c_str(), e.first.second);
+
+        CHECK(data && data->getBytesNoCopy() == e.second && data->getLength() == e.second->Length,
+              "%s: %s instance %u is %p, not %p", what, e.first.first.c_str(), e.first.second,
+              data ? data->getBytesNoCopy() : NULL, e.second);
+    }
+    for (auto &c : counts) {
+        CHECK(!AcpiTableIndexLookup(index, size, c.first.c_str(), c.second), "%s: %s has an instance %u",
+              what, c.first.c_str(), c.second);
+    }
+
+    for (UInt32 i = 0; i < size; i++) {
+        if (!index[i].Data) {
+            continue;
+        }
+        AcpiTableIndexName(&index[i], name, sizeof(name));
+        CHECK(indexed.insert(name).second, "%s: %s named twice", what, name);
+        tables++;
+    }
+    CHECK(indexed == names && tables == expected.size(), "%s: %u names for %zu tables", what, tables, expected.size());
+
+    AcpiTableIndexFree(index, size);
+    CHECK(xnu_allocations_live == baseline, "%s: index not freed", what);
+}
+
+int main()
+{
+    std::vector<ACPI_TABLE_HEADER *> list;
+    AcpiTableIndexEntry *index;
+    UInt32 size, ssdts = 0;
+
+    for (size_t i = 0; i < kCannedCount; i++) {
+        list.push_back(MakeTable(kCanned[i], sizeof(ACPI_TABLE_HEADER) + 4 * i));
+        ssdts += !strcmp(kCanned[i], "SSDT");
+    }
+    Check(list, "canned");
+
+    /* Tables that couldn't be fetched, or have no signature, aren't numbered */
+    list.insert(list.begin() + 5, NULL);
+    list.insert(list.begin() + 9, MakeTable("\0\0\0\0", sizeof(ACPI_TABLE_HEADER)));
+    Check(list, "with holes");
+
+    index = AcpiTableIndexBuild(list.data(), (UInt32)list.size(), &size);
+    CHECK(AcpiTableIndexLookup(index, size, "SSDT", 14) && !AcpiTableIndexLookup(index, size, "SSDT", 15),
+          "15 SSDTs are not SSDT to SSDT-14");
+    CHECK(AcpiTableIndexLookup(index, size, "UEFI", 1) && !AcpiTableIndexLookup(index, size, "FACP", 1),
+          "second UEFI missing, or a second FACP");
+    CHECK(!AcpiTableIndexLookup(index, size, "XSDT", 0) && !AcpiTableIndexLookup(index, size, "SSD", 0) &&
+          !AcpiTableIndexLookup(index, size, "", 0) && !AcpiTableIndexLookup(index, size, NULL, 0),
+          "a table for a signature not in the list");
+    CHECK(AcpiTableIndexLookup(index, size, "SSDTX", 3) == AcpiTableIndexLookup(index, size, "SSDT", 3),
+          "names are not matched on their first four characters");
+    CHECK(!AcpiTableIndexLookup(NULL, 0, "DSDT", 0), "a table from no index");
+    AcpiTableIndexFree(index, size);
+    for (ACPI_TABLE_HEADER *table : list) {
+        free(table);
+    }
+
+    /* Many instances of a few signatures, so probes run long and wrap */
+    srand(1);
+    for (int round = 0; round < 200; round++) {
+        static const char *const kSignatures[] = { "SSDT", "SSDT", "SSDT", "UEFI", "DSDT", "APIC", "OEM1" };
+
+        list.clear();
+        for (int i = 0, n = 1 + rand() % 600; i < n; i++) {
+            list.push_back(MakeTable(kSignatures[rand() % 7], sizeof(ACPI_TABLE_HEADER)));
+        }
+        Check(list, "random");
+        for (ACPI_TABLE_HEADER *table : list) {
+            free(table);
+        }
+    }
+
+    printf("tables: %zu canned tables, %u of them SSDTs, and 200 random lists\n", kCannedCount, ssdts);
+    printf("tables: ok\n");
+    return 0;
+}